@@ -295,6 +295,122 @@ interface FilePath {
   localFile: string;
 }
 
+/**
+ * An entry in the report returned by {@link tiled.memoryReport}.
+ *
+ * @since 1.11
+ */
+interface MemoryReportEntry {
+  /**
+   * Name of the entry, like the name of a layer or tileset.
+   */
+  readonly name: string;
+
+  /**
+   * Approximate amount of memory used, in bytes, or -1 when not known.
+   */
+  readonly bytes: number;
+
+  /**
+   * Number of items, like the objects in an object layer, when applicable.
+   */
+  readonly count?: number;
+
+  /**
+   * The entries that make up this entry.
+   */
+  readonly children?: MemoryReportEntry[];
+}
+
+/**
+ * The differences of a layer, as part of a {@link MapDiff}.
+ *
+ * @since 1.11
+ */
+interface LayerDiff {
+  /**
+   * Whether the layer was added, removed or modified.
+   */
+  readonly change: "added" | "removed" | "modified";
+
+  /**
+   * The ID of the layer.
+   */
+  readonly id: number;
+
+  /**
+   * The name of the layer, or its old name when it was removed.
+   */
+  readonly name: string;
+
+  /**
+   * The type of the layer.
+   */
+  readonly type: "tilelayer" | "objectgroup" | "imagelayer" | "group";
+
+  /**
+   * Whether any attribute of a modified layer changed, like its name,
+   * opacity or properties, its place in the layer hierarchy or the order of
+   * its objects.
+   */
+  readonly attributesChanged?: boolean;
+
+  /**
+   * For tile layers, the rectangles covering the changed cells, in tile
+   * coordinates.
+   */
+  readonly changedCells?: rect[];
+
+  /**
+   * For tile layers, the number of changed cells.
+   */
+  readonly changedCellCount?: number;
+
+  /**
+   * For object layers, the IDs of the added objects.
+   */
+  readonly addedObjects?: number[];
+
+  /**
+   * For object layers, the IDs of the removed objects.
+   */
+  readonly removedObjects?: number[];
+
+  /**
+   * For object layers, the IDs of the changed objects.
+   */
+  readonly changedObjects?: number[];
+}
+
+/**
+ * The differences between two maps, as returned by {@link tiled.compareMaps}.
+ *
+ * @since 1.11
+ */
+interface MapDiff {
+  /**
+   * Whether the map attributes or properties changed, or the order of its
+   * tilesets.
+   */
+  readonly mapChanged: boolean;
+
+  /**
+   * The file names of the added tilesets, or their names when embedded.
+   */
+  readonly addedTilesets: string[];
+
+  /**
+   * The file names of the removed tilesets, or their names when embedded.
+   */
+  readonly removedTilesets: string[];
+
+  /**
+   * The layers that differ, in the order of the new map followed by the
+   * removed layers.
+   */
+  readonly layers: LayerDiff[];
+}
+
 /**
  * An object representing an event.
  *
@@ -790,6 +906,11 @@ declare class TextFile {
  * When using {@link BinaryFile.WriteOnly}, you need to call {@link commit} when you’re
  * done writing otherwise the operation will be aborted without effect.
  *
+ * Since Tiled 1.11, files opened in {@link BinaryFile.ReadOnly} mode are
+ * mapped into memory when possible, so that reading from them is fast
+ * regardless of the size of the reads. Small writes are collected in a
+ * buffer before being written to the file.
+ *
  * To read and write files in text mode, use {@link TextFile} instead.
  */
 declare class BinaryFile {
@@ -987,6 +1108,19 @@ declare class ObjectGroup extends Layer {
    */
   addObject(object : MapObject) : void
 
+  /**
+   * Returns the objects whose bounds overlap or touch the given rectangle,
+   * sorted by their ID. The rectangle is in pixel coordinates, not including
+   * the offset of the layer.
+   *
+   * The bounds take into account the alignment, rotation and polygon of each
+   * object. This function uses a spatial index, so it is much faster than
+   * going over all the objects when the layer contains many of them.
+   *
+   * @since 1.11
+   */
+  objectsIntersecting(rect : rect) : MapObject[]
+
 }
 
 /**
@@ -1170,6 +1304,26 @@ declare class Project extends TiledObject {
    * The path to the .tiled-project file.
    */
   readonly fileName: string;
+
+  /**
+   * Returns the files in the project folders that reference the given file.
+   * This includes maps and tilesets using an image, maps using a tileset or
+   * template and worlds containing a map.
+   *
+   * The index is updated in the background as files change, so recent
+   * changes may not be reflected yet.
+   *
+   * @since 1.11
+   */
+  findReferences(fileName: string): string[];
+
+  /**
+   * Returns the files in the project folders that use the custom type with
+   * the given name, either as class or as the type of a property.
+   *
+   * @since 1.11
+   */
+  findTypeUsages(typeName: string): string[];
 }
 
 /**
@@ -1597,6 +1751,10 @@ declare class Asset extends TiledObject {
    * })
    * ```
    *
+   * Changes to objects made by the callback are reported to the rest
+   * of the editor in one batch after the callback returns, which makes
+   * changing many objects within a macro a lot faster.
+   *
    * The returned value is whatever the callback function returned.
    */
   macro<T>(text: string, callback: () => T): T;
@@ -2755,6 +2913,20 @@ declare class TileMap extends Asset {
   static readonly Base64Zstandard: unique symbol
   static readonly CSV: unique symbol
 
+  /**
+   * Base64 encoded pairs of a run length and a global tile ID.
+   *
+   * @since 1.11
+   */
+  static readonly Base64RunLength: unique symbol
+
+  /**
+   * Like {@link Base64RunLength}, with the runs compressed using Zstandard.
+   *
+   * @since 1.11
+   */
+  static readonly Base64RunLengthZstandard: unique symbol
+
   static readonly RightDown: unique symbol
   static readonly RightUp: unique symbol
   static readonly LeftDown: unique symbol
@@ -2837,7 +3009,7 @@ declare class TileMap extends Asset {
   /**
    * The format in which the layer data is stored, taken into account by TMX, JSON and Lua map formats.
    */
-  layerDataFormat : typeof TileMap.XML | typeof TileMap.Base64 | typeof TileMap.Base64Gzip | typeof TileMap.Base64Zlib | typeof TileMap.Base64Zstandard | typeof TileMap.CSV
+  layerDataFormat : typeof TileMap.XML | typeof TileMap.Base64 | typeof TileMap.Base64Gzip | typeof TileMap.Base64Zlib | typeof TileMap.Base64Zstandard | typeof TileMap.CSV | typeof TileMap.Base64RunLength | typeof TileMap.Base64RunLengthZstandard
 
   /**
    * Number of top-level layers the map has.
@@ -3186,6 +3358,22 @@ declare class TileLayer extends Layer {
    */
   tileAt(x : number, y : number) : Tile | null
 
+  /**
+   * Returns the global tile IDs of the cells in the given area, row by row.
+   * Each ID is a 32-bit unsigned integer that refers to the tilesets of the
+   * map this layer is part of, in the same way as in the TMX and JSON
+   * formats, including the flipping flags. Empty cells have ID 0.
+   *
+   * This is a lot faster than calling {@link tileAt} for each cell:
+   *
+   * ```js
+   * const gids = new Uint32Array(layer.gids(Qt.rect(0, 0, 100, 100)))
+   * ```
+   *
+   * @since 1.11
+   */
+  gids(rect : rect) : ArrayBuffer
+
   /**
    * Returns an object that enables making modifications to the tile layer.
    */
@@ -3234,6 +3422,19 @@ interface TileLayerEdit {
    */
   setTile(x : number, y : number, tile : Tile | null, flags? : number) : void
 
+  /**
+   * Sets the cells in the given area to the given global tile IDs, given row
+   * by row. The IDs refer to the tilesets of the map the target layer is part
+   * of (see {@link TileLayer.gids}). An ID of 0 erases the cell.
+   *
+   * The IDs can be passed as a `Uint32Array`, an `ArrayBuffer` or an array
+   * of numbers. This is a lot faster than calling {@link setTile} for each
+   * cell.
+   *
+   * @since 1.11
+   */
+  setGids(rect : rect, gids : Uint32Array | ArrayBuffer | number[]) : void
+
   /**
    * Applies the changes made through this object to the target layer. This
    * object can be reused to make further changes.
@@ -4719,6 +4920,62 @@ declare namespace tiled {
    */
   export function unloadAllWorlds() : void;
 
+  /**
+   * Starts recording the time spent in scripts. Any previously recorded
+   * profile is discarded.
+   *
+   * While profiling, Tiled records each evaluated script, triggered action,
+   * scripted tool callback and scripted file format call, along with the
+   * extension that registered it and the number of wrapper objects (like
+   * {@link MapObject} or {@link Tile} instances) created during the call.
+   *
+   * @since 1.11
+   */
+  export function startProfiling() : void;
+
+  /**
+   * Stops recording and prints a summary of the recorded profile to the
+   * console, listing the time spent per extension and per callback, as
+   * well as the number of wrapper objects currently alive.
+   *
+   * @since 1.11
+   */
+  export function stopProfiling() : void;
+
+  /**
+   * Saves the recorded profile to the given file, in the Chrome trace event
+   * format. The file can be viewed in `chrome://tracing` or
+   * https://ui.perfetto.dev.
+   *
+   * @since 1.11
+   */
+  export function saveProfile(fileName : string) : boolean;
+
+  /**
+   * Returns a report of the approximate amount of memory used by the given
+   * open asset, or by all open assets and the caches shared between them
+   * when no asset is given.
+   *
+   * Each entry of the report has a `name`, a size in `bytes` (`-1` when not
+   * known) and optionally a `count` of items and a list of `children`. The
+   * size of an entry includes the size of its children. Images may be shared
+   * between tilesets and the image cache, in which case they are counted
+   * for each use.
+   *
+   * @since 1.11
+   */
+  export function memoryReport(asset?: Asset) : MemoryReportEntry;
+
+  /**
+   * Compares two maps and returns their differences. Layers are matched by
+   * their ID and objects by their ID within their layer.
+   *
+   * The same comparison is available on the command line as `--diff-maps`.
+   *
+   * @since 1.11
+   */
+  export function compareMaps(oldMap: TileMap, newMap: TileMap) : MapDiff;
+
   /**
    * Signal emitted when any world is loaded, unloaded, reloaded or changed.
    * @since 1.10.3
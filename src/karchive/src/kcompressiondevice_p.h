@@ -7,7 +7,7 @@
 #ifndef __kcompressiondevice_p_h
 #define __kcompressiondevice_p_h
 
-#define BUFFER_SIZE 8*1024
+#define BUFFER_SIZE 64*1024
 #define SEEK_BUFFER_SIZE 3*BUFFER_SIZE
 
 #endif
@@ -0,0 +1,163 @@
+/*
+ * base64.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base64.h"
+
+#include <array>
+#include <cstring>
+
+namespace Tiled {
+namespace Base64 {
+
+static constexpr char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// The two characters encoding each 12-bit value, which allows encoding
+// three bytes with two lookups
+static constexpr auto characterPairs = [] {
+    std::array<char, 4096 * 2> pairs {};
+    for (int i = 0; i < 4096; ++i) {
+        pairs[i * 2] = alphabet[i >> 6];
+        pairs[i * 2 + 1] = alphabet[i & 63];
+    }
+    return pairs;
+}();
+
+// The value of each character, or -1 for characters outside the alphabet
+static constexpr auto characterValues = [] {
+    std::array<signed char, 256> values {};
+    for (auto &value : values)
+        value = -1;
+    for (int i = 0; i < 64; ++i)
+        values[static_cast<uchar>(alphabet[i])] = static_cast<signed char>(i);
+    return values;
+}();
+
+static inline void writeGroup(quint32 group, char *out)
+{
+    out[0] = static_cast<char>(group >> 16);
+    out[1] = static_cast<char>(group >> 8);
+    out[2] = static_cast<char>(group);
+}
+
+void encode(const char *data, qsizetype size, char *out)
+{
+    auto in = reinterpret_cast<const uchar*>(data);
+    const auto fullGroupsEnd = in + (size - size % 3);
+
+    for (; in != fullGroupsEnd; in += 3, out += 4) {
+        const quint32 group = quint32(in[0]) << 16 | quint32(in[1]) << 8 | quint32(in[2]);
+        std::memcpy(out, &characterPairs[(group >> 12) * 2], 2);
+        std::memcpy(out + 2, &characterPairs[(group & 0xfff) * 2], 2);
+    }
+
+    switch (size % 3) {
+    case 1: {
+        const quint32 group = quint32(in[0]) << 16;
+        out[0] = alphabet[group >> 18];
+        out[1] = alphabet[(group >> 12) & 63];
+        out[2] = '=';
+        out[3] = '=';
+        break;
+    }
+    case 2: {
+        const quint32 group = quint32(in[0]) << 16 | quint32(in[1]) << 8;
+        out[0] = alphabet[group >> 18];
+        out[1] = alphabet[(group >> 12) & 63];
+        out[2] = alphabet[(group >> 6) & 63];
+        out[3] = '=';
+        break;
+    }
+    }
+}
+
+qsizetype decode(const char *data, qsizetype size, char *out)
+{
+    auto in = reinterpret_cast<const uchar*>(data);
+    const auto end = in + size;
+    char *const start = out;
+
+    quint32 bits = 0;
+    int count = 0;
+
+    while (in != end) {
+        // Decode uninterrupted groups of four characters at once
+        if (count == 0 && end - in >= 4) {
+            const int a = characterValues[in[0]];
+            const int b = characterValues[in[1]];
+            const int c = characterValues[in[2]];
+            const int d = characterValues[in[3]];
+
+            if ((a | b | c | d) >= 0) {
+                writeGroup(quint32(a) << 18 | quint32(b) << 12 | quint32(c) << 6 | quint32(d), out);
+                out += 3;
+                in += 4;
+                continue;
+            }
+        }
+
+        const int value = characterValues[*in++];
+        if (value < 0)
+            continue;
+
+        bits = bits << 6 | quint32(value);
+        if (++count == 4) {
+            writeGroup(bits, out);
+            out += 3;
+            bits = 0;
+            count = 0;
+        }
+    }
+
+    // Remaining bits of an incomplete group
+    if (count == 2) {
+        *out++ = static_cast<char>(bits >> 4);
+    } else if (count == 3) {
+        *out++ = static_cast<char>(bits >> 10);
+        *out++ = static_cast<char>(bits >> 2);
+    }
+
+    return out - start;
+}
+
+QByteArray encode(const QByteArray &data)
+{
+    QByteArray result(encodedSize(data.size()), Qt::Uninitialized);
+    encode(data.constData(), data.size(), result.data());
+    return result;
+}
+
+QByteArray decode(const QByteArray &data)
+{
+    QByteArray result(maxDecodedSize(data.size()), Qt::Uninitialized);
+    result.truncate(decode(data.constData(), data.size(), result.data()));
+    return result;
+}
+
+} // namespace Base64
+} // namespace Tiled
@@ -0,0 +1,83 @@
+/*
+ * base64.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QByteArray>
+
+namespace Tiled {
+namespace Base64 {
+
+/**
+ * Returns the number of characters of the padded base64 encoding of
+ * \a size bytes.
+ */
+constexpr qsizetype encodedSize(qsizetype size)
+{
+    return (size + 2) / 3 * 4;
+}
+
+/**
+ * Returns the maximum number of bytes decoded from \a size base64
+ * characters.
+ */
+constexpr qsizetype maxDecodedSize(qsizetype size)
+{
+    return size / 4 * 3 + 2;
+}
+
+/**
+ * Encodes \a size bytes of \a data as padded base64 into \a out, which
+ * needs room for encodedSize(size) characters.
+ */
+TILEDSHARED_EXPORT void encode(const char *data, qsizetype size, char *out);
+
+/**
+ * Decodes \a size base64 characters of \a data into \a out, which needs
+ * room for maxDecodedSize(size) bytes. Returns the number of decoded bytes.
+ *
+ * Like QByteArray::fromBase64, characters outside of the base64 alphabet,
+ * like whitespace and padding, are skipped.
+ */
+TILEDSHARED_EXPORT qsizetype decode(const char *data, qsizetype size, char *out);
+
+/**
+ * Returns the base64 encoding of \a data. Equivalent to QByteArray::toBase64.
+ */
+TILEDSHARED_EXPORT QByteArray encode(const QByteArray &data);
+
+/**
+ * Returns the data decoded from base64 encoded \a data. Equivalent to
+ * QByteArray::fromBase64.
+ */
+TILEDSHARED_EXPORT QByteArray decode(const QByteArray &data);
+
+} // namespace Base64
+} // namespace Tiled
@@ -35,11 +35,14 @@
 #endif
 #ifdef TILED_ZSTD_SUPPORT
 #include <zstd.h>      // presumes zstd library is installed
+#include <zdict.h>
 #endif
 
 #include <QByteArray>
 #include <QDebug>
 
+#include <vector>
+
 #ifdef Z_PREFIX
 #undef compress
 #endif
@@ -66,85 +69,269 @@ static void logZlibError(int error)
     }
 }
 
-bool Tiled::compressionSupported(CompressionMethod method)
+struct CompressionContext::Private
 {
-    switch (method) {
-    case Gzip:
-    case Zlib:
+    ~Private()
+    {
+        if (inflateInitialized)
+            inflateEnd(&inflateStream);
+        if (deflateInitialized)
+            deflateEnd(&deflateStream);
 #ifdef TILED_ZSTD_SUPPORT
-    case Zstandard:
+        ZSTD_freeCDict(cdict);
+        ZSTD_freeDDict(ddict);
+        ZSTD_freeCCtx(cctx);
+        ZSTD_freeDCtx(dctx);
 #endif
-        return true;
-    default:
-        return false;
     }
+
+    z_stream *inflater();
+    z_stream *deflater(int windowBits, int compressionLevel);
+
+    z_stream inflateStream;
+    z_stream deflateStream;
+    bool inflateInitialized = false;
+    bool deflateInitialized = false;
+    int deflateWindowBits = 0;
+    int deflateLevel = 0;
+
+#ifdef TILED_ZSTD_SUPPORT
+    ZSTD_CCtx *compressionContext();
+    ZSTD_DCtx *decompressionContext();
+    const ZSTD_CDict *compressionDictionary(const QByteArray &dictionary,
+                                            int compressionLevel);
+    const ZSTD_DDict *decompressionDictionary(const QByteArray &dictionary);
+
+    size_t zstdDecompress(const QByteArray &data, char *out, int size,
+                          const QByteArray &dictionary);
+
+    // Digesting a dictionary is relatively expensive, so the digested
+    // dictionaries are kept around as well.
+    ZSTD_CCtx *cctx = nullptr;
+    ZSTD_DCtx *dctx = nullptr;
+    ZSTD_CDict *cdict = nullptr;
+    ZSTD_DDict *ddict = nullptr;
+    QByteArray cdictData;
+    QByteArray ddictData;
+    int cdictLevel = 0;
+#endif
+};
+
+/**
+ * Returns the inflate stream, ready to decompress either zlib or gzip
+ * compressed data. Returns nullptr when it could not be initialized.
+ */
+z_stream *CompressionContext::Private::inflater()
+{
+    if (inflateInitialized) {
+        inflateReset(&inflateStream);
+        return &inflateStream;
+    }
+
+    inflateStream.zalloc = Z_NULL;
+    inflateStream.zfree = Z_NULL;
+    inflateStream.opaque = Z_NULL;
+    inflateStream.next_in = Z_NULL;
+    inflateStream.avail_in = 0;
+
+    const int ret = inflateInit2(&inflateStream, 15 + 32);
+    if (ret != Z_OK) {
+        logZlibError(ret);
+        return nullptr;
+    }
+
+    inflateInitialized = true;
+    return &inflateStream;
 }
 
-QByteArray Tiled::decompress(const QByteArray &data,
-                             int expectedSize,
-                             CompressionMethod method)
+/**
+ * Returns the deflate stream, set up for the given \a windowBits and
+ * \a compressionLevel. The stream is only initialized again when these
+ * parameters change. Returns nullptr when it could not be initialized.
+ */
+z_stream *CompressionContext::Private::deflater(int windowBits, int compressionLevel)
+{
+    if (deflateInitialized) {
+        if (deflateWindowBits == windowBits && deflateLevel == compressionLevel) {
+            deflateReset(&deflateStream);
+            return &deflateStream;
+        }
+
+        deflateEnd(&deflateStream);
+        deflateInitialized = false;
+    }
+
+    deflateStream.zalloc = Z_NULL;
+    deflateStream.zfree = Z_NULL;
+    deflateStream.opaque = Z_NULL;
+
+    const int err = deflateInit2(&deflateStream, compressionLevel, Z_DEFLATED,
+                                 windowBits, 8, Z_DEFAULT_STRATEGY);
+    if (err != Z_OK) {
+        logZlibError(err);
+        return nullptr;
+    }
+
+    deflateInitialized = true;
+    deflateWindowBits = windowBits;
+    deflateLevel = compressionLevel;
+    return &deflateStream;
+}
+
+#ifdef TILED_ZSTD_SUPPORT
+// Usually the same implicitly shared dictionary is passed for each call
+static bool isSame(const QByteArray &a, const QByteArray &b)
+{
+    return (a.constData() == b.constData() && a.size() == b.size()) || a == b;
+}
+
+ZSTD_CCtx *CompressionContext::Private::compressionContext()
+{
+    if (!cctx)
+        cctx = ZSTD_createCCtx();
+    return cctx;
+}
+
+ZSTD_DCtx *CompressionContext::Private::decompressionContext()
+{
+    if (!dctx)
+        dctx = ZSTD_createDCtx();
+    return dctx;
+}
+
+const ZSTD_CDict *CompressionContext::Private::compressionDictionary(const QByteArray &dictionary,
+                                                                     int compressionLevel)
+{
+    if (!cdict || cdictLevel != compressionLevel || !isSame(cdictData, dictionary)) {
+        ZSTD_freeCDict(cdict);
+        cdict = ZSTD_createCDict(dictionary.constData(), dictionary.size(), compressionLevel);
+        cdictData = dictionary;
+        cdictLevel = compressionLevel;
+    }
+    return cdict;
+}
+
+const ZSTD_DDict *CompressionContext::Private::decompressionDictionary(const QByteArray &dictionary)
+{
+    if (!ddict || !isSame(ddictData, dictionary)) {
+        ZSTD_freeDDict(ddict);
+        ddict = ZSTD_createDDict(dictionary.constData(), dictionary.size());
+        ddictData = dictionary;
+    }
+    return ddict;
+}
+
+/**
+ * Decompresses Zstandard compressed \a data into \a out, which has room for
+ * \a size bytes. Returns the decompressed size or a zstd error code.
+ */
+size_t CompressionContext::Private::zstdDecompress(const QByteArray &data,
+                                                   char *out, int size,
+                                                   const QByteArray &dictionary)
+{
+    ZSTD_DCtx *context = decompressionContext();
+    if (!context)
+        return ZSTD_decompress(out, size, data.constData(), data.size());
+
+    if (dictionary.isEmpty())
+        return ZSTD_decompressDCtx(context, out, size, data.constData(), data.size());
+
+    const ZSTD_DDict *digestedDictionary = decompressionDictionary(dictionary);
+    if (!digestedDictionary) {
+        qDebug() << "error loading dictionary";
+        return ZSTD_decompress_usingDict(context, out, size,
+                                         data.constData(), data.size(),
+                                         dictionary.constData(), dictionary.size());
+    }
+
+    return ZSTD_decompress_usingDDict(context, out, size,
+                                      data.constData(), data.size(),
+                                      digestedDictionary);
+}
+#endif // TILED_ZSTD_SUPPORT
+
+
+CompressionContext::CompressionContext()
+    : d(std::make_unique<Private>())
+{
+}
+
+CompressionContext::~CompressionContext() = default;
+
+/**
+ * Returns a context owned by the calling thread, which is used by the
+ * Tiled::compress() and Tiled::decompress() functions.
+ */
+CompressionContext &CompressionContext::forCurrentThread()
+{
+    thread_local CompressionContext context;
+    return context;
+}
+
+/**
+ * Decompresses \a data like Tiled::decompress(), reusing the state of this
+ * context.
+ */
+QByteArray CompressionContext::decompress(const QByteArray &data,
+                                          int expectedSize,
+                                          CompressionMethod method,
+                                          const QByteArray &dictionary)
 {
     if (data.isEmpty())
         return QByteArray();
 
     QByteArray out;
-    out.resize(expectedSize);
+    out.resize(qMax(expectedSize, 1));
     if (method == Zlib || method == Gzip) {
-        z_stream strm;
-
-        strm.zalloc = Z_NULL;
-        strm.zfree = Z_NULL;
-        strm.opaque = Z_NULL;
-        strm.next_in = (Bytef *) data.data();
-        strm.avail_in = data.length();
-        strm.next_out = (Bytef *) out.data();
-        strm.avail_out = out.size();
+        z_stream *strm = d->inflater();
+        if (!strm)
+            return QByteArray();
 
-        int ret = inflateInit2(&strm, 15 + 32);
+        strm->next_in = (Bytef *) data.data();
+        strm->avail_in = data.length();
+        strm->next_out = (Bytef *) out.data();
+        strm->avail_out = out.size();
 
-        if (ret != Z_OK) {
-            logZlibError(ret);
-            return QByteArray();
-        }
+        int ret;
 
         do {
-            ret = inflate(&strm, Z_SYNC_FLUSH);
+            ret = inflate(strm, Z_SYNC_FLUSH);
             Q_ASSERT(ret != Z_STREAM_ERROR);
 
+            // No progress is possible when the input is truncated
+            if (ret == Z_BUF_ERROR && strm->avail_in == 0)
+                ret = Z_DATA_ERROR;
+
             switch (ret) {
                 case Z_NEED_DICT:
                     ret = Z_DATA_ERROR;
                     [[fallthrough]];
                 case Z_DATA_ERROR:
                 case Z_MEM_ERROR:
-                    inflateEnd(&strm);
                     logZlibError(ret);
                     return QByteArray();
             }
 
-            if (ret != Z_STREAM_END) {
+            if (ret != Z_STREAM_END && strm->avail_out == 0) {
                 int oldSize = out.size();
                 out.resize(oldSize * 2);
 
-                strm.next_out = (Bytef *)(out.data() + oldSize);
-                strm.avail_out = oldSize;
+                strm->next_out = (Bytef *)(out.data() + oldSize);
+                strm->avail_out = oldSize;
             }
         }
         while (ret != Z_STREAM_END);
 
-        if (strm.avail_in != 0) {
+        if (strm->avail_in != 0) {
             logZlibError(Z_DATA_ERROR);
             return QByteArray();
         }
 
-        const int outLength = out.size() - strm.avail_out;
-        inflateEnd(&strm);
-
-        out.resize(outLength);
+        out.resize(out.size() - strm->avail_out);
         return out;
 #ifdef TILED_ZSTD_SUPPORT
     } else if (method == Zstandard) {
-        size_t const dSize = ZSTD_decompress(out.data(), out.size(), data.constData(), data.size());
+        const size_t dSize = d->zstdDecompress(data, out.data(), out.size(), dictionary);
         if (ZSTD_isError(dSize)) {
             qDebug() << "error decoding:" << ZSTD_getErrorName(dSize);
             return QByteArray();
@@ -158,9 +345,65 @@ QByteArray Tiled::decompress(const QByteArray &data,
     }
 }
 
-QByteArray Tiled::compress(const QByteArray &data,
-                           CompressionMethod method,
-                           int compressionLevel)
+/**
+ * Decompresses \a data directly into \a out, which needs to point to a
+ * buffer of \a size bytes. Useful when the size of the uncompressed data is
+ * known up front, since it avoids allocating and copying any output.
+ *
+ * Returns whether the data was successfully decompressed to exactly
+ * \a size bytes.
+ */
+bool CompressionContext::decompressInto(const QByteArray &data,
+                                        char *out, int size,
+                                        CompressionMethod method,
+                                        const QByteArray &dictionary)
+{
+    if (data.isEmpty())
+        return false;
+
+    if (method == Zlib || method == Gzip) {
+        z_stream *strm = d->inflater();
+        if (!strm)
+            return false;
+
+        strm->next_in = (Bytef *) data.data();
+        strm->avail_in = data.length();
+        strm->next_out = (Bytef *) out;
+        strm->avail_out = size;
+
+        const int ret = inflate(strm, Z_FINISH);
+        Q_ASSERT(ret != Z_STREAM_ERROR);
+
+        if (ret != Z_STREAM_END) {
+            // Either the data is corrupt or it does not fit the buffer
+            logZlibError(ret == Z_BUF_ERROR ? Z_DATA_ERROR : ret);
+            return false;
+        }
+
+        return strm->avail_in == 0 && strm->avail_out == 0;
+#ifdef TILED_ZSTD_SUPPORT
+    } else if (method == Zstandard) {
+        const size_t dSize = d->zstdDecompress(data, out, size, dictionary);
+        if (ZSTD_isError(dSize)) {
+            qDebug() << "error decoding:" << ZSTD_getErrorName(dSize);
+            return false;
+        }
+        return dSize == static_cast<size_t>(size);
+#endif
+    } else {
+        qDebug() << "compression not supported:" << method;
+        return false;
+    }
+}
+
+/**
+ * Compresses \a data like Tiled::compress(), reusing the state of this
+ * context.
+ */
+QByteArray CompressionContext::compress(const QByteArray &data,
+                                        CompressionMethod method,
+                                        int compressionLevel,
+                                        const QByteArray &dictionary)
 {
     if (data.isEmpty())
         return QByteArray();
@@ -171,51 +414,44 @@ QByteArray Tiled::compress(const QByteArray &data,
         else
             compressionLevel = qBound(Z_BEST_SPEED, compressionLevel, Z_BEST_COMPRESSION);
 
-        QByteArray out;
-        out.resize(1024);
-        int err;
-        z_stream strm;
-        strm.zalloc = Z_NULL;
-        strm.zfree = Z_NULL;
-        strm.opaque = Z_NULL;
-        strm.next_in = (Bytef *) data.data();
-        strm.avail_in = data.length();
-        strm.next_out = (Bytef *) out.data();
-        strm.avail_out = out.size();
-
         const int windowBits = (method == Gzip) ? 15 + 16 : 15;
 
-        err = deflateInit2(&strm, compressionLevel, Z_DEFLATED, windowBits,
-                           8, Z_DEFAULT_STRATEGY);
-        if (err != Z_OK) {
-            logZlibError(err);
+        z_stream *strm = d->deflater(windowBits, compressionLevel);
+        if (!strm)
             return QByteArray();
-        }
+
+        // Usually avoids the need to grow the output
+        QByteArray out;
+        out.resize(static_cast<int>(deflateBound(strm, data.length())));
+
+        strm->next_in = (Bytef *) data.data();
+        strm->avail_in = data.length();
+        strm->next_out = (Bytef *) out.data();
+        strm->avail_out = out.size();
+
+        int err;
 
         do {
-            err = deflate(&strm, Z_FINISH);
+            err = deflate(strm, Z_FINISH);
             Q_ASSERT(err != Z_STREAM_ERROR);
 
-            if (err == Z_OK) {
+            if (err == Z_OK || (err == Z_BUF_ERROR && strm->avail_out == 0)) {
                 // More output space needed
                 int oldSize = out.size();
                 out.resize(out.size() * 2);
 
-                strm.next_out = (Bytef *)(out.data() + oldSize);
-                strm.avail_out = oldSize;
+                strm->next_out = (Bytef *)(out.data() + oldSize);
+                strm->avail_out = oldSize;
+                err = Z_OK;
             }
         } while (err == Z_OK);
 
         if (err != Z_STREAM_END) {
             logZlibError(err);
-            deflateEnd(&strm);
             return QByteArray();
         }
 
-        const int outLength = out.size() - strm.avail_out;
-        deflateEnd(&strm);
-
-        out.resize(outLength);
+        out.resize(out.size() - strm->avail_out);
         return out;
 #ifdef TILED_ZSTD_SUPPORT
     } else if (method == Zstandard) {
@@ -229,7 +465,29 @@ QByteArray Tiled::compress(const QByteArray &data,
         QByteArray out;
         out.resize(cBuffSize);
 
-        size_t const cSize = ZSTD_compress(out.data(), cBuffSize, data.constData(), data.size(), compressionLevel);
+        size_t cSize;
+        ZSTD_CCtx *context = d->compressionContext();
+
+        if (!context) {
+            cSize = ZSTD_compress(out.data(), cBuffSize, data.constData(), data.size(), compressionLevel);
+        } else if (dictionary.isEmpty()) {
+            cSize = ZSTD_compressCCtx(context,
+                                      out.data(), cBuffSize,
+                                      data.constData(), data.size(),
+                                      compressionLevel);
+        } else {
+            const ZSTD_CDict *cdict = d->compressionDictionary(dictionary, compressionLevel);
+            if (!cdict) {
+                qDebug() << "error loading dictionary";
+                return QByteArray();
+            }
+
+            cSize = ZSTD_compress_usingCDict(context,
+                                             out.data(), cBuffSize,
+                                             data.constData(), data.size(),
+                                             cdict);
+        }
+
         if (ZSTD_isError(cSize)) {
             qDebug() << "error compressing:" << ZSTD_getErrorName(cSize);
             return QByteArray();
@@ -243,3 +501,77 @@ QByteArray Tiled::compress(const QByteArray &data,
         return QByteArray();
     }
 }
+
+
+bool Tiled::compressionSupported(CompressionMethod method)
+{
+    switch (method) {
+    case Gzip:
+    case Zlib:
+#ifdef TILED_ZSTD_SUPPORT
+    case Zstandard:
+#endif
+        return true;
+    default:
+        return false;
+    }
+}
+
+QByteArray Tiled::decompress(const QByteArray &data,
+                             int expectedSize,
+                             CompressionMethod method,
+                             const QByteArray &dictionary)
+{
+    return CompressionContext::forCurrentThread().decompress(data, expectedSize,
+                                                             method, dictionary);
+}
+
+QByteArray Tiled::compress(const QByteArray &data,
+                           CompressionMethod method,
+                           int compressionLevel,
+                           const QByteArray &dictionary)
+{
+    return CompressionContext::forCurrentThread().compress(data, method,
+                                                           compressionLevel,
+                                                           dictionary);
+}
+
+QByteArray Tiled::trainCompressionDictionary(const QVector<QByteArray> &samples,
+                                             int maxSize)
+{
+#ifdef TILED_ZSTD_SUPPORT
+    QByteArray samplesBuffer;
+    std::vector<size_t> sampleSizes;
+    sampleSizes.reserve(samples.size());
+
+    for (const QByteArray &sample : samples) {
+        if (sample.isEmpty())
+            continue;
+
+        samplesBuffer.append(sample);
+        sampleSizes.push_back(sample.size());
+    }
+
+    if (sampleSizes.empty())
+        return QByteArray();
+
+    QByteArray dictionary;
+    dictionary.resize(maxSize);
+
+    const size_t size = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(),
+                                              samplesBuffer.constData(),
+                                              sampleSizes.data(),
+                                              static_cast<unsigned>(sampleSizes.size()));
+    if (ZDICT_isError(size)) {
+        qDebug() << "error training dictionary:" << ZDICT_getErrorName(size);
+        return QByteArray();
+    }
+
+    dictionary.resize(size);
+    return dictionary;
+#else
+    Q_UNUSED(samples)
+    Q_UNUSED(maxSize)
+    return QByteArray();
+#endif
+}
@@ -30,6 +30,10 @@
 
 #include "tiled_global.h"
 
+#include <QVector>
+
+#include <memory>
+
 class QByteArray;
 
 namespace Tiled {
@@ -55,13 +59,19 @@ bool TILEDSHARED_EXPORT compressionSupported(CompressionMethod method);
  * this method does not need the expected size to be prepended to the data,
  * but it can be passed as optional parameter.
  *
+ * A \a dictionary can be given for Zstandard compressed data, which needs
+ * to be the one that was used to compress the data.
+ *
+ * Uses the CompressionContext of the calling thread.
+ *
  * @param data         the compressed data
  * @param expectedSize the expected size of the uncompressed data in bytes
  * @return the uncompressed data, or a null QByteArray if decompressing failed
  */
 QByteArray TILEDSHARED_EXPORT decompress(const QByteArray &data,
                                          int expectedSize,
-                                         CompressionMethod method = Zlib);
+                                         CompressionMethod method = Zlib,
+                                         const QByteArray &dictionary = QByteArray());
 
 /**
  * Compresses the give data in either gzip or zlib format. Returns a null
@@ -69,11 +79,65 @@ QByteArray TILEDSHARED_EXPORT decompress(const QByteArray &data,
  *
  * Needed because qCompress does not support gzip compression.
  *
+ * A \a dictionary can be given for Zstandard compression, which is
+ * especially effective for small amounts of data. It is ignored for the
+ * other methods.
+ *
+ * Uses the CompressionContext of the calling thread.
+ *
  * @param data the uncompressed data
  * @return the compressed data, or a null QByteArray if compression failed
  */
 QByteArray TILEDSHARED_EXPORT compress(const QByteArray &data,
                                        CompressionMethod method,
-                                       int compressionLevel = -1);
+                                       int compressionLevel = -1,
+                                       const QByteArray &dictionary = QByteArray());
+
+/**
+ * Keeps the zlib and Zstandard state around between calls, so that
+ * compressing or decompressing many small blocks of data (like the chunks of
+ * an infinite map) does not need to set up and tear down that state each
+ * time.
+ *
+ * A context is not thread-safe. Use forCurrentThread() to get a context that
+ * can be used by the calling thread.
+ */
+class TILEDSHARED_EXPORT CompressionContext
+{
+public:
+    CompressionContext();
+    ~CompressionContext();
+
+    QByteArray decompress(const QByteArray &data,
+                          int expectedSize,
+                          CompressionMethod method = Zlib,
+                          const QByteArray &dictionary = QByteArray());
+
+    bool decompressInto(const QByteArray &data,
+                        char *out, int size,
+                        CompressionMethod method = Zlib,
+                        const QByteArray &dictionary = QByteArray());
+
+    QByteArray compress(const QByteArray &data,
+                        CompressionMethod method,
+                        int compressionLevel = -1,
+                        const QByteArray &dictionary = QByteArray());
+
+    static CompressionContext &forCurrentThread();
+
+private:
+    Q_DISABLE_COPY(CompressionContext)
+
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+/**
+ * Trains a Zstandard dictionary of at most \a maxSize bytes on the given
+ * \a samples. Returns a null QByteArray when Zstandard is not supported or
+ * when training failed, for example because there was too little data.
+ */
+QByteArray TILEDSHARED_EXPORT trainCompressionDictionary(const QVector<QByteArray> &samples,
+                                                         int maxSize = 16 * 1024);
 
 } // namespace Tiled
@@ -30,6 +30,7 @@
 
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
 #include <QFileSystemWatcher>
 #include <QStringList>
 
@@ -61,7 +62,7 @@ void FileSystemWatcher::setEnabled(bool enabled)
     if (enabled) {
         const auto files = mWatchCount.keys();
         if (!files.isEmpty())
-            mWatcher->addPaths(files);
+            watchPaths(files);
     } else {
         clearInternal();
         mChangedPathsTimer.stop();
@@ -78,9 +79,14 @@ void FileSystemWatcher::addPaths(const QStringList &paths)
         if (!QFile::exists(path))
             continue;
 
+        // Files in resources, like a packed resource archive, never change
+        if (path.startsWith(QLatin1Char(':')))
+            continue;
+
         QMap<QString, int>::iterator entry = mWatchCount.find(path);
         if (entry == mWatchCount.end()) {
-            if (mEnabled)
+            // Directories may already be watched on behalf of their files
+            if (mEnabled && !mFilesByDirectory.contains(path))
                 pathsToAdd.append(path);
 
             mWatchCount.insert(path, 1);
@@ -91,7 +97,7 @@ void FileSystemWatcher::addPaths(const QStringList &paths)
     }
 
     if (!pathsToAdd.isEmpty())
-        mWatcher->addPaths(pathsToAdd);
+        watchPaths(pathsToAdd);
 }
 
 void FileSystemWatcher::removePaths(const QStringList &paths)
@@ -100,6 +106,9 @@ void FileSystemWatcher::removePaths(const QStringList &paths)
     pathsToRemove.reserve(paths.size());
 
     for (const QString &path : paths) {
+        if (path.startsWith(QLatin1Char(':')))
+            continue;   // never added, see addPaths
+
         QMap<QString, int>::iterator entry = mWatchCount.find(path);
         if (entry == mWatchCount.end()) {
             if (QFile::exists(path))
@@ -113,7 +122,7 @@ void FileSystemWatcher::removePaths(const QStringList &paths)
         if (entry.value() == 0) {
             mWatchCount.erase(entry);
 
-            if (mEnabled)
+            if (mEnabled && !unwatchThroughDirectory(path) && !mFilesByDirectory.contains(path))
                 pathsToRemove.append(path);
         }
     }
@@ -131,6 +140,61 @@ void FileSystemWatcher::clearInternal()
     const QStringList directories = mWatcher->directories();
     if (!directories.isEmpty())
         mWatcher->removePaths(directories);
+
+    mFilesByDirectory.clear();
+}
+
+/**
+ * Adds the given \a paths to the underlying watcher. Files that fail to be
+ * added are watched through their directory instead.
+ */
+void FileSystemWatcher::watchPaths(const QStringList &paths)
+{
+    const QStringList failedPaths = mWatcher->addPaths(paths);
+
+    for (const QString &path : failedPaths)
+        if (QFileInfo(path).isFile())
+            watchThroughDirectory(path);
+}
+
+void FileSystemWatcher::watchThroughDirectory(const QString &path)
+{
+    const QFileInfo fileInfo(path);
+    const QString directory = fileInfo.path();
+
+    auto &files = mFilesByDirectory[directory];
+    if (files.isEmpty() && !mWatchCount.contains(directory))
+        mWatcher->addPath(directory);
+
+    files.insert(path, fileInfo.lastModified());
+}
+
+/**
+ * Stops watching the given file through its directory. Returns whether the
+ * file was being watched that way.
+ */
+bool FileSystemWatcher::unwatchThroughDirectory(const QString &path)
+{
+    const QString directory = QFileInfo(path).path();
+
+    auto it = mFilesByDirectory.find(directory);
+    if (it == mFilesByDirectory.end() || !it->remove(path))
+        return false;
+
+    if (it->isEmpty()) {
+        mFilesByDirectory.erase(it);
+
+        if (!mWatchCount.contains(directory))
+            mWatcher->removePath(directory);
+    }
+
+    return true;
+}
+
+bool FileSystemWatcher::isWatchedThroughDirectory(const QString &path) const
+{
+    auto it = mFilesByDirectory.constFind(QFileInfo(path).path());
+    return it != mFilesByDirectory.constEnd() && it->contains(path);
 }
 
 void FileSystemWatcher::clear()
@@ -149,6 +213,26 @@ void FileSystemWatcher::onFileChanged(const QString &path)
 
 void FileSystemWatcher::onDirectoryChanged(const QString &path)
 {
+    auto it = mFilesByDirectory.find(path);
+    if (it != mFilesByDirectory.end()) {
+        QStringList changedFiles;
+
+        for (auto file = it->begin(), end = it->end(); file != end; ++file) {
+            const QDateTime lastModified = QFileInfo(file.key()).lastModified();
+            if (file.value() != lastModified) {
+                file.value() = lastModified;
+                changedFiles.append(file.key());
+            }
+        }
+
+        for (const QString &file : std::as_const(changedFiles))
+            onFileChanged(file);
+    }
+
+    // The directory may only be watched on behalf of its files
+    if (!mWatchCount.contains(path))
+        return;
+
     mChangedPaths.insert(path);
     mChangedPathsTimer.start();
 
@@ -162,13 +246,25 @@ void FileSystemWatcher::pathsChangedTimeout()
     // If the file was replaced, the watcher is automatically removed and needs
     // to be re-added to keep watching it for changes. This happens commonly
     // with applications that do atomic saving.
+    const QStringList files = mWatcher->files();
+    QSet<QString> watchedFiles;
+    watchedFiles.reserve(files.size());
+    for (const QString &file : files)
+        watchedFiles.insert(file);
+
+    QStringList pathsToAdd;
+
     for (const QString &path : changedPaths) {
-        if (mWatchCount.contains(path) && !mWatcher->files().contains(path)) {
-            if (QFile::exists(path))
-                mWatcher->addPath(path);
+        if (mWatchCount.contains(path) &&
+                !watchedFiles.contains(path) &&
+                !isWatchedThroughDirectory(path) &&
+                QFile::exists(path)) {
+            pathsToAdd.append(path);
         }
     }
 
+    if (!pathsToAdd.isEmpty())
+        watchPaths(pathsToAdd);
 
     emit pathsChanged(changedPaths);
 
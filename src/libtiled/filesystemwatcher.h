@@ -30,6 +30,8 @@
 
 #include "tiled_global.h"
 
+#include <QDateTime>
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QSet>
@@ -48,7 +50,14 @@ namespace Tiled {
  *
  * Optionally, the 'pathsChanged' signal can be used, which triggers at a delay
  * to avoid problems occurring when trying to reload only partially written
- * files, as well as avoiding fast consecutive reloads.
+ * files, as well as avoiding fast consecutive reloads. All changes happening
+ * until things have been quiet for the duration of the delay are reported at
+ * once, so that for example a version control checkout results in only a
+ * single reload of each affected file.
+ *
+ * When a file can't be watched directly, for example because the system
+ * limit on the number of watches has been reached, its directory is watched
+ * instead and changes are detected by comparing modification times.
  */
 class TILEDSHARED_EXPORT FileSystemWatcher : public QObject
 {
@@ -84,9 +93,17 @@ private:
     void pathsChangedTimeout();
     void clearInternal();
 
+    void watchPaths(const QStringList &paths);
+    void watchThroughDirectory(const QString &path);
+    bool unwatchThroughDirectory(const QString &path);
+    bool isWatchedThroughDirectory(const QString &path) const;
+
     QFileSystemWatcher *mWatcher;
     QMap<QString, int> mWatchCount;
 
+    // Files that are watched through their directory, by directory
+    QHash<QString, QHash<QString, QDateTime>> mFilesByDirectory;
+
     QSet<QString> mChangedPaths;
     QTimer mChangedPathsTimer;
     bool mEnabled = true;
@@ -28,12 +28,17 @@
 
 #include "gidmapper.h"
 
+#include "base64.h"
 #include "compression.h"
 #include "tile.h"
 #include "tiled.h"
 #include "tileset.h"
 
+#include <QtEndian>
+
 #include <algorithm>
+#include <cstring>
+#include <limits>
 
 using namespace Tiled;
 
@@ -72,44 +77,7 @@ GidMapper::GidMapper(const QVector<SharedTileset> &tilesets)
 Cell GidMapper::gidToCell(unsigned gid, bool &ok) const
 {
     Cell result;
-
-    // Read out the flags
-    result.setFlippedHorizontally(gid & FlippedHorizontallyFlag);
-    result.setFlippedVertically(gid & FlippedVerticallyFlag);
-    result.setFlippedAntiDiagonally(gid & FlippedAntiDiagonallyFlag);
-
-    result.setRotatedHexagonal120(gid & RotatedHexagonal120Flag);
-
-    // Clear the flags
-    gid &= ~(FlippedHorizontallyFlag |
-             FlippedVerticallyFlag |
-             FlippedAntiDiagonallyFlag |
-             RotatedHexagonal120Flag);
-
-    if (gid == 0) {
-        ok = true;
-    } else if (isEmpty()) {
-        ok = false;
-    } else {
-        // Find the tileset containing this tile
-        QMap<unsigned, SharedTileset>::const_iterator i = mFirstGidToTileset.upperBound(gid);
-        if (i == mFirstGidToTileset.begin()) {
-            // Invalid global tile ID, since it lies before the first tileset
-            ok = false;
-        } else {
-            --i; // Navigate one tileset back since upper bound finds the next
-            int tileId = gid - i.key();
-            const SharedTileset &tileset = i.value();
-
-            result.setTile(tileset.data(), tileId);
-            ok = true;
-
-            // Adjust the next tile ID, in order to preserve tile references
-            // even to tilesets that failed to load.
-            tileset->setNextTileId(std::max(tileset->nextTileId(), tileId + 1));
-        }
-    }
-
+    ok = gidsToCells(&gid, 1, &result) == 1;
     return result;
 }
 
@@ -119,41 +87,154 @@ Cell GidMapper::gidToCell(unsigned gid, bool &ok) const
  */
 unsigned GidMapper::cellToGid(const Cell &cell) const
 {
-    if (cell.isEmpty())
-        return 0;
-
-    const Tileset *tileset = cell.tileset();
-
-    // Find the first GID for the tileset
-    QMap<unsigned, SharedTileset>::const_iterator i = mFirstGidToTileset.begin();
-    QMap<unsigned, SharedTileset>::const_iterator i_end = mFirstGidToTileset.end();
-    while (i != i_end && i.value() != tileset)
-        ++i;
-
-    if (i == i_end) // tileset not found
-        return 0;
-
-    unsigned gid = i.key() + cell.tileId();
-    if (cell.flippedHorizontally())
-        gid |= FlippedHorizontallyFlag;
-    if (cell.flippedVertically())
-        gid |= FlippedVerticallyFlag;
-    if (cell.flippedAntiDiagonally())
-        gid |= FlippedAntiDiagonallyFlag;
-    if (cell.rotatedHexagonal120())
-        gid |= RotatedHexagonal120Flag;
-
+    unsigned gid;
+    cellsToGids(&cell, 1, &gid);
     return gid;
 }
 
+/**
+ * Converts \a count global tile IDs from \a gids to \a cells.
+ *
+ * Consecutive gids usually refer to the same tileset, so the range of the
+ * last used tileset is checked before searching the list of tilesets. For
+ * maps with a single tileset, this means no search is ever needed.
+ *
+ * Returns the number of converted gids. When this is less than \a count,
+ * the gid at the returned index is invalid.
+ */
+int GidMapper::gidsToCells(const unsigned *gids, int count, Cell *cells) const
+{
+    const unsigned flagMask = FlippedHorizontallyFlag |
+                              FlippedVerticallyFlag |
+                              FlippedAntiDiagonallyFlag |
+                              RotatedHexagonal120Flag;
+
+    Tileset *tileset = nullptr;
+    unsigned rangeStart = 0;
+    unsigned rangeEnd = 0;      // tileset covers [rangeStart, rangeEnd)
+    int maxTileId = -1;
+
+    // Adjust the next tile ID, in order to preserve tile references even to
+    // tilesets that failed to load.
+    auto adjustNextTileId = [&] {
+        if (tileset && maxTileId >= tileset->nextTileId())
+            tileset->setNextTileId(maxTileId + 1);
+    };
+
+    for (int i = 0; i < count; ++i) {
+        const unsigned flags = gids[i];
+        const unsigned gid = flags & ~flagMask;
+
+        Cell &cell = cells[i];
+        cell = Cell();
+
+        // Read out the flags
+        cell.setFlippedHorizontally(flags & FlippedHorizontallyFlag);
+        cell.setFlippedVertically(flags & FlippedVerticallyFlag);
+        cell.setFlippedAntiDiagonally(flags & FlippedAntiDiagonallyFlag);
+        cell.setRotatedHexagonal120(flags & RotatedHexagonal120Flag);
+
+        if (gid == 0)
+            continue;
+
+        if (gid < rangeStart || gid >= rangeEnd) {
+            // Find the tileset containing this tile
+            const auto it = std::upper_bound(mFirstGids.begin(), mFirstGids.end(), gid);
+            if (it == mFirstGids.begin()) {
+                // Invalid global tile ID, since it lies before the first
+                // tileset or there are no tilesets
+                adjustNextTileId();
+                return i;
+            }
+
+            adjustNextTileId();
+
+            // Navigate one tileset back since upper bound finds the next
+            const int index = static_cast<int>(it - mFirstGids.begin()) - 1;
+            tileset = mTilesets.at(index).data();
+            rangeStart = mFirstGids.at(index);
+            rangeEnd = it != mFirstGids.end() ? *it : std::numeric_limits<unsigned>::max();
+            maxTileId = -1;
+        }
+
+        const int tileId = static_cast<int>(gid - rangeStart);
+        cell.setTile(tileset, tileId);
+        maxTileId = std::max(maxTileId, tileId);
+    }
+
+    adjustNextTileId();
+    return count;
+}
+
+/**
+ * Converts \a count \a cells to global tile IDs, which are written to
+ * \a gids. Empty cells and cells referring to unknown tilesets are converted
+ * to 0.
+ */
+void GidMapper::cellsToGids(const Cell *cells, int count, unsigned *gids) const
+{
+    const Tileset *lastTileset = nullptr;
+    unsigned firstGid = 0;
+    bool found = false;
+
+    for (int i = 0; i < count; ++i) {
+        const Cell &cell = cells[i];
+
+        if (cell.isEmpty()) {
+            gids[i] = 0;
+            continue;
+        }
+
+        if (cell.tileset() != lastTileset) {
+            lastTileset = cell.tileset();
+            found = findFirstGid(lastTileset, firstGid);
+        }
+
+        if (!found) { // tileset not found
+            gids[i] = 0;
+            continue;
+        }
+
+        unsigned gid = firstGid + cell.tileId();
+        if (cell.flippedHorizontally())
+            gid |= FlippedHorizontallyFlag;
+        if (cell.flippedVertically())
+            gid |= FlippedVerticallyFlag;
+        if (cell.flippedAntiDiagonally())
+            gid |= FlippedAntiDiagonallyFlag;
+        if (cell.rotatedHexagonal120())
+            gid |= RotatedHexagonal120Flag;
+
+        gids[i] = gid;
+    }
+}
+
+/**
+ * Looks up the first global tile ID of the given \a tileset. Returns whether
+ * it was found.
+ */
+bool GidMapper::findFirstGid(const Tileset *tileset, unsigned &firstGid) const
+{
+    for (int i = 0, size = mTilesets.size(); i < size; ++i) {
+        if (mTilesets.at(i) == tileset) {
+            firstGid = mFirstGids.at(i);
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * Encodes the tile layer data of the given \a tileLayer in the given
  * \a format. This function should only be used for base64 encoding, with or
- * without compression.
+ * without compression or run-length encoding.
+ *
+ * The \a dictionary is only used for the Base64Zstandard format.
  */
 QByteArray GidMapper::encodeLayerData(const TileLayer &tileLayer,
                                       Map::LayerDataFormat format,
-                                      QRect bounds, int compressionLevel) const
+                                      QRect bounds, int compressionLevel,
+                                      const QByteArray &dictionary) const
 {
     Q_ASSERT(format != Map::XML);
     Q_ASSERT(format != Map::CSV);
@@ -161,73 +242,216 @@ QByteArray GidMapper::encodeLayerData(const TileLayer &tileLayer,
     if (bounds.isEmpty())
         bounds = QRect(0, 0, tileLayer.width(), tileLayer.height());
 
-    QByteArray tileData;
-    tileData.reserve(bounds.width() * bounds.height() * 4);
+    QByteArray tileData = uncompressedLayerData(tileLayer, bounds);
 
-    for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
-        for (int x = bounds.left(); x <= bounds.right(); ++x) {
-            const unsigned gid = cellToGid(tileLayer.cellAt(x, y));
-            tileData.append(static_cast<char>(gid));
-            tileData.append(static_cast<char>(gid >> 8));
-            tileData.append(static_cast<char>(gid >> 16));
-            tileData.append(static_cast<char>(gid >> 24));
-        }
-    }
+    if (format == Map::Base64RunLength || format == Map::Base64RunLengthZstandard)
+        tileData = runLengthEncode(tileData);
 
     if (format == Map::Base64Gzip)
         tileData = compress(tileData, Gzip, compressionLevel);
     else if (format == Map::Base64Zlib)
         tileData = compress(tileData, Zlib, compressionLevel);
     else if (format == Map::Base64Zstandard)
+        tileData = compress(tileData, Zstandard, compressionLevel, dictionary);
+    else if (format == Map::Base64RunLengthZstandard)
         tileData = compress(tileData, Zstandard, compressionLevel);
 
-    return tileData.toBase64();
+    return Base64::encode(tileData);
+}
+
+/**
+ * Returns the run-length encoding of the 32-bit values in \a data, as pairs
+ * of a run length and a value.
+ */
+QByteArray GidMapper::runLengthEncode(const QByteArray &data)
+{
+    const auto in = reinterpret_cast<const uchar*>(data.constData());
+    const int count = data.size() / 4;
+
+    QByteArray runs;
+    char pair[8];
+
+    for (int i = 0; i < count; ) {
+        const quint32 value = qFromLittleEndian<quint32>(in + i * 4);
+
+        int end = i + 1;
+        while (end < count && qFromLittleEndian<quint32>(in + end * 4) == value)
+            ++end;
+
+        qToLittleEndian<quint32>(quint32(end - i), pair);
+        qToLittleEndian<quint32>(value, pair + 4);
+        runs.append(pair, 8);
+
+        i = end;
+    }
+
+    return runs;
+}
+
+/**
+ * Expands the run-length encoded \a runs into \a cellCount 32-bit values.
+ * Returns a null QByteArray when the runs don't add up to \a cellCount.
+ */
+QByteArray GidMapper::runLengthDecode(const QByteArray &runs, int cellCount)
+{
+    if (runs.size() % 8 != 0)
+        return QByteArray();
+
+    QByteArray data(cellCount * 4, Qt::Uninitialized);
+    auto out = reinterpret_cast<quint32*>(data.data());
+    const auto in = reinterpret_cast<const uchar*>(runs.constData());
+
+    qint64 remaining = cellCount;
+
+    for (int i = 0; i < runs.size(); i += 8) {
+        const quint32 length = qFromLittleEndian<quint32>(in + i);
+        if (length > remaining)
+            return QByteArray();
+
+        // The value is copied as is, keeping it in little-endian byte order
+        quint32 value;
+        std::memcpy(&value, in + i + 4, 4);
+        out = std::fill_n(out, length, value);
+        remaining -= length;
+    }
+
+    if (remaining != 0)
+        return QByteArray();
+
+    return data;
 }
 
+/**
+ * Returns the global tile IDs of the cells in \a bounds of \a tileLayer, as
+ * 32-bit little-endian values, before any compression or encoding.
+ */
+QByteArray GidMapper::uncompressedLayerData(const TileLayer &tileLayer,
+                                            QRect bounds) const
+{
+    QByteArray tileData;
+    tileData.resize(bounds.width() * bounds.height() * 4);
+
+    uchar *out = reinterpret_cast<uchar*>(tileData.data());
+    unsigned gids[CHUNK_SIZE];
+
+    tileLayer.forEachSpan(bounds, [&] (int, int, const Cell *cells, int count) {
+        cellsToGids(cells, count, gids);
+        for (int i = 0; i < count; ++i, out += 4)
+            qToLittleEndian<quint32>(gids[i], out);
+    });
+
+    return tileData;
+}
+
+/**
+ * Decodes the base64 encoded and optionally compressed \a layerData and
+ * sets the resulting cells on \a tileLayer, within the given \a bounds.
+ */
 GidMapper::DecodeError GidMapper::decodeLayerData(TileLayer &tileLayer,
                                                   const QByteArray &layerData,
                                                   Map::LayerDataFormat format,
-                                                  QRect bounds) const
+                                                  QRect bounds,
+                                                  const QByteArray &dictionary) const
+{
+    QByteArray decodedData;
+
+    const DecodeError error = decompressLayerData(layerData, format, bounds,
+                                                  decodedData, dictionary);
+    if (error != NoError)
+        return error;
+
+    return setLayerData(tileLayer, decodedData, bounds);
+}
+
+/**
+ * Decodes the base64 encoded and optionally compressed \a layerData into
+ * \a decodedData, which will contain a 32-bit global tile ID for each cell
+ * in \a bounds.
+ *
+ * This function does not depend on any tilesets and is safe to call from
+ * multiple threads.
+ */
+GidMapper::DecodeError GidMapper::decompressLayerData(const QByteArray &layerData,
+                                                      Map::LayerDataFormat format,
+                                                      QRect bounds,
+                                                      QByteArray &decodedData,
+                                                      const QByteArray &dictionary)
 {
     Q_ASSERT(format != Map::XML);
     Q_ASSERT(format != Map::CSV);
 
-    QByteArray decodedData = QByteArray::fromBase64(layerData);
     const int size = bounds.width() * bounds.height() * 4;
 
+    if (format == Map::Base64) {
+        decodedData = Base64::decode(layerData);
+        return size == decodedData.length() ? NoError : CorruptLayerData;
+    }
+
+    if (format == Map::Base64RunLength || format == Map::Base64RunLengthZstandard) {
+        const int cellCount = bounds.width() * bounds.height();
+
+        // The runs take at most 8 bytes per cell
+        QByteArray runs = Base64::decode(layerData);
+        if (format == Map::Base64RunLengthZstandard)
+            runs = decompress(runs, cellCount * 8, Zstandard);
+
+        decodedData = runLengthDecode(runs, cellCount);
+        return decodedData.isNull() ? CorruptLayerData : NoError;
+    }
+
+    CompressionMethod method = Zlib;
     if (format == Map::Base64Gzip)
-        decodedData = decompress(decodedData, size, Gzip);
-    else if (format == Map::Base64Zlib)
-        decodedData = decompress(decodedData, size, Zlib);
+        method = Gzip;
     else if (format == Map::Base64Zstandard)
-        decodedData = decompress(decodedData, size, Zstandard);
+        method = Zstandard;
+
+    // The size of the uncompressed data is known, so decompress directly
+    // into the output.
+    const QByteArray compressedData = Base64::decode(layerData);
+    decodedData.resize(size);
 
+    CompressionContext &context = CompressionContext::forCurrentThread();
+    if (!context.decompressInto(compressedData, decodedData.data(), size,
+                                method, dictionary)) {
+        decodedData.clear();
+        return CorruptLayerData;
+    }
+
+    return NoError;
+}
+
+/**
+ * Sets the cells on \a tileLayer within \a bounds, based on the global tile
+ * IDs in \a decodedData, as returned by decompressLayerData().
+ */
+GidMapper::DecodeError GidMapper::setLayerData(TileLayer &tileLayer,
+                                               const QByteArray &decodedData,
+                                               QRect bounds) const
+{
+    const int size = bounds.width() * bounds.height() * 4;
     if (size != decodedData.length())
         return CorruptLayerData;
 
-    const unsigned char *data = reinterpret_cast<const unsigned char*>(decodedData.constData());
-    int x = bounds.x();
-    int y = bounds.y();
-    bool ok;
-
-    for (int i = 0; i < size - 3; i += 4) {
-        const unsigned gid = data[i] |
-                             data[i + 1] << 8 |
-                             data[i + 2] << 16 |
-                             data[i + 3] << 24;
-
-        const Cell result = gidToCell(gid, ok);
-        if (!ok) {
-            mInvalidTile = gid;
-            return isEmpty() ? TileButNoTilesets : InvalidTile;
-        }
+    const uchar *data = reinterpret_cast<const uchar*>(decodedData.constData());
+    unsigned gids[CHUNK_SIZE];
+    Cell cells[CHUNK_SIZE];
+
+    // Converts and sets the cells in spans of at most CHUNK_SIZE cells
+    for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
+        for (int x = bounds.left(); x <= bounds.right(); x += CHUNK_SIZE) {
+            const int count = std::min(CHUNK_SIZE, bounds.right() - x + 1);
+
+            for (int i = 0; i < count; ++i, data += 4)
+                gids[i] = qFromLittleEndian<quint32>(data);
 
-        tileLayer.setCell(x, y, result);
+            const int converted = gidsToCells(gids, count, cells);
+            if (converted < count) {
+                tileLayer.setRow(x, y, converted, cells);
+                mInvalidTile = gids[converted];
+                return isEmpty() ? TileButNoTilesets : InvalidTile;
+            }
 
-        x++;
-        if (x > bounds.right()) {
-            x = bounds.x();
-            y++;
+            tileLayer.setRow(x, y, count, cells);
         }
     }
 
@@ -31,7 +31,9 @@
 #include "map.h"
 #include "tilelayer.h"
 
-#include <QMap>
+#include <QVector>
+
+#include <algorithm>
 
 namespace Tiled {
 
@@ -51,10 +53,20 @@ public:
     Cell gidToCell(unsigned gid, bool &ok) const;
     unsigned cellToGid(const Cell &cell) const;
 
+    int gidsToCells(const unsigned *gids, int count, Cell *cells) const;
+    void cellsToGids(const Cell *cells, int count, unsigned *gids) const;
+
     QByteArray encodeLayerData(const TileLayer &tileLayer,
                                Map::LayerDataFormat format,
                                QRect bounds = QRect(),
-                               int compressionLevel = -1) const;
+                               int compressionLevel = -1,
+                               const QByteArray &dictionary = QByteArray()) const;
+
+    QByteArray uncompressedLayerData(const TileLayer &tileLayer,
+                                     QRect bounds) const;
+
+    static QByteArray runLengthEncode(const QByteArray &data);
+    static QByteArray runLengthDecode(const QByteArray &runs, int cellCount);
 
     enum DecodeError {
         NoError = 0,
@@ -66,12 +78,27 @@ public:
     DecodeError decodeLayerData(TileLayer &tileLayer,
                                 const QByteArray &layerData,
                                 Map::LayerDataFormat format,
-                                QRect bounds) const;
+                                QRect bounds,
+                                const QByteArray &dictionary = QByteArray()) const;
+
+    static DecodeError decompressLayerData(const QByteArray &layerData,
+                                           Map::LayerDataFormat format,
+                                           QRect bounds,
+                                           QByteArray &decodedData,
+                                           const QByteArray &dictionary = QByteArray());
+
+    DecodeError setLayerData(TileLayer &tileLayer,
+                             const QByteArray &decodedData,
+                             QRect bounds) const;
 
     unsigned invalidTile() const;
 
 private:
-    QMap<unsigned, SharedTileset> mFirstGidToTileset;
+    bool findFirstGid(const Tileset *tileset, unsigned &firstGid) const;
+
+    // Sorted by first gid, kept apart for a fast binary search
+    QVector<unsigned> mFirstGids;
+    QVector<SharedTileset> mTilesets;
 
     mutable unsigned mInvalidTile = 0;
 };
@@ -82,7 +109,15 @@ private:
  */
 inline void GidMapper::insert(unsigned firstGid, const SharedTileset &tileset)
 {
-    mFirstGidToTileset.insert(firstGid, tileset);
+    const auto it = std::lower_bound(mFirstGids.begin(), mFirstGids.end(), firstGid);
+    const int index = static_cast<int>(it - mFirstGids.begin());
+
+    if (it != mFirstGids.end() && *it == firstGid) {
+        mTilesets[index] = tileset;
+    } else {
+        mFirstGids.insert(index, firstGid);
+        mTilesets.insert(index, tileset);
+    }
 }
 
 /**
@@ -90,7 +125,8 @@ inline void GidMapper::insert(unsigned firstGid, const SharedTileset &tileset)
  */
 inline void GidMapper::clear()
 {
-    mFirstGidToTileset.clear();
+    mFirstGids.clear();
+    mTilesets.clear();
 }
 
 /**
@@ -98,7 +134,7 @@ inline void GidMapper::clear()
  */
 inline bool GidMapper::isEmpty() const
 {
-    return mFirstGidToTileset.isEmpty();
+    return mFirstGids.isEmpty();
 }
 
 /**
@@ -384,10 +384,8 @@ void HexagonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
     }
 }
 
-void HexagonalRenderer::drawTileSelection(QPainter *painter,
-                                          const QRegion &region,
-                                          const QColor &color,
-                                          const QRectF &exposed) const
+QPainterPath HexagonalRenderer::tileSelectionPath(const QRegion &region,
+                                                  const QRectF &exposed) const
 {
     QPainterPath path;
 
@@ -395,22 +393,13 @@ void HexagonalRenderer::drawTileSelection(QPainter *painter,
         for (int y = r.top(); y <= r.bottom(); ++y) {
             for (int x = r.left(); x <= r.right(); ++x) {
                 const QPolygonF polygon = tileToScreenPolygon(x, y);
-                if (QRectF(polygon.boundingRect()).intersects(exposed))
+                if (exposed.isNull() || QRectF(polygon.boundingRect()).intersects(exposed))
                     path.addPolygon(polygon);
             }
         }
     }
 
-    QColor penColor(color);
-    penColor.setAlpha(255);
-
-    QPen pen(penColor);
-    pen.setCosmetic(true);
-
-    painter->setPen(pen);
-    painter->setBrush(color);
-    painter->setRenderHint(QPainter::Antialiasing, true);
-    painter->drawPath(path.simplified());
+    return path.simplified();
 }
 
 QPointF HexagonalRenderer::tileToPixelCoords(qreal x, qreal y) const
@@ -428,9 +417,40 @@ QPointF HexagonalRenderer::pixelToTileCoords(qreal x, qreal y) const
  * supported by this renderer.
  */
 QPointF HexagonalRenderer::screenToTileCoords(qreal x, qreal y) const
+{
+    return screenToTile(RenderParams(map()), x, y);
+}
+
+/**
+ * Converts tile to screen coordinates. Sub-tile return values are not
+ * supported by this renderer.
+ */
+QPointF HexagonalRenderer::tileToScreenCoords(qreal x, qreal y) const
+{
+    return tileToScreen(RenderParams(map()), x, y);
+}
+
+void HexagonalRenderer::pixelToTileCoords(const QPointF *points, QPointF *result, int count) const
+{
+    HexagonalRenderer::screenToTileCoords(points, result, count);
+}
+
+void HexagonalRenderer::screenToTileCoords(const QPointF *points, QPointF *result, int count) const
 {
     const RenderParams p(map());
+    for (int i = 0; i < count; ++i)
+        result[i] = screenToTile(p, points[i].x(), points[i].y());
+}
+
+void HexagonalRenderer::tileToScreenCoords(const QPointF *points, QPointF *result, int count) const
+{
+    const RenderParams p(map());
+    for (int i = 0; i < count; ++i)
+        result[i] = tileToScreen(p, points[i].x(), points[i].y());
+}
 
+QPointF HexagonalRenderer::screenToTile(const RenderParams &p, qreal x, qreal y) const
+{
     if (p.staggerX)
         x -= p.staggerEven ? p.tileWidth : p.sideOffsetX;
     else
@@ -502,13 +522,8 @@ QPointF HexagonalRenderer::screenToTileCoords(qreal x, qreal y) const
     return referencePoint + offsets[nearest];
 }
 
-/**
- * Converts tile to screen coordinates. Sub-tile return values are not
- * supported by this renderer.
- */
-QPointF HexagonalRenderer::tileToScreenCoords(qreal x, qreal y) const
+QPointF HexagonalRenderer::tileToScreen(const RenderParams &p, qreal x, qreal y) const
 {
-    const RenderParams p(map());
     const int tileX = qFloor(x);
     const int tileY = qFloor(y);
     int pixelX, pixelY;
@@ -593,7 +608,7 @@ QPoint HexagonalRenderer::bottomRight(int x, int y) const
 QPolygonF HexagonalRenderer::tileToScreenPolygon(int x, int y) const
 {
     const RenderParams p(map());
-    const QPointF topRight = tileToScreenCoords(x, y);
+    const QPointF topRight = tileToScreen(p, x, y);
 
     QPolygonF polygon(8);
     polygon[0] = topRight + QPoint(0,               p.rowHeight);
@@ -85,10 +85,8 @@ public:
     void drawTileLayer(const RenderTileCallback &renderTile,
                        const QRectF &exposed) const override;
 
-    void drawTileSelection(QPainter *painter,
-                           const QRegion &region,
-                           const QColor &color,
-                           const QRectF &exposed) const override;
+    QPainterPath tileSelectionPath(const QRegion &region,
+                                   const QRectF &exposed = QRectF()) const override;
 
     using OrthogonalRenderer::pixelToTileCoords;
     QPointF pixelToTileCoords(qreal x, qreal y) const override;
@@ -102,6 +100,10 @@ public:
     using OrthogonalRenderer::tileToScreenCoords;
     QPointF tileToScreenCoords(qreal x, qreal y) const override;
 
+    void pixelToTileCoords(const QPointF *points, QPointF *result, int count) const override;
+    void screenToTileCoords(const QPointF *points, QPointF *result, int count) const override;
+    void tileToScreenCoords(const QPointF *points, QPointF *result, int count) const override;
+
     // Functions specific to this type of renderer
     QPoint topLeft(int x, int y) const;
     QPoint topRight(int x, int y) const;
@@ -111,6 +113,10 @@ public:
     QPolygonF tileToScreenPolygon(int x, int y) const;
     QPolygonF tileToScreenPolygon(QPoint tileCoords) const
     { return tileToScreenPolygon(tileCoords.x(), tileCoords.y()); }
+
+protected:
+    QPointF screenToTile(const RenderParams &p, qreal x, qreal y) const;
+    QPointF tileToScreen(const RenderParams &p, qreal x, qreal y) const;
 };
 
 } // namespace Tiled
@@ -31,10 +31,19 @@
 #include "logginginterface.h"
 #include "mapformat.h"
 #include "minimaprenderer.h"
+#include "tracer.h"
 
 #include <QBitmap>
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFileInfo>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
 
 namespace Tiled {
 
@@ -45,9 +54,23 @@ struct LoadedPixmap
     operator const QPixmap &() const { return pixmap; }
 
     QPixmap pixmap;
+    QHash<QRgb, QPixmap> maskedPixmaps;     // by transparent color
     QDateTime lastModified;
+    quint64 lastUsed = 0;
 };
 
+/**
+ * Returns the approximate amount of memory used by the given pixmap and its
+ * masked variants, in bytes.
+ */
+static qint64 memoryCost(const LoadedPixmap &loadedPixmap)
+{
+    qint64 cost = ImageCache::memoryCost(loadedPixmap.pixmap);
+    for (const QPixmap &masked : loadedPixmap.maskedPixmaps)
+        cost += ImageCache::memoryCost(masked);
+    return cost;
+}
+
 
 LoadedImage::LoadedImage()
     : LoadedImage(QImage(), QDateTime())
@@ -65,8 +88,117 @@ LoadedPixmap::LoadedPixmap(const LoadedImage &cachedImage)
 {}
 
 
+namespace {
+
+/**
+ * The header of the files in the decoded image cache, in native byte order.
+ * It is followed by the pixel data.
+ */
+struct DiskCacheHeader
+{
+    char magic[4];
+    quint32 version;
+    qint64 lastModified;    // of the source file, in ms since the epoch
+    qint64 fileSize;        // of the source file
+    qint32 width;
+    qint32 height;
+    qint32 bytesPerLine;
+    qint32 format;
+    char reserved[24];
+};
+
+static_assert(sizeof(DiskCacheHeader) == 64, "keeps the pixel data aligned");
+
+constexpr char diskCacheMagic[4] = { 'T', 'I', 'M', 'G' };
+constexpr quint32 diskCacheVersion = 1;
+
+} // anonymous namespace
+
+static QString diskCacheFileName(const QString &directory, const QFileInfo &source)
+{
+    const QByteArray hash = QCryptographicHash::hash(source.absoluteFilePath().toUtf8(),
+                                                     QCryptographicHash::Sha1);
+    return directory + QLatin1Char('/') + QLatin1String(hash.toHex()) + QStringLiteral(".img");
+}
+
+static void closeMappedFile(void *file)
+{
+    delete static_cast<QFile*>(file);   // also unmaps the memory
+}
+
+/**
+ * Returns the image stored in the given cache file, when it is still valid
+ * for the \a source file. The pixel data is memory-mapped rather than read.
+ */
+static QImage readDiskCache(const QString &cacheFileName, const QFileInfo &source)
+{
+    auto file = std::make_unique<QFile>(cacheFileName);
+    if (!file->open(QIODevice::ReadOnly))
+        return {};
+
+    const qint64 size = file->size();
+    if (size < qint64(sizeof(DiskCacheHeader)))
+        return {};
+
+    const uchar *data = file->map(0, size);
+    if (!data)
+        return {};
+
+    DiskCacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    const auto format = static_cast<QImage::Format>(header.format);
+
+    if (std::memcmp(header.magic, diskCacheMagic, sizeof(diskCacheMagic)) != 0 ||
+            header.version != diskCacheVersion ||
+            header.lastModified != source.lastModified().toMSecsSinceEpoch() ||
+            header.fileSize != source.size() ||
+            (format != QImage::Format_ARGB32_Premultiplied && format != QImage::Format_RGB32) ||
+            header.width <= 0 || header.height <= 0 ||
+            header.bytesPerLine < header.width * 4 ||
+            size != qint64(sizeof(header)) + qint64(header.bytesPerLine) * header.height) {
+        return {};
+    }
+
+    // The image refers to the read-only mapping, and will make a copy when
+    // it is modified. The file is closed once the image is destroyed.
+    return QImage(data + sizeof(header),
+                  header.width, header.height, header.bytesPerLine, format,
+                  closeMappedFile, file.release());
+}
+
+static void writeDiskCache(const QString &cacheFileName, const QFileInfo &source,
+                           const QImage &image)
+{
+    DiskCacheHeader header {};
+    std::memcpy(header.magic, diskCacheMagic, sizeof(diskCacheMagic));
+    header.version = diskCacheVersion;
+    header.lastModified = source.lastModified().toMSecsSinceEpoch();
+    header.fileSize = source.size();
+    header.width = image.width();
+    header.height = image.height();
+    header.bytesPerLine = int(image.bytesPerLine());
+    header.format = image.format();
+
+    // Written atomically, since other processes may be reading the cache
+    QSaveFile file(cacheFileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(image.constBits()), image.sizeInBytes());
+    file.commit();
+}
+
+
 QHash<QString, LoadedImage> ImageCache::sLoadedImages;
 QHash<QString, LoadedPixmap> ImageCache::sLoadedPixmaps;
+QHash<QString, QFuture<QImage>> ImageCache::sPendingImages;
+ImageCache::EvictionHandler ImageCache::sEvictionHandler;
+qint64 ImageCache::sMemoryLimit = 0;
+qint64 ImageCache::sMemoryUsage = 0;
+quint64 ImageCache::sUseCounter = 0;
+QString ImageCache::sDiskCacheDirectory;
 
 LoadedImage ImageCache::loadImage(const QString &fileName)
 {
@@ -83,16 +215,31 @@ LoadedImage ImageCache::loadImage(const QString &fileName)
         remove(fileName);
 
     if (old || !found) {
-        QImage image(fileName);
+        QImage image;
+
+        // Use the result of a prefetch, when available
+        auto pending = sPendingImages.find(fileName);
+        if (pending != sPendingImages.end()) {
+            image = pending.value().result();
+            sPendingImages.erase(pending);
+        } else {
+            TraceScope trace("Decode image", fileName);
+            image = decodeImage(fileName);
+        }
 
         // If the image failed to load, try to load and render a map file
         if (image.isNull())
             image = renderMap(fileName);
 
+        sMemoryUsage += memoryCost(image);
         it = sLoadedImages.insert(fileName, LoadedImage(image, info.lastModified()));
     }
 
-    return it.value();
+    it.value().lastUsed = touch();
+
+    const LoadedImage loadedImage = it.value();
+    evictIfNeeded();
+    return loadedImage;
 }
 
 QPixmap ImageCache::loadPixmap(const QString &fileName)
@@ -107,16 +254,269 @@ QPixmap ImageCache::loadPixmap(const QString &fileName)
 
     if (old)
         remove(fileName);
-    if (old || !found)
-        it = sLoadedPixmaps.insert(fileName, LoadedPixmap(loadImage(fileName)));
+    if (old || !found) {
+        LoadedPixmap loadedPixmap(loadImage(fileName));
+        sMemoryUsage += memoryCost(loadedPixmap.pixmap);
+        it = sLoadedPixmaps.insert(fileName, loadedPixmap);
+    }
+
+    it.value().lastUsed = touch();
 
-    return it.value();
+    const QPixmap pixmap = it.value();
+    evictIfNeeded();
+    return pixmap;
+}
+
+/**
+ * Returns the pixmap loaded from \a fileName, masked to make the given
+ * \a transparentColor transparent.
+ *
+ * The masked pixmap is cached along with the file, so that tilesets using
+ * the same image and transparent color share the same pixels.
+ */
+QPixmap ImageCache::loadPixmap(const QString &fileName, const QColor &transparentColor)
+{
+    if (!transparentColor.isValid())
+        return loadPixmap(fileName);
+
+    const QPixmap pixmap = loadPixmap(fileName);
+    if (pixmap.isNull())
+        return pixmap;
+
+    // May have been evicted if it's the only entry exceeding the limit
+    auto it = sLoadedPixmaps.find(fileName);
+    if (it == sLoadedPixmaps.end()) {
+        QPixmap masked = pixmap;
+        masked.setMask(masked.createMaskFromColor(transparentColor));
+        return masked;
+    }
+
+    auto &maskedPixmaps = it.value().maskedPixmaps;
+    auto maskedIt = maskedPixmaps.constFind(transparentColor.rgba());
+    if (maskedIt != maskedPixmaps.constEnd())
+        return maskedIt.value();
+
+    QPixmap masked = pixmap;
+    masked.setMask(masked.createMaskFromColor(transparentColor));
+
+    sMemoryUsage += memoryCost(masked);
+    maskedPixmaps.insert(transparentColor.rgba(), masked);
+
+    evictIfNeeded();
+    return masked;
+}
+
+/**
+ * Starts decoding the image with the given \a fileName on the global thread
+ * pool, unless it is already cached. The next call to loadImage() or
+ * loadPixmap() for this file will use the result, waiting for it if
+ * necessary.
+ *
+ * This allows images to be decoded in parallel, and while other work is done
+ * on the main thread.
+ */
+void ImageCache::prefetch(const QString &fileName)
+{
+    if (fileName.isEmpty())
+        return;
+    if (sPendingImages.contains(fileName))
+        return;
+
+    auto it = sLoadedImages.constFind(fileName);
+    if (it != sLoadedImages.constEnd() && !(it.value().lastModified < QFileInfo(fileName).lastModified()))
+        return;
+
+    sPendingImages.insert(fileName, QtConcurrent::run([fileName] {
+        TraceScope trace("Decode image", fileName);
+        return decodeImage(fileName);
+    }));
 }
 
 void ImageCache::remove(const QString &fileName)
 {
-    sLoadedImages.remove(fileName);
-    sLoadedPixmaps.remove(fileName);
+    auto imageIt = sLoadedImages.find(fileName);
+    if (imageIt != sLoadedImages.end()) {
+        sMemoryUsage -= memoryCost(imageIt.value().image);
+        sLoadedImages.erase(imageIt);
+    }
+
+    auto pixmapIt = sLoadedPixmaps.find(fileName);
+    if (pixmapIt != sLoadedPixmaps.end()) {
+        sMemoryUsage -= Tiled::memoryCost(pixmapIt.value());
+        sLoadedPixmaps.erase(pixmapIt);
+    }
+
+    // Any pending result may be outdated
+    sPendingImages.remove(fileName);
+}
+
+/**
+ * Sets the approximate amount of memory in \a bytes the cached images and
+ * pixmaps may use. When the limit is exceeded, the least recently used
+ * entries are removed from the cache and the eviction handler is called for
+ * each of their files. A limit of 0 means there is no limit.
+ *
+ * Note that evicting an image only frees its memory when it is no longer
+ * referenced elsewhere.
+ */
+void ImageCache::setMemoryLimit(qint64 bytes)
+{
+    sMemoryLimit = std::max<qint64>(0, bytes);
+    evictIfNeeded();
+}
+
+qint64 ImageCache::memoryLimit()
+{
+    return sMemoryLimit;
+}
+
+/**
+ * Returns the amount of memory used by the pixels of \a image, in bytes.
+ */
+qint64 ImageCache::memoryCost(const QImage &image)
+{
+    return image.sizeInBytes();
+}
+
+/**
+ * Returns the approximate amount of memory used by the pixels of \a pixmap,
+ * in bytes.
+ */
+qint64 ImageCache::memoryCost(const QPixmap &pixmap)
+{
+    return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+/**
+ * Returns the approximate amount of memory used by the cached images and
+ * pixmaps, in bytes.
+ */
+qint64 ImageCache::memoryUsage()
+{
+    return sMemoryUsage;
+}
+
+/**
+ * Sets the \a handler that is called with the file name of each image that
+ * was evicted from the cache because of the memory limit. This gives the
+ * owners of the images the chance to release them, and to load them again
+ * when needed.
+ */
+void ImageCache::setEvictionHandler(EvictionHandler handler)
+{
+    sEvictionHandler = std::move(handler);
+}
+
+/**
+ * Sets the directory in which decoded images are stored, to be reused by
+ * later runs instead of decoding the image files again. An empty \a path
+ * disables this cache, which is the default.
+ *
+ * The cached images are stored uncompressed and are invalidated when the
+ * modification time or size of their image file changes. Since images may
+ * be decoded in the background, this should be set before loading images.
+ */
+void ImageCache::setDiskCacheDirectory(const QString &path)
+{
+    if (!path.isEmpty())
+        QDir().mkpath(path);
+
+    sDiskCacheDirectory = path;
+}
+
+const QString &ImageCache::diskCacheDirectory()
+{
+    return sDiskCacheDirectory;
+}
+
+/**
+ * Decodes the image file with the given \a fileName, using the disk cache
+ * when it is enabled. Can be used from any thread.
+ *
+ * Images stored in the disk cache are converted to a 32-bit format, so that
+ * they can be used without conversion when read back.
+ */
+QImage ImageCache::decodeImage(const QString &fileName)
+{
+    if (sDiskCacheDirectory.isEmpty() || fileName.startsWith(QLatin1Char(':')))
+        return QImage(fileName);
+
+    const QFileInfo source(fileName);
+    if (!source.isFile())
+        return QImage(fileName);
+
+    const QString cacheFileName = diskCacheFileName(sDiskCacheDirectory, source);
+
+    QImage image = readDiskCache(cacheFileName, source);
+    if (!image.isNull())
+        return image;
+
+    image = QImage(fileName);
+    if (image.isNull())
+        return image;
+
+    image = image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                          : QImage::Format_RGB32);
+    writeDiskCache(cacheFileName, source, image);
+    return image;
+}
+
+quint64 ImageCache::touch()
+{
+    return ++sUseCounter;
+}
+
+/**
+ * Removes the least recently used entries until the memory usage is within
+ * the limit. The most recently used entry is always kept.
+ */
+void ImageCache::evictIfNeeded()
+{
+    if (sMemoryLimit <= 0 || sMemoryUsage <= sMemoryLimit)
+        return;
+
+    struct Entry {
+        quint64 lastUsed;
+        QString fileName;
+    };
+
+    QVector<Entry> entries;
+    entries.reserve(sLoadedImages.size() + sLoadedPixmaps.size());
+
+    for (auto it = sLoadedImages.cbegin(); it != sLoadedImages.cend(); ++it)
+        entries.append({ it.value().lastUsed, it.key() });
+    for (auto it = sLoadedPixmaps.cbegin(); it != sLoadedPixmaps.cend(); ++it)
+        entries.append({ it.value().lastUsed, it.key() });
+
+    std::sort(entries.begin(), entries.end(), [] (const Entry &a, const Entry &b) {
+        return a.lastUsed < b.lastUsed;
+    });
+
+    QStringList evicted;
+
+    for (const Entry &entry : std::as_const(entries)) {
+        if (sMemoryUsage <= sMemoryLimit || entry.lastUsed == sUseCounter)
+            break;
+
+        auto imageIt = sLoadedImages.find(entry.fileName);
+        if (imageIt != sLoadedImages.end() && imageIt.value().lastUsed == entry.lastUsed) {
+            sMemoryUsage -= memoryCost(imageIt.value().image);
+            sLoadedImages.erase(imageIt);
+        } else {
+            auto pixmapIt = sLoadedPixmaps.find(entry.fileName);
+            if (pixmapIt != sLoadedPixmaps.end() && pixmapIt.value().lastUsed == entry.lastUsed) {
+                sMemoryUsage -= Tiled::memoryCost(pixmapIt.value());
+                sLoadedPixmaps.erase(pixmapIt);
+            }
+        }
+
+        if (!sLoadedImages.contains(entry.fileName) && !sLoadedPixmaps.contains(entry.fileName))
+            evicted.append(entry.fileName);
+    }
+
+    if (sEvictionHandler)
+        for (const QString &fileName : std::as_const(evicted))
+            sEvictionHandler(fileName);
 }
 
 QImage ImageCache::renderMap(const QString &fileName)
@@ -32,11 +32,14 @@
 
 #include <QColor>
 #include <QDateTime>
+#include <QFuture>
 #include <QHash>
 #include <QImage>
 #include <QPixmap>
 #include <QString>
 
+#include <functional>
+
 namespace Tiled {
 
 struct LoadedImage
@@ -48,24 +51,57 @@ struct LoadedImage
 
     QImage image;
     QDateTime lastModified;
+    quint64 lastUsed = 0;
 };
 
 struct LoadedPixmap;
 class Map;
 
+/**
+ * Caches loaded images and pixmaps by their file name.
+ *
+ * The cache is only meant to be used from the main thread. Images can be
+ * decoded in the background using prefetch().
+ */
 class TILEDSHARED_EXPORT ImageCache
 {
 public:
+    using EvictionHandler = std::function<void (const QString &fileName)>;
+
     static LoadedImage loadImage(const QString &fileName);
     static QPixmap loadPixmap(const QString &fileName);
+    static QPixmap loadPixmap(const QString &fileName, const QColor &transparentColor);
+
+    static void prefetch(const QString &fileName);
 
     static void remove(const QString &fileName);
 
+    static void setMemoryLimit(qint64 bytes);
+    static qint64 memoryLimit();
+    static qint64 memoryUsage();
+
+    static qint64 memoryCost(const QImage &image);
+    static qint64 memoryCost(const QPixmap &pixmap);
+
+    static void setEvictionHandler(EvictionHandler handler);
+
+    static void setDiskCacheDirectory(const QString &path);
+    static const QString &diskCacheDirectory();
+
 private:
+    static QImage decodeImage(const QString &fileName);
     static QImage renderMap(const QString &fileName);
+    static quint64 touch();
+    static void evictIfNeeded();
 
     static QHash<QString, LoadedImage> sLoadedImages;
     static QHash<QString, LoadedPixmap> sLoadedPixmaps;
+    static QHash<QString, QFuture<QImage>> sPendingImages;
+    static EvictionHandler sEvictionHandler;
+    static qint64 sMemoryLimit;
+    static qint64 sMemoryUsage;
+    static quint64 sUseCounter;
+    static QString sDiskCacheDirectory;
 };
 
 } // namespace Tiled
@@ -92,6 +92,18 @@ bool ImageLayer::isEmpty() const
     return mImage.isNull();
 }
 
+/**
+ * Returns the approximate amount of memory used by this layer, including
+ * its image and properties, in bytes. The image may be shared with the
+ * ImageCache and other layers.
+ */
+qint64 ImageLayer::memoryUsage() const
+{
+    return sizeof(ImageLayer)
+            + ImageCache::memoryCost(mImage)
+            + propertiesMemoryUsage(properties());
+}
+
 ImageLayer *ImageLayer::clone() const
 {
     return initializeClone(new ImageLayer(mName, mX, mY));
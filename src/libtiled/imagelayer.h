@@ -114,6 +114,8 @@ public:
      */
     bool isEmpty() const override;
 
+    qint64 memoryUsage() const;
+
     /**
      * Returns true if the image of this layer repeats along the X axis.
      */
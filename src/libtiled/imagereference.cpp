@@ -22,6 +22,8 @@
 
 #include "imagecache.h"
 
+#include <QImageReader>
+
 namespace Tiled {
 
 bool ImageReference::hasImage() const
@@ -42,4 +44,18 @@ QPixmap ImageReference::create() const
     return pixmap;
 }
 
+/**
+ * Returns the size of the referenced image file, reading only its header.
+ * Returns an invalid size for embedded images, or when the size could not be
+ * determined without loading the image.
+ */
+QSize ImageReference::fileImageSize() const
+{
+    const QString fileName = Tiled::urlToLocalFileOrQrc(source);
+    if (fileName.isEmpty())
+        return QSize();
+
+    return QImageReader(fileName).size();
+}
+
 } // namespace Tiled
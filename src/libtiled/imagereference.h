@@ -42,6 +42,7 @@ public:
 
     bool hasImage() const;
     QPixmap create() const;
+    QSize fileImageSize() const;
 };
 
 } // namespace Tiled
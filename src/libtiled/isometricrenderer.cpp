@@ -143,7 +143,7 @@ QPainterPath IsometricRenderer::shape(const MapObject *object) const
     case MapObject::Polygon:
     case MapObject::Polyline: {
         const QPointF &pos = object->position();
-        const QPolygonF polygon = object->polygon().translated(pos);
+        const QPolygonF polygon = object->simplifiedPolygon(polygonTolerance()).translated(pos);
         QPolygonF screenPolygon = pixelToScreenCoords(polygon);
         if (object->shape() == MapObject::Polygon && !screenPolygon.isEmpty())
             screenPolygon.append(screenPolygon.first());
@@ -182,7 +182,7 @@ QPainterPath IsometricRenderer::interactionShape(const MapObject *object) const
             break;
         case MapObject::Polyline: {
             const QPointF &pos = object->position();
-            const QPolygonF polygon = object->polygon().translated(pos);
+            const QPolygonF polygon = object->simplifiedPolygon(polygonTolerance()).translated(pos);
             const QPolygonF screenPolygon = pixelToScreenCoords(polygon);
             for (int i = 1; i < screenPolygon.size(); ++i) {
                 path.addPolygon(lineToPolygon(screenPolygon[i - 1],
@@ -221,20 +221,36 @@ void IsometricRenderer::drawGrid(QPainter *painter, const QRectF &rect,
     QPen gridPen, majorGridPen;
     setupGridPens(painter->device(), gridColor, gridPen, majorGridPen, qMin(tileWidth, tileHeight), gridMajor);
 
-    for (int y = startY; y <= endY; ++y) {
-        const QPointF start = tileToScreenCoords(startX, y);
-        const QPointF end = tileToScreenCoords(endX, y);
+    // The grid fades out when zooming out, at which point its lines are
+    // skipped entirely.
+    const bool drawMinor = gridPen.color().alpha() > 0;
+    if (majorGridPen.color().alpha() <= 0)
+        return;
+
+    // Lines are collected so that they can be drawn in one call per pen
+    QVector<QLineF> minorLines;
+    QVector<QLineF> majorLines;
 
-        painter->setPen(gridMajor.height() != 0 && y % gridMajor.height() == 0 ? majorGridPen : gridPen);
-        painter->drawLine(start, end);
+    const auto addLine = [&] (bool major, const QLineF &line) {
+        if (major)
+            majorLines.append(line);
+        else if (drawMinor)
+            minorLines.append(line);
+    };
+
+    for (int y = startY; y <= endY; ++y) {
+        addLine(gridMajor.height() != 0 && y % gridMajor.height() == 0,
+                QLineF(tileToScreenCoords(startX, y), tileToScreenCoords(endX, y)));
     }
     for (int x = startX; x <= endX; ++x) {
-        const QPointF start = tileToScreenCoords(x, startY);
-        const QPointF end = tileToScreenCoords(x, endY);
-
-        painter->setPen(gridMajor.width() != 0 && x % gridMajor.width() == 0 ? majorGridPen : gridPen);
-        painter->drawLine(start, end);
+        addLine(gridMajor.width() != 0 && x % gridMajor.width() == 0,
+                QLineF(tileToScreenCoords(x, startY), tileToScreenCoords(x, endY)));
     }
+
+    painter->setPen(gridPen);
+    painter->drawLines(minorLines);
+    painter->setPen(majorGridPen);
+    painter->drawLines(majorLines);
 }
 
 void IsometricRenderer::drawTileLayer(const RenderTileCallback &renderTile,
@@ -302,29 +318,18 @@ void IsometricRenderer::drawTileLayer(const RenderTileCallback &renderTile,
     }
 }
 
-void IsometricRenderer::drawTileSelection(QPainter *painter,
-                                          const QRegion &region,
-                                          const QColor &color,
-                                          const QRectF &exposed) const
+QPainterPath IsometricRenderer::tileSelectionPath(const QRegion &region,
+                                                  const QRectF &exposed) const
 {
     QPainterPath path;
 
     for (const QRect &r : region) {
         QPolygonF polygon = tileRectToScreenPolygon(r);
-        if (QRectF(polygon.boundingRect()).intersects(exposed))
+        if (exposed.isNull() || QRectF(polygon.boundingRect()).intersects(exposed))
             path.addPolygon(polygon);
     }
 
-    QColor penColor(color);
-    penColor.setAlpha(255);
-
-    QPen pen(penColor);
-    pen.setCosmetic(true);
-
-    painter->setPen(pen);
-    painter->setBrush(color);
-    painter->setRenderHint(QPainter::Antialiasing, true);
-    painter->drawPath(path.simplified());
+    return path.simplified();
 }
 
 void IsometricRenderer::drawMapObject(QPainter *painter,
@@ -374,13 +379,7 @@ void IsometricRenderer::drawMapObject(QPainter *painter,
         QRectF bounds = { pixelToScreenCoords(object->position()), object->size() };
         bounds.translate(-alignmentOffset(bounds, object->alignment(map())));
 
-        const auto& textData = object->textData();
-
-        painter->setFont(textData.font);
-        painter->setPen(textData.color);
-        painter->drawText(bounds,
-                          textData.text,
-                          textData.textOption());
+        drawTextObject(painter, bounds, object->textData());
     } else {
         const qreal lineWidth = objectLineWidth();
         const qreal scale = painterScale();
@@ -434,7 +433,7 @@ void IsometricRenderer::drawMapObject(QPainter *painter,
         case MapObject::Polygon:
         case MapObject::Polyline: {
             const QPointF &pos = object->position();
-            const QPolygonF polygon = object->polygon().translated(pos);
+            const QPolygonF polygon = object->simplifiedPolygon(polygonTolerance()).translated(pos);
             const QPolygonF screenPolygon = pixelToScreenCoords(polygon);
             const QPointF pointPos = screenPolygon.isEmpty() ? pos
                                                              : screenPolygon.first();
@@ -533,6 +532,75 @@ QPointF IsometricRenderer::pixelToScreenCoords(qreal x, qreal y) const
                    (tileX + tileY) * tileHeight / 2);
 }
 
+void IsometricRenderer::pixelToTileCoords(const QPointF *points, QPointF *result, int count) const
+{
+    const int tileHeight = map()->tileHeight();
+
+    for (int i = 0; i < count; ++i)
+        result[i] = QPointF(points[i].x() / tileHeight,
+                            points[i].y() / tileHeight);
+}
+
+void IsometricRenderer::screenToTileCoords(const QPointF *points, QPointF *result, int count) const
+{
+    const int tileWidth = map()->tileWidth();
+    const int tileHeight = map()->tileHeight();
+    const int originX = map()->height() * tileWidth / 2;
+
+    for (int i = 0; i < count; ++i) {
+        const qreal tileY = points[i].y() / tileHeight;
+        const qreal tileX = (points[i].x() - originX) / tileWidth;
+
+        result[i] = QPointF(tileY + tileX,
+                            tileY - tileX);
+    }
+}
+
+void IsometricRenderer::tileToScreenCoords(const QPointF *points, QPointF *result, int count) const
+{
+    const int tileWidth = map()->tileWidth();
+    const int tileHeight = map()->tileHeight();
+    const int originX = map()->height() * tileWidth / 2;
+
+    for (int i = 0; i < count; ++i) {
+        const qreal x = points[i].x();
+        const qreal y = points[i].y();
+
+        result[i] = QPointF((x - y) * tileWidth / 2 + originX,
+                            (x + y) * tileHeight / 2);
+    }
+}
+
+void IsometricRenderer::screenToPixelCoords(const QPointF *points, QPointF *result, int count) const
+{
+    const int tileWidth = map()->tileWidth();
+    const int tileHeight = map()->tileHeight();
+    const int originX = map()->height() * tileWidth / 2;
+
+    for (int i = 0; i < count; ++i) {
+        const qreal tileY = points[i].y() / tileHeight;
+        const qreal tileX = (points[i].x() - originX) / tileWidth;
+
+        result[i] = QPointF((tileY + tileX) * tileHeight,
+                            (tileY - tileX) * tileHeight);
+    }
+}
+
+void IsometricRenderer::pixelToScreenCoords(const QPointF *points, QPointF *result, int count) const
+{
+    const int tileWidth = map()->tileWidth();
+    const int tileHeight = map()->tileHeight();
+    const int originX = map()->height() * tileWidth / 2;
+
+    for (int i = 0; i < count; ++i) {
+        const qreal tileY = points[i].y() / tileHeight;
+        const qreal tileX = points[i].x() / tileHeight;
+
+        result[i] = QPointF((tileX - tileY) * tileWidth / 2 + originX,
+                            (tileX + tileY) * tileHeight / 2);
+    }
+}
+
 QTransform IsometricRenderer::transform() const
 {
     const qreal tileWidth = map()->tileWidth();
@@ -555,10 +623,9 @@ QTransform IsometricRenderer::transform() const
 QPolygonF IsometricRenderer::pixelRectToScreenPolygon(const QRectF &rect) const
 {
     QPolygonF polygon;
-    polygon << QPointF(pixelToScreenCoords(rect.topLeft()));
-    polygon << QPointF(pixelToScreenCoords(rect.topRight()));
-    polygon << QPointF(pixelToScreenCoords(rect.bottomRight()));
-    polygon << QPointF(pixelToScreenCoords(rect.bottomLeft()));
+    polygon << rect.topLeft() << rect.topRight()
+            << rect.bottomRight() << rect.bottomLeft();
+    IsometricRenderer::pixelToScreenCoords(polygon.constData(), polygon.data(), polygon.size());
     return polygon;
 }
 
@@ -567,12 +634,18 @@ QPolygonF IsometricRenderer::tileRectToScreenPolygon(const QRect &rect) const
     const int tileWidth = map()->tileWidth();
     const int tileHeight = map()->tileHeight();
 
-    const QPointF topRight = tileToScreenCoords(rect.topRight());
-    const QPointF bottomRight = tileToScreenCoords(rect.bottomRight());
-    const QPointF bottomLeft = tileToScreenCoords(rect.bottomLeft());
+    const QPointF corners[] = {
+        rect.topLeft(), rect.topRight(), rect.bottomRight(), rect.bottomLeft()
+    };
+    QPointF screenCorners[4];
+    IsometricRenderer::tileToScreenCoords(corners, screenCorners, 4);
+
+    const QPointF &topRight = screenCorners[1];
+    const QPointF &bottomRight = screenCorners[2];
+    const QPointF &bottomLeft = screenCorners[3];
 
     QPolygonF polygon;
-    polygon << QPointF(tileToScreenCoords(rect.topLeft()));
+    polygon << screenCorners[0];
     polygon << QPointF(topRight.x() + tileWidth / 2,
                        topRight.y() + tileHeight / 2);
     polygon << QPointF(bottomRight.x(), bottomRight.y() + tileHeight);
@@ -57,10 +57,8 @@ public:
     void drawTileLayer(const RenderTileCallback &renderTile,
                        const QRectF &exposed) const override;
 
-    void drawTileSelection(QPainter *painter,
-                           const QRegion &region,
-                           const QColor &color,
-                           const QRectF &exposed) const override;
+    QPainterPath tileSelectionPath(const QRegion &region,
+                                   const QRectF &exposed = QRectF()) const override;
 
     void drawMapObject(QPainter *painter,
                        const MapObject *object,
@@ -84,6 +82,12 @@ public:
     using MapRenderer::pixelToScreenCoords;
     QPointF pixelToScreenCoords(qreal x, qreal y) const override;
 
+    void pixelToTileCoords(const QPointF *points, QPointF *result, int count) const override;
+    void screenToTileCoords(const QPointF *points, QPointF *result, int count) const override;
+    void tileToScreenCoords(const QPointF *points, QPointF *result, int count) const override;
+    void screenToPixelCoords(const QPointF *points, QPointF *result, int count) const override;
+    void pixelToScreenCoords(const QPointF *points, QPointF *result, int count) const override;
+
 private:
     QTransform transform() const;
     QPolygonF pixelRectToScreenPolygon(const QRectF &rect) const;
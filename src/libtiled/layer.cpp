@@ -54,46 +54,56 @@ Layer::Layer(TypeFlag type, const QString &name, int x, int y)
 {
 }
 
-/**
- * Returns the effective opacity, which is the opacity multiplied by the
- * opacity of any parent layers.
- */
-qreal Layer::effectiveOpacity() const
+void Layer::setTintColor(const QColor &tintColor)
 {
-    auto opacity = mOpacity;
-    const Layer *layer = this;
-    while ((layer = layer->parentLayer()))
-        opacity *= layer->opacity();
-    return opacity;
+    mTintColor = tintColor;
+    updateEffectiveProperties();
 }
 
-/**
- * Returns the effective tint color, which is the tint color multiplied by the
- * tint color of any parent layers.
- */
-QColor Layer::effectiveTintColor() const
+void Layer::setOpacity(qreal opacity)
 {
-    auto tintColor = mTintColor.isValid() ? mTintColor
-                                          : QColor(255, 255, 255, 255);
+    mOpacity = opacity;
+    updateEffectiveProperties();
+}
 
-    const Layer *layer = this;
-    while ((layer = layer->parentLayer()))
-        if (layer->tintColor().isValid())
-            tintColor = multiplyColors(tintColor, layer->tintColor());
+void Layer::setVisible(bool visible)
+{
+    mVisible = visible;
+    updateEffectiveProperties();
+}
 
-    return tintColor;
+void Layer::setParentLayer(GroupLayer *groupLayer)
+{
+    mParentLayer = groupLayer;
+    updateEffectiveProperties();
 }
 
 /**
- * Returns whether this layer is hidden. A visible layer may still be hidden,
- * when one of its parent layers is not visible.
+ * Updates the cached effective opacity, tint color, parallax factor and
+ * hidden state of this layer and its child layers, based on their own
+ * properties and those of their parent layers.
  */
-bool Layer::isHidden() const
+void Layer::updateEffectiveProperties()
 {
-    const Layer *layer = this;
-    while (layer && layer->isVisible())
-        layer = layer->parentLayer();
-    return layer;      // encountered an invisible layer
+    const QColor opaqueWhite(255, 255, 255, 255);
+
+    mEffectiveOpacity = mOpacity;
+    mEffectiveTintColor = mTintColor.isValid() ? mTintColor : opaqueWhite;
+    mEffectiveParallaxFactor = mParallaxFactor;
+    mHidden = !mVisible;
+
+    if (const Layer *parent = mParentLayer) {
+        mEffectiveOpacity *= parent->mEffectiveOpacity;
+        if (parent->mEffectiveTintColor != opaqueWhite)
+            mEffectiveTintColor = multiplyColors(mEffectiveTintColor, parent->mEffectiveTintColor);
+        mEffectiveParallaxFactor.rx() *= parent->mEffectiveParallaxFactor.x();
+        mEffectiveParallaxFactor.ry() *= parent->mEffectiveParallaxFactor.y();
+        mHidden = mHidden || parent->mHidden;
+    }
+
+    if (GroupLayer *groupLayer = asGroupLayer())
+        for (Layer *layer : groupLayer->layers())
+            layer->updateEffectiveProperties();
 }
 
 bool Layer::isUnlocked() const
@@ -144,14 +154,16 @@ int Layer::siblingIndex() const
 /**
  * Returns the list of siblings of this layer, including this layer.
  */
-QList<Layer *> Layer::siblings() const
+const QList<Layer *> &Layer::siblings() const
 {
+    static const QList<Layer *> noSiblings;
+
     if (mParentLayer)
         return mParentLayer->layers();
     if (mMap)
         return mMap->layers();
 
-    return QList<Layer *>();
+    return noSiblings;
 }
 
 /**
@@ -167,17 +179,6 @@ QPointF Layer::totalOffset() const
     return offset;
 }
 
-QPointF Layer::effectiveParallaxFactor() const
-{
-    auto factor = mParallaxFactor;
-    const Layer *layer = this;
-    while ((layer = layer->parentLayer())) {
-        factor.rx() *= layer->parallaxFactor().rx();
-        factor.ry() *= layer->parallaxFactor().ry();
-    }
-    return factor;
-}
-
 /**
  * Returns whether this layer can be merged down onto the layer below.
  */
@@ -213,6 +214,7 @@ Layer *Layer::initializeClone(Layer *clone) const
     clone->mVisible = mVisible;
     clone->mLocked = mLocked;
     clone->setProperties(properties());
+    clone->updateEffectiveProperties();
     return clone;
 }
 
@@ -264,7 +266,7 @@ Layer *LayerIterator::next()
                 break;
         }
 
-        const auto siblings = layer->siblings();
+        const auto &siblings = layer->siblings();
 
         // Traverse to parent layer if last child
         if (index == siblings.size()) {
@@ -323,8 +325,7 @@ Layer *LayerIterator::previous()
             // Traverse to previous sibling (possibly of a parent)
             do {
                 if (index >= 0) {
-                    const auto siblings = layer->siblings();
-                    layer = siblings.at(index);
+                    layer = layer->siblings().at(index);
                     break;
                 }
 
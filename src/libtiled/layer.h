@@ -77,7 +77,7 @@ public:
     void setId(int id) { mId = id; }
 
     const QColor &tintColor() const { return mTintColor; }
-    void setTintColor(const QColor &tintColor) { mTintColor = tintColor; }
+    void setTintColor(const QColor &tintColor);
 
     /**
      * Returns the type of this layer.
@@ -102,17 +102,19 @@ public:
     /**
      * Sets the opacity of this layer.
      */
-    void setOpacity(qreal opacity) { mOpacity = opacity; }
+    void setOpacity(qreal opacity);
 
     /**
-     * Returns the effective opacity of this layer
+     * Returns the effective opacity of this layer, which is the opacity
+     * multiplied by the opacity of any parent layers.
      */
-    qreal effectiveOpacity() const;
+    qreal effectiveOpacity() const { return mEffectiveOpacity; }
 
     /**
-     * Returns the effective tint color of this layer
+     * Returns the effective tint color of this layer, which is the tint color
+     * multiplied by the tint color of any parent layers.
      */
-    QColor effectiveTintColor() const;
+    QColor effectiveTintColor() const { return mEffectiveTintColor; }
 
     /**
      * Returns the visibility of this layer.
@@ -129,12 +131,16 @@ public:
      */
     bool isUnlocked() const;
 
-    bool isHidden() const;
+    /**
+     * Returns whether this layer is hidden. A visible layer may still be
+     * hidden, when one of its parent layers is not visible.
+     */
+    bool isHidden() const { return mHidden; }
 
     /**
      * Sets the visibility of this layer.
      */
-    void setVisible(bool visible) { mVisible = visible; }
+    void setVisible(bool visible);
 
     void setLocked(bool locked) { mLocked = locked; }
 
@@ -151,7 +157,7 @@ public:
     bool isParentOrSelf(const Layer *candidate) const;
     int depth() const;
     int siblingIndex() const;
-    QList<Layer*> siblings() const;
+    const QList<Layer*> &siblings() const;
 
     /**
      * Returns the x position of this layer (in tiles).
@@ -190,7 +196,7 @@ public:
 
     void setParallaxFactor(const QPointF &factor);
     QPointF parallaxFactor() const;
-    QPointF effectiveParallaxFactor() const;
+    QPointF effectiveParallaxFactor() const { return mEffectiveParallaxFactor; }
 
     bool canMergeDown() const;
 
@@ -252,10 +258,12 @@ protected:
      * Map class.
      */
     virtual void setMap(Map *map) { mMap = map; }
-    void setParentLayer(GroupLayer *groupLayer) { mParentLayer = groupLayer; }
+    void setParentLayer(GroupLayer *groupLayer);
 
     Layer *initializeClone(Layer *clone) const;
 
+    void updateEffectiveProperties();
+
     QString mName;
     int mId = 0;
     TypeFlag mLayerType;
@@ -270,6 +278,13 @@ protected:
     GroupLayer *mParentLayer = nullptr;
     bool mLocked = false;
 
+    // Cached values depending on the parent layers, which are updated by the
+    // setters, so that they can be queried while painting
+    qreal mEffectiveOpacity = 1.0;
+    QColor mEffectiveTintColor = QColor(255, 255, 255, 255);
+    QPointF mEffectiveParallaxFactor = { 1.0, 1.0 };
+    bool mHidden = false;
+
     friend class Map;
     friend class GroupLayer;
 };
@@ -297,6 +312,7 @@ inline QPointF Layer::offset() const
 inline void Layer::setParallaxFactor(const QPointF &factor)
 {
     mParallaxFactor = factor;
+    updateEffectiveProperties();
 }
 
 /**
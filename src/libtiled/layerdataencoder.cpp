@@ -0,0 +1,214 @@
+/*
+ * layerdataencoder.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "layerdataencoder.h"
+
+#include "compression.h"
+#include "gidmapper.h"
+#include "grouplayer.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+
+using namespace Tiled;
+
+struct LayerDataEncoder::Job
+{
+    const TileLayer *tileLayer;
+    QRect bounds;
+    QByteArray data;
+};
+
+void LayerDataEncoder::collectJobs(const Layer &layer, bool infinite, QSize chunkSize,
+                                   QVector<Job> &jobs)
+{
+    if (layer.isTileLayer()) {
+        auto &tileLayer = static_cast<const TileLayer&>(layer);
+
+        if (infinite) {
+            const auto chunks = tileLayer.sortedChunksToWrite(chunkSize);
+            for (const QRect &rect : chunks)
+                jobs.append({ &tileLayer, rect, QByteArray() });
+        } else {
+            jobs.append({ &tileLayer,
+                          QRect(0, 0, tileLayer.width(), tileLayer.height()),
+                          QByteArray() });
+        }
+    } else if (layer.isGroupLayer()) {
+        for (const Layer *childLayer : static_cast<const GroupLayer&>(layer).layers())
+            collectJobs(*childLayer, infinite, chunkSize, jobs);
+    }
+}
+
+/**
+ * Encodes the data of all tile layers in the given \a map, in parallel.
+ *
+ * For infinite maps, the data is split up in chunks of \a chunkSize, matching
+ * TileLayer::sortedChunksToWrite(). Nothing is done for the XML and CSV
+ * formats, since these are written directly by the writers.
+ */
+void LayerDataEncoder::encode(const Map &map,
+                              const GidMapper &gidMapper,
+                              Map::LayerDataFormat format,
+                              QSize chunkSize,
+                              int compressionLevel)
+{
+    clear();
+
+    if (format == Map::XML || format == Map::CSV)
+        return;
+
+    QVector<Job> jobs;
+    for (const Layer *layer : map.layers())
+        collectJobs(*layer, map.infinite(), chunkSize, jobs);
+
+    run(jobs, gidMapper, format, compressionLevel);
+}
+
+/**
+ * Encodes the data of the given \a layer, which may also be a group layer,
+ * in parallel. The layer needs to be part of a map.
+ *
+ * \overload
+ */
+void LayerDataEncoder::encode(const Layer &layer,
+                              const GidMapper &gidMapper,
+                              Map::LayerDataFormat format,
+                              QSize chunkSize,
+                              int compressionLevel)
+{
+    Q_ASSERT(layer.map());
+
+    clear();
+
+    if (format == Map::XML || format == Map::CSV)
+        return;
+
+    QVector<Job> jobs;
+    collectJobs(layer, layer.map()->infinite(), chunkSize, jobs);
+
+    run(jobs, gidMapper, format, compressionLevel);
+}
+
+void LayerDataEncoder::run(QVector<Job> &jobs,
+                           const GidMapper &gidMapper,
+                           Map::LayerDataFormat format,
+                           int compressionLevel)
+{
+    // Encoding only reads from the layers and the GidMapper
+    QtConcurrent::blockingMap(jobs, [&] (Job &job) {
+        job.data = gidMapper.encodeLayerData(*job.tileLayer, format,
+                                             job.bounds, compressionLevel,
+                                             mDictionary);
+    });
+
+    mEncodedData.reserve(jobs.size());
+    for (const Job &job : std::as_const(jobs))
+        mEncodedData.insert({ job.tileLayer, job.bounds }, job.data);
+}
+
+/**
+ * Clears the encoded data. The dictionary is kept.
+ */
+void LayerDataEncoder::clear()
+{
+    mEncodedData.clear();
+}
+
+/**
+ * Returns the pre-encoded data for the given \a bounds of \a tileLayer, or
+ * a null QByteArray when this data has not been encoded.
+ */
+QByteArray LayerDataEncoder::encodedData(const TileLayer &tileLayer, QRect bounds) const
+{
+    return mEncodedData.value({ &tileLayer, bounds });
+}
+
+/**
+ * Sets up the dictionary to use for the given \a map. When the map uses a
+ * dictionary, it is trained on the current layer data, falling back to the
+ * dictionary the map was loaded with when training fails.
+ */
+void LayerDataEncoder::prepareDictionary(const Map &map,
+                                         const GidMapper &gidMapper,
+                                         QSize chunkSize)
+{
+    mDictionary.clear();
+
+    if (!usesDictionary(map))
+        return;
+
+    mDictionary = trainDictionary(map, gidMapper, chunkSize);
+    if (mDictionary.isNull())
+        mDictionary = map.compressionDictionary();
+}
+
+/**
+ * Returns whether the layer data of the given \a map should be compressed
+ * using a dictionary.
+ */
+bool LayerDataEncoder::usesDictionary(const Map &map)
+{
+    return map.useCompressionDictionary() &&
+            map.layerDataFormat() == Map::Base64Zstandard &&
+            compressionSupported(Zstandard);
+}
+
+/**
+ * Trains a compression dictionary on the tile layer data of the given \a map.
+ *
+ * Since training on large amounts of data takes a long time, a limited
+ * selection of the chunks is used as samples. Returns a null QByteArray
+ * when training failed, which is usually due to a lack of data.
+ */
+QByteArray LayerDataEncoder::trainDictionary(const Map &map,
+                                             const GidMapper &gidMapper,
+                                             QSize chunkSize)
+{
+    constexpr int MaxSamplesSize = 1024 * 1024;
+
+    QVector<Job> jobs;
+    for (const Layer *layer : map.layers())
+        collectJobs(*layer, map.infinite(), chunkSize, jobs);
+
+    qint64 totalSize = 0;
+    for (const Job &job : std::as_const(jobs))
+        totalSize += qint64(job.bounds.width()) * job.bounds.height() * 4;
+
+    const int step = std::max<qint64>(1, totalSize / MaxSamplesSize);
+
+    QVector<QByteArray> samples;
+    for (int i = 0; i < jobs.size(); i += step) {
+        const Job &job = jobs.at(i);
+        samples.append(gidMapper.uncompressedLayerData(*job.tileLayer, job.bounds));
+    }
+
+    return trainCompressionDictionary(samples);
+}
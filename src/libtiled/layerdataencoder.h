@@ -0,0 +1,129 @@
+/*
+ * layerdataencoder.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#pragma once
+
+#include "map.h"
+#include "tilelayer.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QRect>
+
+namespace Tiled {
+
+class GidMapper;
+
+/**
+ * Encodes the base64 (and optionally compressed) tile layer data of a whole
+ * map up front, compressing all layers and chunks concurrently.
+ *
+ * The writers look up the pre-encoded data while they write out the layers
+ * in order, falling back to encoding on the spot for any data that wasn't
+ * prepared.
+ *
+ * It also takes care of training the compression dictionary, for maps that
+ * use one.
+ */
+class TILEDSHARED_EXPORT LayerDataEncoder
+{
+public:
+    void encode(const Map &map,
+                const GidMapper &gidMapper,
+                Map::LayerDataFormat format,
+                QSize chunkSize,
+                int compressionLevel);
+
+    void encode(const Layer &layer,
+                const GidMapper &gidMapper,
+                Map::LayerDataFormat format,
+                QSize chunkSize,
+                int compressionLevel);
+
+    void clear();
+
+    QByteArray encodedData(const TileLayer &tileLayer, QRect bounds) const;
+
+    void setDictionary(const QByteArray &dictionary);
+    const QByteArray &dictionary() const;
+
+    void prepareDictionary(const Map &map,
+                           const GidMapper &gidMapper,
+                           QSize chunkSize);
+
+    static bool usesDictionary(const Map &map);
+    static QByteArray trainDictionary(const Map &map,
+                                      const GidMapper &gidMapper,
+                                      QSize chunkSize);
+
+private:
+    struct Job;
+
+    static void collectJobs(const Layer &layer, bool infinite, QSize chunkSize,
+                            QVector<Job> &jobs);
+    void run(QVector<Job> &jobs,
+             const GidMapper &gidMapper,
+             Map::LayerDataFormat format,
+             int compressionLevel);
+
+    struct Key
+    {
+        const TileLayer *tileLayer;
+        QRect bounds;
+
+        bool operator==(const Key &other) const
+        {
+            return tileLayer == other.tileLayer && bounds == other.bounds;
+        }
+    };
+
+    // Chunks never overlap, so their top-left corner identifies them
+    friend uint qHash(const Key &key, uint seed = 0) Q_DECL_NOTHROW
+    {
+        return qHash(key.tileLayer, seed) ^ qHash(key.bounds.topLeft(), seed);
+    }
+
+    QHash<Key, QByteArray> mEncodedData;
+    QByteArray mDictionary;
+};
+
+/**
+ * Sets the \a dictionary used for Zstandard compression.
+ */
+inline void LayerDataEncoder::setDictionary(const QByteArray &dictionary)
+{
+    mDictionary = dictionary;
+}
+
+inline const QByteArray &LayerDataEncoder::dictionary() const
+{
+    return mDictionary;
+}
+
+} // namespace Tiled
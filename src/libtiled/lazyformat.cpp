@@ -0,0 +1,164 @@
+/*
+ * lazyformat.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "lazyformat.h"
+
+#include "pluginmanager.h"
+
+#include <QCoreApplication>
+#include <QJsonObject>
+
+namespace Tiled {
+
+LazyFormatInfo::LazyFormatInfo(const QString &pluginFileName, const QJsonObject &json)
+    : pluginFileName(pluginFileName)
+    , shortName(json.value(QLatin1String("shortName")).toString())
+    , nameFilter(json.value(QLatin1String("nameFilter")).toString())
+    , context(json.value(QLatin1String("context")).toString().toUtf8())
+{
+}
+
+bool LazyFormatInfo::isValid() const
+{
+    return !shortName.isEmpty() && !nameFilter.isEmpty();
+}
+
+/**
+ * Returns the name filter, translated the same way as the plugin would
+ * translate it when the translation context is given.
+ */
+QString LazyFormatInfo::translatedNameFilter() const
+{
+    if (context.isEmpty())
+        return nameFilter;
+
+    const QByteArray sourceText = nameFilter.toUtf8();
+    return QCoreApplication::translate(context.constData(), sourceText.constData());
+}
+
+/**
+ * Loads the plugin and returns its format with the same short name, or
+ * nullptr when the plugin could not be loaded or doesn't provide it.
+ */
+template<typename Format>
+Format *LazyFormatInfo::load() const
+{
+    if (!PluginManager::instance()->loadDeferredPlugin(pluginFileName))
+        return nullptr;
+
+    return PluginManager::find<Format>([this] (Format *format) {
+        return format->shortName() == shortName;
+    });
+}
+
+
+LazyMapFormat::LazyMapFormat(const LazyFormatInfo &info, QObject *parent)
+    : WritableMapFormat(parent)
+    , mInfo(info)
+{
+}
+
+QStringList LazyMapFormat::outputFiles(const Map *map, const QString &fileName) const
+{
+    if (MapFormat *mapFormat = format())
+        return mapFormat->outputFiles(map, fileName);
+    return WritableMapFormat::outputFiles(map, fileName);
+}
+
+bool LazyMapFormat::write(const Map *map, const QString &fileName, Options options)
+{
+    if (MapFormat *mapFormat = format())
+        return mapFormat->write(map, fileName, options);
+    return false;
+}
+
+QString LazyMapFormat::nameFilter() const
+{
+    return mInfo.translatedNameFilter();
+}
+
+QString LazyMapFormat::shortName() const
+{
+    return mInfo.shortName;
+}
+
+QString LazyMapFormat::errorString() const
+{
+    if (mFormat)
+        return mFormat->errorString();
+    return tr("Failed to load plugin '%1'").arg(mInfo.pluginFileName);
+}
+
+MapFormat *LazyMapFormat::format() const
+{
+    if (!mFormat)
+        mFormat = mInfo.load<MapFormat>();
+    return mFormat;
+}
+
+
+LazyTilesetFormat::LazyTilesetFormat(const LazyFormatInfo &info, QObject *parent)
+    : WritableTilesetFormat(parent)
+    , mInfo(info)
+{
+}
+
+bool LazyTilesetFormat::write(const Tileset &tileset, const QString &fileName, Options options)
+{
+    if (TilesetFormat *tilesetFormat = format())
+        return tilesetFormat->write(tileset, fileName, options);
+    return false;
+}
+
+QString LazyTilesetFormat::nameFilter() const
+{
+    return mInfo.translatedNameFilter();
+}
+
+QString LazyTilesetFormat::shortName() const
+{
+    return mInfo.shortName;
+}
+
+QString LazyTilesetFormat::errorString() const
+{
+    if (mFormat)
+        return mFormat->errorString();
+    return tr("Failed to load plugin '%1'").arg(mInfo.pluginFileName);
+}
+
+TilesetFormat *LazyTilesetFormat::format() const
+{
+    if (!mFormat)
+        mFormat = mInfo.load<TilesetFormat>();
+    return mFormat;
+}
+
+} // namespace Tiled
+
+#include "moc_lazyformat.cpp"
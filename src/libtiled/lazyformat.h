@@ -0,0 +1,107 @@
+/*
+ * lazyformat.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "mapformat.h"
+#include "tilesetformat.h"
+
+class QJsonObject;
+
+namespace Tiled {
+
+/**
+ * The information needed to stand in for a format of a plugin that has not
+ * been loaded yet, as provided by the "formats" array in its metadata.
+ */
+struct TILEDSHARED_EXPORT LazyFormatInfo
+{
+    LazyFormatInfo(const QString &pluginFileName, const QJsonObject &json);
+
+    bool isValid() const;
+    QString translatedNameFilter() const;
+
+    template<typename Format>
+    Format *load() const;
+
+    QString pluginFileName;
+    QString shortName;
+    QString nameFilter;
+    QByteArray context;
+};
+
+/**
+ * Stands in for a write-only map format of a plugin that has not been loaded
+ * yet. The plugin is loaded once the format is used for writing.
+ */
+class TILEDSHARED_EXPORT LazyMapFormat : public WritableMapFormat
+{
+    Q_OBJECT
+
+public:
+    LazyMapFormat(const LazyFormatInfo &info, QObject *parent = nullptr);
+
+    QStringList outputFiles(const Map *map, const QString &fileName) const override;
+    bool write(const Map *map, const QString &fileName, Options options) override;
+
+    QString nameFilter() const override;
+    QString shortName() const override;
+    QString errorString() const override;
+
+private:
+    MapFormat *format() const;
+
+    const LazyFormatInfo mInfo;
+    mutable MapFormat *mFormat = nullptr;
+};
+
+/**
+ * Stands in for a write-only tileset format of a plugin that has not been
+ * loaded yet. The plugin is loaded once the format is used for writing.
+ */
+class TILEDSHARED_EXPORT LazyTilesetFormat : public WritableTilesetFormat
+{
+    Q_OBJECT
+
+public:
+    LazyTilesetFormat(const LazyFormatInfo &info, QObject *parent = nullptr);
+
+    bool write(const Tileset &tileset, const QString &fileName, Options options) override;
+
+    QString nameFilter() const override;
+    QString shortName() const override;
+    QString errorString() const override;
+
+private:
+    TilesetFormat *format() const;
+
+    const LazyFormatInfo mInfo;
+    mutable TilesetFormat *mFormat = nullptr;
+};
+
+} // namespace Tiled
@@ -37,7 +37,7 @@
 
 namespace Tiled {
 
-unsigned Issue::mNextIssueId = 1;
+std::atomic<unsigned> Issue::mNextIssueId { 1 };
 
 Issue::Issue()
     : Issue(Error, QString())
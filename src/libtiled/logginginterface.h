@@ -35,6 +35,7 @@
 #include <QPoint>
 #include <QWeakPointer>
 
+#include <atomic>
 #include <functional>
 
 class QString;
@@ -91,7 +92,7 @@ private:
     int mOccurrences = 1;
     unsigned mId = 0;
 
-    static unsigned mNextIssueId;
+    static std::atomic<unsigned> mNextIssueId;
 };
 
 /**
@@ -363,6 +363,7 @@ std::unique_ptr<Map> Map::clone() const
     o->exportFileName = exportFileName;
     o->exportFormat = exportFormat;
     o->mEditorSettings = mEditorSettings;
+    o->mCompressionDictionary = mCompressionDictionary;
     o->mDrawMargins = mDrawMargins;
     o->mDrawMarginsDirty = mDrawMarginsDirty;
     for (const Layer *layer : mLayers) {
@@ -455,13 +456,13 @@ QList<MapObject*> Map::replaceObjectTemplate(const ObjectTemplate *oldObjectTemp
 
     QList<MapObject*> changedObjects;
 
-    for (auto layer : objectGroups()) {
-        for (auto o : static_cast<ObjectGroup*>(layer)->objects()) {
-            if (o->objectTemplate() == oldObjectTemplate) {
-                o->setObjectTemplate(newObjectTemplate);
-                o->syncWithTemplate();
-                changedObjects.append(o);
-            }
+    // Copy the instances, since changing the template removes them
+    const auto instances = oldObjectTemplate->instances();
+    for (auto o : instances) {
+        if (o->map() == this) {
+            o->setObjectTemplate(newObjectTemplate);
+            o->syncWithTemplate();
+            changedObjects.append(o);
         }
     }
 
@@ -485,15 +486,66 @@ Layer *Map::findLayerById(int layerId) const
     return nullptr;
 }
 
+/**
+ * Returns the object with the given \a objectId, or nullptr when there is
+ * no such object on this map.
+ *
+ * Uses a lookup table, which is created on first use and kept up to date by
+ * the object groups.
+ */
 MapObject *Map::findObjectById(int objectId) const
 {
-    for (Layer *layer : objectGroups()) {
-        for (MapObject *mapObject : static_cast<ObjectGroup*>(layer)->objects()) {
-            if (mapObject->id() == objectId)
-                return mapObject;
+    if (!mObjectsByIdValid) {
+        mObjectsById.clear();
+        mDuplicateObjectIds = false;
+
+        // In case of duplicate IDs, the first object is found
+        for (Layer *layer : objectGroups()) {
+            for (MapObject *mapObject : static_cast<ObjectGroup*>(layer)->objects()) {
+                if (mObjectsById.contains(mapObject->id()))
+                    mDuplicateObjectIds = true;
+                else
+                    mObjectsById.insert(mapObject->id(), mapObject);
+            }
         }
+
+        mObjectsByIdValid = true;
     }
-    return nullptr;
+
+    return mObjectsById.value(objectId);
+}
+
+void Map::objectAdded(MapObject *object)
+{
+    if (!mObjectsByIdValid)
+        return;
+
+    // Rebuild when needed, to find the first of any duplicates
+    if (mObjectsById.contains(object->id()))
+        mObjectsByIdValid = false;
+    else
+        mObjectsById.insert(object->id(), object);
+}
+
+void Map::objectRemoved(MapObject *object)
+{
+    if (!mObjectsByIdValid)
+        return;
+
+    auto it = mObjectsById.find(object->id());
+    if (it == mObjectsById.end() || it.value() != object)
+        return;
+
+    // Another object with the same ID may need to take its place
+    if (mDuplicateObjectIds)
+        mObjectsByIdValid = false;
+    else
+        mObjectsById.erase(it);
+}
+
+void Map::objectIdChanged()
+{
+    mObjectsByIdValid = false;
 }
 
 /**
@@ -610,6 +662,10 @@ QString Tiled::compressionToString(Map::LayerDataFormat layerDataFormat)
         return QStringLiteral("zlib");
     case Map::Base64Zstandard:
         return QStringLiteral("zstd");
+    case Map::Base64RunLength:
+        return QStringLiteral("rle");
+    case Map::Base64RunLengthZstandard:
+        return QStringLiteral("rle+zstd");
     }
     return QString();
 }
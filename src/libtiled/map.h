@@ -34,7 +34,9 @@
 #include "object.h"
 #include "tileset.h"
 
+#include <QByteArray>
 #include <QColor>
+#include <QHash>
 #include <QList>
 #include <QMargins>
 #include <QSharedPointer>
@@ -90,7 +92,8 @@ public:
         BackgroundColorProperty,
         LayerDataFormatProperty,
         CompressionLevelProperty,
-        ChunkSizeProperty
+        ChunkSizeProperty,
+        CompressionDictionaryProperty
     };
 
     /**
@@ -110,14 +113,19 @@ public:
 
     /**
      * The different formats in which the tile layer data can be stored.
+     *
+     * The run-length encoded formats store pairs of 32-bit little-endian
+     * values, a run length followed by the global tile ID repeated by the run.
      */
     enum LayerDataFormat {
-        XML             = 0,
-        Base64          = 1,
-        Base64Gzip      = 2,
-        Base64Zlib      = 3,
-        Base64Zstandard = 4,
-        CSV             = 5
+        XML                         = 0,
+        Base64                      = 1,
+        Base64Gzip                  = 2,
+        Base64Zlib                  = 3,
+        Base64Zstandard             = 4,
+        CSV                         = 5,
+        Base64RunLength             = 6,
+        Base64RunLengthZstandard    = 7
     };
 
     /**
@@ -170,6 +178,7 @@ public:
         int compressionLevel = -1;
         QSize chunkSize = QSize(CHUNK_SIZE, CHUNK_SIZE);
         LayerDataFormat layerDataFormat = Base64Zlib;
+        bool useCompressionDictionary = false;
     };
 
     Map();
@@ -197,6 +206,12 @@ public:
     int compressionLevel() const;
     void setCompressionLevel(int compressionLevel);
 
+    bool useCompressionDictionary() const;
+    void setUseCompressionDictionary(bool enabled);
+
+    const QByteArray &compressionDictionary() const;
+    void setCompressionDictionary(const QByteArray &dictionary);
+
     int width() const;
     void setWidth(int width);
 
@@ -318,13 +333,19 @@ public:
 
 private:
     friend class GroupLayer;    // so it can call adoptLayer
+    friend class ObjectGroup;   // so it can keep mObjectsById up to date
 
     void adoptLayer(Layer &layer);
 
+    void objectAdded(MapObject *object);
+    void objectRemoved(MapObject *object);
+    void objectIdChanged();
+
     void recomputeDrawMargins() const;
 
     Parameters mParameters;
     EditorSettings mEditorSettings;
+    QByteArray mCompressionDictionary;
 
     mutable QMargins mDrawMargins;
     mutable bool mDrawMarginsDirty = true;
@@ -334,6 +355,10 @@ private:
 
     int mNextLayerId = 1;
     int mNextObjectId = 1;
+
+    mutable QHash<int, MapObject*> mObjectsById;
+    mutable bool mObjectsByIdValid = false;
+    mutable bool mDuplicateObjectIds = false;
 };
 
 
@@ -375,6 +400,36 @@ inline void Map::setCompressionLevel(int compressionLevel)
     mEditorSettings.compressionLevel = compressionLevel;
 }
 
+/**
+ * Returns whether a dictionary is used for compressing the tile layer data.
+ * Only applies to the Base64Zstandard layer data format.
+ *
+ * When enabled, the dictionary is trained on the layer data whenever the
+ * map is saved and it is stored along with the map.
+ */
+inline bool Map::useCompressionDictionary() const
+{
+    return mEditorSettings.useCompressionDictionary;
+}
+
+inline void Map::setUseCompressionDictionary(bool enabled)
+{
+    mEditorSettings.useCompressionDictionary = enabled;
+}
+
+/**
+ * Returns the compression dictionary the map was loaded with, if any.
+ */
+inline const QByteArray &Map::compressionDictionary() const
+{
+    return mCompressionDictionary;
+}
+
+inline void Map::setCompressionDictionary(const QByteArray &dictionary)
+{
+    mCompressionDictionary = dictionary;
+}
+
 /**
  * Returns the width of this map in tiles.
  */
@@ -0,0 +1,486 @@
+/*
+ * mapdiff.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mapdiff.h"
+
+#include "imagelayer.h"
+#include "map.h"
+#include "mapobject.h"
+#include "objectgroup.h"
+#include "objecttemplate.h"
+#include "tilelayer.h"
+#include "tileregion.h"
+#include "tileset.h"
+
+#include <QHash>
+
+namespace Tiled {
+
+namespace {
+
+class MapComparison
+{
+public:
+    MapComparison(const Map &oldMap, const Map &newMap);
+
+    MapDiff compare();
+
+private:
+    void compareTilesets(MapDiff &diff);
+    bool haveSameParameters() const;
+
+    bool isSameCell(const Cell &a, const Cell &b) const;
+    bool isSameObject(const MapObject &a, const MapObject &b) const;
+    bool haveSameAttributes(const Layer &a, const Layer &b) const;
+
+    QRegion changedCells(const TileLayer &a, const TileLayer &b) const;
+    void compareObjects(const ObjectGroup &a, const ObjectGroup &b,
+                        LayerDiff &diff) const;
+
+    const Map &mOldMap;
+    const Map &mNewMap;
+
+    // Maps the tilesets of the old map to the matching ones of the new map
+    QHash<const Tileset*, const Tileset*> mTilesetMapping;
+    bool mSharedTilesets = true;
+};
+
+MapComparison::MapComparison(const Map &oldMap, const Map &newMap)
+    : mOldMap(oldMap)
+    , mNewMap(newMap)
+{
+}
+
+static QString tilesetKey(const Tileset &tileset)
+{
+    return tileset.isExternal() ? tileset.fileName() : tileset.name();
+}
+
+MapDiff MapComparison::compare()
+{
+    MapDiff diff;
+
+    compareTilesets(diff);
+    if (!haveSameParameters())
+        diff.mapChanged = true;
+
+    QHash<int, const Layer*> oldLayers;
+    for (const Layer *layer : mOldMap.allLayers())
+        oldLayers.insert(layer->id(), layer);
+
+    for (const Layer *layer : mNewMap.allLayers()) {
+        const Layer *oldLayer = oldLayers.take(layer->id());
+
+        LayerDiff layerDiff;
+        layerDiff.id = layer->id();
+        layerDiff.name = layer->name();
+        layerDiff.type = layer->layerType();
+
+        if (!oldLayer || oldLayer->layerType() != layer->layerType()) {
+            if (oldLayer) {
+                LayerDiff removed = layerDiff;
+                removed.change = LayerDiff::Removed;
+                removed.name = oldLayer->name();
+                removed.type = oldLayer->layerType();
+                diff.layers.append(removed);
+            }
+
+            layerDiff.change = LayerDiff::Added;
+            diff.layers.append(layerDiff);
+            continue;
+        }
+
+        layerDiff.attributesChanged = !haveSameAttributes(*oldLayer, *layer);
+
+        switch (layer->layerType()) {
+        case Layer::TileLayerType:
+            layerDiff.changedCells = changedCells(*static_cast<const TileLayer*>(oldLayer),
+                                                  *static_cast<const TileLayer*>(layer));
+            break;
+        case Layer::ObjectGroupType:
+            compareObjects(*static_cast<const ObjectGroup*>(oldLayer),
+                           *static_cast<const ObjectGroup*>(layer),
+                           layerDiff);
+            break;
+        case Layer::ImageLayerType:
+        case Layer::GroupLayerType:
+            break;
+        }
+
+        if (layerDiff.attributesChanged ||
+                !layerDiff.changedCells.isEmpty() ||
+                !layerDiff.addedObjects.isEmpty() ||
+                !layerDiff.removedObjects.isEmpty() ||
+                !layerDiff.changedObjects.isEmpty()) {
+            diff.layers.append(layerDiff);
+        }
+    }
+
+    // Any layers left were removed, reported in the order of the old map
+    for (const Layer *layer : mOldMap.allLayers()) {
+        if (!oldLayers.contains(layer->id()))
+            continue;
+
+        LayerDiff layerDiff;
+        layerDiff.change = LayerDiff::Removed;
+        layerDiff.id = layer->id();
+        layerDiff.name = layer->name();
+        layerDiff.type = layer->layerType();
+        diff.layers.append(layerDiff);
+    }
+
+    return diff;
+}
+
+void MapComparison::compareTilesets(MapDiff &diff)
+{
+    const auto &newTilesets = mNewMap.tilesets();
+
+    QHash<QString, int> newIndexes;
+    for (int i = 0; i < newTilesets.size(); ++i)
+        newIndexes.insert(tilesetKey(*newTilesets.at(i)), i);
+
+    int lastIndex = -1;
+
+    for (const SharedTileset &tileset : mOldMap.tilesets()) {
+        const QString key = tilesetKey(*tileset);
+        const auto it = newIndexes.find(key);
+
+        if (it == newIndexes.end()) {
+            diff.removedTilesets.append(key);
+            continue;
+        }
+
+        const int index = it.value();
+        newIndexes.erase(it);
+
+        const Tileset *newTileset = newTilesets.at(index).data();
+        mTilesetMapping.insert(tileset.data(), newTileset);
+        if (newTileset != tileset.data())
+            mSharedTilesets = false;
+
+        // Reordering the tilesets changes the global tile IDs
+        if (index < lastIndex)
+            diff.mapChanged = true;
+        lastIndex = index;
+    }
+
+    for (const SharedTileset &tileset : newTilesets) {
+        const QString key = tilesetKey(*tileset);
+        if (newIndexes.contains(key))
+            diff.addedTilesets.append(key);
+    }
+}
+
+bool MapComparison::haveSameParameters() const
+{
+    const Map::Parameters &p = mOldMap.parameters();
+    const Map::Parameters &q = mNewMap.parameters();
+
+    return p.orientation == q.orientation
+            && p.renderOrder == q.renderOrder
+            && p.width == q.width
+            && p.height == q.height
+            && p.tileWidth == q.tileWidth
+            && p.tileHeight == q.tileHeight
+            && p.infinite == q.infinite
+            && p.hexSideLength == q.hexSideLength
+            && p.staggerAxis == q.staggerAxis
+            && p.staggerIndex == q.staggerIndex
+            && p.parallaxOrigin == q.parallaxOrigin
+            && p.backgroundColor == q.backgroundColor
+            && mOldMap.compressionLevel() == mNewMap.compressionLevel()
+            && mOldMap.chunkSize() == mNewMap.chunkSize()
+            && mOldMap.layerDataFormat() == mNewMap.layerDataFormat()
+            && mOldMap.useCompressionDictionary() == mNewMap.useCompressionDictionary()
+            && mOldMap.nextLayerId() == mNewMap.nextLayerId()
+            && mOldMap.nextObjectId() == mNewMap.nextObjectId()
+            && mOldMap.className() == mNewMap.className()
+            && mOldMap.properties() == mNewMap.properties();
+}
+
+bool MapComparison::isSameCell(const Cell &a, const Cell &b) const
+{
+    if (a.isEmpty() || b.isEmpty())
+        return a.isEmpty() == b.isEmpty();
+
+    return mTilesetMapping.value(a.tileset()) == b.tileset()
+            && a.tileId() == b.tileId()
+            && a.flags() == b.flags();
+}
+
+bool MapComparison::isSameObject(const MapObject &a, const MapObject &b) const
+{
+    const ObjectTemplate *t = a.objectTemplate();
+    const ObjectTemplate *u = b.objectTemplate();
+    if ((t ? t->fileName() : QString()) != (u ? u->fileName() : QString()))
+        return false;
+
+    const TextData &text = a.textData();
+    const TextData &otherText = b.textData();
+
+    return a.name() == b.name()
+            && a.className() == b.className()
+            && a.shape() == b.shape()
+            && a.position() == b.position()
+            && a.size() == b.size()
+            && a.rotation() == b.rotation()
+            && a.isVisible() == b.isVisible()
+            && isSameCell(a.cell(), b.cell())
+            && a.polygon() == b.polygon()
+            && a.changedProperties() == b.changedProperties()
+            && a.properties() == b.properties()
+            && text.text == otherText.text
+            && text.font == otherText.font
+            && text.color == otherText.color
+            && text.alignment == otherText.alignment
+            && text.wordWrap == otherText.wordWrap;
+}
+
+bool MapComparison::haveSameAttributes(const Layer &a, const Layer &b) const
+{
+    const int parentId = a.parentLayer() ? a.parentLayer()->id() : 0;
+    const int otherParentId = b.parentLayer() ? b.parentLayer()->id() : 0;
+
+    if (a.name() != b.name()
+            || a.className() != b.className()
+            || a.opacity() != b.opacity()
+            || a.tintColor() != b.tintColor()
+            || a.isVisible() != b.isVisible()
+            || a.isLocked() != b.isLocked()
+            || a.position() != b.position()
+            || a.offset() != b.offset()
+            || a.parallaxFactor() != b.parallaxFactor()
+            || a.properties() != b.properties()
+            || parentId != otherParentId
+            || a.siblingIndex() != b.siblingIndex())
+        return false;
+
+    switch (a.layerType()) {
+    case Layer::TileLayerType:
+        return static_cast<const TileLayer&>(a).size() ==
+                static_cast<const TileLayer&>(b).size();
+    case Layer::ObjectGroupType: {
+        auto &objectGroup = static_cast<const ObjectGroup&>(a);
+        auto &otherObjectGroup = static_cast<const ObjectGroup&>(b);
+        return objectGroup.color() == otherObjectGroup.color()
+                && objectGroup.drawOrder() == otherObjectGroup.drawOrder();
+    }
+    case Layer::ImageLayerType: {
+        auto &imageLayer = static_cast<const ImageLayer&>(a);
+        auto &otherImageLayer = static_cast<const ImageLayer&>(b);
+        return imageLayer.imageSource() == otherImageLayer.imageSource()
+                && imageLayer.transparentColor() == otherImageLayer.transparentColor()
+                && imageLayer.repeatX() == otherImageLayer.repeatX()
+                && imageLayer.repeatY() == otherImageLayer.repeatY();
+    }
+    case Layer::GroupLayerType:
+        break;
+    }
+
+    return true;
+}
+
+QRegion MapComparison::changedCells(const TileLayer &a, const TileLayer &b) const
+{
+    // With shared tilesets, cells can be compared directly, which allows
+    // skipping over chunks that have the same cells
+    if (mSharedTilesets)
+        return a.computeDiffRegion(b).translated(a.position());
+
+    const QRect bounds = a.bounds().united(b.bounds());
+    TileRegion region;
+
+    for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
+        for (int x = bounds.left(); x <= bounds.right(); ++x) {
+            const QPoint pos(x, y);
+            if (!isSameCell(a.cellAt(pos - a.position()), b.cellAt(pos - b.position()))) {
+                const int rangeStart = x;
+                while (x <= bounds.right() &&
+                       !isSameCell(a.cellAt(QPoint(x, y) - a.position()),
+                                   b.cellAt(QPoint(x, y) - b.position()))) {
+                    ++x;
+                }
+                region.addSpan(rangeStart, y, x - rangeStart);
+            }
+        }
+    }
+
+    return region.toRegion();
+}
+
+void MapComparison::compareObjects(const ObjectGroup &a, const ObjectGroup &b,
+                                   LayerDiff &diff) const
+{
+    QHash<int, int> oldIndexes;
+    for (int i = 0; i < a.objectCount(); ++i)
+        oldIndexes.insert(a.objectAt(i)->id(), i);
+
+    int lastIndex = -1;
+
+    for (const MapObject *object : b.objects()) {
+        const auto it = oldIndexes.find(object->id());
+        if (it == oldIndexes.end()) {
+            diff.addedObjects.append(object->id());
+            continue;
+        }
+
+        const int index = it.value();
+        oldIndexes.erase(it);
+
+        if (!isSameObject(*a.objectAt(index), *object))
+            diff.changedObjects.append(object->id());
+
+        // The order of the objects determines their drawing order
+        if (index < lastIndex)
+            diff.attributesChanged = true;
+        lastIndex = index;
+    }
+
+    for (const MapObject *object : a.objects())
+        if (oldIndexes.contains(object->id()))
+            diff.removedObjects.append(object->id());
+}
+
+} // anonymous namespace
+
+
+static QString layerTypeName(Layer::TypeFlag type)
+{
+    switch (type) {
+    case Layer::TileLayerType:      return QStringLiteral("tilelayer");
+    case Layer::ObjectGroupType:    return QStringLiteral("objectgroup");
+    case Layer::ImageLayerType:     return QStringLiteral("imagelayer");
+    case Layer::GroupLayerType:     return QStringLiteral("group");
+    }
+    return QString();
+}
+
+static QVariantList toVariantList(const QVector<int> &ids)
+{
+    QVariantList list;
+    for (int id : ids)
+        list.append(id);
+    return list;
+}
+
+QVariantMap LayerDiff::toVariant() const
+{
+    static const char * const changeNames[] = { "added", "removed", "modified" };
+
+    QVariantMap map {
+        { QStringLiteral("change"), QString::fromLatin1(changeNames[change]) },
+        { QStringLiteral("id"), id },
+        { QStringLiteral("name"), name },
+        { QStringLiteral("type"), layerTypeName(type) },
+    };
+
+    if (change != Modified)
+        return map;
+
+    map.insert(QStringLiteral("attributesChanged"), attributesChanged);
+
+    if (!changedCells.isEmpty()) {
+        QVariantList rects;
+        qint64 count = 0;
+
+        for (const QRect &rect : changedCells) {
+            rects.append(QVariantMap {
+                             { QStringLiteral("x"), rect.x() },
+                             { QStringLiteral("y"), rect.y() },
+                             { QStringLiteral("width"), rect.width() },
+                             { QStringLiteral("height"), rect.height() },
+                         });
+            count += qint64(rect.width()) * rect.height();
+        }
+
+        map.insert(QStringLiteral("changedCells"), rects);
+        map.insert(QStringLiteral("changedCellCount"), count);
+    }
+
+    if (!addedObjects.isEmpty())
+        map.insert(QStringLiteral("addedObjects"), toVariantList(addedObjects));
+    if (!removedObjects.isEmpty())
+        map.insert(QStringLiteral("removedObjects"), toVariantList(removedObjects));
+    if (!changedObjects.isEmpty())
+        map.insert(QStringLiteral("changedObjects"), toVariantList(changedObjects));
+
+    return map;
+}
+
+bool MapDiff::isEmpty() const
+{
+    return !mapChanged
+            && addedTilesets.isEmpty()
+            && removedTilesets.isEmpty()
+            && layers.isEmpty();
+}
+
+/**
+ * Returns whether the only differences are the cells of tile layers.
+ */
+bool MapDiff::hasOnlyCellChanges() const
+{
+    if (mapChanged || !addedTilesets.isEmpty() || !removedTilesets.isEmpty())
+        return false;
+
+    for (const LayerDiff &layer : layers) {
+        if (layer.change != LayerDiff::Modified
+                || layer.attributesChanged
+                || !layer.addedObjects.isEmpty()
+                || !layer.removedObjects.isEmpty()
+                || !layer.changedObjects.isEmpty())
+            return false;
+    }
+
+    return true;
+}
+
+QVariantMap MapDiff::toVariant() const
+{
+    QVariantList layerList;
+    for (const LayerDiff &layer : layers)
+        layerList.append(layer.toVariant());
+
+    return QVariantMap {
+        { QStringLiteral("mapChanged"), mapChanged },
+        { QStringLiteral("addedTilesets"), addedTilesets },
+        { QStringLiteral("removedTilesets"), removedTilesets },
+        { QStringLiteral("layers"), layerList },
+    };
+}
+
+/**
+ * Compares \a oldMap to \a newMap.
+ */
+MapDiff MapDiff::compare(const Map &oldMap, const Map &newMap)
+{
+    return MapComparison(oldMap, newMap).compare();
+}
+
+} // namespace Tiled
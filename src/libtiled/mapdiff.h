@@ -0,0 +1,115 @@
+/*
+ * mapdiff.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "layer.h"
+
+#include <QRegion>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+namespace Tiled {
+
+class Map;
+
+/**
+ * The differences of a single layer between two versions of a map.
+ */
+struct TILEDSHARED_EXPORT LayerDiff
+{
+    enum Change {
+        Added,
+        Removed,
+        Modified,
+    };
+
+    Change change = Modified;
+    int id = 0;
+    QString name;
+    Layer::TypeFlag type = Layer::TileLayerType;
+
+    /**
+     * Whether any attribute of a modified layer changed, like its name,
+     * opacity or properties, its place in the layer hierarchy or the order
+     * of its objects.
+     */
+    bool attributesChanged = false;
+
+    /**
+     * For tile layers, the cells that changed, in map tile coordinates.
+     */
+    QRegion changedCells;
+
+    /**
+     * For object layers, the ids of the objects that were added, removed or
+     * changed.
+     */
+    QVector<int> addedObjects;
+    QVector<int> removedObjects;
+    QVector<int> changedObjects;
+
+    QVariantMap toVariant() const;
+};
+
+/**
+ * The differences between two versions of a map.
+ *
+ * Layers are matched by their id and objects by their id within their layer.
+ * Tilesets are matched by file name, or by name when they are embedded, so
+ * the two maps do not need to share their tilesets. When they do, tile
+ * layers are compared chunk by chunk, skipping the chunks that share their
+ * cells.
+ */
+struct TILEDSHARED_EXPORT MapDiff
+{
+    /**
+     * Whether the map attributes or properties changed, or the order of its
+     * tilesets.
+     */
+    bool mapChanged = false;
+
+    QStringList addedTilesets;
+    QStringList removedTilesets;
+
+    /**
+     * The layers that differ, in the order of the new map followed by the
+     * removed layers.
+     */
+    QVector<LayerDiff> layers;
+
+    bool isEmpty() const;
+    bool hasOnlyCellChanges() const;
+
+    QVariantMap toVariant() const;
+
+    static MapDiff compare(const Map &oldMap, const Map &newMap);
+};
+
+} // namespace Tiled
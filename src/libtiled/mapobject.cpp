@@ -39,6 +39,8 @@
 #include <QFontMetricsF>
 #include <qmath.h>
 
+#include <algorithm>
+
 namespace Tiled {
 
 TextData::TextData()
@@ -85,6 +87,12 @@ MapObject::MapObject(const QString &name,
 {
 }
 
+MapObject::~MapObject()
+{
+    if (mObjectTemplate)
+        mObjectTemplate->removeInstance(this);
+}
+
 int MapObject::index() const
 {
     if (mObjectGroup)
@@ -117,6 +125,24 @@ void MapObject::setTextData(const TextData &textData)
     mTextData = textData;
 }
 
+/**
+ * Lets the object group update its lookup table for object IDs.
+ */
+void MapObject::idChanged()
+{
+    if (mObjectGroup)
+        mObjectGroup->objectIdChanged(this);
+}
+
+/**
+ * Lets the object group update its spatial index.
+ */
+void MapObject::geometryChanged()
+{
+    if (mObjectGroup)
+        mObjectGroup->objectGeometryChanged(this);
+}
+
 static void align(QRectF &r, Alignment alignment)
 {
     r.translate(-alignmentOffset(r.size(), alignment));
@@ -380,6 +406,122 @@ MapObject *MapObject::clone() const
     return o;
 }
 
+/**
+ * Simplifies the given \a polygon using the Douglas-Peucker algorithm, such
+ * that none of the removed points is further than \a tolerance away from the
+ * resulting polygon.
+ */
+static QPolygonF simplifyPolygon(const QPolygonF &polygon, qreal tolerance)
+{
+    const int count = polygon.size();
+    if (count < 3)
+        return polygon;
+
+    const qreal toleranceSquared = tolerance * tolerance;
+
+    QVector<bool> keep(count, false);
+    keep[0] = true;
+    keep[count - 1] = true;
+
+    // Using an explicit stack, since polygons can have many points
+    QVector<QPair<int, int>> ranges;
+    ranges.append(qMakePair(0, count - 1));
+
+    while (!ranges.isEmpty()) {
+        const auto range = ranges.takeLast();
+        const QPointF start = polygon.at(range.first);
+        const QPointF direction = polygon.at(range.second) - start;
+        const qreal lengthSquared = QPointF::dotProduct(direction, direction);
+
+        qreal maxDistanceSquared = toleranceSquared;
+        int farthest = -1;
+
+        for (int i = range.first + 1; i < range.second; ++i) {
+            const QPointF offset = polygon.at(i) - start;
+            qreal distanceSquared;
+            if (lengthSquared > 0) {
+                const qreal cross = direction.x() * offset.y() - direction.y() * offset.x();
+                distanceSquared = cross * cross / lengthSquared;
+            } else {
+                distanceSquared = QPointF::dotProduct(offset, offset);
+            }
+
+            if (distanceSquared > maxDistanceSquared) {
+                maxDistanceSquared = distanceSquared;
+                farthest = i;
+            }
+        }
+
+        if (farthest != -1) {
+            keep[farthest] = true;
+            ranges.append(qMakePair(range.first, farthest));
+            ranges.append(qMakePair(farthest, range.second));
+        }
+    }
+
+    QPolygonF simplified;
+    for (int i = 0; i < count; ++i)
+        if (keep.at(i))
+            simplified.append(polygon.at(i));
+
+    return simplified;
+}
+
+/**
+ * Returns the polygon of this object, simplified such that it deviates at
+ * most \a tolerance pixels from the actual polygon. Used for drawing and hit
+ * testing polygons with many points when zoomed out.
+ *
+ * The simplified polygons are cached for levels of detail at tolerances
+ * that successively double, each level being computed from the previous
+ * one. The cache is cleared when the polygon changes.
+ *
+ * Not thread-safe, unless the needed level was already computed.
+ */
+const QPolygonF &MapObject::simplifiedPolygon(qreal tolerance) const
+{
+    constexpr int MinimumPointCount = 64;
+    constexpr int MaximumLevel = 20;
+
+    if (tolerance < 1 || mPolygon.size() < MinimumPointCount)
+        return mPolygon;
+
+    // Each level is simplified using half its tolerance, so the error
+    // accumulated over the levels stays below the level's tolerance
+    const int level = std::min(qFloor(std::log2(tolerance)), MaximumLevel);
+
+    while (mSimplifiedPolygons.size() <= level) {
+        const int nextLevel = mSimplifiedPolygons.size();
+        const QPolygonF &previous = nextLevel == 0 ? mPolygon
+                                                   : mSimplifiedPolygons.last();
+        QPolygonF simplified = simplifyPolygon(previous, qreal(1 << nextLevel) / 2);
+        mSimplifiedPolygons.append(std::move(simplified));
+    }
+
+    return mSimplifiedPolygons.at(level);
+}
+
+static qint64 simplifiedPolygonsMemoryUsage(const QVector<QPolygonF> &polygons)
+{
+    qint64 usage = polygons.capacity() * qint64(sizeof(QPolygonF));
+    for (const QPolygonF &polygon : polygons)
+        usage += polygon.capacity() * qint64(sizeof(QPointF));
+    return usage;
+}
+
+/**
+ * Returns the approximate amount of memory used by this object, including
+ * its properties, in bytes.
+ */
+qint64 MapObject::memoryUsage() const
+{
+    return sizeof(MapObject)
+            + (mName.capacity() + className().capacity() + mTextData.text.capacity()) * qint64(sizeof(QChar))
+            + mPolygon.capacity() * qint64(sizeof(QPointF))
+            + simplifiedPolygonsMemoryUsage(mSimplifiedPolygons)
+            + propertiesMemoryUsage(properties());
+}
+
 void MapObject::copyPropertiesFrom(const MapObject *object)
 {
     setName(object->name());
@@ -395,6 +537,24 @@ void MapObject::copyPropertiesFrom(const MapObject *object)
     setObjectTemplate(object->objectTemplate());
 }
 
+/**
+ * Sets the template this object is an instance of. The template keeps track
+ * of its instances, so that they can be found quickly when it changes.
+ */
+void MapObject::setObjectTemplate(const ObjectTemplate *objectTemplate)
+{
+    if (mObjectTemplate == objectTemplate)
+        return;
+
+    if (mObjectTemplate)
+        mObjectTemplate->removeInstance(this);
+
+    mObjectTemplate = objectTemplate;
+
+    if (mObjectTemplate)
+        mObjectTemplate->addInstance(this);
+}
+
 const MapObject *MapObject::templateObject() const
 {
     if (mObjectTemplate)
@@ -40,6 +40,7 @@
 #include <QSizeF>
 #include <QString>
 #include <QTextOption>
+#include <QVector>
 
 namespace Tiled {
 
@@ -130,6 +131,7 @@ public:
                        const QString &className = QString(),
                        const QPointF &pos = QPointF(),
                        const QSizeF &size = QSizeF(0, 0));
+    ~MapObject() override;
 
     int id() const;
     void setId(int id);
@@ -173,6 +175,7 @@ public:
 
     const QPolygonF &polygon() const;
     void setPolygon(const QPolygonF &polygon);
+    const QPolygonF &simplifiedPolygon(qreal tolerance) const;
 
     Shape shape() const;
     void setShape(Shape shape);
@@ -222,6 +225,8 @@ public:
     MapObject *clone() const;
     void copyPropertiesFrom(const MapObject *object);
 
+    qint64 memoryUsage() const;
+
     const MapObject *templateObject() const;
 
     void syncWithTemplate();
@@ -236,6 +241,9 @@ private:
     void flipInScreenCoordinates(FlipDirection direction, const QPointF &screenOrigin);
     void flipInPixelCoordinates(FlipDirection direction, const QPointF &pixelOrigin);
 
+    void idChanged();
+    void geometryChanged();
+
     int mId = 0;
     Shape mShape = Rectangle;
     QString mName;
@@ -243,6 +251,7 @@ private:
     QSizeF mSize;
     TextData mTextData;
     QPolygonF mPolygon;
+    mutable QVector<QPolygonF> mSimplifiedPolygons;   // cached per level of detail
     Cell mCell;
     const ObjectTemplate *mObjectTemplate = nullptr;
     ObjectGroup *mObjectGroup = nullptr;
@@ -263,7 +272,10 @@ inline int MapObject::id() const
  * Sets the id of this object.
  */
 inline void MapObject::setId(int id)
-{ mId = id; }
+{
+    mId = id;
+    idChanged();
+}
 
 /**
  * Sets the id back to 0. Mostly used when a new id should be assigned
@@ -295,7 +307,10 @@ inline const QPointF &MapObject::position() const
  * Sets the position of this object.
  */
 inline void MapObject::setPosition(const QPointF &pos)
-{ mPos = pos; }
+{
+    mPos = pos;
+    geometryChanged();
+}
 
 /**
  * Returns the x position of this object.
@@ -307,7 +322,10 @@ inline qreal MapObject::x() const
  * Sets the x position of this object.
  */
 inline void MapObject::setX(qreal x)
-{ mPos.setX(x); }
+{
+    mPos.setX(x);
+    geometryChanged();
+}
 
 /**
  * Returns the y position of this object.
@@ -319,7 +337,10 @@ inline qreal MapObject::y() const
  * Sets the x position of this object.
  */
 inline void MapObject::setY(qreal y)
-{ mPos.setY(y); }
+{
+    mPos.setY(y);
+    geometryChanged();
+}
 
 /**
  * Returns the size of this object.
@@ -331,7 +352,10 @@ inline const QSizeF &MapObject::size() const
  * Sets the size of this object.
  */
 inline void MapObject::setSize(const QSizeF &size)
-{ mSize = size; }
+{
+    mSize = size;
+    geometryChanged();
+}
 
 inline void MapObject::setSize(qreal width, qreal height)
 { setSize(QSizeF(width, height)); }
@@ -346,7 +370,10 @@ inline qreal MapObject::width() const
  * Sets the width of this object.
  */
 inline void MapObject::setWidth(qreal width)
-{ mSize.setWidth(width); }
+{
+    mSize.setWidth(width);
+    geometryChanged();
+}
 
 /**
  * Returns the height of this object.
@@ -358,7 +385,10 @@ inline qreal MapObject::height() const
  * Sets the height of this object.
  */
 inline void MapObject::setHeight(qreal height)
-{ mSize.setHeight(height); }
+{
+    mSize.setHeight(height);
+    geometryChanged();
+}
 
 /**
  * Sets the position and size of this object.
@@ -367,6 +397,7 @@ inline void MapObject::setBounds(const QRectF &bounds)
 {
     mPos = bounds.topLeft();
     mSize = bounds.size();
+    geometryChanged();
 }
 
 /**
@@ -389,7 +420,11 @@ inline const QPolygonF &MapObject::polygon() const
  * \sa setShape()
  */
 inline void MapObject::setPolygon(const QPolygonF &polygon)
-{ mPolygon = polygon; }
+{
+    mPolygon = polygon;
+    mSimplifiedPolygons.clear();
+    geometryChanged();
+}
 
 /**
  * Returns the shape of the object.
@@ -401,7 +436,10 @@ inline MapObject::Shape MapObject::shape() const
  * Sets the shape of the object.
  */
 inline void MapObject::setShape(MapObject::Shape shape)
-{ mShape = shape; }
+{
+    mShape = shape;
+    geometryChanged();
+}
 
 /**
  * Returns true if this object has a width and height.
@@ -446,14 +484,14 @@ inline const Cell &MapObject::cell() const
  * \warning The object shape is ignored for tile objects!
  */
 inline void MapObject::setCell(const Cell &cell)
-{ mCell = cell; }
+{
+    mCell = cell;
+    geometryChanged();
+}
 
 inline const ObjectTemplate *MapObject::objectTemplate() const
 { return mObjectTemplate; }
 
-inline void MapObject::setObjectTemplate(const ObjectTemplate *objectTemplate)
-{ mObjectTemplate = objectTemplate; }
-
 /**
  * Returns the object group this object belongs to.
  */
@@ -477,7 +515,10 @@ inline qreal MapObject::rotation() const
  * Sets the rotation of the object in degrees clockwise.
  */
 inline void MapObject::setRotation(qreal rotation)
-{ mRotation = rotation; }
+{
+    mRotation = rotation;
+    geometryChanged();
+}
 
 inline bool MapObject::isVisible() const
 { return mVisible; }
@@ -30,9 +30,11 @@
 
 #include "mapreader.h"
 
+#include "base64.h"
 #include "compression.h"
 #include "gidmapper.h"
 #include "grouplayer.h"
+#include "imagecache.h"
 #include "imagelayer.h"
 #include "objectgroup.h"
 #include "objecttemplate.h"
@@ -44,13 +46,17 @@
 #include "tilesetmanager.h"
 #include "wangset.h"
 
+#include <QBuffer>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
 #include <QVector>
 #include <QXmlStreamReader>
+#include <QtConcurrent>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 using namespace Tiled;
@@ -71,7 +77,8 @@ public:
         mReadingExternalTileset(false)
     {}
 
-    std::unique_ptr<Map> readMap(QIODevice *device, const QString &path);
+    std::unique_ptr<Map> readMap(QIODevice *device, const QString &path,
+                                 const MapReader::LayerHandler &layerHandler = {});
     SharedTileset readTileset(QIODevice *device, const QString &path);
     std::unique_ptr<ObjectTemplate> readObjectTemplate(QIODevice *device, const QString &path);
 
@@ -82,12 +89,20 @@ public:
 private:
     void readUnknownElement();
 
+    void prefetchExternalTilesetImages(QIODevice *device);
+    void prefetchTilesetImage(const QString &tilesetFileName);
+
     std::unique_ptr<Map> readMap();
     void readMapEditorSettings(Map &map);
+    void readCompressionDictionary(Map &map);
+    void streamLayer(std::unique_ptr<Layer> layer);
+    void loadEmbeddedTilesetImages();
+    void fixUpTileObjectSizes();
 
     SharedTileset readTileset();
     void readTilesetEditorSettings(Tileset &tileset);
     void readTilesetTile(Tileset &tileset);
+    void loadPendingTileImages(Tileset &tileset);
     void readTilesetGrid(Tileset &tileset);
     void readTilesetTransformations(Tileset &tileset);
     void readTilesetImage(Tileset &tileset);
@@ -112,6 +127,8 @@ private:
     void decodeCSVLayerData(TileLayer &tileLayer,
                             QStringRef text,
                             QRect bounds);
+    void decodePendingLayerData();
+    void raiseDecodeError(GidMapper::DecodeError error, const TileLayer &tileLayer);
 
     /**
      * Returns the cell for the given global tile ID. Errors are raised with
@@ -146,18 +163,60 @@ private:
     GidMapper mGidMapper;
     bool mReadingExternalTileset;
 
+    MapReader::LayerHandler mLayerHandler;
+    bool mStreamedLayers = false;
+
+    /**
+     * Binary layer data is collected while parsing, so that it can be
+     * decoded in parallel.
+     */
+    struct PendingLayerData
+    {
+        TileLayer *tileLayer;
+        QByteArray data;
+        Map::LayerDataFormat format;
+        QRect bounds;
+        GidMapper::DecodeError error = GidMapper::NoError;
+    };
+
+    // Limits the amount of layer data that is kept around before decoding
+    static constexpr qsizetype MaxPendingLayerDataSize = 64 * 1024 * 1024;
+
+    QVector<PendingLayerData> mPendingLayerData;
+    qsizetype mPendingLayerDataSize = 0;
+
+    /**
+     * Images of tiles in image collection tilesets are created once the whole
+     * tileset was read, so that they can be decoded in parallel.
+     */
+    struct PendingTileImage
+    {
+        Tile *tile;
+        ImageReference imageReference;
+    };
+
+    QVector<PendingTileImage> mPendingTileImages;
+
+    // Shares the property names and string values between objects
+    StringPool mStringPool;
+
     QXmlStreamReader xml;
 };
 
 } // namespace Internal
 } // namespace Tiled
 
-std::unique_ptr<Map> MapReaderPrivate::readMap(QIODevice *device, const QString &path)
+std::unique_ptr<Map> MapReaderPrivate::readMap(QIODevice *device, const QString &path,
+                                               const MapReader::LayerHandler &layerHandler)
 {
     mError.clear();
     mPath.setPath(path);
+    mLayerHandler = layerHandler;
+    mStreamedLayers = false;
     std::unique_ptr<Map> map;
 
+    prefetchExternalTilesetImages(device);
+
     xml.setDevice(device);
 
     if (xml.readNextStartElement() && xml.name() == QLatin1String("map")) {
@@ -167,6 +226,8 @@ std::unique_ptr<Map> MapReaderPrivate::readMap(QIODevice *device, const QString
     }
 
     mGidMapper.clear();
+    mStringPool.clear();
+    mLayerHandler = nullptr;
     return map;
 }
 
@@ -185,6 +246,7 @@ SharedTileset MapReaderPrivate::readTileset(QIODevice *device, const QString &pa
         xml.raiseError(tr("Not a tileset file."));
 
     mReadingExternalTileset = false;
+    mStringPool.clear();
     return tileset;
 }
 
@@ -201,6 +263,7 @@ std::unique_ptr<ObjectTemplate> MapReaderPrivate::readObjectTemplate(QIODevice *
     else
         xml.raiseError(tr("Not a template file."));
 
+    mStringPool.clear();
     return objectTemplate;
 }
 
@@ -237,6 +300,75 @@ void MapReaderPrivate::readUnknownElement()
     xml.skipCurrentElement();
 }
 
+/**
+ * Scans the tileset references at the start of the map and starts decoding
+ * the images of the external tilesets that aren't loaded yet.
+ *
+ * The tilesets themselves are still loaded one at a time while the map is
+ * parsed, but their images will decode in parallel rather than one by one.
+ *
+ * Only seekable devices are scanned, after which their position is restored.
+ */
+void MapReaderPrivate::prefetchExternalTilesetImages(QIODevice *device)
+{
+    if (device->isSequential())
+        return;
+
+    const qint64 position = device->pos();
+    QXmlStreamReader scanner(device);
+
+    if (scanner.readNextStartElement() && scanner.name() == QLatin1String("map")) {
+        while (scanner.readNextStartElement()) {
+            if (scanner.name() == QLatin1String("tileset")) {
+                const QString source = scanner.attributes().value(QLatin1String("source")).toString();
+                if (!source.isEmpty())
+                    prefetchTilesetImage(p->resolveReference(source, mPath));
+                scanner.skipCurrentElement();
+            } else if (scanner.name() == QLatin1String("properties") ||
+                       scanner.name() == QLatin1String("editorsettings")) {
+                scanner.skipCurrentElement();
+            } else {
+                break;  // Tilesets are written before the layers
+            }
+        }
+    }
+
+    device->seek(position);
+}
+
+/**
+ * Starts decoding the image of the tileset in the given TSX file, when this
+ * tileset isn't loaded yet. Only the start of the file is parsed.
+ */
+void MapReaderPrivate::prefetchTilesetImage(const QString &tilesetFileName)
+{
+    if (TilesetManager::instance()->findTileset(tilesetFileName))
+        return;
+
+    QFile file(tilesetFileName);
+    if (!file.open(QFile::ReadOnly | QFile::Text))
+        return;
+
+    QXmlStreamReader scanner(&file);
+    if (!scanner.readNextStartElement() || scanner.name() != QLatin1String("tileset"))
+        return;
+
+    while (scanner.readNextStartElement()) {
+        if (scanner.name() == QLatin1String("image")) {
+            const QString source = scanner.attributes().value(QLatin1String("source")).toString();
+            const QUrl url = toUrl(source, QFileInfo(tilesetFileName).path());
+            if (!source.isEmpty() && url.isLocalFile())
+                ImageCache::prefetch(url.toLocalFile());
+            return;
+        }
+
+        if (scanner.name() == QLatin1String("tile"))
+            return;     // an image collection or done with the header
+
+        scanner.skipCurrentElement();
+    }
+}
+
 std::unique_ptr<Map> MapReaderPrivate::readMap()
 {
     Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("map"));
@@ -290,46 +422,112 @@ std::unique_ptr<Map> MapReaderPrivate::readMap()
         mMap->setNextObjectId(nextObjectId);
 
     while (xml.readNextStartElement()) {
-        if (xml.name() == QLatin1String("editorsettings"))
+        if (std::unique_ptr<Layer> layer = tryReadLayer()) {
+            if (mLayerHandler)
+                streamLayer(std::move(layer));
+            else
+                mMap->addLayer(std::move(layer));
+        } else if (mStreamedLayers) {
+            xml.raiseError(tr("Unexpected element '%1' following the layers")
+                           .arg(xml.name().toString()));
+        } else if (xml.name() == QLatin1String("editorsettings")) {
             readMapEditorSettings(*mMap);
-        else if (std::unique_ptr<Layer> layer = tryReadLayer())
-            mMap->addLayer(std::move(layer));
-        else if (xml.name() == QLatin1String("properties"))
+        } else if (xml.name() == QLatin1String("compressiondictionary")) {
+            readCompressionDictionary(*mMap);
+        } else if (xml.name() == QLatin1String("properties")) {
             mMap->mergeProperties(readProperties());
-        else if (xml.name() == QLatin1String("tileset"))
+        } else if (xml.name() == QLatin1String("tileset")) {
             mMap->addTileset(readTileset());
-        else
+        } else {
             readUnknownElement();
+        }
     }
 
+    decodePendingLayerData();
+
     // Clean up in case of error
     if (xml.hasError()) {
         mMap.reset();
-    } else {
-        // Try to load the tileset images for embedded tilesets
-        for (const SharedTileset &tileset : mMap->tilesets()) {
-            if (tileset->fileName().isEmpty())
-                tileset->loadImage();
-        }
+    } else if (!mStreamedLayers) {
+        loadEmbeddedTilesetImages();
+        fixUpTileObjectSizes();
+    }
 
-        // Fix up sizes of tile objects. This is for backwards compatibility.
-        LayerIterator iterator(mMap.get());
-        while (Layer *layer = iterator.next()) {
-            if (ObjectGroup *objectGroup = layer->asObjectGroup()) {
-                for (MapObject *object : *objectGroup) {
-                    if (const Tile *tile = object->cell().tile()) {
-                        const QSizeF tileSize = tile->size();
-                        if (object->width() == 0)
-                            object->setWidth(tileSize.width());
-                        if (object->height() == 0)
-                            object->setHeight(tileSize.height());
-                    }
+    return std::move(mMap);
+}
+
+void MapReaderPrivate::readCompressionDictionary(Map &map)
+{
+    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("compressiondictionary"));
+
+    const QXmlStreamAttributes atts = xml.attributes();
+    const QStringRef encoding = atts.value(QLatin1String("encoding"));
+    if (encoding != QLatin1String("base64")) {
+        xml.raiseError(tr("Unknown encoding: %1").arg(encoding.toString()));
+        return;
+    }
+
+    const QString text = xml.readElementText();
+    map.setCompressionDictionary(Base64::decode(text.toLatin1()));
+    map.setUseCompressionDictionary(true);
+}
+
+/**
+ * Hands the given top-level \a layer to the layer handler, after which it is
+ * deleted.
+ */
+void MapReaderPrivate::streamLayer(std::unique_ptr<Layer> layer)
+{
+    // Any pending data refers to this layer
+    decodePendingLayerData();
+
+    if (xml.hasError())
+        return;
+
+    if (!mStreamedLayers) {
+        loadEmbeddedTilesetImages();
+        mStreamedLayers = true;
+    }
+
+    Layer *streamedLayer = layer.get();
+    mMap->addLayer(std::move(layer));
+
+    fixUpTileObjectSizes();
+    mLayerHandler(*mMap, *streamedLayer);
+
+    delete mMap->takeLayerAt(mMap->layerCount() - 1);
+}
+
+/**
+ * Tries to load the tileset images for embedded tilesets.
+ */
+void MapReaderPrivate::loadEmbeddedTilesetImages()
+{
+    for (const SharedTileset &tileset : mMap->tilesets()) {
+        if (tileset->fileName().isEmpty())
+            tileset->loadImage();
+    }
+}
+
+/**
+ * Fixes up sizes of tile objects. This is for backwards compatibility.
+ */
+void MapReaderPrivate::fixUpTileObjectSizes()
+{
+    LayerIterator iterator(mMap.get());
+    while (Layer *layer = iterator.next()) {
+        if (ObjectGroup *objectGroup = layer->asObjectGroup()) {
+            for (MapObject *object : *objectGroup) {
+                if (const Tile *tile = object->cell().tile()) {
+                    const QSizeF tileSize = tile->size();
+                    if (object->width() == 0)
+                        object->setWidth(tileSize.width());
+                    if (object->height() == 0)
+                        object->setHeight(tileSize.height());
                 }
             }
         }
     }
-
-    return std::move(mMap);
 }
 
 void MapReaderPrivate::readMapEditorSettings(Map &map)
@@ -443,6 +641,11 @@ SharedTileset MapReaderPrivate::readTileset()
                 readUnknownElement();
             }
         }
+
+        if (tileset)
+            loadPendingTileImages(*tileset);
+        else
+            mPendingTileImages.clear();
     } else { // External tileset
         const QString absoluteSource = p->resolveReference(source, mPath);
         QString error;
@@ -542,12 +745,24 @@ void MapReaderPrivate::readTilesetTile(Tileset &tileset)
         } else if (xml.name() == QLatin1String("image")) {
             ImageReference imageReference = readImage();
             if (imageReference.hasImage()) {
-                QPixmap image = imageReference.create();
-                if (image.isNull()) {
-                    if (imageReference.source.isEmpty())
-                        xml.raiseError(tr("Error reading embedded image for tile %1").arg(id));
+                QSize pendingSize;
+                if (TilesetManager::instance()->lazyImageLoading())
+                    pendingSize = imageReference.fileImageSize();
+
+                if (pendingSize.isValid()) {
+                    tileset.setTileImageSource(tile, imageReference.source, pendingSize);
+                } else if (imageReference.source.isLocalFile()) {
+                    // Start decoding the image while the rest of the tileset is parsed
+                    ImageCache::prefetch(imageReference.source.toLocalFile());
+                    mPendingTileImages.append(PendingTileImage { tile, imageReference });
+                } else {
+                    QPixmap image = imageReference.create();
+                    if (image.isNull()) {
+                        if (imageReference.source.isEmpty())
+                            xml.raiseError(tr("Error reading embedded image for tile %1").arg(id));
+                    }
+                    tileset.setTileImage(tile, image, imageReference.source);
                 }
-                tileset.setTileImage(tile, image, imageReference.source);
             }
         } else if (xml.name() == QLatin1String("objectgroup")) {
             std::unique_ptr<ObjectGroup> objectGroup = readObjectGroup();
@@ -594,6 +809,21 @@ void MapReaderPrivate::readTilesetTile(Tileset &tileset)
     }
 }
 
+/**
+ * Sets the images of the tiles collected while reading the tileset. Their
+ * decoding was already started on the global thread pool.
+ */
+void MapReaderPrivate::loadPendingTileImages(Tileset &tileset)
+{
+    for (const PendingTileImage &pending : std::as_const(mPendingTileImages)) {
+        tileset.setTileImage(pending.tile,
+                             pending.imageReference.create(),
+                             pending.imageReference.source);
+    }
+
+    mPendingTileImages.clear();
+}
+
 void MapReaderPrivate::readTilesetGrid(Tileset &tileset)
 {
     Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("grid"));
@@ -639,6 +869,10 @@ void MapReaderPrivate::readTilesetImage(Tileset &tileset)
     Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("image"));
 
     tileset.setImageReference(readImage());
+
+    // Start decoding the image while the rest of the file is parsed
+    if (tileset.imageSource().isLocalFile())
+        ImageCache::prefetch(tileset.imageSource().toLocalFile());
 }
 
 ImageReference MapReaderPrivate::readImage()
@@ -670,7 +904,7 @@ ImageReference MapReaderPrivate::readImage()
 
                 image.data = xml.readElementText().toLatin1();
                 if (encoding == QLatin1String("base64"))
-                    image.data = QByteArray::fromBase64(image.data);
+                    image.data = Base64::decode(image.data);
             } else {
                 readUnknownElement();
             }
@@ -917,6 +1151,8 @@ std::unique_ptr<TileLayer> MapReaderPrivate::readTileLayer()
             readUnknownElement();
     }
 
+    tileLayer->squeeze();
+
     return tileLayer;
 }
 
@@ -942,6 +1178,10 @@ void MapReaderPrivate::readTileLayerData(TileLayer &tileLayer)
             layerDataFormat = Map::Base64Zlib;
         } else if (compression == QLatin1String("zstd")) {
             layerDataFormat = Map::Base64Zstandard;
+        } else if (compression == QLatin1String("rle")) {
+            layerDataFormat = Map::Base64RunLength;
+        } else if (compression == QLatin1String("rle+zstd")) {
+            layerDataFormat = Map::Base64RunLengthZstandard;
         } else {
             xml.raiseError(tr("Compression method '%1' not supported")
                            .arg(compression.toString()));
@@ -1023,10 +1263,67 @@ void MapReaderPrivate::decodeBinaryLayerData(TileLayer &tileLayer,
                                              Map::LayerDataFormat format,
                                              QRect bounds)
 {
-    GidMapper::DecodeError error;
+    mPendingLayerData.append(PendingLayerData { &tileLayer, data, format, bounds });
+    mPendingLayerDataSize += data.size();
 
-    error = mGidMapper.decodeLayerData(tileLayer, data, format, bounds);
+    if (mPendingLayerDataSize > MaxPendingLayerDataSize)
+        decodePendingLayerData();
+}
+
+/**
+ * Decodes the collected binary layer data. The decoding and decompression is
+ * done in parallel, after which the cells are set in the original order.
+ */
+void MapReaderPrivate::decodePendingLayerData()
+{
+    if (mPendingLayerData.isEmpty())
+        return;
+
+    QVector<PendingLayerData> pendingLayerData;
+    pendingLayerData.swap(mPendingLayerData);
+    mPendingLayerDataSize = 0;
+
+    if (xml.hasError())
+        return;
+
+    const QByteArray dictionary = mMap->compressionDictionary();
+
+    QtConcurrent::blockingMap(pendingLayerData, [&] (PendingLayerData &pending) {
+        QByteArray decodedData;
+        pending.error = GidMapper::decompressLayerData(pending.data,
+                                                       pending.format,
+                                                       pending.bounds,
+                                                       decodedData,
+                                                       dictionary);
+        pending.data = decodedData;
+    });
+
+    TileLayer *previousLayer = nullptr;
+
+    for (PendingLayerData &pending : pendingLayerData) {
+        GidMapper::DecodeError error = pending.error;
+        if (error == GidMapper::NoError)
+            error = mGidMapper.setLayerData(*pending.tileLayer, pending.data, pending.bounds);
+
+        if (error != GidMapper::NoError) {
+            raiseDecodeError(error, *pending.tileLayer);
+            return;
+        }
+
+        pending.data.clear();
+
+        if (previousLayer && previousLayer != pending.tileLayer)
+            previousLayer->squeeze();
+        previousLayer = pending.tileLayer;
+    }
+
+    if (previousLayer)
+        previousLayer->squeeze();
+}
 
+void MapReaderPrivate::raiseDecodeError(GidMapper::DecodeError error,
+                                        const TileLayer &tileLayer)
+{
     switch (error) {
     case GidMapper::CorruptLayerData:
         xml.raiseError(tr("Corrupt layer data for layer '%1'").arg(tileLayer.name()));
@@ -1042,45 +1339,72 @@ void MapReaderPrivate::decodeBinaryLayerData(TileLayer &tileLayer,
     }
 }
 
+static bool isCsvSpace(ushort c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' ||
+            (c > 127 && QChar::isSpace(c));
+}
+
+/**
+ * Parses the comma-separated global tile IDs in \a text and sets the
+ * resulting cells on \a tileLayer, within the given \a bounds.
+ *
+ * The text is scanned directly, and the cells are converted and set one span
+ * of at most CHUNK_SIZE cells at a time.
+ */
 void MapReaderPrivate::decodeCSVLayerData(TileLayer &tileLayer,
                                           QStringRef text,
                                           QRect bounds)
 {
-    int currentIndex = 0;
+    const QChar *current = text.constData();
+    const QChar *const end = current + text.length();
 
-    for (int y = bounds.top(); y <= bounds.bottom(); y++) {
-        for (int x = bounds.left(); x <= bounds.right(); x++) {
-            // Check if the stream ended early.
-            if (currentIndex >= text.length()) {
-                xml.raiseError(tr("Corrupt layer data for layer '%1'")
-                               .arg(tileLayer.name()));
-                return;
-            }
+    unsigned gids[CHUNK_SIZE];
+    Cell cells[CHUNK_SIZE];
 
-            // Get the next entry.
-            unsigned int gid = 0;
-            while (currentIndex < text.length()) {
-                auto currentChar = text.at(currentIndex);
-                currentIndex++;
-                if (currentChar == QLatin1Char(','))
-                    break;
-                if (currentChar.isSpace())
-                    continue;
-                int value = currentChar.digitValue();
-                if (value != -1)
-                    gid = gid * 10 + value;
-                else {
-                    xml.raiseError(
-                            tr("Unable to parse tile at (%1,%2) on layer '%3': \"%4\"")
-                                   .arg(x + 1).arg(y + 1).arg(tileLayer.name()).arg(currentChar));
+    for (int y = bounds.top(); y <= bounds.bottom(); y++) {
+        for (int x = bounds.left(); x <= bounds.right(); x += CHUNK_SIZE) {
+            const int count = std::min(CHUNK_SIZE, bounds.right() - x + 1);
+
+            for (int i = 0; i < count; ++i) {
+                // Check if the stream ended early.
+                if (current == end) {
+                    xml.raiseError(tr("Corrupt layer data for layer '%1'")
+                                   .arg(tileLayer.name()));
                     return;
                 }
+
+                // Get the next entry.
+                unsigned gid = 0;
+                while (current != end) {
+                    const ushort c = (current++)->unicode();
+                    if (c == ',')
+                        break;
+
+                    const unsigned digit = c - '0';
+                    if (digit < 10) {
+                        gid = gid * 10 + digit;
+                    } else if (!isCsvSpace(c)) {
+                        xml.raiseError(
+                                tr("Unable to parse tile at (%1,%2) on layer '%3': \"%4\"")
+                                       .arg(x + i + 1).arg(y + 1).arg(tileLayer.name()).arg(QChar(c)));
+                        return;
+                    }
+                }
+
+                gids[i] = gid;
             }
 
-            tileLayer.setCell(x, y, cellForGid(gid));
+            const int converted = mGidMapper.gidsToCells(gids, count, cells);
+            tileLayer.setRow(x, y, converted, cells);
+
+            if (converted < count) {
+                cellForGid(gids[converted]);    // raises the error
+                return;
+            }
         }
     }
-    if (currentIndex < text.length()) {
+    if (current != end) {
         // We didn't consume all the data.
         xml.raiseError(tr("Corrupt layer data for layer '%1'")
                        .arg(tileLayer.name()));
@@ -1469,7 +1793,8 @@ void MapReaderPrivate::readProperty(Properties *properties, const ExportContext
         }
     }
 
-    properties->insert(propertyName, context.toPropertyValue(exportValue));
+    properties->insert(mStringPool.intern(propertyName),
+                       mStringPool.intern(context.toPropertyValue(exportValue)));
 }
 
 
@@ -1488,13 +1813,60 @@ std::unique_ptr<Map> MapReader::readMap(QIODevice *device, const QString &path)
     return d->readMap(device, path);
 }
 
+std::unique_ptr<Map> MapReader::readMap(QIODevice *device, const QString &path,
+                                        const LayerHandler &layerHandler)
+{
+    return d->readMap(device, path, layerHandler);
+}
+
+namespace {
+
+/**
+ * Provides the contents of an opened file as a device, memory mapping the
+ * file when possible. Parsing from the mapping avoids the read calls and the
+ * copying into the internal buffer of QFile.
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(QFile &file)
+        : mFile(file)
+    {
+        const qint64 size = file.size();
+        if (size <= 0 || size > std::numeric_limits<int>::max())
+            return;
+
+        if (const uchar *data = file.map(0, size)) {
+            mData = QByteArray::fromRawData(reinterpret_cast<const char*>(data),
+                                            static_cast<int>(size));
+            mBuffer.setBuffer(&mData);
+            mBuffer.open(QIODevice::ReadOnly);
+        }
+    }
+
+    QIODevice *device()
+    {
+        if (mBuffer.isOpen())
+            return &mBuffer;
+        return &mFile;
+    }
+
+private:
+    QFile &mFile;
+    QByteArray mData;
+    QBuffer mBuffer;
+};
+
+} // anonymous namespace
+
 std::unique_ptr<Map> MapReader::readMap(const QString &fileName)
 {
     QFile file(fileName);
     if (!d->openFile(&file))
         return nullptr;
 
-    return readMap(&file, QFileInfo(fileName).absolutePath());
+    MappedFile mappedFile(file);
+    return readMap(mappedFile.device(), QFileInfo(fileName).absolutePath());
 }
 
 SharedTileset MapReader::readTileset(QIODevice *device, const QString &path)
@@ -1512,7 +1884,8 @@ SharedTileset MapReader::readTileset(const QString &fileName)
     if (!d->openFile(&file))
         return SharedTileset();
 
-    return readTileset(&file, QFileInfo(fileName).absolutePath());
+    MappedFile mappedFile(file);
+    return readTileset(mappedFile.device(), QFileInfo(fileName).absolutePath());
 }
 
 std::unique_ptr<ObjectTemplate> MapReader::readObjectTemplate(QIODevice *device, const QString &path)
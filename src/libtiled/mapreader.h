@@ -34,10 +34,13 @@
 
 #include <QImage>
 
+#include <functional>
+
 class QFile;
 
 namespace Tiled {
 
+class Layer;
 class Map;
 
 namespace Internal {
@@ -73,6 +76,27 @@ public:
      */
     std::unique_ptr<Map> readMap(const QString &fileName);
 
+    /**
+     * Called for each top-level layer when streaming a map. The \a layer is
+     * part of the \a map only during this call.
+     */
+    using LayerHandler = std::function<void (Map &map, Layer &layer)>;
+
+    /**
+     * Reads a TMX map from the given \a device, passing each top-level layer
+     * to the \a layerHandler as soon as it has been read. The layers are
+     * deleted afterwards, so only one top-level layer is kept in memory.
+     *
+     * Since the layer handler relies on the tilesets and map properties
+     * being known, these need to precede the layers in the file.
+     *
+     * Returns the map without any layers, or 0 and sets errorString() when
+     * reading failed. When an error is encountered, the layer handler may
+     * already have been called for some of the layers.
+     */
+    std::unique_ptr<Map> readMap(QIODevice *device, const QString &path,
+                                 const LayerHandler &layerHandler);
+
     /**
      * Reads a TSX tileset from the given \a device. Optionally a \a path can
      * be given, which will be used to resolve relative references to external
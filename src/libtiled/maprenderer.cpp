@@ -36,14 +36,23 @@
 #include "orthogonalrenderer.h"
 #include "staggeredrenderer.h"
 #include "tile.h"
+#include "tileatlas.h"
 #include "tilelayer.h"
 
 #include <QCache>
+#include <QCoreApplication>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
 #include <QPaintEngine>
 #include <QPainter>
+#include <QStaticText>
+#include <QThread>
 #include <QVector2D>
 
+#include <atomic>
 #include <cmath>
+#include <limits>
 
 using namespace Tiled;
 
@@ -69,6 +78,32 @@ size_t qHash(const TintedKey &key, size_t seed) Q_DECL_NOTHROW
     return h;
 }
 
+struct TextLayoutKey
+{
+    const QString text;
+    const QFont font;
+    const int flags;
+    const qreal width;
+
+    bool operator==(const TextLayoutKey &o) const
+    {
+        return text == o.text && font == o.font && flags == o.flags && width == o.width;
+    }
+};
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+uint qHash(const TextLayoutKey &key, uint seed) Q_DECL_NOTHROW
+#else
+size_t qHash(const TextLayoutKey &key, size_t seed) Q_DECL_NOTHROW
+#endif
+{
+    auto h = ::qHash(key.text, seed);
+    h = ::qHash(key.font, h);
+    h = ::qHash(key.flags, h);
+    h = ::qHash(key.width, h);
+    return h;
+}
+
 // Borrowed from qpixmapcache.cpp
 static inline qsizetype cost(const QPixmap &pixmap)
 {
@@ -80,42 +115,178 @@ static inline qsizetype cost(const QPixmap &pixmap)
     return static_cast<qsizetype>(qBound(1LL, costKb, costMax));
 }
 
+// Shared by all threads, hence relaxed atomic counters
+static struct {
+    std::atomic<quint64> cellsDrawn { 0 };
+    std::atomic<quint64> flushes { 0 };
+    std::atomic<quint64> tintedFlushes { 0 };
+    std::atomic<quint64> tintCacheHits { 0 };
+    std::atomic<quint64> tintCacheMisses { 0 };
+} sCounters;
+
+static bool hasTint(const QColor &color)
+{
+    return color.isValid() && color != QColor(255, 255, 255, 255);
+}
+
+/**
+ * Multiplies each pixel of the premultiplied \a image by the given \a color,
+ * including its alpha, in a single pass. This matches the tinting done by
+ * the OpenGL tile layer renderer.
+ */
+static void tintImage(QImage &image, const QColor &color)
+{
+    Q_ASSERT(image.format() == QImage::Format_ARGB32_Premultiplied);
+
+    // 16.16 fixed point factors, with the alpha of the tint color folded in
+    const quint64 alpha = color.alpha();
+    const quint32 fa = static_cast<quint32>((alpha * 65536 + 127) / 255);
+    const quint32 fr = static_cast<quint32>((color.red() * alpha * 65536 + 32512) / 65025);
+    const quint32 fg = static_cast<quint32>((color.green() * alpha * 65536 + 32512) / 65025);
+    const quint32 fb = static_cast<quint32>((color.blue() * alpha * 65536 + 32512) / 65025);
+
+    const int width = image.width();
+    const int height = image.height();
+
+    for (int y = 0; y < height; ++y) {
+        auto line = reinterpret_cast<quint32*>(image.scanLine(y));
+
+        // Plain integer arithmetic, so that this loop can be vectorized
+        for (int x = 0; x < width; ++x) {
+            const quint32 p = line[x];
+            const quint32 a = ((p >> 24) * fa) >> 16;
+            const quint32 r = (((p >> 16) & 0xff) * fr) >> 16;
+            const quint32 g = (((p >> 8) & 0xff) * fg) >> 16;
+            const quint32 b = ((p & 0xff) * fb) >> 16;
+            line[x] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+}
+
+/**
+ * Returns a tinted copy of the part \a rect of \a pixmap.
+ */
+static QPixmap tintedCopy(const QPixmap &pixmap, const QRect &rect, const QColor &color)
+{
+    QImage image = pixmap.copy(rect).toImage()
+            .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    tintImage(image, color);
+    return QPixmap::fromImage(std::move(image));
+}
+
+// Cache for up to 100 MB of tinted pixmaps. The cache is shared by the
+// threads used when rendering an image in parallel.
+static QCache<TintedKey, QPixmap> tintedCache { 100 * 1024 };
+static QMutex tintedCacheMutex;
+
+/**
+ * Returns a tinted version of \a pixmap. The result is cached, since this is
+ * used for image layers which are usually large and drawn as a whole.
+ */
 static QPixmap tinted(const QPixmap &pixmap, const QColor &color)
 {
-    if (!color.isValid() || color == QColor(255, 255, 255, 255) || pixmap.isNull())
+    if (!hasTint(color) || pixmap.isNull())
         return pixmap;
 
-    // Cache for up to 100 MB of tinted pixmaps, since tinting is expensive
-    static QCache<TintedKey, QPixmap> cache { 100 * 1024 };
-
     const TintedKey tintedKey { pixmap.cacheKey(), color };
-    if (auto cached = cache.object(tintedKey))
-        return *cached;
+    {
+        QMutexLocker locker(&tintedCacheMutex);
+        if (auto cached = tintedCache.object(tintedKey)) {
+            sCounters.tintCacheHits.fetch_add(1, std::memory_order_relaxed);
+            return *cached;
+        }
+    }
+
+    sCounters.tintCacheMisses.fetch_add(1, std::memory_order_relaxed);
+
+    const QPixmap resultImage = tintedCopy(pixmap, pixmap.rect(), color);
+
+    QMutexLocker locker(&tintedCacheMutex);
+    tintedCache.insert(tintedKey, new QPixmap(resultImage), cost(resultImage));
+
+    return resultImage;
+}
+
+/**
+ * Returns a pixmap with tinted copies of only those parts of \a pixmap that
+ * are referenced by \a fragments, and updates the source rectangles of the
+ * fragments to match.
+ *
+ * This avoids tinting (and keeping around) entire tileset images, when
+ * usually only a small number of their tiles is visible. Falls back to
+ * tinting the whole pixmap when the fragments reference most of it.
+ */
+static QPixmap tintedFragments(const QPixmap &pixmap,
+                               QVector<QPainter::PixmapFragment> &fragments,
+                               const QColor &color)
+{
+    constexpr int MaxRowWidth = 2048;
+
+    struct Part {
+        QRect source;
+        QPoint target;
+    };
+
+    QVector<Part> parts;
+    QVector<int> partIndexes;
+    QHash<quint64, int> partIndexByKey;
+    partIndexes.reserve(fragments.size());
+
+    // Pack the distinct source rectangles in rows
+    QPoint cursor;
+    int rowHeight = 0;
+    int packedWidth = 0;
+
+    for (const auto &fragment : std::as_const(fragments)) {
+        const QRect source(qRound(fragment.sourceLeft), qRound(fragment.sourceTop),
+                           qRound(fragment.width), qRound(fragment.height));
+        const quint64 key = (quint64(quint16(source.x())) << 48) |
+                            (quint64(quint16(source.y())) << 32) |
+                            (quint64(quint16(source.width())) << 16) |
+                            quint64(quint16(source.height()));
+
+        auto it = partIndexByKey.find(key);
+        if (it == partIndexByKey.end()) {
+            if (cursor.x() > 0 && cursor.x() + source.width() > MaxRowWidth) {
+                cursor = QPoint(0, cursor.y() + rowHeight);
+                rowHeight = 0;
+            }
 
-    QPixmap resultImage = pixmap;
-    QPainter painter(&resultImage);
+            it = partIndexByKey.insert(key, parts.size());
+            parts.append(Part { source, cursor });
 
-    QColor fullOpacity = color;
-    fullOpacity.setAlpha(255);
-    // tint the final color (this will will mess up the alpha which we will fix
-    // in the next lines)
-    painter.setCompositionMode(QPainter::CompositionMode_Multiply);
-    painter.fillRect(resultImage.rect(), fullOpacity);
+            cursor.rx() += source.width();
+            rowHeight = std::max(rowHeight, source.height());
+            packedWidth = std::max(packedWidth, cursor.x());
+        }
 
-    // apply the original alpha to the final image
-    painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-    painter.drawPixmap(0, 0, pixmap);
+        partIndexes.append(it.value());
+    }
 
-    // apply the alpha of the tint color so that we can use it to make the image
-    // transparent instead of just increasing or decreasing the tint effect
-    painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-    painter.fillRect(resultImage.rect(), color);
+    const QSize packedSize(packedWidth, cursor.y() + rowHeight);
+    if (qint64(packedSize.width()) * packedSize.height() >=
+            qint64(pixmap.width()) * pixmap.height()) {
+        return tintedCopy(pixmap, pixmap.rect(), color);
+    }
 
+    QImage image(packedSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (const Part &part : std::as_const(parts))
+        painter.drawPixmap(part.target, pixmap, part.source);
     painter.end();
 
-    cache.insert(tintedKey, new QPixmap(resultImage), cost(resultImage));
+    tintImage(image, color);
 
-    return resultImage;
+    for (int i = 0; i < fragments.size(); ++i) {
+        const QPoint &target = parts.at(partIndexes.at(i)).target;
+        fragments[i].sourceLeft = target.x();
+        fragments[i].sourceTop = target.y();
+    }
+
+    return QPixmap::fromImage(std::move(image));
 }
 
 MapRenderer::~MapRenderer()
@@ -166,6 +337,33 @@ QPainterPath MapRenderer::pointShape(const QPointF &position) const
     return path;
 }
 
+void MapRenderer::drawTileSelection(QPainter *painter,
+                                    const QRegion &region,
+                                    const QColor &color,
+                                    const QRectF &exposed) const
+{
+    drawTileSelection(painter, tileSelectionPath(region, exposed), color);
+}
+
+void MapRenderer::drawTileSelection(QPainter *painter,
+                                    const QPainterPath &path,
+                                    const QColor &color) const
+{
+    QColor penColor(color);
+    penColor.setAlpha(255);
+
+    QPen pen(penColor);
+    pen.setCosmetic(true);
+
+    // Orthogonal selections are aligned to pixels
+    const bool antialiasing = map()->orientation() != Map::Orthogonal;
+
+    painter->setPen(pen);
+    painter->setBrush(color);
+    painter->setRenderHint(QPainter::Antialiasing, antialiasing);
+    painter->drawPath(path);
+}
+
 void MapRenderer::drawImageLayer(QPainter *painter,
                                  const ImageLayer *imageLayer,
                                  const QRectF &exposed) const
@@ -180,6 +378,51 @@ void MapRenderer::drawImageLayer(QPainter *painter,
     painter->restore();
 }
 
+/**
+ * Draws the text of a text object with the given \a textData within
+ * \a bounds.
+ *
+ * On the main thread, the laid out text is kept in a QStaticText, so that
+ * it doesn't need to be laid out again each time the object is painted.
+ * The cache is keyed on the text, font, flags and width, so it doesn't need
+ * to be invalidated when the text object changes.
+ */
+void MapRenderer::drawTextObject(QPainter *painter, const QRectF &bounds,
+                                 const TextData &textData)
+{
+    painter->setFont(textData.font);
+    painter->setPen(textData.color);
+
+    // QStaticText is not safe to share between threads
+    const auto app = QCoreApplication::instance();
+    if (!app || QThread::currentThread() != app->thread()) {
+        painter->drawText(bounds, textData.text, textData.textOption());
+        return;
+    }
+
+    static QCache<TextLayoutKey, QStaticText> cache { 4096 };
+
+    const TextLayoutKey key { textData.text, textData.font, textData.flags(), bounds.width() };
+    QStaticText *staticText = cache.object(key);
+    if (!staticText) {
+        staticText = new QStaticText(textData.text);
+        staticText->setTextFormat(Qt::PlainText);
+        staticText->setTextOption(textData.textOption());
+        staticText->setTextWidth(bounds.width() > 0 ? bounds.width() : -1);
+        cache.insert(key, staticText);
+    }
+
+    // QStaticText only supports horizontal alignment
+    QPointF topLeft = bounds.topLeft();
+    const qreal textHeight = staticText->size().height();
+    if (textData.alignment & Qt::AlignBottom)
+        topLeft.ry() += bounds.height() - textHeight;
+    else if (textData.alignment & Qt::AlignVCenter)
+        topLeft.ry() += (bounds.height() - textHeight) / 2;
+
+    painter->drawStaticText(topLeft, *staticText);
+}
+
 void MapRenderer::drawPointObject(QPainter *painter, const QColor &color) const
 {
     const qreal lineWidth = objectLineWidth();
@@ -248,6 +491,36 @@ QPointF MapRenderer::snapToGrid(const QPointF &pixelCoords, int subdivisions) co
     return tileToPixelCoords(tileCoords);
 }
 
+void MapRenderer::pixelToTileCoords(const QPointF *points, QPointF *result, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        result[i] = pixelToTileCoords(points[i]);
+}
+
+void MapRenderer::screenToTileCoords(const QPointF *points, QPointF *result, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        result[i] = screenToTileCoords(points[i]);
+}
+
+void MapRenderer::tileToScreenCoords(const QPointF *points, QPointF *result, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        result[i] = tileToScreenCoords(points[i]);
+}
+
+void MapRenderer::screenToPixelCoords(const QPointF *points, QPointF *result, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        result[i] = screenToPixelCoords(points[i]);
+}
+
+void MapRenderer::pixelToScreenCoords(const QPointF *points, QPointF *result, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        result[i] = pixelToScreenCoords(points[i]);
+}
+
 void MapRenderer::drawTileLayer(QPainter *painter, const TileLayer *layer, const QRectF &exposed) const
 {
     const QSize tileSize = map()->tileSize();
@@ -271,18 +544,43 @@ void MapRenderer::drawTileLayer(QPainter *painter, const TileLayer *layer, const
 
     CellRenderer renderer(painter, this, layer->effectiveTintColor());
 
-    auto tileRenderFunction = [layer, &renderer, tileSize](QPoint tilePos, const QPointF &screenPos) {
-        const Cell &cell = layer->cellAt(tilePos - layer->position());
-        if (!cell.isEmpty()) {
-            QSize size = tileSize;
+    // The renderers visit the cells in their render order, in which
+    // consecutive cells are usually part of the same chunk and often refer
+    // to the same tile. Both lookups are reused in that case.
+    const QPoint layerPosition = layer->position();
+    QPoint chunkCoordinates(std::numeric_limits<int>::min(), 0);
+    const Chunk *chunk = nullptr;
+    const Tileset *tileset = nullptr;
+    int tileId = -1;
+    const Tile *tile = nullptr;
+    QSize size;
+
+    auto tileRenderFunction = [&] (QPoint tilePos, const QPointF &screenPos) {
+        tilePos -= layerPosition;
+
+        const QPoint coordinates(tilePos.x() >> CHUNK_BITS, tilePos.y() >> CHUNK_BITS);
+        if (coordinates != chunkCoordinates) {
+            chunkCoordinates = coordinates;
+            chunk = layer->findChunk(tilePos.x(), tilePos.y());
+        }
+        if (!chunk)
+            return;
 
-            if (cell.tileset()->tileRenderSize() == Tileset::TileSize) {
-                if (const Tile *tile = cell.tile())
-                    size = tile->size();
-            }
+        const Cell cell = chunk->cellAt(tilePos.x() & CHUNK_MASK, tilePos.y() & CHUNK_MASK);
+        if (cell.isEmpty())
+            return;
 
-            renderer.render(cell, screenPos, size, CellRenderer::BottomLeft);
+        if (cell.tileset() != tileset || cell.tileId() != tileId) {
+            tileset = cell.tileset();
+            tileId = cell.tileId();
+            tile = cell.tile();
+            size = tileSize;
+
+            if (tile && tileset->tileRenderSize() == Tileset::TileSize)
+                size = tile->size();
         }
+
+        renderer.render(cell, tile, screenPos, size, CellRenderer::BottomLeft);
     };
 
     drawTileLayer(tileRenderFunction, rect);
@@ -331,6 +629,16 @@ std::unique_ptr<MapRenderer> MapRenderer::create(const Map *map)
     }
 }
 
+/**
+ * Returns the approximate amount of memory used by the cache of tinted
+ * image layer images, in bytes.
+ */
+qint64 MapRenderer::tintCacheMemoryUsage()
+{
+    QMutexLocker locker(&tintedCacheMutex);
+    return qint64(tintedCache.totalCost()) * 1024;
+}
+
 void MapRenderer::setupGridPens(const QPaintDevice *device, QColor color,
                                 QPen &gridPen, QPen &majorGridPen, int gridSize,
                                 QSize gridMajor) const
@@ -392,7 +700,10 @@ CellRenderer::CellRenderer(QPainter *painter, const MapRenderer *renderer, const
     : mPainter(painter)
     , mRenderer(renderer)
     , mTile(nullptr)
+    , mPixmap(nullptr)
     , mIsOpenGL(hasOpenGLEngine(painter))
+    // Tinting the atlas would be too expensive, since it changes often
+    , mUseAtlas(!tintColor.isValid() || tintColor == QColor(255, 255, 255, 255))
     , mTintColor(tintColor)
 {
 }
@@ -410,8 +721,15 @@ CellRenderer::CellRenderer(QPainter *painter, const MapRenderer *renderer, const
  */
 void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSizeF &size, Origin origin)
 {
-    const Tile *tile = cell.tile();
+    render(cell, cell.tile(), screenPos, size, origin);
+}
 
+/**
+ * Renders a \a cell whose \a tile has already been looked up.
+ */
+void CellRenderer::render(const Cell &cell, const Tile *tile, const QPointF &screenPos,
+                          const QSizeF &size, Origin origin)
+{
     if (tile && mRenderer->testFlag(ShowTileAnimations))
         tile = tile->currentFrameTile();
 
@@ -425,16 +743,104 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
         return;
     }
 
+    const QPixmap &image = tile->image();
+    const QRect imageRect = tile->imageRect();
+    if (imageRect.isEmpty())
+        return;
+
+    // Draw small images from the atlas, so that consecutive tiles from
+    // different images can still be drawn in one batch
+    const QPixmap *pixmap = &image;
+    QPoint sourceOffset;
+    if (mUseAtlas) {
+        const TileAtlas::Location location = TileAtlas::find(image);
+        if (location.pixmap) {
+            pixmap = location.pixmap;
+            sourceOffset = location.offset;
+        }
+    }
+
+    // Collision shapes are painted per batch, for a single tile
+    const bool batchPerTile = mRenderer->flags().testFlag(ShowTileCollisionShapes);
+
     // The USHRT_MAX limit is rather arbitrary but avoids a crash in
     // drawPixmapFragments for a large number of fragments.
-    if (mTile != tile || mFragments.size() == USHRT_MAX)
+    if (!mPixmap || mPixmap->cacheKey() != pixmap->cacheKey() ||
+            (batchPerTile && mTile != tile) ||
+            mFragments.size() == USHRT_MAX)
         flush();
 
-    const QPixmap &image = tile->image();
-    const QRect imageRect = tile->imageRect();
-    if (imageRect.isEmpty())
+    QPainter::PixmapFragment fragment = fragmentForCell(mRenderer, cell, tile,
+                                                        screenPos, size, origin);
+    fragment.sourceLeft += sourceOffset.x();
+    fragment.sourceTop += sourceOffset.y();
+
+    // Avoid using drawPixmapFragments with OpenGL in Qt 6.4.1 and above
+    // (https://bugreports.qt.io/browse/QTBUG-111416)
+#if QT_VERSION < QT_VERSION_CHECK(6, 4, 1) || QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    if (mIsOpenGL || (fragment.scaleX > 0 && fragment.scaleY > 0)) {
+#else
+    if (!mIsOpenGL && fragment.scaleX > 0 && fragment.scaleY > 0) {
+#endif
+        mTile = tile;
+        mPixmap = pixmap;
+        mFragments.append(fragment);
         return;
+    }
+
+    // The Raster paint engine as of Qt 4.8.4 / 5.0.2 does not support
+    // drawing fragments with a negative scaling factor.
+
+    flush(); // make sure we drew all tiles so far
+
+    const QTransform oldTransform = mPainter->transform();
+    QTransform transform = oldTransform;
+    transform.translate(fragment.x, fragment.y);
+    transform.rotate(fragment.rotation);
+    transform.scale(fragment.scaleX, fragment.scaleY);
+
+    const QRectF target(fragment.width * -0.5, fragment.height * -0.5,
+                        fragment.width, fragment.height);
+    const QRectF source(fragment.sourceLeft, fragment.sourceTop,
+                        fragment.width, fragment.height);
+
+    mPainter->setTransform(transform);
+    if (hasTint(mTintColor)) {
+        const QPixmap tintedPixmap = tintedCopy(*pixmap, source.toRect(), mTintColor);
+        mPainter->drawPixmap(target, tintedPixmap, tintedPixmap.rect());
+    } else {
+        mPainter->drawPixmap(target, *pixmap, source);
+    }
+    mPainter->setTransform(oldTransform);
+
+    // A bit of a hack to still draw tile collision shapes when requested
+    if (mRenderer->flags().testFlag(ShowTileCollisionShapes)
+            && tile->objectGroup()
+            && !tile->objectGroup()->objects().isEmpty()) {
+        mTile = tile;
+        mFragments.append(fragment);
+        paintTileCollisionShapes();
+        mTile = nullptr;
+        mFragments.clear();
+    }
+}
 
+/**
+ * Returns the fragment for drawing the image of the given \a tile for
+ * \a cell with the given \a origin at \a screenPos, taking into account
+ * the flipping and tile offset. The source rectangle of the fragment is
+ * relative to the tile's image.
+ *
+ * This allows drawing cells through other means than a QPainter.
+ */
+QPainter::PixmapFragment CellRenderer::fragmentForCell(const MapRenderer *renderer,
+                                                       const Cell &cell,
+                                                       const Tile *tile,
+                                                       const QPointF &screenPos,
+                                                       const QSizeF &size,
+                                                       Origin origin)
+{
+    const QRect imageRect = tile->imageRect();
     const QPoint offset = tile->offset();
     const QPointF sizeHalf { size.width() / 2, size.height() / 2 };
 
@@ -468,7 +874,7 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
     if (origin == BottomLeft)
         fragment.y -= size.height();
 
-    if (mRenderer->cellType() == MapRenderer::HexagonalCells) {
+    if (renderer->cellType() == MapRenderer::HexagonalCells) {
 
         if (cell.flippedAntiDiagonally())
             fragment.rotation += 60;
@@ -491,48 +897,7 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
     fragment.scaleX *= flippedHorizontally ? -1 : 1;
     fragment.scaleY *= flippedVertically ? -1 : 1;
 
-    // Avoid using drawPixmapFragments with OpenGL in Qt 6.4.1 and above
-    // (https://bugreports.qt.io/browse/QTBUG-111416)
-#if QT_VERSION < QT_VERSION_CHECK(6, 4, 1) || QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
-    if (mIsOpenGL || (fragment.scaleX > 0 && fragment.scaleY > 0)) {
-#else
-    if (!mIsOpenGL && fragment.scaleX > 0 && fragment.scaleY > 0) {
-#endif
-        mTile = tile;
-        mFragments.append(fragment);
-        return;
-    }
-
-    // The Raster paint engine as of Qt 4.8.4 / 5.0.2 does not support
-    // drawing fragments with a negative scaling factor.
-
-    flush(); // make sure we drew all tiles so far
-
-    const QTransform oldTransform = mPainter->transform();
-    QTransform transform = oldTransform;
-    transform.translate(fragment.x, fragment.y);
-    transform.rotate(fragment.rotation);
-    transform.scale(fragment.scaleX, fragment.scaleY);
-
-    const QRectF target(fragment.width * -0.5, fragment.height * -0.5,
-                        fragment.width, fragment.height);
-    const QRectF source(fragment.sourceLeft, fragment.sourceTop,
-                        fragment.width, fragment.height);
-
-    mPainter->setTransform(transform);
-    mPainter->drawPixmap(target, tinted(image, mTintColor), source);
-    mPainter->setTransform(oldTransform);
-
-    // A bit of a hack to still draw tile collision shapes when requested
-    if (mRenderer->flags().testFlag(ShowTileCollisionShapes)
-            && tile->objectGroup()
-            && !tile->objectGroup()->objects().isEmpty()) {
-        mTile = tile;
-        mFragments.append(fragment);
-        paintTileCollisionShapes();
-        mTile = nullptr;
-        mFragments.clear();
-    }
+    return fragment;
 }
 
 /**
@@ -543,9 +908,20 @@ void CellRenderer::flush()
     if (!mTile)
         return;
 
-    mPainter->drawPixmapFragments(mFragments.constData(),
-                                  mFragments.size(),
-                                  tinted(mTile->image(), mTintColor));
+    sCounters.flushes.fetch_add(1, std::memory_order_relaxed);
+    sCounters.cellsDrawn.fetch_add(mFragments.size(), std::memory_order_relaxed);
+
+    if (hasTint(mTintColor)) {
+        sCounters.tintedFlushes.fetch_add(1, std::memory_order_relaxed);
+        const QPixmap pixmap = tintedFragments(*mPixmap, mFragments, mTintColor);
+        mPainter->drawPixmapFragments(mFragments.constData(),
+                                      mFragments.size(),
+                                      pixmap);
+    } else {
+        mPainter->drawPixmapFragments(mFragments.constData(),
+                                      mFragments.size(),
+                                      *mPixmap);
+    }
 
     if (mRenderer->flags().testFlag(ShowTileCollisionShapes)
             && mTile->objectGroup()
@@ -554,34 +930,51 @@ void CellRenderer::flush()
     }
 
     mTile = nullptr;
+    mPixmap = nullptr;
     mFragments.clear();
 }
 
 /**
- * Returns a transform that rotates by \a rotation degrees around the given
- * \a position.
+ * Returns a snapshot of the rendering counters.
  */
-static QTransform rotateAt(const QPointF &position, qreal rotation)
+RenderStatistics RenderStatistics::current()
+{
+    RenderStatistics statistics;
+    statistics.cellsDrawn = sCounters.cellsDrawn.load(std::memory_order_relaxed);
+    statistics.flushes = sCounters.flushes.load(std::memory_order_relaxed);
+    statistics.tintedFlushes = sCounters.tintedFlushes.load(std::memory_order_relaxed);
+    statistics.tintCacheHits = sCounters.tintCacheHits.load(std::memory_order_relaxed);
+    statistics.tintCacheMisses = sCounters.tintCacheMisses.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+RenderStatistics RenderStatistics::operator-(const RenderStatistics &other) const
 {
-    QTransform transform;
-    transform.translate(position.x(), position.y());
-    transform.rotate(rotation);
-    transform.translate(-position.x(), -position.y());
-    return transform;
+    RenderStatistics statistics;
+    statistics.cellsDrawn = cellsDrawn - other.cellsDrawn;
+    statistics.flushes = flushes - other.flushes;
+    statistics.tintedFlushes = tintedFlushes - other.tintedFlushes;
+    statistics.tintCacheHits = tintCacheHits - other.tintCacheHits;
+    statistics.tintCacheMisses = tintCacheMisses - other.tintCacheMisses;
+    return statistics;
+}
+
+RenderStatistics &RenderStatistics::operator+=(const RenderStatistics &other)
+{
+    cellsDrawn += other.cellsDrawn;
+    flushes += other.flushes;
+    tintedFlushes += other.tintedFlushes;
+    tintCacheHits += other.tintCacheHits;
+    tintCacheMisses += other.tintCacheMisses;
+    return *this;
 }
 
 void CellRenderer::paintTileCollisionShapes()
 {
     const Tileset *tileset = mTile->tileset();
     const bool isIsometric = tileset->orientation() == Tileset::Isometric;
-    Map::Parameters mapParameters;
-    mapParameters.orientation = isIsometric ? Map::Isometric : Map::Orthogonal;
-    mapParameters.width = 1;
-    mapParameters.height = 1;
-    mapParameters.tileWidth = tileset->gridSize().width();
-    mapParameters.tileHeight = tileset->gridSize().height();
-    const Map map(mapParameters);
-    const auto renderer = MapRenderer::create(&map);
+    const QList<MapObject*> &objects = mTile->objectGroup()->objects();
+    const QVector<QPainterPath> &shapes = mTile->collisionShapes();
 
     const qreal lineWidth = mRenderer->objectLineWidth();
     const qreal shadowDist = (lineWidth == 0 ? 1 : lineWidth) / mRenderer->painterScale();
@@ -596,6 +989,9 @@ void CellRenderer::paintTileCollisionShapes()
 
     mPainter->setRenderHint(QPainter::Antialiasing);
 
+    QVector<QTransform> tileTransforms;
+    tileTransforms.reserve(mFragments.size());
+
     for (const auto &fragment : std::as_const(mFragments)) {
         QTransform tileTransform;
         tileTransform.translate(fragment.x, fragment.y);
@@ -606,28 +1002,34 @@ void CellRenderer::paintTileCollisionShapes()
         if (isIsometric)
             tileTransform.translate(0, fragment.height - tileset->gridSize().height());
 
-        for (MapObject *object : mTile->objectGroup()->objects()) {
-            QColor penColor = object->effectiveColor();
-            QColor brushColor = penColor;
-            brushColor.setAlpha(50);
-            QPen colorPen(shadowPen);
-            colorPen.setColor(penColor);
+        tileTransforms.append(tileTransform);
+    }
 
-            mPainter->setPen(colorPen);
-            mPainter->setBrush(brushColor);
+    // Combine the shapes of each object for all cells in this batch, so that
+    // they can be drawn with only a few calls
+    for (int i = 0; i < objects.size(); ++i) {
+        const MapObject *object = objects.at(i);
+        const QPainterPath &objectShape = shapes.at(i);
 
-            auto transform = rotateAt(renderer->pixelToScreenCoords(object->position()),
-                                      object->rotation());
-            transform *= tileTransform;
+        QPainterPath shape;
+        shape.setFillRule(Qt::WindingFill);
+        for (const QTransform &tileTransform : std::as_const(tileTransforms))
+            shape.addPath(tileTransform.map(objectShape));
 
-            const auto shape = transform.map(renderer->shape(object));
+        QColor penColor = object->effectiveColor();
+        QColor brushColor = penColor;
+        brushColor.setAlpha(50);
+        QPen colorPen(shadowPen);
+        colorPen.setColor(penColor);
 
-            mPainter->strokePath(shape.translated(shadowOffset), shadowPen);
+        mPainter->setPen(colorPen);
+        mPainter->setBrush(brushColor);
 
-            if (object->shape() == MapObject::Polyline)
-                mPainter->strokePath(shape, colorPen);
-            else
-                mPainter->drawPath(shape);
-        }
+        mPainter->strokePath(shape.translated(shadowOffset), shadowPen);
+
+        if (object->shape() == MapObject::Polyline)
+            mPainter->strokePath(shape, colorPen);
+        else
+            mPainter->drawPath(shape);
     }
 }
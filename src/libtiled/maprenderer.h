@@ -169,13 +169,33 @@ public:
     /**
      * Draws the tile selection given by \a region in the specified \a color.
      *
-     * The implementation can be optimized by taking into account the
-     * \a exposed rectangle, to avoid drawing too much.
+     * Only the parts of the selection intersecting the \a exposed rectangle
+     * are drawn.
      */
-    virtual void drawTileSelection(QPainter *painter,
-                                   const QRegion &region,
-                                   const QColor &color,
-                                   const QRectF &exposed) const = 0;
+    void drawTileSelection(QPainter *painter,
+                           const QRegion &region,
+                           const QColor &color,
+                           const QRectF &exposed) const;
+
+    /**
+     * Draws a tile selection outline previously returned by
+     * tileSelectionPath() in the specified \a color.
+     */
+    void drawTileSelection(QPainter *painter,
+                           const QPainterPath &path,
+                           const QColor &color) const;
+
+    /**
+     * Returns the simplified outline of the tile selection given by
+     * \a region, in pixel coordinates. Since computing the outline can be
+     * expensive for complex regions, it can be stored and drawn as long as
+     * the region doesn't change.
+     *
+     * When an \a exposed rectangle is given, only the parts of the selection
+     * intersecting this rectangle are included.
+     */
+    virtual QPainterPath tileSelectionPath(const QRegion &region,
+                                           const QRectF &exposed = QRectF()) const = 0;
 
     /**
      * Draws the \a object in the given \a color using the \a painter.
@@ -207,16 +227,14 @@ public:
     QPolygonF pixelToScreenCoords(const QPolygonF &polygon) const
     {
         QPolygonF screenPolygon(polygon.size());
-        for (int i = polygon.size() - 1; i >= 0; --i)
-            screenPolygon[i] = pixelToScreenCoords(polygon[i]);
+        pixelToScreenCoords(polygon.constData(), screenPolygon.data(), polygon.size());
         return screenPolygon;
     }
 
     QPolygonF screenToPixelCoords(const QPolygonF &polygon) const
     {
         QPolygonF pixelPolygon(polygon.size());
-        for (int i = polygon.size() - 1; i >= 0; --i)
-            pixelPolygon[i] = screenToPixelCoords(polygon[i]);
+        screenToPixelCoords(polygon.constData(), pixelPolygon.data(), polygon.size());
         return pixelPolygon;
     }
 
@@ -258,6 +276,22 @@ public:
     virtual QPointF pixelToScreenCoords(qreal x, qreal y) const = 0;
     inline QPointF pixelToScreenCoords(const QPointF &point) const;
 
+    /**
+     * Batched versions of the above coordinate conversions, converting
+     * \a count \a points and storing them in \a result. The \a points and
+     * \a result may refer to the same array.
+     *
+     * These avoid a virtual call per point and allow the renderers to set up
+     * their parameters only once. The default implementations convert each
+     * point individually, so renderers overriding one of the single point
+     * conversions should override its batched version as well.
+     */
+    virtual void pixelToTileCoords(const QPointF *points, QPointF *result, int count) const;
+    virtual void screenToTileCoords(const QPointF *points, QPointF *result, int count) const;
+    virtual void tileToScreenCoords(const QPointF *points, QPointF *result, int count) const;
+    virtual void screenToPixelCoords(const QPointF *points, QPointF *result, int count) const;
+    virtual void pixelToScreenCoords(const QPointF *points, QPointF *result, int count) const;
+
     qreal objectLineWidth() const { return mObjectLineWidth; }
     void setObjectLineWidth(qreal lineWidth) { mObjectLineWidth = lineWidth; }
 
@@ -268,6 +302,14 @@ public:
     qreal painterScale() const { return mPainterScale; }
     void setPainterScale(qreal painterScale) { mPainterScale = painterScale; }
 
+    /**
+     * Returns the distance in pixels by which polygons can be simplified
+     * without a visible difference at the current painter scale.
+     *
+     * \sa MapObject::simplifiedPolygon()
+     */
+    qreal polygonTolerance() const { return 0.5 / mPainterScale; }
+
     RenderFlags flags() const { return mFlags; }
     void setFlags(RenderFlags flags) { mFlags = flags; }
 
@@ -277,7 +319,12 @@ public:
 
     static std::unique_ptr<MapRenderer> create(const Map *map);
 
+    static qint64 tintCacheMemoryUsage();
+
 protected:
+    static void drawTextObject(QPainter *painter, const QRectF &bounds,
+                               const TextData &textData);
+
     void setupGridPens(const QPaintDevice *device, QColor color,
                        QPen &gridPen, QPen &majorGridPen, int gridSize,
                        QSize gridMajor) const;
@@ -337,19 +384,49 @@ public:
 
     void render(const Cell &cell, const QPointF &pos, const QSizeF &size,
                 Origin origin = TopLeft);
+    void render(const Cell &cell, const Tile *tile, const QPointF &pos,
+                const QSizeF &size, Origin origin = TopLeft);
     void flush();
 
+    static QPainter::PixmapFragment fragmentForCell(const MapRenderer *renderer,
+                                                    const Cell &cell,
+                                                    const Tile *tile,
+                                                    const QPointF &screenPos,
+                                                    const QSizeF &size,
+                                                    Origin origin = TopLeft);
+
 private:
     void paintTileCollisionShapes();
 
     QPainter * const mPainter;
     const MapRenderer * const mRenderer;
     const Tile *mTile;
+    const QPixmap *mPixmap;
     QVector<QPainter::PixmapFragment> mFragments;
     const bool mIsOpenGL;
+    const bool mUseAtlas;
     const QColor mTintColor;
 };
 
+/**
+ * Counters for measuring rendering performance. They are shared by all
+ * renderers, so the difference between two snapshots is usually the
+ * interesting part.
+ */
+struct TILEDSHARED_EXPORT RenderStatistics
+{
+    quint64 cellsDrawn = 0;         // cells drawn by a CellRenderer
+    quint64 flushes = 0;            // batches of fragments drawn
+    quint64 tintedFlushes = 0;      // batches that needed to be tinted
+    quint64 tintCacheHits = 0;      // tinted images found in the cache
+    quint64 tintCacheMisses = 0;    // tinted images that had to be created
+
+    static RenderStatistics current();
+
+    RenderStatistics operator-(const RenderStatistics &other) const;
+    RenderStatistics &operator+=(const RenderStatistics &other);
+};
+
 } // namespace Tiled
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Tiled::RenderFlags)
@@ -21,6 +21,7 @@
 
 #include "maptovariantconverter.h"
 
+#include "base64.h"
 #include "fileformat.h"
 #include "grouplayer.h"
 #include "imagelayer.h"
@@ -35,6 +36,7 @@
 #include "wangset.h"
 
 #include <QCoreApplication>
+#include <QVector>
 
 using namespace Tiled;
 
@@ -119,11 +121,25 @@ QVariant MapToVariantConverter::toVariant(const Map &map, const QDir &mapDir)
     }
     mapVariant[QStringLiteral("tilesets")] = tilesetVariants;
 
+    mLayerDataEncoder.prepareDictionary(map, mGidMapper, map.chunkSize());
+
+    const QByteArray &dictionary = mLayerDataEncoder.dictionary();
+    if (!dictionary.isEmpty())
+        mapVariant[QStringLiteral("compressiondictionary")] = QString::fromLatin1(Base64::encode(dictionary));
+
+    mLayerDataEncoder.encode(map, mGidMapper,
+                             map.layerDataFormat(),
+                             map.chunkSize(),
+                             map.compressionLevel());
+
     mapVariant[QStringLiteral("layers")] = toVariant(map.layers(),
                                                     map.layerDataFormat(),
                                                     map.compressionLevel(),
                                                     map.chunkSize());
 
+    mLayerDataEncoder.clear();
+    mLayerDataEncoder.setDictionary(QByteArray());
+
     return mapVariant;
 }
 
@@ -493,6 +509,8 @@ QVariant MapToVariantConverter::toVariant(const TileLayer &tileLayer,
     case Map::Base64Zlib:
     case Map::Base64Gzip:
     case Map::Base64Zstandard:
+    case Map::Base64RunLength:
+    case Map::Base64RunLengthZstandard:
         tileLayerVariant[QStringLiteral("encoding")] = QLatin1String("base64");
         tileLayerVariant[QStringLiteral("compression")] = compressionToString(format);
         break;
@@ -732,19 +750,35 @@ void MapToVariantConverter::addTileLayerData(QVariantMap &variant,
     switch (format) {
     case Map::XML:
     case Map::CSV: {
-        QVariantList tileVariants;
-        for (int y = bounds.top(); y <= bounds.bottom(); ++y)
-            for (int x = bounds.left(); x <= bounds.right(); ++x)
-                tileVariants << mGidMapper.cellToGid(tileLayer.cellAt(x, y));
+        QVector<unsigned> gids(bounds.width() * bounds.height());
+        unsigned *out = gids.data();
+        tileLayer.forEachSpan(bounds, [&] (int, int, const Cell *cells, int count) {
+            mGidMapper.cellsToGids(cells, count, out);
+            out += count;
+        });
+
+        if (mCompactTileData) {
+            variant[QStringLiteral("data")] = QVariant::fromValue(gids);
+        } else {
+            QVariantList tileVariants;
+            tileVariants.reserve(gids.size());
+            for (unsigned gid : std::as_const(gids))
+                tileVariants << gid;
 
-        variant[QStringLiteral("data")] = tileVariants;
+            variant[QStringLiteral("data")] = tileVariants;
+        }
         break;
     }
     case Map::Base64:
     case Map::Base64Zlib:
     case Map::Base64Gzip:
-    case Map::Base64Zstandard:{
-        QByteArray layerData = mGidMapper.encodeLayerData(tileLayer, format, bounds, compressionLevel);
+    case Map::Base64Zstandard:
+    case Map::Base64RunLength:
+    case Map::Base64RunLengthZstandard: {
+        QByteArray layerData = mLayerDataEncoder.encodedData(tileLayer, bounds);
+        if (layerData.isNull())
+            layerData = mGidMapper.encodeLayerData(tileLayer, format, bounds, compressionLevel,
+                                                   mLayerDataEncoder.dictionary());
         variant[QStringLiteral("data")] = layerData;
         break;
     }
@@ -25,6 +25,7 @@
 #include <QVariant>
 
 #include "gidmapper.h"
+#include "layerdataencoder.h"
 
 namespace Tiled {
 
@@ -62,6 +63,14 @@ public:
     QVariant toVariant(const Tileset &tileset, const QDir &directory);
     QVariant toVariant(const ObjectTemplate &objectTemplate, const QDir &directory);
 
+    /**
+     * When enabled, tile layer data in CSV format is stored as a
+     * QVector<unsigned> instead of a QVariantList, which takes a lot less
+     * memory for large maps. Only use this when the consumer of the variant
+     * knows how to handle this type, like the JsonWriter.
+     */
+    void setCompactTileData(bool compact) { mCompactTileData = compact; }
+
 private:
     QVariant toVariant(const Tileset &tileset, int firstGid) const;
     QVariant toVariant(const Properties &properties) const;
@@ -88,8 +97,10 @@ private:
                        const Properties &properties) const;
 
     int mVersion;
+    bool mCompactTileData = false;
     QDir mDir;
     GidMapper mGidMapper;
+    LayerDataEncoder mLayerDataEncoder;
 };
 
 } // namespace Tiled
@@ -30,11 +30,13 @@
 
 #include "mapwriter.h"
 
+#include "base64.h"
 #include "gidmapper.h"
 #include "grouplayer.h"
 #include "map.h"
 #include "mapobject.h"
 #include "imagelayer.h"
+#include "layerdataencoder.h"
 #include "objectgroup.h"
 #include "objecttemplate.h"
 #include "savefile.h"
@@ -70,6 +72,10 @@ public:
     void writeObjectTemplate(const ObjectTemplate *objectTemplate, QIODevice *device,
                              const QString &path);
 
+    void beginMap(const Map *map, QIODevice *device, const QString &path);
+    void writeLayer(const Layer &layer);
+    void endMap();
+
     bool openFile(SaveFile *file);
 
     QString mError;
@@ -80,7 +86,10 @@ public:
     QSize mChunkSize { CHUNK_SIZE, CHUNK_SIZE };
 
 private:
+    void startDocument(QXmlStreamWriter &w, const Map &map, const QString &path);
     void writeMap(QXmlStreamWriter &w, const Map &map);
+    void writeMapStart(QXmlStreamWriter &w, const Map &map);
+    void writeCompressionDictionary(QXmlStreamWriter &w);
     void writeTileset(QXmlStreamWriter &w, const Tileset &tileset,
                       unsigned firstGid);
     void writeLayers(QXmlStreamWriter &w, const QList<Layer *> &layers);
@@ -102,6 +111,8 @@ private:
 
     QDir mDir;      // The directory in which the file is being saved
     GidMapper mGidMapper;
+    LayerDataEncoder mLayerDataEncoder;
+    std::unique_ptr<QXmlStreamWriter> mStreamWriter;
     bool mUseAbsolutePaths { false };
 };
 
@@ -121,27 +132,71 @@ bool MapWriterPrivate::openFile(SaveFile *file)
 
 void MapWriterPrivate::writeMap(const Map *map, QIODevice *device,
                                 const QString &path)
+{
+    QXmlStreamWriter writer(device);
+    startDocument(writer, *map, path);
+    writeMap(writer, *map);
+    writer.writeEndDocument();
+}
+
+void MapWriterPrivate::beginMap(const Map *map, QIODevice *device,
+                                const QString &path)
+{
+    Q_ASSERT(!mStreamWriter);
+
+    mStreamWriter = std::make_unique<QXmlStreamWriter>(device);
+    startDocument(*mStreamWriter, *map, path);
+    writeMapStart(*mStreamWriter, *map);
+
+    // The layers aren't available yet, so the dictionary can't be trained
+    if (LayerDataEncoder::usesDictionary(*map))
+        mLayerDataEncoder.setDictionary(map->compressionDictionary());
+
+    writeCompressionDictionary(*mStreamWriter);
+}
+
+void MapWriterPrivate::writeLayer(const Layer &layer)
+{
+    Q_ASSERT(mStreamWriter);
+
+    mLayerDataEncoder.encode(layer, mGidMapper, mLayerDataFormat,
+                             mChunkSize, mCompressionlevel);
+
+    writeLayers(*mStreamWriter, { const_cast<Layer*>(&layer) });
+
+    mLayerDataEncoder.clear();
+}
+
+void MapWriterPrivate::endMap()
+{
+    Q_ASSERT(mStreamWriter);
+
+    mStreamWriter->writeEndElement();   // </map>
+    mStreamWriter->writeEndDocument();
+    mStreamWriter.reset();
+
+    mLayerDataEncoder.setDictionary(QByteArray());
+}
+
+void MapWriterPrivate::startDocument(QXmlStreamWriter &w, const Map &map,
+                                     const QString &path)
 {
     mDir = QDir(path);
     mUseAbsolutePaths = path.isEmpty();
-    mLayerDataFormat = map->layerDataFormat();
-    mCompressionlevel = map->compressionLevel();
-    mChunkSize = map->chunkSize();
+    mLayerDataFormat = map.layerDataFormat();
+    mCompressionlevel = map.compressionLevel();
+    mChunkSize = map.chunkSize();
 
-    QXmlStreamWriter writer(device);
-    writer.setAutoFormatting(!mMinimize);
-    writer.setAutoFormattingIndent(1);
+    w.setAutoFormatting(!mMinimize);
+    w.setAutoFormattingIndent(1);
 
-    writer.writeStartDocument();
+    w.writeStartDocument();
 
     if (mDtdEnabled) {
-        writer.writeDTD(QLatin1String("<!DOCTYPE map SYSTEM \""
-                                      "http://mapeditor.org/dtd/1.0/"
-                                      "map.dtd\">"));
+        w.writeDTD(QLatin1String("<!DOCTYPE map SYSTEM \""
+                                 "http://mapeditor.org/dtd/1.0/"
+                                 "map.dtd\">"));
     }
-
-    writeMap(writer, *map);
-    writer.writeEndDocument();
 }
 
 void MapWriterPrivate::writeTileset(const Tileset &tileset, QIODevice *device,
@@ -193,6 +248,39 @@ void MapWriterPrivate::writeObjectTemplate(const ObjectTemplate *objectTemplate,
 }
 
 void MapWriterPrivate::writeMap(QXmlStreamWriter &w, const Map &map)
+{
+    writeMapStart(w, map);
+
+    mLayerDataEncoder.prepareDictionary(map, mGidMapper, mChunkSize);
+    writeCompressionDictionary(w);
+
+    mLayerDataEncoder.encode(map, mGidMapper, mLayerDataFormat,
+                             mChunkSize, mCompressionlevel);
+
+    writeLayers(w, map.layers());
+
+    mLayerDataEncoder.clear();
+    mLayerDataEncoder.setDictionary(QByteArray());
+
+    w.writeEndElement();
+}
+
+void MapWriterPrivate::writeCompressionDictionary(QXmlStreamWriter &w)
+{
+    const QByteArray &dictionary = mLayerDataEncoder.dictionary();
+    if (dictionary.isEmpty())
+        return;
+
+    w.writeStartElement(QStringLiteral("compressiondictionary"));
+    w.writeAttribute(QStringLiteral("encoding"), QStringLiteral("base64"));
+    w.writeCharacters(QString::fromLatin1(Base64::encode(dictionary)));
+    w.writeEndElement(); // </compressiondictionary>
+}
+
+/**
+ * Writes the start of the map element, including everything but its layers.
+ */
+void MapWriterPrivate::writeMapStart(QXmlStreamWriter &w, const Map &map)
 {
     w.writeStartElement(QStringLiteral("map"));
 
@@ -274,10 +362,6 @@ void MapWriterPrivate::writeMap(QXmlStreamWriter &w, const Map &map)
         mGidMapper.insert(firstGid, tileset);
         firstGid += tileset->nextTileId();
     }
-
-    writeLayers(w, map.layers());
-
-    w.writeEndElement();
 }
 
 static bool includeTile(const Tile *tile)
@@ -542,6 +626,8 @@ void MapWriterPrivate::writeTileLayer(QXmlStreamWriter &w,
     case Map::Base64Gzip:
     case Map::Base64Zlib:
     case Map::Base64Zstandard:
+    case Map::Base64RunLength:
+    case Map::Base64RunLengthZstandard:
         encoding = QStringLiteral("base64");
         compression = compressionToString(mLayerDataFormat);
         break;
@@ -582,39 +668,46 @@ void MapWriterPrivate::writeTileLayerData(QXmlStreamWriter &w,
                                           const TileLayer &tileLayer,
                                           QRect bounds)
 {
+    unsigned gids[CHUNK_SIZE];
+
     if (mLayerDataFormat == Map::XML) {
-        for (int y = bounds.top(); y <= bounds.bottom(); y++) {
-            for (int x = bounds.left(); x <= bounds.right(); x++) {
-                const unsigned gid = mGidMapper.cellToGid(tileLayer.cellAt(x, y));
+        tileLayer.forEachSpan(bounds, [&] (int, int, const Cell *cells, int count) {
+            mGidMapper.cellsToGids(cells, count, gids);
+            for (int i = 0; i < count; ++i) {
+                const unsigned gid = gids[i];
                 w.writeStartElement(QStringLiteral("tile"));
                 if (gid != 0)
                     w.writeAttribute(QStringLiteral("gid"), QString::number(gid));
                 w.writeEndElement();
             }
-        }
+        });
     } else if (mLayerDataFormat == Map::CSV) {
         QString chunkData;
 
         if (!mMinimize)
             chunkData.append(QLatin1Char('\n'));
 
-        for (int y = bounds.top(); y <= bounds.bottom(); y++) {
-            for (int x = bounds.left(); x <= bounds.right(); x++) {
-                const unsigned gid = mGidMapper.cellToGid(tileLayer.cellAt(x, y));
-                chunkData.append(QString::number(gid));
+        tileLayer.forEachSpan(bounds, [&] (int x, int y, const Cell *cells, int count) {
+            mGidMapper.cellsToGids(cells, count, gids);
+            for (int i = 0; i < count; ++i, ++x) {
+                chunkData.append(QString::number(gids[i]));
                 if (x != bounds.right() || y != bounds.bottom())
                     chunkData.append(QLatin1Char(','));
             }
-            if (!mMinimize)
+            if (!mMinimize && x > bounds.right())
                 chunkData.append(QLatin1Char('\n'));
-        }
+        });
 
         w.writeCharacters(chunkData);
     } else {
-        QByteArray chunkData = mGidMapper.encodeLayerData(tileLayer,
-                                                          mLayerDataFormat,
-                                                          bounds,
-                                                          mCompressionlevel);
+        QByteArray chunkData = mLayerDataEncoder.encodedData(tileLayer, bounds);
+        if (chunkData.isNull()) {
+            chunkData = mGidMapper.encodeLayerData(tileLayer,
+                                                   mLayerDataFormat,
+                                                   bounds,
+                                                   mCompressionlevel,
+                                                   mLayerDataEncoder.dictionary());
+        }
 
         if (!mMinimize)
             w.writeCharacters(QLatin1String("\n   "));
@@ -964,7 +1057,7 @@ void MapWriterPrivate::writeImage(QXmlStreamWriter &w,
 
         QBuffer buffer;
         image.save(&buffer, "png");
-        w.writeCharacters(QString::fromLatin1(buffer.data().toBase64()));
+        w.writeCharacters(QString::fromLatin1(Base64::encode(buffer.data())));
         w.writeEndElement(); // </data>
     }
 
@@ -1006,6 +1099,22 @@ bool MapWriter::writeMap(const Map *map, const QString &fileName)
     return true;
 }
 
+void MapWriter::beginMap(const Map *map, QIODevice *device,
+                         const QString &path)
+{
+    d->beginMap(map, device, path);
+}
+
+void MapWriter::writeLayer(const Layer *layer)
+{
+    d->writeLayer(*layer);
+}
+
+void MapWriter::endMap()
+{
+    d->endMap();
+}
+
 void MapWriter::writeTileset(const Tileset &tileset, QIODevice *device,
                              const QString &path)
 {
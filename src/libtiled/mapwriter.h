@@ -77,6 +77,30 @@ public:
      */
     bool writeMap(const Map *map, const QString &fileName);
 
+    /**
+     * Starts writing a TMX map to the given \a device, for writing its
+     * layers one at a time using writeLayer(). Everything except for the
+     * layers is written based on \a map. The \a path is used like in
+     * writeMap().
+     *
+     * This allows writing a map without having all its layers in memory.
+     * Call endMap() when all layers have been written.
+     */
+    void beginMap(const Map *map, QIODevice *device,
+                  const QString &path = QString());
+
+    /**
+     * Writes the given \a layer as part of the map started with beginMap().
+     * The layer needs to be part of a map using the tilesets that were
+     * written.
+     */
+    void writeLayer(const Layer *layer);
+
+    /**
+     * Finishes writing the map started with beginMap().
+     */
+    void endMap();
+
     /**
      * Writes a TSX tileset to the given \a device. Optionally a \a path can
      * be given, which will be used to create relative references to external
@@ -38,9 +38,17 @@
 #include "tilelayer.h"
 
 #include <QPainter>
+#include <QThread>
+#include <QtConcurrent>
 
 using namespace Tiled;
 
+/**
+ * The minimum height in pixels of the bands in which the image is split for
+ * rendering it in parallel.
+ */
+static constexpr int MinimumBandHeight = 128;
+
 MiniMapRenderer::MiniMapRenderer(const Map *map)
     : mMap(map)
     , mRenderer(MapRenderer::create(map))
@@ -66,11 +74,6 @@ QImage MiniMapRenderer::render(QSize size, RenderFlags renderFlags) const
     return image;
 }
 
-static bool objectLessThan(const MapObject *a, const MapObject *b)
-{
-    return a->y() < b->y();
-}
-
 static QRectF cellRect(const MapRenderer &renderer,
                        const Cell &cell,
                        const QPointF &tileCoords)
@@ -120,7 +123,43 @@ static void extendMapRect(QRect &mapBoundingRect, const MapRenderer &renderer)
     mapBoundingRect = rect.toAlignedRect();
 }
 
+/**
+ * Makes sure the images of all tiles used by the map are loaded, since
+ * images that are loaded on demand can only be loaded on the main thread.
+ */
+static void loadTileImages(const Map *map, bool visibleLayersOnly)
+{
+    LayerIterator iterator(map);
+    while (const Layer *layer = iterator.next()) {
+        if (visibleLayersOnly && layer->isHidden())
+            continue;
+
+        if (layer->isTileLayer()) {
+            for (const Cell &cell : *static_cast<const TileLayer*>(layer))
+                if (const Tile *tile = cell.tile())
+                    tile->image();
+        } else if (layer->isObjectGroup()) {
+            for (const MapObject *object : static_cast<const ObjectGroup*>(layer)->objects())
+                if (const Tile *tile = object->cell().tile())
+                    tile->image();
+        }
+    }
+}
+
 void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) const
+{
+    renderToImage(image, renderFlags, QRect());
+}
+
+/**
+ * Renders only the given \a area of the map (in pixels) to the \a image.
+ * The rest of the image is left untouched, so it should have been rendered
+ * before with the same \a renderFlags. When \a area is null, the whole map
+ * is rendered.
+ *
+ * Larger areas are rendered using multiple threads.
+ */
+void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags, const QRect &area) const
 {
     if (!mMap)
         return;
@@ -128,9 +167,6 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
         return;
 
     const bool drawObjects = renderFlags.testFlag(RenderFlag::DrawMapObjects);
-    const bool drawTileLayers = renderFlags.testFlag(RenderFlag::DrawTileLayers);
-    const bool drawImageLayers = renderFlags.testFlag(RenderFlag::DrawImageLayers);
-    const bool drawTileGrid = renderFlags.testFlag(RenderFlag::DrawGrid);
     const bool visibleLayersOnly = renderFlags.testFlag(RenderFlag::IgnoreInvisibleLayer);
 
     QRect mapBoundingRect = mRenderer->mapBoundingRect();
@@ -147,25 +183,121 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
     const qreal scale = qMin(static_cast<qreal>(image.width()) / mapSize.width(),
                              static_cast<qreal>(image.height()) / mapSize.height());
 
-    if (renderFlags.testFlag(DrawBackground) && mMap->backgroundColor().isValid())
-        image.fill(mMap->backgroundColor());
-    else
-        image.fill(Qt::transparent);
-
-    QPainter painter(&image);
-    painter.setRenderHints(QPainter::SmoothPixmapTransform, renderFlags.testFlag(SmoothPixmapTransform));
-
     // Center the map in the requested size
     const QSize scaledMapSize = mapSize * scale;
     const QPointF centerOffset((image.width() - scaledMapSize.width()) / 2,
                                (image.height() - scaledMapSize.height()) / 2);
 
-    painter.translate(centerOffset);
-    painter.scale(scale, scale);
-    painter.translate(-mapBoundingRect.topLeft());
+    QTransform transform;
+    transform.translate(centerOffset.x(), centerOffset.y());
+    transform.scale(scale, scale);
+    transform.translate(-mapBoundingRect.left(), -mapBoundingRect.top());
+
+    QRect imageArea = image.rect();
+    if (!area.isNull())
+        imageArea &= transform.mapRect(QRectF(area)).toAlignedRect();
+    if (imageArea.isEmpty())
+        return;
 
     mRenderer->setPainterScale(scale);
 
+    // Split larger areas in horizontal bands, which are rendered in parallel
+    const int bandCount = qBound(1, imageArea.height() / MinimumBandHeight,
+                                 QThread::idealThreadCount());
+
+    if (bandCount > 1) {
+        loadTileImages(mMap, visibleLayersOnly);
+
+        // Update the cached draw order and simplified polygons before they
+        // are used from several threads
+        if (drawObjects) {
+            const qreal polygonTolerance = mRenderer->polygonTolerance();
+
+            for (const Layer *layer : mMap->objectGroups()) {
+                auto objectGroup = static_cast<const ObjectGroup*>(layer);
+                for (const MapObject *object : objectGroup->objectsInDrawOrder())
+                    object->simplifiedPolygon(polygonTolerance);
+            }
+        }
+
+        QVector<QRect> bands;
+        for (int i = 0; i < bandCount; ++i) {
+            const int top = imageArea.top() + imageArea.height() * i / bandCount;
+            const int bottom = imageArea.top() + imageArea.height() * (i + 1) / bandCount;
+            bands.append(QRect(imageArea.left(), top, imageArea.width(), bottom - top));
+        }
+
+        // Each band paints on its own image sharing the pixel data
+        uchar *bits = image.bits();
+        const qsizetype bytesPerLine = image.bytesPerLine();
+
+        QtConcurrent::blockingMap(bands, [&] (const QRect &band) {
+            QImage bandImage(bits + band.top() * bytesPerLine,
+                             image.width(), band.height(), bytesPerLine,
+                             image.format());
+
+            // The renderer is not shared between threads
+            const auto renderer = MapRenderer::create(mMap);
+            renderer->setFlags(mRenderer->flags());
+            renderer->setPainterScale(scale);
+
+            QPainter painter(&bandImage);
+            painter.translate(0, -band.top());
+            renderArea(painter, *renderer, band, transform, mapBoundingRect, renderFlags);
+        });
+    } else {
+        QPainter painter(&image);
+        renderArea(painter, *mRenderer, imageArea, transform, mapBoundingRect, renderFlags);
+    }
+
+    // Labels are drawn on the main thread, since the callback may rely on it
+    if (drawObjects && mRenderObjectLabelCallback) {
+        QPainter painter(&image);
+        painter.setClipRect(imageArea);
+        painter.setRenderHints(QPainter::SmoothPixmapTransform, renderFlags.testFlag(SmoothPixmapTransform));
+        painter.setTransform(transform);
+
+        for (const Layer *layer : mMap->objectGroups()) {
+            if (visibleLayersOnly && layer->isHidden())
+                continue;
+
+            const ObjectGroup *objectGroup = static_cast<const ObjectGroup*>(layer);
+
+            for (const MapObject *object : objectGroup->objects())
+                if (object->isVisible())
+                    mRenderObjectLabelCallback(painter, object, *mRenderer);
+        }
+    }
+}
+
+/**
+ * Renders the part of the map that ends up in the given \a imageArea, using
+ * the given \a transform from map to image coordinates.
+ */
+void MiniMapRenderer::renderArea(QPainter &painter, const MapRenderer &renderer,
+                                 const QRect &imageArea, const QTransform &transform,
+                                 const QRect &mapBoundingRect, RenderFlags renderFlags) const
+{
+    const bool drawObjects = renderFlags.testFlag(RenderFlag::DrawMapObjects);
+    const bool drawTileLayers = renderFlags.testFlag(RenderFlag::DrawTileLayers);
+    const bool drawImageLayers = renderFlags.testFlag(RenderFlag::DrawImageLayers);
+    const bool drawTileGrid = renderFlags.testFlag(RenderFlag::DrawGrid);
+    const bool visibleLayersOnly = renderFlags.testFlag(RenderFlag::IgnoreInvisibleLayer);
+
+    painter.setClipRect(imageArea);
+
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    if (renderFlags.testFlag(DrawBackground) && mMap->backgroundColor().isValid())
+        painter.fillRect(imageArea, mMap->backgroundColor());
+    else
+        painter.fillRect(imageArea, Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+    painter.setRenderHints(QPainter::SmoothPixmapTransform, renderFlags.testFlag(SmoothPixmapTransform));
+    painter.setTransform(transform, true);
+
+    const QRectF exposed = transform.inverted().mapRect(QRectF(imageArea));
+
     LayerIterator iterator(mMap);
     while (const Layer *layer = iterator.next()) {
         if (visibleLayersOnly && layer->isHidden())
@@ -180,7 +312,7 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
         case Layer::TileLayerType: {
             if (drawTileLayers) {
                 const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
-                mRenderer->drawTileLayer(&painter, tileLayer);
+                renderer.drawTileLayer(&painter, tileLayer, exposed.translated(-offset));
             }
             break;
         }
@@ -188,22 +320,18 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
         case Layer::ObjectGroupType: {
             if (drawObjects) {
                 const ObjectGroup *objectGroup = static_cast<const ObjectGroup*>(layer);
-                QList<MapObject*> objects = objectGroup->objects();
-
-                if (objectGroup->drawOrder() == ObjectGroup::TopDownOrder)
-                    std::stable_sort(objects.begin(), objects.end(), objectLessThan);
 
-                for (const MapObject *object : std::as_const(objects)) {
+                for (const MapObject *object : objectGroup->objectsInDrawOrder()) {
                     if (object->isVisible()) {
                         if (object->rotation() != qreal(0)) {
-                            QPointF origin = mRenderer->pixelToScreenCoords(object->position());
+                            QPointF origin = renderer.pixelToScreenCoords(object->position());
                             painter.save();
                             painter.translate(origin);
                             painter.rotate(object->rotation());
                             painter.translate(-origin);
                         }
 
-                        mRenderer->drawMapObject(&painter, object, object->effectiveColors());
+                        renderer.drawMapObject(&painter, object, object->effectiveColors());
 
                         if (object->rotation() != qreal(0))
                             painter.restore();
@@ -215,7 +343,7 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
         case Layer::ImageLayerType: {
             if (drawImageLayers) {
                 const ImageLayer *imageLayer = static_cast<const ImageLayer*>(layer);
-                mRenderer->drawImageLayer(&painter, imageLayer);
+                renderer.drawImageLayer(&painter, imageLayer, exposed.translated(-offset));
             }
             break;
         }
@@ -229,18 +357,5 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
     }
 
     if (drawTileGrid)
-        mRenderer->drawGrid(&painter, mapBoundingRect, mGridColor);
-
-    if (drawObjects && mRenderObjectLabelCallback) {
-        for (const Layer *layer : mMap->objectGroups()) {
-            if (visibleLayersOnly && layer->isHidden())
-                continue;
-
-            const ObjectGroup *objectGroup = static_cast<const ObjectGroup*>(layer);
-
-            for (const MapObject *object : objectGroup->objects())
-                if (object->isVisible())
-                    mRenderObjectLabelCallback(painter, object, *mRenderer);
-        }
-    }
+        renderer.drawGrid(&painter, exposed & QRectF(mapBoundingRect), mGridColor);
 }
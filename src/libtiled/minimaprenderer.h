@@ -33,6 +33,7 @@
 #include "tiled_global.h"
 
 #include <QImage>
+#include <QTransform>
 
 #include <functional>
 #include <memory>
@@ -73,8 +74,13 @@ public:
     QImage render(QSize size, RenderFlags renderFlags) const;
 
     void renderToImage(QImage &image, RenderFlags renderFlags) const;
+    void renderToImage(QImage &image, RenderFlags renderFlags, const QRect &area) const;
 
 private:
+    void renderArea(QPainter &painter, const MapRenderer &renderer,
+                    const QRect &imageArea, const QTransform &transform,
+                    const QRect &mapBoundingRect, RenderFlags renderFlags) const;
+
     const Map *mMap;
     std::unique_ptr<MapRenderer> mRenderer;
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
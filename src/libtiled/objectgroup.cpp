@@ -33,8 +33,10 @@
 #include "layer.h"
 #include "map.h"
 #include "mapobject.h"
+#include "objectspatialindex.h"
 #include "tile.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace Tiled;
@@ -54,6 +56,22 @@ ObjectGroup::~ObjectGroup()
     qDeleteAll(mObjects);
 }
 
+/**
+ * Returns the approximate amount of memory used by this object group,
+ * including its objects and properties, in bytes.
+ */
+qint64 ObjectGroup::memoryUsage() const
+{
+    qint64 usage = sizeof(ObjectGroup)
+            + mObjects.size() * qint64(sizeof(MapObject*))
+            + propertiesMemoryUsage(properties());
+
+    for (const MapObject *object : mObjects)
+        usage += object->memoryUsage();
+
+    return usage;
+}
+
 void ObjectGroup::addObject(MapObject *object)
 {
     insertObject(mObjects.size(), object);
@@ -66,10 +84,29 @@ void ObjectGroup::addObject(std::unique_ptr<MapObject> object)
 
 void ObjectGroup::insertObject(int index, MapObject *object)
 {
-    mObjects.insert(index, object);
-    object->setObjectGroup(this);
     if (mMap && object->id() == 0)
         object->setId(mMap->takeNextObjectId());
+
+    mObjects.insert(index, object);
+    object->setObjectGroup(this);
+    invalidateDrawOrder();
+
+    if (mObjectsByIdValid) {
+        // Rebuild when needed, to find the first of any duplicates
+        if (mObjectsById.contains(object->id()))
+            mObjectsByIdValid = false;
+        else
+            mObjectsById.insert(object->id(), object);
+    }
+
+    if (mObjectsBoundingRectValid)
+        mObjectsBoundingRect = mObjectsBoundingRect.united(object->bounds());
+
+    if (mSpatialIndex)
+        mSpatialIndex->insert(object);
+
+    if (mMap)
+        mMap->objectAdded(object);
 }
 
 int ObjectGroup::removeObject(MapObject *object)
@@ -86,6 +123,16 @@ void ObjectGroup::removeObjectAt(int index)
 {
     MapObject *object = mObjects.takeAt(index);
     object->setObjectGroup(nullptr);
+
+    mObjectsByIdValid = false;
+    mObjectsBoundingRectValid = false;
+    invalidateDrawOrder();
+
+    if (mSpatialIndex)
+        mSpatialIndex->remove(object);
+
+    if (mMap)
+        mMap->objectRemoved(object);
 }
 
 void ObjectGroup::moveObjects(int from, int to, int count)
@@ -108,14 +155,124 @@ void ObjectGroup::moveObjects(int from, int to, int count)
 
     for (int i = 0; i < count; ++i)
         mObjects.insert(to + i, movingObjects.at(i));
+
+    invalidateDrawOrder();
+}
+
+/**
+ * Returns the objects in the order in which they are drawn. For top-down
+ * draw order, this is sorted by their y-coordinate, keeping objects with the
+ * same y-coordinate in their stacking order.
+ *
+ * The sorted order is cached. When a few objects have moved, only those are
+ * taken out and inserted again at their new place.
+ *
+ * Not thread-safe, unless the order has already been updated since the last
+ * change.
+ */
+const QList<MapObject*> &ObjectGroup::objectsInDrawOrder() const
+{
+    if (mDrawOrder != TopDownOrder)
+        return mObjects;
+
+    const auto drawOrderLessThan = [] (const DrawOrderEntry &a, const DrawOrderEntry &b) {
+        const qreal ay = a.object->y();
+        const qreal by = b.object->y();
+        return ay < by || (ay == by && a.index < b.index);
+    };
+
+    if (!mDrawOrderValid) {
+        mDrawOrderEntries.resize(mObjects.size());
+        for (int i = 0, end = mObjects.size(); i < end; ++i)
+            mDrawOrderEntries[i] = { mObjects.at(i), i };
+
+        std::sort(mDrawOrderEntries.begin(), mDrawOrderEntries.end(), drawOrderLessThan);
+
+        mMovedObjects.clear();
+        mDrawOrderValid = true;
+    } else if (!mMovedObjects.isEmpty()) {
+        // Take out the moved objects, leaving the others in sorted order
+        QVector<DrawOrderEntry> moved;
+        moved.reserve(mMovedObjects.size());
+
+        for (const MapObject *object : std::as_const(mMovedObjects)) {
+            auto it = std::find_if(mDrawOrderEntries.begin(), mDrawOrderEntries.end(),
+                                   [object] (const DrawOrderEntry &entry) { return entry.object == object; });
+            Q_ASSERT(it != mDrawOrderEntries.end());
+            moved.append(*it);
+            mDrawOrderEntries.erase(it);
+        }
+
+        for (const DrawOrderEntry &entry : std::as_const(moved)) {
+            auto it = std::lower_bound(mDrawOrderEntries.begin(), mDrawOrderEntries.end(),
+                                       entry, drawOrderLessThan);
+            mDrawOrderEntries.insert(it, entry);
+        }
+
+        mMovedObjects.clear();
+    } else {
+        return mObjectsInDrawOrder;
+    }
+
+    mObjectsInDrawOrder.clear();
+    mObjectsInDrawOrder.reserve(mDrawOrderEntries.size());
+    for (const DrawOrderEntry &entry : std::as_const(mDrawOrderEntries))
+        mObjectsInDrawOrder.append(entry.object);
+
+    return mObjectsInDrawOrder;
 }
 
 QRectF ObjectGroup::objectsBoundingRect() const
 {
-    QRectF boundingRect;
-    for (const MapObject *object : mObjects)
-        boundingRect = boundingRect.united(object->bounds());
-    return boundingRect;
+    if (!mObjectsBoundingRectValid) {
+        mObjectsBoundingRect = QRectF();
+        for (const MapObject *object : mObjects)
+            mObjectsBoundingRect = mObjectsBoundingRect.united(object->bounds());
+        mObjectsBoundingRectValid = true;
+    }
+
+    return mObjectsBoundingRect;
+}
+
+/**
+ * Returns the object with the given \a id, or nullptr when this group does
+ * not contain such an object.
+ *
+ * Uses a lookup table, which is created on first use.
+ */
+MapObject *ObjectGroup::findObjectById(int id) const
+{
+    if (!mObjectsByIdValid) {
+        mObjectsById.clear();
+        mObjectsById.reserve(mObjects.size());
+
+        for (MapObject *object : mObjects)
+            if (!mObjectsById.contains(object->id()))
+                mObjectsById.insert(object->id(), object);
+
+        mObjectsByIdValid = true;
+    }
+
+    return mObjectsById.value(id);
+}
+
+/**
+ * Returns the objects whose bounds overlap or touch the given \a rect,
+ * sorted by their ID. The rect is in pixel coordinates, not including the
+ * offset of the layer.
+ *
+ * The bounds take into account the alignment, rotation and polygon of each
+ * object, but not any tile offset.
+ *
+ * Uses a spatial index, which is created on first use and kept up to date
+ * afterwards.
+ */
+QList<MapObject*> ObjectGroup::objectsIntersecting(const QRectF &rect) const
+{
+    if (!mSpatialIndex || mSpatialIndex->isOutdated())
+        mSpatialIndex = std::make_unique<ObjectSpatialIndex>(mObjects);
+
+    return mSpatialIndex->objectsIntersecting(rect);
 }
 
 bool ObjectGroup::isEmpty() const
@@ -207,6 +364,51 @@ Layer *ObjectGroup::mergedWith(const Layer *other) const
  *
  * \sa Layer::clone()
  */
+void ObjectGroup::setMap(Map *map)
+{
+    if (mMap) {
+        for (MapObject *object : std::as_const(mObjects))
+            mMap->objectRemoved(object);
+    }
+
+    Layer::setMap(map);
+
+    if (mMap) {
+        for (MapObject *object : std::as_const(mObjects))
+            mMap->objectAdded(object);
+    }
+}
+
+void ObjectGroup::objectIdChanged(MapObject *)
+{
+    mObjectsByIdValid = false;
+
+    if (mMap)
+        mMap->objectIdChanged();
+}
+
+void ObjectGroup::objectGeometryChanged(MapObject *object)
+{
+    mObjectsBoundingRectValid = false;
+
+    if (mSpatialIndex)
+        mSpatialIndex->invalidate(object);
+
+    // Remember moved objects, unless so many moved that sorting is cheaper
+    if (mDrawOrderValid && !mMovedObjects.contains(object)) {
+        if (mMovedObjects.size() < 16)
+            mMovedObjects.append(object);
+        else
+            invalidateDrawOrder();
+    }
+}
+
+void ObjectGroup::invalidateDrawOrder()
+{
+    mDrawOrderValid = false;
+    mMovedObjects.clear();
+}
+
 ObjectGroup *ObjectGroup::clone() const
 {
     return initializeClone(new ObjectGroup(mName, mX, mY));
@@ -33,14 +33,17 @@
 #include "layer.h"
 
 #include <QColor>
+#include <QHash>
 #include <QList>
 #include <QMetaType>
+#include <QVector>
 
 #include <memory>
 
 namespace Tiled {
 
 class MapObject;
+class ObjectSpatialIndex;
 
 /**
  * A group of objects on a map.
@@ -75,11 +78,15 @@ public:
      */
     int objectCount() const { return mObjects.size(); }
 
+    qint64 memoryUsage() const;
+
     /**
      * Returns the object at the specified index.
      */
     MapObject *objectAt(int index) const { return mObjects.at(index); }
 
+    const QList<MapObject*> &objectsInDrawOrder() const;
+
     /**
      * Adds an object to this object group.
      */
@@ -124,6 +131,10 @@ public:
      */
     QRectF objectsBoundingRect() const;
 
+    MapObject *findObjectById(int id) const;
+
+    QList<MapObject*> objectsIntersecting(const QRectF &rect) const;
+
     /**
      * Returns whether this object group contains any objects.
      */
@@ -179,12 +190,35 @@ public:
     QList<MapObject*>::const_iterator end() const { return mObjects.end(); }
 
 protected:
+    void setMap(Map *map) override;
     ObjectGroup *initializeClone(ObjectGroup *clone) const;
 
 private:
+    friend class MapObject;
+
+    void objectIdChanged(MapObject *object);
+    void objectGeometryChanged(MapObject *object);
+    void invalidateDrawOrder();
+
+    struct DrawOrderEntry {
+        MapObject *object;
+        int index;
+    };
+
     QList<MapObject*> mObjects;
     QColor mColor;
     DrawOrder mDrawOrder = TopDownOrder;
+
+    // Lookup structures, created when needed
+    mutable QHash<int, MapObject*> mObjectsById;
+    mutable bool mObjectsByIdValid = false;
+    mutable QRectF mObjectsBoundingRect;
+    mutable bool mObjectsBoundingRectValid = false;
+    mutable std::unique_ptr<ObjectSpatialIndex> mSpatialIndex;
+    mutable QVector<DrawOrderEntry> mDrawOrderEntries;
+    mutable QList<MapObject*> mObjectsInDrawOrder;
+    mutable QVector<MapObject*> mMovedObjects;      // since mObjectsInDrawOrder was sorted
+    mutable bool mDrawOrderValid = false;
 };
 
 
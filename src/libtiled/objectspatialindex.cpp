@@ -0,0 +1,315 @@
+/*
+ * objectspatialindex.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "objectspatialindex.h"
+
+#include "mapobject.h"
+
+#include <QTransform>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Tiled;
+
+// Objects covering more cells are checked on each query instead
+static constexpr int MaximumCellsPerObject = 64;
+
+// Avoids overflowing the cell coordinates
+static constexpr qreal MaximumCellCoordinate = 1 << 30;
+
+static quint64 cellKey(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
+static qint64 cellCount(const QRect &range)
+{
+    // Not using QRect::width and height, since these may overflow
+    return (qint64(range.right()) - range.left() + 1) *
+            (qint64(range.bottom()) - range.top() + 1);
+}
+
+static bool overlaps(const QRectF &a, const QRectF &b)
+{
+    // Unlike QRectF::intersects, this also works for point objects
+    return a.left() <= b.right() && b.left() <= a.right() &&
+            a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+static QRectF rotatedBounds(const QRectF &rect, const MapObject *object)
+{
+    if (object->rotation() == 0.0)
+        return rect;
+
+    QTransform transform;
+    transform.translate(object->x(), object->y());
+    transform.rotate(object->rotation());
+    transform.translate(-object->x(), -object->y());
+    return transform.mapRect(rect);
+}
+
+/**
+ * Returns bounds that contain \a object regardless of its alignment, which
+ * for tile objects depends on the tileset and the map. This way the index
+ * does not need to be updated when either of those changes.
+ */
+static QRectF indexBounds(const MapObject *object)
+{
+    if (object->isTileObject()) {
+        const QSizeF size = object->size();
+        const QRectF rect(object->x() - size.width(), object->y() - size.height(),
+                          size.width() * 2, size.height() * 2);
+        return rotatedBounds(rect.normalized(), object);
+    }
+
+    return ObjectSpatialIndex::objectBounds(object);
+}
+
+ObjectSpatialIndex::ObjectSpatialIndex(const QList<MapObject*> &objects)
+{
+    // Choose the cell size based on the typical object size and the average
+    // distance between objects
+    QVector<qreal> extents;
+    extents.reserve(objects.size());
+
+    // Not using QRectF::united, since it ignores the bounds of point objects
+    qreal left = 0, top = 0, right = 0, bottom = 0;
+
+    for (const MapObject *object : objects) {
+        const QRectF bounds = indexBounds(object);
+        extents.append(std::max(bounds.width(), bounds.height()));
+
+        if (extents.size() == 1) {
+            left = bounds.left();
+            top = bounds.top();
+            right = bounds.right();
+            bottom = bounds.bottom();
+        } else {
+            left = std::min(left, bounds.left());
+            top = std::min(top, bounds.top());
+            right = std::max(right, bounds.right());
+            bottom = std::max(bottom, bounds.bottom());
+        }
+    }
+
+    if (!extents.isEmpty()) {
+        auto median = extents.begin() + extents.size() / 2;
+        std::nth_element(extents.begin(), median, extents.end());
+
+        const qreal spacing = std::sqrt((right - left) * (bottom - top) / extents.size());
+        const qreal cellSize = std::max(*median, spacing) * 2;
+
+        if (std::isfinite(cellSize) && cellSize > mCellSize)
+            mCellSize = cellSize;
+    }
+
+    mCellRanges.reserve(objects.size());
+    for (MapObject *object : objects)
+        insert(object);
+}
+
+void ObjectSpatialIndex::remove(MapObject *object)
+{
+    take(object);
+    mChangedObjects.remove(object);
+}
+
+/**
+ * Marks the geometry of \a object as changed.
+ */
+void ObjectSpatialIndex::invalidate(MapObject *object)
+{
+    if (mCellRanges.contains(object))
+        mChangedObjects.insert(object);
+}
+
+/**
+ * Returns the objects whose bounds overlap or touch the given \a rect,
+ * sorted by their ID.
+ */
+QList<MapObject*> ObjectSpatialIndex::objectsIntersecting(const QRectF &rect)
+{
+    update();
+
+    QList<MapObject*> objects;
+
+    auto check = [&] (const Entry &entry) {
+        if (overlaps(entry.bounds, rect) && overlaps(objectBounds(entry.object), rect))
+            objects.append(entry.object);
+    };
+
+    for (const Entry &entry : std::as_const(mLargeObjects))
+        check(entry);
+
+    const QRect range = cellRange(rect);
+
+    // An object is only checked in the top-left cell it shares with the
+    // queried range, to avoid reporting it more than once
+    auto checkCell = [&] (int x, int y, const QVector<Entry> &entries) {
+        for (const Entry &entry : entries) {
+            if (x == std::max(entry.cells.left(), range.left()) &&
+                    y == std::max(entry.cells.top(), range.top()))
+                check(entry);
+        }
+    };
+
+    if (cellCount(range) <= mCells.size()) {
+        for (int y = range.top(); y <= range.bottom(); ++y) {
+            for (int x = range.left(); x <= range.right(); ++x) {
+                auto it = mCells.constFind(cellKey(x, y));
+                if (it != mCells.constEnd())
+                    checkCell(x, y, it.value());
+            }
+        }
+    } else {
+        // When the range covers more cells than are in use, it is faster
+        // to go over the cells in use
+        for (auto it = mCells.cbegin(), it_end = mCells.cend(); it != it_end; ++it) {
+            const int x = int(qint32(it.key() >> 32));
+            const int y = int(qint32(it.key() & 0xffffffff));
+            if (range.contains(x, y))
+                checkCell(x, y, it.value());
+        }
+    }
+
+    std::sort(objects.begin(), objects.end(), [] (const MapObject *a, const MapObject *b) {
+        return a->id() < b->id();
+    });
+
+    return objects;
+}
+
+/**
+ * Returns the bounds of \a object in pixel coordinates, taking into account
+ * its alignment, rotation and polygon.
+ */
+QRectF ObjectSpatialIndex::objectBounds(const MapObject *object)
+{
+    const QPointF position = object->position();
+
+    if (!object->isTileObject()) {
+        switch (object->shape()) {
+        case MapObject::Polygon:
+        case MapObject::Polyline: {
+            QTransform transform;
+            transform.translate(position.x(), position.y());
+            transform.rotate(object->rotation());
+            return transform.map(object->polygon()).boundingRect();
+        }
+        case MapObject::Point:
+            return QRectF(position, QSizeF(0, 0));
+        default:
+            break;
+        }
+    }
+
+    QRectF bounds(position, object->size());
+    bounds.translate(-alignmentOffset(bounds.size(), object->alignment()));
+    return rotatedBounds(bounds.normalized(), object);
+}
+
+void ObjectSpatialIndex::insert(MapObject *object)
+{
+    const QRectF bounds = indexBounds(object);
+    const QRect range = cellRange(bounds);
+    const Entry entry { object, bounds, range };
+
+    if (cellCount(range) > MaximumCellsPerObject) {
+        mLargeObjects.append(entry);
+        mCellRanges.insert(object, QRect());
+        return;
+    }
+
+    for (int y = range.top(); y <= range.bottom(); ++y)
+        for (int x = range.left(); x <= range.right(); ++x)
+            mCells[cellKey(x, y)].append(entry);
+
+    mCellRanges.insert(object, range);
+}
+
+void ObjectSpatialIndex::take(MapObject *object)
+{
+    auto removeFrom = [object] (QVector<Entry> &entries) {
+        auto it = std::find_if(entries.begin(), entries.end(), [object] (const Entry &entry) {
+            return entry.object == object;
+        });
+        if (it != entries.end()) {
+            *it = entries.last();
+            entries.removeLast();
+        }
+    };
+
+    auto rangeIt = mCellRanges.find(object);
+    if (rangeIt == mCellRanges.end())
+        return;
+
+    const QRect range = rangeIt.value();
+    mCellRanges.erase(rangeIt);
+
+    if (range.isNull()) {
+        removeFrom(mLargeObjects);
+        return;
+    }
+
+    for (int y = range.top(); y <= range.bottom(); ++y) {
+        for (int x = range.left(); x <= range.right(); ++x) {
+            auto it = mCells.find(cellKey(x, y));
+            if (it == mCells.end())
+                continue;
+
+            removeFrom(it.value());
+            if (it.value().isEmpty())
+                mCells.erase(it);
+        }
+    }
+}
+
+/**
+ * Moves the changed objects to their new cells.
+ */
+void ObjectSpatialIndex::update()
+{
+    for (MapObject *object : std::as_const(mChangedObjects)) {
+        take(object);
+        insert(object);
+    }
+    mChangedObjects.clear();
+}
+
+QRect ObjectSpatialIndex::cellRange(const QRectF &bounds) const
+{
+    auto cell = [this] (qreal coordinate) {
+        return int(std::floor(qBound(-MaximumCellCoordinate,
+                                     coordinate / mCellSize,
+                                     MaximumCellCoordinate)));
+    };
+
+    return QRect(QPoint(cell(bounds.left()), cell(bounds.top())),
+                 QPoint(cell(bounds.right()), cell(bounds.bottom())));
+}
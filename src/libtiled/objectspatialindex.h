@@ -0,0 +1,96 @@
+/*
+ * objectspatialindex.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QHash>
+#include <QList>
+#include <QRect>
+#include <QRectF>
+#include <QSet>
+#include <QVector>
+
+namespace Tiled {
+
+class MapObject;
+
+/**
+ * A uniform grid used by ObjectGroup to quickly find the objects in a
+ * certain area.
+ *
+ * Objects are stored in each cell overlapped by a conservative bounding
+ * rectangle. Changed objects are only marked, and moved to their new cells
+ * before the next query.
+ */
+class TILEDSHARED_EXPORT ObjectSpatialIndex
+{
+public:
+    explicit ObjectSpatialIndex(const QList<MapObject*> &objects);
+
+    void insert(MapObject *object);
+    void remove(MapObject *object);
+    void invalidate(MapObject *object);
+
+    bool isOutdated() const;
+
+    QList<MapObject*> objectsIntersecting(const QRectF &rect);
+
+    static QRectF objectBounds(const MapObject *object);
+
+private:
+    struct Entry
+    {
+        MapObject *object;
+        QRectF bounds;
+        QRect cells;
+    };
+
+    void take(MapObject *object);
+    void update();
+
+    QRect cellRange(const QRectF &bounds) const;
+
+    qreal mCellSize = 1.0;
+    QHash<quint64, QVector<Entry>> mCells;
+    QVector<Entry> mLargeObjects;
+    QHash<MapObject*, QRect> mCellRanges;  // null for large objects
+    QSet<MapObject*> mChangedObjects;
+};
+
+/**
+ * Returns whether so many objects changed that it is faster to create a new
+ * index than to update this one.
+ */
+inline bool ObjectSpatialIndex::isOutdated() const
+{
+    return mChangedObjects.size() > mCellRanges.size() / 2;
+}
+
+} // namespace Tiled
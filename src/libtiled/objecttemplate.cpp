@@ -33,6 +33,8 @@
 
 #include <QFileInfo>
 
+#include <utility>
+
 namespace Tiled {
 
 ObjectTemplate::ObjectTemplate()
@@ -47,6 +49,10 @@ ObjectTemplate::ObjectTemplate(const QString &fileName)
 
 ObjectTemplate::~ObjectTemplate()
 {
+    // Make sure remaining instances don't refer to a deleted template
+    const auto instances = std::exchange(mInstances, {});
+    for (MapObject *object : instances)
+        object->setObjectTemplate(nullptr);
 }
 
 void ObjectTemplate::setObject(const MapObject *object)
@@ -33,6 +33,7 @@
 #include "tileset.h"
 
 #include <QDateTime>
+#include <QSet>
 
 #include <memory>
 
@@ -60,12 +61,22 @@ public:
 
     const SharedTileset &tileset() const;
 
+    const QSet<MapObject*> &instances() const;
+
 private:
+    friend class MapObject;
+
+    void addInstance(MapObject *object) const;
+    void removeInstance(MapObject *object) const;
+
     QString mFileName;
     QString mFormat;
     std::unique_ptr<MapObject> mObject;
     SharedTileset mTileset;
     QDateTime mLastSaved;
+
+    // Objects that refer to this template, maintained by MapObject
+    mutable QSet<MapObject*> mInstances;
 };
 
 inline const MapObject *ObjectTemplate::object() const
@@ -89,4 +100,17 @@ inline QDateTime ObjectTemplate::lastSaved() const
 inline const SharedTileset &ObjectTemplate::tileset() const
 { return mTileset; }
 
+/**
+ * Returns the objects that are currently instances of this template,
+ * regardless of the map they are part of.
+ */
+inline const QSet<MapObject*> &ObjectTemplate::instances() const
+{ return mInstances; }
+
+inline void ObjectTemplate::addInstance(MapObject *object) const
+{ mInstances.insert(object); }
+
+inline void ObjectTemplate::removeInstance(MapObject *object) const
+{ mInstances.remove(object); }
+
 } // namespace Tiled
@@ -36,6 +36,8 @@
 
 #include <QtCore/qmath.h>
 
+#include <algorithm>
+
 using namespace Tiled;
 
 QRect OrthogonalRenderer::boundingRect(const QRect &rect) const
@@ -156,7 +158,7 @@ QPainterPath OrthogonalRenderer::shape(const MapObject *object) const
     case MapObject::Polygon:
     case MapObject::Polyline: {
         const QPointF &pos = object->position();
-        const QPolygonF polygon = object->polygon().translated(pos);
+        const QPolygonF polygon = object->simplifiedPolygon(polygonTolerance()).translated(pos);
         QPolygonF screenPolygon = pixelToScreenCoords(polygon);
 
         if (object->shape() == MapObject::Polygon && !screenPolygon.isEmpty())
@@ -191,7 +193,7 @@ QPainterPath OrthogonalRenderer::interactionShape(const MapObject *object) const
     switch (object->shape()) {
     case MapObject::Polyline: {
         const QPointF &pos = object->position();
-        const QPolygonF polygon = object->polygon().translated(pos);
+        const QPolygonF polygon = object->simplifiedPolygon(polygonTolerance()).translated(pos);
         QPolygonF screenPolygon = pixelToScreenCoords(polygon);
         for (int i = 1; i < screenPolygon.size(); ++i) {
             path.addPolygon(lineToPolygon(screenPolygon[i - 1],
@@ -238,24 +240,51 @@ void OrthogonalRenderer::drawGrid(QPainter *painter, const QRectF &rect,
     QPen gridPen, majorGridPen;
     setupGridPens(painter->device(), gridColor, gridPen, majorGridPen, qMin(tileWidth, tileHeight), gridMajor);
 
-    if (startY < endY) {
-        gridPen.setDashOffset(startY * tileHeight);
-        majorGridPen.setDashOffset(startY * tileHeight);
+    // The grid fades out when zooming out, at which point its lines are
+    // skipped entirely.
+    const bool drawMinor = gridPen.color().alpha() > 0;
+    const bool drawMajor = majorGridPen.color().alpha() > 0;
+    if (!drawMajor)
+        return;
+
+    // Lines are collected so that they can be drawn in one call per pen
+    QVector<QLine> minorLines;
+    QVector<QLine> majorLines;
+
+    const auto addLine = [&] (bool major, const QLine &line) {
+        if (major)
+            majorLines.append(line);
+        else if (drawMinor)
+            minorLines.append(line);
+    };
+
+    const auto drawLines = [&] (qreal dashOffset) {
+        gridPen.setDashOffset(dashOffset);
+        majorGridPen.setDashOffset(dashOffset);
+
+        painter->setPen(gridPen);
+        painter->drawLines(minorLines);
+        painter->setPen(majorGridPen);
+        painter->drawLines(majorLines);
+
+        minorLines.clear();
+        majorLines.clear();
+    };
 
+    if (startY < endY) {
         for (int x = startX; x < endX; ++x) {
-            painter->setPen(gridMajor.width() != 0 && x % gridMajor.width() == 0 ? majorGridPen : gridPen);
-            painter->drawLine(x * tileWidth, startY * tileHeight, x * tileWidth, endY * tileHeight);
+            addLine(gridMajor.width() != 0 && x % gridMajor.width() == 0,
+                    QLine(x * tileWidth, startY * tileHeight, x * tileWidth, endY * tileHeight));
         }
+        drawLines(startY * tileHeight);
     }
 
     if (startX < endX) {
-        gridPen.setDashOffset(startX * tileWidth);
-        majorGridPen.setDashOffset(startX * tileWidth);
-
         for (int y = startY; y < endY; ++y) {
-            painter->setPen(gridMajor.height() != 0 && y % gridMajor.height() == 0 ? majorGridPen : gridPen);
-            painter->drawLine(startX * tileWidth, y * tileHeight, endX * tileWidth, y * tileHeight);
+            addLine(gridMajor.height() != 0 && y % gridMajor.height() == 0,
+                    QLine(startX * tileWidth, y * tileHeight, endX * tileWidth, y * tileHeight));
         }
+        drawLines(startX * tileWidth);
     }
 }
 
@@ -305,29 +334,18 @@ void OrthogonalRenderer::drawTileLayer(const RenderTileCallback &renderTile,
             renderTile(QPoint(x, y), QPointF(x * tileWidth, (y + 1) * tileHeight));
 }
 
-void OrthogonalRenderer::drawTileSelection(QPainter *painter,
-                                           const QRegion &region,
-                                           const QColor &color,
-                                           const QRectF &exposed) const
+QPainterPath OrthogonalRenderer::tileSelectionPath(const QRegion &region,
+                                                   const QRectF &exposed) const
 {
     QPainterPath path;
 
     for (const QRect &r : region) {
         const QRectF toFill = QRectF(boundingRect(r));
-        if (toFill.intersects(exposed))
+        if (exposed.isNull() || toFill.intersects(exposed))
             path.addRect(toFill);
     }
 
-    QColor penColor(color);
-    penColor.setAlpha(255);
-
-    QPen pen(penColor);
-    pen.setCosmetic(true);
-
-    painter->setPen(pen);
-    painter->setBrush(color);
-    painter->setRenderHint(QPainter::Antialiasing, false);
-    painter->drawPath(path.simplified());
+    return path.simplified();
 }
 
 void OrthogonalRenderer::drawMapObject(QPainter *painter,
@@ -416,7 +434,7 @@ void OrthogonalRenderer::drawMapObject(QPainter *painter,
 
         case MapObject::Polygon:
         case MapObject::Polyline: {
-            const QPolygonF screenPolygon = pixelToScreenCoords(object->polygon());
+            const QPolygonF screenPolygon = pixelToScreenCoords(object->simplifiedPolygon(polygonTolerance()));
             const QPointF pointPos = screenPolygon.isEmpty() ? QPointF()
                                                              : screenPolygon.first();
 
@@ -459,10 +477,7 @@ void OrthogonalRenderer::drawMapObject(QPainter *painter,
         }
 
         case MapObject::Text: {
-            const auto& textData = object->textData();
-            painter->setFont(textData.font);
-            painter->setPen(textData.color);
-            painter->drawText(bounds, textData.text, textData.textOption());
+            drawTextObject(painter, bounds, object->textData());
             break;
         }
         case MapObject::Point: {
@@ -508,3 +523,40 @@ QPointF OrthogonalRenderer::pixelToScreenCoords(qreal x, qreal y) const
 {
     return QPointF(x, y);
 }
+
+void OrthogonalRenderer::pixelToTileCoords(const QPointF *points, QPointF *result, int count) const
+{
+    OrthogonalRenderer::screenToTileCoords(points, result, count);
+}
+
+void OrthogonalRenderer::screenToTileCoords(const QPointF *points, QPointF *result, int count) const
+{
+    const qreal tileWidth = map()->tileWidth();
+    const qreal tileHeight = map()->tileHeight();
+
+    for (int i = 0; i < count; ++i)
+        result[i] = QPointF(points[i].x() / tileWidth,
+                            points[i].y() / tileHeight);
+}
+
+void OrthogonalRenderer::tileToScreenCoords(const QPointF *points, QPointF *result, int count) const
+{
+    const qreal tileWidth = map()->tileWidth();
+    const qreal tileHeight = map()->tileHeight();
+
+    for (int i = 0; i < count; ++i)
+        result[i] = QPointF(points[i].x() * tileWidth,
+                            points[i].y() * tileHeight);
+}
+
+void OrthogonalRenderer::screenToPixelCoords(const QPointF *points, QPointF *result, int count) const
+{
+    if (points != result)
+        std::copy(points, points + count, result);
+}
+
+void OrthogonalRenderer::pixelToScreenCoords(const QPointF *points, QPointF *result, int count) const
+{
+    if (points != result)
+        std::copy(points, points + count, result);
+}
@@ -28,13 +28,17 @@
 
 #include "pluginmanager.h"
 
+#include "lazyformat.h"
 #include "mapformat.h"
 #include "plugin.h"
+#include "tracer.h"
 
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QPluginLoader>
 
 namespace Tiled {
@@ -47,9 +51,18 @@ QString PluginFile::fileName() const
     return QStringLiteral("<static>");
 }
 
+/**
+ * Returns whether the plugin is loaded or its formats are available through
+ * deferred loading.
+ */
+bool PluginFile::isActive() const
+{
+    return instance || !deferredFormats.isEmpty();
+}
+
 bool PluginFile::hasError() const
 {
-    if (instance)
+    if (isActive())
         return false;
 
     return state == PluginEnabled || (defaultEnable && state == PluginDefault);
@@ -93,7 +106,7 @@ bool PluginManager::setPluginState(const QString &fileName, PluginState state)
 
     plugin->state = state;
 
-    bool loaded = plugin->instance != nullptr;
+    bool loaded = plugin->isActive();
     bool enable = state == PluginEnabled || (plugin->defaultEnable && state != PluginDisabled);
     bool success = false;
 
@@ -110,6 +123,8 @@ bool PluginManager::setPluginState(const QString &fileName, PluginState state)
 
 bool PluginManager::loadPlugin(PluginFile *plugin)
 {
+    TraceScope trace("Load plugin", plugin->fileName());
+
     plugin->instance = plugin->loader->instance();
 
     if (plugin->instance) {
@@ -127,7 +142,14 @@ bool PluginManager::loadPlugin(PluginFile *plugin)
 
 bool PluginManager::unloadPlugin(PluginFile *plugin)
 {
-    if (plugin->instance && !qobject_cast<Plugin*>(plugin->instance))
+    if (!plugin->instance) {
+        for (FileFormat *format : std::as_const(plugin->deferredFormats))
+            removeObject(format);
+        plugin->deferredFormats.clear();
+        return true;
+    }
+
+    if (!qobject_cast<Plugin*>(plugin->instance))
         removeObject(plugin->instance);
 
     plugin->instance = nullptr;
@@ -135,6 +157,78 @@ bool PluginManager::unloadPlugin(PluginFile *plugin)
     return plugin->loader->unload();
 }
 
+/**
+ * Registers stand-in formats for the given \a plugin based on the \a formats
+ * listed in its metadata, instead of loading the plugin.
+ *
+ * Only write-only map and tileset formats can be deferred this way, since
+ * reading formats need to be able to check whether they support a file.
+ *
+ * Returns whether the plugin was deferred.
+ */
+bool PluginManager::deferPlugin(PluginFile *plugin, const QJsonArray &formats)
+{
+    if (formats.isEmpty())
+        return false;
+
+    const QString fileName = QFileInfo(plugin->loader->fileName()).fileName();
+    QList<FileFormat*> deferredFormats;
+
+    for (const QJsonValue &value : formats) {
+        const QJsonObject object = value.toObject();
+        const LazyFormatInfo info(fileName, object);
+        const QString type = object.value(QLatin1String("type")).toString();
+
+        if (!info.isValid()) {
+            qDeleteAll(deferredFormats);
+            return false;
+        }
+
+        if (type == QLatin1String("map")) {
+            deferredFormats.append(new LazyMapFormat(info, this));
+        } else if (type == QLatin1String("tileset")) {
+            deferredFormats.append(new LazyTilesetFormat(info, this));
+        } else {
+            qDeleteAll(deferredFormats);
+            return false;
+        }
+    }
+
+    plugin->deferredFormats = deferredFormats;
+
+    for (FileFormat *format : std::as_const(deferredFormats))
+        addObject(format);
+
+    return true;
+}
+
+/**
+ * Loads the plugin with the given \a fileName when its loading was deferred,
+ * replacing its stand-in formats with the real ones.
+ *
+ * The stand-in formats are kept alive until the plugin manager is deleted,
+ * since they may still be referenced. They forward to the loaded formats.
+ *
+ * Returns whether the plugin is loaded.
+ */
+bool PluginManager::loadDeferredPlugin(const QString &fileName)
+{
+    PluginFile *plugin = pluginByFileName(fileName);
+    if (!plugin)
+        return false;
+    if (plugin->instance)
+        return true;
+    if (plugin->deferredFormats.isEmpty())
+        return false;
+
+    for (FileFormat *format : std::as_const(plugin->deferredFormats))
+        removeObject(format);
+
+    plugin->deferredFormats.clear();
+
+    return loadPlugin(plugin);
+}
+
 PluginManager *PluginManager::instance()
 {
     if (!mInstance)
@@ -173,6 +267,8 @@ void PluginManager::removeObject(QObject *object)
 
 void PluginManager::loadPlugins()
 {
+    TraceScope trace("Load plugins");
+
     // Load static plugins
     const QObjectList &staticPluginInstances = QPluginLoader::staticInstances();
     for (QObject *instance : staticPluginInstances) {
@@ -217,24 +313,16 @@ void PluginManager::loadPlugins()
 
         bool enable = state == PluginEnabled || (defaultEnable && state != PluginDisabled);
 
-        QObject *instance = nullptr;
-
-        if (enable) {
-            instance = loader->instance();
-
-            if (!instance)
-                qWarning().noquote() << "Error:" << loader->errorString();
-        }
-
-        mPlugins.append(PluginFile(state, instance, loader, defaultEnable));
+        mPlugins.append(PluginFile(state, nullptr, loader, defaultEnable));
 
-        if (!instance)
+        if (!enable)
             continue;
 
-        if (Plugin *plugin = qobject_cast<Plugin*>(instance))
-            plugin->initialize();
-        else
-            addObject(instance);
+        // Write-only plugins that list their formats are loaded on first use
+        PluginFile &plugin = mPlugins.last();
+        const auto formats = metaData.value(QStringLiteral("formats")).toArray();
+        if (!deferPlugin(&plugin, formats))
+            loadPlugin(&plugin);
     }
 }
 
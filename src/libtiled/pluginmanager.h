@@ -37,10 +37,13 @@
 
 #include <functional>
 
+class QJsonArray;
 class QPluginLoader;
 
 namespace Tiled {
 
+class FileFormat;
+
 enum PluginState
 {
     PluginDefault,
@@ -62,6 +65,7 @@ struct TILEDSHARED_EXPORT PluginFile
     {}
 
     QString fileName() const;
+    bool isActive() const;
     bool hasError() const;
     QString errorString() const;
 
@@ -69,6 +73,12 @@ struct TILEDSHARED_EXPORT PluginFile
     QObject *instance;
     QPluginLoader *loader;
     bool defaultEnable;
+
+    /**
+     * Formats standing in for the formats of this plugin, based on its
+     * metadata, while loading the plugin is deferred until first use.
+     */
+    QList<FileFormat*> deferredFormats;
 };
 
 
@@ -151,6 +161,8 @@ public:
 
     PluginFile *pluginByFileName(const QString &fileName);
 
+    bool loadDeferredPlugin(const QString &fileName);
+
     const QMap<QString, PluginState> &pluginStates() const;
     bool setPluginState(const QString &fileName, PluginState state);
 
@@ -166,6 +178,7 @@ private:
 
     bool loadPlugin(PluginFile *plugin);
     bool unloadPlugin(PluginFile *plugin);
+    bool deferPlugin(PluginFile *plugin, const QJsonArray &formats);
 
     static PluginManager *mInstance;
 
@@ -118,6 +118,46 @@ bool setPropertyMemberValue(Properties &properties,
     return true;
 }
 
+/**
+ * Returns a string equal to \a string, sharing its data with previously
+ * interned equal strings.
+ */
+QString StringPool::intern(const QString &string)
+{
+    const auto it = mStrings.constFind(string);
+    if (it != mStrings.constEnd())
+        return *it;
+
+    mStrings.insert(string);
+    return string;
+}
+
+/**
+ * Interns the given \a value when it is a string, or the member names and
+ * values when it is a class value.
+ */
+QVariant StringPool::intern(const QVariant &value)
+{
+    if (value.userType() == QMetaType::QString)
+        return intern(value.toString());
+
+    if (value.userType() == propertyValueId()) {
+        PropertyValue propertyValue = value.value<PropertyValue>();
+        if (propertyValue.value.userType() != QMetaType::QVariantMap)
+            return value;
+
+        const QVariantMap members = propertyValue.value.toMap();
+        QVariantMap internedMembers;
+        for (auto it = members.cbegin(), end = members.cend(); it != end; ++it)
+            internedMembers.insert(internedMembers.cend(), intern(it.key()), intern(it.value()));
+
+        propertyValue.value = internedMembers;
+        return QVariant::fromValue(propertyValue);
+    }
+
+    return value;
+}
+
 void mergeProperties(Properties &target, const Properties &source)
 {
     if (target.isEmpty()) {
@@ -138,6 +178,59 @@ void mergeProperties(Properties &target, const Properties &source)
 #endif
 }
 
+static qint64 stringMemoryUsage(const QString &string)
+{
+    return string.capacity() * qint64(sizeof(QChar));
+}
+
+static qint64 propertyMemoryUsage(const QVariant &value)
+{
+    qint64 usage = sizeof(QVariant);
+
+    switch (value.userType()) {
+    case QMetaType::QString:
+        usage += stringMemoryUsage(value.toString());
+        break;
+    case QMetaType::QVariantList: {
+        const QVariantList list = value.toList();
+        for (const QVariant &item : list)
+            usage += propertyMemoryUsage(item);
+        break;
+    }
+    case QMetaType::QVariantMap:
+        usage += propertiesMemoryUsage(value.toMap());
+        break;
+    default:
+        if (value.userType() == propertyValueId())
+            usage += propertyMemoryUsage(value.value<PropertyValue>().value);
+        else if (value.userType() == filePathTypeId())
+            usage += stringMemoryUsage(value.value<FilePath>().url.toString());
+        break;
+    }
+
+    return usage;
+}
+
+/**
+ * Returns the approximate amount of memory used by the given \a properties,
+ * in bytes. Strings shared between values are counted for each use.
+ */
+qint64 propertiesMemoryUsage(const Properties &properties)
+{
+    // Estimated overhead of each map node (pointers and color)
+    constexpr qint64 nodeOverhead = 4 * sizeof(void*);
+
+    qint64 usage = 0;
+
+    for (auto it = properties.begin(), it_end = properties.end(); it != it_end; ++it) {
+        usage += nodeOverhead;
+        usage += stringMemoryUsage(it.key());
+        usage += propertyMemoryUsage(it.value());
+    }
+
+    return usage;
+}
+
 QJsonArray propertiesToJson(const Properties &properties, const ExportContext &context)
 {
     QJsonArray json;
@@ -32,6 +32,7 @@
 
 #include <QJsonArray>
 #include <QObject>
+#include <QSet>
 #include <QUrl>
 #include <QVariantMap>
 
@@ -170,6 +171,23 @@ using Properties = QVariantMap;
  */
 using AggregatedProperties = QMap<QString, AggregatedPropertyData>;
 
+/**
+ * Makes equal strings share their data. Used while reading files, to avoid
+ * keeping a separate copy of the same property names and string values for
+ * each object.
+ */
+class TILEDSHARED_EXPORT StringPool
+{
+public:
+    QString intern(const QString &string);
+    QVariant intern(const QVariant &value);
+
+    void clear() { mStrings.clear(); }
+
+private:
+    QSet<QString> mStrings;
+};
+
 TILEDSHARED_EXPORT bool setClassPropertyMemberValue(QVariant &classValue,
                                                     int depth,
                                                     const QStringList &path,
@@ -181,6 +199,7 @@ TILEDSHARED_EXPORT bool setPropertyMemberValue(Properties &properties,
 
 TILEDSHARED_EXPORT void aggregateProperties(AggregatedProperties &aggregated, const Properties &properties);
 TILEDSHARED_EXPORT void mergeProperties(Properties &target, const Properties &source);
+TILEDSHARED_EXPORT qint64 propertiesMemoryUsage(const Properties &properties);
 
 TILEDSHARED_EXPORT QJsonArray propertiesToJson(const Properties &properties, const ExportContext &context = ExportContext());
 TILEDSHARED_EXPORT Properties propertiesFromJson(const QJsonArray &json, const ExportContext &context = ExportContext());
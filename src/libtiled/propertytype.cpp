@@ -434,6 +434,21 @@ PropertyTypes::~PropertyTypes()
     qDeleteAll(mTypes);
 }
 
+PropertyType &PropertyTypes::add(std::unique_ptr<PropertyType> type)
+{
+    if (type->id == 0)
+        type->id = ++mNextId;
+    else
+        mNextId = std::max(mNextId, type->id);
+
+    mTypes.append(type.release());
+
+    if (!mIndexDirty)
+        indexType(mTypes.last());
+
+    return *mTypes.last();
+}
+
 size_t PropertyTypes::count(PropertyType::Type type) const
 {
     return std::count_if(mTypes.begin(), mTypes.end(), [&] (const PropertyType *propertyType) {
@@ -458,19 +473,16 @@ void PropertyTypes::merge(PropertyTypes typesToMerge)
     while (typesToMerge.count() > 0) {
         auto typeToImport = typesToMerge.takeAt(0);
         auto typeToImportUsageFlags = typeUsageFlags(*typeToImport);
-        auto existingIt = std::find_if(mTypes.begin(), mTypes.end(), [&] (const PropertyType *type) {
-            // Consider same type only when name matches and usage flags overlap
-            return type->name == typeToImport->name &&
-                    (typeUsageFlags(*type) & typeToImportUsageFlags) != 0;
-        });
+
+        // Consider same type only when name matches and usage flags overlap
+        auto existing = findTypeByNamePriv(typeToImport->name, typeToImportUsageFlags);
 
         if (typeToImport->isClass())
             classesToProcess.append(static_cast<ClassPropertyType*>(typeToImport.get()));
 
-        if (existingIt != mTypes.end()) {
+        if (existing) {
             // Existing types are replaced, but their ID is retained
-            typeToImport->id = (*existingIt)->id;
-            delete std::exchange(*existingIt, typeToImport.release());
+            replaceType(existing, std::move(typeToImport));
         } else {
             // New types are added, but their ID is reset
             typeToImport->id = 0;
@@ -508,16 +520,12 @@ void PropertyTypes::mergeObjectTypes(const QVector<ObjectType> &objectTypes)
         propertyType->members = type.defaultProperties;
         propertyType->usageFlags = ClassPropertyType::MapObjectClass | ClassPropertyType::TileClass;
 
-        auto existingIt = std::find_if(mTypes.begin(), mTypes.end(), [&] (const PropertyType *type) {
-            // Consider same type only when name matches and usage flags overlap
-            return type->name == propertyType->name &&
-                    (typeUsageFlags(*type) & propertyType->usageFlags) != 0;
-        });
+        // Consider same type only when name matches and usage flags overlap
+        auto existing = findTypeByNamePriv(propertyType->name, propertyType->usageFlags);
 
-        if (existingIt != mTypes.end()) {
+        if (existing) {
             // Replace existing classes, but retain their ID
-            propertyType->id = (*existingIt)->id;
-            delete std::exchange(*existingIt, propertyType.release());
+            replaceType(existing, std::move(propertyType));
         } else {
             add(std::move(propertyType));
         }
@@ -530,10 +538,8 @@ void PropertyTypes::mergeObjectTypes(const QVector<ObjectType> &objectTypes)
  */
 const PropertyType *PropertyTypes::findTypeById(int typeId) const
 {
-    auto it = std::find_if(mTypes.begin(), mTypes.end(), [&] (const PropertyType *type) {
-        return type->id == typeId;
-    });
-    return it == mTypes.end() ? nullptr : *it;
+    updateIndex();
+    return mTypesById.value(typeId);
 }
 
 /**
@@ -545,10 +551,17 @@ const PropertyType *PropertyTypes::findTypeByName(const QString &name, int usage
     if (name.isEmpty())
         return nullptr;
 
-    auto it = std::find_if(mTypes.begin(), mTypes.end(), [&] (const PropertyType *type) {
-        return type->name == name && (typeUsageFlags(*type) & usageFlags) != 0;
-    });
-    return it == mTypes.end() ? nullptr : *it;
+    updateIndex();
+
+    const auto it = mTypesByName.constFind(name);
+    if (it == mTypesByName.constEnd())
+        return nullptr;
+
+    for (const PropertyType *type : *it)
+        if (typeUsageFlags(*type) & usageFlags)
+            return type;
+
+    return nullptr;
 }
 
 const PropertyType *PropertyTypes::findPropertyValueType(const QString &name) const
@@ -561,10 +574,17 @@ const ClassPropertyType *PropertyTypes::findClassFor(const QString &name, const
     if (name.isEmpty())
         return nullptr;
 
-    auto it = std::find_if(mTypes.begin(), mTypes.end(), [&] (const PropertyType *type) {
-        return type->name == name && type->isClass() && static_cast<const ClassPropertyType*>(type)->isClassFor(object);
-    });
-    return static_cast<const ClassPropertyType*>(it == mTypes.end() ? nullptr : *it);
+    updateIndex();
+
+    const auto it = mTypesByName.constFind(name);
+    if (it == mTypesByName.constEnd())
+        return nullptr;
+
+    for (const PropertyType *type : *it)
+        if (type->isClass() && static_cast<const ClassPropertyType*>(type)->isClassFor(object))
+            return static_cast<const ClassPropertyType*>(type);
+
+    return nullptr;
 }
 
 PropertyType *PropertyTypes::findTypeByNamePriv(const QString &name, int usageFlags)
@@ -577,6 +597,56 @@ PropertyType *PropertyTypes::findPropertyValueTypePriv(const QString &name)
     return findTypeByNamePriv(name, ClassPropertyType::PropertyValueType);
 }
 
+/**
+ * Replaces the \a existing type with the given \a type, which takes over
+ * its ID and position.
+ */
+void PropertyTypes::replaceType(PropertyType *existing, std::unique_ptr<PropertyType> type)
+{
+    Q_ASSERT(existing->name == type->name);
+
+    type->id = existing->id;
+
+    if (!mIndexDirty) {
+        Types &sameName = mTypesByName[existing->name];
+        std::replace(sameName.begin(), sameName.end(), existing, type.get());
+
+        auto it = mTypesById.find(existing->id);
+        if (it != mTypesById.end() && *it == existing)
+            *it = type.get();
+    }
+
+    const int index = mTypes.indexOf(existing);
+    mTypes[index] = type.release();
+    delete existing;
+}
+
+void PropertyTypes::indexType(PropertyType *type) const
+{
+    mTypesByName[type->name].append(type);
+
+    // When IDs are not unique, the first type with the ID is found
+    if (!mTypesById.contains(type->id))
+        mTypesById.insert(type->id, type);
+}
+
+/**
+ * Rebuilds the lookup indices when they have been invalidated.
+ */
+void PropertyTypes::updateIndex() const
+{
+    if (!mIndexDirty)
+        return;
+
+    mTypesByName.clear();
+    mTypesById.clear();
+
+    for (PropertyType *type : mTypes)
+        indexType(type);
+
+    mIndexDirty = false;
+}
+
 void PropertyTypes::loadFromJson(const QJsonArray &list, const QString &path)
 {
     clear();
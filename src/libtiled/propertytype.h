@@ -29,6 +29,7 @@
 #pragma once
 
 #include <QColor>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QMetaType>
@@ -195,6 +196,7 @@ public:
     void removeAt(int index);
     std::unique_ptr<PropertyType> takeAt(int index);
     PropertyType &typeAt(int index);
+    void setTypeName(int index, const QString &name);
     void moveType(int from, int to);
     void merge(PropertyTypes types);
     void mergeObjectTypes(const QVector<ObjectType> &objectTypes);
@@ -208,8 +210,8 @@ public:
     QJsonArray toJson(const QString &path = QString()) const;
 
     // Enable easy iteration over types with range-based for
-    Types::iterator begin() { return mTypes.begin(); }
-    Types::iterator end() { return mTypes.end(); }
+    Types::iterator begin() { mIndexDirty = true; return mTypes.begin(); }
+    Types::iterator end() { mIndexDirty = true; return mTypes.end(); }
     Types::const_iterator begin() const { return mTypes.begin(); }
     Types::const_iterator end() const { return mTypes.end(); }
 
@@ -219,24 +221,26 @@ private:
     PropertyType *findTypeByNamePriv(const QString &name, int usageFlags = ClassPropertyType::AnyUsage);
     PropertyType *findPropertyValueTypePriv(const QString &name);
 
+    void replaceType(PropertyType *existing, std::unique_ptr<PropertyType> type);
+    void indexType(PropertyType *type) const;
+    void updateIndex() const;
+
     Types mTypes;
     int mNextId = 0;
-};
 
-inline PropertyType &PropertyTypes::add(std::unique_ptr<PropertyType> type)
-{
-    if (type->id == 0)
-        type->id = ++mNextId;
-    else
-        mNextId = std::max(mNextId, type->id);
-
-    mTypes.append(type.release());
-    return *mTypes.last();
-}
+    // Lookup indices, rebuilt on demand when mIndexDirty is set. Type names
+    // need to be changed through setTypeName to keep these up to date.
+    mutable QHash<QString, Types> mTypesByName;
+    mutable QHash<int, PropertyType*> mTypesById;
+    mutable bool mIndexDirty = false;
+};
 
 inline void PropertyTypes::clear()
 {
     mTypes.clear();
+    mTypesByName.clear();
+    mTypesById.clear();
+    mIndexDirty = false;
 }
 
 inline size_t PropertyTypes::count() const
@@ -247,10 +251,12 @@ inline size_t PropertyTypes::count() const
 inline void PropertyTypes::removeAt(int index)
 {
     delete mTypes.takeAt(index);
+    mIndexDirty = true;
 }
 
 inline std::unique_ptr<PropertyType> PropertyTypes::takeAt(int index)
 {
+    mIndexDirty = true;
     return std::unique_ptr<PropertyType> { mTypes.takeAt(index) };
 }
 
@@ -259,9 +265,16 @@ inline PropertyType &PropertyTypes::typeAt(int index)
     return *mTypes.at(index);
 }
 
+inline void PropertyTypes::setTypeName(int index, const QString &name)
+{
+    mTypes.at(index)->name = name;
+    mIndexDirty = true;
+}
+
 inline void PropertyTypes::moveType(int from, int to)
 {
     mTypes.move(from, to);
+    mIndexDirty = true;
 }
 
 using SharedPropertyTypes = QSharedPointer<PropertyTypes>;
@@ -28,29 +28,94 @@
 
 #include "savefile.h"
 
+#include <QCoreApplication>
 #include <QFile>
 #include <QSaveFile>
+#include <QTemporaryFile>
 
 namespace Tiled {
 
 bool SaveFile::mSafeSavingEnabled = true;
+bool SaveFile::mSkipUnchangedFiles = false;
 
 SaveFile::SaveFile(const QString &name)
+    : mFileName(name)
 {
-    if (mSafeSavingEnabled)
-        mFileDevice = std::make_unique<QSaveFile>(name);
-    else
-        mFileDevice = std::make_unique<QFile>(name);
+    if (mSkipUnchangedFiles && QFile::exists(name)) {
+        // Placed next to the target, since this is likely writable
+        mFileDevice = std::make_unique<QTemporaryFile>(name);
+        mCompareBeforeWriting = true;
+    } else {
+        mFileDevice = createFileDevice(name);
+    }
 }
 
 bool SaveFile::commit()
 {
+    if (mCompareBeforeWriting)
+        return commitIfChanged();
+
     if (auto saveFile = qobject_cast<QSaveFile*>(mFileDevice.get()))
         return saveFile->commit();
 
     return mFileDevice->error() == QFileDevice::NoError;
 }
 
+std::unique_ptr<QFileDevice> SaveFile::createFileDevice(const QString &name)
+{
+    if (mSafeSavingEnabled)
+        return std::make_unique<QSaveFile>(name);
+    return std::make_unique<QFile>(name);
+}
+
+/**
+ * Compares the temporary file to the existing file, and only replaces the
+ * existing file when they differ.
+ */
+bool SaveFile::commitIfChanged()
+{
+    auto &temporaryFile = static_cast<QTemporaryFile&>(*mFileDevice);
+    if (temporaryFile.error() != QFileDevice::NoError || !temporaryFile.flush())
+        return false;
+
+    // Compare the raw bytes, without line ending conversion
+    temporaryFile.setTextModeEnabled(false);
+    if (!temporaryFile.seek(0))
+        return false;
+
+    constexpr qint64 chunkSize = 64 * 1024;
+
+    QFile existingFile(mFileName);
+    if (existingFile.size() == temporaryFile.size() && existingFile.open(QIODevice::ReadOnly)) {
+        bool equal = true;
+        while (equal && !temporaryFile.atEnd())
+            equal = temporaryFile.read(chunkSize) == existingFile.read(chunkSize);
+
+        if (equal)
+            return true;
+
+        existingFile.close();
+        temporaryFile.seek(0);
+    }
+
+    // Write the new contents to the actual file. The temporary file will be
+    // removed when it goes out of scope.
+    std::unique_ptr<QFileDevice> temporaryDevice = std::move(mFileDevice);
+    mFileDevice = createFileDevice(mFileName);
+    mCompareBeforeWriting = false;
+
+    if (!mFileDevice->open(QIODevice::WriteOnly))
+        return false;
+
+    while (!temporaryFile.atEnd()) {
+        const QByteArray data = temporaryFile.read(chunkSize);
+        if (data.isEmpty() || mFileDevice->write(data) != data.size())
+            return false;
+    }
+
+    return commit();
+}
+
 bool SaveFile::safeSavingEnabled()
 {
     return mSafeSavingEnabled;
@@ -61,4 +126,60 @@ void SaveFile::setSafeSavingEnabled(bool enabled)
     mSafeSavingEnabled = enabled;
 }
 
+bool SaveFile::skipUnchangedFiles()
+{
+    return mSkipUnchangedFiles;
+}
+
+/**
+ * Sets whether existing files should be left untouched when their contents
+ * would not change. This preserves their modification time, at the cost of
+ * writing to a temporary file first.
+ */
+void SaveFile::setSkipUnchangedFiles(bool enabled)
+{
+    mSkipUnchangedFiles = enabled;
+}
+
+/**
+ * Writes \a contents to \a fileName, unless the file already has exactly
+ * these contents. Unlike setSkipUnchangedFiles(), this applies regardless
+ * of the global setting. It is meant for exporters that have their output
+ * in memory and whose target applications reimport any touched file.
+ *
+ * The \a mode may include QIODevice::Text, which is taken into account when
+ * comparing with the existing file.
+ *
+ * Returns false and sets \a errorString when the file could not be written.
+ */
+bool SaveFile::writeIfChanged(const QString &fileName,
+                              const QByteArray &contents,
+                              QIODevice::OpenMode mode,
+                              QString *errorString)
+{
+    {
+        QFile existingFile(fileName);
+        if (existingFile.open(QIODevice::ReadOnly | (mode & QIODevice::Text)) &&
+                existingFile.readAll() == contents)
+            return true;
+    }
+
+    SaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | mode)) {
+        if (errorString)
+            *errorString = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+        return false;
+    }
+
+    file.device()->write(contents);
+
+    if (file.error() != QFileDevice::NoError || !file.commit()) {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
 } // namespace Tiled
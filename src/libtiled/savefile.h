@@ -40,6 +40,10 @@ namespace Tiled {
 /**
  * A wrapper around QSaveFile and QFile. Allows safe writing of files to be
  * turned off globally.
+ *
+ * Can also be set up to leave existing files untouched when their contents
+ * would not change. In this case the output is first written to a temporary
+ * file, which is compared to the existing file on commit().
  */
 class TILEDSHARED_EXPORT SaveFile
 {
@@ -57,10 +61,24 @@ public:
     static bool safeSavingEnabled();
     static void setSafeSavingEnabled(bool enabled);
 
+    static bool skipUnchangedFiles();
+    static void setSkipUnchangedFiles(bool enabled);
+
+    static bool writeIfChanged(const QString &fileName,
+                               const QByteArray &contents,
+                               QIODevice::OpenMode mode,
+                               QString *errorString = nullptr);
+
 private:
+    static std::unique_ptr<QFileDevice> createFileDevice(const QString &name);
+    bool commitIfChanged();
+
+    QString mFileName;
     std::unique_ptr<QFileDevice> mFileDevice;
+    bool mCompareBeforeWriting = false;
 
     static bool mSafeSavingEnabled;
+    static bool mSkipUnchangedFiles;
 };
 
 
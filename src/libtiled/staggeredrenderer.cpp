@@ -39,9 +39,28 @@ using namespace Tiled;
  * does not produce nice results for isometric shapes in the tile corners.
  */
 QPointF StaggeredRenderer::screenToTileCoords(qreal x, qreal y) const
+{
+    QTransform rotation;
+    rotation.rotate(-45);
+
+    return staggeredScreenToTile(RenderParams(map()), rotation, x, y);
+}
+
+void StaggeredRenderer::screenToTileCoords(const QPointF *points, QPointF *result, int count) const
 {
     const RenderParams p(map());
 
+    QTransform rotation;
+    rotation.rotate(-45);
+
+    for (int i = 0; i < count; ++i)
+        result[i] = staggeredScreenToTile(p, rotation, points[i].x(), points[i].y());
+}
+
+QPointF StaggeredRenderer::staggeredScreenToTile(const RenderParams &p,
+                                                 const QTransform &rotation,
+                                                 qreal x, qreal y) const
+{
     qreal alignedX = x, alignedY = y;
     if (p.staggerX)
         alignedX -= p.staggerEven ? p.sideOffsetX : 0;
@@ -74,14 +93,12 @@ QPointF StaggeredRenderer::screenToTileCoords(qreal x, qreal y) const
     if (p.sideOffsetY * 3 - y_pos < rel.y())
         referencePoint = bottomRight(referencePoint.x(), referencePoint.y());
 
-    QPointF newRel = tileToScreenCoords(referencePoint.x(), referencePoint.y());
+    QPointF newRel = tileToScreen(p, referencePoint.x(), referencePoint.y());
     newRel = QPointF(x - newRel.x(), y - newRel.y());
     QPointF tileLocal = newRel - QPointF(p.tileWidth / 2, 0);
 
     tileLocal.ry() *= (qreal) p.tileWidth / p.tileHeight;
-    QTransform t;
-    t.rotate(-45);
-    tileLocal = t.map(tileLocal);
+    tileLocal = rotation.map(tileLocal);
     tileLocal /= p.tileWidth/sqrt(2);
 
     return tileLocal + referencePoint;
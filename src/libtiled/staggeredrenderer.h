@@ -30,6 +30,8 @@
 
 #include "hexagonalrenderer.h"
 
+#include <QTransform>
+
 namespace Tiled {
 
 /**
@@ -83,6 +85,12 @@ public:
 
     using HexagonalRenderer::screenToTileCoords;
     QPointF screenToTileCoords(qreal x, qreal y) const override;
+    void screenToTileCoords(const QPointF *points, QPointF *result, int count) const override;
+
+private:
+    QPointF staggeredScreenToTile(const RenderParams &p,
+                                  const QTransform &rotation,
+                                  qreal x, qreal y) const;
 };
 
 } // namespace Tiled
@@ -28,10 +28,14 @@
 
 #include "tile.h"
 
+#include "imagecache.h"
+#include "map.h"
+#include "maprenderer.h"
 #include "objectgroup.h"
 #include "tileset.h"
 
 #include <QBitmap>
+#include <QPixmapCache>
 
 using namespace Tiled;
 
@@ -71,12 +75,45 @@ QSharedPointer<Tileset> Tile::sharedTileset() const
 /**
  * Returns the image of this tile, or the image of its tileset if it doesn't
  * have an individual one.
+ *
+ * When the image was set using setPendingImage(), it is loaded by the first
+ * call to this function.
  */
 const QPixmap &Tile::image() const
 {
+    if (mImageStatus == LoadingPending)
+        loadPendingImage();
+
     return mImage.isNull() ? mTileset->image() : mImage;
 }
 
+/**
+ * Returns the part of image() used by this tile, as a separate pixmap.
+ *
+ * Tiles from a tileset image refer to part of the shared tileset image,
+ * which is what should be drawn when possible. The cropped images are
+ * cached, so that views showing tiles as icons don't create a new pixmap
+ * each time they are painted.
+ */
+QPixmap Tile::croppedImage() const
+{
+    const QPixmap &image = this->image();
+    if (image.isNull() || mImageRect == image.rect())
+        return image;
+
+    const QString key = QStringLiteral("tile:%1:%2,%3,%4x%5")
+            .arg(image.cacheKey())
+            .arg(mImageRect.x()).arg(mImageRect.y())
+            .arg(mImageRect.width()).arg(mImageRect.height());
+
+    QPixmap cropped;
+    if (!QPixmapCache::find(key, &cropped)) {
+        cropped = image.copy(mImageRect);
+        QPixmapCache::insert(key, cropped);
+    }
+    return cropped;
+}
+
 // Using some internal Qt API here, but this is the function that is also used
 // by QGraphicsPixmapItem, so my assumption is that it is better suited for
 // this task than using QPainterPath::addRegion.
@@ -116,6 +153,10 @@ const QPainterPath &Tile::imageShape() const
  */
 void Tile::setImage(const QPixmap &image)
 {
+    // The image rect is adjusted based on the previous image
+    if (mImageStatus == LoadingPending)
+        loadPendingImage();
+
     // Initialize or auto-adjust the image rect
     if (mImageRect.isNull() || mImageRect == mImage.rect())
         mImageRect = image.rect();
@@ -125,6 +166,32 @@ void Tile::setImage(const QPixmap &image)
     mImageShape.reset();
 }
 
+/**
+ * Sets the \a imageSource of this tile, without loading the image. The image
+ * is loaded when it is first needed. Until then, the image rect is based on
+ * the given \a size.
+ *
+ * This allows opening image collection tilesets with many tiles without
+ * having to load all their images.
+ */
+void Tile::setPendingImage(const QUrl &imageSource, QSize size)
+{
+    // Initialize or auto-adjust the image rect
+    if (mImageRect.isNull() || mImageRect == mImage.rect())
+        mImageRect = QRect(QPoint(), size);
+
+    mImage = QPixmap();
+    mImageSource = imageSource;
+    mImageStatus = LoadingPending;
+    mImageShape.reset();
+}
+
+void Tile::loadPendingImage() const
+{
+    mImage = ImageCache::loadPixmap(urlToLocalFileOrQrc(mImageSource));
+    mImageStatus = mImage.isNull() ? LoadingError : LoadingReady;
+}
+
 /**
  * Returns the tile to render when taking into account tile animations.
  *
@@ -170,6 +237,7 @@ void Tile::setObjectGroup(std::unique_ptr<ObjectGroup> objectGroup)
         return;
 
     mObjectGroup = std::move(objectGroup);
+    mCollisionShapes.reset();
 }
 
 /**
@@ -180,6 +248,62 @@ void Tile::setObjectGroup(std::unique_ptr<ObjectGroup> objectGroup)
 void Tile::swapObjectGroup(std::unique_ptr<ObjectGroup> &objectGroup)
 {
     std::swap(mObjectGroup, objectGroup);
+    mCollisionShapes.reset();
+}
+
+/**
+ * Returns the shapes of the objects in the object group of this tile, in the
+ * same order as the objects. The shapes are in screen coordinates relative to
+ * the top-left of the tile grid cell, with the rotation of each object
+ * applied.
+ *
+ * The shapes are cached until the object group is replaced or the
+ * orientation or grid size of the tileset changes.
+ */
+const QVector<QPainterPath> &Tile::collisionShapes() const
+{
+    const int orientation = mTileset->orientation();
+    const QSize gridSize = mTileset->gridSize();
+    const int objectCount = mObjectGroup ? mObjectGroup->objectCount() : 0;
+
+    if (mCollisionShapes.has_value() &&
+            mCollisionShapes->orientation == orientation &&
+            mCollisionShapes->gridSize == gridSize &&
+            mCollisionShapes->shapes.size() == objectCount) {
+        return mCollisionShapes->shapes;
+    }
+
+    CollisionShapes &collisionShapes = mCollisionShapes.emplace();
+    collisionShapes.orientation = orientation;
+    collisionShapes.gridSize = gridSize;
+
+    if (objectCount == 0)
+        return collisionShapes.shapes;
+
+    const bool isIsometric = orientation == Tileset::Isometric;
+    Map::Parameters mapParameters;
+    mapParameters.orientation = isIsometric ? Map::Isometric : Map::Orthogonal;
+    mapParameters.width = 1;
+    mapParameters.height = 1;
+    mapParameters.tileWidth = gridSize.width();
+    mapParameters.tileHeight = gridSize.height();
+    const Map map(mapParameters);
+    const auto renderer = MapRenderer::create(&map);
+
+    collisionShapes.shapes.reserve(objectCount);
+
+    for (const MapObject *object : mObjectGroup->objects()) {
+        const QPointF position = renderer->pixelToScreenCoords(object->position());
+
+        QTransform transform;
+        transform.translate(position.x(), position.y());
+        transform.rotate(object->rotation());
+        transform.translate(-position.x(), -position.y());
+
+        collisionShapes.shapes.append(transform.map(renderer->shape(object)));
+    }
+
+    return collisionShapes.shapes;
 }
 
 /**
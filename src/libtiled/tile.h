@@ -74,8 +74,10 @@ public:
     QSharedPointer<Tileset> sharedTileset() const;
 
     const QPixmap &image() const;
+    QPixmap croppedImage() const;
     const QPainterPath &imageShape() const;
     void setImage(const QPixmap &image);
+    void setPendingImage(const QUrl &imageSource, QSize size);
 
     const Tile *currentFrameTile() const;
 
@@ -101,6 +103,7 @@ public:
     ObjectGroup *objectGroup() const;
     void setObjectGroup(std::unique_ptr<ObjectGroup> objectGroup);
     void swapObjectGroup(std::unique_ptr<ObjectGroup> &objectGroup);
+    const QVector<QPainterPath> &collisionShapes() const;
 
     const QVector<Frame> &frames() const;
     void setFrames(const QVector<Frame> &frames);
@@ -115,16 +118,25 @@ public:
     Tile *clone(Tileset *tileset) const;
 
 private:
+    void loadPendingImage() const;
+
     int mId;
     Tileset *mTileset;
-    QPixmap mImage;
+    mutable QPixmap mImage;                             // may be loaded on demand
     mutable std::optional<QPainterPath> mImageShape;   // cache
     QUrl mImageSource;
     QRect mImageRect;
-    LoadingStatus mImageStatus;
+    mutable LoadingStatus mImageStatus;
     qreal mProbability;
     std::unique_ptr<ObjectGroup> mObjectGroup;
 
+    struct CollisionShapes {
+        int orientation;
+        QSize gridSize;
+        QVector<QPainterPath> shapes;
+    };
+    mutable std::optional<CollisionShapes> mCollisionShapes;   // cache
+
     QVector<Frame> mFrames;
     int mCurrentFrameIndex;
     int mUnusedTime;
@@ -0,0 +1,201 @@
+/*
+ * tileatlas.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tileatlas.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QPainter>
+#include <QThread>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+namespace Tiled {
+
+namespace {
+
+/**
+ * Transparent space around each image, filled with its edge pixels to avoid
+ * neighboring images bleeding in when the tiles are drawn scaled.
+ */
+constexpr int Padding = 1;
+
+struct Shelf
+{
+    int y;
+    int height;
+    int usedWidth;
+};
+
+struct Page
+{
+    Page()
+        : pixmap(TileAtlas::PageSize, TileAtlas::PageSize)
+    {
+        pixmap.fill(Qt::transparent);
+    }
+
+    bool allocate(QSize size, QPoint &position);
+
+    QPixmap pixmap;
+    QVector<Shelf> shelves;
+    int usedHeight = 0;
+};
+
+/**
+ * Finds space for an image of the given \a size, using a simple shelf
+ * packing strategy. Returns whether there was room on this page.
+ */
+bool Page::allocate(QSize size, QPoint &position)
+{
+    // Use the lowest shelf that fits, to waste as little space as possible
+    Shelf *best = nullptr;
+    for (Shelf &shelf : shelves) {
+        if (shelf.height < size.height())
+            continue;
+        if (shelf.usedWidth + size.width() > TileAtlas::PageSize)
+            continue;
+        if (!best || shelf.height < best->height)
+            best = &shelf;
+    }
+
+    if (!best) {
+        if (usedHeight + size.height() > TileAtlas::PageSize)
+            return false;
+
+        shelves.append(Shelf { usedHeight, size.height(), 0 });
+        usedHeight += size.height();
+        best = &shelves.last();
+    }
+
+    position = QPoint(best->usedWidth, best->y);
+    best->usedWidth += size.width();
+    return true;
+}
+
+struct Atlas
+{
+    std::vector<std::unique_ptr<Page>> pages;
+    QHash<qint64, TileAtlas::Location> locations;
+};
+
+Atlas &atlas()
+{
+    static Atlas atlas;
+    return atlas;
+}
+
+void copyImage(QPixmap &target, const QPixmap &image, QPoint position)
+{
+    const int w = image.width();
+    const int h = image.height();
+    const int x = position.x() + Padding;
+    const int y = position.y() + Padding;
+
+    QPainter painter(&target);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawPixmap(x, y, image);
+
+    // Extend the edges into the padding
+    painter.drawPixmap(x - 1, y, image, 0, 0, 1, h);
+    painter.drawPixmap(x + w, y, image, w - 1, 0, 1, h);
+    painter.drawPixmap(x, y - 1, image, 0, 0, w, 1);
+    painter.drawPixmap(x, y + h, image, 0, h - 1, w, 1);
+}
+
+} // anonymous namespace
+
+/**
+ * Returns the location of the given \a image in the atlas, adding it when
+ * it isn't there yet. The returned pixmap is null when the image is too
+ * large, when the atlas is full or when not called from the main thread.
+ *
+ * Since images are identified by their cache key, any change to an image
+ * results in it being added again. The old copy stays in the atlas until it
+ * is cleared.
+ */
+TileAtlas::Location TileAtlas::find(const QPixmap &image)
+{
+    if (image.isNull() || image.width() > MaxImageSize || image.height() > MaxImageSize)
+        return {};
+
+    auto app = QCoreApplication::instance();
+    if (!app || QThread::currentThread() != app->thread())
+        return {};
+
+    Atlas &a = atlas();
+
+    const qint64 key = image.cacheKey();
+    auto it = a.locations.constFind(key);
+    if (it != a.locations.constEnd())
+        return it.value();
+
+    const QSize paddedSize = image.size() + QSize(Padding * 2, Padding * 2);
+
+    QPoint position;
+    Page *page = nullptr;
+
+    for (auto &candidate : a.pages) {
+        if (candidate->allocate(paddedSize, position)) {
+            page = candidate.get();
+            break;
+        }
+    }
+
+    if (!page) {
+        if (int(a.pages.size()) == MaxPageCount)
+            return {};
+
+        a.pages.push_back(std::make_unique<Page>());
+        page = a.pages.back().get();
+        if (!page->allocate(paddedSize, position))
+            return {};
+    }
+
+    copyImage(page->pixmap, image, position);
+
+    const Location location { &page->pixmap, position + QPoint(Padding, Padding) };
+    a.locations.insert(key, location);
+    return location;
+}
+
+/**
+ * Removes all images from the atlas and releases its pixmaps. Invalidates
+ * any previously returned locations, so this must not be called while
+ * rendering.
+ */
+void TileAtlas::clear()
+{
+    Atlas &a = atlas();
+    a.locations.clear();
+    a.pages.clear();
+}
+
+} // namespace Tiled
@@ -0,0 +1,64 @@
+/*
+ * tileatlas.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QPixmap>
+#include <QPoint>
+
+namespace Tiled {
+
+/**
+ * Packs small tile images into a few large pixmaps, so that tiles from
+ * image collection tilesets and small tilesets can be drawn in a single
+ * batch.
+ *
+ * The atlas is only used from the main thread. Its pixmaps stay valid until
+ * clear() is called.
+ */
+class TILEDSHARED_EXPORT TileAtlas
+{
+public:
+    struct Location
+    {
+        const QPixmap *pixmap = nullptr;
+        QPoint offset;
+    };
+
+    static Location find(const QPixmap &image);
+
+    static void clear();
+
+    static constexpr int PageSize = 2048;
+    static constexpr int MaxPageCount = 4;
+    static constexpr int MaxImageSize = 256;
+};
+
+} // namespace Tiled
@@ -61,21 +61,70 @@ void Cell::rotate(RotateDirection direction)
     setFlippedAntiDiagonally((mask & 1) != 0);
 }
 
-QRegion Chunk::region(std::function<bool (const Cell &)> condition) const
+TileRegion Chunk::region(std::function<bool (const Cell &)> condition) const
 {
-    QRegion region;
+    if (isUniform()) {
+        if (condition(mUniformCell))
+            return TileRegion(QRect(0, 0, CHUNK_SIZE, CHUNK_SIZE));
+        return TileRegion();
+    }
+
+    TileRegion region;
+    Cell row[CHUNK_SIZE];
 
     for (int y = 0; y < CHUNK_SIZE; ++y) {
+        copyRow(0, y, CHUNK_SIZE, row);
+
         for (int x = 0; x < CHUNK_SIZE; ++x) {
-            if (condition(cellAt(x, y))) {
+            if (condition(row[x])) {
                 const int rangeStart = x;
-                for (++x; x <= CHUNK_SIZE; ++x) {
-                    if (x == CHUNK_SIZE || !condition(cellAt(x, y))) {
-                        const int rangeEnd = x;
-                        region += QRect(rangeStart, y, rangeEnd - rangeStart, 1);
-                        break;
-                    }
-                }
+                while (x < CHUNK_SIZE && condition(row[x]))
+                    ++x;
+                region.addSpan(rangeStart, y, x - rangeStart);
+            }
+        }
+    }
+
+    return region;
+}
+
+/**
+ * Returns the region of cells in this chunk that are equal to \a cell.
+ *
+ * This is faster than using region() with an equivalent condition, since
+ * packed cells are compared without unpacking them and chunks that don't
+ * refer to the tileset of the cell are skipped entirely.
+ */
+TileRegion Chunk::regionOfCell(const Cell &cell) const
+{
+    if (!isPacked())
+        return region([&cell] (const Cell &c) { return c == cell; });
+
+    const int tilesetIndex = cell._tileset ? mTilesets.indexOf(cell._tileset) : -1;
+    if (cell._tileset && tilesetIndex == -1)
+        return TileRegion();
+
+    // Cells that can't be packed can't be present in a packed chunk
+    if (cell._tileId < -1 || cell._tileId > MaxTileId)
+        return TileRegion();
+
+    const quint32 matchPacked = (static_cast<quint32>(cell._tileId + 1) << TileIdShift) |
+                                (static_cast<quint32>(tilesetIndex + 1) << TilesetShift) |
+                                static_cast<quint32>(cell.flags());
+
+    // The checked flag is ignored when comparing cells
+    const quint32 compareMask = ~static_cast<quint32>(Cell::Checked);
+
+    TileRegion region;
+    const quint32 *packed = mPackedCells.constData();
+
+    for (int y = 0; y < CHUNK_SIZE; ++y, packed += CHUNK_SIZE) {
+        for (int x = 0; x < CHUNK_SIZE; ++x) {
+            if ((packed[x] & compareMask) == matchPacked) {
+                const int rangeStart = x;
+                while (x < CHUNK_SIZE && (packed[x] & compareMask) == matchPacked)
+                    ++x;
+                region.addSpan(rangeStart, y, x - rangeStart);
             }
         }
     }
@@ -85,54 +134,657 @@ QRegion Chunk::region(std::function<bool (const Cell &)> condition) const
 
 void Chunk::setCell(int x, int y, const Cell &cell)
 {
-    int index = x + y * CHUNK_SIZE;
+    const int index = x + y * CHUNK_SIZE;
+
+    if (isUniform()) {
+        if (isIdentical(cell, mUniformCell))
+            return;
+
+        expand();
+    }
+
+    if (isPacked()) {
+        quint32 packed;
+        if (pack(cell, packed)) {
+            replacePacked(mPackedCells[index], packed);
+            return;
+        }
+
+        unpackAll();
+    }
+
+    mCells[index] = cell;
+}
+
+/**
+ * Sets \a count cells starting at \a x, \a y to the given \a cells. The
+ * cells must all be within the same row of this chunk.
+ */
+void Chunk::setRow(int x, int y, int count, const Cell *cells)
+{
+    Q_ASSERT(x >= 0 && x + count <= CHUNK_SIZE);
 
-    mGrid[index] = cell;
+    const int index = x + y * CHUNK_SIZE;
+    int i = 0;
+
+    if (isUniform()) {
+        while (i < count && isIdentical(cells[i], mUniformCell))
+            ++i;
+        if (i == count)
+            return;
+
+        expand();
+    }
+
+    if (isPacked()) {
+        for (; i < count; ++i) {
+            quint32 packed;
+            if (!pack(cells[i], packed)) {
+                unpackAll();
+                break;
+            }
+            replacePacked(mPackedCells[index + i], packed);
+        }
+    }
+
+    for (; i < count; ++i)
+        mCells[index + i] = cells[i];
+}
+
+/**
+ * Sets all cells of this chunk to the given \a cell.
+ */
+void Chunk::fill(const Cell &cell)
+{
+    mUniformCell = cell;
+    mPackedCells = QVector<quint32>();
+    mTilesets = QVector<Tileset*>();
+    mTilesetCellCounts = QVector<quint16>();
+    mCells = QVector<Cell>();
+}
+
+/**
+ * Switches this chunk to the most compact storage possible for its current
+ * cells. This is not done automatically on each change, since it requires
+ * checking all cells.
+ */
+void Chunk::squeeze()
+{
+    if (isUniform())
+        return;
+
+    if (isPacked()) {
+        const quint32 first = mPackedCells.first();
+        if (std::all_of(mPackedCells.cbegin(), mPackedCells.cend(),
+                        [first] (quint32 packed) { return packed == first; })) {
+            fill(unpack(first));
+        } else {
+            compactTilesets();
+        }
+        return;
+    }
+
+    const Cell first = mCells.first();
+    if (std::all_of(mCells.cbegin(), mCells.cend(),
+                    [&first] (const Cell &cell) { return isIdentical(cell, first); })) {
+        fill(first);
+        return;
+    }
+
+    // Try to go back to storing the cells packed
+    QVector<quint32> packedCells(CHUNK_SIZE * CHUNK_SIZE);
+    for (int i = 0, i_end = mCells.size(); i < i_end; ++i) {
+        if (!pack(mCells.at(i), packedCells[i])) {
+            mTilesets = QVector<Tileset*>();
+            mTilesetCellCounts = QVector<quint16>();
+            return;
+        }
+    }
+
+    mPackedCells.swap(packedCells);
+    mCells = QVector<Cell>();
+    countTilesetCells();
+}
+
+/**
+ * Returns the approximate amount of memory used to store the cells of this
+ * chunk, in bytes.
+ */
+qint64 Chunk::memoryUsage() const
+{
+    return sizeof(Chunk)
+            + mPackedCells.capacity() * qint64(sizeof(quint32))
+            + mTilesets.capacity() * qint64(sizeof(Tileset*))
+            + mTilesetCellCounts.capacity() * qint64(sizeof(quint16))
+            + mCells.capacity() * qint64(sizeof(Cell));
 }
 
 bool Chunk::isEmpty() const
 {
-    for (int y = 0; y < CHUNK_SIZE; ++y) {
-        for (int x = 0; x < CHUNK_SIZE; ++x) {
-            if (!cellAt(x, y).isEmpty())
+    if (isUniform())
+        return mUniformCell.isEmpty();
+
+    if (isPacked()) {
+        for (const quint32 packed : mPackedCells)
+            if (packedTilesetIndex(packed) != 0)
                 return false;
-        }
+
+        return true;
     }
 
+    for (const Cell &cell : mCells)
+        if (!cell.isEmpty())
+            return false;
+
+    return true;
+}
+
+/**
+ * Returns whether this chunk has the same cells as the \a other chunk.
+ *
+ * Uniform chunks and chunks sharing their cell data are compared without
+ * looking at the individual cells.
+ */
+bool Chunk::hasSameCells(const Chunk &other) const
+{
+    if (isUniform() && other.isUniform())
+        return mUniformCell == other.mUniformCell;
+
+    if (isPacked() && other.isPacked() &&
+            mPackedCells.isSharedWith(other.mPackedCells) &&
+            mTilesets == other.mTilesets)
+        return true;
+
+    if (!mCells.isEmpty() && mCells.isSharedWith(other.mCells))
+        return true;
+
+    for (int index = 0; index < CHUNK_SIZE * CHUNK_SIZE; ++index)
+        if (cellAtIndex(index) != other.cellAtIndex(index))
+            return false;
+
     return true;
 }
 
 bool Chunk::hasCell(std::function<bool (const Cell &)> condition) const
 {
-    for (const Cell &cell : mGrid)
+    if (isUniform())
+        return condition(mUniformCell);
+
+    for (const Cell &cell : *this)
         if (condition(cell))
             return true;
 
     return false;
 }
 
+/**
+ * Returns whether any cell of this chunk refers to the given \a tileset.
+ *
+ * For packed chunks, this only needs to check the number of cells counted
+ * for each of the referenced tilesets.
+ */
+bool Chunk::referencesTileset(const Tileset *tileset) const
+{
+    if (isUniform())
+        return mUniformCell.tileset() == tileset;
+
+    if (isPacked()) {
+        for (int i = 0, i_end = mTilesets.size(); i < i_end; ++i)
+            if (mTilesets.at(i) == tileset && mTilesetCellCounts.at(i) > 0)
+                return true;
+
+        return false;
+    }
+
+    return std::any_of(mCells.cbegin(), mCells.cend(),
+                       [tileset] (const Cell &cell) { return cell.tileset() == tileset; });
+}
+
+/**
+ * Adds the tilesets referred to by the cells of this chunk to \a tilesets.
+ */
+void Chunk::addUsedTilesets(QSet<Tileset*> &tilesets) const
+{
+    if (isUniform()) {
+        if (Tileset *tileset = mUniformCell.tileset())
+            tilesets.insert(tileset);
+        return;
+    }
+
+    if (isPacked()) {
+        for (int i = 0, i_end = mTilesets.size(); i < i_end; ++i)
+            if (mTilesets.at(i) && mTilesetCellCounts.at(i) > 0)
+                tilesets.insert(mTilesets.at(i));
+        return;
+    }
+
+    // Neighboring cells usually refer to the same tileset
+    const Tileset *lastTileset = nullptr;
+
+    for (const Cell &cell : mCells) {
+        if (!cell.tileset() || cell.tileset() == lastTileset)
+            continue;
+
+        tilesets.insert(cell.tileset());
+        lastTileset = cell.tileset();
+    }
+}
+
 void Chunk::removeReferencesToTileset(Tileset *tileset)
 {
-    for (int i = 0, i_end = mGrid.size(); i < i_end; ++i) {
-        if (mGrid.at(i).tileset() == tileset)
-            mGrid.replace(i, Cell::empty);
+    if (isUniform()) {
+        if (mUniformCell.tileset() == tileset)
+            mUniformCell = Cell::empty;
+        return;
+    }
+
+    if (isPacked()) {
+        for (int i = 0, i_end = mTilesets.size(); i < i_end; ++i) {
+            if (mTilesets.at(i) != tileset)
+                continue;
+
+            const int tilesetIndex = i + 1;
+            for (quint32 &packed : mPackedCells)
+                if (packedTilesetIndex(packed) == tilesetIndex)
+                    packed = 0;
+
+            // Leave the slot in place, it will be reused by compactTilesets
+            mTilesets[i] = nullptr;
+            mTilesetCellCounts[i] = 0;
+        }
+        return;
+    }
+
+    for (int i = 0, i_end = mCells.size(); i < i_end; ++i) {
+        if (mCells.at(i).tileset() == tileset)
+            mCells.replace(i, Cell::empty);
     }
 }
 
 void Chunk::replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTileset)
 {
-    for (Cell &cell : mGrid) {
+    if (isUniform()) {
+        if (mUniformCell.tileset() == oldTileset)
+            mUniformCell.setTile(newTileset, mUniformCell.tileId());
+        return;
+    }
+
+    if (isPacked()) {
+        // Packed cells refer to their tileset by index, so only the list of
+        // tilesets needs to change.
+        std::replace(mTilesets.begin(), mTilesets.end(), oldTileset, newTileset);
+        return;
+    }
+
+    for (Cell &cell : mCells) {
         if (cell.tileset() == oldTileset)
             cell.setTile(newTileset, cell.tileId());
     }
 }
 
+/**
+ * Applies the given \a transform to the cells of this chunk, in place.
+ *
+ * Packed cells are transformed without unpacking them, since neither the
+ * tile IDs nor the tileset indexes change.
+ */
+void Chunk::transform(const Transform &transform)
+{
+    // Lookup table for the whole flag field, which preserves the checked flag
+    quint8 flagMap[FlagMask + 1];
+    for (int f = 0; f <= static_cast<int>(FlagMask); ++f)
+        flagMap[f] = static_cast<quint8>((f & ~Cell::VisualFlags) | transform.flags[f & Cell::VisualFlags]);
+
+    const auto transformCell = [&] (Cell cell) {
+        if (cell.isEmpty())
+            return Cell();
+        cell._flags = flagMap[cell._flags & FlagMask];
+        return cell;
+    };
+
+    if (isUniform()) {
+        mUniformCell = transformCell(mUniformCell);
+        return;
+    }
+
+    // Returns the index of the cell that ends up at the given location
+    const auto sourceIndex = [&] (int x, int y) {
+        if (transform.mirrorX)
+            x = CHUNK_MASK - x;
+        if (transform.mirrorY)
+            y = CHUNK_MASK - y;
+        return transform.transpose ? y + x * CHUNK_SIZE
+                                   : x + y * CHUNK_SIZE;
+    };
+
+    if (isPacked()) {
+        QVector<quint32> packedCells(CHUNK_SIZE * CHUNK_SIZE);
+        const quint32 *source = mPackedCells.constData();
+        quint32 *target = packedCells.data();
+
+        for (int y = 0; y < CHUNK_SIZE; ++y) {
+            for (int x = 0; x < CHUNK_SIZE; ++x) {
+                const quint32 packed = source[sourceIndex(x, y)];
+
+                // Branch-free, clearing empty cells entirely
+                const quint32 keep = packedTilesetIndex(packed) ? ~0u : 0u;
+                *target++ = ((packed & ~FlagMask) | flagMap[packed & FlagMask]) & keep;
+            }
+        }
+
+        mPackedCells.swap(packedCells);
+        return;
+    }
+
+    QVector<Cell> cells(CHUNK_SIZE * CHUNK_SIZE);
+    const Cell *source = mCells.constData();
+    Cell *target = cells.data();
+
+    for (int y = 0; y < CHUNK_SIZE; ++y)
+        for (int x = 0; x < CHUNK_SIZE; ++x)
+            *target++ = transformCell(source[sourceIndex(x, y)]);
+
+    mCells.swap(cells);
+}
+
+/**
+ * Tries to pack the given \a cell into 32 bits, adding its tileset to the
+ * list of tilesets referenced by this chunk when necessary.
+ *
+ * Returns whether the cell could be packed.
+ */
+bool Chunk::pack(const Cell &cell, quint32 &packed)
+{
+    if (cell._tileId < -1 || cell._tileId > MaxTileId)
+        return false;
+    if (cell._flags & ~static_cast<int>(FlagMask))
+        return false;
+
+    quint32 tilesetIndex = 0;
+
+    if (Tileset *tileset = cell._tileset) {
+        int index = mTilesets.indexOf(tileset);
+
+        if (index == -1) {
+            if (mTilesets.size() == MaxTilesets && isPacked())
+                compactTilesets();
+            if (mTilesets.size() == MaxTilesets)
+                return false;
+
+            index = mTilesets.size();
+            mTilesets.append(tileset);
+            mTilesetCellCounts.append(0);
+        }
+
+        tilesetIndex = static_cast<quint32>(index + 1);
+    }
+
+    packed = (static_cast<quint32>(cell._tileId + 1) << TileIdShift) |
+             (tilesetIndex << TilesetShift) |
+             static_cast<quint32>(cell._flags);
+
+    return true;
+}
+
+/**
+ * Expands a uniform chunk to a full grid of cells.
+ */
+void Chunk::expand()
+{
+    Q_ASSERT(isUniform());
+
+    quint32 packed;
+    if (pack(mUniformCell, packed)) {
+        mPackedCells.fill(packed, CHUNK_SIZE * CHUNK_SIZE);
+        countTilesetCells();
+    } else {
+        mCells.fill(mUniformCell, CHUNK_SIZE * CHUNK_SIZE);
+    }
+
+    mUniformCell = Cell();
+}
+
+/**
+ * Switches this chunk from storing its cells packed to storing them unpacked.
+ */
+void Chunk::unpackAll()
+{
+    Q_ASSERT(isPacked());
+
+    QVector<Cell> cells;
+    cells.reserve(CHUNK_SIZE * CHUNK_SIZE);
+
+    for (const quint32 packed : std::as_const(mPackedCells))
+        cells.append(unpack(packed));
+
+    mCells.swap(cells);
+    mPackedCells = QVector<quint32>();
+    mTilesets = QVector<Tileset*>();
+    mTilesetCellCounts = QVector<quint16>();
+}
+
+/**
+ * Removes the tilesets that are no longer referenced by any cell from the
+ * list of tilesets, updating the packed cells accordingly.
+ */
+void Chunk::compactTilesets()
+{
+    QVector<int> remap(mTilesets.size() + 1, 0);
+
+    for (const quint32 packed : std::as_const(mPackedCells))
+        remap[packedTilesetIndex(packed)] = 1;
+
+    QVector<Tileset*> tilesets;
+    for (int i = 0, i_end = mTilesets.size(); i < i_end; ++i) {
+        Tileset *tileset = mTilesets.at(i);
+        if (remap.at(i + 1) && tileset) {
+            // Merge duplicate entries that could result from replacing a tileset
+            int index = tilesets.indexOf(tileset);
+            if (index == -1) {
+                index = tilesets.size();
+                tilesets.append(tileset);
+            }
+            remap[i + 1] = index + 1;
+        } else {
+            remap[i + 1] = 0;
+        }
+    }
+    remap[0] = 0;
+
+    for (quint32 &packed : mPackedCells) {
+        const quint32 tilesetIndex = static_cast<quint32>(remap.at(packedTilesetIndex(packed)));
+        packed = (packed & ~(TilesetMask << TilesetShift)) | (tilesetIndex << TilesetShift);
+    }
+
+    mTilesets.swap(tilesets);
+    countTilesetCells();
+}
+
+/**
+ * Counts the packed cells referring to each of the tilesets.
+ */
+void Chunk::countTilesetCells()
+{
+    mTilesetCellCounts.fill(0, mTilesets.size());
+
+    for (const quint32 packed : std::as_const(mPackedCells))
+        if (const int tilesetIndex = packedTilesetIndex(packed))
+            ++mTilesetCellCounts[tilesetIndex - 1];
+}
+
+/**
+ * Replaces the packed cell \a target with \a packed, keeping the number of
+ * cells referring to each tileset up to date.
+ */
+void Chunk::replacePacked(quint32 &target, quint32 packed)
+{
+    if (const int tilesetIndex = packedTilesetIndex(target))
+        --mTilesetCellCounts[tilesetIndex - 1];
+    if (const int tilesetIndex = packedTilesetIndex(packed))
+        ++mTilesetCellCounts[tilesetIndex - 1];
+
+    target = packed;
+}
+
+/**
+ * Sets the area, in tile coordinates, for which chunks are looked up in a
+ * grid. Lookups of chunks outside of this area fall back to a hash table.
+ */
+void ChunkMap::setDenseArea(QRect tileArea)
+{
+    QRect area;
+
+    if (!tileArea.isEmpty()) {
+        area.setCoords(tileArea.left() >> CHUNK_BITS,
+                       tileArea.top() >> CHUNK_BITS,
+                       tileArea.right() >> CHUNK_BITS,
+                       tileArea.bottom() >> CHUNK_BITS);
+
+        if (qint64(area.width()) * area.height() > MaxDenseChunks)
+            area = QRect();
+    }
+
+    if (area == mDenseArea)
+        return;
+
+    mDenseArea = area;
+    rebuildIndex();
+}
+
+void ChunkMap::clear()
+{
+    mChunks.clear();
+    mKeys.clear();
+    rebuildIndex();
+}
+
+/**
+ * Inserts the given \a chunk at \a key, replacing any existing chunk.
+ */
+void ChunkMap::insert(QPoint key, const Chunk &chunk)
+{
+    const int index = indexOf(key);
+    if (index == -1)
+        append(key, chunk);
+    else
+        mChunks[index] = chunk;
+}
+
+/**
+ * Removes the chunks at the given \a keys. Keys without a chunk are ignored.
+ *
+ * The index is rebuilt only once, so removing many chunks at once is much
+ * cheaper than removing them one by one.
+ */
+void ChunkMap::remove(const QVector<QPoint> &keys)
+{
+    QVector<bool> removed(mChunks.size(), false);
+    bool anyRemoved = false;
+
+    for (const QPoint key : keys) {
+        const int index = indexOf(key);
+        if (index != -1) {
+            removed[index] = true;
+            anyRemoved = true;
+        }
+    }
+
+    if (!anyRemoved)
+        return;
+
+    // Compact the remaining chunks, keeping their order
+    int target = 0;
+    for (int i = 0, i_end = mChunks.size(); i < i_end; ++i) {
+        if (removed.at(i))
+            continue;
+        if (target != i) {
+            mChunks[target] = std::move(mChunks[i]);
+            mKeys[target] = mKeys.at(i);
+        }
+        ++target;
+    }
+
+    mChunks.resize(target);
+    mKeys.resize(target);
+    rebuildIndex();
+}
+
+int ChunkMap::append(QPoint key, const Chunk &chunk)
+{
+    const int index = mChunks.size();
+    mChunks.append(chunk);
+    mKeys.append(key);
+
+    if (mDenseArea.contains(key)) {
+        mDenseIndex[(key.y() - mDenseArea.y()) * mDenseArea.width() +
+                    key.x() - mDenseArea.x()] = index;
+    } else {
+        // Keep the load factor of the hash table at or below 50%
+        if ((mSparseCount + 1) * 2 > mSparseIndex.size()) {
+            mSparseIndex.fill(-1, std::max(16, mSparseIndex.size() * 2));
+            mSparseCount = 0;
+
+            for (int i = 0; i < index; ++i)
+                if (!mDenseArea.contains(mKeys.at(i)))
+                    insertSparse(i);
+        }
+
+        insertSparse(index);
+    }
+
+    return index;
+}
+
+void ChunkMap::insertSparse(int index)
+{
+    const int mask = mSparseIndex.size() - 1;
+    int slot = hashKey(mKeys.at(index)) & mask;
+    while (mSparseIndex.at(slot) != -1)
+        slot = (slot + 1) & mask;
+
+    mSparseIndex[slot] = index;
+    ++mSparseCount;
+}
+
+void ChunkMap::rebuildIndex()
+{
+    mDenseIndex.fill(-1, mDenseArea.width() * mDenseArea.height());
+    mSparseIndex.clear();
+    mSparseCount = 0;
+
+    int sparseChunks = 0;
+
+    for (int i = 0, i_end = mKeys.size(); i < i_end; ++i) {
+        const QPoint key = mKeys.at(i);
+        if (mDenseArea.contains(key)) {
+            mDenseIndex[(key.y() - mDenseArea.y()) * mDenseArea.width() +
+                        key.x() - mDenseArea.x()] = i;
+        } else {
+            ++sparseChunks;
+        }
+    }
+
+    if (sparseChunks == 0)
+        return;
+
+    int capacity = 16;
+    while (capacity < sparseChunks * 2)
+        capacity *= 2;
+
+    mSparseIndex.fill(-1, capacity);
+
+    for (int i = 0, i_end = mKeys.size(); i < i_end; ++i)
+        if (!mDenseArea.contains(mKeys.at(i)))
+            insertSparse(i);
+}
+
 TileLayer::TileLayer(const QString &name, int x, int y, int width, int height)
     : Layer(TileLayerType, name, x, y)
     , mWidth(width)
     , mHeight(height)
     , mUsedTilesetsDirty(false)
 {
+    mChunks.setDenseArea(QRect(0, 0, width, height));
 }
 
 TileLayer::TileLayer(const QString &name, QPoint position, QSize size)
@@ -172,25 +824,124 @@ static QMargins computeDrawMargins(const QSet<SharedTileset> &tilesets)
 
 QMargins TileLayer::drawMargins() const
 {
-    return computeDrawMargins(usedTilesets());
+    return computeDrawMargins(usedTilesets());
+}
+
+/**
+ * Calculates the region of cells in this tile layer for which the given
+ * \a condition returns true.
+ */
+/**
+ * Builds a region from the runs of cells reported for each row of each
+ * chunk by \a chunkRowRuns.
+ *
+ * The chunks are visited in order of their position, a band of chunks at a
+ * time, so that the runs are added row by row from left to right. This way
+ * the region needs no sorting and runs that touch across a chunk border are
+ * merged as they are added.
+ */
+template<typename ChunkRowRuns>
+static QRegion regionFromChunks(const ChunkMap &chunks, QPoint origin,
+                                ChunkRowRuns chunkRowRuns)
+{
+    struct ChunkEntry
+    {
+        QPoint key;
+        const Chunk *chunk;
+    };
+
+    QVector<ChunkEntry> entries;
+    entries.reserve(chunks.size());
+    for (auto it = chunks.cbegin(), it_end = chunks.cend(); it != it_end; ++it)
+        entries.append(ChunkEntry { it.key(), &it.value() });
+
+    std::sort(entries.begin(), entries.end(), [] (const ChunkEntry &a, const ChunkEntry &b) {
+        return a.key.y() < b.key.y() || (a.key.y() == b.key.y() && a.key.x() < b.key.x());
+    });
+
+    TileRegion region;
+
+    for (auto bandStart = entries.cbegin(); bandStart != entries.cend(); ) {
+        auto bandEnd = bandStart;
+        while (bandEnd != entries.cend() && bandEnd->key.y() == bandStart->key.y())
+            ++bandEnd;
+
+        const int bandY = origin.y() + bandStart->key.y() * CHUNK_SIZE;
+
+        for (int y = 0; y < CHUNK_SIZE; ++y) {
+            for (auto entry = bandStart; entry != bandEnd; ++entry) {
+                const int chunkX = origin.x() + entry->key.x() * CHUNK_SIZE;
+                chunkRowRuns(*entry->chunk, y, [&] (int x, int count) {
+                    region.addSpan(chunkX + x, bandY + y, count);
+                });
+            }
+        }
+
+        bandStart = bandEnd;
+    }
+
+    return region.toRegion();
+}
+
+QRegion TileLayer::region(std::function<bool (const Cell &)> condition) const
+{
+    return regionFromChunks(mChunks, QPoint(mX, mY), [&] (const Chunk &chunk, int y, auto addRun) {
+        Cell row[CHUNK_SIZE];
+        chunk.copyRow(0, y, CHUNK_SIZE, row);
+
+        for (int x = 0; x < CHUNK_SIZE; ++x) {
+            if (condition(row[x])) {
+                const int runStart = x;
+                while (x < CHUNK_SIZE && condition(row[x]))
+                    ++x;
+                addRun(runStart, x - runStart);
+            }
+        }
+    });
+}
+
+/**
+ * Calculates the region occupied by the tiles of this layer. Similar to
+ * Layer::bounds(), but leaves out the regions without tiles.
+ */
+QRegion TileLayer::region() const
+{
+    return regionFromChunks(mChunks, QPoint(mX, mY), [] (const Chunk &chunk, int y, auto addRun) {
+        chunk.forEachRun(y, Chunk::NonEmptyCells, addRun);
+    });
+}
+
+/**
+ * Calculates the modified region of this layer. This includes both all
+ * non-empty cells as well as any cells that were marked as "checked".
+ */
+QRegion TileLayer::modifiedRegion() const
+{
+    return regionFromChunks(mChunks, QPoint(mX, mY), [] (const Chunk &chunk, int y, auto addRun) {
+        chunk.forEachRun(y, Chunk::NonEmptyOrCheckedCells, addRun);
+    });
 }
 
 /**
- * Calculates the region of cells in this tile layer for which the given
- * \a condition returns true.
+ * Calculates the region of cells in this tile layer that are equal to the
+ * given \a cell.
+ *
+ * This is faster than using region() with an equivalent condition.
  */
-QRegion TileLayer::region(std::function<bool (const Cell &)> condition) const
+QRegion TileLayer::regionOfCell(const Cell &cell) const
 {
-    QRegion region;
+    TileRegion region;
+
+    for (auto it = mChunks.cbegin(), it_end = mChunks.cend(); it != it_end; ++it) {
+        const QPoint offset(it.key().x() * CHUNK_SIZE + mX,
+                            it.key().y() * CHUNK_SIZE + mY);
 
-    QHashIterator<QPoint, Chunk> it(mChunks);
-    while (it.hasNext()) {
-        it.next();
-        region += it.value().region(condition).translated(it.key().x() * CHUNK_SIZE + mX,
-                                                          it.key().y() * CHUNK_SIZE + mY);
+        const TileRegion chunkRegion = it.value().regionOfCell(cell);
+        for (const QRect &span : chunkRegion.spans())
+            region.addSpan(span.x() + offset.x(), span.y() + offset.y(), span.width());
     }
 
-    return region;
+    return region.toRegion();
 }
 
 /**
@@ -211,18 +962,92 @@ void Tiled::TileLayer::setCell(int x, int y, const Cell &cell)
 
     Chunk &_chunk = chunk(x, y);
 
+    Tileset *oldTileset = nullptr;
+
     if (!mUsedTilesetsDirty) {
-        Tileset *oldTileset = _chunk.cellAt(x & CHUNK_MASK, y & CHUNK_MASK).tileset();
         Tileset *newTileset = cell.tileset();
-        if (oldTileset != newTileset) {
-            if (oldTileset)
-                mUsedTilesetsDirty = true;
-            else if (newTileset)
-                mUsedTilesets.insert(newTileset->sharedFromThis());
-        }
+        oldTileset = _chunk.cellAt(x & CHUNK_MASK, y & CHUNK_MASK).tileset();
+        if (oldTileset == newTileset)
+            oldTileset = nullptr;
+        else if (newTileset)
+            mUsedTilesets.insert(newTileset->sharedFromThis());
     }
 
     _chunk.setCell(x & CHUNK_MASK, y & CHUNK_MASK, cell);
+
+    // The old tileset can only have become unused when this chunk no longer
+    // refers to it
+    if (oldTileset && !_chunk.referencesTileset(oldTileset))
+        mUsedTilesetsDirty = true;
+}
+
+/**
+ * Sets \a count cells starting at \a x, \a y to the given \a cells.
+ *
+ * This is faster than calling setCell() for each cell, since each chunk is
+ * only looked up once.
+ */
+void TileLayer::setRow(int x, int y, int count, const Cell *cells)
+{
+    const int end = x + count;
+
+    while (x < end) {
+        const int chunkEnd = std::min(end, (x & ~CHUNK_MASK) + CHUNK_SIZE);
+        const int spanCount = chunkEnd - x;
+
+        if (!findChunk(x, y)) {
+            const bool empty = std::all_of(cells, cells + spanCount, [] (const Cell &cell) {
+                return cell == Cell::empty && !cell.checked();
+            });
+
+            if (empty) {
+                x += spanCount;
+                cells += spanCount;
+                continue;
+            }
+
+            mBounds = mBounds.united(QRect(x - (x & CHUNK_MASK),
+                                           y - (y & CHUNK_MASK),
+                                           CHUNK_SIZE,
+                                           CHUNK_SIZE));
+        }
+
+        Chunk &_chunk = chunk(x, y);
+
+        Tileset *oldTilesets[CHUNK_SIZE];
+        int oldTilesetCount = 0;
+
+        if (!mUsedTilesetsDirty) {
+            Cell oldCells[CHUNK_SIZE];
+            _chunk.copyRow(x & CHUNK_MASK, y & CHUNK_MASK, spanCount, oldCells);
+
+            Tileset *lastInserted = nullptr;
+
+            for (int i = 0; i < spanCount; ++i) {
+                Tileset *oldTileset = oldCells[i].tileset();
+                Tileset *newTileset = cells[i].tileset();
+                if (oldTileset == newTileset)
+                    continue;
+
+                if (oldTileset && (oldTilesetCount == 0 || oldTilesets[oldTilesetCount - 1] != oldTileset))
+                    oldTilesets[oldTilesetCount++] = oldTileset;
+
+                if (newTileset && newTileset != lastInserted) {
+                    mUsedTilesets.insert(newTileset->sharedFromThis());
+                    lastInserted = newTileset;
+                }
+            }
+        }
+
+        _chunk.setRow(x & CHUNK_MASK, y & CHUNK_MASK, spanCount, cells);
+
+        for (int i = 0; i < oldTilesetCount && !mUsedTilesetsDirty; ++i)
+            if (!_chunk.referencesTileset(oldTilesets[i]))
+                mUsedTilesetsDirty = true;
+
+        x += spanCount;
+        cells += spanCount;
+    }
 }
 
 std::unique_ptr<TileLayer> TileLayer::copy(const QRegion &region) const
@@ -234,29 +1059,60 @@ std::unique_ptr<TileLayer> TileLayer::copy(const QRegion &region) const
                                               0, 0,
                                               regionBounds.width(), regionBounds.height());
 
-    for (const QRect &rect : regionWithContents) {
-        for (int x = rect.left(); x <= rect.right(); ++x)
-            for (int y = rect.top(); y <= rect.bottom(); ++y)
-                copied->setCell(x - regionBounds.x(),
-                                y - regionBounds.y(),
-                                cellAt(x, y));
-    }
+    copied->setCells(-regionBounds.x(), -regionBounds.y(), this,
+                     regionWithContents.translated(-regionBounds.topLeft()));
 
     return copied;
 }
 
 void TileLayer::merge(QPoint pos, const TileLayer *layer)
 {
-    // Determine the overlapping area
-    QRect area = QRect(pos, QSize(layer->width(), layer->height()));
-    area &= QRect(0, 0, width(), height());
+    // Determine the overlapping area, in the coordinates of the given layer
+    QRect area = QRect(-pos, size());
+    area &= QRect(0, 0, layer->width(), layer->height());
 
-    for (int y = area.top(); y <= area.bottom(); ++y) {
-        for (int x = area.left(); x <= area.right(); ++x) {
-            const Cell &cell = layer->cellAt(x - pos.x(),
-                                             y - pos.y());
-            if (!cell.isEmpty())
-                setCell(x, y, cell);
+    const bool aligned = (pos.x() & CHUNK_MASK) == 0 && (pos.y() & CHUNK_MASK) == 0;
+    Cell cells[CHUNK_SIZE];
+
+    // Only the allocated chunks of the given layer need to be visited
+    for (auto it = layer->mChunks.cbegin(), it_end = layer->mChunks.cend(); it != it_end; ++it) {
+        const Chunk &chunk = it.value();
+        if (chunk.isEmpty())
+            continue;
+
+        const QRect chunkRect(it.key().x() * CHUNK_SIZE,
+                              it.key().y() * CHUNK_SIZE,
+                              CHUNK_SIZE, CHUNK_SIZE);
+        const QRect rect = chunkRect & area;
+        if (rect.isEmpty())
+            continue;
+
+        // A chunk without empty cells replaces the target chunk entirely
+        if (aligned && rect == chunkRect &&
+                !chunk.hasCell([] (const Cell &cell) { return cell.isEmpty(); })) {
+            setChunk(chunkRect.x() + pos.x(), chunkRect.y() + pos.y(), &chunk);
+            continue;
+        }
+
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            const int count = rect.width();
+            chunk.copyRow(rect.left() - chunkRect.left(), y - chunkRect.top(), count, cells);
+
+            // Set each run of non-empty cells at once
+            int start = 0;
+            while (start < count) {
+                while (start < count && cells[start].isEmpty())
+                    ++start;
+
+                int end = start;
+                while (end < count && !cells[end].isEmpty())
+                    ++end;
+
+                if (end > start)
+                    setRow(rect.left() + start + pos.x(), y + pos.y(), end - start, cells + start);
+
+                start = end;
+            }
         }
     }
 }
@@ -264,10 +1120,92 @@ void TileLayer::merge(QPoint pos, const TileLayer *layer)
 void TileLayer::setCells(int x, int y, const TileLayer *layer,
                          const QRegion &area)
 {
-    for (const QRect &rect : area)
-        for (int _x = rect.left(); _x <= rect.right(); ++_x)
-            for (int _y = rect.top(); _y <= rect.bottom(); ++_y)
-                setCell(_x, _y, layer->cellAt(_x - x, _y - y));
+    QRegion remainingArea = area;
+
+    // When the offset is aligned to the chunk grid, chunks that are entirely
+    // covered by the area are shared with the other layer instead of being
+    // copied cell by cell. The chunk data is only copied once either layer
+    // modifies it.
+    if (layer != this && (x & CHUNK_MASK) == 0 && (y & CHUNK_MASK) == 0) {
+        QRegion sharedArea;
+        QVector<QPoint> clearedChunks;
+
+        for (const QRect &rect : area) {
+            const int left = (rect.left() + CHUNK_MASK) & ~CHUNK_MASK;
+            const int top = (rect.top() + CHUNK_MASK) & ~CHUNK_MASK;
+            const int right = (rect.right() + 1) & ~CHUNK_MASK;
+            const int bottom = (rect.bottom() + 1) & ~CHUNK_MASK;
+
+            if (left >= right || top >= bottom)
+                continue;
+
+            for (int chunkY = top; chunkY < bottom; chunkY += CHUNK_SIZE) {
+                for (int chunkX = left; chunkX < right; chunkX += CHUNK_SIZE) {
+                    const Chunk *chunk = layer->findChunk(chunkX - x, chunkY - y);
+                    setChunk(chunkX, chunkY, chunk);
+
+                    // Chunks cleared entirely are dropped rather than kept empty
+                    if (!chunk)
+                        clearedChunks.append(QPoint(chunkX >> CHUNK_BITS, chunkY >> CHUNK_BITS));
+                }
+            }
+
+            sharedArea += QRect(left, top, right - left, bottom - top);
+        }
+
+        removeChunks(clearedChunks);
+        remainingArea -= sharedArea;
+    }
+
+    if (layer == this) {
+        for (const QRect &rect : std::as_const(remainingArea))
+            for (int _x = rect.left(); _x <= rect.right(); ++_x)
+                for (int _y = rect.top(); _y <= rect.bottom(); ++_y)
+                    setCell(_x, _y, layer->cellAt(_x - x, _y - y));
+        return;
+    }
+
+    // Copy the remaining area row by row
+    for (const QRect &rect : std::as_const(remainingArea)) {
+        layer->forEachSpan(rect.translated(-x, -y),
+                           [&] (int spanX, int spanY, const Cell *cells, int count) {
+            setRow(spanX + x, spanY + y, count, cells);
+        });
+    }
+}
+
+/**
+ * Replaces the chunk at the given chunk-aligned location with a shallow copy
+ * of \a chunk, or with empty cells when \a chunk is null.
+ *
+ * This is equivalent to setting each cell of the chunk individually.
+ */
+void TileLayer::setChunk(int x, int y, const Chunk *chunk)
+{
+    Q_ASSERT((x & CHUNK_MASK) == 0 && (y & CHUNK_MASK) == 0);
+
+    const QPoint chunkCoordinates(x >> CHUNK_BITS, y >> CHUNK_BITS);
+    Chunk *existingChunk = mChunks.find(chunkCoordinates);
+
+    if (!existingChunk) {
+        // Like setCell, avoid allocating a chunk when there is nothing to set
+        if (!chunk || !chunk->hasCell([] (const Cell &cell) { return !cell.isEmpty() || cell.checked(); }))
+            return;
+
+        mBounds = mBounds.united(QRect(x, y, CHUNK_SIZE, CHUNK_SIZE));
+        mChunks.insert(chunkCoordinates, *chunk);
+    } else {
+        if (!existingChunk->isEmpty())
+            mUsedTilesetsDirty = true;
+
+        if (chunk)
+            *existingChunk = *chunk;
+        else
+            existingChunk->fill(Cell::empty);
+    }
+
+    if (chunk && !chunk->isEmpty())
+        mUsedTilesetsDirty = true;
 }
 
 /**
@@ -289,14 +1227,89 @@ void TileLayer::setTiles(const QRegion &area, Tile *tile)
     }
 }
 
+/**
+ * Erases the tiles in the given \a region.
+ *
+ * Chunks entirely covered by the region are dropped as a whole, while the
+ * partially covered chunks are cleared row by row. Chunks that end up empty
+ * are removed afterwards, shrinking the bounds of the layer.
+ */
 void TileLayer::erase(const QRegion &region)
 {
-    const QRegion regionWithContents = region.intersected(mBounds);
+    QRegion remainingRegion = region.intersected(mBounds);
+    if (remainingRegion.isEmpty())
+        return;
+
+    QVector<QPoint> erasedChunks;
+    QRegion droppedArea;
+
+    for (const QRect &rect : std::as_const(remainingRegion)) {
+        const int left = (rect.left() + CHUNK_MASK) & ~CHUNK_MASK;
+        const int top = (rect.top() + CHUNK_MASK) & ~CHUNK_MASK;
+        const int right = (rect.right() + 1) & ~CHUNK_MASK;
+        const int bottom = (rect.bottom() + 1) & ~CHUNK_MASK;
+
+        if (left >= right || top >= bottom)
+            continue;
+
+        for (int chunkY = top; chunkY < bottom; chunkY += CHUNK_SIZE) {
+            for (int chunkX = left; chunkX < right; chunkX += CHUNK_SIZE) {
+                const QPoint key(chunkX >> CHUNK_BITS, chunkY >> CHUNK_BITS);
+                if (const Chunk *chunk = mChunks.find(key)) {
+                    if (!chunk->isEmpty())
+                        mUsedTilesetsDirty = true;
+                    erasedChunks.append(key);
+                }
+            }
+        }
+
+        droppedArea += QRect(left, top, right - left, bottom - top);
+    }
+
+    remainingRegion -= droppedArea;
+
+    const Cell emptyCells[CHUNK_SIZE];
+
+    for (const QRect &rect : std::as_const(remainingRegion)) {
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            for (int x = rect.left(); x <= rect.right(); x += CHUNK_SIZE) {
+                const int count = std::min(CHUNK_SIZE, rect.right() - x + 1);
+                setRow(x, y, count, emptyCells);
+            }
+        }
+
+        // Collect the partially erased chunks that no longer hold anything
+        for (int chunkY = rect.top() >> CHUNK_BITS; chunkY <= rect.bottom() >> CHUNK_BITS; ++chunkY) {
+            for (int chunkX = rect.left() >> CHUNK_BITS; chunkX <= rect.right() >> CHUNK_BITS; ++chunkX) {
+                const QPoint key(chunkX, chunkY);
+                const Chunk *chunk = mChunks.find(key);
+                if (chunk && !chunk->hasCell([] (const Cell &cell) { return !cell.isEmpty() || cell.checked(); }))
+                    erasedChunks.append(key);
+            }
+        }
+    }
+
+    removeChunks(erasedChunks);
+}
+
+/**
+ * Removes the chunks at the given chunk coordinates and recomputes the
+ * bounds of the layer from the remaining chunks.
+ */
+void TileLayer::removeChunks(const QVector<QPoint> &keys)
+{
+    if (keys.isEmpty())
+        return;
 
-    for (const QRect &rect : regionWithContents)
-        for (int x = rect.left(); x <= rect.right(); ++x)
-            for (int y = rect.top(); y <= rect.bottom(); ++y)
-                setCell(x, y, Cell::empty);
+    const int previousSize = mChunks.size();
+    mChunks.remove(keys);
+    if (mChunks.size() == previousSize)
+        return;
+
+    mBounds = QRect();
+    for (auto it = mChunks.cbegin(), it_end = mChunks.cend(); it != it_end; ++it)
+        mBounds |= QRect(it.key().x() * CHUNK_SIZE, it.key().y() * CHUNK_SIZE,
+                         CHUNK_SIZE, CHUNK_SIZE);
 }
 
 /**
@@ -310,44 +1323,93 @@ void TileLayer::clear()
     mUsedTilesetsDirty = false;
 }
 
-void TileLayer::flip(FlipDirection direction)
+/**
+ * Builds a lookup table for the visual flags of a cell, given a function
+ * that maps the flags of a single cell.
+ */
+template<typename Function>
+static void makeFlagMap(quint8 (&flags)[16], Function function)
 {
-    const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, mWidth, mHeight);
+    for (int f = 0; f < 16; ++f) {
+        Cell cell;
+        cell.setFlippedHorizontally(f & Cell::FlippedHorizontally);
+        cell.setFlippedVertically(f & Cell::FlippedVertically);
+        cell.setFlippedAntiDiagonally(f & Cell::FlippedAntiDiagonally);
+        cell.setRotatedHexagonal120(f & Cell::RotatedHexagonal120);
 
-    Q_ASSERT(direction == FlipHorizontally || direction == FlipVertically);
+        function(cell);
 
-    QHashIterator<QPoint, Chunk> it(mChunks);
-    while (it.hasNext()) {
-        it.next();
-        for (int y = 0; y < CHUNK_SIZE; ++y) {
-            for (int x = 0; x < CHUNK_SIZE; ++x) {
-                int _x = it.key().x() * CHUNK_SIZE + x;
-                int _y = it.key().y() * CHUNK_SIZE + y;
+        flags[f] = static_cast<quint8>(cell.flags());
+    }
+}
 
-                Cell dest(it.value().cellAt(x, y));
+/**
+ * Flips or rotates this layer by transforming each chunk in place and
+ * moving it to its new location. When the size of the mirrored dimension is
+ * not a multiple of the chunk size, the result is shifted into place
+ * afterwards.
+ */
+void TileLayer::transformChunks(const Chunk::Transform &transform)
+{
+    const int newWidth = transform.transpose ? mHeight : mWidth;
+    const int newHeight = transform.transpose ? mWidth : mHeight;
 
-                if (dest.isEmpty())
-                    continue;
+    // The mirrored dimensions, rounded up to whole chunks
+    const int chunksX = (newWidth + CHUNK_MASK) >> CHUNK_BITS;
+    const int chunksY = (newHeight + CHUNK_MASK) >> CHUNK_BITS;
 
-                if (direction == FlipHorizontally) {
-                    dest.setFlippedHorizontally(!dest.flippedHorizontally());
-                    newLayer->setCell(mWidth - _x - 1, _y, dest);
-                } else if (direction == FlipVertically) {
-                    dest.setFlippedVertically(!dest.flippedVertically());
-                    newLayer->setCell(_x, mHeight - _y - 1, dest);
-                }
-            }
-        }
+    const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, newWidth, newHeight);
+
+    for (auto it = mChunks.cbegin(), it_end = mChunks.cend(); it != it_end; ++it) {
+        QPoint key = it.key();
+        if (transform.transpose)
+            key = QPoint(key.y(), key.x());
+        if (transform.mirrorX)
+            key.setX(chunksX - 1 - key.x());
+        if (transform.mirrorY)
+            key.setY(chunksY - 1 - key.y());
+
+        Chunk chunk = it.value();
+        chunk.transform(transform);
+
+        newLayer->mChunks.insert(key, chunk);
+        newLayer->mBounds |= QRect(key.x() * CHUNK_SIZE, key.y() * CHUNK_SIZE,
+                                   CHUNK_SIZE, CHUNK_SIZE);
     }
 
+    const QPoint shift(transform.mirrorX ? newWidth - chunksX * CHUNK_SIZE : 0,
+                       transform.mirrorY ? newHeight - chunksY * CHUNK_SIZE : 0);
+    if (!shift.isNull())
+        newLayer->offsetTiles(shift);
+
+    mWidth = newWidth;
+    mHeight = newHeight;
     mChunks = newLayer->mChunks;
     mBounds = newLayer->mBounds;
 }
 
-void TileLayer::flipHexagonal(FlipDirection direction)
+void TileLayer::flip(FlipDirection direction)
 {
-    const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, mWidth, mHeight);
+    Q_ASSERT(direction == FlipHorizontally || direction == FlipVertically);
+
+    Chunk::Transform transform;
+    if (direction == FlipHorizontally) {
+        transform.mirrorX = true;
+        makeFlagMap(transform.flags, [] (Cell &cell) {
+            cell.setFlippedHorizontally(!cell.flippedHorizontally());
+        });
+    } else {
+        transform.mirrorY = true;
+        makeFlagMap(transform.flags, [] (Cell &cell) {
+            cell.setFlippedVertically(!cell.flippedVertically());
+        });
+    }
+
+    transformChunks(transform);
+}
 
+void TileLayer::flipHexagonal(FlipDirection direction)
+{
     Q_ASSERT(direction == FlipHorizontally || direction == FlipVertically);
 
     // for more info see impl "void TileLayer::rotateHexagonal(RotateDirection direction)"
@@ -356,92 +1418,40 @@ void TileLayer::flipHexagonal(FlipDirection direction)
 
     const unsigned char (&flipMask)[16] = (direction == FlipHorizontally ? flipMaskH : flipMaskV);
 
-    QHashIterator<QPoint, Chunk> it(mChunks);
-    while (it.hasNext()) {
-        it.next();
-        for (int y = 0; y < CHUNK_SIZE; ++y) {
-            for (int x = 0; x < CHUNK_SIZE; ++x) {
-                int _x = it.key().x() * CHUNK_SIZE + x;
-                int _y = it.key().y() * CHUNK_SIZE + y;
-
-                Cell dest(it.value().cellAt(x, y));
-
-                if (dest.isEmpty())
-                    continue;
-
-                unsigned char mask =
-                        (static_cast<unsigned char>(dest.flippedHorizontally()) << 3) |
-                        (static_cast<unsigned char>(dest.flippedVertically()) << 2) |
-                        (static_cast<unsigned char>(dest.flippedAntiDiagonally()) << 1) |
-                        (static_cast<unsigned char>(dest.rotatedHexagonal120()) << 0);
+    Chunk::Transform transform;
+    transform.mirrorX = direction == FlipHorizontally;
+    transform.mirrorY = direction == FlipVertically;
 
-                mask = flipMask[mask];
+    makeFlagMap(transform.flags, [&] (Cell &cell) {
+        unsigned char mask =
+                (static_cast<unsigned char>(cell.flippedHorizontally()) << 3) |
+                (static_cast<unsigned char>(cell.flippedVertically()) << 2) |
+                (static_cast<unsigned char>(cell.flippedAntiDiagonally()) << 1) |
+                (static_cast<unsigned char>(cell.rotatedHexagonal120()) << 0);
 
-                dest.setFlippedHorizontally((mask & 8) != 0);
-                dest.setFlippedVertically((mask & 4) != 0);
-                dest.setFlippedAntiDiagonally((mask & 2) != 0);
-                dest.setRotatedHexagonal120((mask & 1) != 0);
+        mask = flipMask[mask];
 
-                if (direction == FlipHorizontally)
-                    newLayer->setCell(mWidth - _x - 1, _y, dest);
-                else
-                    newLayer->setCell(_x, mHeight - _y - 1, dest);
-            }
-        }
-    }
+        cell.setFlippedHorizontally((mask & 8) != 0);
+        cell.setFlippedVertically((mask & 4) != 0);
+        cell.setFlippedAntiDiagonally((mask & 2) != 0);
+        cell.setRotatedHexagonal120((mask & 1) != 0);
+    });
 
-    mChunks = newLayer->mChunks;
-    mBounds = newLayer->mBounds;
+    transformChunks(transform);
 }
 
 void TileLayer::rotate(RotateDirection direction)
 {
-    constexpr unsigned char rotateRightMask[8] = { 5, 4, 1, 0, 7, 6, 3, 2 };
-    constexpr unsigned char rotateLeftMask[8]  = { 3, 2, 7, 6, 1, 0, 5, 4 };
-
-    const unsigned char (&rotateMask)[8] =
-            (direction == RotateRight) ? rotateRightMask : rotateLeftMask;
-
-    int newWidth = mHeight;
-    int newHeight = mWidth;
-    const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, newWidth, newHeight);
-
-    QHashIterator<QPoint, Chunk> it(mChunks);
-    while (it.hasNext()) {
-        it.next();
-        for (int y = 0; y < CHUNK_SIZE; ++y) {
-            for (int x = 0; x < CHUNK_SIZE; ++x) {
-                int _x = it.key().x() * CHUNK_SIZE + x;
-                int _y = it.key().y() * CHUNK_SIZE + y;
-
-                Cell dest(it.value().cellAt(x, y));
-
-                if (dest.isEmpty())
-                    continue;
-
-                unsigned char mask =
-                        (dest.flippedHorizontally() << 2) |
-                        (dest.flippedVertically() << 1) |
-                        (dest.flippedAntiDiagonally() << 0);
-
-                mask = rotateMask[mask];
-
-                dest.setFlippedHorizontally((mask & 4) != 0);
-                dest.setFlippedVertically((mask & 2) != 0);
-                dest.setFlippedAntiDiagonally((mask & 1) != 0);
+    // Rotating right moves (x, y) to (height - y - 1, x) and rotating left
+    // moves it to (y, width - x - 1)
+    Chunk::Transform transform;
+    transform.transpose = true;
+    transform.mirrorX = direction == RotateRight;
+    transform.mirrorY = direction == RotateLeft;
 
-                if (direction == RotateRight)
-                    newLayer->setCell(mHeight - _y - 1, _x, dest);
-                else
-                    newLayer->setCell(_y, mWidth - _x - 1, dest);
-            }
-        }
-    }
+    makeFlagMap(transform.flags, [=] (Cell &cell) { cell.rotate(direction); });
 
-    mWidth = newWidth;
-    mHeight = newHeight;
-    mChunks = newLayer->mChunks;
-    mBounds = newLayer->mBounds;
+    transformChunks(transform);
 }
 
 void TileLayer::rotateHexagonal(RotateDirection direction, Map *map)
@@ -489,9 +1499,7 @@ void TileLayer::rotateHexagonal(RotateDirection direction, Map *map)
     const unsigned char (&rotateMask)[16] =
             (direction == RotateRight) ? rotateRightMask : rotateLeftMask;
 
-    QHashIterator<QPoint, Chunk> it(mChunks);
-    while (it.hasNext()) {
-        it.next();
+    for (auto it = mChunks.cbegin(), it_end = mChunks.cend(); it != it_end; ++it) {
         for (int y = 0; y < CHUNK_SIZE; ++y) {
             for (int x = 0; x < CHUNK_SIZE; ++x) {
                 int _x = it.key().x() * CHUNK_SIZE + x;
@@ -549,13 +1557,16 @@ void TileLayer::rotateHexagonal(RotateDirection direction, Map *map)
 QSet<SharedTileset> TileLayer::usedTilesets() const
 {
     if (mUsedTilesetsDirty) {
-        QSet<SharedTileset> tilesets;
+        // Packed chunks know which of their tilesets are still referenced,
+        // so most chunks don't need their cells to be checked
+        QSet<Tileset*> referenced;
+        for (const Chunk &chunk : mChunks)
+            chunk.addUsedTilesets(referenced);
 
-        for (const Chunk &chunk : mChunks) {
-            for (const Cell &cell : chunk)
-                if (const Tile *tile = cell.tile())
-                    tilesets.insert(tile->sharedTileset());
-        }
+        QSet<SharedTileset> tilesets;
+        tilesets.reserve(referenced.size());
+        for (Tileset *tileset : std::as_const(referenced))
+            tilesets.insert(tileset->sharedFromThis());
 
         mUsedTilesets.swap(tilesets);
         mUsedTilesetsDirty = false;
@@ -564,6 +1575,29 @@ QSet<SharedTileset> TileLayer::usedTilesets() const
     return mUsedTilesets;
 }
 
+/**
+ * Switches all chunks to the most compact storage possible for their cells.
+ * This is done after loading a layer, but can also be useful after larger
+ * edits.
+ */
+void TileLayer::squeeze()
+{
+    for (Chunk &chunk : mChunks)
+        chunk.squeeze();
+}
+
+/**
+ * Returns the approximate amount of memory used to store the cells of this
+ * layer, in bytes.
+ */
+qint64 TileLayer::memoryUsage() const
+{
+    qint64 usage = sizeof(TileLayer);
+    for (const Chunk &chunk : mChunks)
+        usage += chunk.memoryUsage();
+    return usage;
+}
+
 bool TileLayer::hasCell(std::function<bool (const Cell &)> condition) const
 {
     for (const Chunk &chunk : mChunks) {
@@ -606,9 +1640,7 @@ void TileLayer::resize(QSize size, QPoint offset)
 
     // Copy over the preserved part
     QRect area = mBounds.translated(offset).intersected(newLayer->rect());
-    for (int y = area.top(); y <= area.bottom(); ++y)
-        for (int x = area.left(); x <= area.right(); ++x)
-            newLayer->setCell(x, y, cellAt(x - offset.x(), y - offset.y()));
+    newLayer->setCells(offset.x(), offset.y(), this, area);
 
     mChunks = newLayer->mChunks;
     mBounds = newLayer->mBounds;
@@ -617,11 +1649,50 @@ void TileLayer::resize(QSize size, QPoint offset)
     setSize(size);
 }
 
-static int clampWrap(int value, int min, int max)
+namespace {
+
+/**
+ * A part of a row or column of cells that is pulled from a contiguous range
+ * of cells when offsetting tiles.
+ */
+struct OffsetSegment
+{
+    int first;      // first target cell
+    int last;       // last target cell
+    int source;     // source of the first target cell
+};
+
+} // anonymous namespace
+
+/**
+ * Splits the range from \a first to \a last into the segments that are
+ * pulled from a contiguous source range when offsetting by \a offset. Without
+ * wrapping, the part that would be pulled from outside the range is left out.
+ *
+ * Returns the number of segments, which is at most two.
+ */
+static int offsetSegments(int first, int last, int offset, bool wrap,
+                          OffsetSegment segments[2])
 {
-    int v = value - min;
-    int d = max - min;
-    return (v < 0 ? (v + 1) % d + d - 1 : v % d) + min;
+    if (wrap) {
+        const int size = last - first + 1;
+        const int shift = (offset % size + size) % size;
+        int count = 0;
+
+        if (shift > 0)
+            segments[count++] = { first, first + shift - 1, last - shift + 1 };
+        segments[count++] = { first + shift, last, first };
+
+        return count;
+    }
+
+    const int start = std::max(first, first + offset);
+    const int end = std::min(last, last + offset);
+    if (start > end)
+        return 0;
+
+    segments[0] = { start, end, start - offset };
+    return 1;
 }
 
 void TileLayer::offsetTiles(QPoint offset,
@@ -631,30 +1702,38 @@ void TileLayer::offsetTiles(QPoint offset,
     if (offset.isNull())
         return;
 
+    if (bounds.isEmpty())
+        return;
+
     const std::unique_ptr<TileLayer> newLayer(clone());
 
-    for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
-        for (int x = bounds.left(); x <= bounds.right(); ++x) {
-            // Get position to pull tile value from
-            int oldX = x - offset.x();
-            int oldY = y - offset.y();
+    // Each combination of a horizontal and a vertical segment is a rectangle
+    // that is copied from a single source rectangle. This allows the copy to
+    // share whole chunks when the offset is chunk-aligned, and to copy rows
+    // of cells otherwise.
+    OffsetSegment columns[2];
+    OffsetSegment rows[2];
+    const int columnCount = offsetSegments(bounds.left(), bounds.right(), offset.x(), wrapX, columns);
+    const int rowCount = offsetSegments(bounds.top(), bounds.bottom(), offset.y(), wrapY, rows);
 
-            // Wrap x value that will be pulled from
-            if (wrapX)
-                oldX = clampWrap(oldX, bounds.left(), bounds.right() + 1);
+    QRegion uncoveredArea(bounds);
 
-            // Wrap y value that will be pulled from
-            if (wrapY)
-                oldY = clampWrap(oldY, bounds.top(), bounds.bottom() + 1);
+    for (int i = 0; i < columnCount; ++i) {
+        for (int j = 0; j < rowCount; ++j) {
+            const QRect area(QPoint(columns[i].first, rows[j].first),
+                             QPoint(columns[i].last, rows[j].last));
 
-            // Set the new tile
-            if (bounds.contains(oldX, oldY))
-                newLayer->setCell(x, y, cellAt(oldX, oldY));
-            else
-                newLayer->setCell(x, y, Cell::empty);
+            newLayer->setCells(columns[i].first - columns[i].source,
+                               rows[j].first - rows[j].source,
+                               this, area);
+
+            uncoveredArea -= area;
         }
     }
 
+    // Clear the part that was pulled from outside of the bounds
+    newLayer->erase(uncoveredArea);
+
     mChunks = newLayer->mChunks;
     mBounds = newLayer->mBounds;
     mUsedTilesets = newLayer->mUsedTilesets;
@@ -663,26 +1742,17 @@ void TileLayer::offsetTiles(QPoint offset,
 
 void TileLayer::offsetTiles(QPoint offset)
 {
-    const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, 0, 0);
+    const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, mWidth, mHeight);
 
     // Process only the allocated chunks
-    QHashIterator<QPoint, Chunk> it(mChunks);
-    while (it.hasNext()) {
-        it.next();
+    for (auto it = mChunks.cbegin(), it_end = mChunks.cend(); it != it_end; ++it) {
 
         const QPoint p = it.key();
-        const Chunk &chunk = it.value();
         const QRect r(p.x() * CHUNK_SIZE,
                       p.y() * CHUNK_SIZE,
                       CHUNK_SIZE, CHUNK_SIZE);
 
-        for (int y = r.top(); y <= r.bottom(); ++y) {
-            for (int x = r.left(); x <= r.right(); ++x) {
-                int newX = x + offset.x();
-                int newY = y + offset.y();
-                newLayer->setCell(newX, newY, chunk.cellAt(x - r.left(), y - r.top()));
-            }
-        }
+        newLayer->setCells(offset.x(), offset.y(), this, r.translated(offset));
     }
 
     mChunks = newLayer->mChunks;
@@ -718,13 +1788,51 @@ Layer *TileLayer::mergedWith(const Layer *other) const
 
 QRegion TileLayer::computeDiffRegion(const TileLayer &other) const
 {
-    QRegion ret;
+    TileRegion ret;
 
     const int dx = other.x() - mX;
     const int dy = other.y() - mY;
 
     const QRect r = bounds().united(other.bounds()).translated(-position());
 
+    // When the layers are aligned to the chunk grid, they are compared chunk
+    // by chunk, which skips over chunks that have the same cells
+    if ((dx & CHUNK_MASK) == 0 && (dy & CHUNK_MASK) == 0) {
+        const QPoint chunkOffset(dx >> CHUNK_BITS, dy >> CHUNK_BITS);
+        const Chunk emptyChunk;
+
+        auto addDiffSpans = [&] (QPoint key, const Chunk &a, const Chunk &b) {
+            const int startX = key.x() * CHUNK_SIZE;
+            const int startY = key.y() * CHUNK_SIZE;
+
+            for (int y = 0; y < CHUNK_SIZE; ++y) {
+                for (int x = 0; x < CHUNK_SIZE; ++x) {
+                    if (a.cellAt(x, y) != b.cellAt(x, y)) {
+                        const int rangeStart = x;
+                        while (x < CHUNK_SIZE && a.cellAt(x, y) != b.cellAt(x, y))
+                            ++x;
+                        ret.addSpan(startX + rangeStart, startY + y, x - rangeStart);
+                    }
+                }
+            }
+        };
+
+        for (auto it = mChunks.begin(), end = mChunks.end(); it != end; ++it) {
+            const Chunk *otherChunk = other.mChunks.find(it.key() - chunkOffset);
+            const Chunk &b = otherChunk ? *otherChunk : emptyChunk;
+            if (!it->hasSameCells(b))
+                addDiffSpans(it.key(), it.value(), b);
+        }
+
+        for (auto it = other.mChunks.begin(), end = other.mChunks.end(); it != end; ++it) {
+            const QPoint key = it.key() + chunkOffset;
+            if (!mChunks.find(key) && !it->isEmpty())
+                addDiffSpans(key, emptyChunk, it.value());
+        }
+
+        return ret.intersected(TileRegion(r)).toRegion();
+    }
+
     for (int y = r.top(); y <= r.bottom(); ++y) {
         for (int x = r.left(); x <= r.right(); ++x) {
             if (cellAt(x, y) != other.cellAt(x - dx, y - dy)) {
@@ -734,12 +1842,12 @@ QRegion TileLayer::computeDiffRegion(const TileLayer &other) const
                     ++x;
                 }
                 const int rangeEnd = x;
-                ret += QRect(rangeStart, y, rangeEnd - rangeStart, 1);
+                ret.addSpan(rangeStart, y, rangeEnd - rangeStart);
             }
         }
     }
 
-    return ret;
+    return ret.toRegion();
 }
 
 bool TileLayer::isEmpty() const
@@ -776,9 +1884,7 @@ QVector<QRect> TileLayer::sortedChunksToWrite(QSize chunkSize) const
     if (isNativeChunkSize)
         chunksToWrite.reserve(mChunks.size());
 
-    QHashIterator<QPoint, Chunk> it(mChunks);
-    while (it.hasNext()) {
-        it.next();
+    for (auto it = mChunks.cbegin(), it_end = mChunks.cend(); it != it_end; ++it) {
         const Chunk &chunk = it.value();
         if (chunk.isEmpty())
             continue;
@@ -35,14 +35,18 @@
 #include "tiled.h"
 #include "tile.h"
 #include "tileset.h"
+#include "tileregion.h"
 
 #include <QHash>
 #include <QMargins>
 #include <QPoint>
+#include <QSet>
 #include <QSharedPointer>
 #include <QString>
+#include <QVarLengthArray>
 #include <QVector>
 
+#include <algorithm>
 #include <functional>
 
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
@@ -135,6 +139,8 @@ public:
     static Cell empty;
 
 private:
+    friend class Chunk;
+
     Tileset *_tileset = nullptr;
     int _tileId = -1;
     int _flags = 0;
@@ -167,124 +173,452 @@ inline bool Cell::refersTile(const Tile *tile) const
 
 /**
  * A Chunk is a grid of cells of size CHUNK_SIZExCHUNK_SIZE.
+ *
+ * The cells are implicitly shared, so copying a chunk is cheap until either
+ * copy is modified.
+ *
+ * To save memory, the cells are stored packed into 32 bits each, referring to
+ * their tileset by an index into a small per-chunk list of tilesets. When a
+ * cell does not fit this representation (for example because its tile ID is
+ * very large, or the chunk refers to too many tilesets), the chunk falls back
+ * to storing the cells unpacked.
+ *
+ * A chunk in which all cells are the same (including a chunk that is
+ * entirely empty) stores only that single cell. It is expanded to a full grid
+ * on the first write of a different cell.
  */
 class TILEDSHARED_EXPORT Chunk
 {
 public:
-    Chunk() :
-        mGrid(CHUNK_SIZE * CHUNK_SIZE)
-    {}
+    class const_iterator
+    {
+    public:
+        const_iterator(const Chunk *chunk, int index)
+            : mChunk(chunk)
+            , mIndex(index)
+        {}
 
-    QRegion region(std::function<bool (const Cell &)> condition) const;
+        const_iterator operator++(int)
+        {
+            const_iterator it = *this;
+            ++mIndex;
+            return it;
+        }
+
+        const_iterator &operator++()
+        {
+            ++mIndex;
+            return *this;
+        }
+
+        Cell operator*() const { return mChunk->cellAtIndex(mIndex); }
+
+        friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
+        {
+            return lhs.mChunk == rhs.mChunk && lhs.mIndex == rhs.mIndex;
+        }
+
+        friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
 
-    const Cell &cellAt(int x, int y) const;
-    const Cell &cellAt(QPoint point) const;
+    private:
+        const Chunk *mChunk;
+        int mIndex;
+    };
+
+    /**
+     * Describes a flip or rotation of the cells of a chunk. The positions of
+     * the cells are first transposed (when \c transpose is set) and then
+     * mirrored. The visual flags of non-empty cells are mapped through
+     * \c flags, while empty cells are cleared.
+     */
+    struct Transform
+    {
+        bool transpose = false;
+        bool mirrorX = false;
+        bool mirrorY = false;
+        quint8 flags[16] = {};  // new visual flags, indexed by the old ones
+    };
+
+    /**
+     * Common conditions, for which matching cells can be found without
+     * unpacking them.
+     */
+    enum CellFilter {
+        NonEmptyCells,
+        NonEmptyOrCheckedCells,
+    };
+
+    Chunk() = default;
+
+    TileRegion region(std::function<bool (const Cell &)> condition) const;
+    TileRegion regionOfCell(const Cell &cell) const;
+
+    template<typename Function>
+    void forEachRun(int y, CellFilter filter, Function function) const;
+
+    Cell cellAt(int x, int y) const;
+    Cell cellAt(QPoint point) const;
+
+    void copyRow(int x, int y, int count, Cell *cells) const;
 
     void setCell(int x, int y, const Cell &cell);
+    void setRow(int x, int y, int count, const Cell *cells);
+
+    void fill(const Cell &cell);
+    void squeeze();
+
+    qint64 memoryUsage() const;
 
     bool isEmpty() const;
 
     bool hasCell(std::function<bool (const Cell &)> condition) const;
+    bool hasSameCells(const Chunk &other) const;
+
+    bool referencesTileset(const Tileset *tileset) const;
+    void addUsedTilesets(QSet<Tileset*> &tilesets) const;
 
     void removeReferencesToTileset(Tileset *tileset);
 
     void replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTileset);
 
-    QVector<Cell>::iterator begin() { return mGrid.begin(); }
-    QVector<Cell>::iterator end() { return mGrid.end(); }
-    QVector<Cell>::const_iterator begin() const { return mGrid.begin(); }
-    QVector<Cell>::const_iterator end() const { return mGrid.end(); }
+    void transform(const Transform &transform);
+
+    /**
+     * Returns whether all cells of this chunk are the same. In this case,
+     * only a single cell is stored.
+     */
+    bool isUniform() const { return mPackedCells.isEmpty() && mCells.isEmpty(); }
+
+    /**
+     * Returns whether the cells of this chunk are stored packed.
+     */
+    bool isPacked() const { return !mPackedCells.isEmpty(); }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, CHUNK_SIZE * CHUNK_SIZE); }
 
 private:
-    QVector<Cell> mGrid;
+    // Layout of a packed cell, from least to most significant bits
+    static constexpr int FlagBits = 5;
+    static constexpr int TilesetBits = 8;
+    static constexpr int TileIdBits = 32 - FlagBits - TilesetBits;
+
+    static constexpr int TilesetShift = FlagBits;
+    static constexpr int TileIdShift = FlagBits + TilesetBits;
+
+    static constexpr quint32 FlagMask = (1u << FlagBits) - 1;
+    static constexpr quint32 TilesetMask = (1u << TilesetBits) - 1;
+
+    static constexpr int MaxTilesets = TilesetMask;     // index 0 means "no tileset"
+    static constexpr int MaxTileId = (1 << TileIdBits) - 2;
+
+    Cell cellAtIndex(int index) const;
+
+    static bool isIdentical(const Cell &a, const Cell &b)
+    {
+        return a._tileset == b._tileset
+                && a._tileId == b._tileId
+                && a._flags == b._flags;
+    }
+
+    static int packedTilesetIndex(quint32 packed)
+    { return static_cast<int>((packed >> TilesetShift) & TilesetMask); }
+
+    bool pack(const Cell &cell, quint32 &packed);
+    Cell unpack(quint32 packed) const;
+    void expand();
+    void unpackAll();
+    void compactTilesets();
+    void countTilesetCells();
+    void replacePacked(quint32 &target, quint32 packed);
+
+    Cell mUniformCell;
+    QVector<quint32> mPackedCells;
+    QVector<Tileset*> mTilesets;
+    QVector<quint16> mTilesetCellCounts;    // cells referring to each of mTilesets
+    QVector<Cell> mCells;
 };
 
-inline const Cell &Chunk::cellAt(int x, int y) const
+inline Cell Chunk::cellAt(int x, int y) const
 {
-    return mGrid.at(x + y * CHUNK_SIZE);
+    return cellAtIndex(x + y * CHUNK_SIZE);
 }
 
-inline const Cell &Chunk::cellAt(QPoint point) const
+inline Cell Chunk::cellAt(QPoint point) const
 {
     return cellAt(point.x(), point.y());
 }
 
 /**
- * A tile layer is a grid of cells. Each cell refers to a specific tile, and
- * stores how the tile is flipped.
+ * Copies \a count cells starting at \a x, \a y into \a cells. The cells
+ * must all be within the same row of this chunk.
+ */
+inline void Chunk::copyRow(int x, int y, int count, Cell *cells) const
+{
+    Q_ASSERT(x >= 0 && x + count <= CHUNK_SIZE);
+
+    const int index = x + y * CHUNK_SIZE;
+
+    if (isPacked()) {
+        const quint32 *packed = mPackedCells.constData() + index;
+        for (int i = 0; i < count; ++i)
+            cells[i] = unpack(packed[i]);
+    } else if (isUniform()) {
+        std::fill(cells, cells + count, mUniformCell);
+    } else {
+        std::copy_n(mCells.constData() + index, count, cells);
+    }
+}
+
+/**
+ * Calls \a function with the start and length of each run of cells on row
+ * \a y that match the given \a filter.
+ */
+template<typename Function>
+inline void Chunk::forEachRun(int y, CellFilter filter, Function function) const
+{
+    if (isUniform()) {
+        const bool matches = !mUniformCell.isEmpty() ||
+                (filter == NonEmptyOrCheckedCells && mUniformCell.checked());
+        if (matches)
+            function(0, CHUNK_SIZE);
+        return;
+    }
+
+    if (isPacked()) {
+        // A cell is non-empty when it refers to a tileset
+        quint32 mask = TilesetMask << TilesetShift;
+        if (filter == NonEmptyOrCheckedCells)
+            mask |= Cell::Checked;
+
+        const quint32 *packed = mPackedCells.constData() + y * CHUNK_SIZE;
+
+        for (int x = 0; x < CHUNK_SIZE; ++x) {
+            if (packed[x] & mask) {
+                const int runStart = x;
+                while (x < CHUNK_SIZE && (packed[x] & mask))
+                    ++x;
+                function(runStart, x - runStart);
+            }
+        }
+        return;
+    }
+
+    const Cell *cells = mCells.constData() + y * CHUNK_SIZE;
+    auto matches = [filter] (const Cell &cell) {
+        return !cell.isEmpty() || (filter == NonEmptyOrCheckedCells && cell.checked());
+    };
+
+    for (int x = 0; x < CHUNK_SIZE; ++x) {
+        if (matches(cells[x])) {
+            const int runStart = x;
+            while (x < CHUNK_SIZE && matches(cells[x]))
+                ++x;
+            function(runStart, x - runStart);
+        }
+    }
+}
+
+inline Cell Chunk::cellAtIndex(int index) const
+{
+    if (isPacked())
+        return unpack(mPackedCells.at(index));
+    if (isUniform())
+        return mUniformCell;
+
+    return mCells.at(index);
+}
+
+inline Cell Chunk::unpack(quint32 packed) const
+{
+    Cell cell;
+
+    if (const int tilesetIndex = packedTilesetIndex(packed))
+        cell._tileset = mTilesets.at(tilesetIndex - 1);
+
+    cell._tileId = static_cast<int>(packed >> TileIdShift) - 1;
+    cell._flags = static_cast<int>(packed & FlagMask);
+
+    return cell;
+}
+
+/**
+ * A map from chunk coordinates to chunks, used by TileLayer.
  *
- * Coordinates and regions passed to function parameters are in local
- * coordinates and do not take into account the position of the layer.
+ * Chunks within the dense area (normally the area covered by the layer) are
+ * looked up in a grid, which is the common case for maps of a fixed size.
+ * Other chunks are looked up in an open-addressing hash table. The chunks
+ * themselves are stored contiguously, in the order they were added.
  */
-class TILEDSHARED_EXPORT TileLayer : public Layer
+class TILEDSHARED_EXPORT ChunkMap
 {
 public:
-    class iterator
+    class const_iterator
     {
     public:
-        iterator(QHash<QPoint, Chunk>::iterator it, QHash<QPoint, Chunk>::iterator end)
-            : mChunkPointer(it)
-            , mChunkEndPointer(end)
-        {
-            if (it != end)
-                mCellPointer = it.value().begin();
-        }
+        const_iterator(const ChunkMap *map, int index)
+            : mMap(map)
+            , mIndex(index)
+        {}
 
-        iterator operator++(int)
-        {
-            iterator it = *this;
-            advance();
-            return it;
-        }
+        const_iterator &operator++() { ++mIndex; return *this; }
+        const_iterator operator++(int) { const_iterator it = *this; ++mIndex; return it; }
 
-        iterator &operator++()
-        {
-            advance();
-            return *this;
-        }
+        const Chunk &operator*() const { return value(); }
+        const Chunk *operator->() const { return &value(); }
 
-        Cell &operator*() { return *mCellPointer; }
+        friend bool operator==(const const_iterator &lhs, const const_iterator &rhs)
+        { return lhs.mIndex == rhs.mIndex; }
+        friend bool operator!=(const const_iterator &lhs, const const_iterator &rhs)
+        { return lhs.mIndex != rhs.mIndex; }
 
-        QVector<Cell>::iterator operator->() const { return mCellPointer; }
+        QPoint key() const { return mMap->mKeys.at(mIndex); }
+        const Chunk &value() const { return mMap->mChunks.at(mIndex); }
 
-        friend bool operator==(const iterator& lhs, const iterator& rhs)
-        {
-            if (lhs.mChunkPointer == lhs.mChunkEndPointer || rhs.mChunkPointer == rhs.mChunkEndPointer)
-                return lhs.mChunkPointer == rhs.mChunkPointer;
+    private:
+        const ChunkMap *mMap;
+        int mIndex;
+    };
 
-            return lhs.mCellPointer == rhs.mCellPointer;
-        }
+    class iterator
+    {
+    public:
+        iterator(ChunkMap *map, int index)
+            : mMap(map)
+            , mIndex(index)
+        {}
 
-        friend bool operator!=(const iterator& lhs, const iterator& rhs)
-        {
-            if (lhs.mChunkPointer == lhs.mChunkEndPointer || rhs.mChunkPointer == rhs.mChunkEndPointer)
-                return lhs.mChunkPointer != rhs.mChunkPointer;
+        iterator &operator++() { ++mIndex; return *this; }
+        iterator operator++(int) { iterator it = *this; ++mIndex; return it; }
 
-            return lhs.mCellPointer != rhs.mCellPointer;
-        }
+        Chunk &operator*() const { return value(); }
+        Chunk *operator->() const { return &value(); }
 
-        Cell &value() const { return *mCellPointer; }
+        friend bool operator==(const iterator &lhs, const iterator &rhs)
+        { return lhs.mIndex == rhs.mIndex; }
+        friend bool operator!=(const iterator &lhs, const iterator &rhs)
+        { return lhs.mIndex != rhs.mIndex; }
 
-        QPoint key() const;
+        QPoint key() const { return mMap->mKeys.at(mIndex); }
+        Chunk &value() const { return mMap->mChunks[mIndex]; }
 
     private:
-        void advance();
-
-        QHash<QPoint, Chunk>::iterator mChunkPointer;
-        QHash<QPoint, Chunk>::iterator mChunkEndPointer;
-        QVector<Cell>::iterator mCellPointer;
+        ChunkMap *mMap;
+        int mIndex;
     };
 
+    void setDenseArea(QRect tileArea);
+
+    /**
+     * Returns the area, in chunk coordinates, in which chunks are looked up
+     * in a grid.
+     */
+    QRect denseArea() const { return mDenseArea; }
+
+    int size() const { return mChunks.size(); }
+    bool isEmpty() const { return mChunks.isEmpty(); }
+
+    void clear();
+
+    const Chunk *find(QPoint key) const;
+    Chunk *find(QPoint key);
+
+    Chunk &operator[](QPoint key);
+    void insert(QPoint key, const Chunk &chunk);
+    void remove(const QVector<QPoint> &keys);
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, mChunks.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, mChunks.size()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+private:
+    // Maximum number of chunks for which a grid index is used, which covers
+    // layers up to 8192x8192 tiles and takes 1 MB
+    static constexpr int MaxDenseChunks = 1 << 18;
+
+    int indexOf(QPoint key) const;
+    int append(QPoint key, const Chunk &chunk);
+    void insertSparse(int index);
+    void rebuildIndex();
+
+    static uint hashKey(QPoint key)
+    {
+        // Mixing both coordinates, since neighboring chunks are common
+        return (static_cast<uint>(key.x()) * 0x9E3779B1u) ^
+               (static_cast<uint>(key.y()) * 0x85EBCA77u);
+    }
+
+    QVector<Chunk> mChunks;
+    QVector<QPoint> mKeys;
+
+    QRect mDenseArea;
+    QVector<int> mDenseIndex;
+
+    QVector<int> mSparseIndex;
+    int mSparseCount = 0;
+};
+
+inline int ChunkMap::indexOf(QPoint key) const
+{
+    if (mDenseArea.contains(key)) {
+        return mDenseIndex.at((key.y() - mDenseArea.y()) * mDenseArea.width() +
+                              key.x() - mDenseArea.x());
+    }
+
+    if (mSparseCount == 0)
+        return -1;
+
+    const int mask = mSparseIndex.size() - 1;
+    for (int slot = hashKey(key) & mask;; slot = (slot + 1) & mask) {
+        const int index = mSparseIndex.at(slot);
+        if (index == -1 || mKeys.at(index) == key)
+            return index;
+    }
+}
+
+inline const Chunk *ChunkMap::find(QPoint key) const
+{
+    const int index = indexOf(key);
+    return index != -1 ? &mChunks.at(index) : nullptr;
+}
+
+inline Chunk *ChunkMap::find(QPoint key)
+{
+    const int index = indexOf(key);
+    return index != -1 ? &mChunks[index] : nullptr;
+}
+
+inline Chunk &ChunkMap::operator[](QPoint key)
+{
+    int index = indexOf(key);
+    if (index == -1)
+        index = append(key, Chunk());
+    return mChunks[index];
+}
+
+/**
+ * A tile layer is a grid of cells. Each cell refers to a specific tile, and
+ * stores how the tile is flipped.
+ *
+ * Coordinates and regions passed to function parameters are in local
+ * coordinates and do not take into account the position of the layer.
+ */
+class TILEDSHARED_EXPORT TileLayer : public Layer
+{
+public:
     class const_iterator
     {
     public:
-        const_iterator(QHash<QPoint, Chunk>::const_iterator it, QHash<QPoint, Chunk>::const_iterator end)
+        const_iterator(ChunkMap::const_iterator it, ChunkMap::const_iterator end)
             : mChunkPointer(it)
             , mChunkEndPointer(end)
-        {
-            if (it != end)
-                mCellPointer = it.value().begin();
-        }
+        {}
 
         const_iterator operator++(int)
         {
@@ -299,38 +633,40 @@ public:
             return *this;
         }
 
-        const Cell &operator*() { return *mCellPointer; }
-
-        QVector<Cell>::const_iterator operator->() const { return mCellPointer; }
+        Cell operator*() const { return value(); }
 
         friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
         {
             if (lhs.mChunkPointer == lhs.mChunkEndPointer || rhs.mChunkPointer == rhs.mChunkEndPointer)
                 return lhs.mChunkPointer == rhs.mChunkPointer;
 
-            return lhs.mCellPointer == rhs.mCellPointer;
+            return lhs.mChunkPointer == rhs.mChunkPointer && lhs.mCellIndex == rhs.mCellIndex;
         }
 
         friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs)
         {
-            if (lhs.mChunkPointer == lhs.mChunkEndPointer || rhs.mChunkPointer == rhs.mChunkEndPointer)
-                return lhs.mChunkPointer != rhs.mChunkPointer;
-
-            return lhs.mCellPointer != rhs.mCellPointer;
+            return !(lhs == rhs);
         }
 
-        const Cell &value() const { return *mCellPointer; }
+        Cell value() const
+        {
+            return mChunkPointer.value().cellAt(mCellIndex & CHUNK_MASK,
+                                                mCellIndex >> CHUNK_BITS);
+        }
 
         QPoint key() const;
 
     private:
         void advance();
 
-        QHash<QPoint, Chunk>::const_iterator mChunkPointer;
-        QHash<QPoint, Chunk>::const_iterator mChunkEndPointer;
-        QVector<Cell>::const_iterator mCellPointer;
+        ChunkMap::const_iterator mChunkPointer;
+        ChunkMap::const_iterator mChunkEndPointer;
+        int mCellIndex = 0;
     };
 
+    // Cells can't be modified through iterators, since they may be stored packed
+    using iterator = const_iterator;
+
     /**
      * Constructor.
      */
@@ -380,12 +716,19 @@ public:
 
     QRegion region(std::function<bool (const Cell &)> condition) const;
     QRegion region() const;
+    QRegion regionOfCell(const Cell &cell) const;
     QRegion modifiedRegion() const;
 
-    const Cell &cellAt(int x, int y) const;
-    const Cell &cellAt(QPoint point) const;
+    Cell cellAt(int x, int y) const;
+    Cell cellAt(QPoint point) const;
+
+    template<typename Function>
+    void forEachSpan(QRect rect, Function function) const;
+    template<typename Function>
+    void forEachSpan(const QRegion &region, Function function) const;
 
     void setCell(int x, int y, const Cell &cell);
+    void setRow(int x, int y, int count, const Cell *cells);
 
     /**
      * Returns a copy of the area specified by the given \a region. The
@@ -458,6 +801,10 @@ public:
      */
     QSet<SharedTileset> usedTilesets() const override;
 
+    void squeeze();
+
+    qint64 memoryUsage() const;
+
     /**
      * Returns whether this tile layer has any cell for which the given
      * \a condition returns true.
@@ -521,8 +868,6 @@ public:
 
     TileLayer *clone() const override;
 
-    iterator begin() { return iterator(mChunks.begin(), mChunks.end()); }
-    iterator end() { return iterator(mChunks.end(), mChunks.end()); }
     const_iterator begin() const { return const_iterator(mChunks.begin(), mChunks.end()); }
     const_iterator end() const { return const_iterator(mChunks.end(), mChunks.end()); }
 
@@ -532,56 +877,31 @@ protected:
     TileLayer *initializeClone(TileLayer *clone) const;
 
 private:
+    void setChunk(int x, int y, const Chunk *chunk);
+    void removeChunks(const QVector<QPoint> &keys);
+    void transformChunks(const Chunk::Transform &transform);
+
     int mWidth;
     int mHeight;
-    QHash<QPoint, Chunk> mChunks;
+    ChunkMap mChunks;
     QRect mBounds;
     mutable QSet<SharedTileset> mUsedTilesets;
     mutable bool mUsedTilesetsDirty;
 };
 
-inline QPoint TileLayer::iterator::key() const
-{
-    const QPoint chunkPos = mChunkPointer.key();
-    QPoint tilePos = QPoint(chunkPos.x() * CHUNK_SIZE,
-                            chunkPos.y() * CHUNK_SIZE);
-
-    const auto index = std::distance(mChunkPointer.value().begin(), mCellPointer);
-    tilePos += QPoint(index & CHUNK_MASK, index / CHUNK_SIZE);
-
-    return tilePos;
-}
-
-inline void TileLayer::iterator::advance()
-{
-    if (mChunkPointer != mChunkEndPointer) {
-        if (++mCellPointer == mChunkPointer.value().end()) {
-            mChunkPointer++;
-            if (mChunkPointer != mChunkEndPointer)
-                mCellPointer = mChunkPointer.value().begin();
-        }
-    }
-}
-
 inline QPoint TileLayer::const_iterator::key() const
 {
     const QPoint chunkPos = mChunkPointer.key();
-    QPoint tilePos = QPoint(chunkPos.x() * CHUNK_SIZE,
-                            chunkPos.y() * CHUNK_SIZE);
-
-    const auto index = std::distance(mChunkPointer.value().begin(), mCellPointer);
-    tilePos += QPoint(index & CHUNK_MASK, index / CHUNK_SIZE);
-
-    return tilePos;
+    return QPoint(chunkPos.x() * CHUNK_SIZE + (mCellIndex & CHUNK_MASK),
+                  chunkPos.y() * CHUNK_SIZE + (mCellIndex >> CHUNK_BITS));
 }
 
 inline void TileLayer::const_iterator::advance()
 {
     if (mChunkPointer != mChunkEndPointer) {
-        if (++mCellPointer == mChunkPointer.value().end()) {
+        if (++mCellIndex == CHUNK_SIZE * CHUNK_SIZE) {
             mChunkPointer++;
-            if (mChunkPointer != mChunkEndPointer)
-                mCellPointer = mChunkPointer.value().begin();
+            mCellIndex = 0;
         }
     }
 }
@@ -593,6 +913,7 @@ inline void TileLayer::setSize(QSize size)
 {
     mWidth = size.width();
     mHeight = size.height();
+    mChunks.setDenseArea(QRect(0, 0, mWidth, mHeight));
 }
 
 inline bool TileLayer::contains(int x, int y) const
@@ -614,45 +935,84 @@ inline Chunk& TileLayer::chunk(int x, int y)
 inline const Chunk* TileLayer::findChunk(int x, int y) const
 {
     const QPoint chunkCoordinates(x >> CHUNK_BITS, y >> CHUNK_BITS);
-    auto it = mChunks.find(chunkCoordinates);
-    return it != mChunks.end() ? &it.value() : nullptr;
+    return mChunks.find(chunkCoordinates);
 }
 
 /**
- * Calculates the region occupied by the tiles of this layer. Similar to
- * Layer::bounds(), but leaves out the regions without tiles.
+ * Returns the cell at the given coordinates. Coordinates outside of the
+ * allocated area return an empty cell.
  */
-inline QRegion TileLayer::region() const
+inline Cell TileLayer::cellAt(int x, int y) const
 {
-    return region([] (const Cell &cell) { return !cell.isEmpty(); });
+    if (const Chunk *chunk = findChunk(x, y))
+        return chunk->cellAt(x & CHUNK_MASK, y & CHUNK_MASK);
+
+    return Cell::empty;
 }
 
-/**
- * Calculates the modified region of this layer. This includes both all
- * non-empty cells as well as any cells that were marked as "checked".
- */
-inline QRegion TileLayer::modifiedRegion() const
+inline Cell TileLayer::cellAt(QPoint point) const
 {
-    return region([] (const Cell &cell) {
-        return !cell.isEmpty() || cell.checked();
-    });
+    return cellAt(point.x(), point.y());
 }
 
 /**
- * Returns a read-only reference to the cell at the given coordinates. The
- * coordinates have to be within this layer.
+ * Calls \a function for each span of cells within \a rect. A span is a
+ * horizontal run of cells that are part of the same chunk, and the function
+ * is called with the location of its first cell, a pointer to its cells and
+ * the number of cells in the span:
+ *
+ *   void function(int x, int y, const Cell *cells, int count);
+ *
+ * The spans are visited in row-major order. Areas without allocated chunks
+ * are passed as spans of empty cells.
+ *
+ * This is much faster than calling cellAt() for each cell, since each chunk
+ * is only looked up once.
  */
-inline const Cell &TileLayer::cellAt(int x, int y) const
+template<typename Function>
+inline void TileLayer::forEachSpan(QRect rect, Function function) const
 {
-    if (const Chunk *chunk = findChunk(x, y))
-        return chunk->cellAt(x & CHUNK_MASK, y & CHUNK_MASK);
+    if (rect.isEmpty())
+        return;
 
-    return Cell::empty;
+    const int firstChunkX = rect.left() >> CHUNK_BITS;
+    const int lastChunkX = rect.right() >> CHUNK_BITS;
+
+    QVarLengthArray<const Chunk*, 64> chunks(lastChunkX - firstChunkX + 1);
+    Cell cells[CHUNK_SIZE];
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        // Look up the chunks once for each row of chunks
+        if (y == rect.top() || (y & CHUNK_MASK) == 0)
+            for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX)
+                chunks[chunkX - firstChunkX] = findChunk(chunkX << CHUNK_BITS, y);
+
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            const int chunkStartX = chunkX << CHUNK_BITS;
+            const int startX = std::max(rect.left(), chunkStartX);
+            const int endX = std::min(rect.right(), chunkStartX + CHUNK_MASK);
+            const int count = endX - startX + 1;
+
+            if (const Chunk *chunk = chunks[chunkX - firstChunkX])
+                chunk->copyRow(startX & CHUNK_MASK, y & CHUNK_MASK, count, cells);
+            else
+                std::fill(cells, cells + count, Cell::empty);
+
+            function(startX, y, static_cast<const Cell*>(cells), count);
+        }
+    }
 }
 
-inline const Cell &TileLayer::cellAt(QPoint point) const
+/**
+ * Calls \a function for each span of cells within \a region.
+ *
+ * \overload
+ */
+template<typename Function>
+inline void TileLayer::forEachSpan(const QRegion &region, Function function) const
 {
-    return cellAt(point.x(), point.y());
+    for (const QRect &rect : region)
+        forEachSpan(rect, function);
 }
 
 inline void TileLayer::setCells(int x, int y, const TileLayer *tileLayer)
@@ -0,0 +1,303 @@
+/*
+ * tilelayerlod.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tilelayerlod.h"
+
+#include "map.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QPainter>
+#include <QtMath>
+
+#include <cmath>
+
+namespace Tiled {
+
+/**
+ * The deepest level, at which a block of 32x32 pixel tiles is rendered at
+ * 16x16 pixels.
+ */
+static constexpr int MaximumLevel = 7;
+
+static quint64 imageKey(QPoint block, int level)
+{
+    return (quint64(quint32(block.x())) << 32) |
+            (quint64(quint32(block.y()) & 0xFFFFFF) << 8) |
+            quint64(level);
+}
+
+static int floorDiv(int value, int divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+static qsizetype cost(const QPixmap &pixmap)
+{
+    return qMax<qsizetype>(1, qsizetype(pixmap.width()) * pixmap.height() * pixmap.depth() / (8 * 1024));
+}
+
+TileLayerLod::TileLayerLod(const TileLayer *layer)
+    : mLayer(layer)
+    , mImages(32 * 1024)    // up to 32 MB
+{
+}
+
+/**
+ * Returns the level to use for drawing at the given \a scale, in device
+ * pixels per map pixel. Returns -1 when the scale is too high for using
+ * a level of detail.
+ */
+int TileLayerLod::levelForScale(qreal scale)
+{
+    if (scale >= MaximumScale || scale <= 0)
+        return -1;
+
+    // Use the level with the smallest scale that is still at least as
+    // large as the requested one, to avoid upscaling
+    const int level = static_cast<int>(std::floor(std::log2(MaximumScale / scale)));
+    return qBound(0, level, MaximumLevel);
+}
+
+qreal TileLayerLod::scaleForLevel(int level)
+{
+    return MaximumScale / (1 << level);
+}
+
+/**
+ * Draws the blocks intersecting the \a exposed rectangle, using the level
+ * of detail appropriate for the given \a scale.
+ */
+void TileLayerLod::draw(QPainter *painter, const MapRenderer *renderer,
+                        const QRectF &exposed, qreal scale)
+{
+    const int level = levelForScale(scale);
+    if (level < 0) {
+        renderer->drawTileLayer(painter, mLayer, exposed);
+        return;
+    }
+
+    const QColor tintColor = mLayer->effectiveTintColor();
+    if (mRenderer != renderer || mFlags != renderer->flags() || mTintColor != tintColor) {
+        invalidate();
+        mRenderer = renderer;
+        mFlags = renderer->flags();
+        mTintColor = tintColor;
+    }
+
+    // Determine the range of blocks to consider, including some margin for
+    // tiles extending beyond their cell
+    const QRectF area = exposed.marginsAdded(QMarginsF(mLayer->drawMargins()));
+    QPointF corners[] = {
+        area.topLeft(), area.topRight(), area.bottomLeft(), area.bottomRight()
+    };
+    renderer->screenToTileCoords(corners, corners, 4);
+
+    qreal minX = corners[0].x(), maxX = minX;
+    qreal minY = corners[0].y(), maxY = minY;
+    for (const QPointF &corner : corners) {
+        minX = std::min(minX, corner.x());
+        maxX = std::max(maxX, corner.x());
+        minY = std::min(minY, corner.y());
+        maxY = std::max(maxY, corner.y());
+    }
+
+    QRect cells(QPoint(static_cast<int>(std::floor(minX)) - 1, static_cast<int>(std::floor(minY)) - 1),
+                QPoint(static_cast<int>(std::ceil(maxX)) + 1, static_cast<int>(std::ceil(maxY)) + 1));
+    cells.translate(-mLayer->position());
+    cells &= mLayer->localBounds();
+    if (cells.isEmpty())
+        return;
+
+    const int firstBlockX = floorDiv(cells.left(), BlockSize);
+    const int firstBlockY = floorDiv(cells.top(), BlockSize);
+    const int lastBlockX = floorDiv(cells.right(), BlockSize);
+    const int lastBlockY = floorDiv(cells.bottom(), BlockSize);
+
+    const qreal levelScale = scaleForLevel(level);
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+
+    for (int y = firstBlockY; y <= lastBlockY; ++y) {
+        for (int x = firstBlockX; x <= lastBlockX; ++x) {
+            const QPoint block(x, y);
+            const QRect blockRect = blockCells(block);
+            if (blockRect.isEmpty())
+                continue;
+
+            const QRectF bounds = blockBounds(blockRect, renderer);
+            if (!bounds.intersects(exposed))
+                continue;
+
+            const quint64 key = imageKey(block, level);
+
+            if (const QPixmap *cached = mImages.object(key)) {
+                if (!cached->isNull())
+                    painter->drawPixmap(bounds, *cached, cached->rect());
+                continue;
+            }
+
+            const QSize size(std::max(1, qCeil(bounds.width() * levelScale)),
+                             std::max(1, qCeil(bounds.height() * levelScale)));
+
+            // Reduce the next finer level when available, which is much
+            // cheaper than rendering the cells again
+            QPixmap pixmap;
+            if (const QPixmap *finer = level > 0 ? mImages.object(imageKey(block, level - 1)) : nullptr)
+                pixmap = finer->isNull() ? QPixmap() : finer->scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            else
+                pixmap = renderBlock(blockRect, bounds, size, renderer);
+
+            if (!pixmap.isNull())
+                painter->drawPixmap(bounds, pixmap, pixmap.rect());
+
+            mImages.insert(key, new QPixmap(pixmap), cost(pixmap));
+        }
+    }
+
+    painter->restore();
+}
+
+/**
+ * Discards all rendered images.
+ */
+void TileLayerLod::invalidate()
+{
+    mImages.clear();
+}
+
+/**
+ * Discards the images of the blocks containing any of the cells in the
+ * given \a region (in map coordinates).
+ */
+void TileLayerLod::invalidate(const QRegion &region)
+{
+    // Tiles extending beyond their cell may also affect neighboring blocks
+    const QMargins drawMargins = mLayer->drawMargins();
+    const QSize tileSize = mLayer->map() ? mLayer->map()->tileSize() : QSize(1, 1);
+    const int marginX = tileSize.width() > 0 ? qCeil(qreal(std::max(drawMargins.left(), drawMargins.right())) / tileSize.width()) : 0;
+    const int marginY = tileSize.height() > 0 ? qCeil(qreal(std::max(drawMargins.top(), drawMargins.bottom())) / tileSize.height()) : 0;
+
+    for (const QRect &rect : region) {
+        const QRect cells = rect.translated(-mLayer->position())
+                .adjusted(-marginX, -marginY, marginX, marginY);
+
+        for (int y = floorDiv(cells.top(), BlockSize); y <= floorDiv(cells.bottom(), BlockSize); ++y)
+            for (int x = floorDiv(cells.left(), BlockSize); x <= floorDiv(cells.right(), BlockSize); ++x)
+                for (int level = 0; level <= MaximumLevel; ++level)
+                    mImages.remove(imageKey(QPoint(x, y), level));
+    }
+}
+
+/**
+ * Returns the cells of the given \a block that are within the bounds of the
+ * layer, in layer coordinates.
+ */
+QRect TileLayerLod::blockCells(QPoint block) const
+{
+    const QRect rect(block * BlockSize, QSize(BlockSize, BlockSize));
+    return rect & mLayer->localBounds();
+}
+
+/**
+ * Returns the area in pixels covered by the given \a cells, including any
+ * tiles extending beyond their cell.
+ */
+QRectF TileLayerLod::blockBounds(const QRect &cells, const MapRenderer *renderer) const
+{
+    const QRect rect = renderer->boundingRect(cells.translated(mLayer->position()));
+
+    QMargins margins = mLayer->drawMargins();
+    if (const Map *map = mLayer->map()) {
+        margins.setTop(qMax(0, margins.top() - map->tileHeight()));
+        margins.setRight(qMax(0, margins.right() - map->tileWidth()));
+    }
+
+    return QRectF(rect.marginsAdded(margins));
+}
+
+/**
+ * Renders the given \a cells, covering \a bounds, to an image of the given
+ * \a size. Only the cells of the block are rendered, so that the images of
+ * neighboring blocks don't overlap with each other's tiles. Returns a null
+ * pixmap for blocks without any tiles.
+ */
+QPixmap TileLayerLod::renderBlock(const QRect &cells, const QRectF &bounds,
+                                  QSize size, const MapRenderer *renderer) const
+{
+    const bool hasChunks = [&] {
+        for (int y = cells.top() & ~CHUNK_MASK; y <= cells.bottom(); y += CHUNK_SIZE)
+            for (int x = cells.left() & ~CHUNK_MASK; x <= cells.right(); x += CHUNK_SIZE)
+                if (mLayer->findChunk(x, y))
+                    return true;
+        return false;
+    }();
+
+    if (!hasChunks)
+        return QPixmap();
+
+    QPixmap pixmap(size);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.scale(size.width() / bounds.width(), size.height() / bounds.height());
+    painter.translate(-bounds.topLeft());
+
+    const QSize tileSize = renderer->map()->tileSize();
+    const QPoint position = mLayer->position();
+    const QRect mapCells = cells.translated(position);
+
+    CellRenderer cellRenderer(&painter, renderer, mLayer->effectiveTintColor());
+
+    auto renderTile = [&] (QPoint tilePos, const QPointF &screenPos) {
+        if (!mapCells.contains(tilePos))
+            return;
+
+        const Cell &cell = mLayer->cellAt(tilePos - position);
+        if (cell.isEmpty())
+            return;
+
+        QSize size = tileSize;
+        if (cell.tileset()->tileRenderSize() == Tileset::TileSize) {
+            if (const Tile *tile = cell.tile())
+                size = tile->size();
+        }
+
+        cellRenderer.render(cell, screenPos, size, CellRenderer::BottomLeft);
+    };
+
+    renderer->drawTileLayer(renderTile, QRectF(renderer->boundingRect(mapCells)));
+    cellRenderer.flush();
+
+    return pixmap;
+}
+
+} // namespace Tiled
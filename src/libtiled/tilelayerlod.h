@@ -0,0 +1,96 @@
+/*
+ * tilelayerlod.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "maprenderer.h"
+#include "tiled_global.h"
+
+#include <QCache>
+#include <QColor>
+#include <QPixmap>
+#include <QRegion>
+
+namespace Tiled {
+
+class TileLayer;
+
+/**
+ * Renders a tile layer at a low level of detail, for when it is displayed
+ * far zoomed out.
+ *
+ * The layer is divided in blocks of cells, which are rendered to images at
+ * a reduced scale. Each further level halves the scale. The images are
+ * cached and drawn instead of the individual cells, so the cost of drawing
+ * depends on the size of the viewport rather than the number of cells.
+ *
+ * Images are only rendered when they are needed. When cells change, only
+ * the images of the affected blocks need to be rendered again.
+ */
+class TILEDSHARED_EXPORT TileLayerLod
+{
+    Q_DISABLE_COPY(TileLayerLod)
+
+public:
+    explicit TileLayerLod(const TileLayer *layer);
+
+    /**
+     * The highest scale at which the level of detail rendering is used.
+     */
+    static constexpr qreal MaximumScale = 0.25;
+
+    /**
+     * The width and height of a block, in cells.
+     */
+    static constexpr int BlockSize = 64;
+
+    void draw(QPainter *painter, const MapRenderer *renderer,
+              const QRectF &exposed, qreal scale);
+
+    void invalidate();
+    void invalidate(const QRegion &region);
+
+    static int levelForScale(qreal scale);
+    static qreal scaleForLevel(int level);
+
+private:
+    QRect blockCells(QPoint block) const;
+    QRectF blockBounds(const QRect &cells, const MapRenderer *renderer) const;
+    QPixmap renderBlock(const QRect &cells, const QRectF &bounds,
+                        QSize size, const MapRenderer *renderer) const;
+
+    const TileLayer *mLayer;
+    QCache<quint64, QPixmap> mImages;
+
+    // The settings the cached images were rendered with
+    const MapRenderer *mRenderer = nullptr;
+    RenderFlags mFlags;
+    QColor mTintColor;
+};
+
+} // namespace Tiled
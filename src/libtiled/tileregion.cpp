@@ -0,0 +1,358 @@
+/*
+ * tileregion.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tileregion.h"
+
+#include <algorithm>
+#include <climits>
+
+using namespace Tiled;
+
+static bool spanLessThan(const QRect &a, const QRect &b)
+{
+    return a.y() < b.y() || (a.y() == b.y() && a.x() < b.x());
+}
+
+/**
+ * Combines the spans \a a to \a aEnd with the spans \a b to \a bEnd, which
+ * are all on row \a y, appending the result to \a result.
+ *
+ * This sweeps over the edges of the spans, keeping track of whether the
+ * current position is within either of the inputs, and letting \a op
+ * determine whether it is part of the result.
+ */
+template<typename Op>
+static void combineRow(const QRect *a, const QRect *aEnd,
+                       const QRect *b, const QRect *bEnd,
+                       int y, Op op, QVector<QRect> &result)
+{
+    bool inA = false;
+    bool inB = false;
+    bool inResult = false;
+    int start = 0;
+
+    while (a != aEnd || b != bEnd) {
+        const int edgeA = a != aEnd ? (inA ? a->right() + 1 : a->left()) : INT_MAX;
+        const int edgeB = b != bEnd ? (inB ? b->right() + 1 : b->left()) : INT_MAX;
+        const int x = std::min(edgeA, edgeB);
+
+        if (edgeA == x) {
+            if (inA)
+                ++a;
+            inA = !inA;
+        }
+        if (edgeB == x) {
+            if (inB)
+                ++b;
+            inB = !inB;
+        }
+
+        const bool in = op(inA, inB);
+        if (in != inResult) {
+            if (in)
+                start = x;
+            else
+                result.append(QRect(start, y, x - start, 1));
+            inResult = in;
+        }
+    }
+
+    Q_ASSERT(!inResult);
+}
+
+/**
+ * Combines the sorted spans \a a and \a b row by row.
+ */
+template<typename Op>
+static QVector<QRect> combine(const QVector<QRect> &a, const QVector<QRect> &b, Op op)
+{
+    QVector<QRect> result;
+    result.reserve(std::max(a.size(), b.size()));
+
+    const QRect *aIt = a.constBegin();
+    const QRect *bIt = b.constBegin();
+
+    while (aIt != a.constEnd() || bIt != b.constEnd()) {
+        int y;
+        if (aIt == a.constEnd())
+            y = bIt->y();
+        else if (bIt == b.constEnd())
+            y = aIt->y();
+        else
+            y = std::min(aIt->y(), bIt->y());
+
+        const QRect *aRowEnd = aIt;
+        while (aRowEnd != a.constEnd() && aRowEnd->y() == y)
+            ++aRowEnd;
+
+        const QRect *bRowEnd = bIt;
+        while (bRowEnd != b.constEnd() && bRowEnd->y() == y)
+            ++bRowEnd;
+
+        combineRow(aIt, aRowEnd, bIt, bRowEnd, y, op, result);
+
+        aIt = aRowEnd;
+        bIt = bRowEnd;
+    }
+
+    return result;
+}
+
+TileRegion::TileRegion(const QRect &rect)
+{
+    addRect(rect);
+}
+
+TileRegion::TileRegion(const QRegion &region)
+{
+    // The rectangles of a QRegion are sorted in bands of equal top and
+    // height, so the spans can be added in order band by band
+    const QRect *it = region.begin();
+    const QRect *end = region.end();
+
+    while (it != end) {
+        const QRect *bandEnd = it;
+        while (bandEnd != end && bandEnd->top() == it->top())
+            ++bandEnd;
+
+        for (int y = it->top(); y <= it->bottom(); ++y)
+            for (const QRect *rect = it; rect != bandEnd; ++rect)
+                addSpan(rect->x(), y, rect->width());
+
+        it = bandEnd;
+    }
+}
+
+/**
+ * Adds the span of \a width tiles starting at \a x, \a y to this region.
+ */
+void TileRegion::addSpan(int x, int y, int width)
+{
+    if (width <= 0)
+        return;
+
+    if (mNormalized && !mSpans.isEmpty()) {
+        QRect &last = mSpans.last();
+
+        if (last.y() == y && x >= last.x()) {
+            // Extend the last span when the new span overlaps or touches it
+            if (x <= last.right() + 1) {
+                if (x + width - 1 > last.right())
+                    last.setRight(x + width - 1);
+                return;
+            }
+        } else if (y <= last.y()) {
+            mNormalized = false;
+        }
+    }
+
+    mSpans.append(QRect(x, y, width, 1));
+}
+
+/**
+ * Adds the given \a rect to this region.
+ */
+void TileRegion::addRect(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y)
+        addSpan(rect.x(), y, rect.width());
+}
+
+bool TileRegion::contains(QPoint point) const
+{
+    normalize();
+
+    // Find the last span starting at or before the point
+    const QRect pointSpan(point, QSize(1, 1));
+    auto it = std::upper_bound(mSpans.cbegin(), mSpans.cend(), pointSpan, spanLessThan);
+    if (it == mSpans.cbegin())
+        return false;
+
+    --it;
+    return it->y() == point.y() && it->right() >= point.x();
+}
+
+QRect TileRegion::boundingRect() const
+{
+    normalize();
+
+    if (mSpans.isEmpty())
+        return QRect();
+
+    int left = INT_MAX;
+    int right = INT_MIN;
+    for (const QRect &span : std::as_const(mSpans)) {
+        left = std::min(left, span.left());
+        right = std::max(right, span.right());
+    }
+
+    return QRect(QPoint(left, mSpans.first().y()),
+                 QPoint(right, mSpans.last().y()));
+}
+
+/**
+ * Returns the number of tiles in this region.
+ */
+qint64 TileRegion::area() const
+{
+    normalize();
+
+    qint64 area = 0;
+    for (const QRect &span : std::as_const(mSpans))
+        area += span.width();
+    return area;
+}
+
+TileRegion TileRegion::united(const TileRegion &other) const
+{
+    if (other.isEmpty())
+        return *this;
+    if (isEmpty())
+        return other;
+
+    TileRegion result;
+    result.mSpans = combine(spans(), other.spans(), [] (bool a, bool b) { return a || b; });
+    return result;
+}
+
+TileRegion TileRegion::intersected(const TileRegion &other) const
+{
+    if (isEmpty() || other.isEmpty())
+        return TileRegion();
+
+    TileRegion result;
+    result.mSpans = combine(spans(), other.spans(), [] (bool a, bool b) { return a && b; });
+    return result;
+}
+
+TileRegion TileRegion::subtracted(const TileRegion &other) const
+{
+    if (isEmpty() || other.isEmpty())
+        return *this;
+
+    TileRegion result;
+    result.mSpans = combine(spans(), other.spans(), [] (bool a, bool b) { return a && !b; });
+    return result;
+}
+
+TileRegion TileRegion::translated(QPoint offset) const
+{
+    TileRegion result(*this);
+    for (QRect &span : result.mSpans)
+        span.translate(offset);
+    return result;
+}
+
+bool TileRegion::operator==(const TileRegion &other) const
+{
+    return spans() == other.spans();
+}
+
+/**
+ * Converts this region to a QRegion.
+ *
+ * Consecutive rows with the same spans are combined into bands, which is
+ * the representation used by QRegion, so it doesn't need to do any
+ * additional work.
+ */
+QRegion TileRegion::toRegion() const
+{
+    normalize();
+
+    QVector<QRect> rects;
+    rects.reserve(mSpans.size());
+
+    int bandStart = 0;      // index of the first rect in the current band
+    int rowStart = 0;       // index of the first span in the previous row
+    int rowCount = 0;       // number of spans in the previous row
+
+    for (int i = 0; i < mSpans.size();) {
+        const int y = mSpans.at(i).y();
+
+        int rowEnd = i;
+        while (rowEnd < mSpans.size() && mSpans.at(rowEnd).y() == y)
+            ++rowEnd;
+
+        // Check whether this row extends the current band
+        bool extendsBand = !rects.isEmpty()
+                && rects.last().bottom() + 1 == y
+                && rowEnd - i == rowCount;
+
+        for (int j = 0; extendsBand && j < rowCount; ++j) {
+            const QRect &span = mSpans.at(i + j);
+            const QRect &previous = mSpans.at(rowStart + j);
+            extendsBand = span.left() == previous.left() && span.right() == previous.right();
+        }
+
+        if (extendsBand) {
+            for (int j = bandStart; j < rects.size(); ++j)
+                rects[j].setBottom(y);
+        } else {
+            bandStart = rects.size();
+            rects.append(mSpans.mid(i, rowEnd - i));
+        }
+
+        rowStart = i;
+        rowCount = rowEnd - i;
+        i = rowEnd;
+    }
+
+    QRegion region;
+    region.setRects(rects.constData(), rects.size());
+    return region;
+}
+
+/**
+ * Sorts the spans and merges the ones that overlap or touch, after spans
+ * were added out of order.
+ */
+void TileRegion::normalize() const
+{
+    if (mNormalized)
+        return;
+
+    std::sort(mSpans.begin(), mSpans.end(), spanLessThan);
+
+    int count = 0;
+    for (const QRect &span : std::as_const(mSpans)) {
+        if (count > 0) {
+            QRect &last = mSpans[count - 1];
+            if (last.y() == span.y() && span.left() <= last.right() + 1) {
+                last.setRight(std::max(last.right(), span.right()));
+                continue;
+            }
+        }
+        mSpans[count++] = span;
+    }
+
+    mSpans.resize(count);
+    mNormalized = true;
+}
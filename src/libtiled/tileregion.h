@@ -0,0 +1,107 @@
+/*
+ * tileregion.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QRect>
+#include <QRegion>
+#include <QVector>
+
+namespace Tiled {
+
+/**
+ * A region in tile space, stored as horizontal spans of tiles.
+ *
+ * The spans are kept sorted by row and column, which allows combining
+ * regions in linear time and makes the cost of operations independent of
+ * how irregular the shape is. This is unlike QRegion, which is slow to
+ * build up from many small parts.
+ *
+ * Spans can be added in any order, but adding them sorted is fastest.
+ */
+class TILEDSHARED_EXPORT TileRegion
+{
+public:
+    TileRegion() = default;
+    TileRegion(const QRect &rect);
+    explicit TileRegion(const QRegion &region);
+
+    void addSpan(int x, int y, int width);
+    void addRect(const QRect &rect);
+
+    bool isEmpty() const;
+    bool contains(QPoint point) const;
+    QRect boundingRect() const;
+    qint64 area() const;
+
+    const QVector<QRect> &spans() const;
+
+    TileRegion united(const TileRegion &other) const;
+    TileRegion intersected(const TileRegion &other) const;
+    TileRegion subtracted(const TileRegion &other) const;
+    TileRegion translated(QPoint offset) const;
+
+    TileRegion operator|(const TileRegion &other) const { return united(other); }
+    TileRegion operator&(const TileRegion &other) const { return intersected(other); }
+    TileRegion operator-(const TileRegion &other) const { return subtracted(other); }
+
+    TileRegion &operator|=(const TileRegion &other) { return *this = united(other); }
+    TileRegion &operator&=(const TileRegion &other) { return *this = intersected(other); }
+    TileRegion &operator-=(const TileRegion &other) { return *this = subtracted(other); }
+
+    bool operator==(const TileRegion &other) const;
+    bool operator!=(const TileRegion &other) const { return !(*this == other); }
+
+    QRegion toRegion() const;
+
+private:
+    void normalize() const;
+
+    // Spans of height 1, sorted by row and then by column when normalized.
+    // Spans in the same row never overlap or touch.
+    mutable QVector<QRect> mSpans;
+    mutable bool mNormalized = true;
+};
+
+inline bool TileRegion::isEmpty() const
+{
+    return mSpans.isEmpty();
+}
+
+/**
+ * Returns the spans of this region, sorted by row and then by column.
+ */
+inline const QVector<QRect> &TileRegion::spans() const
+{
+    normalize();
+    return mSpans;
+}
+
+} // namespace Tiled
@@ -29,6 +29,8 @@
 
 #include "tileset.h"
 
+#include "imagecache.h"
+#include "objectgroup.h"
 #include "tile.h"
 #include "tilesetmanager.h"
 #include "wangset.h"
@@ -115,13 +117,13 @@ int Tileset::findTileLocation(Tile *tile) const
  */
 Tile *Tileset::findOrCreateTile(int id)
 {
-    if (Tile *tile = mTilesById.value(id))
+    if (Tile *tile = findTile(id))
         return tile;
 
     mNextTileId = std::max(mNextTileId, id + 1);
 
     auto tile = new Tile(id, this);
-    mTilesById[id] = tile;
+    insertTileById(tile);
     mTiles.append(tile);
 
     return tile;
@@ -138,6 +140,29 @@ int Tileset::rowCount() const
     return rowCountForHeight(mImageReference.size.height());
 }
 
+/**
+ * Returns the approximate amount of memory used by this tileset, including
+ * its decoded images, tiles and properties, in bytes. The images may be
+ * shared with the ImageCache.
+ */
+qint64 Tileset::memoryUsage() const
+{
+    qint64 usage = sizeof(Tileset)
+            + ImageCache::memoryCost(mImage)
+            + propertiesMemoryUsage(properties());
+
+    for (const Tile *tile : mTiles) {
+        usage += sizeof(Tile)
+                + ImageCache::memoryCost(tile->image())
+                + propertiesMemoryUsage(tile->properties());
+
+        if (const ObjectGroup *objectGroup = tile->objectGroup())
+            usage += objectGroup->memoryUsage();
+    }
+
+    return usage;
+}
+
 /**
  * Sets the transparent color. Pixels with this color will be masked out
  * when loadFromImage() is called.
@@ -195,6 +220,7 @@ bool Tileset::loadFromImage(const QImage &image, const QUrl &source)
     }
 
     mImage = QPixmap::fromImage(image);
+    mImageMaskColor = QColor();
 
     initializeTilesetTiles();
 
@@ -235,7 +261,18 @@ bool Tileset::loadFromImage(const QString &fileName)
 bool Tileset::loadImage()
 {
     if (mImageReference.hasImage()) {
-        mImage = mImageReference.create();
+        const QString fileName = Tiled::urlToLocalFileOrQrc(mImageReference.source);
+        const QColor &transparentColor = mImageReference.transparentColor;
+
+        // Share the masked pixels with other tilesets using the same image
+        if (!fileName.isEmpty() && transparentColor.isValid()) {
+            mImage = ImageCache::loadPixmap(fileName, transparentColor);
+            mImageMaskColor = transparentColor;
+        } else {
+            mImage = mImageReference.create();
+            mImageMaskColor = QColor();
+        }
+
         if (mImage.isNull()) {
             mImageReference.status = LoadingError;
             return false;
@@ -250,8 +287,11 @@ bool Tileset::initializeTilesetTiles()
     if (mImage.isNull() || mTileWidth <= 0 || mTileHeight <= 0)
         return false;
 
-    if (mImageReference.transparentColor.isValid())
-        mImage.setMask(mImage.createMaskFromColor(mImageReference.transparentColor));
+    const QColor &transparentColor = mImageReference.transparentColor;
+    if (transparentColor.isValid() && transparentColor != mImageMaskColor) {
+        mImage.setMask(mImage.createMaskFromColor(transparentColor));
+        mImageMaskColor = transparentColor;
+    }
 
     QVector<QRect> tileRects;
 
@@ -259,6 +299,8 @@ bool Tileset::initializeTilesetTiles()
         for (int x = mMargin; x <= mImage.width() - mTileWidth; x += mTileWidth + mTileSpacing)
             tileRects.append(QRect(x, y, mTileWidth, mTileHeight));
 
+    mTileSizeCountsValid = false;
+
     for (int tileNum = 0; tileNum < tileRects.size(); ++tileNum) {
         auto it = mTilesById.find(tileNum);
         if (it != mTilesById.end()) {
@@ -267,7 +309,7 @@ bool Tileset::initializeTilesetTiles()
         } else {
             auto tile = new Tile(tileNum, this);
             tile->setImageRect(tileRects.at(tileNum));
-            mTilesById.insert(tileNum, tile);
+            insertTileById(tile);
             mTiles.insert(tileNum, tile);
         }
     }
@@ -433,8 +475,10 @@ Tile *Tileset::addTile(const QPixmap &image, const QUrl &source, const QRect &re
     newTile->setImageSource(source);
     newTile->setImageRect(rect.isNull() ? image.rect() : rect);
 
-    mTilesById.insert(newTile->id(), newTile);
+    insertTileById(newTile);
     mTiles.append(newTile);
+    if (mTileSizeCountsValid)
+        countTileSize(newTile->size());
     if (mTileHeight < newTile->height())
         mTileHeight = newTile->height();
     if (mTileWidth < newTile->width())
@@ -451,11 +495,16 @@ void Tileset::addTiles(const QList<Tile *> &tiles)
 {
     for (Tile *tile : tiles) {
         Q_ASSERT(tile->tileset() == this && !mTilesById.contains(tile->id()));
-        mTilesById.insert(tile->id(), tile);
+        insertTileById(tile);
         mTiles.append(tile);
+        if (mTileSizeCountsValid)
+            countTileSize(tile->size());
     }
 
-    updateTileSize();
+    if (mTileSizeCountsValid)
+        applyTileSizeCounts();
+    else
+        updateTileSize();
 }
 
 /**
@@ -467,11 +516,16 @@ void Tileset::removeTiles(const QList<Tile *> &tiles)
 {
     for (Tile *tile : tiles) {
         Q_ASSERT(tile->tileset() == this && mTilesById.contains(tile->id()));
-        mTilesById.remove(tile->id());
+        takeTileById(tile->id());
         mTiles.removeOne(tile);
+        if (mTileSizeCountsValid && !uncountTileSize(tile->size()))
+            mTileSizeCountsValid = false;
     }
 
-    updateTileSize();
+    if (mTileSizeCountsValid)
+        applyTileSizeCounts();
+    else
+        updateTileSize();
 }
 
 /**
@@ -479,8 +533,10 @@ void Tileset::removeTiles(const QList<Tile *> &tiles)
  */
 void Tileset::deleteTile(int id)
 {
-    auto tile = mTilesById.take(id);
+    auto tile = takeTileById(id);
     mTiles.removeOne(tile);
+    if (tile && mTileSizeCountsValid && !uncountTileSize(tile->size()))
+        mTileSizeCountsValid = false;
     delete tile;
 }
 
@@ -542,6 +598,27 @@ void Tileset::setTileImage(Tile *tile,
     maybeUpdateTileSize(previousTileSize, tile->size());
 }
 
+/**
+ * Sets the image \a source of the given \a tile, leaving the loading of
+ * the image until it is first needed. The \a size of the image needs to be
+ * known up front, since it affects the tile size of the tileset.
+ *
+ * Like setTileImage(), this is only expected to be used for image collection
+ * tilesets.
+ */
+void Tileset::setTileImageSource(Tile *tile,
+                                 const QUrl &source,
+                                 QSize size)
+{
+    Q_ASSERT(isCollection());
+    Q_ASSERT(mTilesById.value(tile->id()) == tile);
+
+    const QSize previousTileSize = tile->size();
+    tile->setPendingImage(source, size);
+
+    maybeUpdateTileSize(previousTileSize, tile->size());
+}
+
 void Tileset::setTileImageRect(Tile *tile, const QRect &imageRect)
 {
     Q_ASSERT(mTilesById.value(tile->id()) == tile);
@@ -557,6 +634,17 @@ void Tileset::maybeUpdateTileSize(QSize previousTileSize, QSize newTileSize)
     if (previousTileSize == newTileSize)
         return;
 
+    if (mTileSizeCountsValid) {
+        if (uncountTileSize(previousTileSize)) {
+            countTileSize(newTileSize);
+            applyTileSizeCounts();
+            return;
+        }
+
+        // The counts are out of date, so they get rebuilt below
+        mTileSizeCountsValid = false;
+    }
+
     // Update our max. tile size
     if (previousTileSize.height() == mTileHeight ||
             previousTileSize.width() == mTileWidth) {
@@ -603,6 +691,9 @@ void Tileset::swap(Tileset &other)
     std::swap(mImageReference, other.mImageReference);
     std::swap(mTileWidth, other.mTileWidth);
     std::swap(mTileHeight, other.mTileHeight);
+    std::swap(mTileWidthCounts, other.mTileWidthCounts);
+    std::swap(mTileHeightCounts, other.mTileHeightCounts);
+    std::swap(mTileSizeCountsValid, other.mTileSizeCountsValid);
     std::swap(mTileSpacing, other.mTileSpacing);
     std::swap(mMargin, other.mMargin);
     std::swap(mTileOffset, other.mTileOffset);
@@ -615,6 +706,7 @@ void Tileset::swap(Tileset &other)
     std::swap(mExpectedColumnCount, other.mExpectedColumnCount);
     std::swap(mExpectedRowCount, other.mExpectedRowCount);
     std::swap(mTilesById, other.mTilesById);
+    std::swap(mDenseTiles, other.mDenseTiles);
     std::swap(mTiles, other.mTiles);
     std::swap(mNextTileId, other.mNextTileId);
     std::swap(mWangSets, other.mWangSets);
@@ -657,10 +749,9 @@ SharedTileset Tileset::clone() const
     c->mTransformationFlags = mTransformationFlags;
 
     for (auto tile : mTiles) {
-        const int id = tile->id();
         Tile *clonedTile = tile->clone(c.data());
 
-        c->mTilesById.insert(id, clonedTile);
+        c->insertTileById(clonedTile);
         c->mTiles.append(clonedTile);
     }
 
@@ -672,26 +763,103 @@ SharedTileset Tileset::clone() const
     // the tileset when it calls TilesetManager::tilesetImageSourceChanged.
     c->setImageReference(mImageReference);
     c->mImage = mImage;
+    c->mImageMaskColor = mImageMaskColor;
 
     return c;
 }
 
+/**
+ * Adds the given \a tile to the lookup by ID.
+ */
+void Tileset::insertTileById(Tile *tile)
+{
+    const int id = tile->id();
+    mTilesById.insert(id, tile);
+
+    if (id < 0)
+        return;
+
+    if (id < mDenseTiles.size()) {
+        mDenseTiles[id] = tile;
+        return;
+    }
+
+    // Grow the dense index only as long as it stays mostly occupied
+    if (id >= 2 * mTilesById.size() + 64)
+        return;
+
+    const int previousSize = mDenseTiles.size();
+    mDenseTiles.resize(id + 1);
+
+    // Tiles that were previously beyond the covered range
+    for (auto it = mTilesById.lowerBound(previousSize); it != mTilesById.end() && it.key() <= id; ++it)
+        mDenseTiles[it.key()] = it.value();
+}
+
+/**
+ * Removes the tile with the given \a id from the lookup by ID and returns
+ * it, if there was one.
+ */
+Tile *Tileset::takeTileById(int id)
+{
+    if (id >= 0 && id < mDenseTiles.size())
+        mDenseTiles[id] = nullptr;
+
+    return mTilesById.take(id);
+}
+
 /**
  * Sets tile size to the maximum size.
+ *
+ * This counts the tiles by size, after which the maximum is maintained
+ * incrementally as tiles are added, removed or resized.
  */
 void Tileset::updateTileSize()
 {
-    int maxWidth = 0;
-    int maxHeight = 0;
-    for (Tile *tile : std::as_const(mTiles)) {
-        const QSize size = tile->size();
-        if (maxWidth < size.width())
-            maxWidth = size.width();
-        if (maxHeight < size.height())
-            maxHeight = size.height();
-    }
-    mTileWidth = maxWidth;
-    mTileHeight = maxHeight;
+    mTileWidthCounts.clear();
+    mTileHeightCounts.clear();
+
+    for (Tile *tile : std::as_const(mTiles))
+        countTileSize(tile->size());
+
+    mTileSizeCountsValid = true;
+    applyTileSizeCounts();
+}
+
+/**
+ * Sets the tile size to the largest width and height that is counted.
+ */
+void Tileset::applyTileSizeCounts()
+{
+    Q_ASSERT(mTileSizeCountsValid);
+
+    mTileWidth = std::max(0, mTileWidthCounts.isEmpty() ? 0 : mTileWidthCounts.lastKey());
+    mTileHeight = std::max(0, mTileHeightCounts.isEmpty() ? 0 : mTileHeightCounts.lastKey());
+}
+
+void Tileset::countTileSize(QSize size)
+{
+    ++mTileWidthCounts[size.width()];
+    ++mTileHeightCounts[size.height()];
+}
+
+/**
+ * Removes a tile of the given \a size from the counts. Returns false when
+ * no tile of that size was counted, which means the counts are out of date.
+ */
+bool Tileset::uncountTileSize(QSize size)
+{
+    auto widthIt = mTileWidthCounts.find(size.width());
+    auto heightIt = mTileHeightCounts.find(size.height());
+    if (widthIt == mTileWidthCounts.end() || heightIt == mTileHeightCounts.end())
+        return false;
+
+    if (--widthIt.value() == 0)
+        mTileWidthCounts.erase(widthIt);
+    if (--heightIt.value() == 0)
+        mTileHeightCounts.erase(heightIt);
+
+    return true;
 }
 
 
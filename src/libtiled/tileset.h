@@ -176,6 +176,8 @@ public:
     Tile *findOrCreateTile(int id);
     int tileCount() const;
 
+    qint64 memoryUsage() const;
+
     int columnCount() const;
     int rowCount() const;
     void setColumnCount(int columnCount);
@@ -238,6 +240,9 @@ public:
     void setTileImage(Tile *tile,
                       const QPixmap &image,
                       const QUrl &source = QUrl());
+    void setTileImageSource(Tile *tile,
+                            const QUrl &source,
+                            QSize size);
     void setTileImageRect(Tile *tile, const QRect &imageRect);
 
     /**
@@ -294,13 +299,20 @@ public:
     static FillMode fillModeFromString(const QString &);
 
 private:
+    void insertTileById(Tile *tile);
+    Tile *takeTileById(int id);
+
     void maybeUpdateTileSize(QSize oldSize, QSize newSize);
     void updateTileSize();
+    void applyTileSizeCounts();
+    void countTileSize(QSize size);
+    bool uncountTileSize(QSize size);
 
     QString mName;
     QString mFileName;
     ImageReference mImageReference;
     QPixmap mImage;
+    QColor mImageMaskColor;     // transparent color already masked out of mImage
     int mTileWidth;
     int mTileHeight;
     int mTileSpacing;
@@ -317,6 +329,17 @@ private:
     int mNextTileId = 0;
     QMap<int, Tile*> mTilesById;
     QList<Tile*> mTiles;
+
+    // Index of the tiles by ID, since findTile is very hot. It covers the
+    // IDs below its size, while larger IDs are only in mTilesById.
+    QVector<Tile*> mDenseTiles;
+
+    // Number of tiles by width and height, to maintain the max. tile size
+    // of image collections without rescanning all tiles. Only built once
+    // needed and dropped when tiles may have been changed directly.
+    QMap<int, int> mTileWidthCounts;
+    QMap<int, int> mTileHeightCounts;
+    bool mTileSizeCountsValid = false;
     QList<WangSet*> mWangSets;
     LoadingStatus mStatus = LoadingReady;
     QColor mBackgroundColor;
@@ -513,6 +536,9 @@ inline const QList<Tile*> &Tileset::tiles() const
  */
 inline Tile *Tileset::findTile(int id) const
 {
+    if (id >= 0 && id < mDenseTiles.size())
+        return mDenseTiles.at(id);
+
     return mTilesById.value(id);
 }
 
@@ -0,0 +1,371 @@
+/*
+ * tilesetatlas.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tilesetatlas.h"
+
+#include "savefile.h"
+#include "tile.h"
+#include "tileset.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QUrl>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+using namespace Tiled;
+
+namespace {
+
+/**
+ * The ways of choosing a free rectangle for the next image. Each packing
+ * is tried with all of them in parallel, keeping the best result.
+ */
+enum class Heuristic {
+    BestShortSideFit,
+    BestLongSideFit,
+    BestAreaFit,
+    BottomLeft,
+};
+
+using Score = std::pair<int, int>;  // lower is better
+
+struct Bin
+{
+    QVector<QRect> freeRects;
+    QRect usedBounds;
+};
+
+/**
+ * A MaxRects packing of a list of image sizes into bins.
+ */
+struct Packing
+{
+    Heuristic heuristic;
+    QVector<Bin> bins;
+    QVector<int> binIndexes;    // for each image
+    QVector<QRect> rects;       // for each image
+
+    void pack(const QVector<QSize> &sizes, int maxSize, int spacing);
+    qint64 usedArea() const;
+
+    bool findPosition(const Bin &bin, QSize size, QRect &rect, Score &score) const;
+    static void place(Bin &bin, const QRect &rect);
+};
+
+void Packing::pack(const QVector<QSize> &sizes, int maxSize, int spacing)
+{
+    binIndexes.fill(-1, sizes.size());
+    rects.resize(sizes.size());
+
+    // Placing the largest images first gives the tightest packing
+    QVector<int> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&] (int a, int b) {
+        const QSize &sa = sizes.at(a);
+        const QSize &sb = sizes.at(b);
+        return std::max(sa.width(), sa.height()) > std::max(sb.width(), sb.height());
+    });
+
+    // Each bin includes space for the spacing after its last column and row
+    const QSize binSize(maxSize + spacing, maxSize + spacing);
+
+    for (int index : std::as_const(order)) {
+        const QSize paddedSize = sizes.at(index) + QSize(spacing, spacing);
+
+        int bestBin = -1;
+        QRect bestRect;
+        Score bestScore;
+
+        for (int i = 0; i < bins.size(); ++i) {
+            QRect rect;
+            Score score;
+            if (findPosition(bins.at(i), paddedSize, rect, score) &&
+                    (bestBin == -1 || score < bestScore)) {
+                bestBin = i;
+                bestRect = rect;
+                bestScore = score;
+            }
+        }
+
+        if (bestBin == -1) {
+            // Images larger than the maximum atlas size get their own bin
+            Bin bin;
+            if (paddedSize.width() > binSize.width() || paddedSize.height() > binSize.height())
+                bin.freeRects.append(QRect(QPoint(), paddedSize));
+            else
+                bin.freeRects.append(QRect(QPoint(), binSize));
+
+            bestBin = bins.size();
+            bestRect = QRect(QPoint(), paddedSize);
+            bins.append(bin);
+        }
+
+        Bin &bin = bins[bestBin];
+        place(bin, bestRect);
+
+        binIndexes[index] = bestBin;
+        rects[index] = QRect(bestRect.topLeft(), sizes.at(index));
+        bin.usedBounds |= rects[index];
+    }
+}
+
+qint64 Packing::usedArea() const
+{
+    qint64 area = 0;
+    for (const Bin &bin : bins)
+        area += qint64(bin.usedBounds.width()) * bin.usedBounds.height();
+    return area;
+}
+
+bool Packing::findPosition(const Bin &bin, QSize size, QRect &rect, Score &score) const
+{
+    bool found = false;
+
+    for (const QRect &freeRect : bin.freeRects) {
+        if (freeRect.width() < size.width() || freeRect.height() < size.height())
+            continue;
+
+        const int leftoverX = freeRect.width() - size.width();
+        const int leftoverY = freeRect.height() - size.height();
+        const int shortSide = std::min(leftoverX, leftoverY);
+        const int longSide = std::max(leftoverX, leftoverY);
+
+        Score candidate;
+        switch (heuristic) {
+        case Heuristic::BestShortSideFit:
+            candidate = { shortSide, longSide };
+            break;
+        case Heuristic::BestLongSideFit:
+            candidate = { longSide, shortSide };
+            break;
+        case Heuristic::BestAreaFit:
+            candidate = { freeRect.width() * freeRect.height() - size.width() * size.height(), shortSide };
+            break;
+        case Heuristic::BottomLeft:
+            candidate = { freeRect.y() + size.height(), freeRect.x() };
+            break;
+        }
+
+        if (!found || candidate < score) {
+            found = true;
+            score = candidate;
+            rect = QRect(freeRect.topLeft(), size);
+        }
+    }
+
+    return found;
+}
+
+/**
+ * Removes \a rect from the free rectangles of \a bin, splitting each free
+ * rectangle it overlaps into up to four maximal free rectangles.
+ */
+void Packing::place(Bin &bin, const QRect &rect)
+{
+    QVector<QRect> freeRects;
+    freeRects.reserve(bin.freeRects.size() + 4);
+
+    for (const QRect &freeRect : std::as_const(bin.freeRects)) {
+        if (!freeRect.intersects(rect)) {
+            freeRects.append(freeRect);
+            continue;
+        }
+
+        if (rect.left() > freeRect.left())
+            freeRects.append(QRect(freeRect.left(), freeRect.top(),
+                                   rect.left() - freeRect.left(), freeRect.height()));
+        if (rect.right() < freeRect.right())
+            freeRects.append(QRect(rect.right() + 1, freeRect.top(),
+                                   freeRect.right() - rect.right(), freeRect.height()));
+        if (rect.top() > freeRect.top())
+            freeRects.append(QRect(freeRect.left(), freeRect.top(),
+                                   freeRect.width(), rect.top() - freeRect.top()));
+        if (rect.bottom() < freeRect.bottom())
+            freeRects.append(QRect(freeRect.left(), rect.bottom() + 1,
+                                   freeRect.width(), freeRect.bottom() - rect.bottom()));
+    }
+
+    // Remove the free rectangles that are contained in another one
+    for (int i = 0; i < freeRects.size(); ++i) {
+        for (int j = i + 1; j < freeRects.size(); ++j) {
+            if (freeRects.at(j).contains(freeRects.at(i))) {
+                freeRects.removeAt(i);
+                --i;
+                break;
+            }
+            if (freeRects.at(i).contains(freeRects.at(j))) {
+                freeRects.removeAt(j);
+                --j;
+            }
+        }
+    }
+
+    bin.freeRects.swap(freeRects);
+}
+
+struct Atlas
+{
+    QString fileName;
+    QVector<int> images;
+    QImage image;
+    QString error;
+};
+
+} // anonymous namespace
+
+/**
+ * Returns the file name of the atlas with the given \a index, for a tileset
+ * saved as \a tilesetFileName.
+ */
+QString TilesetAtlasPacker::atlasFileName(const QString &tilesetFileName, int index)
+{
+    const QFileInfo fileInfo(tilesetFileName);
+    const QString name = fileInfo.completeBaseName() + QStringLiteral("_atlas%1.png").arg(index);
+    return fileInfo.dir().filePath(name);
+}
+
+/**
+ * Packs the tile images of the image collection \a tileset into atlases,
+ * which are saved next to \a tilesetFileName. The tiles are changed to
+ * refer to their part of an atlas.
+ *
+ * Should be called from the main thread, since it converts the tile images
+ * to and from pixmaps. The packing and the compositing of the atlases are
+ * done in parallel.
+ *
+ * Returns whether the atlases were saved successfully. Upon failure, the
+ * tileset is left unchanged.
+ */
+bool TilesetAtlasPacker::pack(Tileset &tileset, const QString &tilesetFileName)
+{
+    mAtlasFileNames.clear();
+    mError.clear();
+
+    if (!tileset.isCollection()) {
+        mError = QCoreApplication::translate("TilesetAtlasPacker", "Only image collection tilesets can be packed into atlases.");
+        return false;
+    }
+
+    QVector<Tile*> tiles;
+    QVector<QImage> images;
+    QVector<QSize> sizes;
+
+    for (Tile *tile : tileset.tiles()) {
+        QImage image = tile->croppedImage().toImage();
+        if (image.isNull())
+            continue;
+
+        tiles.append(tile);
+        sizes.append(image.size());
+        images.append(std::move(image));
+    }
+
+    QVector<Packing> packings {
+        { Heuristic::BestShortSideFit, {}, {}, {} },
+        { Heuristic::BestLongSideFit, {}, {}, {} },
+        { Heuristic::BestAreaFit, {}, {}, {} },
+        { Heuristic::BottomLeft, {}, {}, {} },
+    };
+
+    QtConcurrent::blockingMap(packings, [&] (Packing &packing) {
+        packing.pack(sizes, mMaxAtlasSize, mSpacing);
+    });
+
+    // Prefer the fewest atlases, then the least used area
+    const Packing &best = *std::min_element(packings.cbegin(), packings.cend(),
+                                            [] (const Packing &a, const Packing &b) {
+        if (a.bins.size() != b.bins.size())
+            return a.bins.size() < b.bins.size();
+        return a.usedArea() < b.usedArea();
+    });
+
+    QVector<Atlas> atlases(best.bins.size());
+    for (int i = 0; i < atlases.size(); ++i)
+        atlases[i].fileName = atlasFileName(tilesetFileName, i);
+    for (int i = 0; i < images.size(); ++i)
+        atlases[best.binIndexes.at(i)].images.append(i);
+
+    QtConcurrent::blockingMap(atlases, [&] (Atlas &atlas) {
+        const QRect &bounds = best.bins.at(best.binIndexes.at(atlas.images.first())).usedBounds;
+
+        atlas.image = QImage(bounds.right() + 1, bounds.bottom() + 1,
+                             QImage::Format_ARGB32_Premultiplied);
+        atlas.image.fill(Qt::transparent);
+
+        QPainter painter(&atlas.image);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        for (int index : std::as_const(atlas.images))
+            painter.drawImage(best.rects.at(index).topLeft(), images.at(index));
+        painter.end();
+
+        SaveFile file(atlas.fileName);
+        if (!file.open(QIODevice::WriteOnly)) {
+            atlas.error = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+            return;
+        }
+
+        if (!atlas.image.save(file.device(), "png")) {
+            atlas.error = file.errorString();
+            return;
+        }
+
+        if (!file.commit())
+            atlas.error = file.errorString();
+    });
+
+    for (const Atlas &atlas : std::as_const(atlases)) {
+        if (!atlas.error.isEmpty()) {
+            mError = atlas.fileName + QLatin1String(": ") + atlas.error;
+            return false;
+        }
+    }
+
+    for (const Atlas &atlas : std::as_const(atlases)) {
+        const QPixmap pixmap = QPixmap::fromImage(atlas.image);
+        const QUrl imageSource = QUrl::fromLocalFile(atlas.fileName);
+
+        for (int index : atlas.images) {
+            Tile *tile = tiles.at(index);
+            tile->setImage(pixmap);
+            tile->setImageSource(imageSource);
+            tile->setImageRect(best.rects.at(index));
+        }
+
+        mAtlasFileNames.append(atlas.fileName);
+    }
+
+    return true;
+}
@@ -0,0 +1,72 @@
+/*
+ * tilesetatlas.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QString>
+#include <QStringList>
+
+namespace Tiled {
+
+class Tileset;
+
+/**
+ * Packs the images of an image collection tileset into one or more atlas
+ * images.
+ *
+ * The tiles stay in the collection with their IDs, properties, animations
+ * and collision shapes. Only their image changes, to a sub-rectangle of one
+ * of the atlases. This way the tiles can be drawn in larger batches and
+ * fewer images need to be loaded.
+ */
+class TILEDSHARED_EXPORT TilesetAtlasPacker
+{
+public:
+    void setMaxAtlasSize(int size) { mMaxAtlasSize = size; }
+    int maxAtlasSize() const { return mMaxAtlasSize; }
+
+    void setSpacing(int spacing) { mSpacing = spacing; }
+    int spacing() const { return mSpacing; }
+
+    bool pack(Tileset &tileset, const QString &tilesetFileName);
+
+    const QStringList &atlasFileNames() const { return mAtlasFileNames; }
+    const QString &errorString() const { return mError; }
+
+    static QString atlasFileName(const QString &tilesetFileName, int index);
+
+private:
+    int mMaxAtlasSize = 2048;
+    int mSpacing = 1;
+    QStringList mAtlasFileNames;
+    QString mError;
+};
+
+} // namespace Tiled
@@ -33,9 +33,13 @@
 #include "imagecache.h"
 #include "tile.h"
 #include "tileanimationdriver.h"
+#include "tileatlas.h"
 #include "tilesetformat.h"
 
 #include <QDebug>
+#include <QTimer>
+
+#include <utility>
 
 namespace Tiled {
 
@@ -55,10 +59,19 @@ TilesetManager::TilesetManager():
 
     connect(mAnimationDriver, &TileAnimationDriver::update,
             this, &TilesetManager::advanceTileAnimations);
+
+    ImageCache::setEvictionHandler([this] (const QString &fileName) {
+        // Deferred, since images are evicted while other images are loaded
+        if (mEvictedFiles.isEmpty())
+            QTimer::singleShot(0, this, &TilesetManager::releaseEvictedImages);
+        mEvictedFiles.append(fileName);
+    });
 }
 
 TilesetManager::~TilesetManager()
 {
+    ImageCache::setEvictionHandler(nullptr);
+
     // Assert that there are no remaining tileset instances
     if (!mTilesets.isEmpty()) {
         qWarning() << "TilesetManager: There are still" << mTilesets.size()
@@ -137,6 +150,10 @@ void TilesetManager::removeTileset(Tileset *tileset)
 
     if (tileset->imageSource().isLocalFile())
         mWatcher->removePath(tileset->imageSource().toLocalFile());
+
+    // Release the atlas once it no longer contains any images in use
+    if (mTilesets.isEmpty())
+        TileAtlas::clear();
 }
 
 /**
@@ -148,14 +165,19 @@ void TilesetManager::reloadImages(Tileset *tileset)
         return;
 
     if (tileset->isCollection()) {
+        // Decode all images in parallel before assigning them
         for (Tile *tile : tileset->tiles()) {
             // todo: trigger reload of remote files
             if (tile->imageSource().isLocalFile()) {
                 const QString localFile = tile->imageSource().toLocalFile();
                 ImageCache::remove(localFile);
-                tile->setImage(ImageCache::loadPixmap(localFile));
+                ImageCache::prefetch(localFile);
             }
         }
+        for (Tile *tile : tileset->tiles())
+            if (tile->imageSource().isLocalFile())
+                tile->setImage(ImageCache::loadPixmap(tile->imageSource().toLocalFile()));
+
         emit tilesetImagesChanged(tileset);
     } else if (tileset->imageSource().isLocalFile()) {
         ImageCache::remove(tileset->imageSource().toLocalFile());
@@ -197,6 +219,22 @@ bool TilesetManager::animateTiles() const
     return mAnimationDriver->state() == QAbstractAnimation::Running;
 }
 
+/**
+ * Sets whether the images of image collection tiles should only be loaded
+ * when they are first needed, rather than when the tileset is loaded.
+ *
+ * Only affects tilesets that are loaded afterwards.
+ */
+void TilesetManager::setLazyImageLoading(bool enabled)
+{
+    mLazyImageLoading = enabled;
+}
+
+bool TilesetManager::lazyImageLoading() const
+{
+    return mLazyImageLoading;
+}
+
 void TilesetManager::tilesetImageSourceChanged(const Tileset &tileset,
                                                const QUrl &oldImageSource)
 {
@@ -211,14 +249,55 @@ void TilesetManager::tilesetImageSourceChanged(const Tileset &tileset,
 
 void TilesetManager::filesChanged(const QStringList &fileNames)
 {
-    for (const QString &fileName : fileNames)
+    QSet<QString> changedFiles;
+    changedFiles.reserve(fileNames.size());
+
+    for (const QString &fileName : fileNames) {
         ImageCache::remove(fileName);
+        changedFiles.insert(fileName);
+    }
+
+    // Avoid accumulating outdated images in the atlas
+    TileAtlas::clear();
+
+    // Decode the changed images in parallel before reloading the tilesets
+    QVector<Tileset*> changedTilesets;
 
     for (Tileset *tileset : std::as_const(mTilesets)) {
         const QString fileName = tileset->imageSource().toLocalFile();
-        if (fileNames.contains(fileName))
-            if (tileset->loadImage())
-                emit tilesetImagesChanged(tileset);
+        if (changedFiles.contains(fileName)) {
+            ImageCache::prefetch(fileName);
+            changedTilesets.append(tileset);
+        }
+    }
+
+    for (Tileset *tileset : std::as_const(changedTilesets))
+        if (tileset->loadImage())
+            emit tilesetImagesChanged(tileset);
+}
+
+/**
+ * Releases the images of image collection tiles that were evicted from the
+ * image cache. They will be loaded again when they are next needed.
+ */
+void TilesetManager::releaseEvictedImages()
+{
+    const QStringList fileNames = std::exchange(mEvictedFiles, {});
+
+    for (Tileset *tileset : std::as_const(mTilesets)) {
+        if (!tileset->isCollection())
+            continue;
+
+        for (Tile *tile : tileset->tiles()) {
+            if (tile->imageStatus() != LoadingReady)
+                continue;
+            if (!tile->imageSource().isLocalFile())
+                continue;
+            if (!fileNames.contains(tile->imageSource().toLocalFile()))
+                continue;
+
+            tile->setPendingImage(tile->imageSource(), tile->image().size());
+        }
     }
 }
 
@@ -249,14 +328,17 @@ void TilesetManager::advanceTileAnimations(int ms)
     // TODO: This could be more optimal by keeping track of the list of
     // actually animated tiles
 
-    for (Tileset *tileset : std::as_const(mTilesets)) {
-        bool imageChanged = false;
+    QVector<int> changedTileIds;
 
+    for (Tileset *tileset : std::as_const(mTilesets)) {
         for (Tile *tile : tileset->tiles())
-            imageChanged |= tile->advanceAnimation(ms);
+            if (tile->advanceAnimation(ms))
+                changedTileIds.append(tile->id());
 
-        if (imageChanged)
-            emit repaintTileset(tileset);
+        if (!changedTileIds.isEmpty()) {
+            emit tileAnimationsAdvanced(tileset, changedTileIds);
+            changedTileIds.clear();
+        }
     }
 }
 
@@ -34,6 +34,7 @@
 #include <QObject>
 #include <QList>
 #include <QString>
+#include <QStringList>
 
 namespace Tiled {
 
@@ -72,6 +73,9 @@ public:
     void setAnimateTiles(bool enabled);
     bool animateTiles() const;
 
+    void setLazyImageLoading(bool enabled);
+    bool lazyImageLoading() const;
+
     void advanceTileAnimations(int ms);
     void resetTileAnimations();
 
@@ -86,12 +90,19 @@ signals:
 
     /**
      * Emitted when any images of the tiles in the given \a tileset have
-     * changed as a result of playing tile animations.
+     * changed as a result of resetting tile animations.
      */
     void repaintTileset(Tileset *tileset);
 
+    /**
+     * Emitted when the animations of the tiles with the given \a tileIds in
+     * the given \a tileset have advanced to another frame.
+     */
+    void tileAnimationsAdvanced(Tileset *tileset, const QVector<int> &tileIds);
+
 private:
     void filesChanged(const QStringList &fileNames);
+    void releaseEvictedImages();
 
     /**
      * The list of loaded tilesets (weak references).
@@ -99,6 +110,8 @@ private:
     QList<Tileset*> mTilesets;
     FileSystemWatcher *mWatcher;
     TileAnimationDriver *mAnimationDriver;
+    bool mLazyImageLoading = false;
+    QStringList mEvictedFiles;
 
     static TilesetManager *mInstance;
 };
@@ -0,0 +1,214 @@
+/*
+ * tracer.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tracer.h"
+
+#include "savefile.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+#include <algorithm>
+
+namespace Tiled {
+
+namespace {
+
+struct TraceEvent
+{
+    const char *name;
+    qint64 start;       // microseconds
+    qint64 duration;    // microseconds
+    int threadId;
+    QString detail;
+};
+
+struct TraceData
+{
+    QString fileName;
+    QElapsedTimer timer;
+    QMutex mutex;
+    QVector<TraceEvent> events;
+    QHash<Qt::HANDLE, int> threadIds;
+};
+
+TraceData &traceData()
+{
+    static TraceData data;
+    return data;
+}
+
+} // anonymous namespace
+
+bool Tracer::sActive;
+
+/**
+ * Starts recording trace events, to be written to \a fileName when tracing
+ * is finished. Does nothing when \a fileName is empty.
+ */
+void Tracer::start(const QString &fileName)
+{
+    if (sActive || fileName.isEmpty())
+        return;
+
+    TraceData &data = traceData();
+    data.fileName = fileName;
+    data.threadIds.insert(QThread::currentThreadId(), 0);
+    data.timer.start();
+
+    sActive = true;
+}
+
+/**
+ * Stops recording, writes the trace file and prints a summary of the time
+ * spent in each phase.
+ */
+void Tracer::finish()
+{
+    if (!sActive)
+        return;
+
+    sActive = false;
+
+    TraceData &data = traceData();
+    QMutexLocker locker(&data.mutex);
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+
+    for (auto it = data.threadIds.cbegin(); it != data.threadIds.cend(); ++it) {
+        const QString threadName = it.value() == 0 ? QStringLiteral("Main thread")
+                                                   : QStringLiteral("Worker %1").arg(it.value());
+        traceEvents.append(QJsonObject {
+            { QStringLiteral("name"), QStringLiteral("thread_name") },
+            { QStringLiteral("ph"), QStringLiteral("M") },
+            { QStringLiteral("pid"), pid },
+            { QStringLiteral("tid"), it.value() },
+            { QStringLiteral("args"), QJsonObject { { QStringLiteral("name"), threadName } } },
+        });
+    }
+
+    struct Total
+    {
+        const char *name;
+        int count;
+        qint64 duration;
+    };
+    QVector<Total> totals;
+
+    for (const TraceEvent &event : std::as_const(data.events)) {
+        QJsonObject traceEvent {
+            { QStringLiteral("name"), QLatin1String(event.name) },
+            { QStringLiteral("cat"), QStringLiteral("tiled") },
+            { QStringLiteral("ph"), QStringLiteral("X") },
+            { QStringLiteral("ts"), event.start },
+            { QStringLiteral("dur"), event.duration },
+            { QStringLiteral("pid"), pid },
+            { QStringLiteral("tid"), event.threadId },
+        };
+        if (!event.detail.isEmpty())
+            traceEvent.insert(QStringLiteral("args"), QJsonObject { { QStringLiteral("detail"), event.detail } });
+        traceEvents.append(traceEvent);
+
+        auto total = std::find_if(totals.begin(), totals.end(), [&] (const Total &entry) {
+            return qstrcmp(entry.name, event.name) == 0;
+        });
+        if (total == totals.end()) {
+            totals.append(Total { event.name, 1, event.duration });
+        } else {
+            ++total->count;
+            total->duration += event.duration;
+        }
+    }
+
+    const QJsonObject trace {
+        { QStringLiteral("traceEvents"), traceEvents },
+        { QStringLiteral("displayTimeUnit"), QStringLiteral("ms") },
+    };
+
+    SaveFile file(data.fileName);
+    if (!file.open(QIODevice::WriteOnly) ||
+            file.device()->write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) == -1 ||
+            !file.commit()) {
+        qWarning().noquote() << "Failed to write trace file" << data.fileName << file.errorString();
+    }
+
+    std::stable_sort(totals.begin(), totals.end(), [] (const Total &a, const Total &b) {
+        return a.duration > b.duration;
+    });
+
+    qInfo().noquote() << "Trace written to" << data.fileName;
+    for (const Total &total : std::as_const(totals)) {
+        qInfo().noquote() << QStringLiteral("%1 ms").arg(total.duration / 1000.0, 10, 'f', 1)
+                          << QLatin1String(total.name)
+                          << QStringLiteral("(%1x)").arg(total.count);
+    }
+
+    data.events.clear();
+    data.threadIds.clear();
+}
+
+/**
+ * Returns the time in microseconds since tracing was started.
+ */
+qint64 Tracer::now()
+{
+    return traceData().timer.nsecsElapsed() / 1000;
+}
+
+/**
+ * Records an event with the given \a name, which started at \a start and
+ * ends now. The event is recorded for the current thread.
+ */
+void Tracer::addEvent(const char *name, qint64 start, const QString &detail)
+{
+    if (!sActive)
+        return;
+
+    TraceData &data = traceData();
+    const qint64 end = now();
+
+    QMutexLocker locker(&data.mutex);
+
+    auto threadId = data.threadIds.find(QThread::currentThreadId());
+    if (threadId == data.threadIds.end())
+        threadId = data.threadIds.insert(QThread::currentThreadId(), data.threadIds.size());
+
+    data.events.append(TraceEvent { name, start, end - start, threadId.value(), detail });
+}
+
+} // namespace Tiled
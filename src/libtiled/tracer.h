@@ -0,0 +1,86 @@
+/*
+ * tracer.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QString>
+
+namespace Tiled {
+
+/**
+ * Records how long the named phases of starting up and loading files take.
+ *
+ * Tracing is disabled unless started. When finished, the recorded events
+ * are written as a Chrome trace file, which can be opened in
+ * chrome://tracing or the Perfetto UI, and a summary is printed.
+ */
+class TILEDSHARED_EXPORT Tracer
+{
+public:
+    static void start(const QString &fileName);
+    static void finish();
+
+    static bool isActive() { return sActive; }
+
+    static qint64 now();
+    static void addEvent(const char *name, qint64 start, const QString &detail = QString());
+
+private:
+    static bool sActive;
+};
+
+/**
+ * Records the time between its construction and destruction as a trace
+ * event. The \a name is expected to be a string literal.
+ */
+class TILEDSHARED_EXPORT TraceScope
+{
+public:
+    explicit TraceScope(const char *name, const QString &detail = QString())
+        : mName(Tracer::isActive() ? name : nullptr)
+        , mStart(mName ? Tracer::now() : 0)
+        , mDetail(detail)
+    {}
+
+    ~TraceScope()
+    {
+        if (mName)
+            Tracer::addEvent(mName, mStart, mDetail);
+    }
+
+private:
+    Q_DISABLE_COPY(TraceScope)
+
+    const char * const mName;
+    const qint64 mStart;
+    const QString mDetail;
+};
+
+} // namespace Tiled
@@ -21,6 +21,7 @@
 
 #include "varianttomapconverter.h"
 
+#include "base64.h"
 #include "grouplayer.h"
 #include "imagelayer.h"
 #include "map.h"
@@ -50,6 +51,7 @@ std::unique_ptr<Map> VariantToMapConverter::toMap(const QVariant &variant,
                                                   const QDir &mapDir)
 {
     mGidMapper.clear();
+    mStringPool.clear();
     mDir = mapDir;
 
     const QVariantMap variantMap = variant.toMap();
@@ -103,6 +105,12 @@ std::unique_ptr<Map> VariantToMapConverter::toMap(const QVariant &variant,
 
     readMapEditorSettings(*map, variantMap[QStringLiteral("editorsettings")].toMap());
 
+    const QString compressionDictionary = variantMap[QStringLiteral("compressiondictionary")].toString();
+    if (!compressionDictionary.isEmpty()) {
+        map->setCompressionDictionary(Base64::decode(compressionDictionary.toLatin1()));
+        map->setUseCompressionDictionary(true);
+    }
+
     mMap = map.get();
     map->setProperties(extractProperties(variantMap));
 
@@ -140,6 +148,7 @@ std::unique_ptr<Map> VariantToMapConverter::toMap(const QVariant &variant,
 SharedTileset VariantToMapConverter::toTileset(const QVariant &variant,
                                                const QDir &directory)
 {
+    mStringPool.clear();
     mDir = directory;
     mReadingExternalTileset = true;
 
@@ -155,6 +164,7 @@ std::unique_ptr<ObjectTemplate> VariantToMapConverter::toObjectTemplate(const QV
                                                                         const QDir &directory)
 {
     mGidMapper.clear();
+    mStringPool.clear();
     mDir = directory;
     return toObjectTemplate(variant);
 }
@@ -177,7 +187,7 @@ Properties VariantToMapConverter::toProperties(const QVariant &propertiesVariant
         exportValue.typeName = propertyTypesMap.value(it.key()).toString();
         // TODO: Support for custom property types with customPropertyTypesMap
 
-        properties[it.key()] = context.toPropertyValue(exportValue);
+        properties[mStringPool.intern(it.key())] = mStringPool.intern(context.toPropertyValue(exportValue));
     }
 
     // read array-based format (1.2)
@@ -190,7 +200,7 @@ Properties VariantToMapConverter::toProperties(const QVariant &propertiesVariant
         exportValue.typeName = propertyVariantMap[QStringLiteral("type")].toString();
         exportValue.propertyTypeName = propertyVariantMap[QStringLiteral("propertytype")].toString();
 
-        properties[propertyName] = context.toPropertyValue(exportValue);
+        properties[mStringPool.intern(propertyName)] = mStringPool.intern(context.toPropertyValue(exportValue));
     }
 
     return properties;
@@ -367,8 +377,17 @@ SharedTileset VariantToMapConverter::toTileset(const QVariant &variant)
 
         QVariant imageVariant = tileVar[QStringLiteral("image")];
         if (!imageVariant.isNull()) {
-            const QUrl imagePath = toUrl(imageVariant.toString(), mDir);
-            tileset->setTileImage(tile, QPixmap(imagePath.toLocalFile()), imagePath);
+            ImageReference imageReference;
+            imageReference.source = toUrl(imageVariant.toString(), mDir);
+
+            QSize pendingSize;
+            if (TilesetManager::instance()->lazyImageLoading())
+                pendingSize = imageReference.fileImageSize();
+
+            if (pendingSize.isValid())
+                tileset->setTileImageSource(tile, imageReference.source, pendingSize);
+            else
+                tileset->setTileImage(tile, QPixmap(imageReference.source.toLocalFile()), imageReference.source);
         }
 
         QVariantMap objectGroupVariant = tileVar[QStringLiteral("objectgroup")].toMap();
@@ -654,6 +673,10 @@ std::unique_ptr<TileLayer> VariantToMapConverter::toTileLayer(const QVariantMap
             layerDataFormat = Map::Base64Zlib;
         } else if (compression == QLatin1String("zstd")) {
             layerDataFormat = Map::Base64Zstandard;
+        } else if (compression == QLatin1String("rle")) {
+            layerDataFormat = Map::Base64RunLength;
+        } else if (compression == QLatin1String("rle+zstd")) {
+            layerDataFormat = Map::Base64RunLengthZstandard;
         } else {
             mError = tr("Compression method '%1' not supported").arg(compression);
             return nullptr;
@@ -683,6 +706,8 @@ std::unique_ptr<TileLayer> VariantToMapConverter::toTileLayer(const QVariantMap
         }
     }
 
+    tileLayer->squeeze();
+
     return tileLayer;
 }
 
@@ -947,6 +972,9 @@ bool VariantToMapConverter::readTileLayerData(TileLayer &tileLayer,
     switch (layerDataFormat) {
     case Map::XML:
     case Map::CSV: {
+        if (dataVariant.userType() == qMetaTypeId<QVector<unsigned>>())
+            return readTileLayerData(tileLayer, dataVariant.value<QVector<unsigned>>(), bounds);
+
         const QVariantList dataVariantList = dataVariant.toList();
 
         if (dataVariantList.size() != bounds.width() * bounds.height()) {
@@ -982,12 +1010,16 @@ bool VariantToMapConverter::readTileLayerData(TileLayer &tileLayer,
     case Map::Base64:
     case Map::Base64Zlib:
     case Map::Base64Gzip:
-    case Map::Base64Zstandard:{
+    case Map::Base64Zstandard:
+    case Map::Base64RunLength:
+    case Map::Base64RunLengthZstandard: {
         const QByteArray data = dataVariant.toByteArray();
+        const QByteArray dictionary = mMap ? mMap->compressionDictionary() : QByteArray();
         GidMapper::DecodeError error = mGidMapper.decodeLayerData(tileLayer,
                                                                   data,
                                                                   layerDataFormat,
-                                                                  bounds);
+                                                                  bounds,
+                                                                  dictionary);
 
         switch (error) {
         case GidMapper::CorruptLayerData:
@@ -1010,6 +1042,43 @@ bool VariantToMapConverter::readTileLayerData(TileLayer &tileLayer,
     return true;
 }
 
+/**
+ * Reads tile layer data stored as a compact list of global tile IDs, which
+ * is decoded a row at a time.
+ */
+bool VariantToMapConverter::readTileLayerData(TileLayer &tileLayer,
+                                              const QVector<unsigned> &gids,
+                                              QRect bounds)
+{
+    const int width = bounds.width();
+
+    if (gids.size() != width * bounds.height()) {
+        mError = tr("Corrupt layer data for layer '%1'").arg(tileLayer.name());
+        return false;
+    }
+
+    QVector<Cell> cells(width);
+    const unsigned *rowGids = gids.constData();
+
+    for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
+        int converted = 0;
+        while (converted < width) {
+            converted += mGidMapper.gidsToCells(rowGids + converted,
+                                                width - converted,
+                                                cells.data() + converted);
+
+            // Like gidToCell, an invalid tile results in an empty cell
+            if (converted < width)
+                ++converted;
+        }
+
+        tileLayer.setRow(bounds.x(), y, width, cells.constData());
+        rowGids += width;
+    }
+
+    return true;
+}
+
 Properties VariantToMapConverter::extractProperties(const QVariantMap &variantMap) const
 {
     return toProperties(variantMap[QStringLiteral("properties")],
@@ -27,6 +27,7 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QVariant>
+#include <QVector>
 
 namespace Tiled {
 
@@ -57,6 +58,9 @@ public:
      * Tries to convert the given \a variant to a Map instance. The \a mapDir
      * is necessary to resolve any relative references to external images.
      *
+     * Tile layer data in CSV format can be provided either as a QVariantList
+     * or as a more compact QVector<unsigned>.
+     *
      * Returns 0 in case of an error. The error can be obstained using
      * errorString().
      */
@@ -107,6 +111,9 @@ private:
                            const QVariant &dataVariant,
                            Map::LayerDataFormat layerDataFormat,
                            QRect bounds);
+    bool readTileLayerData(TileLayer &tileLayer,
+                           const QVector<unsigned> &gids,
+                           QRect bounds);
 
     Properties extractProperties(const QVariantMap &variantMap) const;
 
@@ -115,6 +122,9 @@ private:
     bool mReadingExternalTileset;
     GidMapper mGidMapper;
     QString mError;
+
+    // Shares the property names and string values between objects
+    mutable StringPool mStringPool;
 };
 
 } // namespace Tiled
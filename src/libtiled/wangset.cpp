@@ -31,10 +31,48 @@
 
 #include <QDebug>
 #include <QStack>
+#include <QtAlgorithms>
+#include <QtEndian>
 #include <QtMath>
 
 namespace Tiled {
 
+// The lowest and highest bit of each index
+static constexpr quint64 LowBits = Q_UINT64_C(0x0101010101010101);
+static constexpr quint64 HighBits = Q_UINT64_C(0x8080808080808080);
+
+/**
+ * Returns a mask with all bits set for each index of \a id that is not 0,
+ * without looking at each index separately.
+ */
+static constexpr quint64 nonZeroIndexes(quint64 id)
+{
+    // The high bit of each index is set when any of its low bits are set
+    // (without carrying into the next index) or when it was already set
+    const quint64 high = (((id & ~HighBits) + ~HighBits) | id) & HighBits;
+    return (high >> 7) * WangId::INDEX_MASK;
+}
+
+/**
+ * Returns a mask with all bits set for each index of \a id that equals
+ * \a color.
+ */
+static constexpr quint64 indexesWithColor(quint64 id, int color)
+{
+    if (color < 0 || quint64(color) > WangId::INDEX_MASK)
+        return 0;
+
+    return ~nonZeroIndexes(id ^ (LowBits * quint64(color)));
+}
+
+static constexpr quint64 rotateLeft(quint64 id, unsigned bits)
+{
+    return (id << bits) | (id >> ((64 - bits) & 63));
+}
+
+static_assert(nonZeroIndexes(Q_UINT64_C(0x0080010000FF7F00)) == Q_UINT64_C(0x00FFFF0000FFFF00), "nonZeroIndexes");
+static_assert(indexesWithColor(Q_UINT64_C(0x0203020002030202), 2) == Q_UINT64_C(0xFF00FF00FF00FFFF), "indexesWithColor");
+
 /**
  * These return the color of the edge of the WangId.
  * 0 being the top edge:
@@ -141,11 +179,7 @@ void WangId::updateToAdjacent(WangId adjacent, int position)
  */
 bool WangId::hasWildCards() const
 {
-    for (int i = 0; i < NumIndexes; ++i)
-        if (!indexColor(i))
-            return true;
-
-    return false;
+    return nonZeroIndexes(mId) != FULL_MASK;
 }
 
 /**
@@ -153,11 +187,7 @@ bool WangId::hasWildCards() const
  */
 bool WangId::hasCornerWildCards() const
 {
-    for (int i = 0; i < NumCorners; ++i)
-        if (!cornerColor(i))
-            return true;
-
-    return false;
+    return (nonZeroIndexes(mId) & MaskCorners) != MaskCorners;
 }
 
 /**
@@ -165,11 +195,7 @@ bool WangId::hasCornerWildCards() const
  */
 bool WangId::hasEdgeWildCards() const
 {
-    for (int i = 0; i < NumEdges; ++i)
-        if (!edgeColor(i))
-            return true;
-
-    return false;
+    return (nonZeroIndexes(mId) & MaskEdges) != MaskEdges;
 }
 
 /**
@@ -177,12 +203,7 @@ bool WangId::hasEdgeWildCards() const
  */
 WangId WangId::mask() const
 {
-    quint64 mask = 0;
-    for (int i = 0; i < NumIndexes; ++i) {
-        if (indexColor(i))
-            mask |= INDEX_MASK << (i * BITS_PER_INDEX);
-    }
-    return mask;
+    return nonZeroIndexes(mId);
 }
 
 /**
@@ -190,30 +211,17 @@ WangId WangId::mask() const
  */
 WangId WangId::mask(int value) const
 {
-    quint64 mask = 0;
-    for (int i = 0; i < NumIndexes; ++i) {
-        if (indexColor(i) == value)
-            mask |= INDEX_MASK << (i * BITS_PER_INDEX);
-    }
-    return mask;
+    return indexesWithColor(mId, value);
 }
 
 bool WangId::hasCornerWithColor(int value) const
 {
-    for (int i = 0; i < NumCorners; ++i) {
-        if (cornerColor(i) == value)
-            return true;
-    }
-    return false;
+    return (indexesWithColor(mId, value) & MaskCorners) != 0;
 }
 
 bool WangId::hasEdgeWithColor(int value) const
 {
-    for (int i = 0; i < NumEdges; ++i) {
-        if (edgeColor(i) == value)
-            return true;
-    }
-    return false;
+    return (indexesWithColor(mId, value) & MaskEdges) != 0;
 }
 
 /**
@@ -231,15 +239,8 @@ void WangId::rotate(int rotations)
  */
 WangId WangId::rotated(int rotations) const
 {
-    if (rotations < 0)
-        rotations = 4 + (rotations % 4);
-    else
-        rotations %= 4;
-
-    quint64 rotated = mId << (rotations * BITS_PER_INDEX * 2);
-    rotated = rotated | (mId >> ((4 - rotations) * BITS_PER_INDEX * 2));
-
-    return rotated;
+    // Each rotation moves all indexes over by two
+    return rotateLeft(mId, unsigned(rotations & 3) * BITS_PER_INDEX * 2);
 }
 
 /**
@@ -255,28 +256,27 @@ void WangId::flipHorizontally()
  */
 void WangId::flipVertically()
 {
-    flipHorizontally();
-    rotate(2);
+    *this = flippedVertically();
 }
 
+/**
+ * Returns the wang Id flipped horizontally, which moves each index i to
+ * (8 - i) % 8.
+ */
 WangId WangId::flippedHorizontally() const
 {
-    WangId newWangId = mId;
-
-    newWangId.setIndexColor(WangId::Right, indexColor(WangId::Left));
-    newWangId.setIndexColor(WangId::Left, indexColor(WangId::Right));
-
-    for (int i = 0; i < NumCorners; ++i)
-        newWangId.setCornerColor(i, cornerColor(NumCorners - 1 - i));
-
-    return newWangId;
+    // Reversing the byte order moves each index i to 7 - i, after which
+    // one more index is needed
+    return rotateLeft(qbswap(mId), BITS_PER_INDEX);
 }
 
+/**
+ * Returns the wang Id flipped vertically, which moves each index i to
+ * (12 - i) % 8.
+ */
 WangId WangId::flippedVertically() const
 {
-    WangId newWangId = mId;
-    newWangId.flipVertically();
-    return newWangId;
+    return rotateLeft(qbswap(mId), BITS_PER_INDEX * 5);
 }
 
 WangId::Index WangId::indexByGrid(int x, int y)
@@ -577,6 +577,91 @@ const QVector<WangSet::WangIdAndCell> &WangSet::wangIdsAndCells() const
     return mWangIdAndCells;
 }
 
+/**
+ * Calls \a function with the index of each entry in wangIdsAndCells() of
+ * which the WangId matches \a wangId at the bits set in \a mask, in order,
+ * until \a function returns false.
+ */
+template<typename Function>
+void WangSet::forEachMatchingIndex(WangId wangId, WangId mask, Function function) const
+{
+    const auto &entries = wangIdsAndCells();
+    const WangId maskedWangId = wangId & mask;
+
+    bool partialMask = false;
+    int maskedIndexes[WangId::NumIndexes];
+    int maskedIndexCount = 0;
+
+    for (int i = 0; i < WangId::NumIndexes; ++i) {
+        const int indexMask = mask.indexColor(i);
+        if (indexMask == WangId::INDEX_MASK)
+            maskedIndexes[maskedIndexCount++] = i;
+        else if (indexMask != 0)
+            partialMask = true;
+    }
+
+    // The lookup tables only cover masks selecting whole indexes
+    if (partialMask || maskedIndexCount == 0) {
+        for (int index = 0; index < entries.size(); ++index)
+            if ((entries.at(index).wangId & mask) == maskedWangId)
+                if (!function(index))
+                    return;
+        return;
+    }
+
+    // Since the WangIds in the set are masked by the type mask, they need to
+    // equal the masked WangId when all of those bits are selected
+    if ((mask & typeMask()) == typeMask()) {
+        const auto it = mIndexesByWangId.constFind(maskedWangId);
+        if (it != mIndexesByWangId.constEnd())
+            for (int index : *it)
+                if (!function(index))
+                    return;
+        return;
+    }
+
+    // Otherwise, intersect the bitsets of the selected color at each index
+    const quint64 *bitsets[WangId::NumIndexes];
+    for (int i = 0; i < maskedIndexCount; ++i) {
+        const int index = maskedIndexes[i];
+        const int color = maskedWangId.indexColor(index);
+        if (color >= mColorBitsColors)
+            return;
+
+        bitsets[i] = mColorBits.constData() + (index * mColorBitsColors + color) * mColorBitsWords;
+    }
+
+    for (int word = 0; word < mColorBitsWords; ++word) {
+        quint64 bits = bitsets[0][word];
+        for (int i = 1; i < maskedIndexCount && bits; ++i)
+            bits &= bitsets[i][word];
+
+        while (bits) {
+            const int index = word * 64 + static_cast<int>(qCountTrailingZeroBits(bits));
+            if (!function(index))
+                return;
+            bits &= bits - 1;
+        }
+    }
+}
+
+/**
+ * Returns the indexes of the entries in wangIdsAndCells() of which the WangId
+ * matches \a wangId at the bits set in \a mask, in order.
+ *
+ * This uses lookup tables, which is much faster than checking each entry
+ * for large Wang sets.
+ */
+QVector<int> WangSet::matchingWangIdsAndCells(WangId wangId, WangId mask) const
+{
+    QVector<int> indexes;
+    forEachMatchingIndex(wangId, mask, [&] (int index) {
+        indexes.append(index);
+        return true;
+    });
+    return indexes;
+}
+
 void WangSet::recalculateCells()
 {
     mWangIdAndCells.clear();
@@ -601,8 +686,10 @@ void WangSet::recalculateCells()
     const auto transformationFlags = tileset()->transformationFlags();
     mLastSeenTranslationFlags = transformationFlags;
 
-    if (!(transformationFlags & ~Tileset::PreferUntransformed))
+    if (!(transformationFlags & ~Tileset::PreferUntransformed)) {
+        recalculateLookupTables();
         return;
+    }
 
     // Then insert variations based on flipping
     it.toFront();
@@ -656,6 +743,40 @@ void WangSet::recalculateCells()
             mWangIdAndCells.append({wangIds[i], cells[i]});
         }
     }
+
+    recalculateLookupTables();
+}
+
+/**
+ * Rebuilds the tables used to look up the entries in mWangIdAndCells that
+ * match a certain WangId.
+ */
+void WangSet::recalculateLookupTables()
+{
+    mIndexesByWangId.clear();
+
+    int maximumColor = 0;
+    for (int index = 0; index < mWangIdAndCells.size(); ++index) {
+        const WangId wangId = mWangIdAndCells.at(index).wangId;
+        mIndexesByWangId[wangId].append(index);
+
+        for (int i = 0; i < WangId::NumIndexes; ++i)
+            maximumColor = std::max(maximumColor, wangId.indexColor(i));
+    }
+
+    mColorBitsWords = (mWangIdAndCells.size() + 63) / 64;
+    mColorBitsColors = maximumColor + 1;
+    mColorBits.fill(0, WangId::NumIndexes * mColorBitsColors * mColorBitsWords);
+
+    for (int index = 0; index < mWangIdAndCells.size(); ++index) {
+        const WangId wangId = mWangIdAndCells.at(index).wangId;
+        const quint64 bit = Q_UINT64_C(1) << (index % 64);
+
+        for (int i = 0; i < WangId::NumIndexes; ++i) {
+            const int color = wangId.indexColor(i);
+            mColorBits[(i * mColorBitsColors + color) * mColorBitsWords + index / 64] |= bit;
+        }
+    }
 }
 
 /**
@@ -664,83 +785,82 @@ void WangSet::recalculateCells()
  * Distance between colors is the minimum number of tiles required before one
  * color may meet another. Colors that have no transition path have a distance
  * of -1.
+ *
+ * This is only done when the distances are needed after the set changed,
+ * so assigning many WangIds in a row does not repeat it.
  */
 void WangSet::recalculateColorDistances()
 {
+    using ColorSet = std::bitset<WangId::INDEX_MASK + 1>;
+
+    const int count = colorCount();
     int maximumDistance = 1;
 
-    for (int i = 1; i <= colorCount(); ++i) {
-        WangColor &color = *colorAt(i);
-        QVector<int> distance(colorCount() + 1, -1);
+    // Find the direct transitions in a single pass over the tiles
+    mTransitions = QVector<ColorSet>(count + 1);
 
-        // Check all tiles for transitions to other Wang colors
-        for (WangId wangId : std::as_const(mTileIdToWangId)) {
-            wangId &= typeMask();
+    for (WangId wangId : std::as_const(mTileIdToWangId)) {
+        wangId &= typeMask();
 
-            // Don't consider edges and corners to be connected. This helps
-            // avoid seeing transitions to "no color" for edge or corner
-            // based sets.
+        // Don't consider edges and corners to be connected. This helps
+        // avoid seeing transitions to "no color" for edge or corner
+        // based sets.
+        ColorSet cornerColors;
+        ColorSet edgeColors;
+        for (int index = 0; index < 4; ++index) {
+            cornerColors.set(wangId.cornerColor(index));
+            edgeColors.set(wangId.edgeColor(index));
+        }
 
-            if (wangId.hasCornerWithColor(i)) {
-                for (int index = 0; index < 4; ++index)
-                    distance[wangId.cornerColor(index)] = 1;
-            }
+        for (int index = 0; index < 4; ++index) {
+            const int cornerColor = wangId.cornerColor(index);
+            const int edgeColor = wangId.edgeColor(index);
 
-            if (wangId.hasEdgeWithColor(i)) {
-                for (int index = 0; index < 4; ++index)
-                    distance[wangId.edgeColor(index)] = 1;
-            }
+            if (cornerColor > 0 && cornerColor <= count)
+                mTransitions[cornerColor] |= cornerColors;
+            if (edgeColor > 0 && edgeColor <= count)
+                mTransitions[edgeColor] |= edgeColors;
         }
+    }
 
-        // Color has at least one tile of its own type
-        distance[i] = 0;
+    for (int i = 1; i <= count; ++i)
+        if (mTransitions[i].test(0))
+            mTransitions[0].set(i);
 
-        color.mDistanceToColor = distance;
-    }
+    // Calculate the indirect transition distances with a breadth-first
+    // search from each color. Paths may pass through "no color", but the
+    // distance to "no color" itself only counts direct transitions.
+    for (int i = 1; i <= count; ++i) {
+        QVector<int> distance(count + 1, -1);
+        distance[i] = 0;
 
-    // Calculate indirect transition distances
-    bool newConnections;
-    do {
-        newConnections = false;
-
-        // For each combination of colors
-        for (int i = 1; i <= colorCount(); ++i) {
-            WangColor &colorI = *colorAt(i);
-
-            for (int j = 1; j <= colorCount(); ++j) {
-                if (i == j)
-                    continue;
-
-                WangColor &colorJ = *colorAt(j);
-
-                // Scan through each color, and see if we have any in common
-                for (int t = 0; t <= colorCount(); ++t) {
-                    const int d0 = colorI.distanceToColor(t);
-                    const int d1 = colorJ.distanceToColor(t);
-                    if (d0 == -1 || d1 == -1)
-                        continue;
-
-                    // We have found a common connection
-                    int d = colorI.distanceToColor(j);
-                    Q_ASSERT(colorJ.distanceToColor(i) == d);
-
-                    // If the new path is shorter, record the new distance
-                    if (d == -1 || d0 + d1 < d) {
-                        d = d0 + d1;
-                        colorI.mDistanceToColor[j] = d;
-                        colorJ.mDistanceToColor[i] = d;
-                        maximumDistance = qMax(maximumDistance, d);
-
-                        // We're making progress, flag for another iteration...
-                        newConnections = true;
-                    }
+        ColorSet visited;
+        ColorSet frontier;
+        visited.set(i);
+        frontier.set(i);
+
+        for (int d = 1; frontier.any(); ++d) {
+            ColorSet next;
+            for (int t = 0; t <= count; ++t)
+                if (frontier.test(t))
+                    next |= mTransitions[t];
+
+            next &= ~visited;
+            visited |= next;
+            frontier = next;
+
+            for (int j = 1; j <= count; ++j) {
+                if (next.test(j)) {
+                    distance[j] = d;
+                    maximumDistance = qMax(maximumDistance, d);
                 }
             }
         }
 
-        // Repeat while we are still making new connections (could take a
-        // number of iterations for distant colors to connect)
-    } while (newConnections);
+        distance[0] = mTransitions[i].test(0) ? 1 : -1;
+
+        colorAt(i)->mDistanceToColor = distance;
+    }
 
     mMaximumColorDistance = maximumDistance;
     mColorDistancesDirty = false;
@@ -846,14 +966,12 @@ bool WangSet::wangIdIsValid(WangId wangId, int colorCount)
  */
 bool WangSet::wangIdIsUsed(WangId wangId, WangId mask) const
 {
-    mask &= typeMask();
-    const WangId maskedWangId = wangId & mask;
-
-    for (const auto &wangIdAndCell : wangIdsAndCells())
-        if ((wangIdAndCell.wangId & mask) == maskedWangId)
-            return true;
-
-    return false;
+    bool used = false;
+    forEachMatchingIndex(wangId, mask & typeMask(), [&] (int) {
+        used = true;
+        return false;
+    });
+    return used;
 }
 
 int WangSet::transitionPenalty(int colorA, int colorB) const
@@ -879,6 +997,21 @@ int WangSet::maximumColorDistance() const
     return mMaximumColorDistance;
 }
 
+/**
+ * Returns whether any tile in this set directly connects \a colorA and
+ * \a colorB, either of which may be 0 for "no color".
+ */
+bool WangSet::hasTransition(int colorA, int colorB) const
+{
+    if (mColorDistancesDirty)
+        const_cast<WangSet*>(this)->recalculateColorDistances();
+
+    if (colorA < 0 || colorA > colorCount() || colorB < 0 || colorB > colorCount())
+        return false;
+
+    return mTransitions.at(colorA).test(colorB);
+}
+
 /**
  * Returns whether every template wangTile is filled.
  */
@@ -998,6 +1131,11 @@ WangSet *WangSet::clone(Tileset *tileset) const
     c->mColors = mColors;
     c->mTileIdToWangId = mTileIdToWangId;
     c->mWangIdAndCells = mWangIdAndCells;
+    c->mIndexesByWangId = mIndexesByWangId;
+    c->mColorBits = mColorBits;
+    c->mColorBitsWords = mColorBitsWords;
+    c->mColorBitsColors = mColorBitsColors;
+    c->mTransitions = mTransitions;
     c->mMaximumColorDistance = mMaximumColorDistance;
     c->mColorDistancesDirty = mColorDistancesDirty;
     c->mCellsDirty = mCellsDirty;
@@ -39,6 +39,8 @@
 
 #include "qtcompat_p.h"
 
+#include <bitset>
+
 namespace Tiled {
 
 class TILEDSHARED_EXPORT WangId
@@ -234,14 +236,6 @@ private:
     QVector<int> mDistanceToColor;
 };
 
-/**
- * Returns the transition penalty(/distance) from this color to another.
- */
-inline int WangColor::distanceToColor(int targetColor) const
-{
-    return mDistanceToColor.at(targetColor);
-}
-
 /**
  * Represents a Wang set.
  */
@@ -296,6 +290,7 @@ public:
     };
 
     const QVector<WangIdAndCell> &wangIdsAndCells() const;
+    QVector<int> matchingWangIdsAndCells(WangId wangId, WangId mask) const;
 
     QList<WangTile> sortedWangTiles() const;
 
@@ -312,6 +307,7 @@ public:
 
     int transitionPenalty(int colorA, int colorB) const;
     int maximumColorDistance() const;
+    bool hasTransition(int colorA, int colorB) const;
 
     bool isEmpty() const;
     bool isComplete() const;
@@ -328,8 +324,12 @@ private:
 
     bool cellsDirty() const;
     void recalculateCells();
+    void recalculateLookupTables();
     void recalculateColorDistances();
 
+    template<typename Function>
+    void forEachMatchingIndex(WangId wangId, WangId mask, Function function) const;
+
     Tileset *mTileset;
     QString mName;
     Type mType;
@@ -345,6 +345,15 @@ private:
 
     QVector<WangIdAndCell> mWangIdAndCells;
 
+    // Lookup tables for finding the entries in mWangIdAndCells matching a
+    // given WangId. They are rebuilt along with the cells.
+    QHash<WangId, QVector<int>> mIndexesByWangId;
+    QVector<quint64> mColorBits;    // bitset of entries per index and color
+    int mColorBitsWords = 0;        // size of each bitset
+    int mColorBitsColors = 0;       // number of colors per index
+
+    // Colors directly connected by a tile, by color (including "no color")
+    QVector<std::bitset<WangId::INDEX_MASK + 1>> mTransitions;
     int mMaximumColorDistance = 0;
     bool mColorDistancesDirty = true;
     bool mCellsDirty = true;
@@ -419,6 +428,15 @@ inline bool WangSet::cellsDirty() const
     return mCellsDirty || mLastSeenTranslationFlags != mTileset->transformationFlags();
 }
 
+/**
+ * Returns the transition penalty(/distance) from this color to another.
+ */
+inline int WangColor::distanceToColor(int targetColor) const
+{
+    return mWangSet ? mWangSet->transitionPenalty(mColorIndex, targetColor)
+                    : mDistanceToColor.at(targetColor);
+}
+
 TILEDSHARED_EXPORT QString wangSetTypeToString(WangSet::Type type);
 TILEDSHARED_EXPORT WangSet::Type wangSetTypeFromString(const QString &);
 
@@ -55,6 +55,7 @@ void World::setMapRect(int mapIndex, const QRect &rect)
 void World::removeMap(int mapIndex)
 {
     maps.removeAt(mapIndex);
+    mMapIndexesDirty = true;
 }
 
 void World::addMap(const QString &fileName, const QRect &rect)
@@ -63,23 +64,35 @@ void World::addMap(const QString &fileName, const QRect &rect)
     entry.rect = rect;
     entry.fileName = fileName;
     maps.append(entry);
+
+    if (!mMapIndexesDirty)
+        mMapIndexes.insert(fileName, maps.size() - 1);
 }
 
 int World::mapIndex(const QString &fileName) const
 {
-    for (int i = 0; i < maps.length(); i++) {
-        if (maps[i].fileName == fileName)
-            return i;
+    // The maps are public, so also rebuild the index when it is out of sync
+    if (mMapIndexesDirty || mMapIndexes.size() != maps.size()) {
+        mMapIndexes.clear();
+        mMapIndexes.reserve(maps.size());
+        for (int i = maps.size() - 1; i >= 0; --i)
+            mMapIndexes.insert(maps.at(i).fileName, i);
+        mMapIndexesDirty = false;
+    }
+
+    const int index = mMapIndexes.value(fileName, -1);
+    if (index != -1 && maps.at(index).fileName != fileName) {
+        mMapIndexesDirty = true;
+        return mapIndex(fileName);
     }
-    return -1;
+
+    return index;
 }
 
 bool World::containsMap(const QString &fileName) const
 {
-    for (const WorldMapEntry &mapEntry : maps) {
-        if (mapEntry.fileName == fileName)
-            return true;
-    }
+    if (mapIndex(fileName) != -1)
+        return true;
 
     // Currently patterns can only be used to search for maps in the same
     // folder as the .world file. It could be useful to support a "prefix" or
@@ -98,10 +111,9 @@ bool World::containsMap(const QString &fileName) const
 
 QRect World::mapRect(const QString &fileName) const
 {
-    for (const WorldMapEntry &mapEntry : maps) {
-       if (mapEntry.fileName == fileName)
-            return mapEntry.rect;
-    }
+    const int index = mapIndex(fileName);
+    if (index != -1)
+        return maps.at(index).rect;
 
     for (const WorldPattern &pattern : patterns) {
         QRegularExpressionMatch match = pattern.regexp.match(fileName);
@@ -126,46 +138,69 @@ QRect World::mapRect(const QString &fileName) const
 QVector<WorldMapEntry> World::allMaps() const
 {
     QVector<WorldMapEntry> all(maps);
+    all.append(patternMaps());
+    return all;
+}
+
+/**
+ * Returns the maps matched by the patterns of this world. The directory is
+ * only listed again when it has been modified since it was last listed.
+ */
+const QVector<WorldMapEntry> &World::patternMaps() const
+{
+    if (patterns.isEmpty()) {
+        mPatternMaps.clear();
+        return mPatternMaps;
+    }
+
+    const QDir dir(QFileInfo(fileName).dir());
+    const QDateTime lastModified = QFileInfo(dir.path()).lastModified();
+    if (mPatternMapsLastModified.isValid() && mPatternMapsLastModified == lastModified)
+        return mPatternMaps;
 
-    if (!patterns.isEmpty()) {
-        const QDir dir(QFileInfo(fileName).dir());
-        const QStringList entries = dir.entryList(QDir::Files | QDir::Readable);
+    mPatternMaps.clear();
+    mPatternMapsLastModified = lastModified;
 
-        for (const WorldPattern &pattern : patterns) {
-            for (const QString &fileName : entries) {
-                QRegularExpressionMatch match = pattern.regexp.match(fileName);
-                if (match.hasMatch()) {
+    const QStringList entries = dir.entryList(QDir::Files | QDir::Readable);
+
+    for (const WorldPattern &pattern : patterns) {
+        for (const QString &fileName : entries) {
+            QRegularExpressionMatch match = pattern.regexp.match(fileName);
+            if (match.hasMatch()) {
 #if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
-                    const int x = match.capturedView(1).toInt();
-                    const int y = match.capturedView(2).toInt();
+                const int x = match.capturedView(1).toInt();
+                const int y = match.capturedView(2).toInt();
 #else
-                    const int x = match.capturedRef(1).toInt();
-                    const int y = match.capturedRef(2).toInt();
+                const int x = match.capturedRef(1).toInt();
+                const int y = match.capturedRef(2).toInt();
 #endif
 
-                    WorldMapEntry entry;
-                    entry.fileName = dir.filePath(fileName);
-                    entry.rect = QRect(QPoint(x * pattern.multiplierX,
-                                              y * pattern.multiplierY) + pattern.offset,
-                                       pattern.mapSize);
-                    all.append(entry);
-                }
+                WorldMapEntry entry;
+                entry.fileName = dir.filePath(fileName);
+                entry.rect = QRect(QPoint(x * pattern.multiplierX,
+                                          y * pattern.multiplierY) + pattern.offset,
+                                   pattern.mapSize);
+                mPatternMaps.append(entry);
             }
         }
     }
 
-    return all;
+    return mPatternMaps;
 }
 
 QVector<WorldMapEntry> World::mapsInRect(const QRect &rect) const
 {
-    QVector<WorldMapEntry> maps(allMaps());
+    QVector<WorldMapEntry> result;
 
-    maps.erase(std::remove_if(maps.begin(), maps.end(),
-                              [&](const WorldMapEntry &mapEntry) { return !mapEntry.rect.intersects(rect); }),
-               maps.end());
+    for (const WorldMapEntry &mapEntry : maps)
+        if (mapEntry.rect.intersects(rect))
+            result.append(mapEntry);
 
-    return maps;
+    for (const WorldMapEntry &mapEntry : patternMaps())
+        if (mapEntry.rect.intersects(rect))
+            result.append(mapEntry);
+
+    return result;
 }
 
 QVector<WorldMapEntry> World::contextMaps(const QString &fileName) const
@@ -180,18 +215,9 @@ QString World::firstMap() const
     if (!maps.isEmpty())
         return maps.first().fileName;
 
-    if (!patterns.isEmpty()) {
-        const QDir dir(QFileInfo(fileName).dir());
-        const QStringList entries = dir.entryList(QDir::Files | QDir::Readable);
-
-        for (const WorldPattern &pattern : patterns) {
-            for (const QString &fileName : entries) {
-                QRegularExpressionMatch match = pattern.regexp.match(fileName);
-                if (match.hasMatch())
-                    return dir.filePath(fileName);
-            }
-        }
-    }
+    const auto &patternMaps = this->patternMaps();
+    if (!patternMaps.isEmpty())
+        return patternMaps.first().fileName;
 
     return QString();
 }
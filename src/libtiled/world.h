@@ -31,6 +31,8 @@
 #include "object.h"
 
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QHash>
 #include <QPoint>
 #include <QRect>
 #include <QRegularExpression>
@@ -110,6 +112,17 @@ public:
                                        QString *errorString = nullptr);
     static bool save(World &world,
                      QString *errorString = nullptr);
+
+private:
+    const QVector<WorldMapEntry> &patternMaps() const;
+
+    // Index of the entries in 'maps' by file name, built on demand
+    mutable QHash<QString, int> mMapIndexes;
+    mutable bool mMapIndexesDirty = true;
+
+    // Maps matched by the patterns, until the directory changes
+    mutable QVector<WorldMapEntry> mPatternMaps;
+    mutable QDateTime mPatternMapsLastModified;
 };
 
 } // namespace Tiled
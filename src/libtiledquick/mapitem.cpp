@@ -25,6 +25,7 @@
 #include "map.h"
 #include "maprenderer.h"
 #include "tilelayer.h"
+#include "tileset.h"
 
 #include <cmath>
 
@@ -146,6 +147,7 @@ void MapItem::refresh()
 
     qDeleteAll(mTileLayerItems);
     mTileLayerItems.clear();
+    mTilesetImages.clear();
 
     mRenderer = nullptr;
 
@@ -154,6 +156,11 @@ void MapItem::refresh()
 
     mRenderer = Tiled::MapRenderer::create(mMap);
 
+    // The tileset images were decoded while loading the map. Converting the
+    // pixmaps to images here avoids decoding them again on the render thread.
+    for (const Tiled::SharedTileset &tileset : mMap->tilesets())
+        mTilesetImages.insert(tileset.data(), tileset->image().toImage());
+
     for (Tiled::Layer *layer : mMap->layers()) {
         if (Tiled::TileLayer *tl = layer->asTileLayer()) {
             TileLayerItem *layerItem = new TileLayerItem(tl, mRenderer.get(), this);
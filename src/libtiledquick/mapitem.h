@@ -23,12 +23,15 @@
 #include "mapref.h"
 #include "tiledquick_global.h"
 
+#include <QHash>
+#include <QImage>
 #include <QQuickItem>
 
 #include <memory>
 
 namespace Tiled {
 class MapRenderer;
+class Tileset;
 } // namespace Tiled
 
 namespace TiledQuick {
@@ -59,6 +62,8 @@ public:
 
     QRectF boundingRect() const override;
 
+    QImage tilesetImage(Tiled::Tileset *tileset) const;
+
     Q_INVOKABLE QPointF screenToTileCoords(qreal x, qreal y) const;
     Q_INVOKABLE QPointF screenToTileCoords(const QPointF &position) const;
     Q_INVOKABLE QPointF tileToScreenCoords(qreal x, qreal y) const;
@@ -84,6 +89,7 @@ private:
 
     std::unique_ptr<Tiled::MapRenderer> mRenderer;
     QList<TileLayerItem*> mTileLayerItems;
+    QHash<Tiled::Tileset*, QImage> mTilesetImages;
 };
 
 inline const QRectF &MapItem::visibleArea() const
@@ -91,6 +97,16 @@ inline const QRectF &MapItem::visibleArea() const
     return mVisibleArea;
 }
 
+/**
+ * Returns the image of the given \a tileset, which is used to create its
+ * texture. This is called on the render thread, while the GUI thread is
+ * blocked.
+ */
+inline QImage MapItem::tilesetImage(Tiled::Tileset *tileset) const
+{
+    return mTilesetImages.value(tileset);
+}
+
 inline MapRef MapItem::map() const
 {
     return mMap;
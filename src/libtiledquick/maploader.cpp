@@ -25,6 +25,8 @@
 #include "tiled.h"
 #include "tileset.h"
 
+#include <QTimer>
+
 using namespace TiledQuick;
 
 MapLoader::MapLoader(QObject *parent)
@@ -44,10 +46,29 @@ void MapLoader::setSource(const QUrl &source)
         return;
 
     m_source = source;
+    emit sourceChanged(source);
+
+    if (m_status != Loading) {
+        m_status = Loading;
+        emit statusChanged(m_status);
+    }
+
+    // The map is read on the next iteration of the event loop, so that the
+    // loading status can be displayed first. When the source is changed
+    // again before that, only the last source is loaded.
+    if (!m_loadPending) {
+        m_loadPending = true;
+        QTimer::singleShot(0, this, &MapLoader::load);
+    }
+}
+
+void MapLoader::load()
+{
+    m_loadPending = false;
 
     Tiled::MapReader mapReader;
 
-    std::unique_ptr<Tiled::Map> map(mapReader.readMap(Tiled::urlToLocalFileOrQrc(source)));
+    std::unique_ptr<Tiled::Map> map(mapReader.readMap(Tiled::urlToLocalFileOrQrc(m_source)));
     Status status = map ? Ready : Error;
     QString error = map ? QString() : mapReader.errorString();
 
@@ -59,8 +80,6 @@ void MapLoader::setSource(const QUrl &source)
     m_status = status;
     m_error = error;
 
-    emit sourceChanged(source);
-
     if (mapDiff)
         emit mapChanged(m_map.get());
     if (statusDiff)
@@ -35,7 +35,7 @@ class TILEDQUICK_SHARED_EXPORT MapLoader : public QObject
     Q_OBJECT
 
     Q_PROPERTY(QUrl source READ source WRITE setSource NOTIFY sourceChanged)
-    Q_PROPERTY(TiledQuick::MapRef map READ map NOTIFY sourceChanged)
+    Q_PROPERTY(TiledQuick::MapRef map READ map NOTIFY mapChanged)
     Q_PROPERTY(Status status READ status NOTIFY statusChanged)
     Q_PROPERTY(QString error READ error NOTIFY errorChanged)
 
@@ -43,7 +43,8 @@ public:
     enum Status {
         Null,
         Ready,
-        Error
+        Error,
+        Loading
     };
     Q_ENUM(Status)
 
@@ -65,10 +66,13 @@ public slots:
     void setSource(const QUrl &source);
 
 private:
+    void load();
+
     QUrl m_source;
     std::unique_ptr<Tiled::Map> m_map;
     Status m_status;
     QString m_error;
+    bool m_loadPending = false;
 };
 
 
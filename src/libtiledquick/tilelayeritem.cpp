@@ -35,22 +35,34 @@
 using namespace Tiled;
 using namespace TiledQuick;
 
+/**
+ * The geometry is rebuilt when the area it was built for is more than this
+ * factor larger than the visible area. With the margins added on each side,
+ * the prepared area is at most 4 times as large as the visible area.
+ */
+static constexpr qreal MaxPreparedAreaFactor = 9;
+
 namespace {
 
 /**
- * Returns the texture of a given tileset, or 0 if the image has not been
- * loaded yet.
+ * Returns the texture for the image of a tileset, or 0 if the tileset has no
+ * image.
+ *
+ * The image was already decoded when the map was loaded, so this only needs
+ * to upload it.
  */
-static inline QSGTexture *tilesetTexture(Tileset *tileset,
+static inline QSGTexture *tilesetTexture(const QImage &image,
                                          QQuickWindow *window)
 {
-    static QHash<Tileset *, QSGTexture *> cache;
+    static QHash<qint64, QSGTexture *> cache;
+
+    if (image.isNull())
+        return nullptr;
 
-    QSGTexture *texture = cache.value(tileset);
+    QSGTexture *texture = cache.value(image.cacheKey());
     if (!texture) {
-        const QString imagePath(Tiled::urlToLocalFileOrQrc(tileset->imageSource()));
-        texture = window->createTextureFromImage(QImage(imagePath));
-        cache.insert(tileset, texture);
+        texture = window->createTextureFromImage(image);
+        cache.insert(image.cacheKey(), texture);
     }
     return texture;
 }
@@ -62,7 +74,8 @@ static inline QSGTexture *tilesetTexture(Tileset *tileset,
 struct TilesetHelper
 {
     TilesetHelper(const MapItem *mapItem)
-        : mWindow(mapItem->window())
+        : mMapItem(mapItem)
+        , mWindow(mapItem->window())
         , mTileset(nullptr)
         , mTexture(nullptr)
         , mMargin(0)
@@ -78,7 +91,7 @@ struct TilesetHelper
     void setTileset(Tileset *tileset)
     {
         mTileset = tileset;
-        mTexture = tilesetTexture(tileset, mWindow);
+        mTexture = tilesetTexture(mMapItem->tilesetImage(tileset), mWindow);
         if (!mTexture)
             return;
 
@@ -103,6 +116,7 @@ struct TilesetHelper
     }
 
 private:
+    const MapItem *mMapItem;
     QQuickWindow *mWindow;
     Tileset *mTileset;
     QSGTexture *mTexture;
@@ -216,10 +230,27 @@ void TileLayerItem::updateVisibleTiles()
                 drawMargins.left(),
                 drawMargins.top());
 
-    rect &= mRenderer->boundingRect(mLayer->localBounds());
+    const QRectF layerBounds = mRenderer->boundingRect(mLayer->localBounds());
+    rect &= layerBounds;
+
+    // The geometry is built for an area larger than the visible one, so that
+    // it can be reused while panning. It is only built again when the visible
+    // area moves outside of it, or when it became much larger than needed
+    // (after zooming in).
+    const qreal visibleSize = rect.width() * rect.height();
+    const qreal preparedSize = mVisibleArea.width() * mVisibleArea.height();
+
+    if (rect.isEmpty() || mVisibleArea.contains(rect)) {
+        if (preparedSize <= visibleSize * MaxPreparedAreaFactor)
+            return;
+    }
+
+    const qreal marginX = rect.width() / 2;
+    const qreal marginY = rect.height() / 2;
+    const QRectF preparedArea = rect.adjusted(-marginX, -marginY, marginX, marginY) & layerBounds;
 
-    if (mVisibleArea != rect) {
-        mVisibleArea = rect;
+    if (mVisibleArea != preparedArea) {
+        mVisibleArea = preparedArea;
         update();
     }
 }
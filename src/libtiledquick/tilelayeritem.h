@@ -70,7 +70,7 @@ private:
 
     Tiled::TileLayer *mLayer;
     Tiled::MapRenderer *mRenderer;
-    QRectF mVisibleArea;
+    QRectF mVisibleArea;    // The area for which the geometry was built
 };
 
 /**
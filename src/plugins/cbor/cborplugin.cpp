@@ -0,0 +1,543 @@
+/*
+ * CBOR Tiled Plugin
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cborplugin.h"
+
+#include "map.h"
+#include "maptovariantconverter.h"
+#include "savefile.h"
+#include "varianttomapconverter.h"
+
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <limits>
+
+using namespace Tiled;
+
+namespace Cbor {
+
+namespace {
+
+/**
+ * Writes a QVariant as produced by the MapToVariantConverter as a CBOR
+ * document. Values are written to the device while walking the variant,
+ * without building an intermediate QCborValue.
+ */
+class CborWriter
+{
+public:
+    explicit CborWriter(QIODevice *device)
+        : mWriter(device)
+    {}
+
+    bool write(const QVariant &variant);
+
+    const QString &errorString() const { return mError; }
+
+private:
+    void writeValue(const QVariant &variant);
+    void writeString(const QString &string);
+
+    QCborStreamWriter mWriter;
+    QString mError;
+};
+
+bool CborWriter::write(const QVariant &variant)
+{
+    mWriter.append(QCborKnownTags::Signature);
+    writeValue(variant);
+    return mError.isEmpty();
+}
+
+void CborWriter::writeValue(const QVariant &variant)
+{
+    const int type = variant.userType();
+
+    if (type == qMetaTypeId<QVector<unsigned>>()) {
+        // Tile layer data is written as a byte string of little-endian gids
+        const QVector<unsigned> gids = variant.value<QVector<unsigned>>();
+        QByteArray data(gids.size() * 4, Qt::Uninitialized);
+        qToLittleEndian<quint32>(gids.constData(), gids.size(), data.data());
+        mWriter.appendByteString(data.constData(), data.size());
+        return;
+    }
+
+    switch (type) {
+    case QMetaType::QVariantMap: {
+        const QVariantMap map = variant.toMap();
+
+        // The type is written first, so that it can be checked cheaply
+        const auto typeIt = map.constFind(QStringLiteral("type"));
+
+        mWriter.startMap(map.size());
+        if (typeIt != map.constEnd()) {
+            writeString(typeIt.key());
+            writeValue(typeIt.value());
+        }
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            if (it == typeIt)
+                continue;
+            writeString(it.key());
+            writeValue(it.value());
+        }
+        mWriter.endMap();
+        return;
+    }
+    case QMetaType::QVariantList:
+    case QMetaType::QStringList: {
+        const QVariantList list = variant.toList();
+        mWriter.startArray(list.size());
+        for (const QVariant &value : list)
+            writeValue(value);
+        mWriter.endArray();
+        return;
+    }
+    case QMetaType::QString:
+    case QMetaType::QByteArray:     // base64 encoded layer data
+        writeString(variant.toString());
+        return;
+    case QMetaType::Double:
+        mWriter.append(variant.toDouble());
+        return;
+    case QMetaType::Float:
+        mWriter.append(variant.toFloat());
+        return;
+    case QMetaType::Bool:
+        mWriter.append(variant.toBool());
+        return;
+    case QMetaType::UnknownType:
+        mWriter.appendNull();
+        return;
+    case QMetaType::UInt:
+    case QMetaType::ULongLong:
+        mWriter.append(quint64(variant.toULongLong()));
+        return;
+    case QMetaType::Int:
+    case QMetaType::LongLong:
+        mWriter.append(qint64(variant.toLongLong()));
+        return;
+    }
+
+    if (variant.canConvert<qlonglong>()) {
+        mWriter.append(qint64(variant.toLongLong()));
+    } else if (variant.canConvert<QString>()) {
+        writeString(variant.toString());
+    } else {
+        if (!mError.isEmpty())
+            mError.append(QLatin1Char('\n'));
+        mError.append(QStringLiteral("Unsupported type %1 (id: %2)")
+                      .arg(QString::fromUtf8(variant.typeName())).arg(type));
+        mWriter.appendNull();
+    }
+}
+
+void CborWriter::writeString(const QString &string)
+{
+    const QByteArray utf8 = string.toUtf8();
+    mWriter.appendTextString(utf8.constData(), utf8.size());
+}
+
+
+/**
+ * Reads a CBOR document into a QVariant that can be passed to the
+ * VariantToMapConverter. Byte strings are interpreted as tile layer data
+ * and converted to a QVector<unsigned>.
+ */
+class CborReader
+{
+public:
+    explicit CborReader(const QByteArray &data)
+        : mReader(data)
+    {}
+
+    QVariant read();
+    QString documentType();
+
+    QCborError error() const { return mReader.lastError(); }
+
+private:
+    QVariant readValue();
+    QString readString();
+    QByteArray readByteString();
+    void skipTags();
+
+    bool hasError() const { return mReader.lastError() != QCborError::NoError; }
+
+    QCborStreamReader mReader;
+};
+
+QVariant CborReader::read()
+{
+    skipTags();
+    return readValue();
+}
+
+/**
+ * Returns the value of the "type" member of the top-level map, when it is
+ * the first member, like it is in files written by this plugin.
+ */
+QString CborReader::documentType()
+{
+    skipTags();
+    if (!mReader.isMap() || !mReader.enterContainer())
+        return QString();
+    if (!mReader.hasNext() || !mReader.isString() || readString() != QLatin1String("type"))
+        return QString();
+    if (!mReader.isString())
+        return QString();
+    return readString();
+}
+
+QVariant CborReader::readValue()
+{
+    switch (mReader.type()) {
+    case QCborStreamReader::UnsignedInteger: {
+        const quint64 value = mReader.toUnsignedInteger();
+        mReader.next();
+        if (value <= quint64(std::numeric_limits<int>::max()))
+            return int(value);
+        if (value <= quint64(std::numeric_limits<qint64>::max()))
+            return qint64(value);
+        return value;
+    }
+    case QCborStreamReader::NegativeInteger: {
+        const qint64 value = mReader.toInteger();
+        mReader.next();
+        if (value >= std::numeric_limits<int>::min())
+            return int(value);
+        return value;
+    }
+    case QCborStreamReader::ByteString: {
+        const QByteArray data = readByteString();
+        if (data.size() % 4 != 0)
+            return data;    // left for the converter to report
+
+        QVector<unsigned> gids(data.size() / 4);
+        qFromLittleEndian<quint32>(data.constData(), gids.size(), gids.data());
+        return QVariant::fromValue(gids);
+    }
+    case QCborStreamReader::TextString:
+        return readString();
+    case QCborStreamReader::Array: {
+        QVariantList list;
+        if (mReader.isLengthKnown())
+            list.reserve(int(mReader.length()));
+
+        if (!mReader.enterContainer())
+            return QVariant();
+        while (!hasError() && mReader.hasNext())
+            list.append(readValue());
+        if (!hasError())
+            mReader.leaveContainer();
+        return list;
+    }
+    case QCborStreamReader::Map: {
+        QVariantMap map;
+        if (!mReader.enterContainer())
+            return QVariant();
+        while (!hasError() && mReader.hasNext()) {
+            if (!mReader.isString()) {
+                mReader.next();     // skip non-string key and its value
+                mReader.next();
+                continue;
+            }
+            const QString key = readString();
+            map.insert(key, readValue());
+        }
+        if (!hasError())
+            mReader.leaveContainer();
+        return map;
+    }
+    case QCborStreamReader::Tag:
+        skipTags();
+        return readValue();
+    case QCborStreamReader::SimpleType: {
+        QVariant value;
+        if (mReader.isBool())
+            value = mReader.toBool();
+        mReader.next();
+        return value;
+    }
+    case QCborStreamReader::Float16: {
+        const double value = float(mReader.toFloat16());
+        mReader.next();
+        return value;
+    }
+    case QCborStreamReader::Float: {
+        const double value = mReader.toFloat();
+        mReader.next();
+        return value;
+    }
+    case QCborStreamReader::Double: {
+        const double value = mReader.toDouble();
+        mReader.next();
+        return value;
+    }
+    case QCborStreamReader::Invalid:
+        break;
+    }
+
+    return QVariant();
+}
+
+QString CborReader::readString()
+{
+    QString string;
+    auto result = mReader.readString();
+    while (result.status == QCborStreamReader::Ok) {
+        string += result.data;
+        result = mReader.readString();
+    }
+    return string;
+}
+
+QByteArray CborReader::readByteString()
+{
+    QByteArray data;
+    if (mReader.isLengthKnown())
+        data.reserve(int(mReader.length()));
+
+    auto result = mReader.readByteArray();
+    while (result.status == QCborStreamReader::Ok) {
+        data += result.data;
+        result = mReader.readByteArray();
+    }
+    return data;
+}
+
+void CborReader::skipTags()
+{
+    while (mReader.isTag() && mReader.next())
+        ;
+}
+
+/**
+ * Returns the contents of the opened \a file, mapping it into memory when
+ * possible to avoid copying it.
+ */
+QByteArray fileContents(QFile &file)
+{
+    if (file.size() > 0 && file.size() <= std::numeric_limits<int>::max()) {
+        if (uchar *data = file.map(0, file.size()))
+            return QByteArray::fromRawData(reinterpret_cast<const char*>(data), int(file.size()));
+    }
+    return file.readAll();
+}
+
+QString documentType(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+
+    CborReader reader(fileContents(file));
+    return reader.documentType();
+}
+
+} // anonymous namespace
+
+
+void CborPlugin::initialize()
+{
+    addObject(new CborMapFormat(this));
+    addObject(new CborTilesetFormat(this));
+}
+
+
+CborMapFormat::CborMapFormat(QObject *parent)
+    : MapFormat(parent)
+{}
+
+std::unique_ptr<Map> CborMapFormat::read(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mError = QCoreApplication::translate("File Errors", "Could not open file for reading.");
+        return nullptr;
+    }
+
+    CborReader reader(fileContents(file));
+    const QVariant variant = reader.read();
+
+    if (reader.error() != QCborError::NoError) {
+        mError = tr("Error parsing file: %1").arg(reader.error().toString());
+        return nullptr;
+    }
+
+    VariantToMapConverter converter;
+    auto map = converter.toMap(variant, QFileInfo(fileName).dir());
+
+    if (!map)
+        mError = converter.errorString();
+
+    return map;
+}
+
+bool CborMapFormat::supportsFile(const QString &fileName) const
+{
+    if (!fileName.endsWith(QLatin1String(".cbor"), Qt::CaseInsensitive))
+        return false;
+
+    return documentType(fileName) == QLatin1String("map");
+}
+
+bool CborMapFormat::write(const Map *map, const QString &fileName, Options options)
+{
+    Q_UNUSED(options)
+
+    SaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+        return false;
+    }
+
+    MapToVariantConverter converter;
+    converter.setCompactTileData(true);
+    const QVariant variant = converter.toVariant(*map, QFileInfo(fileName).dir());
+
+    CborWriter writer(file.device());
+    if (!writer.write(variant)) {
+        // This can only happen due to coding error
+        mError = writer.errorString();
+        return false;
+    }
+
+    if (file.error() != QFileDevice::NoError) {
+        mError = tr("Error while writing file:\n%1").arg(file.errorString());
+        return false;
+    }
+
+    if (!file.commit()) {
+        mError = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+QString CborMapFormat::nameFilter() const
+{
+    return tr("CBOR map files (*.cbor)");
+}
+
+QString CborMapFormat::shortName() const
+{
+    return QStringLiteral("cbor");
+}
+
+QString CborMapFormat::errorString() const
+{
+    return mError;
+}
+
+
+CborTilesetFormat::CborTilesetFormat(QObject *parent)
+    : TilesetFormat(parent)
+{}
+
+SharedTileset CborTilesetFormat::read(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mError = QCoreApplication::translate("File Errors", "Could not open file for reading.");
+        return SharedTileset();
+    }
+
+    CborReader reader(fileContents(file));
+    const QVariant variant = reader.read();
+
+    if (reader.error() != QCborError::NoError) {
+        mError = tr("Error parsing file: %1").arg(reader.error().toString());
+        return SharedTileset();
+    }
+
+    VariantToMapConverter converter;
+    SharedTileset tileset = converter.toTileset(variant, QFileInfo(fileName).dir());
+
+    if (!tileset)
+        mError = converter.errorString();
+
+    return tileset;
+}
+
+bool CborTilesetFormat::supportsFile(const QString &fileName) const
+{
+    if (!fileName.endsWith(QLatin1String(".cbor"), Qt::CaseInsensitive))
+        return false;
+
+    return documentType(fileName) == QLatin1String("tileset");
+}
+
+bool CborTilesetFormat::write(const Tileset &tileset, const QString &fileName, Options options)
+{
+    Q_UNUSED(options)
+
+    SaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+        return false;
+    }
+
+    MapToVariantConverter converter;
+    const QVariant variant = converter.toVariant(tileset, QFileInfo(fileName).dir());
+
+    CborWriter writer(file.device());
+    if (!writer.write(variant)) {
+        // This can only happen due to coding error
+        mError = writer.errorString();
+        return false;
+    }
+
+    if (file.error() != QFileDevice::NoError) {
+        mError = tr("Error while writing file:\n%1").arg(file.errorString());
+        return false;
+    }
+
+    if (!file.commit()) {
+        mError = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+QString CborTilesetFormat::nameFilter() const
+{
+    return tr("CBOR tileset files (*.cbor)");
+}
+
+QString CborTilesetFormat::shortName() const
+{
+    return QStringLiteral("cbor");
+}
+
+QString CborTilesetFormat::errorString() const
+{
+    return mError;
+}
+
+} // namespace Cbor
@@ -0,0 +1,91 @@
+/*
+ * CBOR Tiled Plugin
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cbor_global.h"
+
+#include "mapformat.h"
+#include "plugin.h"
+#include "tilesetformat.h"
+
+namespace Cbor {
+
+class CBORSHARED_EXPORT CborPlugin : public Tiled::Plugin
+{
+    Q_OBJECT
+    Q_INTERFACES(Tiled::Plugin)
+    Q_PLUGIN_METADATA(IID "org.mapeditor.Plugin" FILE "plugin.json")
+
+public:
+    void initialize() override;
+};
+
+
+/**
+ * A binary equivalent of the JSON map format. The map is stored with the
+ * same structure as a JSON map, but encoded as CBOR. Tile layer data is
+ * stored as byte strings of little-endian 32-bit global tile IDs, instead
+ * of arrays of numbers.
+ */
+class CBORSHARED_EXPORT CborMapFormat : public Tiled::MapFormat
+{
+    Q_OBJECT
+    Q_INTERFACES(Tiled::MapFormat)
+
+public:
+    CborMapFormat(QObject *parent = nullptr);
+
+    std::unique_ptr<Tiled::Map> read(const QString &fileName) override;
+    bool supportsFile(const QString &fileName) const override;
+
+    bool write(const Tiled::Map *map, const QString &fileName, Options options) override;
+
+    QString nameFilter() const override;
+    QString shortName() const override;
+    QString errorString() const override;
+
+protected:
+    QString mError;
+};
+
+
+class CBORSHARED_EXPORT CborTilesetFormat : public Tiled::TilesetFormat
+{
+    Q_OBJECT
+    Q_INTERFACES(Tiled::TilesetFormat)
+
+public:
+    CborTilesetFormat(QObject *parent = nullptr);
+
+    Tiled::SharedTileset read(const QString &fileName) override;
+    bool supportsFile(const QString &fileName) const override;
+
+    bool write(const Tiled::Tileset &tileset, const QString &fileName, Options options) override;
+
+    QString nameFilter() const override;
+    QString shortName() const override;
+    QString errorString() const override;
+
+protected:
+    QString mError;
+};
+
+} // namespace Cbor
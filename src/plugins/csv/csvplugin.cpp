@@ -29,7 +29,11 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
 #include <QRegularExpression>
+#include <QtConcurrent>
+
+#include <vector>
 
 using namespace Tiled;
 using namespace Csv;
@@ -44,6 +48,98 @@ CsvPlugin::CsvPlugin()
 {
 }
 
+/**
+ * Appends \a value in decimal notation, avoiding the temporary byte array
+ * that QByteArray::number would allocate.
+ */
+static void appendNumber(QByteArray &out, int value)
+{
+    char buffer[12];
+    char *end = buffer + sizeof(buffer);
+    char *begin = end;
+
+    // Work with an unsigned value so that the minimum int has no overflow
+    unsigned magnitude = value < 0 ? 0u - static_cast<unsigned>(value)
+                                   : static_cast<unsigned>(value);
+    do {
+        *--begin = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+
+    if (value < 0)
+        *--begin = '-';
+
+    out.append(begin, static_cast<int>(end - begin));
+}
+
+static QByteArray layerData(const Map *map, const TileLayer *tileLayer)
+{
+    QRect bounds = map->infinite() ? tileLayer->region().boundingRect() : tileLayer->rect();
+    bounds.translate(-tileLayer->position());
+
+    QByteArray data;
+    data.reserve(bounds.width() * bounds.height() * 4);
+
+    // Tiles with a "name" property are rare, but looking up the property
+    // for every cell is not cheap
+    struct TileName
+    {
+        bool hasName;
+        QByteArray name;
+    };
+
+    QHash<const Tile*, TileName> tileNames;
+    auto tileName = [&] (const Tile *tile) -> const TileName & {
+        auto it = tileNames.find(tile);
+        if (it == tileNames.end()) {
+            TileName entry { tile->hasProperty(QLatin1String("name")), QByteArray() };
+            if (entry.hasName)
+                entry.name = tile->property(QLatin1String("name")).toString().toUtf8();
+            it = tileNames.insert(tile, entry);
+        }
+        return it.value();
+    };
+
+    // Write out tiles either by ID or their name, if given. -1 is "empty"
+    tileLayer->forEachSpan(bounds, [&] (int x, int, const Cell *cells, int count) {
+        for (int i = 0; i < count; ++i, ++x) {
+            if (x > bounds.left())
+                data.append(',');
+
+            const Cell &cell = cells[i];
+            const Tile *tile = cell.tile();
+            if (!tile) {
+                data.append("-1", 2);
+                continue;
+            }
+
+            const TileName &name = tileName(tile);
+            if (name.hasName) {
+                data.append(name.name);
+                continue;
+            }
+
+            int id = tile->id();
+
+            if (cell.flippedHorizontally())
+                id |= FlippedHorizontallyFlag;
+            if (cell.flippedVertically())
+                id |= FlippedVerticallyFlag;
+            if (cell.flippedAntiDiagonally())
+                id |= FlippedAntiDiagonallyFlag;
+            if (cell.rotatedHexagonal120())
+                id |= RotatedHexagonal120Flag;
+
+            appendNumber(data, id);
+        }
+
+        if (x > bounds.right())
+            data.append('\n');
+    });
+
+    return data;
+}
+
 bool CsvPlugin::write(const Map *map, const QString &fileName, Options options)
 {
     Q_UNUSED(options)
@@ -51,69 +147,50 @@ bool CsvPlugin::write(const Map *map, const QString &fileName, Options options)
     // Get file paths for each layer
     const QStringList layerPaths = outputFiles(map, fileName);
 
-    // Traverse all tile layers
+    struct LayerFile
+    {
+        const TileLayer *tileLayer;
+        QString fileName;
+        QString error;
+    };
+
+    std::vector<LayerFile> layerFiles;
+
     int currentLayer = 0;
     for (const Layer *layer : map->tileLayers()) {
-        const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
+        layerFiles.push_back(LayerFile { static_cast<const TileLayer*>(layer),
+                                         layerPaths.at(currentLayer),
+                                         QString() });
+        ++currentLayer;
+    }
 
-        SaveFile file(layerPaths.at(currentLayer));
+    // Each layer is written to its own file, so they are handled in parallel
+    QtConcurrent::blockingMap(layerFiles, [map] (LayerFile &layerFile) {
+        SaveFile file(layerFile.fileName);
 
         if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
-            mError += QLatin1String("\n");
-            mError += layerPaths.at(currentLayer);
-            return false;
+            layerFile.error = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+            layerFile.error += QLatin1String("\n");
+            layerFile.error += layerFile.fileName;
+            return;
         }
 
-        auto device = file.device();
-
-        QRect bounds = map->infinite() ? tileLayer->region().boundingRect() : tileLayer->rect();
-        bounds.translate(-layer->position());
-
-        // Write out tiles either by ID or their name, if given. -1 is "empty"
-        for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
-            for (int x = bounds.left(); x <= bounds.right(); ++x) {
-                if (x > bounds.left())
-                    device->write(",", 1);
-
-                const Cell &cell = tileLayer->cellAt(x, y);
-                const Tile *tile = cell.tile();
-                if (tile && tile->hasProperty(QLatin1String("name"))) {
-                    device->write(tile->property(QLatin1String("name")).toString().toUtf8());
-                } else {
-                    int id = -1;
-
-                    if (tile) {
-                        id = tile->id();
-
-                        if (cell.flippedHorizontally())
-                            id |= FlippedHorizontallyFlag;
-                        if (cell.flippedVertically())
-                            id |= FlippedVerticallyFlag;
-                        if (cell.flippedAntiDiagonally())
-                            id |= FlippedAntiDiagonallyFlag;
-                        if (cell.rotatedHexagonal120())
-                            id |= RotatedHexagonal120Flag;
-                    }
-
-                    device->write(QByteArray::number(id));
-                }
-            }
-
-            device->write("\n", 1);
-        }
+        file.device()->write(layerData(map, layerFile.tileLayer));
 
         if (file.error() != QFileDevice::NoError) {
-            mError = file.errorString();
-            return false;
+            layerFile.error = file.errorString();
+            return;
         }
 
-        if (!file.commit()) {
-            mError = file.errorString();
+        if (!file.commit())
+            layerFile.error = file.errorString();
+    });
+
+    for (const LayerFile &layerFile : layerFiles) {
+        if (!layerFile.error.isEmpty()) {
+            mError = layerFile.error;
             return false;
         }
-
-        ++currentLayer;
     }
 
     return true;
@@ -30,59 +30,68 @@
 #include "tilelayer.h"
 
 #include <QCoreApplication>
-#include <QTextStream>
+#include <QtConcurrent>
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace Defold {
 
-static const char cell_t[] =
-"  cell {\n\
-    x: {{x}}\n\
-    y: {{y}}\n\
-    tile: {{tile}}\n\
-    h_flip: {{h_flip}}\n\
-    v_flip: {{v_flip}}\n\
-    rotate90: {{rotate90}}\n\
-  }\n";
-
-static const char layer_t[] =
-"layers {\n\
-  id: \"{{id}}\"\n\
-  z: {{z}}\n\
-  is_visible: {{is_visible}}\n\
-{{cells}}\
-}\n";
-
-static const char map_t[] =
-"tile_set: \"{{tile_set}}\"\n\
-{{layers}}\n\
-material: \"{{material}}\"\n\
-blend_mode: {{blend_mode}}\n";
-
-static QString replaceTags(QString context, const QVariantHash &map)
+/**
+ * Appends the cells of \a tileLayer to \a out, ordered by column.
+ *
+ * Writes to a byte array directly rather than filling in a template for
+ * each cell, since large maps have many cells.
+ */
+static void appendCells(QByteArray &out, const Tiled::TileLayer &tileLayer)
 {
-    QHashIterator<QString,QVariant> it{map};
-    while (it.hasNext()) {
-        it.next();
-        context.replace(QLatin1String("{{") + it.key() + QLatin1String("}}"),
-                        it.value().toString());
-    }
-    return context;
-}
+    struct PlacedCell
+    {
+        int x;
+        int y;
+        Tiled::Cell cell;
+    };
+
+    std::vector<PlacedCell> cells;
+
+    const QRect rect(0, 0, tileLayer.width(), tileLayer.height());
+    tileLayer.forEachSpan(rect, [&] (int startX, int y, const Tiled::Cell *spanCells, int count) {
+        for (int i = 0; i < count; ++i)
+            if (!spanCells[i].isEmpty())
+                cells.push_back(PlacedCell { startX + i, y, spanCells[i] });
+    });
+
+    // The spans are visited by row, while the cells are written by column
+    std::stable_sort(cells.begin(), cells.end(), [] (const PlacedCell &a, const PlacedCell &b) {
+        return a.x < b.x;
+    });
+
+    for (const PlacedCell &placed : cells) {
+        const Tiled::Cell &cell = placed.cell;
+
+        bool hFlip = cell.flippedHorizontally();
+        bool vFlip = cell.flippedVertically();
+        const bool rotate90 = cell.flippedAntiDiagonally();
+
+        if (rotate90) {
+            hFlip = cell.flippedVertically();
+            vFlip = !cell.flippedHorizontally();
+        }
 
-static void setCellProperties(QVariantHash &cellHash, const Tiled::Cell &cell)
-{
-    cellHash["tile"] = cell.tileId();
-
-    if (cell.flippedAntiDiagonally()) {
-        cellHash["h_flip"] = cell.flippedVertically() ? 1 : 0;
-        cellHash["v_flip"] = cell.flippedHorizontally() ? 0 : 1;
-        cellHash["rotate90"] = 1;
-    } else {
-        cellHash["h_flip"] = cell.flippedHorizontally() ? 1 : 0;
-        cellHash["v_flip"] = cell.flippedVertically() ? 1 : 0;
-        cellHash["rotate90"] = 0;
+        out += "  cell {\n    x: ";
+        out += QByteArray::number(placed.x);
+        out += "\n    y: ";
+        out += QByteArray::number(tileLayer.height() - placed.y - 1);
+        out += "\n    tile: ";
+        out += QByteArray::number(cell.tileId());
+        out += "\n    h_flip: ";
+        out += hFlip ? '1' : '0';
+        out += "\n    v_flip: ";
+        out += vFlip ? '1' : '0';
+        out += "\n    rotate90: ";
+        out += rotate90 ? '1' : '0';
+        out += "\n  }\n";
     }
 }
 
@@ -116,9 +125,15 @@ bool DefoldPlugin::write(const Tiled::Map *map, const QString &fileName, Options
 {
     Q_UNUSED(options)
 
-    QVariantHash map_h;
+    struct LayerData
+    {
+        const Tiled::TileLayer *tileLayer;
+        double z;
+        QByteArray cells;
+    };
+
+    std::vector<LayerData> layers;
 
-    QString layers;
     Tiled::LayerIterator it(map, Tiled::Layer::TileLayerType);
     double z = 0.0;
 
@@ -126,53 +141,39 @@ bool DefoldPlugin::write(const Tiled::Map *map, const QString &fileName, Options
         // Defold exports the z value to be between -1 and 1, so these
         // automatic increments should allow up to 10000 layers.
         z = optionalProperty(tileLayer, QStringLiteral("z"), z + 0.0001);
-
-        QVariantHash layer_h;
-        layer_h["id"] = tileLayer->name();
-        layer_h["z"] = z;
-        layer_h["is_visible"] = tileLayer->isVisible() ? 1 : 0;
-        QString cells;
-
-        for (int x = 0; x < tileLayer->width(); ++x) {
-            for (int y = 0; y < tileLayer->height(); ++y) {
-                const Tiled::Cell &cell = tileLayer->cellAt(x, y);
-                if (cell.isEmpty())
-                    continue;
-                QVariantHash cell_h;
-                cell_h["x"] = x;
-                cell_h["y"] = tileLayer->height() - y - 1;
-                setCellProperties(cell_h, cell);
-                cells.append(replaceTags(QLatin1String(cell_t), cell_h));
-            }
-        }
-        layer_h["cells"] = cells;
-        layers.append(replaceTags(QLatin1String(layer_t), layer_h));
+        layers.push_back(LayerData { tileLayer, z, QByteArray() });
     }
-    map_h["layers"] = layers;
-    map_h["material"] = "/builtins/materials/tile_map.material";
-    map_h["blend_mode"] = "BLEND_MODE_ALPHA";
-    map_h["tile_set"] = map->property(QStringLiteral("tile_set")).toString();
-
-    QString result = replaceTags(QLatin1String(map_t), map_h);
-    Tiled::SaveFile mapFile(fileName);
-    if (!mapFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
-        return false;
-    }
-    QTextStream stream(mapFile.device());
-    stream << result;
 
-    if (mapFile.error() != QFileDevice::NoError) {
-        mError = mapFile.errorString();
-        return false;
+    // Formatting the cells is most of the work, and is done per layer in
+    // parallel
+    QtConcurrent::blockingMap(layers, [] (LayerData &layer) {
+        appendCells(layer.cells, *layer.tileLayer);
+    });
+
+    QByteArray result;
+    result += "tile_set: \"";
+    result += map->property(QStringLiteral("tile_set")).toString().toUtf8();
+    result += "\"\n";
+
+    for (const LayerData &layer : layers) {
+        result += "layers {\n  id: \"";
+        result += layer.tileLayer->name().toUtf8();
+        result += "\"\n  z: ";
+        result += QVariant(layer.z).toString().toUtf8();
+        result += "\n  is_visible: ";
+        result += layer.tileLayer->isVisible() ? '1' : '0';
+        result += '\n';
+        result += layer.cells;
+        result += "}\n";
     }
 
-    if (!mapFile.commit()) {
-        mError = mapFile.errorString();
-        return false;
-    }
+    result += "\nmaterial: \"/builtins/materials/tile_map.material\"\n"
+              "blend_mode: BLEND_MODE_ALPHA\n";
 
-    return true;
+    // Leave the file untouched when nothing changed, to avoid a reimport
+    // by the Defold editor
+    return Tiled::SaveFile::writeIfChanged(fileName, result,
+                                           QIODevice::Text, &mError);
 }
 
 } // namespace Defold
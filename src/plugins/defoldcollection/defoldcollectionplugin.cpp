@@ -27,41 +27,17 @@
 #include "tilelayer.h"
 #include "grouplayer.h"
 
-#include <QCoreApplication>
 #include <QDir>
 #include <QFileInfo>
-#include <QTextStream>
+#include <QHash>
+#include <QtConcurrent>
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace DefoldCollection {
 
-static const char cellTemplate[] =
-R"(  cell {
-    x: {{x}}
-    y: {{y}}
-    tile: {{tile}}
-    h_flip: {{h_flip}}
-    v_flip: {{v_flip}}
-    rotate90: {{rotate90}}
-  }
-)";
-
-static const char layerTemplate[] =
-R"(layers {
-  id: "{{id}}"
-  z: {{z}}
-  is_visible: {{is_visible}}
-{{cells}}}
-)";
-
-static const char tileMapTemplate[] =
-R"(tile_set: "{{tile_set}}"
-{{layers}}
-material: "{{material}}"
-blend_mode: {{blend_mode}}
-)";
-
 static const char collectionTemplate[] =
 R"(name: "default"
 scale_along_z: 0
@@ -218,19 +194,95 @@ static float zIndexForLayer(const Tiled::Map &map, const Tiled::Layer &inLayer,
     return 0;
 }
 
-static void setCellProperties(QVariantHash &cellHash, const Tiled::Cell &cell)
+using CellsByTileset = QHash<const Tiled::Tileset*, QByteArray>;
+
+/*
+ * Formats the cells of \a tileLayer, ordered by column and separated by the
+ * tileset they refer to.
+ *
+ * Writes to byte arrays directly rather than filling in a template for each
+ * cell, since large maps have many cells.
+ */
+static CellsByTileset formatCells(const Tiled::TileLayer &tileLayer)
 {
-    cellHash["tile"] = cell.tileId();
-
-    if (cell.flippedAntiDiagonally()) {
-        cellHash["h_flip"] = cell.flippedVertically() ? 1 : 0;
-        cellHash["v_flip"] = cell.flippedHorizontally() ? 0 : 1;
-        cellHash["rotate90"] = 1;
-    } else {
-        cellHash["h_flip"] = cell.flippedHorizontally() ? 1 : 0;
-        cellHash["v_flip"] = cell.flippedVertically() ? 1 : 0;
-        cellHash["rotate90"] = 0;
+    struct PlacedCell
+    {
+        int x;
+        int y;
+        Tiled::Cell cell;
+    };
+
+    std::vector<PlacedCell> placedCells;
+
+    const QRect rect(0, 0, tileLayer.width(), tileLayer.height());
+    tileLayer.forEachSpan(rect, [&] (int startX, int y, const Tiled::Cell *spanCells, int count) {
+        for (int i = 0; i < count; ++i)
+            if (!spanCells[i].isEmpty())
+                placedCells.push_back(PlacedCell { startX + i, y, spanCells[i] });
+    });
+
+    // The spans are visited by row, while the cells are written by column
+    std::stable_sort(placedCells.begin(), placedCells.end(), [] (const PlacedCell &a, const PlacedCell &b) {
+        return a.x < b.x;
+    });
+
+    CellsByTileset cells;
+
+    for (const PlacedCell &placed : placedCells) {
+        const Tiled::Cell &cell = placed.cell;
+
+        bool hFlip = cell.flippedHorizontally();
+        bool vFlip = cell.flippedVertically();
+        const bool rotate90 = cell.flippedAntiDiagonally();
+
+        if (rotate90) {
+            hFlip = cell.flippedVertically();
+            vFlip = !cell.flippedHorizontally();
+        }
+
+        QByteArray &out = cells[cell.tileset()];
+        out += "  cell {\n    x: ";
+        out += QByteArray::number(placed.x);
+        out += "\n    y: ";
+        out += QByteArray::number(tileLayer.height() - placed.y - 1);
+        out += "\n    tile: ";
+        out += QByteArray::number(cell.tileId());
+        out += "\n    h_flip: ";
+        out += hFlip ? '1' : '0';
+        out += "\n    v_flip: ";
+        out += vFlip ? '1' : '0';
+        out += "\n    rotate90: ";
+        out += rotate90 ? '1' : '0';
+        out += "\n  }\n";
     }
+
+    return cells;
+}
+
+static void appendLayer(QByteArray &out, const QString &id, float z,
+                        bool visible, const QByteArray &cells)
+{
+    out += "layers {\n  id: \"";
+    out += id.toUtf8();
+    out += "\"\n  z: ";
+    out += QVariant(z).toString().toUtf8();
+    out += "\n  is_visible: ";
+    out += visible ? '1' : '0';
+    out += '\n';
+    out += cells;
+    out += "}\n";
+}
+
+static QByteArray tileMap(const Tiled::Tileset &tileset, const QByteArray &layers)
+{
+    QByteArray result;
+    result += "tile_set: \"";
+    result += tileSource(tileset).toUtf8();
+    result += "\"\n";
+    result += layers;
+    result += "\nmaterial: \"/builtins/materials/tile_map.material\"\n"
+              "blend_mode: BLEND_MODE_ALPHA\n";
+    return result;
 }
 
 /*
@@ -258,96 +310,78 @@ bool DefoldCollectionPlugin::write(const Tiled::Map *map, const QString &collect
     QString tilesetFileDir = outputFilePath;
     tilesetFileDir.chop(outputFileName.length());
 
+    // Formatting the cells is most of the work, so it is done once for each
+    // relevant tile layer, in parallel
+    struct LayerCells
+    {
+        const Tiled::TileLayer *tileLayer;
+        CellsByTileset cells;
+    };
+
+    std::vector<LayerCells> layerCells;
+    for (auto layer : map->layers()) {
+        if (auto tileLayer = layer->asTileLayer()) {
+            layerCells.push_back(LayerCells { tileLayer, {} });
+        } else if (auto groupLayer = layer->asGroupLayer()) {
+            for (auto subLayer : groupLayer->layers())
+                if (auto tileLayer = subLayer->asTileLayer())
+                    layerCells.push_back(LayerCells { tileLayer, {} });
+        }
+    }
+
+    QtConcurrent::blockingMap(layerCells, [] (LayerCells &entry) {
+        entry.cells = formatCells(*entry.tileLayer);
+    });
+
+    QHash<const Tiled::TileLayer*, const CellsByTileset*> cellsForLayer;
+    for (const LayerCells &entry : layerCells)
+        cellsForLayer.insert(entry.tileLayer, &entry.cells);
+
+    // Files whose contents did not change are left untouched, to avoid
+    // triggering a reimport by the Defold editor
+    auto writeFile = [this] (const QString &fileName, const QByteArray &contents) {
+        return Tiled::SaveFile::writeIfChanged(fileName, contents,
+                                               QIODevice::Text, &mError);
+    };
+
     // dealing with top-level tile layers here only
     // create a tilemap file for each tileset this map uses, and for each of them create a "component" in the main embedded instance
     for (auto &tileset : map->tilesets()) {
         QString tilemapFilePath = tilesetFileDir;
         tilemapFilePath.append(mapName + "-" + tileset->name() + ".tilemap");
 
-        QVariantHash componentHash;
-        componentHash["tilemap_name"] = mapName + "-" + tileset->name();
-        componentHash["tilemap_rel_path"] = tilesetRelativePath(tilemapFilePath);
-
-        QVariantHash tileMapHash;
-
-        bool tilemapHasCells = false;
-
-        int componentCells = 0;
-        QString layers;
+        QByteArray layers;
         for (auto layer : map->layers()) {
-            if (layer->layerType() != Tiled::Layer::TileLayerType)
+            auto tileLayer = layer->asTileLayer();
+            if (!tileLayer)
                 continue;
-            auto tileLayer = static_cast<Tiled::TileLayer*>(layer);
-
-            QVariantHash layerHash;
-            layerHash["id"] = tileLayer->name();
-            layerHash["z"] = zIndexForLayer(*map, *tileLayer, true);
-            layerHash["is_visible"] = tileLayer->isVisible() ? 1 : 0;
-            QString cells;
-
-            for (int x = 0; x < tileLayer->width(); ++x) {
-                for (int y = 0; y < tileLayer->height(); ++y) {
-                    const Tiled::Cell &cell = tileLayer->cellAt(x, y);
-                    if (cell.isEmpty())
-                        continue;
-                    if (cell.tileset() != tileset) // skip cell if it doesn't belong to current tileset
-                        continue;
-
-                    tilemapHasCells = true;
-                    componentCells++;
-                    QVariantHash cellHash;
-                    cellHash["x"] = x;
-                    cellHash["y"] = tileLayer->height() - y - 1;
-                    setCellProperties(cellHash, cell);
-                    cells.append(replaceTags(QLatin1String(cellTemplate), cellHash));
-
-                    // Create a component for this embedded instance only when the first cell of this component is found.
-                    // If 0 cells are found, this component is not necessary.
-                    // If more than 1 cells are found, recreating it would be redundant.
-                    if (componentCells == 1)
-                        topLevelComponents.append(replaceTags(QLatin1String(componentTemplate), componentHash));
-                }
-            }
-            layerHash["cells"] = cells;
 
             // only add this layer to the .tilemap if it has any cells
+            const QByteArray cells = cellsForLayer.value(tileLayer)->value(tileset.data());
             if (!cells.isEmpty())
-                layers.append(replaceTags(QLatin1String(layerTemplate), layerHash));
+                appendLayer(layers, tileLayer->name(), zIndexForLayer(*map, *tileLayer, true),
+                            tileLayer->isVisible(), cells);
         }
+
         // make a check that this tilemap has cells at all, or no .tilesource file is necessary
-        if (tilemapHasCells) {
-            tileMapHash["layers"] = layers;
-            tileMapHash["material"] = "/builtins/materials/tile_map.material";
-            tileMapHash["blend_mode"] = "BLEND_MODE_ALPHA";
-            tileMapHash["tile_set"] = tileSource(*tileset);
-
-            QString result = replaceTags(QLatin1String(tileMapTemplate), tileMapHash);
-            Tiled::SaveFile mapFile(tilemapFilePath);
-            if (!mapFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
-                return false;
-            }
-            QTextStream stream(mapFile.device());
-            stream << result;
+        if (layers.isEmpty())
+            continue;
 
-            if (mapFile.error() != QFileDevice::NoError) {
-                mError = mapFile.errorString();
-                return false;
-            }
+        QVariantHash componentHash;
+        componentHash["tilemap_name"] = mapName + "-" + tileset->name();
+        componentHash["tilemap_rel_path"] = tilesetRelativePath(tilemapFilePath);
+        topLevelComponents.append(replaceTags(QLatin1String(componentTemplate), componentHash));
 
-            if (!mapFile.commit()) {
-                mError = mapFile.errorString();
-                return false;
-            }
-        }
+        if (!writeFile(tilemapFilePath, tileMap(*tileset, layers)))
+            return false;
     }
 
     // For each Group Layer, create a "GameObject" parented to the "tilemaps" GO
     // and create tilemaps for layers (as components of this GO)
     for (auto layer : map->layers()) {
-        if (layer->layerType() != Tiled::Layer::GroupLayerType)
+        auto groupLayer = layer->asGroupLayer();
+        if (!groupLayer)
             continue;
-        auto groupLayer = static_cast<Tiled::GroupLayer*>(layer);
 
         QVariantHash childHash;
         childHash["child-name"] = layer->name();
@@ -366,81 +400,29 @@ bool DefoldCollectionPlugin::write(const Tiled::Map *map, const QString &collect
             QString tilemapFilePath = tilesetFileDir;
             tilemapFilePath.append(mapName + "-" + layer->name() + "-" + tileset->name() + ".tilemap");
 
-            QVariantHash tileMapHash;
-            QString layers;
-
-            int componentCells = 0;
+            QByteArray layers;
             for (auto subLayer : groupLayer->layers()) {
                 auto tileLayer = subLayer->asTileLayer();
                 if (!tileLayer)
                     continue;
 
-                QVariantHash layerHash;
-                layerHash["id"] = tileLayer->name();
-                layerHash["z"] = zIndexForLayer(*map, *subLayer, false);
-
-                layerHash["is_visible"] = layer->isVisible() ? 1 : 0;
-                QString cells;
-
-                for (int x = 0; x < tileLayer->width(); ++x) {
-                    for (int y = 0; y < tileLayer->height(); ++y) {
-                        const Tiled::Cell &cell = tileLayer->cellAt(x, y);
-                        if (cell.isEmpty() || cell.tileset() != tileset) // skip cell if it doesn't belong to current tileset
-                            continue;
-
-                        QVariantHash cellHash;
-                        cellHash["x"] = x;
-                        cellHash["y"] = tileLayer->height() - y - 1;
-                        setCellProperties(cellHash, cell);
-                        cells.append(replaceTags(QLatin1String(cellTemplate), cellHash));
-                        componentCells++;
-
-                        // Create a component for this embedded instance only when the first cell of this component is found.
-                        // If 0 cells are found, this component is not necessary.
-                        // If more than 1 cells are found, recreating it would be redundant.
-                        if (componentCells == 1) {
-                            QVariantHash componentHash;
-                            componentHash["tilemap_name"] = mapName + "-" + layer->name() + "-" + tileset->name();
-                            componentHash["tilemap_rel_path"] = tilesetRelativePath(tilemapFilePath);
-                            components.append(replaceTags(QLatin1String(componentTemplate), componentHash));
-                        }
-                    }
-                }
-
-                if (!cells.isEmpty()) {
-                    layerHash["cells"] = cells;
-                    layers.append(replaceTags(QLatin1String(layerTemplate), layerHash));
-                }
+                const QByteArray cells = cellsForLayer.value(tileLayer)->value(tileset.data());
+                if (!cells.isEmpty())
+                    appendLayer(layers, tileLayer->name(), zIndexForLayer(*map, *subLayer, false),
+                                layer->isVisible(), cells);
             }
 
             // no need to save a tilemap with 0 cells
             if (layers.isEmpty())
                 continue;
 
-            tileMapHash["layers"] = layers;
-            tileMapHash["material"] = "/builtins/materials/tile_map.material";
-            tileMapHash["blend_mode"] = "BLEND_MODE_ALPHA";
-            tileMapHash["tile_set"] = tileSource(*tileset);
-
-            QString result = replaceTags(QLatin1String(tileMapTemplate), tileMapHash);
-            Tiled::SaveFile mapFile(tilemapFilePath);
-            if (!mapFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
-                return false;
-            }
-
-            QTextStream stream(mapFile.device());
-            stream << result;
-
-            if (mapFile.error() != QFileDevice::NoError) {
-                mError = mapFile.errorString();
-                return false;
-            }
+            QVariantHash componentHash;
+            componentHash["tilemap_name"] = mapName + "-" + layer->name() + "-" + tileset->name();
+            componentHash["tilemap_rel_path"] = tilesetRelativePath(tilemapFilePath);
+            components.append(replaceTags(QLatin1String(componentTemplate), componentHash));
 
-            if (!mapFile.commit()) {
-                mError = mapFile.errorString();
+            if (!writeFile(tilemapFilePath, tileMap(*tileset, layers)))
                 return false;
-            }
         }
         emdeddedInstanceHash["components"] = components;
         embeddedInstances.append(replaceTags(QLatin1String(emdeddedInstanceTemplate), emdeddedInstanceHash));
@@ -451,26 +433,8 @@ bool DefoldCollectionPlugin::write(const Tiled::Map *map, const QString &collect
     embeddedInstances.prepend(replaceTags(QLatin1String(emdeddedInstanceTemplate), mainEmbeddedInstanceHash));
     collectionHash["embedded-instances"] = embeddedInstances;
 
-    QString result = replaceTags(QLatin1String(collectionTemplate), collectionHash);
-    Tiled::SaveFile mapFile(collectionFile);
-    if (!mapFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
-        return false;
-    }
-    QTextStream stream(mapFile.device());
-    stream << result;
-
-    if (mapFile.error() != QFileDevice::NoError) {
-        mError = mapFile.errorString();
-        return false;
-    }
-
-    if (!mapFile.commit()) {
-        mError = mapFile.errorString();
-        return false;
-    }
-
-    return true;
+    const QString result = replaceTags(QLatin1String(collectionTemplate), collectionHash);
+    return writeFile(collectionFile, result.toUtf8());
 }
 
 } // namespace DefoldCollection
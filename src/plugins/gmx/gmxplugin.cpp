@@ -371,15 +371,8 @@ bool GmxPlugin::write(const Map *map, const QString &fileName, Options options)
 
         case Layer::ObjectGroupType: {
             auto objectGroup = static_cast<const ObjectGroup*>(layer);
-            auto objects = objectGroup->objects();
-
             // Make sure the objects export in the rendering order
-            if (objectGroup->drawOrder() == ObjectGroup::TopDownOrder) {
-                std::stable_sort(objects.begin(), objects.end(),
-                                 [](const MapObject *a, const MapObject *b) { return a->y() < b->y(); });
-            }
-
-            for (const MapObject *object : std::as_const(objects)) {
+            for (const MapObject *object : objectGroup->objectsInDrawOrder()) {
                 // Objects with a class are already exported as instances
                 if (!object->effectiveClassName().isEmpty())
                     continue;
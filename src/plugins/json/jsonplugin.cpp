@@ -30,12 +30,98 @@
 #include <QCoreApplication>
 #include <QFile>
 #include <QFileInfo>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QTextStream>
 
+#include <cmath>
+#include <limits>
+
 namespace Json {
 
+static QVariant toVariant(const QJsonValue &value);
+static QVariant toVariant(const QJsonObject &object, bool hasTileData);
+
+/**
+ * Converts tile layer data to a compact list of global tile IDs, avoiding
+ * a QVariant for each tile. Data that can't be represented this way is
+ * converted as usual, leaving error reporting to the VariantToMapConverter.
+ */
+static QVariant tileDataToVariant(const QJsonValue &value)
+{
+    if (!value.isArray())
+        return toVariant(value);
+
+    const QJsonArray array = value.toArray();
+
+    QVector<unsigned> gids;
+    gids.reserve(array.size());
+
+    for (const QJsonValue &gidValue : array) {
+        const double gid = gidValue.toDouble(-1);
+        if (gid < 0 || gid > std::numeric_limits<unsigned>::max() || gid != std::floor(gid))
+            return toVariant(value);
+
+        gids.append(static_cast<unsigned>(gid));
+    }
+
+    return QVariant::fromValue(gids);
+}
+
+/**
+ * Equivalent to QJsonValue::toVariant, except that the data of tile layers
+ * and their chunks is converted using tileDataToVariant.
+ */
+static QVariant toVariant(const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::Object:
+        return toVariant(value.toObject(), false);
+    case QJsonValue::Array: {
+        const QJsonArray array = value.toArray();
+        QVariantList list;
+        list.reserve(array.size());
+        for (const QJsonValue &element : array)
+            list.append(toVariant(element));
+        return list;
+    }
+    default:
+        return value.toVariant();
+    }
+}
+
+static QVariant toVariant(const QJsonObject &object, bool hasTileData)
+{
+    const bool isTileLayer = object.value(QLatin1String("type")).toString() == QLatin1String("tilelayer");
+    hasTileData |= isTileLayer;
+
+    QVariantMap map;
+
+    for (auto it = object.begin(); it != object.end(); ++it) {
+        const QString key = it.key();
+
+        if (hasTileData && key == QLatin1String("data")) {
+            map.insert(key, tileDataToVariant(it.value()));
+        } else if (isTileLayer && key == QLatin1String("chunks") && it.value().isArray()) {
+            const QJsonArray chunks = it.value().toArray();
+            QVariantList chunkVariants;
+            chunkVariants.reserve(chunks.size());
+            for (const QJsonValue &chunk : chunks) {
+                if (chunk.isObject())
+                    chunkVariants.append(toVariant(chunk.toObject(), true));
+                else
+                    chunkVariants.append(toVariant(chunk));
+            }
+            map.insert(key, chunkVariants);
+        } else {
+            map.insert(key, toVariant(it.value()));
+        }
+    }
+
+    return map;
+}
+
 void JsonPlugin::initialize()
 {
     addObject(new JsonMapFormat(JsonMapFormat::Json, this));
@@ -79,7 +165,8 @@ std::unique_ptr<Tiled::Map> JsonMapFormat::read(const QString &fileName)
     }
 
     Tiled::VariantToMapConverter converter;
-    auto map = converter.toMap(document.toVariant(), QFileInfo(fileName).dir());
+    auto map = converter.toMap(toVariant(document.object(), false),
+                               QFileInfo(fileName).dir());
 
     if (!map)
         mError = converter.errorString();
@@ -99,18 +186,13 @@ bool JsonMapFormat::write(const Tiled::Map *map,
     }
 
     Tiled::MapToVariantConverter converter;
+    converter.setCompactTileData(true);
     QVariant variant = converter.toVariant(*map, QFileInfo(fileName).dir());
 
     JsonWriter writer;
     writer.setAutoFormatting(!options.testFlag(WriteMinimized));
     writer.setAutoFormattingWrapArrayCount(map->infinite() ? map->chunkSize().width() : map->width());
 
-    if (!writer.stringify(variant)) {
-        // This can only happen due to coding error
-        mError = writer.errorString();
-        return false;
-    }
-
     QTextStream out(file.device());
     if (mSubFormat == JavaScript) {
         // Trim and escape name
@@ -126,10 +208,19 @@ bool JsonMapFormat::write(const Tiled::Map *map,
         out << " if(typeof module === 'object' && module && module.exports) {\n";
         out << "  module.exports = data;\n";
         out << " }})(" << nameWriter.result() << ",\n";
+        out.flush();
     }
-    out << writer.result();
+
+    // Write directly to the file, to avoid keeping the whole output in memory
+    if (!writer.stringify(variant, file.device())) {
+        // This can only happen due to coding error
+        mError = writer.errorString();
+        return false;
+    }
+
     if (mSubFormat == JavaScript) {
         out << ");";
+        out.flush();
     }
 
     if (file.error() != QFileDevice::NoError) {
@@ -278,15 +369,12 @@ bool JsonTilesetFormat::write(const Tiled::Tileset &tileset,
     JsonWriter writer;
     writer.setAutoFormatting(!options.testFlag(WriteMinimized));
 
-    if (!writer.stringify(variant)) {
+    if (!writer.stringify(variant, file.device())) {
         // This can only happen due to coding error
         mError = writer.errorString();
         return false;
     }
 
-    QTextStream out(file.device());
-    out << writer.result();
-
     if (file.error() != QFileDevice::NoError) {
         mError = tr("Error while writing file:\n%1").arg(file.errorString());
         return false;
@@ -380,15 +468,12 @@ bool JsonObjectTemplateFormat::write(const Tiled::ObjectTemplate *objectTemplate
     JsonWriter writer;
     writer.setAutoFormatting(true);
 
-    if (!writer.stringify(variant)) {
+    if (!writer.stringify(variant, file.device())) {
         // This can only happen due to coding error
         mError = writer.errorString();
         return false;
     }
 
-    QTextStream out(file.device());
-    out << writer.result();
-
     if (file.error() != QFileDevice::NoError) {
         mError = tr("Error while writing file:\n%1").arg(file.errorString());
         return false;
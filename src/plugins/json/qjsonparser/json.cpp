@@ -10,8 +10,12 @@
 #include "json.h"
 
 #include <QDebug>
+#include <QIODevice>
 #include <qnumeric.h>
 
+// Amount of characters collected before writing them to the device
+static const int FlushThreshold = 16384;
+
 /*!
   \class JsonWriter
   \reentrant
@@ -153,23 +157,17 @@ static QString escape(const QVariant &variant)
  */
 void JsonWriter::stringify(const QVariant &variant, int depth)
 {
-    if (variant.type() == QVariant::List || variant.type() == QVariant::StringList) {
+    if (variant.userType() == qMetaTypeId<QVector<unsigned>>()) {
+        stringify(variant.value<QVector<unsigned>>(), depth);
+    } else if (variant.type() == QVariant::List || variant.type() == QVariant::StringList) {
         const QString indent = m_autoFormattingIndent.repeated(depth);
         m_result += QLatin1Char('[');
         QVariantList list = variant.toList();
         for (int i = 0; i < list.count(); i++) {
-            if (i != 0) {
-                m_result += QLatin1Char(',');
-                if (m_autoFormatting) {
-                    if (m_autoFormattingWrapArrayCount && i % m_autoFormattingWrapArrayCount == 0) {
-                        m_result += QLatin1Char('\n');
-                        m_result += indent;
-                    } else {
-                        m_result += QLatin1Char(' ');
-                    }
-                }
-            }
+            if (i != 0)
+                writeArraySeparator(i, indent);
             stringify(list[i], depth+1);
+            flush();
         }
         m_result += QLatin1Char(']');
     } else if (variant.type() == QVariant::Map) {
@@ -192,6 +190,7 @@ void JsonWriter::stringify(const QVariant &variant, int depth)
                 m_result += indent + QLatin1Char(' ');
             m_result += QLatin1Char('\"') + escape(it.key()) + QLatin1String("\":");
             stringify(it.value(), depth+1);
+            flush();
         }
         if (m_autoFormatting) {
             m_result += QLatin1Char('\n');
@@ -238,6 +237,57 @@ void JsonWriter::stringify(const QVariant &variant, int depth)
     }
 }
 
+/*! \internal
+  Stringifies \a values as an array of numbers. Used for tile layer data,
+  which would take a lot of memory when stored as a QVariantList.
+ */
+void JsonWriter::stringify(const QVector<unsigned> &values, int depth)
+{
+    const QString indent = m_autoFormattingIndent.repeated(depth);
+    m_result += QLatin1Char('[');
+    for (int i = 0; i < values.size(); i++) {
+        if (i != 0)
+            writeArraySeparator(i, indent);
+        m_result += QString::number(values.at(i));
+        flush();
+    }
+    m_result += QLatin1Char(']');
+}
+
+/*! \internal
+  Writes the separator in front of the array element at \a index.
+ */
+void JsonWriter::writeArraySeparator(int index, const QString &indent)
+{
+    m_result += QLatin1Char(',');
+    if (m_autoFormatting) {
+        if (m_autoFormattingWrapArrayCount && index % m_autoFormattingWrapArrayCount == 0) {
+            m_result += QLatin1Char('\n');
+            m_result += indent;
+        } else {
+            m_result += QLatin1Char(' ');
+        }
+    }
+}
+
+/*! \internal
+  When writing to a device, writes the collected output to the device once
+  enough of it has been collected, or always when \a force is \c true.
+
+  The output only contains ASCII characters, since all other characters are
+  escaped.
+ */
+void JsonWriter::flush(bool force)
+{
+    if (!m_device)
+        return;
+    if (!force && m_result.size() < FlushThreshold)
+        return;
+
+    m_device->write(m_result.toLatin1());
+    m_result.truncate(0);
+}
+
 /*!
   Converts the variant \a var into a JSON string.
 
@@ -249,6 +299,9 @@ void JsonWriter::stringify(const QVariant &variant, int depth)
   \o QVariant::List, QVariant::StringList
   \o JSON array []
   \row
+  \o QVector<unsigned>
+  \o JSON array [] of numbers
+  \row
   \o QVariant::Map
   \o JSON object {}
   \row
@@ -285,6 +338,23 @@ bool JsonWriter::stringify(const QVariant &var)
     return m_errorString.isEmpty();
 }
 
+/*!
+  Converts the variant \a var into JSON, writing it directly to \a device.
+
+  This avoids keeping the entire result in memory, which makes a difference
+  for large documents. After this call, result() returns an empty string.
+
+  \sa stringify()
+ */
+bool JsonWriter::stringify(const QVariant &var, QIODevice *device)
+{
+    m_device = device;
+    const bool success = stringify(var);
+    flush(true);
+    m_device = nullptr;
+    return success;
+}
+
 /*!
   Returns the result of the last stringify() call.
 
@@ -11,6 +11,9 @@
 
 #include <QByteArray>
 #include <QVariant>
+#include <QVector>
+
+class QIODevice;
 
 class JsonWriter
 {
@@ -19,6 +22,7 @@ public:
     ~JsonWriter();
 
     bool stringify(const QVariant &variant);
+    bool stringify(const QVariant &variant, QIODevice *device);
 
     QString result() const;
 
@@ -34,7 +38,11 @@ public:
 
 private:
     void stringify(const QVariant &variant, int depth);
+    void stringify(const QVector<unsigned> &values, int depth);
+    void writeArraySeparator(int index, const QString &indent);
+    void flush(bool force = false);
 
+    QIODevice *m_device = nullptr;
     QString m_result;
     QString m_errorString;
     bool m_autoFormatting = false;
@@ -25,6 +25,7 @@
 #include "gidmapper.h"
 #include "grouplayer.h"
 #include "imagelayer.h"
+#include "layerdataencoder.h"
 #include "map.h"
 #include "mapobject.h"
 #include "objectgroup.h"
@@ -102,6 +103,7 @@ private:
     LuaTableWriter &mWriter;
     const QDir mDir;
     Tiled::GidMapper mGidMapper;
+    Tiled::LayerDataEncoder mLayerDataEncoder;
 };
 
 
@@ -263,8 +265,20 @@ void LuaWriter::writeMap(const Map *map)
     }
     mWriter.writeEndTable();
 
+    mLayerDataEncoder.prepareDictionary(*map, mGidMapper, map->chunkSize());
+
+    const QByteArray &dictionary = mLayerDataEncoder.dictionary();
+    if (!dictionary.isEmpty())
+        mWriter.writeKeyAndValue("compressiondictionary", dictionary.toBase64());
+
+    mLayerDataEncoder.encode(*map, mGidMapper, map->layerDataFormat(),
+                             map->chunkSize(), map->compressionLevel());
+
     writeLayers(map->layers(), map->layerDataFormat(), map->compressionLevel(), map->chunkSize());
 
+    mLayerDataEncoder.clear();
+    mLayerDataEncoder.setDictionary(QByteArray());
+
     mWriter.writeEndTable();
     mWriter.writeEndDocument();
 }
@@ -571,9 +585,11 @@ void LuaWriter::writeTileLayer(const TileLayer *tileLayer,
 
         break;
     }
-    case Map::Base64Zstandard: {
+    case Map::Base64Zstandard:
+    case Map::Base64RunLength:
+    case Map::Base64RunLengthZstandard: {
         mWriter.writeKeyAndValue("encoding", "base64");
-        mWriter.writeKeyAndValue("compression", "zstd");
+        mWriter.writeKeyAndValue("compression", compressionToString(format));
 
         break;
     }
@@ -614,21 +630,27 @@ void LuaWriter::writeTileLayerData(const TileLayer *tileLayer,
     case Map::XML:
     case Map::CSV:
         mWriter.writeStartTable("data");
-        for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
-            if (y > bounds.top())
+        tileLayer->forEachSpan(bounds, [&] (int x, int y, const Cell *cells, int count) {
+            if (y > bounds.top() && x == bounds.left())
                 mWriter.prepareNewLine();
 
-            for (int x = bounds.left(); x <= bounds.right(); ++x)
-                mWriter.writeValue(mGidMapper.cellToGid(tileLayer->cellAt(x, y)));
-        }
+            unsigned gids[CHUNK_SIZE];
+            mGidMapper.cellsToGids(cells, count, gids);
+            mWriter.writeValues(gids, count);
+        });
         mWriter.writeEndTable();
         break;
 
     case Map::Base64:
     case Map::Base64Zlib:
     case Map::Base64Gzip:
-    case Map::Base64Zstandard: {
-        QByteArray layerData = mGidMapper.encodeLayerData(*tileLayer, format, bounds, compressionLevel);
+    case Map::Base64Zstandard:
+    case Map::Base64RunLength:
+    case Map::Base64RunLengthZstandard: {
+        QByteArray layerData = mLayerDataEncoder.encodedData(*tileLayer, bounds);
+        if (layerData.isNull())
+            layerData = mGidMapper.encodeLayerData(*tileLayer, format, bounds, compressionLevel,
+                                                   mLayerDataEncoder.dictionary());
         mWriter.writeKeyAndValue("data", layerData);
         break;
     }
@@ -24,9 +24,18 @@
 
 namespace Lua {
 
+// Amount of bytes collected before writing them to the device
+static constexpr int BufferSize = 16384;
+
 LuaTableWriter::LuaTableWriter(QIODevice *device)
     : m_device(device)
 {
+    m_buffer.reserve(BufferSize);
+}
+
+LuaTableWriter::~LuaTableWriter()
+{
+    flush();
 }
 
 void LuaTableWriter::writeStartDocument()
@@ -38,6 +47,7 @@ void LuaTableWriter::writeEndDocument()
 {
     Q_ASSERT(m_indent == 0);
     write('\n');
+    flush();
 }
 
 void LuaTableWriter::writeStartTable()
@@ -90,6 +100,62 @@ void LuaTableWriter::writeEndTable()
     m_valueWritten = true;
 }
 
+void LuaTableWriter::writeValue(int value)
+{
+    prepareNewValue();
+    if (value < 0) {
+        write('-');
+        writeNumber(0u - static_cast<unsigned>(value));
+    } else {
+        writeNumber(static_cast<unsigned>(value));
+    }
+    m_newLine = false;
+    m_valueWritten = true;
+}
+
+void LuaTableWriter::writeValue(unsigned value)
+{
+    prepareNewValue();
+    writeNumber(value);
+    m_newLine = false;
+    m_valueWritten = true;
+}
+
+/**
+ * Writes \a count values at once. The output is the same as when calling
+ * writeValue() for each value, but avoids its overhead for large arrays
+ * like tile layer data.
+ */
+void LuaTableWriter::writeValues(const unsigned *values, int count)
+{
+    if (count <= 0)
+        return;
+
+    writeValue(values[0]);
+
+    const char separator[] = { m_valueSeparator, ' ' };
+    const int separatorLength = m_minimize ? 1 : 2;
+
+    for (int i = 1; i < count; ++i) {
+        write(separator, separatorLength);
+        writeNumber(values[i]);
+    }
+}
+
+/**
+ * Writes the buffered output to the device.
+ */
+void LuaTableWriter::flush()
+{
+    if (m_buffer.isEmpty())
+        return;
+
+    if (m_device->write(m_buffer) != m_buffer.size())
+        m_error = true;
+
+    m_buffer.truncate(0);
+}
+
 void LuaTableWriter::writeValue(const QByteArray &value)
 {
     prepareNewValue();
@@ -240,10 +306,24 @@ void LuaTableWriter::writeNewline()
     }
 }
 
+void LuaTableWriter::writeNumber(unsigned value)
+{
+    char digits[10];
+    int start = sizeof(digits);
+
+    do {
+        digits[--start] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    write(digits + start, sizeof(digits) - start);
+}
+
 void LuaTableWriter::write(const char *bytes, qint64 length)
 {
-    if (m_device->write(bytes, length) != length)
-        m_error = true;
+    m_buffer.append(bytes, static_cast<int>(length));
+    if (m_buffer.size() >= BufferSize)
+        flush();
 }
 
 } // namespace Lua
@@ -30,11 +30,15 @@ namespace Lua {
 
 /**
  * Makes it easy to produce a well formatted Lua table.
+ *
+ * Output is collected in a buffer, which is written to the device when it
+ * gets full and at the end of the document.
  */
 class LuaTableWriter
 {
 public:
     LuaTableWriter(QIODevice *device);
+    ~LuaTableWriter();
 
     void writeStartDocument();
     void writeEndDocument();
@@ -47,6 +51,7 @@ public:
 
     void writeValue(int value);
     void writeValue(unsigned value);
+    void writeValues(const unsigned *values, int count);
     void writeValue(const QByteArray &value);
     void writeValue(const QString &value);
 
@@ -73,6 +78,8 @@ public:
 
     void prepareNewLine();
 
+    void flush();
+
     bool hasError() const { return m_error; }
 
     static QString quote(const QString &str);
@@ -82,12 +89,14 @@ private:
     void writeIndent();
 
     void writeNewline();
+    void writeNumber(unsigned value);
     void write(const char *bytes, qint64 length);
     void write(const char *bytes);
     void write(const QByteArray &bytes);
     void write(char c);
 
     QIODevice *m_device;
+    QByteArray m_buffer;
     int m_indent { 0 };
     char m_valueSeparator { ',' };
     bool m_suppressNewlines { false };
@@ -97,12 +106,6 @@ private:
     bool m_error { false };
 };
 
-inline void LuaTableWriter::writeValue(int value)
-{ writeUnquotedValue(QByteArray::number(value)); }
-
-inline void LuaTableWriter::writeValue(unsigned value)
-{ writeUnquotedValue(QByteArray::number(value)); }
-
 inline void LuaTableWriter::writeValue(const QString &value)
 { writeUnquotedValue(quote(value).toUtf8()); }
 
@@ -44,6 +44,7 @@ typedef enum _PyBindGenWrapperFlags {
 
 
 #include "pythonplugin.h"
+#include "gidmapper.h"
 #include "grouplayer.h"
 #include "imagelayer.h"
 #include "layer.h"
@@ -6198,6 +6199,43 @@ _wrap_PyTiledTileLayer_cellAt(PyTiledTileLayer *self, PyObject *args, PyObject *
 }
 
 
+static PyObject *
+_wrap_PyTiledTileLayer_gids(PyTiledTileLayer *self, PyObject *PYBINDGEN_UNUSED(_args), PyObject *PYBINDGEN_UNUSED(_kwargs))
+{
+    Tiled::TileLayer *layer = self->obj;
+    Tiled::Map *map = layer->map();
+    if (!map) {
+        PyErr_SetString(PyExc_RuntimeError, "tile layer is not part of a map");
+        return NULL;
+    }
+
+    const int width = layer->width();
+    const int height = layer->height();
+    PyObject *bytes = PyBytes_FromStringAndSize(NULL, Py_ssize_t(width) * height * sizeof(unsigned));
+    if (!bytes)
+        return NULL;
+
+    const Tiled::GidMapper gidMapper(map->tilesets());
+    unsigned *gids = reinterpret_cast<unsigned*>(PyBytes_AS_STRING(bytes));
+    layer->forEachSpan(QRect(0, 0, width, height), [&] (int x, int y, const Tiled::Cell *cells, int count) {
+        gidMapper.cellsToGids(cells, count, gids + Py_ssize_t(y) * width + x);
+    });
+
+    PyObject *view = PyMemoryView_FromObject(bytes);
+    Py_DECREF(bytes);
+    if (!view)
+        return NULL;
+
+    PyObject *py_retval;
+    if (width > 0 && height > 0)
+        py_retval = PyObject_CallMethod(view, (char *) "cast", (char *) "s(ii)", "I", height, width);
+    else
+        py_retval = PyObject_CallMethod(view, (char *) "cast", (char *) "s", "I");
+    Py_DECREF(view);
+    return py_retval;
+}
+
+
 PyObject *
 _wrap_PyTiledTileLayer_height(PyTiledTileLayer *self, PyObject *PYBINDGEN_UNUSED(_args), PyObject *PYBINDGEN_UNUSED(_kwargs))
 {
@@ -6273,6 +6311,7 @@ _wrap_PyTiledTileLayer_width(PyTiledTileLayer *self, PyObject *PYBINDGEN_UNUSED(
 
 static PyMethodDef PyTiledTileLayer_methods[] = {
     {(char *) "cellAt", (PyCFunction) _wrap_PyTiledTileLayer_cellAt, METH_KEYWORDS|METH_VARARGS, "cellAt(x, y)\n\ntype: x: int\ntype: y: int" },
+    {(char *) "gids", (PyCFunction) _wrap_PyTiledTileLayer_gids, METH_NOARGS, NULL },
     {(char *) "height", (PyCFunction) _wrap_PyTiledTileLayer_height, METH_NOARGS, "height()\n\n" },
     {(char *) "isEmpty", (PyCFunction) _wrap_PyTiledTileLayer_isEmpty, METH_NOARGS, "isEmpty()\n\n" },
     {(char *) "referencesTileset", (PyCFunction) _wrap_PyTiledTileLayer_referencesTileset, METH_KEYWORDS|METH_VARARGS, "referencesTileset(ts)\n\ntype: ts: Tileset *" },
@@ -6717,6 +6756,29 @@ _wrap_PyTiledObjectGroup_objectCount(PyTiledObjectGroup *self, PyObject *PYBINDG
 }
 
 
+static PyObject *
+_wrap_PyTiledObjectGroup_objects(PyTiledObjectGroup *self, PyObject *PYBINDGEN_UNUSED(_args), PyObject *PYBINDGEN_UNUSED(_kwargs))
+{
+    const QList<Tiled::MapObject*> &objects = self->obj->objects();
+    PyObject *py_retval = PyList_New(objects.size());
+    if (!py_retval)
+        return NULL;
+
+    for (int i = 0; i < objects.size(); ++i) {
+        PyTiledMapObject *py_MapObject = PyObject_New(PyTiledMapObject, &PyTiledMapObject_Type);
+        if (!py_MapObject) {
+            Py_DECREF(py_retval);
+            return NULL;
+        }
+        py_MapObject->obj = objects.at(i);
+        py_MapObject->flags = PYBINDGEN_WRAPPER_FLAG_OBJECT_NOT_OWNED;
+        PyList_SET_ITEM(py_retval, i, (PyObject *) py_MapObject);
+    }
+
+    return py_retval;
+}
+
+
 PyObject *
 _wrap_PyTiledObjectGroup_referencesTileset(PyTiledObjectGroup *self, PyObject *args, PyObject *kwargs)
 {
@@ -6759,6 +6821,7 @@ static PyMethodDef PyTiledObjectGroup_methods[] = {
     {(char *) "insertObject", (PyCFunction) _wrap_PyTiledObjectGroup_insertObject, METH_KEYWORDS|METH_VARARGS, "insertObject(index, object)\n\ntype: index: int\ntype: object: MapObject *" },
     {(char *) "objectAt", (PyCFunction) _wrap_PyTiledObjectGroup_objectAt, METH_KEYWORDS|METH_VARARGS, "objectAt(index)\n\ntype: index: int" },
     {(char *) "objectCount", (PyCFunction) _wrap_PyTiledObjectGroup_objectCount, METH_NOARGS, "objectCount()\n\n" },
+    {(char *) "objects", (PyCFunction) _wrap_PyTiledObjectGroup_objects, METH_NOARGS, NULL },
     {(char *) "referencesTileset", (PyCFunction) _wrap_PyTiledObjectGroup_referencesTileset, METH_KEYWORDS|METH_VARARGS, "referencesTileset(ts)\n\ntype: ts: Tileset *" },
     {(char *) "removeObject", (PyCFunction) _wrap_PyTiledObjectGroup_removeObject, METH_KEYWORDS|METH_VARARGS, "removeObject(object)\n\ntype: object: MapObject *" },
     {NULL, NULL, 0, NULL}
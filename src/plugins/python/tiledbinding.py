@@ -53,6 +53,7 @@ mod = Module('tiled')
 mod.functions = SimpleSortedDict()
 
 mod.add_include('"pythonplugin.h"')
+mod.add_include('"gidmapper.h"')
 mod.add_include('"grouplayer.h"')
 mod.add_include('"imagelayer.h"')
 mod.add_include('"layer.h"')
@@ -240,6 +241,48 @@ cls_tilelayer.add_method('referencesTileset', 'bool',
     [param('Tileset*','ts',transfer_ownership=False)])
 cls_tilelayer.add_method('isEmpty', 'bool', [])
 
+# Returns the global tile IDs of the whole layer at once, as a memoryview of
+# unsigned 32-bit integers with shape (height, width). This is a lot faster
+# than calling cellAt for each tile and can be passed to numpy.asarray.
+cls_tilelayer.add_custom_method_wrapper('gids', '_wrap_PyTiledTileLayer_gids',
+    flags=['METH_NOARGS'], wrapper_body="""
+static PyObject *
+_wrap_PyTiledTileLayer_gids(PyTiledTileLayer *self, PyObject *PYBINDGEN_UNUSED(_args), PyObject *PYBINDGEN_UNUSED(_kwargs))
+{
+    Tiled::TileLayer *layer = self->obj;
+    Tiled::Map *map = layer->map();
+    if (!map) {
+        PyErr_SetString(PyExc_RuntimeError, "tile layer is not part of a map");
+        return NULL;
+    }
+
+    const int width = layer->width();
+    const int height = layer->height();
+    PyObject *bytes = PyBytes_FromStringAndSize(NULL, Py_ssize_t(width) * height * sizeof(unsigned));
+    if (!bytes)
+        return NULL;
+
+    const Tiled::GidMapper gidMapper(map->tilesets());
+    unsigned *gids = reinterpret_cast<unsigned*>(PyBytes_AS_STRING(bytes));
+    layer->forEachSpan(QRect(0, 0, width, height), [&] (int x, int y, const Tiled::Cell *cells, int count) {
+        gidMapper.cellsToGids(cells, count, gids + Py_ssize_t(y) * width + x);
+    });
+
+    PyObject *view = PyMemoryView_FromObject(bytes);
+    Py_DECREF(bytes);
+    if (!view)
+        return NULL;
+
+    PyObject *py_retval;
+    if (width > 0 && height > 0)
+        py_retval = PyObject_CallMethod(view, (char *) "cast", (char *) "s(ii)", "I", height, width);
+    else
+        py_retval = PyObject_CallMethod(view, (char *) "cast", (char *) "s", "I");
+    Py_DECREF(view);
+    return py_retval;
+}
+""")
+
 cls_imagelayer = tiled.add_class('ImageLayer', cls_layer)
 cls_imagelayer.add_constructor([('QString','name'), ('int','x'), ('int','y')])
 cls_imagelayer.add_method('loadFromImage', 'bool',
@@ -297,6 +340,32 @@ cls_objectgroup.add_method('removeObject', 'int',
     [param('MapObject*','object',transfer_ownership=False)])
 cls_objectgroup.add_method('objectAt', retval('Tiled::MapObject*',reference_existing_object=True),[('int','index')])
 cls_objectgroup.add_method('objectCount', 'int',[])
+
+# Returns all objects at once, avoiding a call to objectAt for each object
+cls_objectgroup.add_custom_method_wrapper('objects', '_wrap_PyTiledObjectGroup_objects',
+    flags=['METH_NOARGS'], wrapper_body="""
+static PyObject *
+_wrap_PyTiledObjectGroup_objects(PyTiledObjectGroup *self, PyObject *PYBINDGEN_UNUSED(_args), PyObject *PYBINDGEN_UNUSED(_kwargs))
+{
+    const QList<Tiled::MapObject*> &objects = self->obj->objects();
+    PyObject *py_retval = PyList_New(objects.size());
+    if (!py_retval)
+        return NULL;
+
+    for (int i = 0; i < objects.size(); ++i) {
+        PyTiledMapObject *py_MapObject = PyObject_New(PyTiledMapObject, &PyTiledMapObject_Type);
+        if (!py_MapObject) {
+            Py_DECREF(py_retval);
+            return NULL;
+        }
+        py_MapObject->obj = objects.at(i);
+        py_MapObject->flags = PYBINDGEN_WRAPPER_FLAG_OBJECT_NOT_OWNED;
+        PyList_SET_ITEM(py_retval, i, (PyObject *) py_MapObject);
+    }
+
+    return py_retval;
+}
+""")
 #cls_objectgroup.add_method('objectsBoundingRect', 'QRectF', [])
 #cls_objectgroup.add_method('usedTilesets', 'QSet<Tileset*>', [])
 cls_objectgroup.add_method('referencesTileset', 'bool',
@@ -268,10 +268,10 @@ void RpMapPlugin::writeTokenMap(QXmlStreamWriter &writer, Tiled::Map const* map)
                         auto it = filename2md5.find(tilepath);
                         if (it == filename2md5.end()) {
                             QFile file(tilepath);
-                            if (file.open(QIODevice::ReadOnly)) {
-                                QByteArray image = file.readAll();
-                                QByteArray md5bin = QCryptographicHash::hash(image, QCryptographicHash::Md5);
-                                QString md5string = md5bin.toHex();
+                            QCryptographicHash hash(QCryptographicHash::Md5);
+                            if (file.open(QIODevice::ReadOnly) && hash.addData(&file)) {
+                                // hashed in chunks, without reading the whole image into memory
+                                QString md5string = hash.result().toHex();
                                 it = filename2md5.insert(tilepath, md5string);
                                 // remember the first element (tile) referencing this file
                                 first_used_md5.push_back(number_of_tiles);
@@ -5,6 +5,7 @@ namespace sf
 {
     using Int32 = int;
     using Uint8 = unsigned char;
+    using Uint16 = unsigned short;
     struct Vector2i
     {
         Int32 x;
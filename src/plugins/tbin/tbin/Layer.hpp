@@ -27,6 +27,8 @@
 #define TBIN_LAYER_HPP
 
 //#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -45,7 +47,19 @@ namespace tbin
             sf::Vector2i layerSize;
             sf::Vector2i tileSize;
             Properties props;
-            std::vector< Tile > tiles;
+
+            // The ids of the tilesheets referred to by the tiles
+            std::vector< std::string > tilesheets;
+
+            // One entry for each cell, row by row
+            std::vector< LayerTile > tiles;
+
+            // Frames of animated tiles and properties of any tiles, by cell index
+            std::map< std::size_t, Tile > animatedTiles;
+            std::map< std::size_t, Properties > tileProps;
+
+            // Returns the index of the given tilesheet, adding it when needed
+            sf::Uint16 tilesheetIndex( const std::string& tilesheet );
     };
 }
 
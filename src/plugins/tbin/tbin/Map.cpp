@@ -197,7 +197,7 @@ namespace tbin
         return ret;
     }
 
-    void writeAnimatedTile( std::ostream& out, const Tile& tile )
+    void writeAnimatedTile( std::ostream& out, const Tile& tile, const Properties& props )
     {
         write( out, tile.animatedData.frameInterval );
         write< sf::Int32 >( out, tile.animatedData.frames.size() );
@@ -216,7 +216,20 @@ namespace tbin
             writeStaticTile( out, frame );
         }
 
-        writeProperties( out, tile.props );
+        writeProperties( out, props );
+    }
+
+    sf::Uint16 Layer::tilesheetIndex( const std::string& tilesheet )
+    {
+        for ( std::size_t i = 0; i < tilesheets.size(); ++i )
+            if ( tilesheets[ i ] == tilesheet )
+                return static_cast< sf::Uint16 >( i );
+
+        if ( tilesheets.size() > 0xFFFF )
+            throw std::invalid_argument( QT_TRANSLATE_NOOP("TbinMapFormat", "Too many tilesheets in layer") );
+
+        tilesheets.push_back( tilesheet );
+        return static_cast< sf::Uint16 >( tilesheets.size() - 1 );
     }
 
     Layer readLayer( std::istream& in )
@@ -229,11 +242,13 @@ namespace tbin
         ret.tileSize = read< sf::Vector2i >( in );
         ret.props = readProperties( in );
 
-        Tile nullTile;
-        nullTile.staticData.tileIndex = -1;
-        ret.tiles.resize( static_cast<size_t>(ret.layerSize.x) * ret.layerSize.y, nullTile );
+        const std::size_t tileCount = static_cast<size_t>(ret.layerSize.x) * ret.layerSize.y;
+        ret.tiles.resize( tileCount );
 
+        // Looked up only once a tile refers to it
         std::string currTilesheet = "";
+        int currTilesheetIndex = -1;
+
         for ( int iy = 0; iy < ret.layerSize.y; ++iy )
         {
             int ix = 0;
@@ -246,15 +261,44 @@ namespace tbin
                         ix += read< sf::Int32 >( in );
                         break;
                     case 'S':
-                        ret.tiles[ ix + iy * ret.layerSize.x ] = readStaticTile( in, currTilesheet );
-                        ++ix;
-                        break;
                     case 'A':
-                        ret.tiles[ ix + iy * ret.layerSize.x ] = readAnimatedTile( in );
+                    {
+                        if ( ix < 0 )
+                            throw std::invalid_argument( QT_TRANSLATE_NOOP("TbinMapFormat", "Bad layer tile data") );
+
+                        const std::size_t index = ix + static_cast<size_t>(iy) * ret.layerSize.x;
+
+                        if ( currTilesheetIndex == -1 )
+                            currTilesheetIndex = ret.tilesheetIndex( currTilesheet );
+
+                        LayerTile& tile = ret.tiles[ index ];
+                        tile.tilesheet = static_cast< sf::Uint16 >( currTilesheetIndex );
+
+                        Properties props;
+                        if ( c == 'S' )
+                        {
+                            tile.type = Tile::Static;
+                            tile.tileIndex = read< sf::Int32 >( in );
+                            tile.blendMode = read< sf::Uint8 >( in );
+                            props = readProperties( in );
+                        }
+                        else
+                        {
+                            Tile animated = readAnimatedTile( in );
+                            tile.type = Tile::Animated;
+                            std::swap( props, animated.props );
+                            ret.animatedTiles[ index ] = std::move( animated );
+                        }
+
+                        if ( !props.empty() )
+                            ret.tileProps[ index ] = std::move( props );
+
                         ++ix;
                         break;
+                    }
                     case 'T':
                         currTilesheet = read< std::string >( in );
+                        currTilesheetIndex = -1;
                         break;
                     default:
                         throw std::invalid_argument( QT_TRANSLATE_NOOP("TbinMapFormat", "Bad layer tile data") );
@@ -274,13 +318,16 @@ namespace tbin
         write( out, layer.tileSize );
         writeProperties( out, layer.props );
 
+        const Properties noProps;
+
         std::string currTilesheet = "";
         for ( int iy = 0; iy < layer.layerSize.y; ++iy )
         {
             sf::Int32 nulls = 0;
             for ( int ix = 0; ix < layer.layerSize.x; ++ix )
             {
-                const Tile& tile = layer.tiles[ ix + iy * layer.layerSize.x ];
+                const std::size_t index = ix + static_cast<size_t>(iy) * layer.layerSize.x;
+                const LayerTile& tile = layer.tiles[ index ];
 
                 if ( tile.isNullTile() )
                 {
@@ -295,22 +342,32 @@ namespace tbin
                     nulls = 0;
                 }
 
-                if ( tile.tilesheet != currTilesheet )
+                const std::string& tilesheet = layer.tilesheets.at( tile.tilesheet );
+                if ( tilesheet != currTilesheet )
                 {
                     write< sf::Uint8 >( out, 'T' );
-                    write( out, tile.tilesheet );
-                    currTilesheet = tile.tilesheet;
+                    write( out, tilesheet );
+                    currTilesheet = tilesheet;
                 }
 
-                if ( tile.animatedData.frames.size() == 0 )
+                const auto propsIt = layer.tileProps.find( index );
+                const Properties& props = propsIt != layer.tileProps.end() ? propsIt->second : noProps;
+
+                if ( tile.type == Tile::Static )
                 {
                     write< sf::Uint8 >( out, 'S' );
-                    writeStaticTile( out, tile );
+                    write( out, tile.tileIndex );
+                    write( out, tile.blendMode );
+                    writeProperties( out, props );
                 }
                 else
                 {
+                    const auto animatedIt = layer.animatedTiles.find( index );
+                    if ( animatedIt == layer.animatedTiles.end() )
+                        throw std::invalid_argument( QT_TRANSLATE_NOOP("TbinMapFormat", "Bad layer tile data") );
+
                     write< sf::Uint8 >( out, 'A' );
-                    writeAnimatedTile( out, tile );
+                    writeAnimatedTile( out, animatedIt->second, props );
                 }
             }
 
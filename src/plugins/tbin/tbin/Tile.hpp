@@ -62,6 +62,20 @@ namespace tbin
             
             inline bool isNullTile() const { return staticData.tileIndex == -1 && animatedData.frames.size() == 0; }
     };
+
+    // Compact form of a tile placed on a layer. The tilesheet is an index
+    // into Layer::tilesheets, and the frames and properties of a tile are
+    // stored separately by the layer, since most tiles have neither.
+    struct LayerTile
+    {
+        public:
+            sf::Int32 tileIndex = -1;
+            sf::Uint16 tilesheet = 0;
+            sf::Uint8 type = Tile::Null;
+            sf::Uint8 blendMode = 0;
+
+            inline bool isNullTile() const { return type == Tile::Null; }
+    };
 }
 
 #endif // TBIN_TILE_HPP
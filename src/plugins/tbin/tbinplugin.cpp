@@ -33,6 +33,7 @@
 
 #include <QCoreApplication>
 #include <QDir>
+#include <QHash>
 #if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
 #include <QStringView>
 #endif
@@ -208,45 +209,62 @@ std::unique_ptr<Tiled::Map> TbinMapFormat::read(const QString &fileName)
 
             auto layer = std::make_unique<Tiled::TileLayer>(QString::fromStdString(tlayer.id), 0, 0, tlayer.layerSize.x, tlayer.layerSize.y);
             tbinToTiledProperties(tlayer.props, *layer);
-            auto objects = std::make_unique<Tiled::ObjectGroup>(QString::fromStdString(tlayer.id), 0, 0);
-            for (std::size_t i = 0; i < tlayer.tiles.size(); ++i) {
-                const tbin::Tile& ttile = tlayer.tiles[i];
-                int ix = static_cast<int>(i % static_cast<std::size_t>(tlayer.layerSize.x));
-                int iy = static_cast<int>(i / static_cast<std::size_t>(tlayer.layerSize.x));
-
-                if (ttile.isNullTile())
-                    continue;
 
-                Tiled::Cell cell;
-                if (ttile.animatedData.frames.size() > 0) {
-                    tbin::Tile tfirstTile = ttile.animatedData.frames[0];
-                    Tiled::Tile* firstTile = map->tilesetAt(tmapTilesheetMapping[tfirstTile.tilesheet])->findOrCreateTile(tfirstTile.staticData.tileIndex);
-                    QVector<Tiled::Frame> frames;
-                    for (const tbin::Tile& tframe : ttile.animatedData.frames) {
-                        if (tframe.isNullTile() || tframe.animatedData.frames.size() > 0 ||
-                             tframe.tilesheet != tfirstTile.tilesheet)
+            // Resolve the tilesheets referred to by this layer only once
+            std::vector<Tiled::Tileset*> layerTilesets;
+            layerTilesets.reserve(tlayer.tilesheets.size());
+            for (const std::string &tilesheet : tlayer.tilesheets)
+                layerTilesets.push_back(map->tilesetAt(tmapTilesheetMapping[tilesheet]).data());
+
+            // Cells are converted a row at a time
+            const std::size_t width = static_cast<std::size_t>(tlayer.layerSize.x);
+            std::vector<Tiled::Cell> row(width);
+
+            for (int iy = 0; iy < tlayer.layerSize.y; ++iy) {
+                for (std::size_t ix = 0; ix < width; ++ix) {
+                    const std::size_t i = ix + static_cast<std::size_t>(iy) * width;
+                    const tbin::LayerTile &ttile = tlayer.tiles[i];
+
+                    if (ttile.type == tbin::Tile::Static && ttile.tileIndex != -1) {
+                        row[ix] = Tiled::Cell(layerTilesets[ttile.tilesheet], ttile.tileIndex);
+                    } else if (ttile.type == tbin::Tile::Animated) {
+                        const tbin::Tile &tanimated = tlayer.animatedTiles.at(i);
+                        if (tanimated.animatedData.frames.empty())
                             throw std::invalid_argument(QT_TR_NOOP("Invalid animation frame."));
 
-                        Tiled::Frame frame;
-                        frame.tileId = tframe.staticData.tileIndex;
-                        frame.duration = ttile.animatedData.frameInterval;
-                        frames.append(frame);
+                        const tbin::Tile &tfirstTile = tanimated.animatedData.frames[0];
+                        Tiled::Tile* firstTile = map->tilesetAt(tmapTilesheetMapping[tfirstTile.tilesheet])->findOrCreateTile(tfirstTile.staticData.tileIndex);
+                        QVector<Tiled::Frame> frames;
+                        for (const tbin::Tile& tframe : tanimated.animatedData.frames) {
+                            if (tframe.isNullTile() || tframe.animatedData.frames.size() > 0 ||
+                                 tframe.tilesheet != tfirstTile.tilesheet)
+                                throw std::invalid_argument(QT_TR_NOOP("Invalid animation frame."));
+
+                            Tiled::Frame frame;
+                            frame.tileId = tframe.staticData.tileIndex;
+                            frame.duration = tanimated.animatedData.frameInterval;
+                            frames.append(frame);
+                        }
+                        firstTile->setFrames(frames);
+                        row[ix] = Tiled::Cell(firstTile);
+                    } else {
+                        row[ix] = Tiled::Cell();
                     }
-                    firstTile->setFrames(frames);
-                    cell = Tiled::Cell(firstTile);
-                }
-                else {
-                    cell = Tiled::Cell(map->tilesetAt(tmapTilesheetMapping[ttile.tilesheet]).data(), ttile.staticData.tileIndex);
-                }
-                layer->setCell(ix, iy, cell);
-
-                if (ttile.props.size() > 0) {
-                    auto obj = std::make_unique<Tiled::MapObject>("TileData");
-                    obj->setPosition(QPointF(ix * tlayer.tileSize.x, iy * tlayer.tileSize.y));
-                    obj->setSize(QSizeF(tlayer.tileSize.x, tlayer.tileSize.y));
-                    tbinToTiledProperties(ttile.props, *obj);
-                    objects->addObject(std::move(obj));
                 }
+
+                layer->setRow(0, iy, tlayer.layerSize.x, row.data());
+            }
+
+            auto objects = std::make_unique<Tiled::ObjectGroup>(QString::fromStdString(tlayer.id), 0, 0);
+            for (const auto &tileProps : tlayer.tileProps) {
+                const int ix = static_cast<int>(tileProps.first % width);
+                const int iy = static_cast<int>(tileProps.first / width);
+
+                auto obj = std::make_unique<Tiled::MapObject>("TileData");
+                obj->setPosition(QPointF(ix * tlayer.tileSize.x, iy * tlayer.tileSize.y));
+                obj->setSize(QSizeF(tlayer.tileSize.x, tlayer.tileSize.y));
+                tbinToTiledProperties(tileProps.second, *obj);
+                objects->addObject(std::move(obj));
             }
             map->addLayer(std::move(layer));
             map->addLayer(std::move(objects));
@@ -317,43 +335,59 @@ bool TbinMapFormat::write(const Tiled::Map *map, const QString &fileName, Option
                 tlayer.tileSize.x = map->tileWidth();
                 tlayer.tileSize.y = map->tileHeight();
                 //tlayer.visible = ???;
-                for (int iy = 0; iy < tlayer.layerSize.y; ++iy) {
-                    for (int ix = 0; ix < tlayer.layerSize.x; ++ix) {
-                        Tiled::Cell cell = layer->cellAt(ix, iy);
-                        tbin::Tile ttile;
-                        ttile.staticData.tileIndex = -1;
+                tlayer.tiles.resize(static_cast<std::size_t>(tlayer.layerSize.x) * static_cast<std::size_t>(tlayer.layerSize.y));
+
+                QHash<Tiled::Tileset*, sf::Uint16> tilesheetIndexes;
+
+                const QRect rect(0, 0, layer->width(), layer->height());
+                layer->forEachSpan(rect, [&] (int startX, int iy, const Tiled::Cell *cells, int count) {
+                    for (int i = 0; i < count; ++i) {
+                        const Tiled::Cell &cell = cells[i];
+                        const int ix = startX + i;
 
                         if (hasFlags(cell)) {
                             Tiled::ERROR("tBIN: Flipped and/or rotated tiles are not supported.",
                                          Tiled::JumpToTile { map, QPoint(ix + layer->x(), iy + layer->y()), layer });
                         }
 
-                        if (Tiled::Tile *tile = cell.tile()) {
-                            ttile.tilesheet = tile->tileset()->name().toStdString();
-                            if (tile->frames().size() == 0) {
-                                ttile.staticData.tileIndex = tile->id();
-                                ttile.staticData.blendMode = 0;
-                            }
-                            else {
-                                ttile.animatedData.frameInterval = tile->frames().at(0).duration;
-
-                                for (Tiled::Frame frame : tile->frames()) {
-                                    if (frame.duration != ttile.animatedData.frameInterval) {
-                                        Tiled::ERROR("tBIN: Frames with different duration are not supported.",
-                                                     Tiled::SelectTile { tile });
-                                    }
-
-                                    tbin::Tile tframe;
-                                    tframe.tilesheet = ttile.tilesheet;
-                                    tframe.staticData.tileIndex = frame.tileId;
-                                    tframe.staticData.blendMode = 0;
-                                    ttile.animatedData.frames.push_back(tframe);
+                        Tiled::Tile *tile = cell.tile();
+                        if (!tile)
+                            continue;
+
+                        const std::size_t index = static_cast<std::size_t>(ix) + static_cast<std::size_t>(iy) * static_cast<std::size_t>(tlayer.layerSize.x);
+                        tbin::LayerTile &ttile = tlayer.tiles[index];
+
+                        auto indexIt = tilesheetIndexes.find(tile->tileset());
+                        if (indexIt == tilesheetIndexes.end())
+                            indexIt = tilesheetIndexes.insert(tile->tileset(), tlayer.tilesheetIndex(tile->tileset()->name().toStdString()));
+                        ttile.tilesheet = indexIt.value();
+
+                        if (tile->frames().size() == 0) {
+                            ttile.type = tbin::Tile::Static;
+                            ttile.tileIndex = tile->id();
+                            ttile.blendMode = 0;
+                        }
+                        else {
+                            ttile.type = tbin::Tile::Animated;
+
+                            tbin::Tile &tanimated = tlayer.animatedTiles[index];
+                            tanimated.animatedData.frameInterval = tile->frames().at(0).duration;
+
+                            for (Tiled::Frame frame : tile->frames()) {
+                                if (frame.duration != tanimated.animatedData.frameInterval) {
+                                    Tiled::ERROR("tBIN: Frames with different duration are not supported.",
+                                                 Tiled::SelectTile { tile });
                                 }
+
+                                tbin::Tile tframe;
+                                tframe.tilesheet = tlayer.tilesheets[ttile.tilesheet];
+                                tframe.staticData.tileIndex = frame.tileId;
+                                tframe.staticData.blendMode = 0;
+                                tanimated.animatedData.frames.push_back(tframe);
                             }
                         }
-                        tlayer.tiles.push_back(ttile);
                     }
-                }
+                });
                 tiledToTbinProperties(layer->properties(), tlayer.props, fileDir);
                 tmap.layers.push_back(std::move(tlayer));
                 tileLayerIdMap[tmap.layers.back().id] = &tmap.layers.back();
@@ -403,7 +437,7 @@ bool TbinMapFormat::write(const Tiled::Map *map, const QString &fileName, Option
                 tileY = qBound(0, tileY, tiles->layerSize.y - 1);
 
                 std::size_t idx = static_cast<std::size_t>(tileX + tileY * tiles->layerSize.x);
-                tiledToTbinProperties(obj->properties(), tiles->tiles[idx].props, fileDir);
+                tiledToTbinProperties(obj->properties(), tiles->tileProps[idx], fileDir);
             }
         }
 
@@ -0,0 +1,424 @@
+/*
+ * Tiled Compiled Map Plugin
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tcmplugin.h"
+
+#include "map.h"
+#include "savefile.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QPainter>
+#include <QSet>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <algorithm>
+#include <numeric>
+
+using namespace Tiled;
+
+namespace Tcm {
+
+namespace {
+
+/*
+ * File layout, all values little-endian:
+ *
+ *   header        the magic, followed by twelve 32-bit values (see below)
+ *   atlases       width, height and file name of each atlas image
+ *   tiles         location of each tile in the atlases, with its animation
+ *   layers        id and name of each tile layer (in LayerIterator order)
+ *   chunk index   one IndexEntrySize entry for each chunk
+ *   chunk data    the cells of each chunk, as 32-bit values
+ *
+ * The header values are the format version, the orientation, the map width
+ * and height, the tile width and height, the chunk width and height, and
+ * the number of atlases, tiles, layers and chunks.
+ *
+ * A tile entry contains the atlas index, the x, y, width and height of the
+ * tile in the atlas, the index of its tileset in the map, its tile ID, the
+ * number of animation frames and each frame's tile index and duration.
+ *
+ * An index entry contains the layer index, the chunk's x, y, width and
+ * height and the 64-bit offset of its cells relative to the start of the
+ * chunk data.
+ *
+ * Each cell stores the index of its tile plus one, with the same flipping
+ * flags in the highest bits as used by global tile IDs. Empty cells are 0.
+ *
+ * Strings are stored as their 32-bit UTF-8 length followed by the data.
+ */
+const char Magic[4] = { 'T', 'C', 'M', 'F' };
+constexpr quint32 FormatVersion = 1;
+
+constexpr unsigned FlippedHorizontallyFlag   = 0x80000000;
+constexpr unsigned FlippedVerticallyFlag     = 0x40000000;
+constexpr unsigned FlippedAntiDiagonallyFlag = 0x20000000;
+constexpr unsigned RotatedHexagonal120Flag   = 0x10000000;
+
+constexpr int MaxAtlasSize = 4096;
+constexpr int Padding = 1;
+
+struct AtlasTile
+{
+    const Tile *tile;
+    int tilesetIndex;
+    int atlas = 0;
+    QRect rect;         // location in the atlas
+};
+
+struct Atlas
+{
+    QSize size;
+    QString fileName;
+    QString error;
+};
+
+struct Layout
+{
+    QVector<AtlasTile> tiles;
+    QVector<Atlas> atlases;
+    QHash<const Tile*, quint32> tileIndexes;
+};
+
+struct ChunkData
+{
+    quint32 layerIndex;
+    QRect bounds;
+    QByteArray cells;
+};
+
+/**
+ * Collects the tiles used by the tile layers of the \a map, including the
+ * frames of their animations, and packs them into atlases using shelves.
+ */
+Layout layoutAtlases(const Map *map, const QString &fileName)
+{
+    QSet<const Tile*> usedTiles;
+
+    for (const Layer *layer : map->tileLayers()) {
+        const auto tileLayer = static_cast<const TileLayer*>(layer);
+        for (const Cell cell : *tileLayer)
+            if (const Tile *tile = cell.tile())
+                usedTiles.insert(tile);
+    }
+
+    for (const Tile *tile : QSet<const Tile*>(usedTiles)) {
+        for (const Frame &frame : tile->frames())
+            if (const Tile *frameTile = tile->tileset()->findTile(frame.tileId))
+                usedTiles.insert(frameTile);
+    }
+
+    Layout layout;
+
+    // Keep the order of the tilesets and their tiles, to get stable output
+    const auto &tilesets = map->tilesets();
+    for (int tilesetIndex = 0; tilesetIndex < tilesets.size(); ++tilesetIndex) {
+        for (const Tile *tile : tilesets.at(tilesetIndex)->tiles()) {
+            if (!usedTiles.contains(tile))
+                continue;
+
+            layout.tileIndexes.insert(tile, layout.tiles.size());
+            layout.tiles.append({ tile, tilesetIndex, 0, QRect(QPoint(), tile->imageRect().size()) });
+        }
+    }
+
+    // Placing the tallest tiles first wastes less space on each shelf
+    QVector<int> order(layout.tiles.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&] (int a, int b) {
+        return layout.tiles.at(a).rect.height() > layout.tiles.at(b).rect.height();
+    });
+
+    int x = 0;
+    int y = 0;
+    int shelfHeight = 0;
+
+    for (int index : std::as_const(order)) {
+        AtlasTile &atlasTile = layout.tiles[index];
+        const QSize size = atlasTile.rect.size();
+
+        if (x > 0 && x + size.width() > MaxAtlasSize) {
+            x = 0;
+            y += shelfHeight + Padding;
+            shelfHeight = 0;
+        }
+
+        if (layout.atlases.isEmpty() || (y > 0 && y + size.height() > MaxAtlasSize)) {
+            layout.atlases.append(Atlas());
+            x = 0;
+            y = 0;
+            shelfHeight = 0;
+        }
+
+        atlasTile.atlas = layout.atlases.size() - 1;
+        atlasTile.rect.moveTo(x, y);
+
+        x += size.width() + Padding;
+        shelfHeight = std::max(shelfHeight, size.height());
+
+        QSize &atlasSize = layout.atlases.last().size;
+        atlasSize = atlasSize.expandedTo(QSize(atlasTile.rect.right() + 1,
+                                               atlasTile.rect.bottom() + 1));
+    }
+
+    const QFileInfo fileInfo(fileName);
+    const QString base = fileInfo.completeBaseName();
+    const QDir dir = fileInfo.dir();
+
+    for (int i = 0; i < layout.atlases.size(); ++i) {
+        const QString atlasFileName = base + QStringLiteral("_atlas%1.png").arg(i);
+        layout.atlases[i].fileName = dir.filePath(atlasFileName);
+    }
+
+    return layout;
+}
+
+quint32 compiledCell(const Cell &cell, const QHash<const Tile*, quint32> &tileIndexes)
+{
+    const Tile *tile = cell.tile();
+    if (!tile)
+        return 0;
+
+    quint32 value = tileIndexes.value(tile) + 1;
+
+    if (cell.flippedHorizontally())
+        value |= FlippedHorizontallyFlag;
+    if (cell.flippedVertically())
+        value |= FlippedVerticallyFlag;
+    if (cell.flippedAntiDiagonally())
+        value |= FlippedAntiDiagonallyFlag;
+    if (cell.rotatedHexagonal120())
+        value |= RotatedHexagonal120Flag;
+
+    return value;
+}
+
+void writeString(QDataStream &out, const QString &string)
+{
+    const QByteArray utf8 = string.toUtf8();
+    out << quint32(utf8.size());
+    out.writeRawData(utf8.constData(), utf8.size());
+}
+
+} // anonymous namespace
+
+TcmPlugin::TcmPlugin()
+{
+}
+
+bool TcmPlugin::write(const Map *map, const QString &fileName, Options options)
+{
+    Q_UNUSED(options)
+
+    Layout layout = layoutAtlases(map, fileName);
+
+    // Pixmaps can only be used on the main thread
+    QVector<QImage> tileImages;
+    tileImages.reserve(layout.tiles.size());
+    for (const AtlasTile &atlasTile : std::as_const(layout.tiles))
+        tileImages.append(atlasTile.tile->croppedImage().toImage());
+
+    QVector<QVector<int>> atlasTiles(layout.atlases.size());
+    for (int i = 0; i < layout.tiles.size(); ++i)
+        atlasTiles[layout.tiles.at(i).atlas].append(i);
+
+    // Each atlas is composited and saved to its own file in parallel
+    QVector<int> atlasIndexes(layout.atlases.size());
+    std::iota(atlasIndexes.begin(), atlasIndexes.end(), 0);
+
+    QtConcurrent::blockingMap(atlasIndexes, [&] (int atlasIndex) {
+        Atlas &atlas = layout.atlases[atlasIndex];
+
+        QImage image(atlas.size, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        for (int tileIndex : atlasTiles.at(atlasIndex))
+            painter.drawImage(layout.tiles.at(tileIndex).rect.topLeft(), tileImages.at(tileIndex));
+        painter.end();
+
+        SaveFile file(atlas.fileName);
+        if (!file.open(QIODevice::WriteOnly)) {
+            atlas.error = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+            return;
+        }
+
+        if (!image.save(file.device(), "png")) {
+            atlas.error = tr("Error while writing file:\n%1").arg(file.errorString());
+            return;
+        }
+
+        if (!file.commit())
+            atlas.error = file.errorString();
+    });
+
+    for (const Atlas &atlas : std::as_const(layout.atlases)) {
+        if (!atlas.error.isEmpty()) {
+            mError = atlas.error;
+            return false;
+        }
+    }
+
+    // The cells of each chunk are remapped to atlas tile indexes in parallel
+    QVector<ChunkData> chunks;
+    QVector<const TileLayer*> tileLayers;
+
+    for (const Layer *layer : map->tileLayers()) {
+        const auto tileLayer = static_cast<const TileLayer*>(layer);
+        const quint32 layerIndex = tileLayers.size();
+
+        for (const QRect &bounds : tileLayer->sortedChunksToWrite(map->chunkSize()))
+            chunks.append({ layerIndex, bounds, QByteArray() });
+
+        tileLayers.append(tileLayer);
+    }
+
+    QtConcurrent::blockingMap(chunks, [&] (ChunkData &chunk) {
+        const QRect &bounds = chunk.bounds;
+        chunk.cells.resize(bounds.width() * bounds.height() * 4);
+
+        auto out = reinterpret_cast<uchar*>(chunk.cells.data());
+        tileLayers.at(chunk.layerIndex)->forEachSpan(bounds, [&] (int, int, const Cell *cells, int count) {
+            for (int i = 0; i < count; ++i, out += 4)
+                qToLittleEndian<quint32>(compiledCell(cells[i], layout.tileIndexes), out);
+        });
+    });
+
+    SaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+        return false;
+    }
+
+    QDataStream out(file.device());
+    out.setByteOrder(QDataStream::LittleEndian);
+
+    out.writeRawData(Magic, sizeof(Magic));
+    out << FormatVersion
+        << quint32(map->orientation())
+        << qint32(map->width())
+        << qint32(map->height())
+        << qint32(map->tileWidth())
+        << qint32(map->tileHeight())
+        << qint32(map->chunkSize().width())
+        << qint32(map->chunkSize().height())
+        << quint32(layout.atlases.size())
+        << quint32(layout.tiles.size())
+        << quint32(tileLayers.size())
+        << quint32(chunks.size());
+
+    const QDir dir = QFileInfo(fileName).dir();
+
+    for (const Atlas &atlas : std::as_const(layout.atlases)) {
+        out << qint32(atlas.size.width())
+            << qint32(atlas.size.height());
+        writeString(out, dir.relativeFilePath(atlas.fileName));
+    }
+
+    for (const AtlasTile &atlasTile : std::as_const(layout.tiles)) {
+        const Tile *tile = atlasTile.tile;
+        const QVector<Frame> &frames = tile->frames();
+
+        out << quint32(atlasTile.atlas)
+            << qint32(atlasTile.rect.x())
+            << qint32(atlasTile.rect.y())
+            << qint32(atlasTile.rect.width())
+            << qint32(atlasTile.rect.height())
+            << quint32(atlasTile.tilesetIndex)
+            << qint32(tile->id())
+            << quint32(frames.size());
+
+        for (const Frame &frame : frames) {
+            const Tile *frameTile = tile->tileset()->findTile(frame.tileId);
+            out << quint32(frameTile ? layout.tileIndexes.value(frameTile) : 0)
+                << qint32(frame.duration);
+        }
+    }
+
+    for (const TileLayer *tileLayer : std::as_const(tileLayers)) {
+        out << qint32(tileLayer->id());
+        writeString(out, tileLayer->name());
+    }
+
+    quint64 offset = 0;
+    for (const ChunkData &chunk : std::as_const(chunks)) {
+        out << chunk.layerIndex
+            << qint32(chunk.bounds.x())
+            << qint32(chunk.bounds.y())
+            << quint32(chunk.bounds.width())
+            << quint32(chunk.bounds.height())
+            << offset;
+
+        offset += chunk.cells.size();
+    }
+
+    for (const ChunkData &chunk : std::as_const(chunks))
+        out.writeRawData(chunk.cells.constData(), chunk.cells.size());
+
+    if (file.error() != QFileDevice::NoError) {
+        mError = tr("Error while writing file:\n%1").arg(file.errorString());
+        return false;
+    }
+
+    if (!file.commit()) {
+        mError = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+QStringList TcmPlugin::outputFiles(const Map *map, const QString &fileName) const
+{
+    QStringList result(fileName);
+
+    const Layout layout = layoutAtlases(map, fileName);
+    for (const Atlas &atlas : layout.atlases)
+        result.append(atlas.fileName);
+
+    return result;
+}
+
+QString TcmPlugin::nameFilter() const
+{
+    return tr("Tiled compiled map files (*.tcm)");
+}
+
+QString TcmPlugin::shortName() const
+{
+    return QStringLiteral("tcm");
+}
+
+QString TcmPlugin::errorString() const
+{
+    return mError;
+}
+
+} // namespace Tcm
@@ -0,0 +1,52 @@
+/*
+ * Tiled Compiled Map Plugin
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "tcm_global.h"
+
+#include "mapformat.h"
+
+namespace Tcm {
+
+/**
+ * Exports a map in a form that is ready for use at runtime. The used tiles
+ * are packed into atlas images, and the tile layers are written as fixed
+ * size chunks of atlas tile indexes.
+ */
+class TCMSHARED_EXPORT TcmPlugin : public Tiled::WritableMapFormat
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "org.mapeditor.MapFormat" FILE "plugin.json")
+
+public:
+    TcmPlugin();
+
+    bool write(const Tiled::Map *map, const QString &fileName, Options options) override;
+    QStringList outputFiles(const Tiled::Map *map, const QString &fileName) const override;
+    QString nameFilter() const override;
+    QString shortName() const override;
+    QString errorString() const override;
+
+private:
+    QString mError;
+};
+
+} // namespace Tcm
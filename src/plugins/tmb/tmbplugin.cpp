@@ -0,0 +1,338 @@
+/*
+ * Tiled Binary Map Plugin
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tmbplugin.h"
+
+#include "compression.h"
+#include "gidmapper.h"
+#include "layer.h"
+#include "map.h"
+#include "mapreader.h"
+#include "mapwriter.h"
+#include "savefile.h"
+#include "tilelayer.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <cstring>
+
+using namespace Tiled;
+
+namespace Tmb {
+
+namespace {
+
+/*
+ * File layout, all values little-endian:
+ *
+ *   header        the magic, followed by seven 32-bit values (see below)
+ *   first gids    32-bit first global tile ID of each tileset
+ *   document      TMX document with the map, without any tile layer data
+ *   chunk index   one IndexEntrySize entry for each chunk
+ *   chunk data    the compressed global tile IDs of each chunk
+ *
+ * The header values are the format version, the compression method, the
+ * layer data format of the map, the tileset count, the chunk count, the
+ * size of the document and a reserved value.
+ *
+ * An index entry contains the tile layer index (in LayerIterator order),
+ * the chunk's x, y, width and height, the compressed size and the 64-bit
+ * offset of its data in the file.
+ */
+const char Magic[4] = { 'T', 'M', 'B', 'F' };
+constexpr quint32 FormatVersion = 1;
+constexpr qint64 HeaderSize = 32;
+constexpr qint64 IndexEntrySize = 32;
+constexpr quint32 MaxChunkArea = 1 << 20;
+
+struct ChunkData
+{
+    quint32 layerIndex;
+    QRect bounds;
+    QByteArray data;
+};
+
+} // anonymous namespace
+
+TmbPlugin::TmbPlugin()
+{
+}
+
+std::unique_ptr<Map> TmbPlugin::read(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mError = QCoreApplication::translate("File Errors", "Could not open file for reading.");
+        return nullptr;
+    }
+
+    // Map the file, so that the chunks are decompressed without reading all
+    // of the file into memory first
+    const qint64 fileSize = file.size();
+    QByteArray fileData;
+    const uchar *data = file.map(0, fileSize);
+    if (!data) {
+        fileData = file.readAll();
+        data = reinterpret_cast<const uchar*>(fileData.constData());
+    }
+
+    if (fileSize < HeaderSize || std::memcmp(data, Magic, sizeof(Magic)) != 0) {
+        mError = tr("Not a Tiled binary map file.");
+        return nullptr;
+    }
+
+    auto readUInt32 = [data] (qint64 offset) {
+        return qFromLittleEndian<quint32>(data + offset);
+    };
+
+    const quint32 version = readUInt32(4);
+    if (version != FormatVersion) {
+        mError = tr("Unsupported binary map version: %1").arg(version);
+        return nullptr;
+    }
+
+    const quint32 method = readUInt32(8);
+    if (method > Zstandard || !compressionSupported(static_cast<CompressionMethod>(method))) {
+        mError = tr("Unsupported compression method: %1").arg(method);
+        return nullptr;
+    }
+
+    const quint32 layerDataFormat = readUInt32(12);
+    const quint32 tilesetCount = readUInt32(16);
+    const quint32 chunkCount = readUInt32(20);
+    const quint32 documentSize = readUInt32(24);
+
+    const QString corruptFile = tr("Corrupt binary map file.");
+
+    const qint64 documentOffset = HeaderSize + qint64(tilesetCount) * 4;
+    const qint64 indexOffset = documentOffset + documentSize;
+    if (indexOffset + qint64(chunkCount) * IndexEntrySize > fileSize) {
+        mError = corruptFile;
+        return nullptr;
+    }
+
+    QByteArray document = QByteArray::fromRawData(reinterpret_cast<const char*>(data + documentOffset),
+                                                  static_cast<int>(documentSize));
+    QBuffer buffer(&document);
+    buffer.open(QIODevice::ReadOnly);
+
+    MapReader reader;
+    auto map = reader.readMap(&buffer, QFileInfo(fileName).absolutePath());
+    if (!map) {
+        mError = reader.errorString();
+        return nullptr;
+    }
+
+    if (map->tilesetCount() != static_cast<int>(tilesetCount)) {
+        mError = corruptFile;
+        return nullptr;
+    }
+
+    GidMapper gidMapper;
+    for (quint32 i = 0; i < tilesetCount; ++i)
+        gidMapper.insert(readUInt32(HeaderSize + i * 4), map->tilesetAt(i));
+
+    QVector<TileLayer*> tileLayers;
+    LayerIterator iterator(map.get(), Layer::TileLayerType);
+    while (Layer *layer = iterator.next())
+        tileLayers.append(static_cast<TileLayer*>(layer));
+
+    CompressionContext &context = CompressionContext::forCurrentThread();
+    QByteArray decodedData;
+
+    for (quint32 i = 0; i < chunkCount; ++i) {
+        const qint64 entry = indexOffset + i * IndexEntrySize;
+
+        const quint32 layerIndex = readUInt32(entry);
+        const qint32 x = qFromLittleEndian<qint32>(data + entry + 4);
+        const qint32 y = qFromLittleEndian<qint32>(data + entry + 8);
+        const quint32 width = readUInt32(entry + 12);
+        const quint32 height = readUInt32(entry + 16);
+        const quint32 size = readUInt32(entry + 20);
+        const quint64 offset = qFromLittleEndian<quint64>(data + entry + 24);
+
+        if (layerIndex >= static_cast<quint32>(tileLayers.size()) ||
+                width == 0 || height == 0 ||
+                quint64(width) * height > MaxChunkArea ||
+                offset > quint64(fileSize) || size > quint64(fileSize) - offset) {
+            mError = corruptFile;
+            return nullptr;
+        }
+
+        TileLayer &tileLayer = *tileLayers.at(layerIndex);
+        const QRect bounds(x, y, static_cast<int>(width), static_cast<int>(height));
+
+        const QByteArray compressedData = QByteArray::fromRawData(reinterpret_cast<const char*>(data + offset),
+                                                                  static_cast<int>(size));
+        decodedData.resize(static_cast<int>(width * height * 4));
+
+        if (!context.decompressInto(compressedData, decodedData.data(), decodedData.size(),
+                                    static_cast<CompressionMethod>(method))) {
+            mError = tr("Corrupt layer data for layer '%1'").arg(tileLayer.name());
+            return nullptr;
+        }
+
+        switch (gidMapper.setLayerData(tileLayer, decodedData, bounds)) {
+        case GidMapper::CorruptLayerData:
+            mError = tr("Corrupt layer data for layer '%1'").arg(tileLayer.name());
+            return nullptr;
+        case GidMapper::TileButNoTilesets:
+            mError = tr("Tile used but no tilesets specified");
+            return nullptr;
+        case GidMapper::InvalidTile:
+            mError = tr("Invalid tile: %1").arg(gidMapper.invalidTile());
+            return nullptr;
+        case GidMapper::NoError:
+            break;
+        }
+    }
+
+    if (layerDataFormat <= Map::Base64Zstandard)
+        map->setLayerDataFormat(static_cast<Map::LayerDataFormat>(layerDataFormat));
+
+    return map;
+}
+
+bool TmbPlugin::supportsFile(const QString &fileName) const
+{
+    if (!fileName.endsWith(QLatin1String(".tmb"), Qt::CaseInsensitive))
+        return false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    return file.read(sizeof(Magic)) == QByteArray::fromRawData(Magic, sizeof(Magic));
+}
+
+bool TmbPlugin::write(const Map *map, const QString &fileName, Options options)
+{
+    // Store the map without its tile layer data, which is written as chunks
+    std::unique_ptr<Map> strippedMap = map->clone();
+    strippedMap->setLayerDataFormat(Map::Base64Zlib);
+
+    LayerIterator strippedIterator(strippedMap.get(), Layer::TileLayerType);
+    while (Layer *layer = strippedIterator.next())
+        static_cast<TileLayer*>(layer)->clear();
+
+    QByteArray document;
+    QBuffer buffer(&document);
+    buffer.open(QIODevice::WriteOnly);
+
+    MapWriter writer;
+    writer.setMinimizeOutput(options.testFlag(WriteMinimized));
+    writer.writeMap(strippedMap.get(), &buffer, QFileInfo(fileName).absolutePath());
+
+    strippedMap.reset();
+
+    // Compress the chunks of each tile layer
+    const CompressionMethod method = compressionSupported(Zstandard) ? Zstandard : Zlib;
+    const GidMapper gidMapper(map->tilesets());
+    CompressionContext &context = CompressionContext::forCurrentThread();
+
+    QVector<ChunkData> chunks;
+    quint32 layerIndex = 0;
+
+    LayerIterator iterator(map, Layer::TileLayerType);
+    while (Layer *layer = iterator.next()) {
+        const TileLayer &tileLayer = *static_cast<TileLayer*>(layer);
+        const auto chunkBounds = tileLayer.sortedChunksToWrite(QSize(CHUNK_SIZE, CHUNK_SIZE));
+
+        for (const QRect &bounds : chunkBounds) {
+            const QByteArray gids = gidMapper.uncompressedLayerData(tileLayer, bounds);
+            chunks.append({ layerIndex, bounds, context.compress(gids, method) });
+        }
+
+        ++layerIndex;
+    }
+
+    SaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        mError = QCoreApplication::translate("File Errors", "Could not open file for writing.");
+        return false;
+    }
+
+    QDataStream out(file.device());
+    out.setByteOrder(QDataStream::LittleEndian);
+
+    out.writeRawData(Magic, sizeof(Magic));
+    out << FormatVersion
+        << quint32(method)
+        << quint32(map->layerDataFormat())
+        << quint32(map->tilesetCount())
+        << quint32(chunks.size())
+        << quint32(document.size())
+        << quint32(0);
+
+    unsigned firstGid = 1;
+    for (const SharedTileset &tileset : map->tilesets()) {
+        out << quint32(firstGid);
+        firstGid += tileset->nextTileId();
+    }
+
+    out.writeRawData(document.constData(), document.size());
+
+    quint64 offset = HeaderSize + map->tilesetCount() * 4 + document.size()
+            + chunks.size() * IndexEntrySize;
+
+    for (const ChunkData &chunk : std::as_const(chunks)) {
+        out << chunk.layerIndex
+            << qint32(chunk.bounds.x())
+            << qint32(chunk.bounds.y())
+            << quint32(chunk.bounds.width())
+            << quint32(chunk.bounds.height())
+            << quint32(chunk.data.size())
+            << offset;
+
+        offset += chunk.data.size();
+    }
+
+    for (const ChunkData &chunk : std::as_const(chunks))
+        out.writeRawData(chunk.data.constData(), chunk.data.size());
+
+    if (!file.commit()) {
+        mError = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+QString TmbPlugin::nameFilter() const
+{
+    return tr("Tiled binary map files (*.tmb)");
+}
+
+QString TmbPlugin::shortName() const
+{
+    return QStringLiteral("tmb");
+}
+
+QString TmbPlugin::errorString() const
+{
+    return mError;
+}
+
+} // namespace Tmb
@@ -34,6 +34,7 @@
 #include <QFileInfo>
 #include <QMap>
 #include <QRegularExpression>
+#include <QtConcurrent>
 
 #include <iostream>
 #include <map>
@@ -328,14 +329,9 @@ static void addTileset(Tileset *tileset, AssetInfo &assetInfo)
 // Search a layer for every tileset that was used and store it in assetInfo
 static void findUsedTilesets(const TileLayer *layer, AssetInfo &assetInfo)
 {
-    auto bounds = layer->localBounds();
-    for (int y = bounds.y(); y < bounds.y() + bounds.height(); ++y) {
-        for (int x = bounds.x(); x < bounds.x() + bounds.width(); ++x) {
-            auto cell = layer->cellAt(x, y);
-            if (!cell.isEmpty())
-                addTileset(cell.tileset(), assetInfo);
-        }
-    }
+    const auto tilesets = layer->usedTilesets();
+    for (const SharedTileset &tileset : tilesets)
+        addTileset(tileset.data(), assetInfo);
 }
 
 // Search an object layer for all object resources and save them in assetInfo
@@ -855,6 +851,127 @@ static void writeTileset(const Map *map, QFileDevice *device, bool isExternal, A
 }
 
 
+// The details of a tileset needed for writing the tile data, looked up
+// once per export rather than for each tile
+struct TileDataTileset
+{
+    int atlasId;
+    int columnCount;
+    bool exportAlternates;
+    const QSet<int> *reservedAnimationTiles;
+};
+
+using TileDataTilesets = QHash<const Tileset*, TileDataTileset>;
+
+// Tilesets are identified by their image, so multiple tilesets may share the
+// same atlas
+static TileDataTilesets tileDataTilesets(AssetInfo &assetInfo)
+{
+    TileDataTilesets tilesets;
+
+    for (const TileLayer *layer : std::as_const(assetInfo.layers)) {
+        const auto usedTilesets = layer->usedTilesets();
+        for (const SharedTileset &tileset : usedTilesets) {
+            if (tilesets.contains(tileset.data()))
+                continue;
+
+            const auto resPath = imageSourceToRes(tileset.data(), assetInfo.resRoot);
+            const TilesetInfo &tilesetInfo = assetInfo.tilesetInfo[resPath];
+
+            tilesets.insert(tileset.data(), TileDataTileset {
+                                tilesetInfo.atlasId,
+                                tileset->columnCount(),
+                                tileset->resolvedProperty("exportAlternates").toBool(),
+                                &tilesetInfo.reservedAnimationTiles
+                            });
+        }
+    }
+
+    return tilesets;
+}
+
+// Returns the contents of the PackedInt32Array holding the tiles of the
+// given layer.
+//
+// Tile packing format:
+// DestLocation, SrcX, SrcY
+// Where:
+//   DestLocation = (DestX >= 0 ? DestY : DestY + 1) * 65536 + DestX
+//   SrcX         = SrcX * 65536 + TileSetId
+//   SrcY         = SrcY + 65536 * (AlternateId | FLIP_H | FLIP_V | TRANSPOSE)
+//
+// Only reads from the layer and the lookup table, so the tile data of
+// multiple layers can be generated in parallel.
+static QByteArray tileData(const Map *map, const TileLayer *layer,
+                           const TileDataTilesets &tilesets)
+{
+    QByteArray data;
+
+    const Tileset *currentTileset = nullptr;
+    const TileDataTileset *info = nullptr;
+
+    auto appendNumber = [&data] (int number) {
+        if (!data.isEmpty())
+            data.append(", ");
+        data.append(QByteArray::number(number));
+    };
+
+    layer->forEachSpan(layer->bounds(), [&] (int startX, int y, const Cell *cells, int count) {
+        for (int i = 0; i < count; ++i) {
+            const Cell &cell = cells[i];
+            if (cell.isEmpty())
+                continue;
+
+            const int x = startX + i;
+
+            if (cell.tileset() != currentTileset) {
+                currentTileset = cell.tileset();
+                auto it = tilesets.constFind(currentTileset);
+                info = it != tilesets.constEnd() ? &it.value() : nullptr;
+            }
+            if (!info)
+                continue;
+
+            if (info->reservedAnimationTiles->contains(cell.tileId())) {
+                Tiled::ERROR(TscnPlugin::tr("Cannot use tile %1 from tileset %2 because it is "
+                                            "reserved as an animation frame.")
+                                         .arg(cell.tileId())
+                                         .arg(cell.tileset()->name()),
+                             Tiled::SelectTile { cell.tile() });
+            }
+
+            int alt = 0;
+            if (cell.rotatedHexagonal120()) {
+                Tiled::ERROR(TscnPlugin::tr("Hex tiles that are rotated by 120° degrees are not supported."),
+                             Tiled::JumpToTile { map, QPoint(x, y), layer });
+            }
+            if (cell.flippedHorizontally())
+                alt |= FlippedH;
+            if (cell.flippedVertically())
+                alt |= FlippedV;
+            if (cell.flippedAntiDiagonally())
+                alt |= Transposed;
+            // exportAlternate Deprecation Note: Remove this if block
+            if (alt && !info->exportAlternates) {
+                alt <<= 12;
+            }
+
+            int destLocation = (x >= 0 ? y : y + 1) * 65536 + x;
+            int srcX = cell.tileId() % info->columnCount;
+            srcX *= 65536;
+            srcX += info->atlasId;
+            int srcY = cell.tileId() / info->columnCount;
+            srcY += alt * 65536;
+
+            appendNumber(destLocation);
+            appendNumber(srcX);
+            appendNumber(srcY);
+        }
+    });
+
+    return data;
+}
+
 bool TscnPlugin::write(const Map *map, const QString &fileName, Options options)
 {
     Q_UNUSED(options)
@@ -935,14 +1052,29 @@ bool TscnPlugin::write(const Map *map, const QString &fileName, Options options)
 
         device->write("format = 2\n");
 
-        // Tile packing format:
-        // DestLocation, SrcX, SrcY
-        // Where:
-        //   DestLocation = (DestX >= 0 ? DestY : DestY + 1) * 65536 + DestX
-        //   SrcX         = SrcX * 65536 + TileSetId
-        //   SrcY         = SrcY + 65536 * (AlternateId | FLIP_H | FLIP_V | TRANSPOSE)
+        // The tile data of large layers is by far the biggest part of the
+        // file, so it is generated in parallel
+        struct LayerTileData
+        {
+            const TileLayer *layer;
+            QByteArray data;
+        };
+
+        const TileDataTilesets tilesets = tileDataTilesets(assetInfo);
+
+        QVector<LayerTileData> layerTileData;
+        layerTileData.reserve(assetInfo.layers.size());
+        for (const auto layer : std::as_const(assetInfo.layers))
+            layerTileData.append(LayerTileData { layer, QByteArray() });
+
+        QtConcurrent::blockingMap(layerTileData, [&] (LayerTileData &layerData) {
+            layerData.data = tileData(map, layerData.layer, tilesets);
+        });
+
         int layerIndex = 0;
-        for (const auto layer : std::as_const(assetInfo.layers)) {
+        for (const LayerTileData &layerData : std::as_const(layerTileData)) {
+            const TileLayer *layer = layerData.layer;
+
             device->write(formatByteString("layer_%1/name = \"%2\"\n",
                                            layerIndex,
                                            sanitizeQuotedString(layer->name())));
@@ -960,59 +1092,7 @@ bool TscnPlugin::write(const Map *map, const QString &fileName, Options options)
 
             device->write(formatByteString("layer_%1/tile_data = PackedInt32Array(",
                                            layerIndex));
-
-            bool first = true;
-            auto bounds = layer->bounds();
-            for (int y = bounds.y(); y < bounds.y() + bounds.height(); ++y) {
-                for (int x = bounds.x(); x < bounds.x() + bounds.width(); ++x) {
-                    auto& cell = layer->cellAt(x, y);
-
-                    if (!cell.isEmpty()) {
-                        auto resPath = imageSourceToRes(cell.tile()->tileset(), assetInfo.resRoot);
-                        auto& tilesetInfo = assetInfo.tilesetInfo[resPath];
-
-                        if (tilesetInfo.reservedAnimationTiles.contains(cell.tileId())) {
-                            Tiled::ERROR(TscnPlugin::tr("Cannot use tile %1 from tileset %2 because it is "
-                                                        "reserved as an animation frame.")
-                                                     .arg(cell.tileId())
-                                                     .arg(cell.tileset()->name()),
-                                         Tiled::SelectTile { cell.tile() });
-                        }
-
-                        int alt = 0;
-                        if (cell.rotatedHexagonal120()) {
-                            Tiled::ERROR(TscnPlugin::tr("Hex tiles that are rotated by 120° degrees are not supported."),
-                                         Tiled::JumpToTile { map, QPoint(x, y), layer });
-                        }
-                        if (cell.flippedHorizontally())
-                            alt |= FlippedH;
-                        if (cell.flippedVertically())
-                            alt |= FlippedV;
-                        if (cell.flippedAntiDiagonally())
-                            alt |= Transposed;
-                        // exportAlternate Deprecation Note: Remove this if block
-                        if (alt && !cell.tileset()->resolvedProperty("exportAlternates").toBool()) {
-                            alt <<= 12;
-                        }
-
-                        int destLocation = (x >= 0 ? y : y + 1) * 65536 + x;
-                        int srcX = cell.tileId() % cell.tileset()->columnCount();
-                        srcX *= 65536;
-                        srcX += tilesetInfo.atlasId;
-                        int srcY = cell.tileId() / cell.tileset()->columnCount();
-                        srcY += alt * 65536;     
-
-                        if (!first)
-                            device->write(", ");
-
-                        device->write(formatByteString("%1, %2, %3",
-                                                       destLocation, srcX, srcY));
-
-                        first = false;
-                    }
-                }
-            }
-
+            device->write(layerData.data);
             device->write(")\n");
 
             layerIndex++;
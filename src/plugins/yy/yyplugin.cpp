@@ -37,6 +37,7 @@
 #include <QDirIterator>
 #include <QFileInfo>
 #include <QRegularExpression>
+#include <QtConcurrent>
 
 #include <vector>
 
@@ -248,7 +249,12 @@ struct GMRTileLayer final : GMRLayer
     int y = 0;
     int SerialiseWidth = 0;
     int SerialiseHeight = 0;
-    std::vector<unsigned> tiles;
+    bool compressed = true;
+    std::vector<int> tiles;     // run-length encoded when compressed
+
+    // The tiles are filled in by fillTileLayer, after processing the layers
+    const TileLayer *tileLayer = nullptr;
+    const Tileset *tileset = nullptr;
 };
 
 struct GMRAssetLayer final : GMRLayer
@@ -307,6 +313,8 @@ struct Context
     std::vector<InstanceCreation> instanceCreationOrder;
     std::unique_ptr<MapRenderer> renderer;
     ExportContext exportContext;
+    std::vector<GMRTileLayer*> tileLayers;
+    bool compressTileData = true;
 
     QString makeUnique(const QString &name)
     {
@@ -634,20 +642,41 @@ static void writeLayers(JsonWriter &json, const std::vector<std::unique_ptr<GMRL
             json.writeStartObject("tiles");
             json.writeMember("SerialiseWidth", tileLayer.SerialiseWidth);
             json.writeMember("SerialiseHeight", tileLayer.SerialiseHeight);
-            json.writeStartArray("TileSerialiseData");
 
-            size_t index = 0;
+            if (tileLayer.compressed) {
+                json.writeStartArray("TileCompressedData");
 
-            for (int y = 0; y < tileLayer.SerialiseHeight; ++y) {
-                json.prepareNewLine();
+                for (size_t index = 0; index < tileLayer.tiles.size(); ) {
+                    json.prepareNewLine();
+
+                    // A negative count is followed by a single repeated value
+                    const int count = tileLayer.tiles.at(index++);
+                    const int valueCount = count < 0 ? 1 : count;
+                    json.writeValue(count);
+
+                    for (int i = 0; i < valueCount; ++i)
+                        json.writeValue(tileLayer.tiles.at(index++));
+                }
+
+                json.writeEndArray();   // TileCompressedData
+                json.writeMember("TileDataFormat", 1);
+            } else {
+                json.writeStartArray("TileSerialiseData");
 
-                for (int x = 0; x < tileLayer.SerialiseWidth; ++x) {
-                    json.writeValue(tileLayer.tiles.at(index));
-                    ++index;
+                size_t index = 0;
+
+                for (int y = 0; y < tileLayer.SerialiseHeight; ++y) {
+                    json.prepareNewLine();
+
+                    for (int x = 0; x < tileLayer.SerialiseWidth; ++x) {
+                        json.writeValue(static_cast<unsigned>(tileLayer.tiles.at(index)));
+                        ++index;
+                    }
                 }
+
+                json.writeEndArray();   // TileSerialiseData
             }
 
-            json.writeEndArray();   // TileSerialiseData
             json.writeEndObject();  // tiles
             break;
         }
@@ -675,26 +704,105 @@ static void writeLayers(JsonWriter &json, const std::vector<std::unique_ptr<GMRL
     json.writeEndArray();   // layers
 }
 
-static void fillTileLayer(GMRTileLayer &gmrTileLayer, const TileLayer *tileLayer, const Tileset *tileset)
+namespace {
+
+/**
+ * Encodes tile data in the run-length encoded form GameMaker uses for
+ * "TileCompressedData". A negative count is followed by a single value that
+ * is repeated that many times, while a positive count is followed by that
+ * many values.
+ */
+class TileRunEncoder
 {
-    const auto layerOffset = tileLayer->totalOffset().toPoint();
+public:
+    explicit TileRunEncoder(std::vector<int> &out)
+        : mOut(out)
+    {}
+
+    void add(int value)
+    {
+        if (mRunLength > 0 && value != mRunValue)
+            endRun();
+
+        mRunValue = value;
+        ++mRunLength;
+    }
+
+    void finish()
+    {
+        endRun();
+        flushLiterals();
+    }
 
-    gmrTileLayer.tilesetId = sanitizeName(tileset->name());
-    gmrTileLayer.x = layerOffset.x();
-    gmrTileLayer.y = layerOffset.y();
-    gmrTileLayer.SerialiseHeight = tileLayer->height();
-    gmrTileLayer.SerialiseWidth = tileLayer->width();
+private:
+    void endRun()
+    {
+        // Short runs are cheaper to store as part of a list of literals
+        if (mRunLength >= 3) {
+            flushLiterals();
+            mOut.push_back(-mRunLength);
+            mOut.push_back(mRunValue);
+        } else {
+            mLiterals.insert(mLiterals.end(), mRunLength, mRunValue);
+        }
+
+        mRunLength = 0;
+    }
+
+    void flushLiterals()
+    {
+        if (mLiterals.empty())
+            return;
+
+        mOut.push_back(static_cast<int>(mLiterals.size()));
+        mOut.insert(mOut.end(), mLiterals.begin(), mLiterals.end());
+        mLiterals.clear();
+    }
+
+    std::vector<int> &mOut;
+    std::vector<int> mLiterals;
+    int mRunValue = 0;
+    int mRunLength = 0;
+};
+
+} // anonymous namespace
+
+/**
+ * Fills in the tiles of \a gmrTileLayer based on its source layer and
+ * tileset. Does not touch the export context, so that the tile layers can be
+ * filled in parallel.
+ */
+static void fillTileLayer(GMRTileLayer &gmrTileLayer)
+{
+    const TileLayer *tileLayer = gmrTileLayer.tileLayer;
+    const Tileset *tileset = gmrTileLayer.tileset;
 
     constexpr unsigned Uninitialized        = 0x80000000;
     constexpr unsigned FlippedHorizontally  = 0x10000000;
     constexpr unsigned FlippedVertically    = 0x20000000;
     constexpr unsigned Rotated90            = 0x40000000;
 
-    for (int y = 0; y < tileLayer->height(); ++y) {
-        for (int x = 0; x < tileLayer->width(); ++x) {
-            const Cell &cell = tileLayer->cellAt(x, y);
+    TileRunEncoder encoder(gmrTileLayer.tiles);
+
+    auto addTile = [&] (unsigned tile) {
+        if (gmrTileLayer.compressed)
+            encoder.add(static_cast<int>(tile));
+        else
+            gmrTileLayer.tiles.push_back(static_cast<int>(tile));
+    };
+
+    if (!gmrTileLayer.compressed) {
+        gmrTileLayer.tiles.reserve(static_cast<size_t>(gmrTileLayer.SerialiseWidth) *
+                                   static_cast<size_t>(gmrTileLayer.SerialiseHeight));
+    }
+
+    const QRect rect(0, 0, gmrTileLayer.SerialiseWidth, gmrTileLayer.SerialiseHeight);
+
+    tileLayer->forEachSpan(rect, [&] (int startX, int y, const Cell *cells, int count) {
+        for (int i = 0; i < count; ++i) {
+            const Cell &cell = cells[i];
             if (cell.tileset() != tileset) {
-                gmrTileLayer.tiles.push_back(Uninitialized);
+                addTile(Uninitialized);
                 continue;
             }
 
@@ -702,7 +810,7 @@ static void fillTileLayer(GMRTileLayer &gmrTileLayer, const TileLayer *tileLayer
 
             if (tileId == 0) {
                 Tiled::WARNING(QStringLiteral("YY plugin: First tile in tileset used, which will appear invisible in GameMaker"),
-                               Tiled::JumpToTile { tileLayer->map(), QPoint(x, y), tileLayer });
+                               Tiled::JumpToTile { tileLayer->map(), QPoint(startX + i, y), tileLayer });
             }
 
             if (cell.flippedAntiDiagonally()) {
@@ -718,9 +826,12 @@ static void fillTileLayer(GMRTileLayer &gmrTileLayer, const TileLayer *tileLayer
                     tileId |= FlippedVertically;
             }
 
-            gmrTileLayer.tiles.push_back(tileId);
+            addTile(tileId);
         }
-    }
+    });
+
+    if (gmrTileLayer.compressed)
+        encoder.finish();
 }
 
 static void initializeTileGraphic(GMRGraphic &g,
@@ -870,9 +981,20 @@ static std::unique_ptr<GMRLayer> processTileLayer(const TileLayer *tileLayer,
             if (tileset->tileSize() != tileLayer->map()->tileSize())
                 continue;
 
+            const auto layerOffset = tileLayer->totalOffset().toPoint();
+
             auto gmrTileLayer = std::make_unique<GMRTileLayer>();
             gmrTileLayer->name = sanitizeName(QStringLiteral("%1_%2").arg(tileLayer->name(), tileset->name()));
-            fillTileLayer(*gmrTileLayer, tileLayer, tileset.data());
+            gmrTileLayer->tilesetId = sanitizeName(tileset->name());
+            gmrTileLayer->x = layerOffset.x();
+            gmrTileLayer->y = layerOffset.y();
+            gmrTileLayer->SerialiseWidth = tileLayer->width();
+            gmrTileLayer->SerialiseHeight = tileLayer->height();
+            gmrTileLayer->compressed = context.compressTileData;
+            gmrTileLayer->tileLayer = tileLayer;
+            gmrTileLayer->tileset = tileset.data();
+
+            context.tileLayers.push_back(gmrTileLayer.get());
             gmrLayers.push_back(std::move(gmrTileLayer));
         }
     }
@@ -892,7 +1014,9 @@ static std::unique_ptr<GMRLayer> processTileLayer(const TileLayer *tileLayer,
     } else if (gmrLayers.empty()) {
         // When no layers are set up, the tile layer is exported as an
         // empty tile layer.
-        gmrLayer = std::make_unique<GMRTileLayer>();
+        auto gmrTileLayer = std::make_unique<GMRTileLayer>();
+        gmrTileLayer->compressed = context.compressTileData;
+        gmrLayer = std::move(gmrTileLayer);
     } else {
         // When multiple layers have been created, they will be exported
         // as children of a group layer.
@@ -917,15 +1041,8 @@ static std::unique_ptr<GMRLayer> processObjectGroup(const ObjectGroup *objectGro
     color.setAlphaF(color.alphaF() * objectGroup->effectiveOpacity());
     const auto layerOffset = objectGroup->totalOffset().toPoint();
 
-    auto objects = objectGroup->objects();
-
     // Make sure the objects export in the rendering order
-    if (objectGroup->drawOrder() == ObjectGroup::TopDownOrder) {
-        std::stable_sort(objects.begin(), objects.end(),
-                         [](const MapObject *a, const MapObject *b) { return a->y() < b->y(); });
-    }
-
-    for (const MapObject *mapObject : std::as_const(objects)) {
+    for (const MapObject *mapObject : objectGroup->objectsInDrawOrder()) {
         const QString &className = mapObject->effectiveClassName();
 
         if (className == QLatin1String("view")) {
@@ -1366,10 +1483,17 @@ bool YyPlugin::write(const Map *map, const QString &fileName, Options options)
 
     Context context;
     context.renderer = MapRenderer::create(map);
+    context.compressTileData = optionalProperty(map, "compressTileData", true);
 
     std::vector<std::unique_ptr<GMRLayer>> layers;
     processLayers(layers, map->layers(), context);
 
+    // Preparing the tile data of large tile layers takes most of the time,
+    // so it is done in parallel
+    QtConcurrent::blockingMap(context.tileLayers, [] (GMRTileLayer *gmrTileLayer) {
+        fillTileLayer(*gmrTileLayer);
+    });
+
     // If a valid background color is set, create a background layer with this color.
     if (map->backgroundColor().isValid()) {
         auto gmrBackgroundLayer = std::make_unique<GMRBackgroundLayer>();
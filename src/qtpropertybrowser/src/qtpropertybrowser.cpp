@@ -41,6 +41,7 @@
 
 #include "qtpropertybrowser.h"
 #include <QSet>
+#include <QHash>
 #include <QMap>
 #include <QIcon>
 #include <QLineEdit>
@@ -493,7 +494,7 @@ void QtProperty::insertSubProperty(QtProperty *property,
 
     // traverse all children of item. if this item is a child of item then cannot add.
     QList<QtProperty *> pendingList = property->subProperties();
-    QMap<QtProperty *, bool> visited;
+    QSet<QtProperty *> visited;
     while (!pendingList.isEmpty()) {
         QtProperty *i = pendingList.first();
         if (i == this)
@@ -501,7 +502,7 @@ void QtProperty::insertSubProperty(QtProperty *property,
         pendingList.removeFirst();
         if (visited.contains(i))
             continue;
-        visited[i] = true;
+        visited.insert(i);
         pendingList += i->subProperties();
     }
 
@@ -1305,12 +1306,12 @@ public:
     void slotPropertyDataChanged(QtProperty *property);
 
     QList<QtProperty *> m_subItems;
-    QMap<QtAbstractPropertyManager *, QList<QtProperty *> > m_managerToProperties;
-    QMap<QtProperty *, QList<QtProperty *> > m_propertyToParents;
+    QHash<QtAbstractPropertyManager *, QSet<QtProperty *> > m_managerToProperties;
+    QHash<QtProperty *, QList<QtProperty *> > m_propertyToParents;
 
-    QMap<QtProperty *, QtBrowserItem *> m_topLevelPropertyToIndex;
+    QHash<QtProperty *, QtBrowserItem *> m_topLevelPropertyToIndex;
     QList<QtBrowserItem *> m_topLevelIndexes;
-    QMap<QtProperty *, QList<QtBrowserItem *> > m_propertyToIndexes;
+    QHash<QtProperty *, QList<QtBrowserItem *> > m_propertyToIndexes;
 
     QtBrowserItem *m_currentItem;
 };
@@ -1347,7 +1348,7 @@ void QtAbstractPropertyBrowserPrivate::insertSubTree(QtProperty *property,
         q_ptr->connect(manager, SIGNAL(propertyChanged(QtProperty *)),
                 q_ptr, SLOT(slotPropertyDataChanged(QtProperty *)));
     }
-    m_managerToProperties[manager].append(property);
+    m_managerToProperties[manager].insert(property);
     m_propertyToParents[property].append(parentProperty);
 
     QList<QtProperty *> subList = property->subProperties();
@@ -1372,7 +1373,7 @@ void QtAbstractPropertyBrowserPrivate::removeSubTree(QtProperty *property,
 
     m_propertyToParents.remove(property);
     QtAbstractPropertyManager *manager = property->propertyManager();
-    m_managerToProperties[manager].removeAll(property);
+    m_managerToProperties[manager].remove(property);
     if (m_managerToProperties[manager].isEmpty()) {
         // disconnect manager's signals
         q_ptr->disconnect(manager, SIGNAL(propertyInserted(QtProperty *,
@@ -1402,7 +1403,7 @@ void QtAbstractPropertyBrowserPrivate::createBrowserIndexes(QtProperty *property
 {
     QMap<QtBrowserItem *, QtBrowserItem *> parentToAfter;
     if (afterProperty) {
-        QMap<QtProperty *, QList<QtBrowserItem *> >::ConstIterator it =
+        QHash<QtProperty *, QList<QtBrowserItem *> >::ConstIterator it =
             m_propertyToIndexes.find(afterProperty);
         if (it == m_propertyToIndexes.constEnd())
             return;
@@ -1416,7 +1417,7 @@ void QtAbstractPropertyBrowserPrivate::createBrowserIndexes(QtProperty *property
                 parentToAfter[idx->parent()] = idx;
         }
     } else if (parentProperty) {
-        QMap<QtProperty *, QList<QtBrowserItem *> >::ConstIterator it =
+        QHash<QtProperty *, QList<QtBrowserItem *> >::ConstIterator it =
                 m_propertyToIndexes.find(parentProperty);
         if (it == m_propertyToIndexes.constEnd())
             return;
@@ -1463,7 +1464,7 @@ QtBrowserItem *QtAbstractPropertyBrowserPrivate::createBrowserIndex(QtProperty *
 void QtAbstractPropertyBrowserPrivate::removeBrowserIndexes(QtProperty *property, QtProperty *parentProperty)
 {
     QList<QtBrowserItem *> toRemove;
-    QMap<QtProperty *, QList<QtBrowserItem *> >::ConstIterator it =
+    QHash<QtProperty *, QList<QtBrowserItem *> >::ConstIterator it =
         m_propertyToIndexes.find(property);
     if (it == m_propertyToIndexes.constEnd())
         return;
@@ -1551,7 +1552,7 @@ void QtAbstractPropertyBrowserPrivate::slotPropertyDataChanged(QtProperty *prope
     if (!m_propertyToParents.contains(property))
         return;
 
-    QMap<QtProperty *, QList<QtBrowserItem *> >::ConstIterator it =
+    QHash<QtProperty *, QList<QtBrowserItem *> >::ConstIterator it =
             m_propertyToIndexes.find(property);
     if (it == m_propertyToIndexes.constEnd())
         return;
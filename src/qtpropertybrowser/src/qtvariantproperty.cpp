@@ -43,6 +43,7 @@
 #include "qtpropertymanager.h"
 #include "qteditorfactory.h"
 #include <QVariant>
+#include <QHash>
 #include <QIcon>
 #include <QDate>
 #include <QLocale>
@@ -136,7 +137,7 @@ int QtVariantPropertyManager::iconMapTypeId()
     return qMetaTypeId<QtIconMap>();
 }
 
-typedef QMap<const QtProperty *, QtProperty *> PropertyMap;
+typedef QHash<const QtProperty *, QtProperty *> PropertyMap;
 Q_GLOBAL_STATIC(PropertyMap, propertyToWrappedProperty)
 
 static QtProperty *wrappedProperty(QtProperty *property)
@@ -357,12 +358,12 @@ public:
     QMap<int, QtAbstractPropertyManager *> m_typeToPropertyManager;
     QMap<int, QMap<QString, int> > m_typeToAttributeToAttributeType;
 
-    QMap<const QtProperty *, QPair<QtVariantProperty *, int> > m_propertyToType;
+    QHash<const QtProperty *, QPair<QtVariantProperty *, int> > m_propertyToType;
 
     QMap<int, int> m_typeToValueType;
 
 
-    QMap<QtProperty *, QtVariantProperty *> m_internalToProperty;
+    QHash<QtProperty *, QtVariantProperty *> m_internalToProperty;
 
     const QString m_constraintAttribute;
     const QString m_singleStepAttribute;
@@ -1274,7 +1275,7 @@ QtVariantPropertyManager::~QtVariantPropertyManager()
 */
 QtVariantProperty *QtVariantPropertyManager::variantProperty(const QtProperty *property) const
 {
-    const QMap<const QtProperty *, QPair<QtVariantProperty *, int> >::const_iterator it = d_ptr->m_propertyToType.constFind(property);
+    const QHash<const QtProperty *, QPair<QtVariantProperty *, int> >::const_iterator it = d_ptr->m_propertyToType.constFind(property);
     if (it == d_ptr->m_propertyToType.constEnd())
         return 0;
     return it.value().first;
@@ -1420,7 +1421,7 @@ int QtVariantPropertyManager::valueType(int propertyType) const
 */
 int QtVariantPropertyManager::propertyType(const QtProperty *property) const
 {
-    const QMap<const QtProperty *, QPair<QtVariantProperty *, int> >::const_iterator it = d_ptr->m_propertyToType.constFind(property);
+    const QHash<const QtProperty *, QPair<QtVariantProperty *, int> >::const_iterator it = d_ptr->m_propertyToType.constFind(property);
     if (it == d_ptr->m_propertyToType.constEnd())
         return 0;
     return it.value().second;
@@ -1851,22 +1852,22 @@ void QtVariantPropertyManager::initializeProperty(QtProperty *property)
 */
 void QtVariantPropertyManager::uninitializeProperty(QtProperty *property)
 {
-    const QMap<const QtProperty *, QPair<QtVariantProperty *, int> >::iterator type_it = d_ptr->m_propertyToType.find(property);
-    if (type_it == d_ptr->m_propertyToType.end())
+    if (!d_ptr->m_propertyToType.contains(property))
         return;
 
-    PropertyMap::iterator it = propertyToWrappedProperty()->find(property);
-    if (it != propertyToWrappedProperty()->end()) {
-        QtProperty *internProp = it.value();
+    // No iterators are kept, since deleting the internal property may
+    // remove other entries from these hashes.
+    if (propertyToWrappedProperty()->contains(property)) {
+        QtProperty *internProp = propertyToWrappedProperty()->value(property);
         if (internProp) {
             d_ptr->m_internalToProperty.remove(internProp);
             if (!d_ptr->m_destroyingSubProperties) {
                 delete internProp;
             }
         }
-        propertyToWrappedProperty()->erase(it);
+        propertyToWrappedProperty()->remove(property);
     }
-    d_ptr->m_propertyToType.erase(type_it);
+    d_ptr->m_propertyToType.remove(property);
 }
 
 /*!
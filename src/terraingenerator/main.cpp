@@ -19,6 +19,7 @@
  * this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "imagecache.h"
 #include "mapreader.h"
 #include "mapwriter.h"
 #include "wangset.h"
@@ -27,11 +28,15 @@
 
 #include <QGuiApplication>
 
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QPainter>
+#include <QSaveFile>
 #include <QStringList>
+#include <QtConcurrent>
 
 #include <algorithm>
 
@@ -49,6 +54,8 @@ struct CommandLineOptions {
     bool embedImage = false;
     int columns = 16;
     QString target;
+    QString cacheDirectory;
+    QString imageCacheDirectory;
     QStringList sources;
     QStringList terrainPriority;
     QList<QStringList> combineList;
@@ -75,6 +82,11 @@ static void showHelp()
             "  -o --output OUT  : Specify output tileset filename.\n"
             "  -p --priority T1[ T2 [Tn ...]]\n"
             "                   : Add terrain names to priority list (T1 < T2 < Tn).\n"
+            "     --cache DIR   : Directory in which generated tile images are cached\n"
+            "                     between runs.\n"
+            "     --image-cache DIR\n"
+            "                   : Directory in which decoded source images are cached\n"
+            "                     between runs.\n"
     ;
 }
 
@@ -164,6 +176,20 @@ static bool parseCommandLineArguments(CommandLineOptions &options)
             } else {
                 options.target = arg2;
             }
+        } else if (arg == QLatin1String("--cache")) {
+            i++;
+            if (i >= arguments.size()) {
+                qWarning() << "Missing argument to" << arg << "option";
+                return false;
+            }
+            options.cacheDirectory = arguments.at(i);
+        } else if (arg == QLatin1String("--image-cache")) {
+            i++;
+            if (i >= arguments.size()) {
+                qWarning() << "Missing argument to" << arg << "option";
+                return false;
+            }
+            options.imageCacheDirectory = arguments.at(i);
         } else if (arg == QLatin1String("--overwrite")) {
             options.overwrite = true;
         } else if (arg == QLatin1String("-e")
@@ -378,6 +404,60 @@ static bool isEmpty(const QImage &image)
     return true;
 }
 
+/**
+ * A tile image to be generated by drawing a number of layers on top of each
+ * other.
+ */
+struct GeneratedTile
+{
+    QVector<QImage> layers;
+    QString cacheFileName;
+    QImage image;
+};
+
+/**
+ * A tile to be added to the target tileset, either copied from a source
+ * tileset or generated.
+ */
+struct NewTile
+{
+    TileTerrainNames terrainNames;
+    Properties properties;
+    QPixmap image;
+    int generatedIndex = -1;
+};
+
+/**
+ * Draws the layers of the given \a tile, or loads the result from the cache
+ * when it was generated before from the same images.
+ *
+ * This function is called from multiple threads.
+ */
+static void generateTile(GeneratedTile &tile, QSize tileSize)
+{
+    if (!tile.cacheFileName.isEmpty()) {
+        const QImage cached(tile.cacheFileName);
+        if (cached.size() == tileSize) {
+            tile.image = cached;
+            return;
+        }
+    }
+
+    tile.image = QImage(tileSize, QImage::Format_ARGB32);
+    tile.image.fill(Qt::transparent);
+
+    QPainter painter(&tile.image);
+    for (const QImage &layer : std::as_const(tile.layers))
+        painter.drawImage(0, 0, layer);
+    painter.end();
+
+    if (!tile.cacheFileName.isEmpty()) {
+        QSaveFile file(tile.cacheFileName);
+        if (file.open(QIODevice::WriteOnly) && tile.image.save(&file, "PNG"))
+            file.commit();
+    }
+}
+
 
 int main(int argc, char *argv[])
 {
@@ -401,6 +481,9 @@ int main(int argc, char *argv[])
     if (options.showVersion || options.showHelp)
         return 0;
 
+    if (!options.imageCacheDirectory.isEmpty())
+        ImageCache::setDiskCacheDirectory(options.imageCacheDirectory);
+
     if (options.target.isEmpty()) {
         qWarning() << "Error: No target tileset provided";
         showHelp();
@@ -600,61 +683,124 @@ int main(int argc, char *argv[])
         }
     }
 
-    // Go through each combination of terrains and add the tile to the target
-    // terrain set if it's not in there yet.
+    if (!options.cacheDirectory.isEmpty() && !QDir().mkpath(options.cacheDirectory)) {
+        qWarning() << "Failed to create cache directory" << options.cacheDirectory;
+        options.cacheDirectory.clear();
+    }
+
+    // The tile images are converted once, so they can be drawn on other
+    // threads. For the cache, a hash of the image data is also computed.
+    QHash<const Tile*, QImage> tileImages;
+    QHash<const Tile*, QByteArray> tileImageHashes;
+
+    auto tileImage = [&] (const Tile *tile) -> const QImage & {
+        auto it = tileImages.find(tile);
+        if (it == tileImages.end()) {
+            QImage image = tile->image().toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+            if (!options.cacheDirectory.isEmpty()) {
+                QCryptographicHash hash(QCryptographicHash::Sha1);
+                hash.addData(reinterpret_cast<const char*>(image.constBits()), image.sizeInBytes());
+                tileImageHashes.insert(tile, hash.result());
+            }
+            it = tileImages.insert(tile, image);
+        }
+        return *it;
+    };
+
+    // Go through each combination of terrains and determine the tiles to add
+    // to the target terrain set, for those not in there yet.
+    QVector<NewTile> newTiles;
+    QVector<GeneratedTile> generatedTiles;
+    QMap<TileTerrainNames, int> plannedTiles;
+
     for (const TileTerrainNames &terrainNames : process) {
         Tile *tile = terrainToTile.value(terrainNames);
 
         if (tile && tile->tileset() == targetTileset)
             continue;
+        if (plannedTiles.contains(terrainNames))
+            continue;
 
-        QPixmap image;
-        Properties properties;
+        NewTile newTile;
+        newTile.terrainNames = terrainNames;
 
         if (!tile) {
             qInfo() << "Generating" << terrainNames;
 
-            // Start a new image
-            QImage tileImage = QImage(targetTileset->tileWidth(),
-                                      targetTileset->tileHeight(),
-                                      QImage::Format_ARGB32);
-            tileImage.fill(Qt::transparent);
-            QPainter painter(&tileImage);
+            GeneratedTile generated;
+            QCryptographicHash cacheKey(QCryptographicHash::Sha1);
+
+            auto addLayer = [&] (const Tile *layerTile) {
+                generated.layers.append(tileImage(layerTile));
+                cacheKey.addData(tileImageHashes.value(layerTile));
+            };
+
+            // Tiles generated earlier in this run are only looked up for
+            // single-terrain combinations, which are empty when generated, so
+            // they can be skipped here.
+            auto isPlanned = [&] (const TileTerrainNames &names) {
+                return plannedTiles.contains(names);
+            };
 
             QStringList terrainList = terrainNames.terrainList();
             std::sort(terrainList.begin(), terrainList.end(), lessThan);
 
             // Draw the lowest terrain to avoid pixel gaps
             const TileTerrainNames baseTerrain(terrainList.first());
-            Tile *baseTile = terrainToTile.value(baseTerrain);
-            if (baseTile)
-                painter.drawPixmap(0, 0, baseTile->image());
+            if (Tile *baseTile = terrainToTile.value(baseTerrain))
+                addLayer(baseTile);
 
             for (const QString &terrainName : std::as_const(terrainList)) {
                 TileTerrainNames filtered = terrainNames.filter(terrainName);
                 Tile *tile = terrainToTile.value(filtered);
                 if (!tile) {
-                    qWarning() << "Missing" << filtered;
+                    if (!isPlanned(filtered))
+                        qWarning() << "Missing" << filtered;
                     continue;
                 }
 
-                painter.drawPixmap(0, 0, tile->image());
-                mergeProperties(properties, tile->properties());
+                addLayer(tile);
+                mergeProperties(newTile.properties, tile->properties());
             }
 
-            image = QPixmap::fromImage(tileImage);
+            if (!options.cacheDirectory.isEmpty()) {
+                cacheKey.addData(QByteArray::number(targetTileset->tileWidth()));
+                cacheKey.addData(QByteArray::number(targetTileset->tileHeight()));
+
+                const QString fileName = QString::fromLatin1(cacheKey.result().toHex()) + QStringLiteral(".png");
+                generated.cacheFileName = QDir(options.cacheDirectory).filePath(fileName);
+            }
+
+            newTile.generatedIndex = generatedTiles.size();
+            generatedTiles.append(std::move(generated));
         } else {
             qInfo() << "Copying" << terrainNames << "from"
                     << QFileInfo(tile->tileset()->fileName()).fileName();
 
-            image = tile->image();
-            properties = tile->properties();
+            newTile.image = tile->image();
+            newTile.properties = tile->properties();
         }
 
-        Tile *newTile = targetTileset->addTile(image);
-        builder.setWangId(newTile, builder.toWangId(terrainNames));
-        newTile->setProperties(properties);
-        terrainToTile.insert(terrainNames, newTile);
+        plannedTiles.insert(terrainNames, newTiles.size());
+        newTiles.append(std::move(newTile));
+    }
+
+    // Draw the generated tiles in parallel
+    const QSize tileSize(targetTileset->tileWidth(), targetTileset->tileHeight());
+    QtConcurrent::blockingMap(generatedTiles, [tileSize] (GeneratedTile &tile) {
+        generateTile(tile, tileSize);
+    });
+
+    // Add the new tiles to the target tileset, in order
+    for (const NewTile &newTile : std::as_const(newTiles)) {
+        const QPixmap image = newTile.generatedIndex != -1
+                ? QPixmap::fromImage(generatedTiles.at(newTile.generatedIndex).image)
+                : newTile.image;
+
+        Tile *tile = targetTileset->addTile(image);
+        builder.setWangId(tile, builder.toWangId(newTile.terrainNames));
+        tile->setProperties(newTile.properties);
+        terrainToTile.insert(newTile.terrainNames, tile);
     }
 
     if (targetTileset->tileCount() == 0)
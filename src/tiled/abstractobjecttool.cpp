@@ -377,24 +377,24 @@ void AbstractObjectTool::applyCollisionsToSelectedTiles(bool replace)
 
 void AbstractObjectTool::resetTileSize()
 {
-    QList<QUndoCommand*> commands;
+    QList<MapObject*> mapObjects;
+    QVector<QVariant> sizes;
 
     for (auto mapObject : mapDocument()->selectedObjects()) {
         if (!isResizedTileObject(mapObject))
             continue;
 
-        commands << new ChangeMapObject(mapDocument(),
-                                        mapObject,
-                                        MapObject::SizeProperty,
-                                        mapObject->cell().tile()->size());
+        mapObjects.append(mapObject);
+        sizes.append(mapObject->cell().tile()->size());
     }
 
-    if (!commands.isEmpty()) {
-        QUndoStack *undoStack = mapDocument()->undoStack();
-        undoStack->beginMacro(tr("Reset Tile Size"));
-        for (auto command : std::as_const(commands))
-            undoStack->push(command);
-        undoStack->endMacro();
+    if (!mapObjects.isEmpty()) {
+        auto command = new ChangeMapObject(mapDocument(),
+                                           mapObjects,
+                                           MapObject::SizeProperty,
+                                           sizes);
+        command->setText(tr("Reset Tile Size"));
+        mapDocument()->undoStack()->push(command);
     }
 }
 
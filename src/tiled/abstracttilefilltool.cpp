@@ -189,13 +189,25 @@ QList<Layer *> AbstractTileFillTool::targetLayers() const
     return AbstractTileTool::targetLayers();
 }
 
-void AbstractTileFillTool::updatePreview(const QRegion &fillRegion)
+/**
+ * Updates the preview to fill the given \a fillRegion.
+ *
+ * When \a keepRandomCells is true and the previous preview was a random
+ * fill, the random cells that were already picked are kept where the
+ * regions overlap. This avoids rebuilding the whole preview when a shape
+ * is resized and keeps the preview from flickering.
+ */
+void AbstractTileFillTool::updatePreview(const QRegion &fillRegion, bool keepRandomCells)
 {
     if (!mRandomAndMissingCacheValid) {
         updateRandomListAndMissingTilesets();
         mRandomAndMissingCacheValid = true;
+        keepRandomCells = false;
     }
 
+    const SharedMap previousPreview = mPreviewMap;
+    const QRegion previousRandomFillRegion = std::exchange(mRandomFillRegion, QRegion());
+
     mFillBounds = fillRegion.boundingRect();
     auto preview = SharedMap::create(mapDocument()->map()->parameters());
 
@@ -209,8 +221,20 @@ void AbstractTileFillTool::updatePreview(const QRegion &fillRegion)
         std::unique_ptr<TileLayer> previewLayer {
             new TileLayer(QString(), mFillBounds.topLeft(), mFillBounds.size())
         };
-        randomFill(*previewLayer, fillRegion);
+
+        QRegion keptRegion;
+        if (keepRandomCells && previousPreview && !previousRandomFillRegion.isEmpty()) {
+            const auto previousLayer = static_cast<const TileLayer*>(previousPreview->layerAt(0));
+            keptRegion = fillRegion & previousRandomFillRegion;
+            previewLayer->setCells(previousLayer->x() - previewLayer->x(),
+                                   previousLayer->y() - previewLayer->y(),
+                                   previousLayer,
+                                   keptRegion.translated(-previewLayer->position()));
+        }
+
+        randomFill(*previewLayer, fillRegion - keptRegion);
         preview->addLayer(previewLayer.release());
+        mRandomFillRegion = fillRegion;
         break;
     }
     case WangFill: {
@@ -230,7 +254,13 @@ void AbstractTileFillTool::updatePreview(const QRegion &fillRegion)
 
     preview->addTilesets(preview->usedTilesets());
 
-    brushItem()->setMap(preview);
+    // A random fill covers the whole region, so there is no need to
+    // compute the region from the preview
+    if (mFillMethod == RandomFill && !mRandomCellPicker.isEmpty())
+        brushItem()->setMap(preview, fillRegion);
+    else
+        brushItem()->setMap(preview);
+
     mPreviewMap = preview;
 }
 
@@ -240,6 +270,7 @@ void AbstractTileFillTool::clearOverlay()
     static_cast<WangBrushItem*>(brushItem())->setInvalidTiles(QRegion());
 
     mPreviewMap.clear();
+    mRandomFillRegion = QRegion();
 }
 
 void AbstractTileFillTool::updateRandomListAndMissingTilesets()
@@ -277,13 +308,16 @@ void AbstractTileFillTool::randomFill(TileLayer &tileLayer, const QRegion &regio
         return;
 
     const auto localRegion = region.translated(-tileLayer.position());
+    QVector<Cell> row;
 
     for (const QRect &rect : localRegion) {
+        row.resize(rect.width());
+
         for (int y = rect.top(); y <= rect.bottom(); ++y) {
-            for (int x = rect.left(); x <= rect.right(); ++x) {
-                tileLayer.setCell(x, y,
-                                  mRandomCellPicker.pick());
-            }
+            for (Cell &cell : row)
+                cell = mRandomCellPicker.pick();
+
+            tileLayer.setRow(rect.left(), y, rect.width(), row.constData());
         }
     }
 }
@@ -310,7 +344,7 @@ void AbstractTileFillTool::fillWithStamp(Map &map,
         return;
 
     const QRect bounds = mask.boundingRect();
-    const auto randomVariations = stamp.randomVariations();
+    const auto &randomVariations = stamp.randomVariations();
 
     QHash<QString, QList<TileLayer*>> targetLayersByName;
 
@@ -92,7 +92,7 @@ protected:
 
     virtual void clearConnections(MapDocument *mapDocument) = 0;
 
-    void updatePreview(const QRegion &fillRegion);
+    void updatePreview(const QRegion &fillRegion, bool keepRandomCells = false);
 
     void clearOverlay();
 
@@ -120,7 +120,10 @@ private:
                        const QRegion &mask);
 
     WangSet *mWangSet;
-    RandomPicker<Cell> mRandomCellPicker;
+    AliasPicker<Cell> mRandomCellPicker;
+
+    // The region filled by the current random fill preview, if any
+    QRegion mRandomFillRegion;
 
     CaptureStampHelper mCaptureStampHelper;
 
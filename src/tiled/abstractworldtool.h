@@ -21,6 +21,9 @@
 #pragma once
 
 #include "abstracttool.h"
+#include "mapdocument.h"
+
+#include <QPointer>
 
 class QAction;
 class QMenu;
@@ -94,7 +97,8 @@ private:
 
     void populateAddToWorldMenu(QMenu &menu);
 
-    MapDocument *mTargetMap = nullptr;
+    // Maps of a world may get unloaded while hovered (see MapScene)
+    QPointer<MapDocument> mTargetMap;
 
     QAction *mAddAnotherMapToWorldAction;
     QAction *mAddMapToWorldAction;
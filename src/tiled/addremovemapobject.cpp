@@ -110,11 +110,28 @@ void AddMapObjects::undo()
 
     emit mDocument->changed(mapObjectsEvent);
 
-    for (int i = mEntries.size() - 1; i >= 0; --i) {
-        Entry &entry = mEntries[i];
-        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAboutToBeRemoved, entry.objectGroup, entry.index));
-        entry.objectGroup->removeObjectAt(entry.index);
-        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectRemoved, entry.objectGroup, entry.index));
+    for (int i = mEntries.size() - 1; i >= 0;) {
+        const Entry &last = mEntries.at(i);
+        ObjectGroup *objectGroup = last.objectGroup;
+
+        // Objects that were inserted at consecutive indexes are removed as
+        // a single block
+        int count = 1;
+        while (count <= i) {
+            const Entry &previous = mEntries.at(i - count);
+            if (previous.objectGroup != objectGroup || previous.index != last.index - count)
+                break;
+            ++count;
+        }
+
+        const int index = last.index - count + 1;
+
+        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAboutToBeRemoved, objectGroup, index, count));
+        for (int j = count - 1; j >= 0; --j)
+            objectGroup->removeObjectAt(index + j);
+        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectRemoved, objectGroup, index, count));
+
+        i -= count;
     }
 
     mapObjectsEvent.type = ChangeEvent::MapObjectsRemoved;
@@ -129,13 +146,34 @@ void AddMapObjects::redo()
 {
     QUndoCommand::redo(); // redo child commands
 
-    for (Entry &entry : mEntries) {
-        if (entry.index == -1)
-            entry.index = entry.objectGroup->objectCount();
-
-        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAboutToBeAdded, entry.objectGroup, entry.index));
-        entry.objectGroup->insertObject(entry.index, entry.mapObject);
-        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAdded, entry.objectGroup, entry.index));
+    for (int i = 0; i < mEntries.size();) {
+        const Entry &first = mEntries.at(i);
+        ObjectGroup *objectGroup = first.objectGroup;
+        const int index = first.index == -1 ? objectGroup->objectCount()
+                                            : first.index;
+        const bool appending = index == objectGroup->objectCount();
+
+        // Objects ending up at consecutive indexes, like those appended to
+        // the same object group, are inserted as a single block
+        int count = 1;
+        while (i + count < mEntries.size()) {
+            const Entry &next = mEntries.at(i + count);
+            if (next.objectGroup != objectGroup)
+                break;
+            if (next.index != index + count && !(appending && next.index == -1))
+                break;
+            ++count;
+        }
+
+        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAboutToBeAdded, objectGroup, index, count));
+        for (int j = 0; j < count; ++j) {
+            Entry &entry = mEntries[i + j];
+            entry.index = index + j;
+            objectGroup->insertObject(entry.index, entry.mapObject);
+        }
+        emit mDocument->changed(MapObjectEvent(ChangeEvent::MapObjectAdded, objectGroup, index, count));
+
+        i += count;
     }
 
     emit mDocument->changed(MapObjectsEvent(ChangeEvent::MapObjectsAdded, objects(mEntries)));
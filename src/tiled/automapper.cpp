@@ -33,7 +33,9 @@
 #include "tile.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QRandomGenerator>
+#include <QVarLengthArray>
 #include <QtConcurrent>
 
 #include <algorithm>
@@ -46,28 +48,27 @@ static int wrap(int value, int bound)
     return (value % bound + bound) % bound;
 }
 
-static const Cell &getWrappedCell(int x, int y, const TileLayer &tileLayer)
+static Cell getWrappedCell(int x, int y, const TileLayer &tileLayer)
 {
     return tileLayer.cellAt(wrap(x, tileLayer.width()),
                             wrap(y, tileLayer.height()));
 }
 
-static const Cell &getBoundCell(int x, int y, const TileLayer &tileLayer)
+static Cell getBoundCell(int x, int y, const TileLayer &tileLayer)
 {
     return tileLayer.cellAt(qBound(0, x, tileLayer.width() - 1),
                             qBound(0, y, tileLayer.height() - 1));
 }
 
-static const Cell &getCell(int x, int y, const TileLayer &tileLayer)
+static Cell getCell(int x, int y, const TileLayer &tileLayer)
 {
     return tileLayer.cellAt(x, y);
 }
 
 static double randomDouble()
 {
-    thread_local std::mt19937 engine(std::random_device{}());
     std::uniform_real_distribution<double> dist(0, 1);
-    return dist(engine);
+    return dist(globalRandomEngine());
 }
 
 template<typename Type, typename Container, typename Pred, typename... Args>
@@ -133,8 +134,32 @@ struct ApplyContext
     QHash<const Layer*, QRegion> appliedRegions;
 
     QRegion *appliedRegion;
+
+    struct TileCopy
+    {
+        const RuleOutputCells *outputCells;
+        TileLayer *layer;
+        QPoint offset;
+    };
+
+    // When rules don't need to see each other's output, the tile copies can
+    // be collected and done at the end.
+    bool deferTileCopies = false;
+    QVector<TileCopy> tileCopies;
 };
 
+/**
+ * The height of the bands in which deferred tile copies are split up, for
+ * doing them in parallel.
+ */
+static constexpr int TileCopyBandHeight = 64;
+
+/**
+ * The maximum area for doing deferred tile copies in parallel, since this
+ * needs a buffer of cells covering the area.
+ */
+static constexpr qint64 MaximumTileCopyArea = 16 * 1024 * 1024;
+
 
 AutoMappingContext::AutoMappingContext(MapDocument *mapDocument)
     : targetDocument(mapDocument)
@@ -755,17 +780,19 @@ static void collectCellsInRegion(const QVector<InputLayer> &list,
                                  QVector<MatchCell> &cells)
 {
     for (const InputLayer &inputLayer : list) {
-        forEachPointInRegion(r, [&] (int x, int y) {
-            const Cell &cell = inputLayer.tileLayer->cellAt(x, y);
-            switch (matchType(cell.tile())) {
-            case MatchType::Tile:
-                appendUnique(cells, { cell, inputLayer.flagsMask });
-                break;
-            case MatchType::Empty:
-                appendUnique(cells, MatchCell());
-                break;
-            default:
-                break;
+        inputLayer.tileLayer->forEachSpan(r, [&] (int, int, const Cell *spanCells, int count) {
+            for (int i = 0; i < count; ++i) {
+                const Cell &cell = spanCells[i];
+                switch (matchType(cell.tile())) {
+                case MatchType::Tile:
+                    appendUnique(cells, { cell, inputLayer.flagsMask });
+                    break;
+                case MatchType::Empty:
+                    appendUnique(cells, MatchCell());
+                    break;
+                default:
+                    break;
+                }
             }
         });
     }
@@ -783,6 +810,54 @@ static bool isEmptyRegion(const TileLayer &tileLayer,
     return true;
 }
 
+/**
+ * Returns the compiled input sets of all rules, in the order of mRules. The
+ * input sets of rules that can't match are empty.
+ *
+ * The compiled rules are kept between calls, since compiling all rules can
+ * take a while and AutoMapping while drawing runs often. They only depend on
+ * the target map through the tilesets, which get unified with those of the
+ * target map, and through its missing input layers. The input layer
+ * references are updated on each call.
+ */
+const std::vector<QVector<RuleInputSet>> &AutoMapper::compileRules(const AutoMappingContext &context) const
+{
+    QSet<QString> missingInputLayers;
+    for (const QString &name : std::as_const(mRuleMapSetup.mInputLayerNames))
+        if (!context.inputLayers.contains(name))
+            missingInputLayers.insert(name);
+
+    auto &compiled = mCompiledRules;
+
+    if (!compiled.valid ||
+            compiled.tilesets != mRulesMap->tilesets() ||
+            compiled.missingInputLayers != missingInputLayers) {
+        compiled.valid = true;
+        compiled.tilesets = mRulesMap->tilesets();
+        compiled.missingInputLayers = std::move(missingInputLayers);
+        compiled.inputSets.clear();
+        compiled.inputSets.resize(mRules.size());
+        compiled.outputCells.clear();
+
+        for (size_t i = 0; i < mRules.size(); ++i) {
+            const Rule &rule = mRules[i];
+            if (!rule.outputSet && rule.outputSets.isEmpty())
+                continue;
+            if (!compileRule(compiled.inputSets[i], rule, context))
+                compiled.inputSets[i].clear();
+        }
+
+        return compiled.inputSets;
+    }
+
+    for (auto &inputSets : compiled.inputSets)
+        for (RuleInputSet &inputSet : inputSets)
+            for (RuleInputLayer &layer : inputSet.layers)
+                layer.targetLayer = context.inputLayers.value(layer.name, &dummy);
+
+    return compiled.inputSets;
+}
+
 /**
  * Sets up a small data structure for this rule that is optimized for matching.
  */
@@ -875,6 +950,7 @@ bool AutoMapper::compileInputSet(RuleInputSet &index,
 
         RuleInputLayer layer;
         layer.targetLayer = context.inputLayers.value(conditions.layerName, &dummy);
+        layer.name = conditions.layerName;
 
         forEachPointInRegion(inputRegion, [&] (int x, int y) {
             anyOf.clear();
@@ -992,6 +1068,12 @@ bool AutoMapper::compileInputSet(RuleInputSet &index,
                 pos.y = y - topLeft.y();
                 pos.anyCount = anyOf.size();
                 pos.noneCount = noneOf.size();
+                pos.match = PositionMatch::Cells;
+
+                if (anyOf.size() == 1)
+                    pos.match = anyOf.first().isEmpty() ? PositionMatch::Empty : PositionMatch::Tile;
+                else if (anyOf.isEmpty() && noneOf.size() == 1 && noneOf.first().isEmpty())
+                    pos.match = PositionMatch::NonEmpty;
 
                 index.positions.append(pos);
                 ++layer.posCount;
@@ -1079,15 +1161,18 @@ void AutoMapper::autoMap(const QRegion &where,
 
         const QRegion regionToErase = inputLayersRegion.intersected(applyRegion);
 
-        for (const QString &name : mRuleMapSetup.mOutputTileLayerNames)
+        for (const QString &name : mRuleMapSetup.mOutputTileLayerNames) {
             context.outputTileLayers.value(name)->erase(regionToErase);
 
+            if (!context.changedRegions.isEmpty())
+                context.changedRegions[name] |= regionToErase;
+        }
+
         for (const QString &name : mRuleMapSetup.mOutputObjectGroupNames) {
-            const auto objects = objectsInRegion(*context.targetDocument->renderer(),
-                                                 context.outputObjectGroups.value(name),
-                                                 regionToErase);
-            for (MapObject *mapObject : objects)
-                context.mapObjectsToRemove.insert(mapObject);
+            collectObjectsInRegion(*context.targetDocument->renderer(),
+                                   context.outputObjectGroups.value(name),
+                                   regionToErase,
+                                   context.mapObjectsToRemove);
         }
     }
 
@@ -1102,42 +1187,40 @@ void AutoMapper::autoMap(const QRegion &where,
     }
 
     ApplyContext applyContext { appliedRegion };
+    auto &statistics = context.statistics;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const auto &inputSets = compileRules(context);
+
+    statistics.compileTime += timer.nsecsElapsed();
+    timer.restart();
 
     if (mOptions.matchInOrder) {
-        for (const Rule &rule : mRules) {
+        for (size_t i = 0; i < mRules.size(); ++i) {
+            const Rule &rule = mRules[i];
             if (rule.options.disabled)
                 continue;
 
-            matchRule(rule, applyRegion, get, [&] (QPoint pos) {
+            matchRule(rule, inputSets[i], applyRegion, get, [&] (QPoint pos) {
                 applyRule(rule, pos, applyContext, context);
+                ++statistics.matchCount;
             }, context);
             applyContext.appliedRegions.clear();
         }
+
+        statistics.matchTime += timer.nsecsElapsed();
     } else {
-        auto collectMatches = [&] (const Rule &rule) {
-            QVector<QPoint> positions;
-            if (!rule.options.disabled)
-                matchRule(rule, applyRegion, get, [&] (QPoint pos) { positions.append(pos); }, context);
-            return positions;
-        };
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-        auto result = QtConcurrent::blockingMapped(mRules, collectMatches);
-#else
-        struct MatchRule
-        {
-            using result_type = QVector<QPoint>;
+        const auto result = matchRules(inputSets, applyRegion, get, context);
 
-            std::function<result_type(const Rule&)> collectMatches;
+        statistics.matchTime += timer.nsecsElapsed();
+        timer.restart();
 
-            result_type operator()(const Rule &rule)
-            {
-                return collectMatches(rule);
-            }
-        };
+        for (const auto &matches : result)
+            statistics.matchCount += matches.size();
 
-        const auto result = QtConcurrent::blockingMapped<QVector<QVector<QPoint>>>(mRules,
-                                                                                   MatchRule { collectMatches });
-#endif
+        applyContext.deferTileCopies = true;
 
         for (size_t i = 0; i < mRules.size(); ++i) {
             const Rule &rule = mRules[i];
@@ -1145,6 +1228,10 @@ void AutoMapper::autoMap(const QRegion &where,
                 applyRule(rule, pos, applyContext, context);
             applyContext.appliedRegions.clear();
         }
+
+        applyDeferredTileCopies(applyContext, context);
+
+        statistics.applyTime += timer.nsecsElapsed();
     }
 }
 
@@ -1169,6 +1256,26 @@ static bool matchInputIndex(const RuleInputSet &inputSet, QPoint offset, AutoMap
             const RuleInputLayerPos &pos = inputSet.positions[p];
             const Cell &cell = getCell(pos.x + offset.x(), pos.y + offset.y(), *layer.targetLayer);
 
+            switch (pos.match) {
+            case PositionMatch::Tile:
+                if (!cellMatches(inputSet.cells[nextCell], cell))
+                    return false;
+                nextCell += pos.anyCount + pos.noneCount;
+                continue;
+            case PositionMatch::Empty:
+                if (!cell.isEmpty())
+                    return false;
+                nextCell += pos.anyCount + pos.noneCount;
+                continue;
+            case PositionMatch::NonEmpty:
+                if (cell.isEmpty())
+                    return false;
+                nextCell += pos.anyCount + pos.noneCount;
+                continue;
+            case PositionMatch::Cells:
+                break;
+            }
+
             // Match may succeed if any of the "any" tiles are seen, or when
             // there are no "any" tiles for this location.
             bool anyMatch = !pos.anyCount;
@@ -1203,19 +1310,155 @@ static bool matchRuleAtOffset(const QVector<RuleInputSet> &inputSets, QPoint off
                        [=] (const RuleInputSet &index) { return matchInputIndex(index, offset, getCell); });
 }
 
+namespace {
+
+using CellKey = QPair<const Tileset*, int>;
+
+CellKey cellKey(const Cell &cell)
+{
+    if (cell.isEmpty())
+        return CellKey(nullptr, -1);
+    return CellKey(cell.tileset(), cell.tileId());
+}
+
+/**
+ * Refers to one of the input sets of a rule.
+ */
+struct RuleCandidate
+{
+    int rule;
+    int inputSet;
+};
+
+/**
+ * A position in an input set at which only a few specific cells are
+ * accepted. Every match of the input set has one of these cells there.
+ */
+struct RuleAnchor
+{
+    const TileLayer *layer = nullptr;
+    QPoint pos;
+    int firstCell = 0;
+    int cellCount = 0;
+};
+
+/**
+ * The input sets anchored at the same position of the same layer, by the
+ * cells they accept at that position.
+ */
+struct AnchorGroup
+{
+    const TileLayer *layer;
+    QPoint pos;
+    QHash<CellKey, QVector<RuleCandidate>> candidates;
+};
+
+struct RuleMatch
+{
+    int rule;
+    int rectIndex;
+    QPoint pos;
+};
+
+} // anonymous namespace
+
+/**
+ * Finds the most selective anchor of the given \a inputSet, which is the
+ * position accepting the least amount of different cells. Returns an anchor
+ * without layer when all positions accept any cells except some.
+ */
+static RuleAnchor findAnchor(const RuleInputSet &inputSet)
+{
+    RuleAnchor anchor;
+    qsizetype nextPos = 0;
+    qsizetype nextCell = 0;
+
+    for (const RuleInputLayer &layer : inputSet.layers) {
+        for (auto p = std::exchange(nextPos, nextPos + layer.posCount); p < nextPos; ++p) {
+            const RuleInputLayerPos &pos = inputSet.positions[p];
+            const int firstCell = static_cast<int>(nextCell);
+            nextCell += pos.anyCount + pos.noneCount;
+
+            // The "none" tiles are only used when there are no "any" tiles
+            // (see optimizeAnyNoneOf)
+            if (pos.anyCount == 0)
+                continue;
+
+            if (!anchor.layer || pos.anyCount < anchor.cellCount) {
+                anchor.layer = layer.targetLayer;
+                anchor.pos = QPoint(pos.x, pos.y);
+                anchor.firstCell = firstCell;
+                anchor.cellCount = pos.anyCount;
+            }
+        }
+    }
+
+    return anchor;
+}
+
+/**
+ * Returns the index of the rectangle in \a region at which the rule with
+ * the given \a options would be matched at \a pos by AutoMapper::matchRule,
+ * or -1 when it would not be matched there.
+ */
+static int matchRectIndex(const QRegion &region, QPoint pos, const RuleOptions &options)
+{
+    int index = 0;
+
+    for (const QRect &rect : region) {
+        if (rect.contains(pos)) {
+            const int startX = rect.left() + (rect.left() + options.offsetX) % options.modX;
+            const int startY = rect.top() + (rect.top() + options.offsetY) % options.modY;
+
+            if (pos.x() < startX || pos.y() < startY)
+                return -1;
+            if ((pos.x() - startX) % options.modX || (pos.y() - startY) % options.modY)
+                return -1;
+
+            return index;
+        }
+        ++index;
+    }
+
+    return -1;
+}
+
 void AutoMapper::matchRule(const Rule &rule,
+                           const QVector<RuleInputSet> &inputSets,
                            const QRegion &matchRegion,
                            GetCell getCell,
                            const std::function<void(QPoint pos)> &matched,
                            const AutoMappingContext &context) const
 {
-    if (!rule.outputSet && rule.outputSets.isEmpty())
+    if (inputSets.isEmpty())
         return;
 
-    QVector<RuleInputSet> inputSets;
-    if (!compileRule(inputSets, rule, context))
-        return;
+    const QRegion ruleMatchRegion = this->ruleMatchRegion(rule, matchRegion, context);
+
+    for (const QRect &rect : ruleMatchRegion) {
+        const int startX = rect.left() + (rect.left() + rule.options.offsetX) % rule.options.modX;
+        const int startY = rect.top() + (rect.top() + rule.options.offsetY) % rule.options.modY;
 
+        for (int y = startY; y <= rect.bottom(); y += rule.options.modY) {
+            for (int x = startX; x <= rect.right(); x += rule.options.modX) {
+                if (rule.options.skipChance != 0.0 && randomDouble() < rule.options.skipChance)
+                    continue;
+
+                if (matchRuleAtOffset(inputSets, QPoint(x, y), getCell))
+                    matched(QPoint(x, y));
+            }
+        }
+    }
+}
+
+/**
+ * Returns the region in which the top-left of the given \a rule needs to be
+ * matched to cover the given \a matchRegion.
+ */
+QRegion AutoMapper::ruleMatchRegion(const Rule &rule,
+                                    const QRegion &matchRegion,
+                                    const AutoMappingContext &context) const
+{
     const QRect inputBounds = rule.inputRegion.boundingRect();
 
     // This is really the rule size - 1, since when applying the rule we will
@@ -1239,20 +1482,141 @@ void AutoMapper::matchRule(const Rule &rule,
                                  context.targetMap->height() - ruleHeight);
     }
 
-    for (const QRect &rect : ruleMatchRegion) {
-        const int startX = rect.left() + (rect.left() + rule.options.offsetX) % rule.options.modX;
-        const int startY = rect.top() + (rect.top() + rule.options.offsetY) % rule.options.modY;
+    return ruleMatchRegion;
+}
 
-        for (int y = startY; y <= rect.bottom(); y += rule.options.modY) {
-            for (int x = startX; x <= rect.right(); x += rule.options.modX) {
-                if (rule.options.skipChance != 0.0 && randomDouble() < rule.options.skipChance)
-                    continue;
+std::vector<QVector<QPoint>> AutoMapper::matchRules(const std::vector<QVector<RuleInputSet>> &inputSets,
+                                                    const QRegion &matchRegion,
+                                                    GetCell getCell,
+                                                    const AutoMappingContext &context) const
+{
+    const int ruleCount = static_cast<int>(mRules.size());
 
-                if (matchRuleAtOffset(inputSets, QPoint(x, y), getCell))
-                    matched(QPoint(x, y));
+    std::vector<QRegion> ruleMatchRegions(mRules.size());
+    std::vector<AnchorGroup> anchorGroups;
+    QVector<RuleCandidate> unanchored;
+    QRegion candidateRegion;
+
+    // Sort the input sets of the rules by anchor
+    for (int i = 0; i < ruleCount; ++i) {
+        const Rule &rule = mRules[i];
+        if (rule.options.disabled || inputSets[i].isEmpty())
+            continue;
+
+        ruleMatchRegions[i] = ruleMatchRegion(rule, matchRegion, context);
+        if (ruleMatchRegions[i].isEmpty())
+            continue;
+
+        candidateRegion |= ruleMatchRegions[i];
+
+        for (int j = 0; j < inputSets[i].size(); ++j) {
+            const RuleInputSet &inputSet = inputSets[i].at(j);
+            const RuleCandidate candidate { i, j };
+
+            const auto anchor = findAnchor(inputSet);
+            if (!anchor.layer) {
+                unanchored.append(candidate);
+                continue;
+            }
+
+            auto &group = find_or_emplace<AnchorGroup>(anchorGroups, [&] (const AnchorGroup &group) {
+                return group.layer == anchor.layer && group.pos == anchor.pos;
+            }, AnchorGroup { anchor.layer, anchor.pos, {} });
+
+            for (int c = anchor.firstCell; c < anchor.firstCell + anchor.cellCount; ++c) {
+                auto &candidates = group.candidates[cellKey(inputSet.cells.at(c))];
+                if (candidates.isEmpty() || candidates.last().rule != i || candidates.last().inputSet != j)
+                    candidates.append(candidate);
             }
         }
     }
+
+    // Iterate the candidate region in bands of rows, which are matched in
+    // parallel
+    struct Band
+    {
+        QRect rect;
+        QVector<RuleMatch> matches;
+    };
+
+    QVector<Band> bands;
+    for (const QRect &rect : candidateRegion) {
+        for (int y = rect.top(); y <= rect.bottom(); y += 16) {
+            Band band;
+            band.rect = QRect(rect.left(), y, rect.width(), std::min(16, rect.bottom() - y + 1));
+            bands.append(band);
+        }
+    }
+
+    auto matchCandidate = [&] (const RuleCandidate &candidate, QPoint pos, QVector<RuleMatch> &matches) {
+        const Rule &rule = mRules[candidate.rule];
+
+        // Avoid matching the same rule twice at the same location
+        for (auto it = matches.crbegin(); it != matches.crend() && it->pos == pos; ++it)
+            if (it->rule == candidate.rule)
+                return;
+
+        const int rectIndex = matchRectIndex(ruleMatchRegions[candidate.rule], pos, rule.options);
+        if (rectIndex == -1)
+            return;
+
+        if (matchInputIndex(inputSets[candidate.rule].at(candidate.inputSet), pos, getCell))
+            matches.append(RuleMatch { candidate.rule, rectIndex, pos });
+    };
+
+    QtConcurrent::blockingMap(bands, [&] (Band &band) {
+        const QRect &rect = band.rect;
+
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            for (int x = rect.left(); x <= rect.right(); ++x) {
+                const QPoint pos(x, y);
+
+                for (const AnchorGroup &group : anchorGroups) {
+                    const Cell cell = getCell(x + group.pos.x(), y + group.pos.y(), *group.layer);
+                    const auto it = group.candidates.constFind(cellKey(cell));
+                    if (it == group.candidates.constEnd())
+                        continue;
+
+                    for (const RuleCandidate &candidate : it.value())
+                        matchCandidate(candidate, pos, band.matches);
+                }
+
+                for (const RuleCandidate &candidate : std::as_const(unanchored))
+                    matchCandidate(candidate, pos, band.matches);
+            }
+        }
+    });
+
+    std::vector<QVector<RuleMatch>> ruleMatches(mRules.size());
+    for (const Band &band : std::as_const(bands))
+        for (const RuleMatch &match : band.matches)
+            ruleMatches[match.rule].append(match);
+
+    std::vector<QVector<QPoint>> result(mRules.size());
+
+    for (int i = 0; i < ruleCount; ++i) {
+        auto &matches = ruleMatches[i];
+
+        // Restore the order in which matchRule would find these matches
+        std::sort(matches.begin(), matches.end(), [] (const RuleMatch &a, const RuleMatch &b) {
+            if (a.rectIndex != b.rectIndex)
+                return a.rectIndex < b.rectIndex;
+            if (a.pos.y() != b.pos.y())
+                return a.pos.y() < b.pos.y();
+            return a.pos.x() < b.pos.x();
+        });
+
+        const qreal skipChance = mRules[i].options.skipChance;
+
+        for (const RuleMatch &match : std::as_const(matches)) {
+            if (skipChance != 0.0 && randomDouble() < skipChance)
+                continue;
+
+            result[i].append(match.pos);
+        }
+    }
+
+    return result;
 }
 
 void AutoMapper::applyRule(const Rule &rule, QPoint pos,
@@ -1303,10 +1667,10 @@ void AutoMapper::applyRule(const Rule &rule, QPoint pos,
     }
 
     if (rule.outputSet)
-        copyMapRegion(rule, pos, *rule.outputSet, context);
+        copyMapRegion(rule, pos, *rule.outputSet, applyContext, context);
 
     if (randomOutputSet)
-        copyMapRegion(rule, pos, *randomOutputSet, context);
+        copyMapRegion(rule, pos, *randomOutputSet, applyContext, context);
 
     if (applyContext.appliedRegion)
         *applyContext.appliedRegion |= rule.outputRegion.translated(pos.x(), pos.y());
@@ -1344,6 +1708,7 @@ void AutoMapper::collectLayerOutputRegions(const Rule &rule,
 
 void AutoMapper::copyMapRegion(const Rule &rule, QPoint offset,
                                const RuleOutputSet &outputSet,
+                               ApplyContext &applyContext,
                                AutoMappingContext &context) const
 {
     for (const auto &tileOutput : outputSet.tileOutputs) {
@@ -1352,21 +1717,26 @@ void AutoMapper::copyMapRegion(const Rule &rule, QPoint offset,
         if (!rule.options.ignoreLock && !toTileLayer->isUnlocked())
             continue;
 
-        if (!context.touchedTileLayers.isEmpty())
-            appendUnique<const TileLayer*>(context.touchedTileLayers, toTileLayer);
+        if (!context.changedRegions.isEmpty())
+            context.changedRegions[tileOutput.name] |= rule.outputRegion.translated(offset);
 
-        for (const QRect &rect : rule.outputRegion) {
-            copyTileRegion(tileOutput.tileLayer, rect, toTileLayer,
-                           rect.x() + offset.x(), rect.y() + offset.y(),
-                           context);
-        }
+        const RuleOutputCells &cells = outputCells(rule, tileOutput.tileLayer);
+
+        if (applyContext.deferTileCopies)
+            applyContext.tileCopies.append(ApplyContext::TileCopy { &cells, toTileLayer, offset });
+        else
+            copyTileCells(cells, toTileLayer, offset, context);
 
         applyLayerProperties(tileOutput.tileLayer, toTileLayer, context);
     }
 
     if (!outputSet.objectOutputs.isEmpty()) {
+        qsizetype objectCount = 0;
+        for (const auto &objectOutput : outputSet.objectOutputs)
+            objectCount += objectOutput.objects.size();
+
         QVector<AddMapObjects::Entry> newMapObjects;
-        newMapObjects.reserve(outputSet.objectOutputs.size());
+        newMapObjects.reserve(objectCount);
 
         const MapRenderer *renderer = context.targetDocument->renderer();
         const QRect outputRect = rule.outputRegion.boundingRect();
@@ -1386,10 +1756,11 @@ void AutoMapper::copyMapRegion(const Rule &rule, QPoint offset,
                 newMapObjects.append(AddMapObjects::Entry { clone, toObjectGroup });
             }
 
-            context.newMapObjects.append(newMapObjects);
-
             applyLayerProperties(objectOutput.objectGroup, toObjectGroup, context);
         }
+
+        if (!newMapObjects.isEmpty())
+            context.newMapObjects.append(newMapObjects);
     }
 }
 
@@ -1414,53 +1785,216 @@ void AutoMapper::applyLayerProperties(const Layer *from, Layer *to, AutoMappingC
     }
 }
 
-void AutoMapper::copyTileRegion(const TileLayer *srcLayer, QRect rect,
-                                TileLayer *dstLayer, int dstX, int dstY,
-                                const AutoMappingContext &context) const
+const RuleOutputCells &AutoMapper::outputCells(const Rule &rule, const TileLayer *srcLayer) const
 {
-    int startX = dstX;
-    int startY = dstY;
+    const int ruleIndex = static_cast<int>(&rule - mRules.data());
+    const auto [it, inserted] = mCompiledRules.outputCells.try_emplace(std::make_pair(srcLayer, ruleIndex));
+    RuleOutputCells &outputCells = it->second;
+    if (!inserted)
+        return outputCells;
+
+    for (const QRect &rect : rule.outputRegion) {
+        srcLayer->forEachSpan(rect, [&] (int x, int y, const Cell *cells, int count) {
+            for (int i = 0; i < count; ++i) {
+                const Cell &cell = cells[i];
+
+                switch (matchType(cell.tile())) {
+                case MatchType::Tile:
+                    outputCells.cells.append(RuleOutputCell { QPoint(x + i, y), cell });
+                    break;
+                case MatchType::Empty:
+                    outputCells.cells.append(RuleOutputCell { QPoint(x + i, y), Cell() });
+                    break;
+                default:
+                    break;
+                }
+            }
+        });
+    }
 
-    int endX = dstX + rect.width();
-    int endY = dstY + rect.height();
+    const auto &cells = std::as_const(outputCells.cells);
+    for (int i = 0; i < cells.size(); ++i) {
+        const QPoint pos = cells.at(i).pos;
+        outputCells.bounds |= QRect(pos, QSize(1, 1));
 
+        if (i > 0 && pos == cells.at(i - 1).pos + QPoint(1, 0))
+            ++outputCells.runs.last().count;
+        else
+            outputCells.runs.append(RuleOutputRun { i, 1 });
+    }
+
+    return outputCells;
+}
+
+void AutoMapper::copyTileCells(const RuleOutputCells &outputCells, TileLayer *dstLayer,
+                               QPoint offset, const AutoMappingContext &context) const
+{
     const int dwidth = dstLayer->width();
     const int dheight = dstLayer->height();
 
     const bool fixedSize = !context.targetMap->infinite();
     const bool wrapBorder = mOptions.wrapBorder && fixedSize;
-    if (!wrapBorder && fixedSize) {
-        startX = qMax(0, startX);
-        startY = qMax(0, startY);
-        endX = qMin(dwidth, endX);
-        endY = qMin(dheight, endY);
+
+    if (wrapBorder) {
+        for (const RuleOutputCell &outputCell : outputCells.cells) {
+            const int xd = wrap(outputCell.pos.x() + offset.x(), dwidth);
+            const int yd = wrap(outputCell.pos.y() + offset.y(), dheight);
+
+            // this is without graphics update, it's done afterwards for all
+            dstLayer->setCell(xd, yd, outputCell.cell);
+        }
+        return;
     }
 
-    const int offsetX = rect.x() - dstX;
-    const int offsetY = rect.y() - dstY;
+    // Place each run with a single setRow, which looks up the target chunk
+    // once per chunk rather than once per cell
+    QVarLengthArray<Cell, 64> row;
 
-    for (int x = startX; x < endX; ++x) {
-        for (int y = startY; y < endY; ++y) {
-            const Cell &cell = srcLayer->cellAt(x + offsetX, y + offsetY);
+    for (const RuleOutputRun &run : outputCells.runs) {
+        const QPoint start = outputCells.cells.at(run.first).pos + offset;
+        int first = run.first;
+        int x = start.x();
+        int count = run.count;
 
-            // this is without graphics update, it's done afterwards for all
-            int xd = x;
-            int yd = y;
+        if (fixedSize) {
+            if (start.y() < 0 || start.y() >= dheight)
+                continue;
+
+            const int left = std::max(x, 0);
+            const int right = std::min(x + count, dwidth);
+            first += left - x;
+            count = right - left;
+            x = left;
+
+            if (count <= 0)
+                continue;
+        }
+
+        row.resize(count);
+        for (int i = 0; i < count; ++i)
+            row[i] = outputCells.cells.at(first + i).cell;
+
+        dstLayer->setRow(x, start.y(), count, row.constData());
+    }
+}
+
+void AutoMapper::applyDeferredTileCopies(ApplyContext &applyContext,
+                                         const AutoMappingContext &context) const
+{
+    using TileCopy = ApplyContext::TileCopy;
+
+    const QVector<TileCopy> copies = std::exchange(applyContext.tileCopies, QVector<TileCopy>());
+    applyContext.deferTileCopies = false;
+
+    auto copySerially = [&] (const QVector<const TileCopy*> &layerCopies) {
+        for (const TileCopy *copy : layerCopies)
+            copyTileCells(*copy->outputCells, copy->layer, copy->offset, context);
+    };
+
+    // Group the copies by target layer, keeping them in order
+    std::vector<std::pair<TileLayer*, QVector<const TileCopy*>>> layers;
+    for (const TileCopy &copy : copies) {
+        auto &layer = find_or_emplace<std::pair<TileLayer*, QVector<const TileCopy*>>>(layers, [&] (const auto &entry) {
+            return entry.first == copy.layer;
+        }, copy.layer, QVector<const TileCopy*>());
+        layer.second.append(&copy);
+    }
+
+    const bool fixedSize = !context.targetMap->infinite();
+    const bool wrapBorder = mOptions.wrapBorder && fixedSize;
 
-            if (wrapBorder) {
-                xd = wrap(xd, dwidth);
-                yd = wrap(yd, dheight);
+    for (const auto &[layer, layerCopies] : layers) {
+        // Wrapped cells could end up anywhere, so these copies are done
+        // serially
+        if (!context.applyInParallel || wrapBorder) {
+            copySerially(layerCopies);
+            continue;
+        }
+
+        QRect bounds;
+        for (const TileCopy *copy : layerCopies)
+            bounds |= copy->outputCells->bounds.translated(copy->offset);
+        if (fixedSize)
+            bounds &= QRect(0, 0, layer->width(), layer->height());
+        if (bounds.isEmpty())
+            continue;
+
+        if (qint64(bounds.width()) * bounds.height() > MaximumTileCopyArea) {
+            copySerially(layerCopies);
+            continue;
+        }
+
+        // Split the area in bands, each determining the resulting cells in
+        // its part of the area by doing the relevant copies in order. Since
+        // the bands don't overlap, the result is the same as when doing all
+        // copies serially.
+        struct Band
+        {
+            QRect rect;
+            QVector<const TileCopy*> copies;
+            QVector<Cell> cells;
+            std::vector<bool> placed;
+        };
+
+        const int bandCount = (bounds.height() + TileCopyBandHeight - 1) / TileCopyBandHeight;
+        QVector<Band> bands(bandCount);
+
+        for (int i = 0; i < bandCount; ++i) {
+            const int top = bounds.top() + i * TileCopyBandHeight;
+            bands[i].rect = QRect(bounds.left(), top,
+                                  bounds.width(), std::min(TileCopyBandHeight, bounds.bottom() - top + 1));
+        }
+
+        for (const TileCopy *copy : layerCopies) {
+            const QRect rect = copy->outputCells->bounds.translated(copy->offset) & bounds;
+            if (rect.isEmpty())
+                continue;
+
+            const int firstBand = (rect.top() - bounds.top()) / TileCopyBandHeight;
+            const int lastBand = (rect.bottom() - bounds.top()) / TileCopyBandHeight;
+            for (int i = firstBand; i <= lastBand; ++i)
+                bands[i].copies.append(copy);
+        }
+
+        QtConcurrent::blockingMap(bands, [] (Band &band) {
+            const QRect &rect = band.rect;
+            band.cells.resize(rect.width() * rect.height());
+            band.placed.assign(band.cells.size(), false);
+
+            for (const TileCopy *copy : std::as_const(band.copies)) {
+                for (const RuleOutputCell &outputCell : copy->outputCells->cells) {
+                    const QPoint pos = outputCell.pos + copy->offset;
+                    if (!rect.contains(pos))
+                        continue;
+
+                    const int index = (pos.y() - rect.top()) * rect.width() + pos.x() - rect.left();
+                    band.cells[index] = outputCell.cell;
+                    band.placed[index] = true;
+                }
             }
+        });
 
-            switch (matchType(cell.tile())) {
-            case MatchType::Tile:
-                dstLayer->setCell(xd, yd, cell);
-                break;
-            case MatchType::Empty:
-                dstLayer->setCell(xd, yd, Cell());
-                break;
-            default:
-                break;
+        // Place the resulting cells, a row of consecutive cells at a time
+        for (const Band &band : std::as_const(bands)) {
+            const QRect &rect = band.rect;
+
+            for (int y = 0; y < rect.height(); ++y) {
+                const int row = y * rect.width();
+
+                for (int x = 0; x < rect.width();) {
+                    if (!band.placed[row + x]) {
+                        ++x;
+                        continue;
+                    }
+
+                    int end = x + 1;
+                    while (end < rect.width() && band.placed[row + end])
+                        ++end;
+
+                    layer->setRow(rect.left() + x, rect.top() + y, end - x,
+                                  band.cells.constData() + row + x);
+                    x = end;
+                }
             }
         }
     }
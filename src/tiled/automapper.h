@@ -35,6 +35,7 @@
 #include <QString>
 #include <QVector>
 
+#include <map>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -170,15 +171,30 @@ struct RuleMapSetup
 struct RuleInputLayer
 {
     const TileLayer *targetLayer = nullptr;   // reference to layer in target map
+    QString name;                             // name of the input layer
     int posCount = 0;
 };
 
+/**
+ * How the cell at a certain position is matched. The common cases are
+ * detected when compiling the rule, so that they can be checked without
+ * going through the lists of cells.
+ */
+enum class PositionMatch : quint8
+{
+    Cells,                          // any of the "any" and none of the "none" cells
+    Tile,                           // a single specific tile
+    Empty,                          // only the empty cell
+    NonEmpty,                       // anything except the empty cell
+};
+
 struct RuleInputLayerPos
 {
     int x;                          // position relative to match location
     int y;
     int anyCount;                   // any of these cells
     int noneCount;                  // none of these cells
+    PositionMatch match;
 };
 
 struct MatchCell : Cell
@@ -221,6 +237,33 @@ struct RuleOutputSet
     QVector<RuleOutputMapObjects> objectOutputs;
 };
 
+struct RuleOutputCell
+{
+    QPoint pos;                         // position in the rule map
+    Cell cell;                          // an empty cell erases the target cell
+};
+
+/**
+ * A run of horizontally consecutive output cells, referring to \a count
+ * entries in RuleOutputCells::cells starting at \a first.
+ */
+struct RuleOutputRun
+{
+    int first;
+    int count;
+};
+
+/**
+ * The cells a tile output layer places when applying a rule, in the order
+ * they are placed.
+ */
+struct RuleOutputCells
+{
+    QVector<RuleOutputCell> cells;
+    QVector<RuleOutputRun> runs;        // allows placing cells a row at a time
+    QRect bounds;
+};
+
 struct CompileContext;
 struct ApplyContext;
 
@@ -247,6 +290,10 @@ struct TILED_EDITOR_EXPORT AutoMappingContext
     const MapDocument * const targetDocument;
     const Map * const targetMap;
 
+    // Whether tile outputs may be placed using multiple threads. The result
+    // is the same, but this allows comparing against placing them serially.
+    bool applyInParallel = true;
+
     QVector<SharedTileset> newTilesets;             // New tilesets that might get used
     std::vector<std::unique_ptr<Layer>> newLayers;  // Layers created in AutoMapper::prepareAutoMap
     QVector<QVector<AddMapObjects::Entry>> newMapObjects;   // Objects placed by AutoMapper
@@ -256,8 +303,21 @@ struct TILED_EDITOR_EXPORT AutoMappingContext
     // Clones of existing tile layers that might have been changed in AutoMapper::autoMap
     std::unordered_map<TileLayer*, std::unique_ptr<TileLayer>> originalToOutputLayerMapping;
 
-    // Used to keep track of touched tile layers (only when initially non-empty)
-    QVector<const TileLayer*> touchedTileLayers;
+    // Used to keep track of the changed region of each tile layer by name
+    // (only when initially non-empty)
+    QHash<QString, QRegion> changedRegions;
+
+    // Time spent in AutoMapper::autoMap (in nanoseconds) and the number of
+    // matches found, accumulated over all calls. When matching rules in
+    // order, applying them is included in the match time.
+    struct Statistics
+    {
+        qint64 compileTime = 0;
+        qint64 matchTime = 0;
+        qint64 applyTime = 0;
+        int matchCount = 0;
+    };
+    Statistics statistics;
 
 private:
     friend class AutoMapper;
@@ -321,7 +381,7 @@ public:
         int autoMappingRadius = 0;
     };
 
-    using GetCell = const Cell &(*)(int x, int y, const TileLayer &tileLayer);
+    using GetCell = Cell (*)(int x, int y, const TileLayer &tileLayer);
 
     /**
      * Constructs an AutoMapper.
@@ -379,7 +439,7 @@ private:
         QRegion outputRegion;
         RuleOptions options;
         std::optional<RuleOutputSet> outputSet;
-        RandomPicker<RuleOutputSet> outputSets;
+        AliasPicker<RuleOutputSet> outputSets;
     };
 
     void setupRuleMapProperties();
@@ -396,6 +456,7 @@ private:
     void setupRules();
 
     void setupWorkMapLayers(AutoMappingContext &context) const;
+    const std::vector<QVector<RuleInputSet>> &compileRules(const AutoMappingContext &context) const;
     bool compileRule(QVector<RuleInputSet> &inputSets,
                      const Rule &rule,
                      const AutoMappingContext &context) const;
@@ -409,17 +470,26 @@ private:
                           const QRegion &outputRegion) const;
 
     /**
-     * This copies all tiles from TileLayer \a srcLayer to TileLayer
-     * \a dstLayer.
-     *
-     * In src the tiles are taken from the \a rect.
-     * In dst they get copied to a rectangle given by
-     * \a dstX, \a dstY and the size of \a rect.
-     * if there is no tile in src TileLayer, there will nothing be copied,
-     * so the maybe existing tile in dst will not be overwritten.
+     * Returns the cells placed by the tile output layer \a srcLayer of the
+     * given \a rule. Only tiles and "Empty" tiles in the output region of the
+     * rule are placed.
+     */
+    const RuleOutputCells &outputCells(const Rule &rule, const TileLayer *srcLayer) const;
+
+    /**
+     * This copies the \a outputCells to \a dstLayer, translated by
+     * \a offset. Cells that end up outside of a fixed-size map are skipped,
+     * or wrapped when the WrapBorder option is enabled.
      */
-    void copyTileRegion(const TileLayer *srcLayer, QRect rect, TileLayer *dstLayer,
-                        int dstX, int dstY, const AutoMappingContext &context) const;
+    void copyTileCells(const RuleOutputCells &outputCells, TileLayer *dstLayer,
+                       QPoint offset, const AutoMappingContext &context) const;
+
+    /**
+     * Performs the tile copies that were deferred while applying the rules,
+     * in parallel when possible.
+     */
+    void applyDeferredTileCopies(ApplyContext &applyContext,
+                                 const AutoMappingContext &context) const;
 
     /**
      * This copies multiple layers from one map to another.
@@ -430,6 +500,7 @@ private:
      */
     void copyMapRegion(const Rule &rule, QPoint offset,
                        const RuleOutputSet &outputSet,
+                       ApplyContext &applyContext,
                        AutoMappingContext &context) const;
 
     void applyLayerProperties(const Layer *from, Layer *to,
@@ -437,16 +508,31 @@ private:
 
     /**
      * This goes through all the positions in \a matchRegion and checks if the
-     * \a rule matches there.
+     * \a rule, compiled to \a inputSets, matches there.
      *
      * Calls \a matched for each matching location.
      */
     void matchRule(const Rule &rule,
+                   const QVector<RuleInputSet> &inputSets,
                    const QRegion &matchRegion,
                    GetCell getCell,
                    const std::function<void (QPoint)> &matched,
                    const AutoMappingContext &context) const;
 
+    /**
+     * Matches all rules at once in the given \a matchRegion, using their
+     * compiled \a inputSets. Returns the matching locations for each rule,
+     * in the same order as matchRule() would report them.
+     */
+    std::vector<QVector<QPoint>> matchRules(const std::vector<QVector<RuleInputSet>> &inputSets,
+                                            const QRegion &matchRegion,
+                                            GetCell getCell,
+                                            const AutoMappingContext &context) const;
+
+    QRegion ruleMatchRegion(const Rule &rule,
+                            const QRegion &matchRegion,
+                            const AutoMappingContext &context) const;
+
     /**
      * Applies the given \a rule at the given \a pos.
      */
@@ -475,6 +561,24 @@ private:
      */
     std::vector<Rule> mRules;
 
+    /**
+     * The input sets of each rule compiled for matching, and the cells
+     * placed by their outputs. These are kept while the tilesets of the rules
+     * map and the missing input layers of the target map stay the same.
+     */
+    struct CompiledRules
+    {
+        bool valid = false;
+        QVector<SharedTileset> tilesets;
+        QSet<QString> missingInputLayers;
+        std::vector<QVector<RuleInputSet>> inputSets;
+
+        // Cells placed by each rule (by index) and tile output layer
+        std::map<std::pair<const TileLayer*, int>, RuleOutputCells> outputCells;
+    };
+
+    mutable CompiledRules mCompiledRules;
+
     Options mOptions;
 
     /**
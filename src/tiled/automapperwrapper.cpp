@@ -46,10 +46,11 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
     for (const auto autoMapper : autoMappers)
         autoMapper->prepareAutoMap(context);
 
-    // During "AutoMap while drawing", keep track of the touched layers, so we
-    // can skip any rule maps that doesn't have these layers as input entirely.
+    // During "AutoMap while drawing", keep track of the changed region of
+    // each layer, so we only need to match rule maps in the changed parts of
+    // their input layers, skipping rule maps that don't use them entirely.
     if (touchedLayer)
-        context.touchedTileLayers.append(touchedLayer);
+        context.changedRegions.insert(touchedLayer->name(), where);
 
     // use a copy of the region, so each AutoMapper can manipulate it and the
     // following AutoMappers do see the impact
@@ -60,17 +61,24 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
     const QRegion mapRect(0, 0, map->width(), map->height());
 
     for (const auto autoMapper : autoMappers) {
+        if (touchedLayer) {
+            QRegion inputRegion;
+            for (auto it = context.changedRegions.cbegin(); it != context.changedRegions.cend(); ++it)
+                if (autoMapper->ruleLayerNameUsed(it.key()))
+                    inputRegion |= it.value();
+
+            if (!map->infinite())
+                inputRegion &= mapRect;
+
+            if (!inputRegion.isEmpty())
+                autoMapper->autoMap(inputRegion, nullptr, context);
+            continue;
+        }
+
         // stop expanding region when it's already the entire fixed-size map
         if (appliedRegionPtr && (!map->infinite() && (mapRect - region).isEmpty()))
             appliedRegionPtr = nullptr;
 
-        if (touchedLayer) {
-            if (std::none_of(context.touchedTileLayers.cbegin(),
-                             context.touchedTileLayers.cend(),
-                             [&] (const TileLayer *tileLayer) { return autoMapper->ruleLayerNameUsed(tileLayer->name()); }))
-                continue;
-        }
-
         autoMapper->autoMap(region, appliedRegionPtr, context);
 
         if (appliedRegionPtr) {
@@ -128,7 +136,12 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
 
     // Add any newly placed objects
     if (!context.newMapObjects.isEmpty()) {
+        qsizetype entryCount = 0;
+        for (const QVector<AddMapObjects::Entry> &entries : std::as_const(context.newMapObjects))
+            entryCount += entries.size();
+
         QVector<AddMapObjects::Entry> allEntries;
+        allEntries.reserve(entryCount);
 
         for (const QVector<AddMapObjects::Entry> &entries : std::as_const(context.newMapObjects)) {
             // Each group of copied objects needs to be rewired separately
@@ -31,6 +31,7 @@
 #include "projectmanager.h"
 #include "tilelayer.h"
 
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFileInfo>
 #include <QFileSystemWatcher>
@@ -38,13 +39,60 @@
 #include <QScopedValueRollback>
 #include <QTextStream>
 
+#include <vector>
+
 using namespace Tiled;
 
+/**
+ * The AutoMappers loaded from a rules file, along with the files they were
+ * loaded from.
+ */
+struct AutomappingManager::RuleSet
+{
+    QString rulesFile;
+    bool loaded = false;
+
+    /**
+     * For each rule map an AutoMapper is set up. They are stored here in
+     * order.
+     */
+    std::vector<std::unique_ptr<AutoMapper>> autoMappers;
+
+    QStringList files;      // the rules files and rule maps that were read
+    QByteArray hash;        // of the contents of those files
+
+    QString error;
+    QString warning;
+};
+
+// Number of rule sets that are kept loaded after no map is using them
+static constexpr int MaxCachedRuleSets = 8;
+
+static QByteArray hashFiles(const QStringList &fileNames)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    for (const QString &fileName : fileNames) {
+        hash.addData(fileName.toUtf8());
+
+        QFile file(fileName);
+        if (file.open(QIODevice::ReadOnly))
+            hash.addData(&file);
+    }
+
+    return hash.result();
+}
+
 SessionOption<bool> AutomappingManager::automappingWhileDrawing { "automapping.whileDrawing", false };
 
+QList<std::shared_ptr<AutomappingManager::RuleSet>> AutomappingManager::sRuleSetCache;
+int AutomappingManager::sInstanceCount;
+
 AutomappingManager::AutomappingManager(QObject *parent)
     : QObject(parent)
 {
+    ++sInstanceCount;
+
     mMapNameFilter.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
 
     connect(&mWatcher, &QFileSystemWatcher::fileChanged,
@@ -53,6 +101,9 @@ AutomappingManager::AutomappingManager(QObject *parent)
 
 AutomappingManager::~AutomappingManager()
 {
+    // The rules refer to tilesets, which should not outlive the application
+    if (--sInstanceCount == 0)
+        sRuleSetCache.clear();
 }
 
 void AutomappingManager::autoMap()
@@ -110,19 +161,25 @@ void AutomappingManager::autoMapInternal(const QRegion &where,
 
     const bool automatic = touchedLayer != nullptr;
 
-    if (!mLoaded) {
+    if (!mRuleSet) {
         if (mRulesFile.isEmpty()) {
             mError = tr("No AutoMapping rules provided. Save the map or refer to a rule file in the project properties.");
             emit errorsOccurred(automatic);
             return;
         }
 
-        if (loadFile(mRulesFile)) {
-            mLoaded = true;
-        } else {
+        auto ruleSet = loadRuleSet(mRulesFile);
+        mError = ruleSet->error;
+        mWarning = ruleSet->warning;
+
+        if (!ruleSet->loaded) {
             emit errorsOccurred(automatic);
             return;
         }
+
+        mRuleSet = std::move(ruleSet);
+        if (!mRuleSet->files.isEmpty())
+            mWatcher.addPaths(mRuleSet->files);
     }
 
     // Even if no AutoMapper instance will be executed, we still want to report
@@ -139,8 +196,8 @@ void AutomappingManager::autoMapInternal(const QRegion &where,
     // Determine the list of AutoMappers that is relevant for this map
     const QString mapFileName = QFileInfo(mMapDocument->fileName()).fileName();
     QVector<AutoMapper*> autoMappers;
-    autoMappers.reserve(mAutoMappers.size());
-    for (const auto &autoMapper : mAutoMappers) {
+    autoMappers.reserve(mRuleSet->autoMappers.size());
+    for (const auto &autoMapper : mRuleSet->autoMappers) {
         const auto &mapNameFilter = autoMapper->mapNameFilter();
         if (!mapNameFilter.isValid() || mapNameFilter.match(mapFileName).hasMatch())
             autoMappers.append(autoMapper.get());
@@ -165,6 +222,47 @@ void AutomappingManager::autoMapInternal(const QRegion &where,
     mMapDocument->undoStack()->push(aw);
 }
 
+/**
+ * Returns the rules loaded from \a rulesFile.
+ *
+ * Loaded rules are shared between documents and AutomappingManager
+ * instances, since loading the rule maps and compiling their rules can take
+ * a long time. They are reused as long as the contents of the files they
+ * were loaded from did not change. Rules that could not be loaded without
+ * errors are not shared, so that they get loaded again.
+ */
+std::shared_ptr<AutomappingManager::RuleSet> AutomappingManager::loadRuleSet(const QString &rulesFile)
+{
+    auto &cache = sRuleSetCache;
+    const QString canonicalPath = QFileInfo(rulesFile).canonicalFilePath();
+
+    for (int i = 0; i < cache.size(); ++i) {
+        if (cache.at(i)->rulesFile != canonicalPath)
+            continue;
+
+        if (cache.at(i)->hash == hashFiles(cache.at(i)->files)) {
+            cache.move(i, 0);
+            return cache.first();
+        }
+
+        cache.removeAt(i);
+        break;
+    }
+
+    auto ruleSet = std::make_shared<RuleSet>();
+    ruleSet->rulesFile = canonicalPath;
+    ruleSet->loaded = loadFile(rulesFile, *ruleSet);
+    ruleSet->hash = hashFiles(ruleSet->files);
+
+    if (ruleSet->loaded && ruleSet->error.isEmpty() && !canonicalPath.isEmpty()) {
+        cache.prepend(ruleSet);
+        while (cache.size() > MaxCachedRuleSets)
+            cache.removeLast();
+    }
+
+    return ruleSet;
+}
+
 /**
  * This function parses a rules file or loads a rules map file.
  *
@@ -174,20 +272,20 @@ void AutomappingManager::autoMapInternal(const QRegion &where,
  *
  * @return whether the loading was successful
  */
-bool AutomappingManager::loadFile(const QString &filePath)
+bool AutomappingManager::loadFile(const QString &filePath, RuleSet &ruleSet)
 {
     if (filePath.endsWith(QLatin1String(".txt"), Qt::CaseInsensitive)) {
         // Restore any potential change to the map name filter after processing
         // the included rules file.
         QScopedValueRollback<QRegularExpression> mapNameFilter(mMapNameFilter);
 
-        return loadRulesFile(filePath);
+        return loadRulesFile(filePath, ruleSet);
     }
 
-    return loadRuleMap(filePath);
+    return loadRuleMap(filePath, ruleSet);
 }
 
-bool AutomappingManager::loadRulesFile(const QString &filePath)
+bool AutomappingManager::loadRulesFile(const QString &filePath, RuleSet &ruleSet)
 {
     bool ret = true;
     const QDir absPath = QFileInfo(filePath).dir();
@@ -197,20 +295,20 @@ bool AutomappingManager::loadRulesFile(const QString &filePath)
         QString error = tr("No rules file found at '%1'").arg(filePath);
         ERROR(error);
 
-        mError += error;
-        mError += QLatin1Char('\n');
+        ruleSet.error += error;
+        ruleSet.error += QLatin1Char('\n');
         return false;
     }
     if (!rulesFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QString error = tr("Error opening rules file '%1'").arg(filePath);
         ERROR(error);
 
-        mError += error;
-        mError += QLatin1Char('\n');
+        ruleSet.error += error;
+        ruleSet.error += QLatin1Char('\n');
         return false;
     }
 
-    mWatcher.addPath(filePath);
+    ruleSet.files.append(filePath);
 
     QTextStream in(&rulesFile);
 
@@ -239,20 +337,20 @@ bool AutomappingManager::loadRulesFile(const QString &filePath)
                     .arg(rulePath, filePath);
             ERROR(error);
 
-            mError += error;
-            mError += QLatin1Char('\n');
+            ruleSet.error += error;
+            ruleSet.error += QLatin1Char('\n');
             ret = false;
             continue;
         }
 
-        if (!loadFile(rulePath))
+        if (!loadFile(rulePath, ruleSet))
             ret = false;
     }
 
     return ret;
 }
 
-bool AutomappingManager::loadRuleMap(const QString &filePath)
+bool AutomappingManager::loadRuleMap(const QString &filePath, RuleSet &ruleSet)
 {
     QString errorString;
     std::unique_ptr<Map> rules { readMap(filePath, &errorString) };
@@ -262,20 +360,20 @@ bool AutomappingManager::loadRuleMap(const QString &filePath)
                 .arg(filePath, errorString);
         ERROR(error);
 
-        mError += error;
-        mError += QLatin1Char('\n');
+        ruleSet.error += error;
+        ruleSet.error += QLatin1Char('\n');
         return false;
     }
 
     std::unique_ptr<AutoMapper> autoMapper { new AutoMapper(std::move(rules), mMapNameFilter) };
 
-    mWarning += autoMapper->warningString();
+    ruleSet.warning += autoMapper->warningString();
     const QString error = autoMapper->errorString();
     if (error.isEmpty()) {
-        mAutoMappers.push_back(std::move(autoMapper));
-        mWatcher.addPath(filePath);
+        ruleSet.autoMappers.push_back(std::move(autoMapper));
+        ruleSet.files.append(filePath);
     } else {
-        mError += error;
+        ruleSet.error += error;
     }
 
     return true;
@@ -339,8 +437,7 @@ void AutomappingManager::refreshRulesFile(const QString &ruleFileOverride)
 
 void AutomappingManager::cleanUp()
 {
-    mAutoMappers.clear();
-    mLoaded = false;
+    mRuleSet.reset();
     if (!mWatcher.files().isEmpty())
         mWatcher.removePaths(mWatcher.files());
 }
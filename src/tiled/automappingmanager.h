@@ -24,13 +24,13 @@
 #include "session.h"
 
 #include <QFileSystemWatcher>
+#include <QList>
 #include <QObject>
 #include <QRegion>
 #include <QRegularExpression>
 #include <QString>
 
 #include <memory>
-#include <vector>
 
 namespace Tiled {
 
@@ -80,13 +80,16 @@ signals:
     void warningsOccurred(bool automatic);
 
 private:
+    struct RuleSet;
+
     void onRegionEdited(const QRegion &where, TileLayer *touchedLayer);
     void onMapFileNameChanged();
     void onFileChanged();
 
-    bool loadFile(const QString &filePath);
-    bool loadRulesFile(const QString &filePath);
-    bool loadRuleMap(const QString &filePath);
+    std::shared_ptr<RuleSet> loadRuleSet(const QString &rulesFile);
+    bool loadFile(const QString &filePath, RuleSet &ruleSet);
+    bool loadRulesFile(const QString &filePath, RuleSet &ruleSet);
+    bool loadRuleMap(const QString &filePath, RuleSet &ruleSet);
 
     /**
      * Applies automapping to the region \a where.
@@ -107,16 +110,10 @@ private:
     MapDocument *mMapDocument = nullptr;
 
     /**
-     * For each new file of rules a new AutoMapper is setup. In this vector we
-     * can store all of the AutoMappers in order.
-     */
-    std::vector<std::unique_ptr<AutoMapper>> mAutoMappers;
-
-    /**
-     * This tells you if the rules for the current map document were already
-     * loaded.
+     * The rules loaded for the current map document, or null when they were
+     * not loaded yet.
      */
-    bool mLoaded = false;
+    std::shared_ptr<RuleSet> mRuleSet;
 
     /**
      * Contains all errors which occurred until canceling.
@@ -135,6 +132,13 @@ private:
     QString mRulesFile;
     QRegularExpression mMapNameFilter;
     bool mRulesFileOverride = false;
+
+    /**
+     * Rules recently loaded by any instance, most recently used first. Kept
+     * while any instance exists.
+     */
+    static QList<std::shared_ptr<RuleSet>> sRuleSetCache;
+    static int sInstanceCount;
 };
 
 } // namespace Tiled
@@ -26,6 +26,7 @@
 #include "mapobject.h"
 #include "maprenderer.h"
 #include "objectgroup.h"
+#include "objectspatialindex.h"
 
 namespace Tiled {
 
@@ -63,6 +64,39 @@ QList<MapObject*> objectsInRegion(const MapRenderer &renderer,
     return objectsToErase;
 }
 
+/**
+ * Adds the objects occupying the given region (in tiles) to \a objects.
+ *
+ * On orthogonal maps, the spatial index of the object group is used to find
+ * the candidates, which are then matched by their actual bounds (including
+ * rotation). Other orientations check each object like objectsInRegion.
+ */
+void collectObjectsInRegion(const MapRenderer &renderer,
+                            const ObjectGroup *layer,
+                            const QRegion &where,
+                            QSet<MapObject*> &objects)
+{
+    if (where.isEmpty())
+        return;
+
+    if (renderer.map()->orientation() != Map::Orthogonal) {
+        for (MapObject *object : objectsInRegion(renderer, layer, where))
+            objects.insert(object);
+        return;
+    }
+
+    const QRectF pixelRect = renderer.tileToPixelCoords(QRectF(where.boundingRect()));
+
+    for (MapObject *object : layer->objectsIntersecting(pixelRect)) {
+        const QRectF bounds = ObjectSpatialIndex::objectBounds(object);
+        const QPointF topLeft = renderer.pixelToTileCoords(bounds.topLeft());
+        const QPointF bottomRight = renderer.pixelToTileCoords(bounds.bottomRight());
+
+        if (where.intersects(QRectF(topLeft, bottomRight).toAlignedRect()))
+            objects.insert(object);
+    }
+}
+
 QRegion tileRegionOfObjectGroup(const MapRenderer &renderer,
                                 const ObjectGroup *objectGroup)
 {
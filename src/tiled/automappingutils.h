@@ -22,6 +22,7 @@
 #pragma once
 
 #include <QRegion>
+#include <QSet>
 
 namespace Tiled {
 
@@ -36,6 +37,11 @@ QList<MapObject*> objectsInRegion(const MapRenderer &renderer,
                                   const ObjectGroup *layer,
                                   const QRegion &where);
 
+void collectObjectsInRegion(const MapRenderer &renderer,
+                            const ObjectGroup *layer,
+                            const QRegion &where,
+                            QSet<MapObject*> &objects);
+
 QRegion tileRegionOfObjectGroup(const MapRenderer &renderer,
                                 const ObjectGroup *objectGroup);
 
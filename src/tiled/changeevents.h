@@ -223,17 +223,23 @@ public:
     MapObject::ChangedProperties properties;
 };
 
+/**
+ * Reports the insertion or removal of \a count consecutive objects, starting
+ * at \a index in \a objectGroup.
+ */
 class MapObjectEvent : public ChangeEvent
 {
 public:
-    MapObjectEvent(Type type, ObjectGroup *objectGroup, int index)
+    MapObjectEvent(Type type, ObjectGroup *objectGroup, int index, int count = 1)
         : ChangeEvent(type)
         , objectGroup(objectGroup)
         , index(index)
+        , count(count)
     {}
 
     ObjectGroup *objectGroup;
     int index;
+    int count;
 };
 
 class TilesetChangeEvent : public ChangeEvent
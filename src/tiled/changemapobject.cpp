@@ -35,18 +35,30 @@ ChangeMapObject::ChangeMapObject(Document *document,
                                  MapObject *mapObject,
                                  MapObject::Property property,
                                  const QVariant &value)
+    : ChangeMapObject(document,
+                      QList<MapObject *> { mapObject },
+                      property,
+                      QVector<QVariant> { value })
+{
+}
+
+ChangeMapObject::ChangeMapObject(Document *document,
+                                 QList<MapObject *> mapObjects,
+                                 MapObject::Property property,
+                                 const QVector<QVariant> &values)
     : QUndoCommand(QCoreApplication::translate("Undo Commands",
                                                "Change Object"))
     , mDocument(document)
-    , mMapObject(mapObject)
+    , mMapObjects(std::move(mapObjects))
     , mProperty(property)
-    , mValue(value)
-    , mOldChangeState(mapObject->propertyChanged(property))
-    , mNewChangeState(true)
+    , mValues(values)
+    , mChangeStates(mMapObjects.size(), true)
 {
+    Q_ASSERT(mMapObjects.size() == mValues.size());
+
     switch (property) {
     case MapObject::VisibleProperty:
-        if (value.toBool())
+        if (!mValues.isEmpty() && mValues.first().toBool())
             setText(QCoreApplication::translate("Undo Commands", "Show Object"));
         else
             setText(QCoreApplication::translate("Undo Commands", "Hide Object"));
@@ -59,22 +71,31 @@ ChangeMapObject::ChangeMapObject(Document *document,
 bool ChangeMapObject::mergeWith(const QUndoCommand *other)
 {
     auto o = static_cast<const ChangeMapObject*>(other);
-    if (mDocument == o->mDocument && mMapObject == o->mMapObject && mProperty == o->mProperty) {
-        setObsolete(mMapObject->mapObjectProperty(mProperty) == mValue);
-        return true;
-    }
-    return false;
+    if (mDocument != o->mDocument || mProperty != o->mProperty || mMapObjects != o->mMapObjects)
+        return false;
+
+    bool obsolete = true;
+    for (int i = 0; i < mMapObjects.size() && obsolete; ++i)
+        obsolete = mMapObjects.at(i)->mapObjectProperty(mProperty) == mValues.at(i);
+
+    setObsolete(obsolete);
+    return true;
 }
 
 void ChangeMapObject::swap()
 {
-    const auto value = std::exchange(mValue, mMapObject->mapObjectProperty(mProperty));
-    mMapObject->setMapObjectProperty(mProperty, value);
+    for (int i = 0; i < mMapObjects.size(); ++i) {
+        MapObject *mapObject = mMapObjects.at(i);
+
+        const auto value = std::exchange(mValues[i], mapObject->mapObjectProperty(mProperty));
+        mapObject->setMapObjectProperty(mProperty, value);
 
-    mMapObject->setPropertyChanged(mProperty, mNewChangeState);
-    std::swap(mOldChangeState, mNewChangeState);
+        const bool changed = mapObject->propertyChanged(mProperty);
+        mapObject->setPropertyChanged(mProperty, mChangeStates.at(i));
+        mChangeStates[i] = changed;
+    }
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObject, mProperty));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObjects, mProperty));
 }
 
 
@@ -110,7 +131,7 @@ void ChangeMapObjectCells::swap()
         change.propertyChanged = changed;
     }
 
-    emit mDocument->changed(MapObjectsChangeEvent(objectList(mChanges), MapObject::CellProperty));
+    mDocument->emitChanged(MapObjectsChangeEvent(objectList(mChanges), MapObject::CellProperty));
 }
 
 
@@ -172,8 +193,8 @@ void ChangeMapObjectsTile::restoreTiles()
         mMapObjects[i]->setChangedProperties(mOldChangedProperties[i]);
     }
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects,
-                                                  MapObject::CellProperty | MapObject::SizeProperty));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObjects,
+                                             MapObject::CellProperty | MapObject::SizeProperty));
 }
 
 void ChangeMapObjectsTile::changeTiles()
@@ -187,8 +208,8 @@ void ChangeMapObjectsTile::changeTiles()
             mMapObjects[i]->setPropertyChanged(MapObject::SizeProperty);
     }
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects,
-                                                  MapObject::CellProperty | MapObject::SizeProperty));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObjects,
+                                             MapObject::CellProperty | MapObject::SizeProperty));
 }
 
 DetachObjects::DetachObjects(Document *document,
@@ -214,7 +235,7 @@ void DetachObjects::redo()
     for (MapObject *object : std::as_const(mMapObjects))
         object->detachFromTemplate();
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, MapObject::TemplateProperty));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObjects, MapObject::TemplateProperty));
 }
 
 void DetachObjects::undo()
@@ -229,7 +250,7 @@ void DetachObjects::undo()
 
     QUndoCommand::undo(); // undo child commands
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, MapObject::TemplateProperty));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObjects, MapObject::TemplateProperty));
 }
 
 ResetInstances::ResetInstances(Document *document,
@@ -265,7 +286,7 @@ void ResetInstances::redo()
         object->syncWithTemplate();
     }
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, affectedProperties));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObjects, affectedProperties));
 
     // This signal forces updating custom properties in the properties dock
 //    emit mMapDocument->selectedObjectsChanged();
@@ -280,7 +301,7 @@ void ResetInstances::undo()
         affectedProperties |= mOldMapObjects.at(i)->changedProperties();
     }
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, affectedProperties));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObjects, affectedProperties));
 }
 
 
@@ -313,7 +334,7 @@ void ReplaceObjectsWithTemplate::redo()
         object->syncWithTemplate();
     }
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, MapObject::AllProperties));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObjects, MapObject::AllProperties));
 }
 
 void ReplaceObjectsWithTemplate::undo()
@@ -321,5 +342,5 @@ void ReplaceObjectsWithTemplate::undo()
     for (int i = 0; i < mMapObjects.size(); ++i)
         mMapObjects.at(i)->copyPropertiesFrom(mOldMapObjects.at(i));
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, MapObject::AllProperties));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObjects, MapObject::AllProperties));
 }
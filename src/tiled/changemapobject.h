@@ -46,6 +46,17 @@ public:
                     MapObject::Property property,
                     const QVariant &value);
 
+    /**
+     * Creates an undo command that sets the \a property of each of the given
+     * \a objects to the value at the same index in \a values.
+     *
+     * Only a single change event is emitted for all objects.
+     */
+    ChangeMapObject(Document *document,
+                    QList<MapObject *> objects,
+                    MapObject::Property property,
+                    const QVector<QVariant> &values);
+
     void undo() override { swap(); }
     void redo() override { swap(); }
 
@@ -57,11 +68,10 @@ private:
     void swap();
 
     Document *mDocument;
-    MapObject *mMapObject;
+    QList<MapObject *> mMapObjects;
     MapObject::Property mProperty;
-    QVariant mValue;
-    bool mOldChangeState;
-    bool mNewChangeState;
+    QVector<QVariant> mValues;
+    QVector<bool> mChangeStates;
 };
 
 
@@ -56,6 +56,10 @@ ChangeMapProperty::ChangeMapProperty(MapDocument *mapDocument,
         setText(QCoreApplication::translate("Undo Commands",
                                             "Change Compression Level"));
         break;
+    case Map::CompressionDictionaryProperty:
+        setText(QCoreApplication::translate("Undo Commands",
+                                            "Change Compression Dictionary"));
+        break;
     default:
         break;
     }
@@ -234,6 +238,12 @@ void ChangeMapProperty::swap()
         mChunkSize = chunkSize;
         break;
     }
+    case Map::CompressionDictionaryProperty: {
+        const bool useCompressionDictionary = map->useCompressionDictionary();
+        map->setUseCompressionDictionary(mIntValue);
+        mIntValue = useCompressionDictionary;
+        break;
+    }
     }
 
     emit mMapDocument->changed(MapChangeEvent(mProperty));
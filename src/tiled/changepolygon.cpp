@@ -47,7 +47,7 @@ void ChangePolygon::undo()
     mMapObject->setPolygon(mOldPolygon);
     mMapObject->setPropertyChanged(MapObject::ShapeProperty, mOldChangeState);
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObject, MapObject::ShapeProperty));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObject, MapObject::ShapeProperty));
 }
 
 void ChangePolygon::redo()
@@ -55,7 +55,7 @@ void ChangePolygon::redo()
     mMapObject->setPolygon(mNewPolygon);
     mMapObject->setPropertyChanged(MapObject::ShapeProperty);
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObject, MapObject::ShapeProperty));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObject, MapObject::ShapeProperty));
 }
 
 
@@ -85,7 +85,7 @@ void SplitPolyline::undo()
     mFirstPolyline->setPolygon(polygon);
     mFirstPolyline->setPropertyChanged(MapObject::ShapeProperty, mOldChangeState);
 
-    emit mMapDocument->changed(MapObjectsChangeEvent(mFirstPolyline, MapObject::ShapeProperty));
+    mMapDocument->emitChanged(MapObjectsChangeEvent(mFirstPolyline, MapObject::ShapeProperty));
 }
 
 void SplitPolyline::redo()
@@ -115,7 +115,7 @@ void SplitPolyline::redo()
     mFirstPolyline->setPolygon(firstPolygon);
     mFirstPolyline->setPropertyChanged(MapObject::ShapeProperty);
 
-    emit mMapDocument->changed(MapObjectsChangeEvent(mFirstPolyline, MapObject::ShapeProperty));
+    mMapDocument->emitChanged(MapObjectsChangeEvent(mFirstPolyline, MapObject::ShapeProperty));
 
     // If the first polyline is selected, select the second as well
     QList<MapObject*> selection = mMapDocument->selectedObjects();
@@ -21,6 +21,7 @@
 #include "clipboardmanager.h"
 
 #include "addremovemapobject.h"
+#include "compression.h"
 #include "map.h"
 #include "mapdocument.h"
 #include "mapobject.h"
@@ -32,6 +33,7 @@
 #include "snaphelper.h"
 #include "tile.h"
 #include "tilelayer.h"
+#include "tileset.h"
 #include "tmxmapformat.h"
 
 #include <QApplication>
@@ -48,9 +50,79 @@
 #include <algorithm>
 
 static const char * const TMX_MIMETYPE = "text/tmx";
+static const char * const MAP_MIMETYPE = "application/vnd.tiled.map";
 
 using namespace Tiled;
 
+namespace {
+
+/**
+ * Mime data holding a copied map. Within this process the map is used
+ * directly, and it is only serialized when another application (or another
+ * instance of Tiled) requests the clipboard contents.
+ */
+class MapMimeData : public QMimeData
+{
+    Q_OBJECT
+
+public:
+    explicit MapMimeData(std::unique_ptr<Map> map)
+        : mMap(std::move(map))
+    {}
+
+    const Map *map() const { return mMap.get(); }
+
+    QStringList formats() const override
+    {
+        return { QLatin1String(MAP_MIMETYPE), QLatin1String(TMX_MIMETYPE) };
+    }
+
+    bool hasFormat(const QString &mimeType) const override
+    {
+        return mimeType == QLatin1String(MAP_MIMETYPE) ||
+                mimeType == QLatin1String(TMX_MIMETYPE);
+    }
+
+protected:
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    QVariant retrieveData(const QString &mimeType, QVariant::Type) const override
+#else
+    QVariant retrieveData(const QString &mimeType, QMetaType) const override
+#endif
+    {
+        if (mimeType == QLatin1String(MAP_MIMETYPE))
+            return compactData();
+        if (mimeType == QLatin1String(TMX_MIMETYPE))
+            return TmxMapFormat().toByteArray(mMap.get());
+        return QVariant();
+    }
+
+private:
+    /**
+     * The compact format is TMX with the tile layer data always stored
+     * compressed, which is a lot smaller than XML or CSV encoded tile data
+     * for large selections.
+     */
+    QByteArray compactData() const
+    {
+        if (mCompactData.isEmpty()) {
+            const auto format = compressionSupported(Zstandard) ? Map::Base64Zstandard
+                                                                : Map::Base64Zlib;
+            const auto previousFormat = mMap->layerDataFormat();
+
+            mMap->setLayerDataFormat(format);
+            mCompactData = TmxMapFormat().toByteArray(mMap.get());
+            mMap->setLayerDataFormat(previousFormat);
+        }
+        return mCompactData;
+    }
+
+    const std::unique_ptr<Map> mMap;
+    mutable QByteArray mCompactData;
+};
+
+} // anonymous namespace
+
 ClipboardManager::ClipboardManager()
     : mClipboard(QApplication::clipboard())
     , mHasMap(false)
@@ -82,7 +154,24 @@ ClipboardManager *ClipboardManager::instance()
 std::unique_ptr<Map> ClipboardManager::map() const
 {
     const QMimeData *mimeData = mClipboard->mimeData();
-    const QByteArray data = mimeData->data(QLatin1String(TMX_MIMETYPE));
+
+    // Fast path for maps copied within this instance
+    if (auto mapMimeData = qobject_cast<const MapMimeData*>(mimeData)) {
+        auto map = mapMimeData->map()->clone();
+
+        // Embedded tilesets are cloned as well, to avoid sharing them between
+        // the clipboard and the maps it gets pasted in
+        const auto tilesets = map->tilesets();
+        for (const SharedTileset &tileset : tilesets)
+            if (!tileset->isExternal())
+                map->replaceTileset(tileset, tileset->clone());
+
+        return map;
+    }
+
+    QByteArray data = mimeData->data(QLatin1String(MAP_MIMETYPE));
+    if (data.isEmpty())
+        data = mimeData->data(QLatin1String(TMX_MIMETYPE));
     if (data.isEmpty())
         return nullptr;
 
@@ -95,12 +184,7 @@ std::unique_ptr<Map> ClipboardManager::map() const
  */
 void ClipboardManager::setMap(const Map &map)
 {
-    TmxMapFormat format;
-
-    QMimeData *mimeData = new QMimeData;
-    mimeData->setData(QLatin1String(TMX_MIMETYPE), format.toByteArray(&map));
-
-    mClipboard->setMimeData(mimeData);
+    mClipboard->setMimeData(new MapMimeData(map.clone()));
 }
 
 Properties ClipboardManager::properties() const
@@ -263,7 +347,8 @@ void ClipboardManager::update()
     bool hasProperties = false;
 
     if (const QMimeData *data = mClipboard->mimeData()) {
-        hasMap = data->hasFormat(QLatin1String(TMX_MIMETYPE));
+        hasMap = data->hasFormat(QLatin1String(MAP_MIMETYPE)) ||
+                data->hasFormat(QLatin1String(TMX_MIMETYPE));
         hasProperties = data->hasFormat(QLatin1String(PROPERTIES_MIMETYPE));
     }
 
@@ -279,3 +364,4 @@ void ClipboardManager::update()
 }
 
 #include "moc_clipboardmanager.cpp"
+#include "clipboardmanager.moc"
@@ -40,6 +40,12 @@ namespace session {
 static SessionOption<QStringList> commandHistory { "console.history" };
 } // namespace session
 
+// Output is appended in batches, at most this often
+static constexpr int FlushInterval = 50;    // ms
+
+// Older output is removed when the console grows beyond this many lines
+static constexpr int MaximumLineCount = 10000;
+
 class ConsoleOutputWidget : public QPlainTextEdit
 {
 public:
@@ -76,6 +82,7 @@ ConsoleDock::ConsoleDock(QWidget *parent)
     layout->setSpacing(0);
 
     mPlainTextEdit->setReadOnly(true);
+    mPlainTextEdit->setMaximumBlockCount(MaximumLineCount);
 
     QPalette p = mPlainTextEdit->palette();
     p.setColor(QPalette::Base, Qt::black);
@@ -93,7 +100,7 @@ ConsoleDock::ConsoleDock(QWidget *parent)
     connect(nextShortcut, &QShortcut::activated, [this] { moveHistory(1); });
 
     mClearButton = new QPushButton(tr("Clear Console"));
-    connect(mClearButton, &QPushButton::clicked, mPlainTextEdit, &QPlainTextEdit::clear);
+    connect(mClearButton, &QPushButton::clicked, this, &ConsoleDock::clear);
 
     auto bottomBar = new QHBoxLayout;
     bottomBar->addWidget(mLineEdit);
@@ -108,6 +115,10 @@ ConsoleDock::ConsoleDock(QWidget *parent)
     connect(&logger, &LoggingInterface::warning, this, &ConsoleDock::appendWarning);
     connect(&logger, &LoggingInterface::error, this, &ConsoleDock::appendError);
 
+    mFlushTimer.setSingleShot(true);
+    mFlushTimer.setInterval(FlushInterval);
+    connect(&mFlushTimer, &QTimer::timeout, this, &ConsoleDock::flushPendingOutput);
+
     setWidget(widget);
 
     mHistory = session::commandHistory;
@@ -125,35 +136,70 @@ ConsoleDock::~ConsoleDock()
 {
 }
 
+/**
+ * Queues the given \a html to be appended to the console. Appending many
+ * messages one by one is slow, so they are appended in batches.
+ */
+void ConsoleDock::append(const QString &html)
+{
+    mPendingOutput.append(html);
+
+    // No need to keep output that would be removed right away
+    if (mPendingOutput.size() > MaximumLineCount)
+        mPendingOutput.erase(mPendingOutput.begin(),
+                             mPendingOutput.begin() + (mPendingOutput.size() - MaximumLineCount));
+
+    if (!mFlushTimer.isActive())
+        mFlushTimer.start();
+}
+
+void ConsoleDock::flushPendingOutput()
+{
+    mFlushTimer.stop();
+
+    if (mPendingOutput.isEmpty())
+        return;
+
+    mPlainTextEdit->appendHtml(mPendingOutput.join(QString()));
+    mPendingOutput.clear();
+}
+
+void ConsoleDock::clear()
+{
+    mFlushTimer.stop();
+    mPendingOutput.clear();
+    mPlainTextEdit->clear();
+}
+
 void ConsoleDock::appendInfo(const QString &str)
 {
-    mPlainTextEdit->appendHtml(QLatin1String("<pre>") + str.toHtmlEscaped() +
-                               QLatin1String("</pre>"));
+    append(QLatin1String("<pre>") + str.toHtmlEscaped() +
+           QLatin1String("</pre>"));
 }
 
 void ConsoleDock::appendWarning(const QString &str)
 {
-    mPlainTextEdit->appendHtml(QLatin1String("<pre style='color:orange'>") + str.toHtmlEscaped() +
-                               QLatin1String("</pre>"));
+    append(QLatin1String("<pre style='color:orange'>") + str.toHtmlEscaped() +
+           QLatin1String("</pre>"));
 }
 
 void ConsoleDock::appendError(const QString &str)
 {
-    mPlainTextEdit->appendHtml(QLatin1String("<pre style='color:red'>") + str.toHtmlEscaped() +
-                               QLatin1String("</pre>"));
+    append(QLatin1String("<pre style='color:red'>") + str.toHtmlEscaped() +
+           QLatin1String("</pre>"));
 }
 
 void ConsoleDock::appendScript(const QString &str)
 {
-    mPlainTextEdit->appendHtml(QLatin1String("<pre style='color:lightgreen'>&gt; ") + str.toHtmlEscaped() +
-                               QLatin1String("</pre>"));
+    append(QLatin1String("<pre style='color:lightgreen'>&gt; ") + str.toHtmlEscaped() +
+           QLatin1String("</pre>"));
 }
 
 void ConsoleDock::appendScriptResult(const QString &tempName, const QString &result)
 {
-    mPlainTextEdit->appendHtml(QLatin1String("<pre><span style='color:gray'>") + tempName.toHtmlEscaped() +
-                               QLatin1String("&nbsp;=&nbsp;</span>") + result.toHtmlEscaped() +
-                               QLatin1String("</pre>"));
+    append(QLatin1String("<pre><span style='color:gray'>") + tempName.toHtmlEscaped() +
+           QLatin1String("&nbsp;=&nbsp;</span>") + result.toHtmlEscaped() +
+           QLatin1String("</pre>"));
 }
 
 void ConsoleDock::executeScript()
@@ -22,6 +22,8 @@
 #pragma once
 
 #include <QDockWidget>
+#include <QStringList>
+#include <QTimer>
 
 class QLineEdit;
 class QPlainTextEdit;
@@ -41,6 +43,10 @@ protected:
     void changeEvent(QEvent *e) override;
 
 private:
+    void append(const QString &html);
+    void flushPendingOutput();
+    void clear();
+
     void appendInfo(const QString &str);
     void appendWarning(const QString &str);
     void appendError(const QString &str);
@@ -58,6 +64,9 @@ private:
     QPushButton *mClearButton;
     QStringList mHistory;
     int mHistoryPosition = 0;
+
+    QStringList mPendingOutput;
+    QTimer mFlushTimer;
 };
 
 } // namespace Tiled
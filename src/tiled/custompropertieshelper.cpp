@@ -154,6 +154,22 @@ void CustomPropertiesHelper::deleteSubProperties(QtProperty *property)
     }
 }
 
+/**
+ * Returns whether \a property was created for the custom property type of
+ * the given \a value (or for no custom type, when \a value doesn't have
+ * one).
+ */
+bool CustomPropertiesHelper::hasPropertyType(QtProperty *property, const QVariant &value) const
+{
+    int typeId = 0;
+
+    if (value.userType() == propertyValueId())
+        if (const PropertyType *type = value.value<PropertyValue>().type())
+            typeId = type->id;
+
+    return mPropertyTypeIds.value(property) == typeId;
+}
+
 void CustomPropertiesHelper::clear()
 {
     QHashIterator<QtProperty *, int> it(mPropertyTypeIds);
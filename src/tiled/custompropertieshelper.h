@@ -47,6 +47,7 @@ public:
     void deleteProperty(QtProperty *property);
     void clear();
     bool hasProperty(QtProperty *property) const;
+    bool hasPropertyType(QtProperty *property, const QVariant &value) const;
     QtVariantProperty *property(const QString &name);
     const QHash<QString, QtVariantProperty *> &properties() const;
 
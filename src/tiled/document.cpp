@@ -26,6 +26,7 @@
 #include "editableasset.h"
 #include "logginginterface.h"
 #include "object.h"
+#include "preferences.h"
 #include "tile.h"
 #include "undocommands.h"
 #include "wangset.h"
@@ -35,6 +36,12 @@
 
 namespace Tiled {
 
+/**
+ * The amount of memory in MiB the undo commands of each document may use,
+ * before the oldest commands get compressed. 0 means unlimited.
+ */
+Preference<int> Document::undoMemoryBudget { "Undo/MemoryBudget", 256 };
+
 Document::Document(DocumentType type, const QString &fileName,
                    QObject *parent)
     : QObject(parent)
@@ -51,6 +58,14 @@ Document::Document(DocumentType type, const QString &fileName,
 
     connect(mUndoStack, &QUndoStack::indexChanged, this, &Document::updateIsModified);
     connect(mUndoStack, &QUndoStack::cleanChanged, this, &Document::updateIsModified);
+    connect(mUndoStack, &QUndoStack::indexChanged, this, [this] {
+        if (const int budget = undoMemoryBudget)
+            compressUndoStack(mUndoStack, qint64(budget) * 1024 * 1024);
+    });
+
+    // Connected first, so that any buffered changes are dispatched before
+    // listeners get to see another change event.
+    connect(this, &Document::changed, this, &Document::flushPendingChanges);
 }
 
 Document::~Document()
@@ -95,6 +110,72 @@ void Document::setFileName(const QString &fileName)
     emit fileNameChanged(fileName, oldFileName);
 }
 
+/**
+ * Starts a change transaction. Transactions can be nested.
+ *
+ * While a transaction is active, consecutive MapObjectsChanged events emitted
+ * through emitChanged() are merged into a single event. This event is
+ * dispatched when the outermost transaction ends, or right before any other
+ * change event is emitted, so listeners still see all changes in order.
+ */
+void Document::beginChangeTransaction()
+{
+    ++mChangeTransactionDepth;
+}
+
+/**
+ * Ends a change transaction started with beginChangeTransaction().
+ */
+void Document::endChangeTransaction()
+{
+    Q_ASSERT(mChangeTransactionDepth > 0);
+
+    if (--mChangeTransactionDepth == 0)
+        flushPendingChanges();
+}
+
+/**
+ * Emits the changed() signal for the given \a change, unless a change
+ * transaction is active and the change can be merged with pending changes.
+ */
+void Document::emitChanged(const ChangeEvent &change)
+{
+    if (mChangeTransactionDepth > 0 && change.type == ChangeEvent::MapObjectsChanged) {
+        auto &mapObjectsChange = static_cast<const MapObjectsChangeEvent&>(change);
+
+        if (!mPendingMapObjectsChange) {
+            mPendingMapObjectsChange = std::make_unique<MapObjectsChangeEvent>(QList<MapObject*>(),
+                                                                               MapObject::ChangedProperties());
+        }
+
+        for (MapObject *mapObject : mapObjectsChange.mapObjects) {
+            if (!mPendingMapObjects.contains(mapObject)) {
+                mPendingMapObjects.insert(mapObject);
+                mPendingMapObjectsChange->mapObjects.append(mapObject);
+            }
+        }
+
+        mPendingMapObjectsChange->properties |= mapObjectsChange.properties;
+        return;
+    }
+
+    emit changed(change);
+}
+
+/**
+ * Dispatches any changes buffered by an active change transaction.
+ */
+void Document::flushPendingChanges()
+{
+    if (!mPendingMapObjectsChange)
+        return;
+
+    const auto change = std::move(mPendingMapObjectsChange);
+    mPendingMapObjects.clear();
+
+    emit changed(*change);
+}
+
 void Document::checkFilePathProperties(const Object *object) const
 {
     const auto &props = object->properties();
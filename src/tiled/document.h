@@ -24,6 +24,7 @@
 
 #include <QDateTime>
 #include <QObject>
+#include <QSet>
 #include <QSharedPointer>
 #include <QString>
 #include <QVariant>
@@ -35,11 +36,15 @@ class QUndoStack;
 namespace Tiled {
 
 class FileFormat;
+class MapObject;
 class Object;
 class Tile;
 
 class ChangeEvent;
 class EditableAsset;
+class MapObjectsChangeEvent;
+
+template<typename T> class Preference;
 
 /**
  * Keeps track of a file and its undo history.
@@ -65,6 +70,8 @@ public:
              QObject *parent = nullptr);
     ~Document() override;
 
+    static Preference<int> undoMemoryBudget;
+
     DocumentType type() const { return mType; }
 
     const QString &fileName() const;
@@ -128,6 +135,12 @@ public:
 
     virtual void checkIssues() {}
 
+    void beginChangeTransaction();
+    void endChangeTransaction();
+    bool isInChangeTransaction() const { return mChangeTransactionDepth > 0; }
+
+    void emitChanged(const ChangeEvent &change);
+
 signals:
     void changed(const ChangeEvent &change);
     void saved();
@@ -162,6 +175,8 @@ protected:
 
     void checkFilePathProperties(const Object *object) const;
 
+    void flushPendingChanges();
+
     QDateTime mLastSaved;
 
     Object *mCurrentObject = nullptr;   /**< Current properties object. */
@@ -184,6 +199,10 @@ private:
     bool mModified = false;
     bool mChangedOnDisk = false;
     bool mIgnoreBrokenLinks = false;
+
+    int mChangeTransactionDepth = 0;
+    std::unique_ptr<MapObjectsChangeEvent> mPendingMapObjectsChange;
+    QSet<MapObject*> mPendingMapObjects;
 };
 
 
@@ -55,10 +55,12 @@
 #include <QDialogButtonBox>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QGuiApplication>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QMenu>
 #include <QMessageBox>
+#include <QScopeGuard>
 #include <QScrollBar>
 #include <QStackedLayout>
 #include <QTabBar>
@@ -588,6 +590,14 @@ int DocumentManager::insertDocument(int index, const DocumentPtr &document)
     if (auto *mapDocument = qobject_cast<MapDocument*>(documentPtr)) {
         connect(mapDocument, &MapDocument::tilesetAdded, this, &DocumentManager::tilesetAdded);
         connect(mapDocument, &MapDocument::tilesetRemoved, this, &DocumentManager::tilesetRemoved);
+        connect(mapDocument, &MapDocument::backgroundSaveFinished, this, [=] (bool success, const QString &error) {
+            if (success) {
+                emit documentSaved(mapDocument);
+            } else {
+                switchToDocument(mapDocument);
+                QMessageBox::critical(mWidget->window(), QCoreApplication::translate("Tiled::MainWindow", "Error Saving File"), error);
+            }
+        });
     }
 
     if (auto *tilesetDocument = qobject_cast<TilesetDocument*>(documentPtr))
@@ -652,6 +662,10 @@ DocumentPtr DocumentManager::loadDocument(const QString &fileName,
         return DocumentPtr();
     }
 
+    // Loading large files can take a while, so indicate we're busy
+    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+    const auto restoreCursor = qScopeGuard([] { QGuiApplication::restoreOverrideCursor(); });
+
     DocumentPtr document;
 
     if (MapFormat *mapFormat = qobject_cast<MapFormat*>(fileFormat)) {
@@ -692,6 +706,27 @@ bool DocumentManager::saveDocument(Document *document, const QString &fileName)
     return true;
 }
 
+/**
+ * Save the given document with the given file name, continuing in the
+ * background when possible. Errors are reported once the save has finished.
+ *
+ * Falls back to saveDocument() for documents that can't be saved in the
+ * background.
+ *
+ * @return <code>false</code> when saving failed or could not be started
+ */
+bool DocumentManager::saveDocumentInBackground(Document *document, const QString &fileName)
+{
+    auto mapDocument = qobject_cast<MapDocument*>(document);
+    if (fileName.isEmpty() || !mapDocument || !mapDocument->canSaveInBackground())
+        return saveDocument(document, fileName);
+
+    emit documentAboutToBeSaved(document);
+
+    mapDocument->saveInBackground(fileName);
+    return true;
+}
+
 /**
  * Save the given document with a file name chosen by the user. When saved
  * successfully, the file is added to the list of recent files.
@@ -1148,6 +1183,9 @@ void DocumentManager::fileChanged(const QString &fileName)
     // Ignore change event when it seems to be our own save
     if (fileInfo.lastModified() == document->lastSaved())
         return;
+    if (auto mapDocument = qobject_cast<MapDocument*>(document))
+        if (mapDocument->isSavingInBackground())
+            return;
 
     // Automatically reload when there are no unsaved changes
     if (!isDocumentModified(document)) {
@@ -113,6 +113,7 @@ public:
 
     bool saveDocument(Document *document);
     bool saveDocument(Document *document, const QString &fileName);
+    bool saveDocumentInBackground(Document *document, const QString &fileName);
     bool saveDocumentAs(Document *document);
 
     void closeCurrentDocument();
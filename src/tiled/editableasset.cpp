@@ -92,32 +92,41 @@ QJSValue EditableAsset::macro(const QString &text, QJSValue callback)
         return QJSValue();
     }
 
+    // Change notifications are dispatched once the callback has finished
     auto stack = undoStack();
-    if (stack)
+    if (stack) {
         undoStack()->beginMacro(text);
+        document()->beginChangeTransaction();
+    }
 
     QJSValue result = callback.call();
     ScriptManager::instance().checkError(result);
 
-    if (stack)
+    if (stack) {
+        document()->endChangeTransaction();
         undoStack()->endMacro();
+    }
 
     return result;
 }
 
 void EditableAsset::undo()
 {
-    if (auto stack = undoStack())
+    if (auto stack = undoStack()) {
+        document()->beginChangeTransaction();
         stack->undo();
-    else
+        document()->endChangeTransaction();
+    } else
         ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Undo system not available for this asset"));
 }
 
 void EditableAsset::redo()
 {
-    if (auto stack = undoStack())
+    if (auto stack = undoStack()) {
+        document()->beginChangeTransaction();
         stack->redo();
-    else
+        document()->endChangeTransaction();
+    } else
         ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Undo system not available for this asset"));
 }
 
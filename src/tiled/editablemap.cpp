@@ -91,6 +91,7 @@ EditableMap::~EditableMap()
 QList<QObject *> EditableMap::tilesets() const
 {
     QList<QObject *> editableTilesets;
+    editableTilesets.reserve(map()->tilesetCount());
 
     for (const SharedTileset &tileset : map()->tilesets())
         editableTilesets.append(EditableTileset::get(tileset.data()));
@@ -101,6 +102,7 @@ QList<QObject *> EditableMap::tilesets() const
 QList<QObject *> EditableMap::layers()
 {
     QList<QObject *> editables;
+    editables.reserve(map()->layerCount());
 
     for (const auto layer : map()->layers())
         editables.append(EditableLayer::get(this, layer));
@@ -123,6 +125,7 @@ QList<QObject *> EditableMap::selectedLayers()
     QList<QObject*> selectedLayers;
 
     const auto selectedLayersOrdered = mapDocument()->selectedLayersOrdered();
+    selectedLayers.reserve(selectedLayersOrdered.size());
     for (Layer *layer : selectedLayersOrdered)
         selectedLayers.append(EditableLayer::get(this, layer));
 
@@ -137,6 +140,7 @@ QList<QObject *> EditableMap::selectedObjects()
     QList<QObject*> selectedObjects;
 
     const auto selectedObjectsOrdered = mapDocument()->selectedObjectsOrdered();
+    selectedObjects.reserve(selectedObjectsOrdered.size());
     for (MapObject *object : selectedObjectsOrdered)
         selectedObjects.append(EditableMapObject::get(this, object));
 
@@ -75,12 +75,14 @@ public:
 
     // Synchronized with Map::LayerDataFormat
     enum LayerDataFormat {
-        XML             = 0,
-        Base64          = 1,
-        Base64Gzip      = 2,
-        Base64Zlib      = 3,
-        Base64Zstandard = 4,
-        CSV             = 5
+        XML                         = 0,
+        Base64                      = 1,
+        Base64Gzip                  = 2,
+        Base64Zlib                  = 3,
+        Base64Zstandard             = 4,
+        CSV                         = 5,
+        Base64RunLength             = 6,
+        Base64RunLengthZstandard    = 7
     };
     Q_ENUM(LayerDataFormat)
 
@@ -89,7 +89,7 @@ bool EditableMapObject::isSelected() const
 {
     if (auto m = map())
         if (auto doc = m->mapDocument())
-            return doc->selectedObjects().contains(mapObject());
+            return doc->isObjectSelected(mapObject());
     return false;
 }
 
@@ -319,16 +319,15 @@ void EditableMapObject::setSelected(bool selected)
         return;
 
     if (selected) {
-        if (!document->selectedObjects().contains(mapObject())) {
+        if (!document->isObjectSelected(mapObject())) {
             auto objects = document->selectedObjects();
             objects.append(mapObject());
             document->setSelectedObjects(objects);
         }
     } else {
-        int index = document->selectedObjects().indexOf(mapObject());
-        if (index != -1) {
+        if (document->isObjectSelected(mapObject())) {
             auto objects = document->selectedObjects();
-            objects.removeAt(index);
+            objects.removeOne(mapObject());
             document->setSelectedObjects(objects);
         }
     }
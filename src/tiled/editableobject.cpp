@@ -40,10 +40,17 @@ EditableObject::EditableObject(EditableAsset *asset,
     , mAsset(asset)
     , mObject(object)
 {
+    ScriptProfiler::wrapperCreated();
+
     if (object)
         object->mEditable = this;
 }
 
+EditableObject::~EditableObject()
+{
+    ScriptProfiler::wrapperDestroyed();
+}
+
 bool EditableObject::isReadOnly() const
 {
     return asset() && asset()->isReadOnly();
@@ -50,6 +50,7 @@ public:
     EditableObject(EditableAsset *asset,
                    Object *object,
                    QObject *parent = nullptr);
+    ~EditableObject() override;
 
     EditableAsset *asset() const;
 
@@ -44,8 +44,10 @@ EditableObjectGroup::EditableObjectGroup(EditableAsset *asset,
 
 QList<QObject *> EditableObjectGroup::objects()
 {
+    const auto &mapObjects = objectGroup()->objects();
     QList<QObject*> objects;
-    for (MapObject *object : objectGroup()->objects())
+    objects.reserve(mapObjects.size());
+    for (MapObject *object : mapObjects)
         objects.append(EditableMapObject::get(asset(), object));
     return objects;
 }
@@ -135,6 +137,16 @@ void EditableObjectGroup::addObject(EditableMapObject *editableMapObject)
     insertObjectAt(objectCount(), editableMapObject);
 }
 
+QList<QObject *> EditableObjectGroup::objectsIntersecting(const QRectF &rect)
+{
+    const auto mapObjects = objectGroup()->objectsIntersecting(rect);
+    QList<QObject*> objects;
+    objects.reserve(mapObjects.size());
+    for (MapObject *object : mapObjects)
+        objects.append(EditableMapObject::get(asset(), object));
+    return objects;
+}
+
 /**
  * This functions exists in addition to EditableLayer::get() because the asset
  * might also be an EditableTileset in the case of object groups.
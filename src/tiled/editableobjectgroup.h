@@ -59,6 +59,7 @@ public:
     Q_INVOKABLE void removeObject(Tiled::EditableMapObject *editableMapObject);
     Q_INVOKABLE void insertObjectAt(int index, Tiled::EditableMapObject *editableMapObject);
     Q_INVOKABLE void addObject(Tiled::EditableMapObject *editableMapObject);
+    Q_INVOKABLE QList<QObject*> objectsIntersecting(const QRectF &rect);
     QColor color() const;
     DrawOrder drawOrder() const;
 
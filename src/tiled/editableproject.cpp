@@ -22,6 +22,8 @@
 #include "editableproject.h"
 
 #include "projectdocument.h"
+#include "projectmanager.h"
+#include "referenceindex.h"
 
 namespace Tiled {
 
@@ -51,6 +53,16 @@ QStringList EditableProject::folders() const
     return project()->folders();
 }
 
+QStringList EditableProject::findReferences(const QString &fileName) const
+{
+    return ProjectManager::instance()->referenceIndex()->referencingFiles(fileName);
+}
+
+QStringList EditableProject::findTypeUsages(const QString &typeName) const
+{
+    return ProjectManager::instance()->referenceIndex()->filesUsingType(typeName);
+}
+
 bool EditableProject::isReadOnly() const
 {
     return false;
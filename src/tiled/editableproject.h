@@ -50,6 +50,9 @@ public:
     QString fileName() const;
     QStringList folders() const;
 
+    Q_INVOKABLE QStringList findReferences(const QString &fileName) const;
+    Q_INVOKABLE QStringList findTypeUsages(const QString &typeName) const;
+
     Project *project() const;
 
     QSharedPointer<Document> createDocument() override;
@@ -147,6 +147,10 @@ EditableTile *EditableTile::get(Tile *tile)
     if (!tile)
         return nullptr;
 
+    // Avoid looking up the tileset when the tile is already wrapped
+    if (auto editable = EditableTile::find(tile))
+        return editable;
+
     auto tileset = EditableTileset::get(tile->tileset());
     return get(tileset, tile);
 }
@@ -23,12 +23,15 @@
 #include "addremovetileset.h"
 #include "changelayer.h"
 #include "editablemap.h"
+#include "gidmapper.h"
 #include "painttilelayer.h"
 #include "resizetilelayer.h"
 #include "scriptmanager.h"
 #include "tilelayeredit.h"
 #include "tilelayerwangedit.h"
 
+#include <limits>
+
 namespace Tiled {
 
 EditableTileLayer::EditableTileLayer(const QString &name, QSize size, QObject *parent)
@@ -105,6 +108,45 @@ EditableTile *EditableTileLayer::tileAt(int x, int y) const
     return EditableTile::get(cellAt(x, y).tile());
 }
 
+/**
+ * Returns the global tile IDs of the cells in \a rect as a buffer of 32-bit
+ * unsigned integers, row by row. The IDs refer to the tilesets of the map
+ * this layer is part of, and include the flipping flags.
+ */
+QByteArray EditableTileLayer::gids(QRect rect) const
+{
+    const Map *map = tileLayer()->map();
+    if (!map) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Layer not part of a map"));
+        return QByteArray();
+    }
+
+    if (rect.isEmpty())
+        return QByteArray();
+
+    const qint64 count = qint64(rect.width()) * rect.height();
+    if (count > std::numeric_limits<int>::max() / int(sizeof(unsigned))) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Area too large"));
+        return QByteArray();
+    }
+
+    const GidMapper gidMapper(map->tilesets());
+
+    QByteArray data(int(count * sizeof(unsigned)), Qt::Uninitialized);
+    auto gids = reinterpret_cast<unsigned*>(data.data());
+
+    QVector<Cell> row(rect.width());
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        for (int x = rect.left(); x <= rect.right(); ++x)
+            row[x - rect.left()] = tileLayer()->cellAt(x, y);
+
+        gidMapper.cellsToGids(row.constData(), row.size(), gids);
+        gids += row.size();
+    }
+
+    return data;
+}
+
 TileLayerEdit *EditableTileLayer::edit()
 {
     return new TileLayerEdit(this);
@@ -103,8 +103,10 @@ EditableTile *EditableTileset::findTile(int id)
 
 QList<QObject*> EditableTileset::tiles()
 {
+    const auto &plainTiles = tileset()->tiles();
     QList<QObject*> tiles;
-    for (Tile *tile : tileset()->tiles())
+    tiles.reserve(plainTiles.size());
+    for (Tile *tile : plainTiles)
         tiles.append(EditableTile::get(this, tile));
     return tiles;
 }
@@ -53,6 +53,9 @@
 
 using namespace Tiled;
 
+// Objects with more points get their handles drawn by a PointHandlesItem
+static constexpr int MaxPointHandleItems = 1024;
+
 static TransformMapObjects *createChangePolygonsCommand(Document *document,
                                                         const QHash<MapObject*, QPolygonF> &newPolygons)
 {
@@ -124,10 +127,13 @@ void EditPolygonTool::deactivate(MapScene *scene)
     QHashIterator<MapObject*, QList<PointHandle*> > i(mHandles);
     while (i.hasNext())
         qDeleteAll(i.next().value());
+    qDeleteAll(mBatchedHandles);
 
     mHoveredHandle = nullptr;
     mHoveredSegment.clear();
     mHandles.clear();
+    mBatchedHandles.clear();
+    mOnDemandHandles.clear();
     mSelectedHandles.clear();
     mHighlightedHandles.clear();
 
@@ -329,7 +335,7 @@ void EditPolygonTool::mouseDoubleClicked(QGraphicsSceneMouseEvent *event)
 
         mapDocument()->undoStack()->push(splitSegment);
 
-        auto newNodeHandle = mHandles.value(mClickedSegment.object).at(mClickedSegment.index + 1);
+        auto newNodeHandle = handleAt(mClickedSegment.object, mClickedSegment.index + 1);
         setSelectedHandle(newNodeHandle);
         setHighlightedHandles(mSelectedHandles);
         mHoveredHandle = newNodeHandle;
@@ -393,6 +399,7 @@ void EditPolygonTool::updateHandles()
             mSelectedHandles.remove(handle);
         if (handle->isHighlighted())
             mHighlightedHandles.remove(handle);
+        mOnDemandHandles.remove(handle);
         delete handle;
     };
 
@@ -402,8 +409,10 @@ void EditPolygonTool::updateHandles()
         i.next();
         if (!selection.contains(i.key())) {
             for (PointHandle *handle : std::as_const(i.value()))
-                deleteHandle(handle);
+                if (handle)
+                    deleteHandle(handle);
 
+            delete mBatchedHandles.take(i.key());
             i.remove();
         }
     }
@@ -419,19 +428,41 @@ void EditPolygonTool::updateHandles()
             continue;
 
         const QPolygonF &polygon = object->polygon();
+        const bool batched = polygon.size() > MaxPointHandleItems;
 
         QList<PointHandle*> &pointHandles = mHandles[object];
 
-        // Create missing handles
-        while (pointHandles.size() < polygon.size()) {
-            PointHandle *handle = new PointHandle(object, pointHandles.size());
-            pointHandles.append(handle);
-            mapScene()->addItem(handle);
+        // Remove superfluous handles
+        while (pointHandles.size() > polygon.size()) {
+            if (PointHandle *handle = pointHandles.takeLast())
+                deleteHandle(handle);
         }
 
-        // Remove superfluous handles
-        while (pointHandles.size() > polygon.size())
-            deleteHandle(pointHandles.takeLast());
+        // Create missing handles. When the handles are batched, they are
+        // only created on demand by handleAt().
+        while (pointHandles.size() < polygon.size())
+            pointHandles.append(nullptr);
+
+        PointHandlesItem *batchedHandles = mBatchedHandles.value(object);
+
+        if (batched && !batchedHandles) {
+            batchedHandles = new PointHandlesItem;
+            mBatchedHandles.insert(object, batchedHandles);
+            mapScene()->addItem(batchedHandles);
+        } else if (!batched) {
+            delete mBatchedHandles.take(object);
+            batchedHandles = nullptr;
+
+            for (int i = 0; i < pointHandles.size(); ++i) {
+                if (PointHandle *handle = pointHandles.at(i)) {
+                    mOnDemandHandles.remove(handle);
+                } else {
+                    handle = new PointHandle(object, i);
+                    pointHandles[i] = handle;
+                    mapScene()->addItem(handle);
+                }
+            }
+        }
 
         if (pointHandles.isEmpty())
             continue;
@@ -440,13 +471,61 @@ void EditPolygonTool::updateHandles()
         QTransform rotate = rotateAt(objectScreenPos, object->rotation());
         QPointF totalOffset = mapScene()->absolutePositionForLayer(*object->objectGroup());
 
+        QVector<QPointF> positions;
+        if (batchedHandles)
+            positions.reserve(pointHandles.size());
+
         // Update the position of all handles
         for (int i = 0; i < pointHandles.size(); ++i) {
             QPointF pixelPos = polygon.at(i) + object->position();
             QPointF screenPos = renderer->pixelToScreenCoords(pixelPos);
-            screenPos = rotate.map(screenPos);
-            pointHandles.at(i)->setPos(totalOffset + screenPos);
+            screenPos = totalOffset + rotate.map(screenPos);
+
+            if (PointHandle *handle = pointHandles.at(i))
+                handle->setPos(screenPos);
+            if (batchedHandles)
+                positions.append(screenPos);
         }
+
+        if (batchedHandles)
+            batchedHandles->setPositions(std::move(positions));
+    }
+}
+
+/**
+ * Returns the handle for the point at \a index of the given \a object,
+ * creating it when the handles of this object are batched.
+ */
+PointHandle *EditPolygonTool::handleAt(MapObject *object, int index)
+{
+    PointHandle *&handle = mHandles[object][index];
+
+    if (!handle) {
+        handle = new PointHandle(object, index);
+        handle->setPos(mBatchedHandles.value(object)->positions().at(index));
+        mapScene()->addItem(handle);
+        mOnDemandHandles.insert(handle);
+    }
+
+    return handle;
+}
+
+/**
+ * Deletes the handles created on demand which are no longer hovered,
+ * clicked, selected or highlighted.
+ */
+void EditPolygonTool::releaseUnusedHandles()
+{
+    QMutableSetIterator<PointHandle*> it(mOnDemandHandles);
+    while (it.hasNext()) {
+        PointHandle *handle = it.next();
+        if (handle == mHoveredHandle || handle == mClickedHandle ||
+                handle->isSelected() || handle->isHighlighted())
+            continue;
+
+        mHandles[handle->mapObject()][handle->pointIndex()] = nullptr;
+        it.remove();
+        delete handle;
     }
 }
 
@@ -503,6 +582,10 @@ void EditPolygonTool::updateSelection(QGraphicsSceneMouseEvent *event)
                 selectedHandles.insert(handle);
         }
 
+        for (auto it = mBatchedHandles.cbegin(); it != mBatchedHandles.cend(); ++it)
+            for (int index : it.value()->pointsInRect(rect))
+                selectedHandles.insert(handleAt(it.key(), index));
+
         if (event->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier))
             setSelectedHandles(mSelectedHandles | selectedHandles);
         else
@@ -690,16 +773,17 @@ void EditPolygonTool::showHandleContextMenu(QPoint screenPos)
  * Returns all clicked handles. This may return two handles when a polygon
  * segment was clicked.
  */
-QSet<PointHandle *> EditPolygonTool::clickedHandles() const
+QSet<PointHandle *> EditPolygonTool::clickedHandles()
 {
     QSet<PointHandle*> handles;
 
     if (mClickedHandle) {
         handles.insert(mClickedHandle);
     } else if (mClickedSegment) {
-        auto handlesForObject = mHandles.value(mClickedSegment.object);
-        handles.insert(handlesForObject.at(mClickedSegment.index));
-        handles.insert(handlesForObject.at((mClickedSegment.index + 1) % handlesForObject.size()));
+        MapObject *object = mClickedSegment.object;
+        const int count = mHandles.value(object).size();
+        handles.insert(handleAt(object, mClickedSegment.index));
+        handles.insert(handleAt(object, (mClickedSegment.index + 1) % count));
     }
 
     return handles;
@@ -1083,10 +1167,23 @@ void EditPolygonTool::updateHover(const QPointF &scenePos, QGraphicsSceneMouseEv
         QGraphicsItem *hoveredItem = mapScene()->itemAt(scenePos, transform);
         hoveredHandle = qgraphicsitem_cast<PointHandle*>(hoveredItem);
 
+        MapRenderer *renderer = mapDocument()->renderer();
+
+        // Look up the batched handles, when they are shown
+        if (!hoveredHandle && renderer->painterScale() >= PointHandlesItem::MinimumScale) {
+            const qreal radius = Utils::dpiScaled(qreal(7)) / renderer->painterScale();
+
+            for (auto it = mBatchedHandles.cbegin(); it != mBatchedHandles.cend(); ++it) {
+                const int index = it.value()->pointAt(scenePos, radius);
+                if (index != -1) {
+                    hoveredHandle = handleAt(it.key(), index);
+                    break;
+                }
+            }
+        }
+
         if (!hoveredHandle) {
             // check if we're hovering a line segment
-            MapRenderer *renderer = mapDocument()->renderer();
-
             const qreal hoverDistance = 7 / renderer->painterScale();
             qreal minDistance = std::numeric_limits<qreal>::max();
 
@@ -1129,15 +1226,18 @@ void EditPolygonTool::updateHover(const QPointF &scenePos, QGraphicsSceneMouseEv
     if (hoveredHandle) {
         highlightedHandles.insert(hoveredHandle);
     } else if (hoveredSegment) {
-        auto handles = mHandles.value(hoveredSegment.object);
-        highlightedHandles.insert(handles.at(hoveredSegment.index));
-        highlightedHandles.insert(handles.at((hoveredSegment.index + 1) % handles.size()));
+        MapObject *object = hoveredSegment.object;
+        const int count = mHandles.value(object).size();
+        highlightedHandles.insert(handleAt(object, hoveredSegment.index));
+        highlightedHandles.insert(handleAt(object, (hoveredSegment.index + 1) % count));
     }
 
     setHighlightedHandles(highlightedHandles);
 
     mHoveredHandle = hoveredHandle;
     mHoveredSegment = hoveredSegment;
+
+    releaseUnusedHandles();
 }
 
 #include "moc_editpolygontool.cpp"
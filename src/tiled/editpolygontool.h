@@ -32,6 +32,7 @@ class QGraphicsItem;
 namespace Tiled {
 
 class PointHandle;
+class PointHandlesItem;
 class SelectionRectangle;
 
 /**
@@ -70,6 +71,8 @@ protected:
 
 private:
     void updateHandles();
+    PointHandle *handleAt(MapObject *object, int index);
+    void releaseUnusedHandles();
     void objectsAboutToBeRemoved(const QList<MapObject *> &objects);
 
     void joinNodes();
@@ -104,7 +107,7 @@ private:
 
     void showHandleContextMenu(QPoint screenPos);
 
-    QSet<PointHandle*> clickedHandles() const;
+    QSet<PointHandle*> clickedHandles();
 
     enum Action {
         NoAction,
@@ -137,8 +140,11 @@ private:
     QPoint mScreenStart;
     Qt::KeyboardModifiers mModifiers;
 
-    /// The list of handles associated with each selected map object
+    /// The list of handles associated with each selected map object. For
+    /// objects with many points, handles are only created on demand.
     QHash<MapObject*, QList<PointHandle*> > mHandles;
+    QHash<MapObject*, PointHandlesItem*> mBatchedHandles;
+    QSet<PointHandle*> mOnDemandHandles;
     QSet<PointHandle*> mSelectedHandles;
     QSet<PointHandle*> mHighlightedHandles;
 };
@@ -0,0 +1,252 @@
+/*
+ * exportcache.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exportcache.h"
+
+#include "imagelayer.h"
+#include "map.h"
+#include "mapobject.h"
+#include "objectgroup.h"
+#include "objecttemplate.h"
+#include "savefile.h"
+#include "tiled.h"
+#include "tile.h"
+#include "tileset.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+
+namespace Tiled {
+
+static void addDependency(QStringList &dependencies, const QString &fileName)
+{
+    if (!fileName.isEmpty())
+        dependencies.append(QDir::cleanPath(fileName));
+}
+
+static void addDependency(QStringList &dependencies, const QUrl &url)
+{
+    addDependency(dependencies, urlToLocalFileOrQrc(url));
+}
+
+static void addTilesetDependencies(QStringList &dependencies, const Tileset &tileset)
+{
+    if (tileset.isExternal())
+        addDependency(dependencies, tileset.fileName());
+
+    addDependency(dependencies, tileset.imageSource());
+
+    for (const Tile *tile : tileset.tiles())
+        addDependency(dependencies, tile->imageSource());
+}
+
+/**
+ * Creates an export cache stored in \a fileName.
+ *
+ * The \a settings should contain anything that affects the output of all
+ * exported maps, like the application version and the export options. When
+ * the settings stored in the cache don't match, all maps are considered to
+ * be out of date.
+ */
+ExportCache::ExportCache(const QString &fileName, const QJsonObject &settings)
+    : mFileName(fileName)
+    , mSettings(settings)
+{
+}
+
+/**
+ * Returns the file name of the export cache used for the given project.
+ */
+QString ExportCache::fileNameForProject(const QString &projectFileName)
+{
+    const QFileInfo fileInfo(projectFileName);
+    return fileInfo.dir().filePath(fileInfo.completeBaseName() +
+                                   QLatin1String(".tiled-export-cache"));
+}
+
+/**
+ * Loads the cache from its file.
+ *
+ * Returns false when there was no usable cache, in which case all maps are
+ * considered out of date.
+ */
+bool ExportCache::load()
+{
+    mEntries = QJsonObject();
+
+    QFile file(mFileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(QLatin1String("settings")).toObject() != mSettings)
+        return false;
+
+    mEntries = root.value(QLatin1String("maps")).toObject();
+    return true;
+}
+
+bool ExportCache::save() const
+{
+    const QJsonObject root {
+        { QStringLiteral("settings"), mSettings },
+        { QStringLiteral("maps"), mEntries },
+    };
+
+    SaveFile file(mFileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.device()->write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+/**
+ * Returns whether the map \a mapFileName was exported before, its target
+ * still exists and none of the files it depends on have changed since.
+ */
+bool ExportCache::isUpToDate(const QString &mapFileName)
+{
+    const QJsonObject entry = mEntries.value(relativePath(mapFileName)).toObject();
+    if (entry.isEmpty())
+        return false;
+
+    const QString target = entry.value(QLatin1String("target")).toString();
+    if (!target.isEmpty() && !QFileInfo::exists(absolutePath(target)))
+        return false;
+
+    const QJsonObject inputs = entry.value(QLatin1String("inputs")).toObject();
+    for (auto it = inputs.begin(), end = inputs.end(); it != end; ++it) {
+        const QByteArray storedHash = it.value().toString().toLatin1();
+        if (hash(absolutePath(it.key())) != storedHash)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Records the current state of the dependencies of \a map, which should have
+ * been exported successfully (or have no export target). The
+ * \a extraDependencies can be used for files that affect the export of all
+ * maps, like the project file.
+ */
+void ExportCache::update(const Map &map, const QStringList &extraDependencies)
+{
+    QStringList files = dependencies(map);
+    files.append(extraDependencies);
+
+    QJsonObject inputs;
+    for (const QString &fileName : std::as_const(files))
+        inputs.insert(relativePath(fileName), QString::fromLatin1(hash(fileName)));
+
+    QString target;
+    if (!map.exportFileName.isEmpty())
+        target = relativePath(map.exportFileName);
+
+    mEntries.insert(relativePath(map.fileName), QJsonObject {
+                        { QStringLiteral("target"), target },
+                        { QStringLiteral("inputs"), inputs },
+                    });
+}
+
+/**
+ * Forgets about the map \a mapFileName, for example because its export
+ * failed.
+ */
+void ExportCache::remove(const QString &mapFileName)
+{
+    mEntries.remove(relativePath(mapFileName));
+}
+
+/**
+ * Returns the files that affect the export of the given \a map: the map
+ * itself, its external tilesets, the images used by its tilesets and image
+ * layers, and the object templates it uses.
+ */
+QStringList ExportCache::dependencies(const Map &map)
+{
+    QStringList dependencies;
+    addDependency(dependencies, map.fileName);
+
+    for (const SharedTileset &tileset : map.tilesets())
+        addTilesetDependencies(dependencies, *tileset);
+
+    for (Layer *layer : map.allLayers(Layer::ImageLayerType | Layer::ObjectGroupType)) {
+        if (layer->isImageLayer()) {
+            addDependency(dependencies, layer->asImageLayer()->imageSource());
+            continue;
+        }
+
+        for (const MapObject *object : layer->asObjectGroup()->objects()) {
+            if (const ObjectTemplate *objectTemplate = object->objectTemplate()) {
+                addDependency(dependencies, objectTemplate->fileName());
+                if (const SharedTileset &tileset = objectTemplate->tileset())
+                    addTilesetDependencies(dependencies, *tileset);
+            }
+        }
+    }
+
+    dependencies.removeDuplicates();
+    return dependencies;
+}
+
+/**
+ * Returns the hex-encoded SHA-1 hash of the contents of \a fileName, or an
+ * empty hash when the file doesn't exist. Hashes are computed only once for
+ * each file, since many maps tend to share the same tilesets and images.
+ */
+QByteArray ExportCache::hash(const QString &fileName)
+{
+    auto it = mHashes.find(fileName);
+    if (it != mHashes.end())
+        return it.value();
+
+    QByteArray result;
+
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly)) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        if (hash.addData(&file))
+            result = hash.result().toHex();
+    }
+
+    mHashes.insert(fileName, result);
+    return result;
+}
+
+/**
+ * Paths are stored relative to the cache, so that it stays valid when the
+ * project is moved.
+ */
+QString ExportCache::relativePath(const QString &fileName) const
+{
+    return QFileInfo(mFileName).dir().relativeFilePath(fileName);
+}
+
+QString ExportCache::absolutePath(const QString &fileName) const
+{
+    return QDir::cleanPath(QFileInfo(mFileName).dir().filePath(fileName));
+}
+
+} // namespace Tiled
@@ -0,0 +1,70 @@
+/*
+ * exportcache.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "tilededitor_global.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+namespace Tiled {
+
+class Map;
+
+/**
+ * Remembers the inputs each exported map depended on, along with a hash of
+ * their contents, so that maps can be skipped when exporting a project
+ * again while none of their inputs changed.
+ *
+ * The cache is stored next to the project file.
+ */
+class TILED_EDITOR_EXPORT ExportCache
+{
+public:
+    ExportCache(const QString &fileName, const QJsonObject &settings);
+
+    static QString fileNameForProject(const QString &projectFileName);
+
+    bool load();
+    bool save() const;
+
+    bool isUpToDate(const QString &mapFileName);
+    void update(const Map &map, const QStringList &extraDependencies = QStringList());
+    void remove(const QString &mapFileName);
+
+    static QStringList dependencies(const Map &map);
+
+private:
+    QByteArray hash(const QString &fileName);
+
+    QString relativePath(const QString &fileName) const;
+    QString absolutePath(const QString &fileName) const;
+
+    const QString mFileName;
+    const QJsonObject mSettings;
+    QJsonObject mEntries;
+    QHash<QString, QByteArray> mHashes;
+};
+
+} // namespace Tiled
@@ -50,6 +50,8 @@ SharedTileset ExportHelper::prepareExportTileset(const SharedTileset &tileset,
     const bool hasExportSettings = !(tileset->exportFileName.isEmpty()
                                      && tileset->exportFormat.isEmpty());
 
+    mInheritedProperties.clear();
+
     if (!mOptions && !hasExportSettings)
         return tileset;
 
@@ -99,6 +101,8 @@ const Map *ExportHelper::prepareExportMap(const Map *map, std::unique_ptr<Map> &
     const bool hasExportSettings = !(map->exportFileName.isEmpty()
                                      && map->exportFormat.isEmpty());
 
+    mInheritedProperties.clear();
+
     // If no export options are active, return the same map
     if (!(mOptions & ~Preferences::ExportMinimized) && !hasExportSettings)
         return map;
@@ -206,20 +210,15 @@ void ExportHelper::resolveProperties(Object *object) const
             mapObject->setClassName(tile->className());
         }
 
-        Properties properties;
-
-        // Inherit properties from the class
-        if (auto type = Object::propertyTypes().findClassFor(mapObject->className(), *mapObject))
-            mergeProperties(properties, type->members);
-
-        // Inherit properties from the tile
-        if (tile)
-            mergeProperties(properties, tile->properties());
+        // Inherit properties from the class and the tile
+        auto type = Object::propertyTypes().findClassFor(mapObject->className(), *mapObject);
+        Properties properties = inheritedProperties(type, tile);
 
         // Override with own properties
-        mergeProperties(properties, mapObject->properties());
+        Properties ownProperties = mapObject->properties();
+        resolveClassPropertyMembers(ownProperties);
+        mergeProperties(properties, ownProperties);
 
-        resolveClassPropertyMembers(properties);
         mapObject->setProperties(properties);
         return;
     }
@@ -256,9 +255,48 @@ void ExportHelper::resolveProperties(Object *object) const
         break;
     }
 
-    auto properties = object->resolvedProperties();
-    resolveClassPropertyMembers(properties);
+    // Equivalent to Object::resolvedProperties for objects other than map
+    // objects, but sharing the resolved class members
+    auto type = Object::propertyTypes().findClassFor(object->className(), *object);
+    Properties properties = inheritedProperties(type, nullptr);
+
+    Properties ownProperties = object->properties();
+    resolveClassPropertyMembers(ownProperties);
+    mergeProperties(properties, ownProperties);
+
     object->setProperties(properties);
+
+    // Map objects in tile object groups may inherit from this tile, so
+    // previously cached properties are no longer valid
+    if (object->typeId() == Object::TileType)
+        mInheritedProperties.clear();
+}
+
+/**
+ * Returns the properties inherited from the given \a classType and \a tile,
+ * with the members of class values resolved.
+ *
+ * Resolving these is repeated for each object sharing the same class and
+ * tile, so the result is cached for the duration of an export.
+ */
+Properties ExportHelper::inheritedProperties(const ClassPropertyType *classType,
+                                             const Tile *tile) const
+{
+    const auto key = qMakePair(classType, tile);
+    auto it = mInheritedProperties.constFind(key);
+    if (it != mInheritedProperties.constEnd())
+        return it.value();
+
+    Properties properties;
+
+    if (classType)
+        mergeProperties(properties, classType->members);
+    if (tile)
+        mergeProperties(properties, tile->properties());
+
+    resolveClassPropertyMembers(properties);
+    mInheritedProperties.insert(key, properties);
+    return properties;
 }
 
 } // namespace Tiled
@@ -25,6 +25,9 @@
 #include "tilededitor_global.h"
 #include "tileset.h"
 
+#include <QHash>
+#include <QPair>
+
 #include <memory>
 
 namespace Tiled {
@@ -49,8 +52,14 @@ public:
 
 private:
     void resolveProperties(Object *object) const;
+    Properties inheritedProperties(const ClassPropertyType *classType,
+                                   const Tile *tile) const;
 
     const Preferences::ExportOptions mOptions;
+
+    // Resolved properties inherited from a class and tile, shared by all
+    // objects using the same class and tile during an export
+    mutable QHash<QPair<const ClassPropertyType*, const Tile*>, Properties> mInheritedProperties;
 };
 
 } // namespace Tiled
@@ -66,5 +66,5 @@ void FlipMapObjects::flip()
 
     mOldChangedProperties.swap(mNewChangedProperties);
 
-    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, propertiesChangedByFlip));
+    mDocument->emitChanged(MapObjectsChangeEvent(mMapObjects, propertiesChangedByFlip));
 }
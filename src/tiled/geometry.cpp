@@ -23,6 +23,8 @@
 
 #include "geometry.h"
 
+#include "tileregion.h"
+
 #include <QTransform>
 
 namespace Tiled {
@@ -79,10 +81,13 @@ QVector<QPoint> pointsOnEllipse(int xm, int ym, int a, int b)
  */
 QRegion ellipseRegion(int x0, int y0, int x1, int y1)
 {
-    QRegion ret;
+    // Collect the rows as spans, since building up a QRegion row by row is
+    // slow for large ellipses
+    TileRegion ret;
 
     auto addRect = [&ret](int x0, int y0, int x1, int y1) {
-        ret += QRect(QPoint(x0, y0), QPoint(x1, y1));
+        Q_ASSERT(y0 == y1);
+        ret.addSpan(x0, y0, x1 - x0 + 1);
     };
 
     long a = abs(x1-x0), b = abs(y1-y0), b1 = b&1;                 /* diameter */
@@ -115,7 +120,7 @@ QRegion ellipseRegion(int x0, int y0, int x1, int y1)
        y1--;
     }
 
-    return ret;
+    return ret.toRegion();
 }
 
 QRegion ellipseRegion(QRect rect)
@@ -20,24 +20,362 @@
 
 #include "grouplayeritem.h"
 
+#include "mapdocument.h"
+#include "paintprofiler.h"
+#include "tilelayeritem.h"
+
+#include <QStyleOptionGraphicsItem>
+
+#include <algorithm>
+#include <cmath>
+
 namespace Tiled {
 
-GroupLayerItem::GroupLayerItem(GroupLayer *groupLayer, QGraphicsItem *parent)
+namespace {
+
+/**
+ * The size of the baked chunks in device-independent pixels.
+ */
+constexpr int ChunkSize = 512;
+
+/**
+ * Up to 128 MB of baked chunks are kept for each frozen group (in KB).
+ */
+constexpr int MaxChunkCacheCost = 128 * 1024;
+
+int cost(const QPixmap &pixmap)
+{
+    return qMax(1, int(qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / (8 * 1024)));
+}
+
+QList<QGraphicsItem*> sortedChildItems(const QGraphicsItem *item)
+{
+    QList<QGraphicsItem*> children = item->childItems();
+    std::stable_sort(children.begin(), children.end(), [] (QGraphicsItem *a, QGraphicsItem *b) {
+        return a->zValue() < b->zValue();
+    });
+    return children;
+}
+
+/**
+ * Paints the descendants of \a item, as they would be painted by the scene
+ * when \a root were painted with the given \a rootTransform.
+ *
+ * The child layer items of a frozen group are hidden, so their visibility
+ * and opacity are taken from the layers instead.
+ */
+void paintDescendants(QPainter *painter,
+                      const MapRenderer *renderer,
+                      QGraphicsItem *item,
+                      const QGraphicsItem *root,
+                      const QTransform &rootTransform,
+                      const QRectF &exposed,
+                      qreal opacity)
+{
+    const auto children = sortedChildItems(item);
+    for (QGraphicsItem *child : children) {
+        qreal childOpacity = opacity;
+
+        if (auto layerItem = dynamic_cast<LayerItem*>(child)) {
+            if (!layerItem->layer()->isVisible())
+                continue;
+            childOpacity *= layerItem->layer()->opacity();
+        } else {
+            // Only layers are part of the group's rendering
+            if (item == root || !child->isVisibleTo(item))
+                continue;
+            childOpacity *= child->opacity();
+        }
+
+        QTransform transform;
+        QRectF childExposed = child->boundingRect();
+
+        if (child->flags() & QGraphicsItem::ItemIgnoresTransformations) {
+            const QPointF position = rootTransform.map(child->mapToItem(root, QPointF()));
+            transform = QTransform::fromTranslate(position.x(), position.y());
+        } else {
+            transform = child->itemTransform(root) * rootTransform;
+            childExposed &= child->mapRectFromItem(root, exposed);
+        }
+
+        if (!(child->flags() & QGraphicsItem::ItemHasNoContents) && !childExposed.isEmpty()) {
+            painter->save();
+            painter->setTransform(transform);
+            painter->setOpacity(childOpacity);
+
+            if (auto tileLayerItem = dynamic_cast<TileLayerItem*>(child)) {
+                // Render directly, to avoid filling the cache of the layer
+                const LayerPaintScope paintScope(tileLayerItem->tileLayer());
+                renderer->drawTileLayer(painter, tileLayerItem->tileLayer(), childExposed);
+            } else {
+                QStyleOptionGraphicsItem option;
+                option.exposedRect = childExposed;
+                option.rect = child->boundingRect().toAlignedRect();
+                child->paint(painter, &option, nullptr);
+            }
+
+            painter->restore();
+        }
+
+        // A frozen group draws its own children
+        if (auto groupItem = dynamic_cast<GroupLayerItem*>(child))
+            if (groupItem->isFrozen())
+                continue;
+
+        paintDescendants(painter, renderer, child, root, rootTransform, exposed, childOpacity);
+    }
+}
+
+/**
+ * Adds the bounding rectangles of the visible descendants of \a item, in
+ * the coordinates of \a root.
+ */
+void addDescendantBounds(QRectF &bounds, const QGraphicsItem *item, const QGraphicsItem *root)
+{
+    const auto children = item->childItems();
+    for (const QGraphicsItem *child : children) {
+        if (auto layerItem = dynamic_cast<const LayerItem*>(child)) {
+            if (!layerItem->layer()->isVisible())
+                continue;
+        } else if (item == root || !child->isVisibleTo(item)) {
+            continue;
+        }
+
+        if (child->flags() & QGraphicsItem::ItemIgnoresTransformations)
+            bounds |= child->boundingRect().translated(child->mapToItem(root, QPointF()));
+        else
+            bounds |= child->mapRectToItem(root, child->boundingRect());
+
+        addDescendantBounds(bounds, child, root);
+    }
+}
+
+} // anonymous namespace
+
+bool GroupLayerItem::BakeParameters::operator==(const BakeParameters &o) const
+{
+    return renderer == o.renderer &&
+            flags == o.flags &&
+            scale == o.scale &&
+            devicePixelRatio == o.devicePixelRatio &&
+            objectLineWidth == o.objectLineWidth &&
+            renderHints == o.renderHints;
+}
+
+GroupLayerItem::GroupLayerItem(GroupLayer *groupLayer, MapDocument *mapDocument,
+                               QGraphicsItem *parent)
     : LayerItem(groupLayer, parent)
+    , mMapDocument(mapDocument)
+    , mChunks(MaxChunkCacheCost)
 {
-    // Since we don't do any painting, we can spare us the call to paint()
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+
+    // Unless frozen, we don't do any painting, so we can spare us the call
+    // to paint()
     setFlag(QGraphicsItem::ItemHasNoContents);
 }
 
+/**
+ * Sets whether the rendering of this group layer is \a frozen.
+ *
+ * The visibility of the child layer items needs to be adjusted separately.
+ */
+void GroupLayerItem::setFrozen(bool frozen)
+{
+    if (mFrozen == frozen)
+        return;
+
+    mFrozen = frozen;
+    setFlag(QGraphicsItem::ItemHasNoContents, !frozen);
+
+    mChunks.clear();
+    mLayerPositions.clear();
+    updateBoundingRect();
+    update();
+}
+
+/**
+ * Discards all baked chunks and schedules a repaint.
+ */
+void GroupLayerItem::invalidate()
+{
+    if (!mFrozen)
+        return;
+
+    mChunks.clear();
+    updateBoundingRect();
+    update();
+}
+
+/**
+ * Discards the baked chunks intersecting the given \a rect (in item
+ * coordinates) and schedules a repaint of the area.
+ */
+void GroupLayerItem::invalidate(const QRectF &rect)
+{
+    if (!mFrozen)
+        return;
+
+    if (!mBoundingRect.contains(rect)) {
+        prepareGeometryChange();
+        mBoundingRect |= rect;
+    }
+
+    if (mBakeParameters.scale > 0) {
+        const qreal chunkSpan = ChunkSize / mBakeParameters.scale;
+        const int startX = static_cast<int>(std::floor(rect.left() / chunkSpan));
+        const int startY = static_cast<int>(std::floor(rect.top() / chunkSpan));
+        const int endX = static_cast<int>(std::floor(rect.right() / chunkSpan));
+        const int endY = static_cast<int>(std::floor(rect.bottom() / chunkSpan));
+
+        for (int y = startY; y <= endY; ++y)
+            for (int x = startX; x <= endX; ++x)
+                mChunks.remove(QPoint(x, y));
+    }
+
+    update(rect);
+}
+
 QRectF GroupLayerItem::boundingRect() const
 {
-    return QRectF();
+    return mBoundingRect;
 }
 
-void GroupLayerItem::paint(QPainter *,
-                           const QStyleOptionGraphicsItem *,
+void GroupLayerItem::paint(QPainter *painter,
+                           const QStyleOptionGraphicsItem *option,
                            QWidget *)
 {
+    if (!mFrozen)
+        return;
+
+    const QTransform transform = painter->transform();
+
+    // Chunks are only baked when the view is scaled uniformly
+    if (transform.type() > QTransform::TxScale ||
+            transform.m11() <= 0 || transform.m11() != transform.m22()) {
+        paintLayers(painter, option->exposedRect);
+        return;
+    }
+
+    const MapRenderer *renderer = mMapDocument->renderer();
+
+    BakeParameters parameters;
+    parameters.renderer = renderer;
+    parameters.flags = renderer->flags();
+    parameters.scale = transform.m11();
+    parameters.devicePixelRatio = painter->device()->devicePixelRatioF();
+    parameters.objectLineWidth = renderer->objectLineWidth();
+    parameters.renderHints = painter->renderHints();
+
+    if (parameters != mBakeParameters) {
+        mChunks.clear();
+        mBakeParameters = parameters;
+    }
+
+    // Child layers move relative to the group when they have a different
+    // parallax factor
+    QVector<QPointF> positions = layerPositions();
+    if (positions != mLayerPositions) {
+        mChunks.clear();
+        mLayerPositions.swap(positions);
+    }
+
+    const qreal chunkSpan = ChunkSize / parameters.scale;
+    const QRectF exposed = option->exposedRect & mBoundingRect;
+    if (exposed.isEmpty())
+        return;
+
+    const int startX = static_cast<int>(std::floor(exposed.left() / chunkSpan));
+    const int startY = static_cast<int>(std::floor(exposed.top() / chunkSpan));
+    const int endX = static_cast<int>(std::ceil(exposed.right() / chunkSpan));
+    const int endY = static_cast<int>(std::ceil(exposed.bottom() / chunkSpan));
+
+    // Baked chunks are drawn at whole pixels, to avoid resampling them
+    const QPoint origin(qRound(transform.dx()), qRound(transform.dy()));
+
+    painter->save();
+    painter->setTransform(QTransform());
+
+    for (int y = startY; y < endY; ++y) {
+        for (int x = startX; x < endX; ++x) {
+            const QPoint index(x, y);
+            const QPoint position = origin + index * ChunkSize;
+
+            if (const QPixmap *baked = mChunks.object(index)) {
+                painter->drawPixmap(position, *baked);
+                continue;
+            }
+
+            const QPixmap pixmap = bakeChunk(index, parameters);
+            painter->drawPixmap(position, pixmap);
+            mChunks.insert(index, new QPixmap(pixmap), cost(pixmap));
+        }
+    }
+
+    painter->restore();
+}
+
+QPixmap GroupLayerItem::bakeChunk(QPoint index, const BakeParameters &parameters)
+{
+    const qreal dpr = parameters.devicePixelRatio;
+    const qreal chunkSpan = ChunkSize / parameters.scale;
+    const QRectF rect(index.x() * chunkSpan, index.y() * chunkSpan, chunkSpan, chunkSpan);
+
+    QPixmap pixmap(QSize(ChunkSize, ChunkSize) * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHints(parameters.renderHints);
+    painter.scale(parameters.scale, parameters.scale);
+    painter.translate(-rect.topLeft());
+
+    paintLayers(&painter, rect);
+
+    return pixmap;
+}
+
+/**
+ * Paints the child layers directly, for the given \a exposed area in item
+ * coordinates.
+ */
+void GroupLayerItem::paintLayers(QPainter *painter, const QRectF &exposed)
+{
+    paintDescendants(painter, mMapDocument->renderer(),
+                     this, this, painter->transform(),
+                     exposed, painter->opacity());
+}
+
+/**
+ * Returns the positions of the child layer items, relative to this item.
+ */
+QVector<QPointF> GroupLayerItem::layerPositions() const
+{
+    QVector<QPointF> positions;
+
+    QList<QGraphicsItem*> items = childItems();
+    for (int i = 0; i < items.size(); ++i) {
+        const QGraphicsItem *item = items.at(i);
+        if (dynamic_cast<const LayerItem*>(item)) {
+            positions.append(item->mapToItem(this, QPointF()));
+            if (dynamic_cast<const GroupLayerItem*>(item))
+                items.append(item->childItems());
+        }
+    }
+
+    return positions;
+}
+
+void GroupLayerItem::updateBoundingRect()
+{
+    QRectF bounds;
+    if (mFrozen)
+        addDescendantBounds(bounds, this, this);
+
+    if (mBoundingRect != bounds) {
+        prepareGeometryChange();
+        mBoundingRect = bounds;
+    }
 }
 
 } // namespace Tiled
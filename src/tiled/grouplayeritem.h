@@ -23,21 +23,70 @@
 #include "layeritem.h"
 
 #include "grouplayer.h"
+#include "maprenderer.h"
+
+#include <QCache>
+#include <QPainter>
+#include <QVector>
 
 namespace Tiled {
 
+class MapDocument;
+
+/**
+ * A graphics item representing a group layer in a QGraphicsView.
+ *
+ * Normally the items of the child layers draw themselves. When the group
+ * layer is frozen, its child layer items are hidden and the group draws
+ * their contents from images that are rendered once at the current zoom
+ * level, in chunks of a fixed size. Changes to the child layers discard the
+ * affected chunks, which are rendered again when next painted.
+ */
 class GroupLayerItem : public LayerItem
 {
 public:
-    GroupLayerItem(GroupLayer *groupLayer, QGraphicsItem *parent = nullptr);
+    GroupLayerItem(GroupLayer *groupLayer, MapDocument *mapDocument,
+                   QGraphicsItem *parent = nullptr);
 
     GroupLayer *groupLayer() const;
 
+    bool isFrozen() const { return mFrozen; }
+    void setFrozen(bool frozen);
+
+    void invalidate();
+    void invalidate(const QRectF &rect);
+
     // QGraphicsItem
     QRectF boundingRect() const override;
     void paint(QPainter *painter,
                const QStyleOptionGraphicsItem *option,
                QWidget *widget = nullptr) override;
+
+private:
+    struct BakeParameters
+    {
+        const MapRenderer *renderer = nullptr;
+        RenderFlags flags;
+        qreal scale = 0;
+        qreal devicePixelRatio = 0;
+        qreal objectLineWidth = 0;
+        QPainter::RenderHints renderHints;
+
+        bool operator==(const BakeParameters &o) const;
+        bool operator!=(const BakeParameters &o) const { return !(*this == o); }
+    };
+
+    QPixmap bakeChunk(QPoint index, const BakeParameters &parameters);
+    void paintLayers(QPainter *painter, const QRectF &exposed);
+    QVector<QPointF> layerPositions() const;
+    void updateBoundingRect();
+
+    MapDocument *mMapDocument;
+    bool mFrozen = false;
+    QRectF mBoundingRect;
+    BakeParameters mBakeParameters;
+    QVector<QPointF> mLayerPositions;
+    QCache<QPoint, QPixmap> mChunks;
 };
 
 inline GroupLayer *GroupLayerItem::groupLayer() const
@@ -23,6 +23,7 @@
 
 #include "mapdocument.h"
 #include "maprenderer.h"
+#include "paintprofiler.h"
 
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
@@ -35,6 +36,12 @@ ImageLayerItem::ImageLayerItem(ImageLayer *layer, MapDocument *mapDocument, QGra
 {
     setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
 
+    // Image layers are often large backgrounds, which move relative to the
+    // view when scrolling with parallax. With the device coordinate cache,
+    // Qt keeps the visible part of the layer in a pixmap, which is scrolled
+    // along so that only the newly exposed parts are drawn again.
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+
     syncWithImageLayer();
 }
 
@@ -42,6 +49,15 @@ void ImageLayerItem::syncWithImageLayer()
 {
     prepareGeometryChange();
     mBoundingRect = mMapDocument->renderer()->boundingRect(imageLayer());
+
+    // Very large images are drawn from a pyramid of tiles instead
+    const QPixmap &image = imageLayer()->image();
+    if (ImagePyramid::isLarge(image.size())) {
+        if (!mPyramid || mPyramid->cacheKey() != image.cacheKey())
+            mPyramid = std::make_unique<ImagePyramid>(image);
+    } else {
+        mPyramid.reset();
+    }
 }
 
 QRectF ImageLayerItem::boundingRect() const
@@ -53,7 +69,22 @@ void ImageLayerItem::paint(QPainter *painter,
                            const QStyleOptionGraphicsItem *option,
                            QWidget *)
 {
+    const LayerPaintScope paintScope(imageLayer());
+
     // TODO: Display a border around the layer when selected
+    const ImageLayer *layer = imageLayer();
+    const QColor tintColor = layer->effectiveTintColor();
+    const bool tinted = tintColor.isValid() && tintColor != Qt::white;
+
+    // The pyramid does not support repeating or tinting the image
+    if (mPyramid && !layer->repeatX() && !layer->repeatY() && !tinted) {
+        const QRectF imageRect(QPointF(), mPyramid->size());
+        const QRectF rect = option->exposedRect.isNull() ? imageRect
+                                                         : imageRect & option->exposedRect;
+        mPyramid->draw(painter, rect, rect);
+        return;
+    }
+
     MapRenderer *renderer = mMapDocument->renderer();
     renderer->drawImageLayer(painter, imageLayer(), option->exposedRect);
 }
@@ -24,6 +24,9 @@
 #include "layeritem.h"
 
 #include "imagelayer.h"
+#include "imagepyramid.h"
+
+#include <memory>
 
 namespace Tiled {
 
@@ -64,6 +67,7 @@ public:
 private:
     MapDocument *mMapDocument;
     QRectF mBoundingRect;
+    std::unique_ptr<ImagePyramid> mPyramid;
 };
 
 inline ImageLayer *ImageLayerItem::imageLayer() const
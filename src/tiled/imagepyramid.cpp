@@ -0,0 +1,159 @@
+/*
+ * imagepyramid.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "imagepyramid.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Tiled {
+
+// Images larger than this in either direction are drawn from a pyramid
+static constexpr int LargeImageSize = 4096;
+
+// Keep up to 64 MB of tile pixmaps (the cost is in KB)
+static constexpr int MaxTileCacheCost = 64 * 1024;
+
+ImagePyramid::ImagePyramid(const QPixmap &image)
+    : mSize(image.size())
+    , mCacheKey(image.cacheKey())
+    , mTiles(MaxTileCacheCost)
+{
+    mLevels.append(image.toImage());
+
+    // Levels are added until the whole image fits in a single tile
+    QSize levelSize = mSize;
+    while (levelSize.width() > TileSize || levelSize.height() > TileSize) {
+        levelSize = QSize((levelSize.width() + 1) / 2, (levelSize.height() + 1) / 2);
+        ++mLevelCount;
+    }
+}
+
+/**
+ * Returns whether an image of the given \a size is large enough to be drawn
+ * using a pyramid.
+ */
+bool ImagePyramid::isLarge(QSize size)
+{
+    return size.width() > LargeImageSize || size.height() > LargeImageSize;
+}
+
+/**
+ * Draws the part \a sourceRect of the image into \a targetRect, using the
+ * level matching the scale at which it ends up on the device.
+ */
+void ImagePyramid::draw(QPainter *painter,
+                        const QRectF &targetRect,
+                        const QRectF &sourceRect) const
+{
+    const QRectF source = sourceRect & QRectF(QPointF(), mSize);
+    if (source.isEmpty() || targetRect.isEmpty())
+        return;
+
+    const qreal scaleX = targetRect.width() / sourceRect.width();
+    const qreal scaleY = targetRect.height() / sourceRect.height();
+    const qreal deviceScale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform())
+            * painter->device()->devicePixelRatioF()
+            * std::max(scaleX, scaleY);
+
+    const int level = levelForScale(deviceScale);
+    const int factor = 1 << level;
+    const int levelTileSize = TileSize * factor;    // in source pixels
+
+    const int firstX = int(source.left()) / levelTileSize;
+    const int firstY = int(source.top()) / levelTileSize;
+    const int lastX = int(std::ceil(source.right())) / levelTileSize;
+    const int lastY = int(std::ceil(source.bottom())) / levelTileSize;
+
+    for (int y = firstY; y <= lastY; ++y) {
+        for (int x = firstX; x <= lastX; ++x) {
+            const QRectF tileSource(x * levelTileSize, y * levelTileSize,
+                                    levelTileSize, levelTileSize);
+            const QRectF visible = tileSource & source;
+            if (visible.isEmpty())
+                continue;
+
+            const QPixmap pixmap = tile(level, x, y);
+            if (pixmap.isNull())
+                continue;
+
+            const QRectF pixmapSource((visible.x() - tileSource.x()) / factor,
+                                      (visible.y() - tileSource.y()) / factor,
+                                      visible.width() / factor,
+                                      visible.height() / factor);
+
+            const QRectF target(targetRect.x() + (visible.x() - sourceRect.x()) * scaleX,
+                                targetRect.y() + (visible.y() - sourceRect.y()) * scaleY,
+                                visible.width() * scaleX,
+                                visible.height() * scaleY);
+
+            painter->drawPixmap(target, pixmap, pixmapSource);
+        }
+    }
+}
+
+/**
+ * Returns the lowest resolution level that still has at least one pixel
+ * for each device pixel at the given \a scale.
+ */
+int ImagePyramid::levelForScale(qreal scale) const
+{
+    int level = 0;
+    while (level + 1 < mLevelCount && scale <= 0.5) {
+        scale *= 2;
+        ++level;
+    }
+    return level;
+}
+
+const QImage &ImagePyramid::levelImage(int level) const
+{
+    while (mLevels.size() <= level) {
+        const QImage &previous = mLevels.last();
+        mLevels.append(previous.scaled((previous.width() + 1) / 2,
+                                       (previous.height() + 1) / 2,
+                                       Qt::IgnoreAspectRatio,
+                                       Qt::SmoothTransformation));
+    }
+    return mLevels.at(level);
+}
+
+QPixmap ImagePyramid::tile(int level, int x, int y) const
+{
+    const quint64 key = (quint64(level) << 48) | (quint64(y) << 24) | quint64(x);
+    if (const QPixmap *cached = mTiles.object(key))
+        return *cached;
+
+    const QImage &image = levelImage(level);
+    const QRect rect = QRect(x * TileSize, y * TileSize, TileSize, TileSize) & image.rect();
+    if (rect.isEmpty())
+        return QPixmap();
+
+    const QPixmap pixmap = QPixmap::fromImage(image.copy(rect));
+    const int cost = std::max(1, int(qint64(rect.width()) * rect.height() * 4 / 1024));
+    mTiles.insert(key, new QPixmap(pixmap), cost);
+
+    return pixmap;
+}
+
+} // namespace Tiled
@@ -0,0 +1,71 @@
+/*
+ * imagepyramid.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QPixmap>
+#include <QVector>
+
+class QPainter;
+
+namespace Tiled {
+
+/**
+ * Draws a large image from a pyramid of tiles, in which each level has half
+ * the resolution of the previous one.
+ *
+ * Only the tiles of the level matching the current scale that are actually
+ * drawn are converted to pixmaps, and only the most recently used ones are
+ * kept. This avoids creating textures beyond the size supported by the
+ * graphics hardware, and scaling the whole image when zoomed out.
+ *
+ * The lower resolution levels are created when they are first needed.
+ */
+class ImagePyramid
+{
+public:
+    static constexpr int TileSize = 512;
+
+    explicit ImagePyramid(const QPixmap &image);
+
+    static bool isLarge(QSize size);
+
+    qint64 cacheKey() const { return mCacheKey; }
+    QSize size() const { return mSize; }
+
+    void draw(QPainter *painter,
+              const QRectF &targetRect,
+              const QRectF &sourceRect) const;
+
+private:
+    int levelForScale(qreal scale) const;
+    const QImage &levelImage(int level) const;
+    QPixmap tile(int level, int x, int y) const;
+
+    QSize mSize;
+    qint64 mCacheKey;
+    int mLevelCount = 1;
+    mutable QVector<QImage> mLevels;
+    mutable QCache<quint64, QPixmap> mTiles;
+};
+
+} // namespace Tiled
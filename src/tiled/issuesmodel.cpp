@@ -20,8 +20,14 @@
 
 #include "issuesmodel.h"
 
+#include <QMutexLocker>
+#include <QTimer>
+
 namespace Tiled {
 
+// Limits how often the buffered issues are added to the model
+static constexpr int FlushInterval = 100;   // ms
+
 IssuesModel::IssuesModel(QObject *parent)
     : QAbstractListModel(parent)
 {
@@ -33,8 +39,10 @@ IssuesModel::IssuesModel(QObject *parent)
     mWarningIcon.addFile(QLatin1String("://images/24/dialog-warning.png"));
     mWarningIcon.addFile(QLatin1String("://images/32/dialog-warning.png"));
 
+    // Direct connection, since addIssue takes care of getting the issue to
+    // the GUI thread
     connect(&LoggingInterface::instance(), &LoggingInterface::issue,
-            this, &IssuesModel::addIssue);
+            this, &IssuesModel::addIssue, Qt::DirectConnection);
     connect(&LoggingInterface::instance(), &LoggingInterface::removeIssuesWithContext,
             this, &IssuesModel::removeIssuesWithContext);
 }
@@ -45,30 +53,83 @@ IssuesModel &IssuesModel::instance()
     return issuesModel;
 }
 
+/**
+ * Queues the given \a issue to be added to the model. This function can be
+ * called from any thread.
+ */
 void IssuesModel::addIssue(const Issue &issue)
 {
-    int i = mIssues.indexOf(issue);
-    if (i != -1) {
-        auto &existingIssue = mIssues[i];
-        existingIssue.addOccurrence(issue);
+    QMutexLocker locker(&mPendingIssuesMutex);
 
-        QModelIndex modelIndex = index(i);
-        emit dataChanged(modelIndex, modelIndex);
-        return;
+    const bool scheduleFlush = mPendingIssues.isEmpty();
+    mPendingIssues.append(issue);
+
+    if (scheduleFlush) {
+        QMetaObject::invokeMethod(this, [this] {
+            QTimer::singleShot(FlushInterval, this, &IssuesModel::flushPendingIssues);
+        }, Qt::QueuedConnection);
+    }
+}
+
+/**
+ * Adds the queued issues to the model, combining them with existing issues
+ * where possible.
+ */
+void IssuesModel::flushPendingIssues()
+{
+    QVector<Issue> pendingIssues;
+    {
+        QMutexLocker locker(&mPendingIssuesMutex);
+        pendingIssues.swap(mPendingIssues);
     }
 
-    switch (issue.severity()) {
-    case Issue::Error: ++mErrorCount; break;
-    case Issue::Warning: ++mWarningCount; break;
+    if (pendingIssues.isEmpty())
+        return;
+
+    QVector<Issue> newIssues;
+    int firstChanged = mIssues.size();
+    int lastChanged = -1;
+
+    for (const Issue &issue : std::as_const(pendingIssues)) {
+        const IssueKey key = keyOf(issue);
+        const auto it = mIssueIndexes.constFind(key);
+
+        if (it != mIssueIndexes.constEnd()) {
+            const int i = it.value();
+
+            if (i < mIssues.size()) {
+                mIssues[i].addOccurrence(issue);
+                firstChanged = std::min(firstChanged, i);
+                lastChanged = std::max(lastChanged, i);
+            } else {
+                newIssues[i - mIssues.size()].addOccurrence(issue);
+            }
+            continue;
+        }
+
+        switch (issue.severity()) {
+        case Issue::Error: ++mErrorCount; break;
+        case Issue::Warning: ++mWarningCount; break;
+        }
+
+        mIssueIndexes.insert(key, mIssues.size() + newIssues.size());
+        newIssues.append(issue);
     }
 
-    beginInsertRows(QModelIndex(), mIssues.size(), mIssues.size());
-    mIssues.append(issue);
-    endInsertRows();
+    if (lastChanged != -1)
+        emit dataChanged(index(firstChanged), index(lastChanged));
+
+    if (!newIssues.isEmpty()) {
+        beginInsertRows(QModelIndex(), mIssues.size(), mIssues.size() + newIssues.size() - 1);
+        mIssues.append(newIssues);
+        endInsertRows();
+    }
 }
 
 void IssuesModel::removeIssues(const QList<unsigned> &issueIds)
 {
+    flushPendingIssues();
+
     RangeSet<int> indexes;
 
     for (unsigned id : issueIds) {
@@ -84,6 +145,9 @@ void IssuesModel::removeIssues(const QList<unsigned> &issueIds)
 
 void IssuesModel::removeIssuesWithContext(const void *context)
 {
+    // Pending issues may refer to the context as well
+    flushPendingIssues();
+
     RangeSet<int> indexes;
 
     for (int i = 0, size = mIssues.size(); i < size; ++i)
@@ -118,15 +182,32 @@ void IssuesModel::removeIssues(const RangeSet<int> &indexes)
         mIssues.remove(it.first(), it.length());
         endRemoveRows();
     } while (it != begin);
+
+    rebuildIndex();
+}
+
+void IssuesModel::rebuildIndex()
+{
+    mIssueIndexes.clear();
+    mIssueIndexes.reserve(mIssues.size());
+
+    for (int i = 0, size = mIssues.size(); i < size; ++i)
+        mIssueIndexes.insert(keyOf(mIssues.at(i)), i);
 }
 
 void IssuesModel::clear()
 {
+    {
+        QMutexLocker locker(&mPendingIssuesMutex);
+        mPendingIssues.clear();
+    }
+
     beginResetModel();
 
     mErrorCount = 0;
     mWarningCount = 0;
     mIssues.clear();
+    mIssueIndexes.clear();
 
     endResetModel();
 }
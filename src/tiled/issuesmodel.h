@@ -24,11 +24,22 @@
 #include "rangeset.h"
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QIcon>
+#include <QMutex>
+#include <QPair>
 #include <QVector>
 
 namespace Tiled {
 
+/**
+ * Model holding the reported issues.
+ *
+ * Issues can be reported from any thread. They are buffered and added to
+ * the model in batches, which keeps the editor responsive when thousands of
+ * issues are reported in a short time. Issues with the same severity and
+ * text are combined into a single entry.
+ */
 class IssuesModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -57,9 +68,20 @@ public:
     const QIcon &warningIcon() const;
 
 private:
+    using IssueKey = QPair<int, QString>;
+
+    static IssueKey keyOf(const Issue &issue)
+    { return IssueKey(issue.severity(), issue.text()); }
+
+    void flushPendingIssues();
     void removeIssues(const RangeSet<int> &indexes);
+    void rebuildIndex();
 
     QVector<Issue> mIssues;
+    QHash<IssueKey, int> mIssueIndexes;
+
+    QMutex mPendingIssuesMutex;
+    QVector<Issue> mPendingIssues;
 
     int mErrorCount = 0;
     int mWarningCount = 0;
@@ -356,8 +356,13 @@ void LayerView::onCollapsed(const QModelIndex &proxyIndex)
 void LayerView::restoreExpandedLayers()
 {
     const LayerModel *layerModel = mMapDocument->layerModel();
-    for (const int layerId : std::as_const(mMapDocument->expandedGroupLayers)) {
-        if (Layer *layer = mMapDocument->map()->findLayerById(layerId)) {
+    const auto &expandedGroupLayers = mMapDocument->expandedGroupLayers;
+    if (expandedGroupLayers.isEmpty())
+        return;
+
+    // Look up the expanded layers in a single pass over the group layers
+    for (Layer *layer : mMapDocument->map()->allLayers(Layer::GroupLayerType)) {
+        if (expandedGroupLayers.contains(layer->id())) {
             const QModelIndex sourceIndex = layerModel->index(layer);
             const QModelIndex index = mProxyModel->mapFromSource(sourceIndex);
             setExpanded(index, true);
@@ -481,6 +486,7 @@ void LayerView::contextMenuEvent(QContextMenuEvent *event)
         menu.addSeparator();
         menu.addAction(handler->actionToggleSelectedLayers());
         menu.addAction(handler->actionToggleLockSelectedLayers());
+        menu.addAction(handler->actionToggleFreezeSelectedLayers());
         menu.addAction(handler->actionToggleOtherLayers());
         menu.addAction(handler->actionToggleLockOtherLayers());
         menu.addSeparator();
@@ -31,6 +31,7 @@
 #include <QApplication>
 #include <QMimeData>
 #include <QStyle>
+#include <QVarLengthArray>
 
 #include <algorithm>
 
@@ -258,18 +259,30 @@ QMimeData *LayerModel::mimeData(const QModelIndexList &indexes) const
     QDataStream stream(&encodedData, QDataStream::WriteOnly);
 #endif
     QVector<Layer*> layers;
+    QHash<Layer*, int> globalIndexes;
 
     for (const QModelIndex &index : indexes) {
         if (Layer *layer = toLayer(index)) {
             // Make sure we only add each layer once
-            if (layers.contains(layer))
+            if (globalIndexes.contains(layer))
                 continue;
+            globalIndexes.insert(layer, -1);
             layers.append(layer);
-
-            stream << globalIndex(layer);
         }
     }
 
+    // Look up the global indexes in a single pass over the map
+    int layerIndex = 0;
+    for (Layer *layer : map()->allLayers()) {
+        auto it = globalIndexes.find(layer);
+        if (it != globalIndexes.end())
+            *it = layerIndex;
+        ++layerIndex;
+    }
+
+    for (Layer *layer : std::as_const(layers))
+        stream << globalIndexes.value(layer);
+
     mimeData->setData(QLatin1String(LAYERS_MIMETYPE), encodedData);
     return mimeData;
 }
@@ -299,11 +312,13 @@ bool LayerModel::dropMimeData(const QMimeData *data, Qt::DropAction action,
     QDataStream stream(encodedData);
     QList<Layer*> layers;
 
+    const QList<Layer*> allLayers = map()->allLayers().toList();
+
     while (!stream.atEnd()) {
-        int globalIndex;
-        stream >> globalIndex;
-        if (Layer *layer = layerAtGlobalIndex(map(), globalIndex))
-            layers.append(layer);
+        int layerIndex;
+        stream >> layerIndex;
+        if (layerIndex >= 0 && layerIndex < allLayers.size())
+            layers.append(allLayers.at(layerIndex));
     }
 
     if (layers.isEmpty())
@@ -332,15 +347,9 @@ QModelIndex LayerModel::index(Layer *layer, int column) const
 
     Q_ASSERT(layer->map() == map());
 
-    if (auto parentLayer = layer->parentLayer()) {
-        int row = parentLayer->layers().indexOf(layer);
-        Q_ASSERT(row != -1);
-        return createIndex(row, column, parentLayer);
-    }
-
-    int row = map()->layers().indexOf(layer);
+    const int row = rowOf(layer);
     Q_ASSERT(row != -1);
-    return createIndex(row, column, nullptr);
+    return createIndex(row, column, layer->parentLayer());
 }
 
 Layer *LayerModel::toLayer(const QModelIndex &index) const
@@ -370,6 +379,8 @@ void LayerModel::setMapDocument(MapDocument *mapDocument)
 
     beginResetModel();
     mMapDocument = mapDocument;
+    mRows.clear();
+    mPendingDataChanged.clear();
     endResetModel();
 }
 
@@ -379,12 +390,15 @@ void LayerModel::setMapDocument(MapDocument *mapDocument)
  */
 void LayerModel::insertLayer(GroupLayer *parentLayer, int index, Layer *layer)
 {
+    emitPendingDataChanged();
+
     QModelIndex parent = LayerModel::index(parentLayer);
     beginInsertRows(parent, index, index);
     if (parentLayer)
         parentLayer->insertLayer(index, layer);
     else
         map()->insertLayer(index, layer);
+    cacheRows(parentLayer);
     endInsertRows();
     emit layerAdded(layer);
 }
@@ -396,6 +410,8 @@ void LayerModel::insertLayer(GroupLayer *parentLayer, int index, Layer *layer)
  */
 Layer *LayerModel::takeLayerAt(GroupLayer *parentLayer, int index)
 {
+    emitPendingDataChanged();
+
     emit layerAboutToBeRemoved(parentLayer, index);
     QModelIndex parent = LayerModel::index(parentLayer);
     beginRemoveRows(parent, index, index);
@@ -404,6 +420,8 @@ Layer *LayerModel::takeLayerAt(GroupLayer *parentLayer, int index)
         layer = parentLayer->takeLayerAt(index);
     else
         layer = map()->takeLayerAt(index);
+    mRows.remove(layer);
+    cacheRows(parentLayer);
     endRemoveRows();
     emit layerRemoved(layer);
     return layer;
@@ -492,34 +510,32 @@ void LayerModel::toggleLockLayers(QList<Layer *> layers)
  */
 static QList<Layer *> collectAllSiblings(const QList<Layer *> &layers)
 {
-    QList<Layer *> todo = layers;
-    QSet<Layer *> collected;
-
-    // Collect all siblings and siblings of parents
-    while (!todo.isEmpty()) {
-        Layer *layer = todo.takeFirst();
-
-        const auto& siblings = layer->siblings();
-        for (Layer *sibling : siblings) {
-            collected.insert(sibling);
-            todo.removeOne(sibling);
-        }
-
-        Layer *parent = layer->parentLayer();
-        if (parent && !collected.contains(parent) && !todo.contains(parent))
-            todo.append(parent);
+    // Exclude input layers and their parents
+    QSet<const Layer *> excluded;
+    for (const Layer *layer : layers) {
+        for (; layer && !excluded.contains(layer); layer = layer->parentLayer())
+            excluded.insert(layer);
     }
 
-    // Exclude input layers and their parents
-    for (Layer *layer : layers) {
-        while (layer) {
-            if (!collected.remove(layer))
+    // Collect all siblings and siblings of parents, visiting each list of
+    // siblings only once (the top-level layers are identified by nullptr)
+    QSet<const GroupLayer *> visitedParents;
+    QList<Layer *> collected;
+
+    for (const Layer *layer : layers) {
+        for (; layer; layer = layer->parentLayer()) {
+            const GroupLayer *parent = layer->parentLayer();
+            if (visitedParents.contains(parent))
                 break;
-            layer = layer->parentLayer();
+            visitedParents.insert(parent);
+
+            for (Layer *sibling : layer->siblings())
+                if (!excluded.contains(sibling))
+                    collected.append(sibling);
         }
     }
 
-    return collected.values();
+    return collected;
 }
 
 /**
@@ -583,6 +599,8 @@ void LayerModel::documentChanged(const ChangeEvent &change)
     switch (change.type) {
     case ChangeEvent::DocumentAboutToReload:
         beginResetModel();
+        mRows.clear();
+        mPendingDataChanged.clear();
         break;
     case ChangeEvent::DocumentReloaded:
         endResetModel();
@@ -600,9 +618,7 @@ void LayerModel::documentChanged(const ChangeEvent &change)
 
         if (!columns.isEmpty()) {
             auto minMaxPair = std::minmax_element(columns.begin(), columns.end());
-            emit dataChanged(index(layerChange.layer, *minMaxPair.first),
-                             index(layerChange.layer, *minMaxPair.second));
-
+            scheduleDataChanged(layerChange.layer, *minMaxPair.first, *minMaxPair.second);
         }
 
         break;
@@ -612,6 +628,108 @@ void LayerModel::documentChanged(const ChangeEvent &change)
     }
 }
 
+/**
+ * Returns the row of the given \a layer among its siblings.
+ *
+ * Rows are cached, since the views look up the parent of each index they
+ * handle. A cached row is verified before it is used, so stale entries only
+ * cost a lookup.
+ */
+int LayerModel::rowOf(Layer *layer) const
+{
+    const auto &siblings = layer->siblings();
+
+    auto it = mRows.find(layer);
+    if (it != mRows.end() && *it < siblings.size() && siblings.at(*it) == layer)
+        return *it;
+
+    const int row = siblings.indexOf(layer);
+    mRows.insert(layer, row);
+    return row;
+}
+
+/**
+ * Updates the cached rows of the children of \a parentLayer, or of the
+ * top-level layers when \a parentLayer is nullptr.
+ */
+void LayerModel::cacheRows(GroupLayer *parentLayer)
+{
+    const auto &layers = parentLayer ? parentLayer->layers() : map()->layers();
+    for (int row = 0, rows = layers.size(); row < rows; ++row)
+        mRows.insert(layers.at(row), row);
+}
+
+/**
+ * Remembers that the given columns of \a layer changed. The changes are
+ * reported by emitPendingDataChanged(), so that changing many layers at once
+ * results in a few dataChanged signals for ranges of rows rather than one per
+ * layer.
+ */
+void LayerModel::scheduleDataChanged(Layer *layer, int firstColumn, int lastColumn)
+{
+    if (mPendingDataChanged.isEmpty())
+        QMetaObject::invokeMethod(this, &LayerModel::emitPendingDataChanged, Qt::QueuedConnection);
+
+    auto it = mPendingDataChanged.find(layer);
+    if (it == mPendingDataChanged.end()) {
+        mPendingDataChanged.insert(layer, { firstColumn, lastColumn });
+    } else {
+        it->first = std::min(it->first, firstColumn);
+        it->last = std::max(it->last, lastColumn);
+    }
+}
+
+/**
+ * Emits dataChanged for any pending changes, for each range of adjacent
+ * changed rows. Called before changes to the layer hierarchy, since the
+ * pending changes refer to the current rows.
+ */
+void LayerModel::emitPendingDataChanged()
+{
+    if (mPendingDataChanged.isEmpty())
+        return;
+
+    struct ChangedRows {
+        QVector<int> rows;
+        ChangedColumns columns { 0, 0 };
+    };
+
+    QHash<GroupLayer*, ChangedRows> changedRowsByParent;
+
+    for (auto it = mPendingDataChanged.cbegin(), end = mPendingDataChanged.cend(); it != end; ++it) {
+        Layer *layer = it.key();
+        auto &changed = changedRowsByParent[layer->parentLayer()];
+        if (changed.rows.isEmpty()) {
+            changed.columns = it.value();
+        } else {
+            changed.columns.first = std::min(changed.columns.first, it->first);
+            changed.columns.last = std::max(changed.columns.last, it->last);
+        }
+        changed.rows.append(rowOf(layer));
+    }
+
+    mPendingDataChanged.clear();
+
+    for (auto it = changedRowsByParent.begin(), end = changedRowsByParent.end(); it != end; ++it) {
+        const QModelIndex parent = index(it.key());
+        auto &rows = it->rows;
+        const auto &columns = it->columns;
+
+        std::sort(rows.begin(), rows.end());
+
+        for (int i = 0, count = rows.size(); i < count;) {
+            int last = i;
+            while (last + 1 < count && rows.at(last + 1) == rows.at(last) + 1)
+                ++last;
+
+            emit dataChanged(index(rows.at(i), columns.first, parent),
+                             index(rows.at(last), columns.last, parent));
+
+            i = last + 1;
+        }
+    }
+}
+
 Map *LayerModel::map() const
 {
     return mMapDocument->map();
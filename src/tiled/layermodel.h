@@ -21,6 +21,7 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QIcon>
 
 namespace Tiled {
@@ -98,10 +99,24 @@ signals:
 private:
     void documentChanged(const ChangeEvent &change);
 
+    int rowOf(Layer *layer) const;
+    void cacheRows(GroupLayer *parentLayer);
+
+    void scheduleDataChanged(Layer *layer, int firstColumn, int lastColumn);
+    void emitPendingDataChanged();
+
     Map *map() const;
 
     MapDocument *mMapDocument = nullptr;
 
+    struct ChangedColumns {
+        int first;
+        int last;
+    };
+
+    mutable QHash<const Layer*, int> mRows;
+    QHash<Layer*, ChangedColumns> mPendingDataChanged;
+
     QIcon mTileLayerIcon;
     QIcon mObjectGroupIcon;
     QIcon mImageLayerIcon;
@@ -50,14 +50,17 @@
 #include "mapformat.h"
 #include "mapscene.h"
 #include "mapview.h"
+#include "memoryreportdock.h"
 #include "minimaprenderer.h"
 #include "newmapdialog.h"
 #include "newsbutton.h"
 #include "newtilesetdialog.h"
 #include "offsetmapdialog.h"
+#include "paintprofiler.h"
 #include "projectdock.h"
 #include "projectmanager.h"
 #include "projectpropertiesdialog.h"
+#include "referenceindex.h"
 #include "propertytypeseditor.h"
 #include "resizedialog.h"
 #include "scriptmanager.h"
@@ -69,6 +72,7 @@
 #include "tileseteditor.h"
 #include "tilesetmanager.h"
 #include "tmxmapformat.h"
+#include "tracer.h"
 #include "utils.h"
 #include "world.h"
 #include "worlddocument.h"
@@ -93,6 +97,7 @@
 #include <QUndoStack>
 #include <QUndoView>
 #include <QVariantAnimation>
+#include <QtConcurrent>
 
 #ifdef Q_OS_WIN
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -301,6 +306,7 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     ActionManager::registerAction(mUi->actionSaveAs, "SaveAs");
     ActionManager::registerAction(mUi->actionShowGrid, "ShowGrid");
     ActionManager::registerAction(mUi->actionShowObjectReferences, "ShowObjectReferences");
+    ActionManager::registerAction(mUi->actionShowPerformanceOverlay, "ShowPerformanceOverlay");
     ActionManager::registerAction(mUi->actionShowTileAnimations, "ShowTileAnimations");
     ActionManager::registerAction(mUi->actionShowTileCollisionShapes, "ShowTileCollisionShapes");
     ActionManager::registerAction(mUi->actionShowTileObjectOutlines, "ShowTileObjectOutlines");
@@ -308,7 +314,9 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     ActionManager::registerAction(mUi->actionSnapToFineGrid, "SnapToFineGrid");
     ActionManager::registerAction(mUi->actionSnapToGrid, "SnapToGrid");
     ActionManager::registerAction(mUi->actionSnapToPixels, "SnapToPixels");
+    ActionManager::registerAction(mUi->actionStreamWorldMaps, "StreamWorldMaps");
     ActionManager::registerAction(mUi->actionTilesetProperties, "TilesetProperties");
+    ActionManager::registerAction(mUi->actionValidateProject, "ValidateProject");
     ActionManager::registerAction(mUi->actionZoomIn, "ZoomIn");
     ActionManager::registerAction(mUi->actionZoomNormal, "ZoomNormal");
     ActionManager::registerAction(mUi->actionZoomOut, "ZoomOut");
@@ -378,16 +386,21 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     ActionManager::registerAction(redoAction, "Redo");
 
     mProjectDock = new ProjectDock(this);   // uses some actions registered above
+    ProjectManager::instance()->referenceIndex()->setAutoUpdate(true);
     mConsoleDock = new ConsoleDock(this);
     mIssuesDock = new IssuesDock(this);
+    mMemoryReportDock = new MemoryReportDock(this);
 
     addDockWidget(Qt::LeftDockWidgetArea, mProjectDock);
     addDockWidget(Qt::BottomDockWidgetArea, mConsoleDock);
     addDockWidget(Qt::BottomDockWidgetArea, mIssuesDock);
+    addDockWidget(Qt::BottomDockWidgetArea, mMemoryReportDock);
     tabifyDockWidget(mConsoleDock, mIssuesDock);
+    tabifyDockWidget(mIssuesDock, mMemoryReportDock);
 
     mConsoleDock->setVisible(false);
     mIssuesDock->setVisible(false);
+    mMemoryReportDock->setVisible(false);
 
     mMapEditor = new MapEditor;
     mTilesetEditor = new TilesetEditor;
@@ -427,6 +440,7 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
 
     bindToOption(mUi->actionAutoMapWhileDrawing, AutomappingManager::automappingWhileDrawing);
     bindToOption(mUi->actionEnableWorlds, MapScene::enableWorlds);
+    bindToOption(mUi->actionStreamWorldMaps, MapScene::streamWorldMaps);
 
     mUi->actionHighlightCurrentLayer->setIcon(highlightCurrentLayerIcon);
     mUi->actionHighlightCurrentLayer->setIconVisibleInMenu(false);
@@ -511,6 +525,7 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     mLayerMenu->addSeparator();
     mLayerMenu->addAction(mActionHandler->actionToggleSelectedLayers());
     mLayerMenu->addAction(mActionHandler->actionToggleLockSelectedLayers());
+    mLayerMenu->addAction(mActionHandler->actionToggleFreezeSelectedLayers());
     mLayerMenu->addAction(mActionHandler->actionToggleOtherLayers());
     mLayerMenu->addAction(mActionHandler->actionToggleLockOtherLayers());
     mLayerMenu->addSeparator();
@@ -529,7 +544,7 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     connect(mUi->actionSearchActions, &QAction::triggered, this, &MainWindow::searchActions);
     connect(mUi->actionReopenClosedFile, &QAction::triggered, this, &MainWindow::reopenClosedFile);
     connect(mUi->actionClearRecentFiles, &QAction::triggered, preferences, &Preferences::clearRecentFiles);
-    connect(mUi->actionSave, &QAction::triggered, this, &MainWindow::saveFile);
+    connect(mUi->actionSave, &QAction::triggered, this, &MainWindow::saveFileInBackground);
     connect(mUi->actionSaveAs, &QAction::triggered, this, &MainWindow::saveFileAs);
     connect(mUi->actionSaveAll, &QAction::triggered, this, &MainWindow::saveAll);
     connect(mUi->actionExportAsImage, &QAction::triggered, this, &MainWindow::exportAsImage);
@@ -569,6 +584,8 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
             preferences, &Preferences::setHighlightCurrentLayer);
     connect(mUi->actionHighlightHoveredObject, &QAction::toggled,
             preferences, &Preferences::setHighlightHoveredObject);
+    connect(mUi->actionShowPerformanceOverlay, &QAction::toggled,
+            PaintProfiler::instance(), &PaintProfiler::setEnabled);
     connect(mUi->actionZoomIn, &QAction::triggered, this, &MainWindow::zoomIn);
     connect(mUi->actionZoomOut, &QAction::triggered, this, &MainWindow::zoomOut);
     connect(mUi->actionZoomNormal, &QAction::triggered, this, &MainWindow::zoomNormal);
@@ -685,6 +702,9 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     connect(mUi->actionRefreshProjectFolders, &QAction::triggered, mProjectDock, &ProjectDock::refreshProjectFolders);
     connect(mUi->actionClearRecentProjects, &QAction::triggered, preferences, &Preferences::clearRecentProjects);
     connect(mUi->actionProjectProperties, &QAction::triggered, this, &MainWindow::projectProperties);
+    connect(mUi->actionValidateProject, &QAction::triggered, this, &MainWindow::validateProject);
+    connect(&mProjectValidation, &QFutureWatcher<QVector<ProjectValidator::MapResult>>::finished,
+            this, &MainWindow::projectValidationFinished);
 
     connect(mUi->actionDocumentation, &QAction::triggered, this, &MainWindow::openDocumentation);
     connect(mUi->actionForum, &QAction::triggered, this, &MainWindow::openForum);
@@ -809,6 +829,7 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     mUi->menuTileset->insertSeparator(mUi->actionTilesetProperties);
     mUi->menuTileset->insertAction(mUi->actionTilesetProperties, mTilesetEditor->addTilesAction());
     mUi->menuTileset->insertAction(mUi->actionTilesetProperties, mTilesetEditor->removeTilesAction());
+    mUi->menuTileset->insertAction(mUi->actionTilesetProperties, mTilesetEditor->packIntoAtlasesAction());
     mUi->menuTileset->insertSeparator(mUi->actionTilesetProperties);
 
     connect(mViewsAndToolbarsMenu, &QMenu::aboutToShow,
@@ -839,6 +860,10 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     connect(mDocumentManager, &DocumentManager::currentEditorChanged,
             this, &MainWindow::currentEditorChanged);
 
+    // Connected after the DocumentManager, which stores the open documents
+    connect(preferences, &Preferences::aboutToSwitchSession,
+            this, &MainWindow::keepUnrestoredSessionFiles);
+
     connect(mResetToDefaultLayout, &QAction::triggered, this, &MainWindow::resetToDefaultLayout);
     connect(mLockLayout, &QAction::toggled, this, &MainWindow::setLayoutLocked);
 
@@ -1076,15 +1101,19 @@ bool MainWindow::openFile(const QString &fileName, FileFormat *fileFormat)
     }
 
     mDocumentManager->addDocument(document);
+    checkOpenedDocument(document.data());
 
-    if (auto mapDocument = qobject_cast<MapDocument*>(document.data())) {
+    return true;
+}
+
+void MainWindow::checkOpenedDocument(Document *document)
+{
+    if (auto mapDocument = qobject_cast<MapDocument*>(document)) {
         mDocumentManager->checkTilesetColumns(mapDocument);
-    } else if (auto tilesetDocument = qobject_cast<TilesetDocument*>(document.data())) {
+    } else if (auto tilesetDocument = qobject_cast<TilesetDocument*>(document)) {
         mDocumentManager->checkTilesetColumns(tilesetDocument);
         tilesetDocument->tileset()->syncExpectedColumnsAndRows();
     }
-
-    return true;
 }
 
 void MainWindow::openFileDialog()
@@ -1173,6 +1202,26 @@ bool MainWindow::saveFile()
         return mDocumentManager->saveDocument(document, currentFileName);
 }
 
+/**
+ * Like saveFile(), but allows large maps to be written in the background, so
+ * that editing can continue. Used for the Save action.
+ */
+void MainWindow::saveFileInBackground()
+{
+    Document *document = mDocumentManager->currentDocument();
+    if (!document)
+        return;
+
+    document = saveAsDocument(document);
+
+    const QString currentFileName = document->fileName();
+
+    if (currentFileName.isEmpty() || !document->writerFormat())
+        mDocumentManager->saveDocumentAs(document);
+    else
+        mDocumentManager->saveDocumentInBackground(document, currentFileName);
+}
+
 bool MainWindow::saveFileAs()
 {
     Document *document = mDocumentManager->currentDocument();
@@ -1224,6 +1273,10 @@ void MainWindow::saveAll()
 
 bool MainWindow::confirmSave(Document *document)
 {
+    // A save in progress may leave nothing to confirm
+    if (auto mapDocument = qobject_cast<MapDocument*>(document))
+        mapDocument->waitForBackgroundSave();
+
     if (!document || !mDocumentManager->isDocumentModified(document))
         return true;
 
@@ -1376,6 +1429,7 @@ void MainWindow::closeFile()
 bool MainWindow::closeAllFiles()
 {
     if (confirmAllSave()) {
+        mSessionFilesToRestore.clear();
         mDocumentManager->closeAllDocuments();
         return true;
     }
@@ -1475,15 +1529,34 @@ bool MainWindow::switchProject(std::unique_ptr<Project> project)
 
 void MainWindow::restoreSession()
 {
+    TraceScope trace("Restore session");
+
     const auto &session = Session::current();
 
     // Copy values because the session will get changed while restoring it
     const auto openFiles = session.openFiles;
     const auto activeFile = session.activeFile;
 
-    for (const QString &file : openFiles)
-        openFile(file);
-    mDocumentManager->switchToDocument(activeFile);
+    // Open the active file first, so that it can be used as soon as possible.
+    // The other files are opened one at a time in the background.
+    const bool hasActiveFile = openFiles.contains(activeFile);
+    bool beforeActiveFile = hasActiveFile;
+
+    mSessionFilesToRestore.clear();
+    mSessionActiveFile = activeFile;
+
+    for (const QString &file : openFiles) {
+        if (hasActiveFile && file == activeFile)
+            beforeActiveFile = false;
+        else
+            mSessionFilesToRestore.append(SessionFile { file, beforeActiveFile });
+    }
+
+    if (hasActiveFile)
+        openFile(activeFile);
+
+    if (!mSessionFilesToRestore.isEmpty())
+        QMetaObject::invokeMethod(this, &MainWindow::restoreNextSessionFile, Qt::QueuedConnection);
 
     WorldManager::instance().loadWorlds(mLoadedWorlds);
 
@@ -1493,6 +1566,70 @@ void MainWindow::restoreSession()
         openProjectExtensionsPopup();
 }
 
+/**
+ * Opens the next file remaining from the restored session, without switching
+ * to it. The files that were before the active file in the session are
+ * inserted before it, to restore the original order of the tabs.
+ */
+void MainWindow::restoreNextSessionFile()
+{
+    if (mSessionFilesToRestore.isEmpty())
+        return;
+
+    const SessionFile sessionFile = mSessionFilesToRestore.takeFirst();
+
+    if (mDocumentManager->findDocument(sessionFile.fileName) == -1) {
+        QString error;
+        DocumentPtr document = mDocumentManager->loadDocument(sessionFile.fileName, nullptr, &error);
+
+        if (document) {
+            int index = mDocumentManager->documents().size();
+            if (sessionFile.beforeActiveFile) {
+                const int activeIndex = mDocumentManager->findDocument(mSessionActiveFile);
+                if (activeIndex != -1)
+                    index = activeIndex;
+            }
+
+            mDocumentManager->insertDocument(index, document);
+            checkOpenedDocument(document.data());
+        } else {
+            QMessageBox::critical(this,
+                                  tr("Error Opening File"),
+                                  tr("Error opening '%1':\n%2").arg(sessionFile.fileName, error));
+        }
+    }
+
+    if (!mSessionFilesToRestore.isEmpty())
+        QMetaObject::invokeMethod(this, &MainWindow::restoreNextSessionFile, Qt::QueuedConnection);
+}
+
+/**
+ * Makes sure the files that weren't restored yet remain part of the session
+ * when it is stored, in their original place.
+ */
+void MainWindow::keepUnrestoredSessionFiles()
+{
+    if (mSessionFilesToRestore.isEmpty())
+        return;
+
+    auto &session = Session::current();
+    QStringList openFiles = session.openFiles;
+    int activeIndex = openFiles.indexOf(mSessionActiveFile);
+
+    for (const SessionFile &sessionFile : std::as_const(mSessionFilesToRestore)) {
+        if (openFiles.contains(sessionFile.fileName))
+            continue;
+
+        if (sessionFile.beforeActiveFile && activeIndex != -1)
+            openFiles.insert(activeIndex++, sessionFile.fileName);
+        else
+            openFiles.append(sessionFile.fileName);
+    }
+
+    session.setOpenFiles(openFiles);
+    mSessionFilesToRestore.clear();
+}
+
 void MainWindow::projectProperties()
 {
     Project &project = ProjectManager::instance()->project();
@@ -1509,6 +1646,46 @@ void MainWindow::projectProperties()
     }
 }
 
+/**
+ * Checks all maps in the project folders in the background. The problems
+ * found are reported in the Issues view once done.
+ */
+void MainWindow::validateProject()
+{
+    const Project &project = ProjectManager::instance()->project();
+    if (project.folders().isEmpty() || mProjectValidation.isRunning())
+        return;
+
+    statusBar()->showMessage(tr("Validating maps..."));
+
+    const ProjectValidator validator(project);
+    mProjectValidation.setFuture(QtConcurrent::run([validator] {
+        return validator.validate();
+    }));
+
+    updateActions();
+}
+
+void MainWindow::projectValidationFinished()
+{
+    const QVector<ProjectValidator::MapResult> results = mProjectValidation.result();
+    ProjectValidator::report(results);
+
+    int problemCount = 0;
+    for (const ProjectValidator::MapResult &result : results)
+        problemCount += result.problems.size();
+
+    statusBar()->showMessage(tr("Validated %n map(s)", nullptr, results.size()) + QLatin1String(", ") +
+                             tr("found %n problem(s)", nullptr, problemCount), 3000);
+
+    if (problemCount > 0) {
+        mIssuesDock->show();
+        mIssuesDock->raise();
+    }
+
+    updateActions();
+}
+
 void MainWindow::cut()
 {
     if (auto editor = mDocumentManager->currentEditor())
@@ -2092,13 +2269,17 @@ void MainWindow::resetToDefaultLayout()
     mProjectDock->setFloating(false);
     mConsoleDock->setFloating(false);
     mIssuesDock->setFloating(false);
+    mMemoryReportDock->setFloating(false);
     addDockWidget(Qt::LeftDockWidgetArea, mProjectDock);
     addDockWidget(Qt::BottomDockWidgetArea, mConsoleDock);
     addDockWidget(Qt::BottomDockWidgetArea, mIssuesDock);
+    addDockWidget(Qt::BottomDockWidgetArea, mMemoryReportDock);
     mProjectDock->setVisible(true);
     mConsoleDock->setVisible(false);
     mIssuesDock->setVisible(false);
+    mMemoryReportDock->setVisible(false);
     tabifyDockWidget(mConsoleDock, mIssuesDock);
+    tabifyDockWidget(mIssuesDock, mMemoryReportDock);
 
     // Reset the layout of the current editor
     if (auto editor = mDocumentManager->currentEditor())
@@ -2112,6 +2293,7 @@ void MainWindow::updateViewsAndToolbarsMenu()
     mViewsAndToolbarsMenu->addAction(mProjectDock->toggleViewAction());
     mViewsAndToolbarsMenu->addAction(mConsoleDock->toggleViewAction());
     mViewsAndToolbarsMenu->addAction(mIssuesDock->toggleViewAction());
+    mViewsAndToolbarsMenu->addAction(mMemoryReportDock->toggleViewAction());
 
     if (Editor *editor = mDocumentManager->currentEditor()) {
         mViewsAndToolbarsMenu->addSeparator();
@@ -2180,6 +2362,7 @@ void MainWindow::updateActions()
     mUi->actionAddFolderToProject->setEnabled(hasProject);
     mUi->actionRefreshProjectFolders->setEnabled(projectHasFolders);
     mUi->actionProjectProperties->setEnabled(hasProject);
+    mUi->actionValidateProject->setEnabled(projectHasFolders && !mProjectValidation.isRunning());
     mShowPropertyTypesEditor->setEnabled(hasProject);
 }
 
@@ -27,9 +27,11 @@
 #include "preferences.h"
 #include "preferencesdialog.h"
 #include "project.h"
+#include "projectvalidator.h"
 #include "session.h"
 #include "tilededitor_global.h"
 
+#include <QFutureWatcher>
 #include <QMainWindow>
 #include <QPointer>
 #include <QSessionManager>
@@ -52,6 +54,7 @@ class ConsoleDock;
 class DocumentManager;
 class Editor;
 class IssuesDock;
+class MemoryReportDock;
 class LocatorSource;
 class LocatorWidget;
 class MapDocument;
@@ -118,6 +121,7 @@ private:
     void searchActions();
     void showLocatorWidget(LocatorSource *source);
     bool saveFile();
+    void saveFileInBackground();
     bool saveFileAs();
     void saveAll();
     void export_(); // 'export' is a reserved word
@@ -133,7 +137,11 @@ private:
     bool closeProject();
     bool switchProject(std::unique_ptr<Project> project);
     void restoreSession();
+    void restoreNextSessionFile();
+    void keepUnrestoredSessionFiles();
     void projectProperties();
+    void validateProject();
+    void projectValidationFinished();
 
     void cut();
     void copy();
@@ -167,6 +175,8 @@ private:
 
     void editTilesetProperties();
 
+    void checkOpenedDocument(Document *document);
+
     void updateWindowTitle();
     void updateActions();
     void updateZoomable();
@@ -237,6 +247,7 @@ private:
     ConsoleDock *mConsoleDock;
     ProjectDock *mProjectDock;
     IssuesDock *mIssuesDock;
+    MemoryReportDock *mMemoryReportDock;
     PropertyTypesEditor *mPropertyTypesEditor;
     QPointer<LocatorWidget> mLocatorWidget;
     QPointer<QWidget> mPopupWidget;
@@ -269,6 +280,18 @@ private:
 
     SessionOption<QStringList> mLoadedWorlds { "loadedWorlds" };
 
+    struct SessionFile
+    {
+        QString fileName;
+        bool beforeActiveFile;
+    };
+
+    // Files of the session that remain to be opened in the background
+    QVector<SessionFile> mSessionFilesToRestore;
+    QString mSessionActiveFile;
+
+    QFutureWatcher<QVector<ProjectValidator::MapResult>> mProjectValidation;
+
     static MainWindow *mInstance;
 };
 
@@ -41,6 +41,8 @@
 #include "issuesmodel.h"
 #include "layermodel.h"
 #include "logginginterface.h"
+#include "mapdiff.h"
+#include "mapwriter.h"
 #include "mapobject.h"
 #include "mapobjectmodel.h"
 #include "maprenderer.h"
@@ -59,6 +61,8 @@
 #include "tile.h"
 #include "tilelayer.h"
 #include "tilesetdocument.h"
+#include "tmxmapformat.h"
+#include "tracer.h"
 #include "transformmapobjects.h"
 
 #include <QFileInfo>
@@ -66,6 +70,10 @@
 #include <QSet>
 #include <QString>
 #include <QUndoStack>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <utility>
 
 using namespace Tiled;
 
@@ -119,6 +127,13 @@ MapDocument::MapDocument(std::unique_ptr<Map> map)
     connect(this, &Document::changed,
             this, &MapDocument::onChanged);
 
+    connect(undoStack(), &QUndoStack::indexChanged, this, [this] {
+        if (isSavingInBackground())
+            mChangedDuringBackgroundSave = true;
+    });
+    connect(&mBackgroundSave, &QFutureWatcher<SaveResult>::finished,
+            this, &MapDocument::finishBackgroundSave);
+
     connect(mMapObjectModel, &QAbstractItemModel::rowsInserted,
             this, &MapDocument::onMapObjectModelRowsInserted);
     connect(mMapObjectModel, &QAbstractItemModel::rowsRemoved,
@@ -135,6 +150,9 @@ MapDocument::~MapDocument()
     // Clear any previously found issues in this document
     IssuesModel::instance().removeIssuesWithContext(this);
 
+    // Make sure a save in progress is completed
+    mBackgroundSave.waitForFinished();
+
     // Needs to be deleted before the Map instance is deleted, because it may
     // cause script values to detach from the map, in which case they'll need
     // to be able to copy the data.
@@ -143,6 +161,8 @@ MapDocument::~MapDocument()
 
 bool MapDocument::save(const QString &fileName, QString *error)
 {
+    waitForBackgroundSave();
+
     MapFormat *mapFormat = writerFormat();
     if (!mapFormat) {
         if (error)
@@ -157,7 +177,106 @@ bool MapDocument::save(const QString &fileName, QString *error)
     }
 
     undoStack()->setClean();
+    finishSave(fileName);
+    return true;
+}
+
+/**
+ * Returns whether this map can be saved using saveInBackground().
+ *
+ * This is currently limited to the TMX format, since other formats may not
+ * be safe to use from another thread. Maps with embedded tilesets are
+ * excluded, because those tilesets could be changed while they are being
+ * written.
+ */
+bool MapDocument::canSaveInBackground() const
+{
+    if (!dynamic_cast<TmxMapFormat*>(writerFormat()))
+        return false;
+
+    for (const SharedTileset &tileset : mMap->tilesets())
+        if (!tileset->isExternal())
+            return false;
+
+    return true;
+}
+
+/**
+ * Saves a snapshot of the map to \a fileName on the global thread pool, so
+ * that editing can continue while the map is written. The
+ * backgroundSaveFinished() signal is emitted once done.
+ *
+ * Should only be called when canSaveInBackground() returns true.
+ */
+void MapDocument::saveInBackground(const QString &fileName)
+{
+    Q_ASSERT(canSaveInBackground());
+
+    waitForBackgroundSave();
+
+    // Cheap, since the tile layer data is implicitly shared. The snapshot is
+    // owned here, so that it is destroyed on the main thread.
+    mBackgroundSaveSnapshot = mMap->clone();
+    mBackgroundSaveFileName = fileName;
+    mChangedDuringBackgroundSave = false;
+
+    const Map *snapshot = mBackgroundSaveSnapshot.get();
+
+    mBackgroundSave.setFuture(QtConcurrent::run([snapshot, fileName] {
+        MapWriter writer;
+
+        SaveResult result;
+        result.success = writer.writeMap(snapshot, fileName);
+        if (!result.success)
+            result.error = writer.errorString();
+        return result;
+    }));
+}
+
+bool MapDocument::isSavingInBackground() const
+{
+    return !mBackgroundSaveFileName.isEmpty();
+}
+
+/**
+ * Blocks until a save started with saveInBackground() has finished, and
+ * processes its result.
+ */
+void MapDocument::waitForBackgroundSave()
+{
+    if (!isSavingInBackground())
+        return;
+
+    mBackgroundSave.waitForFinished();
+    finishBackgroundSave();
+}
+
+void MapDocument::finishBackgroundSave()
+{
+    if (!isSavingInBackground())
+        return;     // already handled by waitForBackgroundSave
+
+    const QString fileName = std::exchange(mBackgroundSaveFileName, QString());
+    const SaveResult result = mBackgroundSave.result();
+    mBackgroundSaveSnapshot.reset();
+
+    if (result.success) {
+        // Changes made during the save are not part of the saved file
+        if (!mChangedDuringBackgroundSave)
+            undoStack()->setClean();
+
+        finishSave(fileName);
+    }
+
+    emit backgroundSaveFinished(result.success, result.error);
+}
 
+/**
+ * Updates the state of the document after it has been saved to
+ * \a fileName.
+ */
+void MapDocument::finishSave(const QString &fileName)
+{
     if (mMap->fileName != fileName) {
         mMap->fileName = fileName;
         mMap->exportFileName.clear();
@@ -174,7 +293,6 @@ bool MapDocument::save(const QString &fileName, QString *error)
     }
 
     emit saved();
-    return true;
 }
 
 bool MapDocument::canReload() const
@@ -187,6 +305,8 @@ bool MapDocument::reload(QString *error)
     if (!canReload())
         return false;
 
+    waitForBackgroundSave();
+
     auto format = findFileFormat<MapFormat>(mReaderFormat, FileFormat::Read);
     if (!format) {
         if (error)
@@ -204,7 +324,29 @@ bool MapDocument::reload(QString *error)
 
     map->fileName = fileName();
 
-    undoStack()->push(new ReloadMap(this, std::move(map)));
+    // When only the contents of tile layers changed, the differences are
+    // painted onto the existing layers. This keeps the scene intact, whereas
+    // swapping the map rebuilds it completely.
+    const bool sameTilesets = mMap->tilesets() == map->tilesets();
+    const MapDiff diff = sameTilesets ? MapDiff::compare(*mMap, *map) : MapDiff();
+
+    if (sameTilesets && diff.hasOnlyCellChanges()) {
+        if (!diff.isEmpty()) {
+            auto command = new PaintTileLayer(this);
+            command->setText(QCoreApplication::translate("Undo Commands", "Reload Map"));
+
+            for (const LayerDiff &layerDiff : diff.layers) {
+                auto layer = static_cast<TileLayer*>(mMap->findLayerById(layerDiff.id));
+                auto reloadedLayer = static_cast<TileLayer*>(map->findLayerById(layerDiff.id));
+                command->paint(layer, 0, 0, reloadedLayer, layerDiff.changedCells);
+            }
+
+            undoStack()->push(command);
+        }
+    } else {
+        undoStack()->push(new ReloadMap(this, std::move(map)));
+    }
+
     undoStack()->setClean();
 
     mLastSaved = QFileInfo(fileName()).lastModified();
@@ -217,6 +359,8 @@ MapDocumentPtr MapDocument::load(const QString &fileName,
                                  MapFormat *format,
                                  QString *error)
 {
+    TraceScope trace("Load map", fileName);
+
     auto map = format->read(fileName);
 
     if (!map) {
@@ -894,6 +1038,41 @@ void MapDocument::toggleLockOtherLayers(const QList<Layer *> &layers)
     mLayerModel->toggleLockOtherLayers(layers);
 }
 
+/**
+ * Freezes the rendering of the group layers among the given \a layers, or
+ * unfreezes them when they are all frozen already.
+ *
+ * The contents of a frozen group layer are drawn from cached images. This
+ * is an editor setting and does not affect the map data.
+ */
+void MapDocument::toggleFreezeLayers(const QList<Layer *> &layers)
+{
+    QList<GroupLayer*> groupLayers;
+    for (Layer *layer : layers)
+        if (GroupLayer *groupLayer = layer->asGroupLayer())
+            groupLayers.append(groupLayer);
+
+    const bool freeze = std::any_of(groupLayers.begin(), groupLayers.end(),
+                                    [this] (GroupLayer *groupLayer) { return !isLayerFrozen(groupLayer); });
+
+    for (GroupLayer *groupLayer : std::as_const(groupLayers)) {
+        if (isLayerFrozen(groupLayer) == freeze)
+            continue;
+
+        if (freeze)
+            frozenGroupLayers.insert(groupLayer->id());
+        else
+            frozenGroupLayers.remove(groupLayer->id());
+
+        emit layerFrozenChanged(groupLayer);
+    }
+}
+
+bool MapDocument::isLayerFrozen(const Layer *layer) const
+{
+    return layer->isGroupLayer() && frozenGroupLayers.contains(layer->id());
+}
+
 
 /**
  * Adds a tileset to this map at the given \a index. Emits the appropriate
@@ -1186,7 +1365,7 @@ void MapDocument::replaceObjectTemplate(const ObjectTemplate *oldObjectTemplate,
     auto changedObjects = mMap->replaceObjectTemplate(oldObjectTemplate, newObjectTemplate);
 
     // Update the objects in the map scene
-    emit changed(MapObjectsChangeEvent(std::move(changedObjects)));
+    emitChanged(MapObjectsChangeEvent(std::move(changedObjects)));
     emit objectTemplateReplaced(newObjectTemplate, oldObjectTemplate);
 }
 
@@ -1221,7 +1400,9 @@ QList<Layer *> MapDocument::selectedLayersOrdered() const
     return sortLayers(*mMap, mSelectedLayers);
 }
 
-static QList<MapObject *> sortObjects(const Map &map, const QList<MapObject *> &objects)
+static QList<MapObject *> sortObjects(const Map &map,
+                                      const QList<MapObject *> &objects,
+                                      const QSet<MapObject *> &objectsSet)
 {
     if (objects.size() < 2)
         return objects;
@@ -1235,7 +1416,7 @@ static QList<MapObject *> sortObjects(const Map &map, const QList<MapObject *> &
             continue;
 
         for (MapObject *mapObject : static_cast<ObjectGroup*>(layer)->objects()) {
-            if (objects.contains(mapObject))
+            if (objectsSet.contains(mapObject))
                 sorted.append(mapObject);
         }
     }
@@ -1249,13 +1430,29 @@ static QList<MapObject *> sortObjects(const Map &map, const QList<MapObject *> &
  */
 QList<MapObject *> MapDocument::selectedObjectsOrdered() const
 {
-    return sortObjects(*mMap, mSelectedObjects);
+    return sortObjects(*mMap, mSelectedObjects, mSelectedObjectsSet);
 }
 
 void MapDocument::setSelectedObjects(const QList<MapObject *> &selectedObjects)
 {
+    QSet<MapObject*> selectedObjectsSet;
+    selectedObjectsSet.reserve(selectedObjects.size());
+    for (MapObject *object : selectedObjects)
+        selectedObjectsSet.insert(object);
+
+    QSet<MapObject*> added;
+    QSet<MapObject*> removed;
+
+    for (MapObject *object : std::as_const(selectedObjectsSet))
+        if (!mSelectedObjectsSet.contains(object))
+            added.insert(object);
+    for (MapObject *object : std::as_const(mSelectedObjectsSet))
+        if (!selectedObjectsSet.contains(object))
+            removed.insert(object);
+
     mSelectedObjects = selectedObjects;
-    emit selectedObjectsChanged();
+    mSelectedObjectsSet.swap(selectedObjectsSet);
+    emit selectedObjectsChanged(added, removed);
 
     ObjectGroup *singleObjectGroup = nullptr;
     for (MapObject *object : selectedObjects) {
@@ -1277,7 +1474,7 @@ void MapDocument::setSelectedObjects(const QList<MapObject *> &selectedObjects)
     // Make sure the current object is one of the selected ones
     if (!selectedObjects.isEmpty()) {
         if (currentObject() && currentObject()->typeId() == Object::MapObjectType) {
-            if (selectedObjects.contains(static_cast<MapObject*>(currentObject())))
+            if (isObjectSelected(static_cast<MapObject*>(currentObject())))
                 return;
         }
 
@@ -1525,6 +1722,9 @@ void MapDocument::onLayerAboutToBeRemoved(GroupLayer *groupLayer, int index)
 {
     Layer *layer = groupLayer ? groupLayer->layerAt(index) : mMap->layerAt(index);
 
+    // Pending changes may refer to objects on this layer
+    flushPendingChanges();
+
     // Deselect any objects on this layer when necessary
     if (layer->isObjectGroup() || layer->isGroupLayer()) {
         QList<MapObject*> objects;
@@ -1687,25 +1887,23 @@ void MapDocument::swapMap(std::unique_ptr<Map> &other)
 void MapDocument::updateTemplateInstances(const ObjectTemplate *objectTemplate)
 {
     QList<MapObject*> objectList;
-    for (Layer *layer : mMap->objectGroups()) {
-        for (auto object : static_cast<ObjectGroup*>(layer)->objects()) {
-            if (object->objectTemplate() == objectTemplate) {
-                object->syncWithTemplate();
-                objectList.append(object);
-            }
+    for (MapObject *object : objectTemplate->instances()) {
+        if (object->map() == mMap.get()) {
+            object->syncWithTemplate();
+            objectList.append(object);
         }
     }
-    emit changed(MapObjectsChangeEvent(std::move(objectList)));
+
+    if (!objectList.isEmpty())
+        emitChanged(MapObjectsChangeEvent(std::move(objectList)));
 }
 
 void MapDocument::selectAllInstances(const ObjectTemplate *objectTemplate)
 {
     QList<MapObject*> objectList;
-    for (Layer *layer : mMap->objectGroups()) {
-        for (auto object : static_cast<ObjectGroup*>(layer)->objects())
-            if (object->objectTemplate() == objectTemplate)
-                objectList.append(object);
-    }
+    for (MapObject *object : objectTemplate->instances())
+        if (object->map() == mMap.get())
+            objectList.append(object);
     setSelectedObjects(objectList);
 }
 
@@ -1722,18 +1920,33 @@ void MapDocument::deselectObjects(const QList<MapObject *> &objects)
         if (objects.contains(static_cast<MapObject*>(mCurrentObject)))
             setCurrentObject(nullptr);
 
-    int removedSelectedObjects = 0;
-    int removedAboutToBeSelectedObjects = 0;
+    QSet<MapObject*> objectsSet;
+    objectsSet.reserve(objects.size());
+    for (MapObject *object : objects)
+        objectsSet.insert(object);
 
-    for (MapObject *object : objects) {
-        removedSelectedObjects += mSelectedObjects.removeAll(object);
-        removedAboutToBeSelectedObjects += mAboutToBeSelectedObjects.removeAll(object);
+    const auto isDeselected = [&] (MapObject *object) { return objectsSet.contains(object); };
+
+    QSet<MapObject*> removed;
+    for (MapObject *object : std::as_const(objectsSet))
+        if (mSelectedObjectsSet.remove(object))
+            removed.insert(object);
+
+    if (!removed.isEmpty()) {
+        mSelectedObjects.erase(std::remove_if(mSelectedObjects.begin(),
+                                              mSelectedObjects.end(),
+                                              isDeselected),
+                               mSelectedObjects.end());
+        emit selectedObjectsChanged(QSet<MapObject*>(), removed);
     }
 
-    if (removedSelectedObjects > 0)
-        emit selectedObjectsChanged();
-    if (removedAboutToBeSelectedObjects > 0)
+    const auto aboutToBeSelectedEnd = std::remove_if(mAboutToBeSelectedObjects.begin(),
+                                                     mAboutToBeSelectedObjects.end(),
+                                                     isDeselected);
+    if (aboutToBeSelectedEnd != mAboutToBeSelectedObjects.end()) {
+        mAboutToBeSelectedObjects.erase(aboutToBeSelectedEnd, mAboutToBeSelectedObjects.end());
         emit aboutToBeSelectedObjectsChanged(mAboutToBeSelectedObjects);
+    }
 }
 
 void MapDocument::duplicateObjects(const QList<MapObject *> &objects)
@@ -1784,7 +1997,12 @@ void MapDocument::moveObjectsToGroup(const QList<MapObject *> &objects,
     undoStack()->beginMacro(tr("Move %n Object(s) to Layer", "",
                                objects.size()));
 
-    const auto objectsToMove = sortObjects(*mMap, objects);
+    QSet<MapObject*> objectsSet;
+    objectsSet.reserve(objects.size());
+    for (MapObject *object : objects)
+        objectsSet.insert(object);
+
+    const auto objectsToMove = sortObjects(*mMap, objects, objectsSet);
     for (MapObject *mapObject : objectsToMove) {
         if (mapObject->objectGroup() == objectGroup)
             continue;
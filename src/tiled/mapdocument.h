@@ -30,6 +30,7 @@
 #include "tilededitor_global.h"
 #include "tileset.h"
 
+#include <QFutureWatcher>
 #include <QList>
 #include <QRegion>
 #include <QSet>
@@ -92,6 +93,11 @@ public:
 
     bool save(const QString &fileName, QString *error = nullptr) override;
 
+    bool canSaveInBackground() const;
+    void saveInBackground(const QString &fileName);
+    bool isSavingInBackground() const;
+    void waitForBackgroundSave();
+
     bool canReload() const override;
     bool reload(QString *error);
 
@@ -172,6 +178,9 @@ public:
     void toggleLockLayers(QList<Layer *> layers);
     void toggleOtherLayers(const QList<Layer *> &layers);
     void toggleLockOtherLayers(const QList<Layer *> &layers);
+    void toggleFreezeLayers(const QList<Layer *> &layers);
+
+    bool isLayerFrozen(const Layer *layer) const;
 
     void insertTileset(int index, const SharedTileset &tileset);
     void removeTilesetAt(int index);
@@ -232,6 +241,12 @@ public:
     const QList<MapObject*> &selectedObjects() const
     { return mSelectedObjects; }
 
+    /**
+     * Returns whether the given \a object is selected.
+     */
+    bool isObjectSelected(MapObject *object) const
+    { return mSelectedObjectsSet.contains(object); }
+
     QList<Layer*> selectedLayersOrdered() const;
     QList<MapObject*> selectedObjectsOrdered() const;
 
@@ -271,8 +286,15 @@ public:
 
     QSet<int> expandedGroupLayers;
     QSet<int> expandedObjectLayers;
+    QSet<int> frozenGroupLayers;
 
 signals:
+    /**
+     * Emitted when a save started with saveInBackground() has finished. On
+     * success, the saved() signal is emitted as well.
+     */
+    void backgroundSaveFinished(bool success, const QString &error);
+
     /**
      * Emitted when the selected tile region changes. Sends the currently
      * selected region and the previously selected region.
@@ -286,9 +308,12 @@ signals:
     void selectedLayersChanged();
 
     /**
-     * Emitted when the list of selected objects changes.
+     * Emitted when the list of selected objects changes. The \a added and
+     * \a removed sets contain the objects that got selected and deselected.
+     * Both are empty when only the order of the selected objects changed.
      */
-    void selectedObjectsChanged();
+    void selectedObjectsChanged(const QSet<MapObject*> &added,
+                                const QSet<MapObject*> &removed);
 
     /**
      * Emitted when the hovered object changes. Use \a previous with caution,
@@ -336,6 +361,12 @@ signals:
      */
     void editLayerNameRequested();
 
+    /**
+     * Emitted when the rendering of the given \a groupLayer was frozen or
+     * unfrozen.
+     */
+    void layerFrozenChanged(GroupLayer *groupLayer);
+
     /**
      * Emitted when the current layer changes.
      */
@@ -387,6 +418,9 @@ protected:
 private:
     void onChanged(const ChangeEvent &change);
 
+    void finishSave(const QString &fileName);
+    void finishBackgroundSave();
+
     void onMapObjectModelRowsInserted(const QModelIndex &parent, int first, int last);
     void onMapObjectModelRowsInsertedOrRemoved(const QModelIndex &parent, int first, int last);
     void onObjectsMoved(const QModelIndex &parent, int start, int end,
@@ -411,6 +445,7 @@ private:
     QRegion mSelectedArea;
     QList<Layer*> mSelectedLayers;
     QList<MapObject*> mSelectedObjects;
+    QSet<MapObject*> mSelectedObjectsSet;   /**< For fast lookup */
     QList<MapObject*> mAboutToBeSelectedObjects;
     MapObject *mHoveredMapObject;       /**< Map object with mouse on top. */
     std::unique_ptr<MapRenderer> mRenderer;
@@ -418,6 +453,17 @@ private:
     MapObjectModel *mMapObjectModel;
     bool mAllowHidingObjects = true;
     bool mAllowTileObjects = true;
+
+    struct SaveResult
+    {
+        bool success = false;
+        QString error;
+    };
+
+    QFutureWatcher<SaveResult> mBackgroundSave;
+    std::unique_ptr<const Map> mBackgroundSaveSnapshot;
+    QString mBackgroundSaveFileName;
+    bool mChangedDuringBackgroundSave = false;
 };
 
 } // namespace Tiled
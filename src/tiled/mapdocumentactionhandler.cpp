@@ -145,6 +145,8 @@ MapDocumentActionHandler::MapDocumentActionHandler(QObject *parent)
     mActionToggleLockSelectedLayers->setShortcut(Qt::CTRL + Qt::Key_L);
     mActionToggleLockSelectedLayers->setIcon(lockedIcon);
 
+    mActionToggleFreezeSelectedLayers = new QAction(this);
+
     mActionToggleOtherLayers = new QAction(this);
     mActionToggleOtherLayers->setShortcut((Qt::CTRL | Qt::SHIFT) + Qt::Key_H);
     mActionToggleOtherLayers->setIcon(
@@ -194,6 +196,7 @@ MapDocumentActionHandler::MapDocumentActionHandler(QObject *parent)
     connect(mActionMoveLayersDown, &QAction::triggered, this, &MapDocumentActionHandler::moveLayersDown);
     connect(mActionToggleSelectedLayers, &QAction::triggered, this, &MapDocumentActionHandler::toggleSelectedLayers);
     connect(mActionToggleLockSelectedLayers, &QAction::triggered, this, &MapDocumentActionHandler::toggleLockSelectedLayers);
+    connect(mActionToggleFreezeSelectedLayers, &QAction::triggered, this, &MapDocumentActionHandler::toggleFreezeSelectedLayers);
     connect(mActionToggleOtherLayers, &QAction::triggered, this, &MapDocumentActionHandler::toggleOtherLayers);
     connect(mActionToggleLockOtherLayers, &QAction::triggered, this, &MapDocumentActionHandler::toggleLockOtherLayers);
     connect(mActionLayerProperties, &QAction::triggered, this, &MapDocumentActionHandler::layerProperties);
@@ -225,6 +228,7 @@ MapDocumentActionHandler::MapDocumentActionHandler(QObject *parent)
     ActionManager::registerAction(mActionMoveLayersDown, "MoveLayersDown");
     ActionManager::registerAction(mActionToggleSelectedLayers, "ToggleSelectedLayers");
     ActionManager::registerAction(mActionToggleLockSelectedLayers, "ToggleLockSelectedLayers");
+    ActionManager::registerAction(mActionToggleFreezeSelectedLayers, "ToggleFreezeSelectedLayers");
     ActionManager::registerAction(mActionToggleOtherLayers, "ToggleOtherLayers");
     ActionManager::registerAction(mActionToggleLockOtherLayers, "ToggleLockOtherLayers");
     ActionManager::registerAction(mActionLayerProperties, "LayerProperties");
@@ -268,6 +272,7 @@ void MapDocumentActionHandler::retranslateUi()
     mActionMoveLayersDown->setText(tr("&Lower Layers"));
     mActionToggleSelectedLayers->setText(tr("Show/&Hide Layers"));
     mActionToggleLockSelectedLayers->setText(tr("Lock/&Unlock Layers"));
+    mActionToggleFreezeSelectedLayers->setText(tr("&Freeze/Unfreeze Group Layers"));
     mActionToggleOtherLayers->setText(tr("Show/&Hide Other Layers"));
     mActionToggleLockOtherLayers->setText(tr("Lock/&Unlock Other Layers"));
     mActionLayerProperties->setText(tr("Layer &Properties..."));
@@ -796,6 +801,12 @@ void MapDocumentActionHandler::toggleLockSelectedLayers()
         mMapDocument->toggleLockLayers(mMapDocument->selectedLayers());
 }
 
+void MapDocumentActionHandler::toggleFreezeSelectedLayers()
+{
+    if (mMapDocument)
+        mMapDocument->toggleFreezeLayers(mMapDocument->selectedLayers());
+}
+
 void MapDocumentActionHandler::toggleOtherLayers()
 {
     if (mMapDocument)
@@ -893,6 +904,8 @@ void MapDocumentActionHandler::updateActions()
     mActionMoveLayersDown->setEnabled(canMoveLayersDown);
     mActionToggleSelectedLayers->setEnabled(!selectedLayers.isEmpty());
     mActionToggleLockSelectedLayers->setEnabled(!selectedLayers.isEmpty());
+    mActionToggleFreezeSelectedLayers->setEnabled(std::any_of(selectedLayers.begin(), selectedLayers.end(),
+                                                              [] (Layer *layer) { return layer->isGroupLayer(); }));
     mActionToggleOtherLayers->setEnabled(currentLayer && (hasNextLayer || hasPreviousLayer));
     mActionToggleLockOtherLayers->setEnabled(currentLayer && (hasNextLayer || hasPreviousLayer));
     mActionRemoveLayers->setEnabled(!selectedLayers.isEmpty());
@@ -83,6 +83,7 @@ public:
     QAction *actionMoveLayersDown() const { return mActionMoveLayersDown; }
     QAction *actionToggleSelectedLayers() const { return mActionToggleSelectedLayers; }
     QAction *actionToggleLockSelectedLayers() const { return mActionToggleLockSelectedLayers; }
+    QAction *actionToggleFreezeSelectedLayers() const { return mActionToggleFreezeSelectedLayers; }
     QAction *actionToggleOtherLayers() const { return mActionToggleOtherLayers; }
     QAction *actionToggleLockOtherLayers() const { return mActionToggleLockOtherLayers; }
     QAction *actionLayerProperties() const { return mActionLayerProperties; }
@@ -129,6 +130,7 @@ public slots:
     void removeLayers();
     void toggleSelectedLayers();
     void toggleLockSelectedLayers();
+    void toggleFreezeSelectedLayers();
     void toggleOtherLayers();
     void toggleLockOtherLayers();
     void layerProperties();
@@ -169,6 +171,7 @@ private:
     QAction *mActionMoveLayersDown;
     QAction *mActionToggleSelectedLayers;
     QAction *mActionToggleLockSelectedLayers;
+    QAction *mActionToggleFreezeSelectedLayers;
     QAction *mActionToggleOtherLayers;
     QAction *mActionToggleLockOtherLayers;
     QAction *mActionLayerProperties;
@@ -336,6 +336,7 @@ void MapEditor::addDocument(Document *document)
     if (!fileState.isEmpty()) {
         mapDocument->expandedGroupLayers = fromSettingsValue<QSet<int>>(fileState.value(QStringLiteral("expandedGroupLayers")));
         mapDocument->expandedObjectLayers = fromSettingsValue<QSet<int>>(fileState.value(QStringLiteral("expandedObjectLayers")));
+        mapDocument->frozenGroupLayers = fromSettingsValue<QSet<int>>(fileState.value(QStringLiteral("frozenGroupLayers")));
     }
 
     MapView *view = new MapView(mWidgetStack);
@@ -616,6 +617,8 @@ void MapEditor::saveDocumentState(MapDocument *mapDocument) const
         fileState.insert(QStringLiteral("expandedGroupLayers"), toSettingsValue(mapDocument->expandedGroupLayers));
     if (!mapDocument->expandedObjectLayers.isEmpty())
         fileState.insert(QStringLiteral("expandedObjectLayers"), toSettingsValue(mapDocument->expandedObjectLayers));
+    if (!mapDocument->frozenGroupLayers.isEmpty())
+        fileState.insert(QStringLiteral("frozenGroupLayers"), toSettingsValue(mapDocument->frozenGroupLayers));
 
     Session::current().setFileState(mapDocument->fileName(), fileState);
 }
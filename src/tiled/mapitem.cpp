@@ -55,6 +55,10 @@ namespace Tiled {
 static const qreal darkeningFactor = 0.6;
 static const qreal opacityFactor = 0.4;
 
+// Limits how often the bounding rect follows changing tile layer bounds,
+// which is expensive since it changes the scene rect
+static const int boundingRectUpdateInterval = 100;
+
 class TileGridItem : public QGraphicsObject
 {
     Q_OBJECT
@@ -160,6 +164,7 @@ MapItem::MapItem(const MapDocumentPtr &mapDocument, DisplayMode displayMode,
     connect(mapDocument.data(), &MapDocument::layerAdded, this, &MapItem::layerAdded);
     connect(mapDocument.data(), &MapDocument::layerAboutToBeRemoved, this, &MapItem::layerAboutToBeRemoved);
     connect(mapDocument.data(), &MapDocument::layerRemoved, this, &MapItem::layerRemoved);
+    connect(mapDocument.data(), &MapDocument::layerFrozenChanged, this, &MapItem::layerFrozenChanged);
     connect(mapDocument.data(), &MapDocument::selectedLayersChanged, this, &MapItem::updateSelectedLayersHighlight);
     connect(mapDocument.data(), &MapDocument::tilesetTilePositioningChanged, this, &MapItem::adaptToTilesetTileSizeChanges);
     connect(mapDocument.data(), &MapDocument::tileImageSourceChanged, this, &MapItem::adaptToTileSizeChanges);
@@ -168,6 +173,15 @@ MapItem::MapItem(const MapDocumentPtr &mapDocument, DisplayMode displayMode,
     connect(mapDocument.data(), &MapDocument::objectsInserted, this, &MapItem::objectsInserted);
     connect(mapDocument.data(), &MapDocument::objectsIndexChanged, this, &MapItem::objectsIndexChanged);
 
+    mBoundingRectUpdateTimer.setSingleShot(true);
+    mBoundingRectUpdateTimer.setInterval(boundingRectUpdateInterval);
+    connect(&mBoundingRectUpdateTimer, &QTimer::timeout, this, [this] {
+        if (mTileBoundingRectDirty)
+            updateBoundingRect();
+        else
+            applyTileBoundingRect();
+    });
+
     updateBoundingRect();
 
     mDarkRectangle->setPen(Qt::NoPen);
@@ -258,6 +272,35 @@ void MapItem::setShowTileCollisionShapes(bool enabled)
     for (LayerItem *item : std::as_const(mLayerItems))
         if (item->layer()->isTileLayer())
             item->update();
+
+    invalidateAllFrozenGroups();
+}
+
+/**
+ * Discards the cached rendering of the tile layers using the given
+ * \a tileset, for example because its images have changed.
+ */
+void MapItem::invalidateTileLayers(Tileset *tileset)
+{
+    for (LayerItem *item : std::as_const(mLayerItems))
+        if (item->layer()->isTileLayer() && item->layer()->referencesTileset(tileset))
+            static_cast<TileLayerItem*>(item)->invalidate();
+
+    invalidateAllFrozenGroups();
+}
+
+void MapItem::invalidateTileAnimations(Tileset *tileset)
+{
+    for (LayerItem *item : std::as_const(mLayerItems))
+        if (item->layer()->isTileLayer() && item->layer()->referencesTileset(tileset))
+            static_cast<TileLayerItem*>(item)->invalidateAnimations();
+}
+
+void MapItem::repaintAnimatedTiles(Tileset *tileset, const QSet<int> &tileIds)
+{
+    for (LayerItem *item : std::as_const(mLayerItems))
+        if (item->layer()->isTileLayer() && item->layer()->referencesTileset(tileset))
+            static_cast<TileLayerItem*>(item)->repaintAnimatedTiles(tileset, tileIds);
 }
 
 void MapItem::updateLayerPositions()
@@ -345,13 +388,14 @@ void MapItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 
 void MapItem::repaintRegion(const QRegion &region, TileLayer *tileLayer)
 {
-    const MapRenderer *renderer = mapDocument()->renderer();
-    const QMargins margins = mapDocument()->map()->drawMargins();
-    TileLayerItem *tileLayerItem = static_cast<TileLayerItem*>(mLayerItems.value(tileLayer));
+    if (auto tileLayerItem = static_cast<TileLayerItem*>(mLayerItems.value(tileLayer))) {
+        tileLayerItem->invalidate(region);
 
-    for (const QRect &r : region) {
-        QRectF boundingRect = renderer->boundingRect(r).marginsAdded(margins);
-        tileLayerItem->update(boundingRect);
+        if (tileLayer->parentLayer() && !region.isEmpty()) {
+            const MapRenderer *renderer = mMapDocument->renderer();
+            const QMargins margins = mMapDocument->map()->drawMargins();
+            invalidateFrozenGroups(tileLayer, renderer->boundingRect(region.boundingRect()).marginsAdded(margins));
+        }
     }
 }
 
@@ -378,8 +422,11 @@ void MapItem::documentChanged(const ChangeEvent &change)
         if (!objectsChange.objects.isEmpty() && (objectsChange.properties & ObjectsChangeEvent::ClassProperty)) {
             const auto typeId = objectsChange.objects.first()->typeId();
             if (typeId == Object::MapObjectType) {
-                for (Object *object : objectsChange.objects)
-                    mObjectItems.value(static_cast<MapObject*>(object))->syncWithMapObject();
+                for (Object *object : objectsChange.objects) {
+                    auto mapObject = static_cast<MapObject*>(object);
+                    mObjectItems.value(mapObject)->syncWithMapObject();
+                    invalidateFrozenGroups(mapObject->objectGroup());
+                }
             } else if (typeId == Object::TileType) {
                 if (mapDocument()->renderer()->testFlag(ShowTileObjectOutlines))
                     for (MapObjectItem *item : std::as_const(mObjectItems))
@@ -404,7 +451,9 @@ void MapItem::documentChanged(const ChangeEvent &change)
         break;
     case ChangeEvent::MapObjectAboutToBeRemoved: {
         auto &e = static_cast<const MapObjectEvent&>(change);
-        deleteObjectItem(e.objectGroup->objectAt(e.index));
+        for (int i = 0; i < e.count; ++i)
+            deleteObjectItem(e.objectGroup->objectAt(e.index + i));
+        invalidateFrozenGroups(e.objectGroup);
         break;
     }
     case ChangeEvent::MapObjectsChanged:
@@ -426,6 +475,7 @@ void MapItem::documentChanged(const ChangeEvent &change)
         if (sync)
             syncObjectItems(objectGroup->objects());
 
+        invalidateFrozenGroups(objectGroup);
         break;
     }
     case ChangeEvent::TilesetChanged: {
@@ -436,6 +486,7 @@ void MapItem::documentChanged(const ChangeEvent &change)
                 if (TileLayerItem *tli = dynamic_cast<TileLayerItem*>(item))
                     tli->syncWithTileLayer();
             }
+            invalidateAllFrozenGroups();
         }
         break;
     }
@@ -455,6 +506,7 @@ void MapItem::mapChanged()
     }
 
     syncAllObjectItems();
+    invalidateAllFrozenGroups();
     updateBoundingRect();
 
     // When this map is part of a world, update that map's rect when necessary
@@ -475,14 +527,16 @@ void MapItem::tileLayerChanged(TileLayer *tileLayer, MapDocument::TileLayerChang
 {
     TileLayerItem *item = static_cast<TileLayerItem*>(mLayerItems.value(tileLayer));
     item->syncWithTileLayer();
+    invalidateFrozenGroups(tileLayer);
 
     if (flags & MapDocument::LayerBoundsChanged)
-        updateBoundingRect();
+        scheduleBoundingRectUpdate(tileLayer);
 }
 
 void MapItem::layerAdded(Layer *layer)
 {
     createLayerItem(layer);
+    invalidateFrozenGroups(layer);
 
     int z = 0;
     const auto siblings = layer->siblings();
@@ -499,6 +553,7 @@ void MapItem::layerAboutToBeRemoved(GroupLayer *parentLayer, int index)
     const auto siblings = parentLayer ? parentLayer->layers()
                                       : mMapDocument->map()->layers();
     const Layer *layer = siblings.at(index);
+    invalidateFrozenGroups(layer);
 
     int z = 0;
     for (auto sibling : siblings)
@@ -527,7 +582,8 @@ void MapItem::layerChanged(const LayerChangeEvent &change)
     if (change.properties & LayerChangeEvent::TintColorProperty)
         layerTintColorChanged(layer);
 
-    layerItem->setVisible(layer->isVisible());
+    layerItem->setVisible(isLayerItemVisible(layer));
+    invalidateFrozenGroups(layer);
 
     qreal multiplier = 1;
 
@@ -574,6 +630,9 @@ void MapItem::layerTintColorChanged(Layer *layer)
         }
         break;
     case Layer::GroupLayerType:
+        if (auto groupItem = static_cast<GroupLayerItem*>(mLayerItems.value(layer)))
+            groupItem->invalidate();
+
         // Recurse into group layers since tint color is inherited
         for (auto childLayer : static_cast<GroupLayer*>(layer)->layers())
             layerTintColorChanged(childLayer);
@@ -581,6 +640,74 @@ void MapItem::layerTintColorChanged(Layer *layer)
     }
 }
 
+/**
+ * Freezes or unfreezes the rendering of the given \a groupLayer. The items
+ * of its child layers are hidden while frozen, since the group draws them.
+ */
+void MapItem::layerFrozenChanged(GroupLayer *groupLayer)
+{
+    auto groupItem = static_cast<GroupLayerItem*>(mLayerItems.value(groupLayer));
+    if (!groupItem)
+        return;
+
+    const bool frozen = mMapDocument->isLayerFrozen(groupLayer);
+    if (frozen) {
+        groupItem->setFrozen(true);
+        for (Layer *childLayer : groupLayer->layers())
+            mLayerItems.value(childLayer)->setVisible(false);
+    } else {
+        groupItem->setFrozen(false);
+        for (Layer *childLayer : groupLayer->layers())
+            mLayerItems.value(childLayer)->setVisible(childLayer->isVisible());
+    }
+}
+
+/**
+ * Returns whether the item of the given \a layer should be visible. This
+ * is not the case for the layers in a frozen group, which are drawn by the
+ * group instead.
+ */
+bool MapItem::isLayerItemVisible(const Layer *layer) const
+{
+    if (layer->parentLayer()) {
+        auto parentItem = static_cast<GroupLayerItem*>(mLayerItems.value(layer->parentLayer()));
+        if (parentItem && parentItem->isFrozen())
+            return false;
+    }
+
+    return layer->isVisible();
+}
+
+/**
+ * Discards the baked rendering of any frozen group containing the given
+ * \a layer. When given, only the \a rect (in the coordinates of the item of
+ * the layer) is discarded.
+ */
+void MapItem::invalidateFrozenGroups(const Layer *layer, const QRectF &rect)
+{
+    const LayerItem *layerItem = mLayerItems.value(const_cast<Layer*>(layer));
+    if (!layerItem)
+        return;
+
+    for (GroupLayer *groupLayer = layer->parentLayer(); groupLayer; groupLayer = groupLayer->parentLayer()) {
+        auto groupItem = static_cast<GroupLayerItem*>(mLayerItems.value(groupLayer));
+        if (!groupItem || !groupItem->isFrozen())
+            continue;
+
+        if (rect.isNull())
+            groupItem->invalidate();
+        else
+            groupItem->invalidate(layerItem->mapRectToItem(groupItem, rect));
+    }
+}
+
+void MapItem::invalidateAllFrozenGroups()
+{
+    for (LayerItem *item : std::as_const(mLayerItems))
+        if (auto groupItem = dynamic_cast<GroupLayerItem*>(item))
+            groupItem->invalidate();
+}
+
 /**
  * When an image layer has changed, it may change size and it may look
  * differently.
@@ -590,6 +717,7 @@ void MapItem::imageLayerChanged(ImageLayer *imageLayer)
     ImageLayerItem *item = static_cast<ImageLayerItem*>(mLayerItems.value(imageLayer));
     item->syncWithImageLayer();
     item->update();
+    invalidateFrozenGroups(imageLayer);
 }
 
 /**
@@ -602,6 +730,8 @@ void MapItem::adaptToTilesetTileSizeChanges(Tileset *tileset)
         if (TileLayerItem *tli = dynamic_cast<TileLayerItem*>(item))
             tli->syncWithTileLayer();
 
+    invalidateAllFrozenGroups();
+
     for (MapObjectItem *item : std::as_const(mObjectItems)) {
         const Cell &cell = item->mapObject()->cell();
         if (cell.tileset() == tileset)
@@ -615,6 +745,8 @@ void MapItem::adaptToTileSizeChanges(Tile *tile)
         if (TileLayerItem *tli = dynamic_cast<TileLayerItem*>(item))
             tli->syncWithTileLayer();
 
+    invalidateAllFrozenGroups();
+
     for (MapObjectItem *item : std::as_const(mObjectItems)) {
         const Cell &cell = item->mapObject()->cell();
         if (cell.tile() == tile)
@@ -662,6 +794,8 @@ void MapItem::objectsInserted(ObjectGroup *objectGroup, int first, int last)
 
         mObjectItems.insert(object, item);
     }
+
+    invalidateFrozenGroups(objectGroup);
 }
 
 /**
@@ -684,6 +818,7 @@ void MapItem::syncObjectItems(const QList<MapObject*> &objects)
         Q_ASSERT(item);
 
         item->syncWithMapObject();
+        invalidateFrozenGroups(object->objectGroup());
     }
 }
 
@@ -702,6 +837,8 @@ void MapItem::objectsIndexChanged(ObjectGroup *objectGroup,
 
         item->setZValue(i);
     }
+
+    invalidateFrozenGroups(objectGroup);
 }
 
 void MapItem::syncAllObjectItems()
@@ -721,6 +858,8 @@ void MapItem::setObjectLineWidth(qreal lineWidth)
             item->update();
         }
     }
+
+    invalidateAllFrozenGroups();
 }
 
 void MapItem::setShowTileObjectOutlines(bool enabled)
@@ -731,6 +870,8 @@ void MapItem::setShowTileObjectOutlines(bool enabled)
         if (!item->mapObject()->cell().isEmpty())
             item->update();
     }
+
+    invalidateAllFrozenGroups();
 }
 
 void MapItem::createLayerItems(const QList<Layer *> &layers)
@@ -782,7 +923,7 @@ LayerItem *MapItem::createLayerItem(Layer *layer)
         break;
 
     case Layer::GroupLayerType:
-        layerItem = new GroupLayerItem(static_cast<GroupLayer*>(layer), parent);
+        layerItem = new GroupLayerItem(static_cast<GroupLayer*>(layer), mapDocument(), parent);
         break;
     }
 
@@ -794,14 +935,18 @@ LayerItem *MapItem::createLayerItem(Layer *layer)
     if (const MapScene *mapScene = static_cast<MapScene*>(scene()))
         layerItem->setPos(mapScene->layerItemPosition(*layer));
 
-    layerItem->setVisible(layer->isVisible());
+    layerItem->setVisible(isLayerItemVisible(layer));
     layerItem->setEnabled(mDisplayMode == Editable);
 
     mLayerItems.insert(layer, layerItem);
 
-    if (GroupLayer *groupLayer = layer->asGroupLayer())
+    if (GroupLayer *groupLayer = layer->asGroupLayer()) {
         createLayerItems(groupLayer->layers());
 
+        if (mMapDocument->isLayerFrozen(groupLayer))
+            layerFrozenChanged(groupLayer);
+    }
+
     return layerItem;
 }
 
@@ -828,7 +973,42 @@ void MapItem::deleteLayerItems(Layer *layer)
 
 void MapItem::updateBoundingRect()
 {
-    QRect boundingRect = mapDocument()->renderer()->mapBoundingRect();
+    mBoundingRectUpdateTimer.stop();
+    mTileBoundingRect = mapDocument()->map()->tileBoundingRect();
+    mTileBoundingRectDirty = false;
+
+    applyTileBoundingRect();
+}
+
+/**
+ * Schedules an update of the bounding rect after the bounds of the given
+ * \a tileLayer changed, for example while painting.
+ *
+ * Growth of the map bounds is tracked incrementally, while only shrinking
+ * bounds require visiting all tile layers. In both cases the update is
+ * throttled, so that a stroke along the edge of an infinite map doesn't
+ * change the scene rect on each step.
+ */
+void MapItem::scheduleBoundingRectUpdate(const TileLayer *tileLayer)
+{
+    // The bounds of a fixed-size map don't depend on the layer contents
+    if (!mapDocument()->map()->infinite())
+        return;
+
+    const QRect layerBounds = tileLayer->bounds();
+
+    if (layerBounds.isEmpty() || mTileBoundingRect.contains(layerBounds))
+        mTileBoundingRectDirty = true;     // layer may have shrunk
+    else
+        mTileBoundingRect |= layerBounds;
+
+    if (!mBoundingRectUpdateTimer.isActive())
+        mBoundingRectUpdateTimer.start();
+}
+
+void MapItem::applyTileBoundingRect()
+{
+    QRect boundingRect = mapDocument()->renderer()->boundingRect(mTileBoundingRect);
 
     // This rectangle represents the map boundary and as such is unaffected
     // by layer offsets or image layers.
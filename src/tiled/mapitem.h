@@ -24,6 +24,8 @@
 
 #include <QGraphicsObject>
 #include <QMap>
+#include <QSet>
+#include <QTimer>
 
 #include <memory>
 
@@ -73,6 +75,9 @@ public:
 
     void setDisplayMode(DisplayMode displayMode);
     void setShowTileCollisionShapes(bool enabled);
+    void invalidateTileLayers(Tileset *tileset);
+    void invalidateTileAnimations(Tileset *tileset);
+    void repaintAnimatedTiles(Tileset *tileset, const QSet<int> &tileIds);
 
     void updateLayerPositions();
 
@@ -108,6 +113,11 @@ private:
     void layerRemoved(Layer *layer);
     void layerChanged(const LayerChangeEvent &change);
     void layerTintColorChanged(Layer *layer);
+    void layerFrozenChanged(GroupLayer *groupLayer);
+
+    bool isLayerItemVisible(const Layer *layer) const;
+    void invalidateFrozenGroups(const Layer *layer, const QRectF &rect = QRectF());
+    void invalidateAllFrozenGroups();
 
     void imageLayerChanged(ImageLayer *imageLayer);
 
@@ -132,6 +142,8 @@ private:
     void deleteLayerItems(Layer *layer);
 
     void updateBoundingRect();
+    void scheduleBoundingRectUpdate(const TileLayer *tileLayer);
+    void applyTileBoundingRect();
     void updateSelectedLayersHighlight();
 
     MapDocumentPtr mMapDocument;
@@ -144,6 +156,9 @@ private:
     QMap<MapObject*, MapObjectItem*> mObjectItems;
     DisplayMode mDisplayMode;
     QRectF mBoundingRect;
+    QRect mTileBoundingRect;
+    bool mTileBoundingRectDirty = false;
+    QTimer mBoundingRectUpdateTimer;
     bool mIsHovered = false;
 };
 
@@ -31,6 +31,7 @@
 #include "utils.h"
 
 #include <QPainter>
+#include <QStyleOptionGraphicsItem>
 
 #include <cmath>
 #include <memory>
@@ -39,6 +40,9 @@ using namespace Tiled;
 
 Preference<bool> MapObjectItem::preciseTileObjectSelection { "Interface/PreciseTileObjectSelection", true };
 
+// Objects smaller than this size in device pixels are drawn as rectangles
+static constexpr qreal MinimumDetailedSize = 4.0;
+
 MapObjectItem::MapObjectItem(MapObject *object, MapDocument *mapDocument,
                              QGraphicsItem *parent):
     QGraphicsItem(parent),
@@ -90,6 +94,8 @@ void MapObjectItem::syncWithMapObject()
     setPos(pixelPos);
     setRotation(mObject->rotation());
 
+    mShapeDirty = true;
+
     if (mBoundingRect != bounds) {
         // Notify the graphics scene about the geometry change in advance
         prepareGeometryChange();
@@ -121,15 +127,44 @@ QPainterPath MapObjectItem::shape() const
     if (mObject->isTileObject() && preciseTileObjectSelection)
         return mObject->tileObjectShape(mMapDocument->map());
 
-    QPainterPath path = mMapDocument->renderer()->interactionShape(mObject);
-    path.translate(-pos());
-    return path;
+    const MapRenderer *renderer = mMapDocument->renderer();
+
+    // Polygons are simplified based on the scale, so their shape needs to be
+    // built again when zooming by more than a factor two
+    const qreal painterScale = renderer->painterScale();
+    if (mObject->polygon().size() > 1 &&
+            (painterScale > mShapePainterScale * 2 || painterScale < mShapePainterScale / 2)) {
+        mShapeDirty = true;
+    }
+
+    // The shape is requested for each candidate item when selecting objects
+    // by area, so it is only built again after the object changed
+    if (mShapeDirty) {
+        mShape = renderer->interactionShape(mObject);
+        mShape.translate(-pos());
+        mShapePainterScale = painterScale;
+        mShapeDirty = false;
+    }
+
+    return mShape;
 }
 
 void MapObjectItem::paint(QPainter *painter,
                           const QStyleOptionGraphicsItem *,
                           QWidget *)
 {
+    // When zoomed out far, draw shapes and text as a simple rectangle, since
+    // there are no details to see and drawing them is slow
+    if (!mIsHoveredIndicator && !mObject->isTileObject() &&
+            !(flags() & QGraphicsItem::ItemIgnoresTransformations)) {
+        const qreal scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+        if (mBoundingRect.width() * scale < MinimumDetailedSize &&
+                mBoundingRect.height() * scale < MinimumDetailedSize) {
+            painter->fillRect(mBoundingRect, mColors.main);
+            return;
+        }
+    }
+
     const auto renderer = mMapDocument->renderer();
     const qreal painterScale = renderer->painterScale();
 
@@ -26,6 +26,7 @@
 
 #include <QCoreApplication>
 #include <QGraphicsItem>
+#include <QPainterPath>
 
 namespace Tiled {
 
@@ -96,6 +97,9 @@ private:
     QRectF mBoundingRect;
     QPolygonF mPolygon; // Copy of the polygon, so we know when it changes
     MapObjectColors mColors; // Cached colors of the object
+    mutable QPainterPath mShape; // Cached interaction shape, in item coordinates
+    mutable qreal mShapePainterScale = 1; // Scale the shape was simplified for
+    mutable bool mShapeDirty = true;
     bool mIsHoveredIndicator = false;
 };
 
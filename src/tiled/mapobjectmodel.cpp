@@ -35,6 +35,8 @@
 #include <QPalette>
 #include <QStyle>
 
+#include <algorithm>
+
 using namespace Tiled;
 
 ObjectIconManager::ObjectIconManager()
@@ -78,6 +80,11 @@ MapObjectModel::MapObjectModel(QObject *parent)
     , mObjectGroupIcon(QLatin1String(":/images/16/layer-object.png"))
 {
     mObjectGroupIcon.addFile(QLatin1String(":images/32/layer-object.png"));
+
+    mDataChangedTimer.setInterval(0);
+    mDataChangedTimer.setSingleShot(true);
+    connect(&mDataChangedTimer, &QTimer::timeout,
+            this, &MapObjectModel::emitPendingDataChanged);
 }
 
 QModelIndex MapObjectModel::index(int row, int column,
@@ -343,8 +350,7 @@ QModelIndex MapObjectModel::index(MapObject *mapObject, int column) const
     Q_ASSERT(mapObject->objectGroup());
     Q_ASSERT(mapObject->map() == map());
 
-    const int row = mapObject->objectGroup()->objects().indexOf(mapObject);
-    return createIndex(row, column, mapObject);
+    return createIndex(objectRow(mapObject), column, mapObject);
 }
 
 Layer *MapObjectModel::toLayer(const QModelIndex &index) const
@@ -413,6 +419,14 @@ void MapObjectModel::setMapDocument(MapDocument *mapDocument)
     mMapDocument = mapDocument;
 
     mFilteredLayers.clear();
+    mObjectRows.clear();
+
+    mChangedObjects.clear();
+    mChangedFirstColumn = ColumnCount;
+    mChangedLastColumn = -1;
+    mChangedRoles.clear();
+    mAllRolesChanged = false;
+    mDataChangedTimer.stop();
 
     if (mMapDocument) {
         connect(mMapDocument, &MapDocument::layerAdded,
@@ -463,6 +477,9 @@ void MapObjectModel::layerAboutToBeRemoved(GroupLayer *groupLayer, int index)
     Layer *layer = layers.at(index);
 
     if (layer->isObjectGroup() || layer->isGroupLayer()) {
+        emitPendingDataChanged();
+        mObjectRows.clear();
+
         auto &filtered = filteredChildLayers(groupLayer);
         const int row = filtered.indexOf(layer);
 
@@ -521,6 +538,8 @@ QList<Layer *> &MapObjectModel::filteredChildLayers(GroupLayer *parentLayer) con
 
 void MapObjectModel::moveObjects(ObjectGroup *og, int from, int to, int count)
 {
+    emitPendingDataChanged();
+
     const QModelIndex parent = index(og);
     if (!beginMoveRows(parent, from, from + count - 1, parent, to)) {
         Q_ASSERT(false); // The code should never attempt this
@@ -536,10 +555,12 @@ void MapObjectModel::documentChanged(const ChangeEvent &change)
     // Notify views about certain property changes
     switch (change.type) {
     case ChangeEvent::DocumentAboutToReload:
+        emitPendingDataChanged();
         beginResetModel();
         break;
     case ChangeEvent::DocumentReloaded:
         mFilteredLayers.clear();
+        mObjectRows.clear();
         endResetModel();
         break;
     case ChangeEvent::ObjectsChanged: {
@@ -568,12 +589,14 @@ void MapObjectModel::documentChanged(const ChangeEvent &change)
         break;
     case ChangeEvent::MapObjectAboutToBeAdded: {
         auto &e = static_cast<const MapObjectEvent&>(change);
-        beginInsertRows(index(e.objectGroup), e.index, e.index);
+        emitPendingDataChanged();
+        beginInsertRows(index(e.objectGroup), e.index, e.index + e.count - 1);
         break;
     }
     case ChangeEvent::MapObjectAboutToBeRemoved: {
         auto &e = static_cast<const MapObjectEvent&>(change);
-        beginRemoveRows(index(e.objectGroup), e.index, e.index);
+        emitPendingDataChanged();
+        beginRemoveRows(index(e.objectGroup), e.index, e.index + e.count - 1);
         break;
     }
     case ChangeEvent::MapObjectAdded:
@@ -600,19 +623,114 @@ void MapObjectModel::documentChanged(const ChangeEvent &change)
     }
 }
 
+/**
+ * Schedules a dataChanged signal for the given \a objects, \a columns and
+ * \a roles.
+ *
+ * The changes are collected until returning to the event loop, so that
+ * changes to many objects can be reported as a few ranges of rows.
+ */
 void MapObjectModel::emitDataChanged(const QList<MapObject *> &objects,
                                      const QVarLengthArray<Column, 3> &columns,
                                      const QVector<int> &roles)
 {
-    if (columns.isEmpty())
+    if (columns.isEmpty() || objects.isEmpty())
         return;
 
     auto minMaxPair = std::minmax_element(columns.begin(), columns.end());
-    for (auto object : objects) {
-        emit dataChanged(index(object, *minMaxPair.first),
-                         index(object, *minMaxPair.second),
-                         roles);
+    mChangedFirstColumn = std::min<int>(mChangedFirstColumn, *minMaxPair.first);
+    mChangedLastColumn = std::max<int>(mChangedLastColumn, *minMaxPair.second);
+
+    if (roles.isEmpty()) {
+        mAllRolesChanged = true;
+    } else {
+        for (int role : roles)
+            if (!mChangedRoles.contains(role))
+                mChangedRoles.append(role);
     }
+
+    for (MapObject *object : objects)
+        mChangedObjects.insert(object);
+
+    if (!mDataChangedTimer.isActive())
+        mDataChangedTimer.start();
+}
+
+/**
+ * Emits the scheduled dataChanged signals. Needs to be called before any
+ * rows are inserted, removed or moved.
+ */
+void MapObjectModel::emitPendingDataChanged()
+{
+    mDataChangedTimer.stop();
+
+    if (mChangedObjects.isEmpty())
+        return;
+
+    QHash<ObjectGroup*, QVector<int>> rowsPerGroup;
+    for (MapObject *object : std::as_const(mChangedObjects)) {
+        ObjectGroup *objectGroup = object->objectGroup();
+        if (objectGroup && objectGroup->map() == map())
+            rowsPerGroup[objectGroup].append(objectRow(object));
+    }
+
+    const int firstColumn = mChangedFirstColumn;
+    const int lastColumn = mChangedLastColumn;
+    const QVector<int> roles = mAllRolesChanged ? QVector<int>() : mChangedRoles;
+
+    mChangedObjects.clear();
+    mChangedFirstColumn = ColumnCount;
+    mChangedLastColumn = -1;
+    mChangedRoles.clear();
+    mAllRolesChanged = false;
+
+    for (auto it = rowsPerGroup.begin(), it_end = rowsPerGroup.end(); it != it_end; ++it) {
+        const QModelIndex parent = index(it.key());
+        QVector<int> &rows = it.value();
+        std::sort(rows.begin(), rows.end());
+
+        // Emit one signal for each range of consecutive rows
+        int start = 0;
+        for (int i = 1; i <= rows.size(); ++i) {
+            if (i == rows.size() || rows.at(i) != rows.at(i - 1) + 1) {
+                emit dataChanged(index(rows.at(start), firstColumn, parent),
+                                 index(rows.at(i - 1), lastColumn, parent),
+                                 roles);
+                start = i;
+            }
+        }
+    }
+}
+
+/**
+ * Returns the row of the given \a mapObject within its object group.
+ *
+ * Rows are looked up in a table, which is updated when it turns out to be
+ * outdated by changes in the order of the objects.
+ */
+int MapObjectModel::objectRow(MapObject *mapObject) const
+{
+    const ObjectGroup *objectGroup = mapObject->objectGroup();
+    const QList<MapObject*> &objects = objectGroup->objects();
+    QHash<const MapObject*, int> &rows = mObjectRows[objectGroup];
+
+    const int row = rows.value(mapObject, -1);
+    if (row != -1 && row < objects.size() && objects.at(row) == mapObject)
+        return row;
+
+    // Objects are usually added at the end
+    const int lastRow = objects.size() - 1;
+    if (lastRow >= 0 && objects.at(lastRow) == mapObject) {
+        rows.insert(mapObject, lastRow);
+        return lastRow;
+    }
+
+    rows.clear();
+    rows.reserve(objects.size());
+    for (int i = 0; i < objects.size(); ++i)
+        rows.insert(objects.at(i), i);
+
+    return rows.value(mapObject, -1);
 }
 
 Map *MapObjectModel::map() const
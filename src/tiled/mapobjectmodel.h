@@ -24,7 +24,10 @@
 #include "mapobject.h"
 
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QIcon>
+#include <QSet>
+#include <QTimer>
 
 namespace Tiled {
 
@@ -119,6 +122,9 @@ private:
     void emitDataChanged(const QList<MapObject *> &objects,
                          const QVarLengthArray<Column, 3> &columns,
                          const QVector<int> &roles = QVector<int>());
+    void emitPendingDataChanged();
+
+    int objectRow(MapObject *mapObject) const;
 
     Map *map() const;
 
@@ -128,6 +134,17 @@ private:
     mutable QMap<GroupLayer*, QList<Layer*>> mFilteredLayers;
     QList<Layer *> &filteredChildLayers(GroupLayer *parentLayer) const;
 
+    // Rows of the objects, which may be outdated and are verified on use
+    mutable QHash<const ObjectGroup*, QHash<const MapObject*, int>> mObjectRows;
+
+    // Changes to be reported in one go when returning to the event loop
+    QSet<MapObject*> mChangedObjects;
+    int mChangedFirstColumn = ColumnCount;
+    int mChangedLastColumn = -1;
+    QVector<int> mChangedRoles;
+    bool mAllRolesChanged = false;
+    QTimer mDataChangedTimer;
+
     QIcon mObjectGroupIcon;
 };
 
@@ -36,6 +36,7 @@
 #include "snaphelper.h"
 #include "stylehelper.h"
 #include "templatemanager.h"
+#include "thumbnailcache.h"
 #include "tilesetmanager.h"
 #include "toolmanager.h"
 #include "world.h"
@@ -43,7 +44,9 @@
 
 #include <QApplication>
 #include <QFileInfo>
+#include <QGraphicsPixmapItem>
 #include <QGraphicsSceneMouseEvent>
+#include <QLineF>
 #include <QKeyEvent>
 #include <QMimeData>
 #include <QPalette>
@@ -51,6 +54,10 @@
 using namespace Tiled;
 
 SessionOption<bool> MapScene::enableWorlds { "mapScene.enableWorlds", true };
+SessionOption<bool> MapScene::streamWorldMaps { "mapScene.streamWorldMaps", false };
+
+// Below this scale, other maps of the world are only shown as thumbnails
+static constexpr qreal MinimumWorldMapDetailScale = 0.25;
 
 MapScene::MapScene(QObject *parent)
     : QGraphicsScene(parent)
@@ -65,7 +72,9 @@ MapScene::MapScene(QObject *parent)
     connect(tilesetManager, &TilesetManager::tilesetImagesChanged,
             this, &MapScene::repaintTileset);
     connect(tilesetManager, &TilesetManager::repaintTileset,
-            this, &MapScene::repaintTileset);
+            this, &MapScene::repaintTileAnimations);
+    connect(tilesetManager, &TilesetManager::tileAnimationsAdvanced,
+            this, &MapScene::repaintAnimatedTiles);
 
     WorldManager &worldManager = WorldManager::instance();
     connect(&worldManager, &WorldManager::worldsChanged, this, &MapScene::refreshScene);
@@ -75,6 +84,10 @@ MapScene::MapScene(QObject *parent)
     qApp->installEventFilter(this);
 
     mEnableWorldsCallback = enableWorlds.onChange([this] { setWorldsEnabled(enableWorlds); });
+    mStreamWorldMapsCallback = streamWorldMaps.onChange([this] { refreshScene(); });
+
+    mWorldMapsUpdateTimer.setSingleShot(true);
+    connect(&mWorldMapsUpdateTimer, &QTimer::timeout, this, &MapScene::updateWorldMaps);
 
 #ifdef QT_DEBUG
     mDebugDrawItem = new DebugDrawItem;
@@ -85,6 +98,7 @@ MapScene::MapScene(QObject *parent)
 MapScene::~MapScene()
 {
     enableWorlds.unregister(mEnableWorldsCallback);
+    streamWorldMaps.unregister(mStreamWorldMapsCallback);
 
     qApp->removeEventFilter(this);
 }
@@ -141,8 +155,12 @@ void MapScene::setParallaxEnabled(bool enabled)
  */
 void MapScene::setPainterScale(qreal painterScale)
 {
+    mPainterScale = painterScale;
+
     for (auto mapItem : std::as_const(mMapItems))
         mapItem->mapDocument()->renderer()->setPainterScale(painterScale);
+
+    scheduleWorldMapsUpdate();
 }
 
 void MapScene::setSuppressMouseMoveEvents(bool suppress)
@@ -211,6 +229,8 @@ void MapScene::setViewRect(const QRectF &rect)
 
     if (mParallaxEnabled)
         emit parallaxParametersChanged();
+
+    scheduleWorldMapsUpdate();
 }
 
 void MapScene::setOverrideBackgroundColor(QColor backgroundColor)
@@ -285,9 +305,13 @@ void MapScene::refreshScene()
 {
     QHash<MapDocument*, MapItem*> mapItems;
 
+    mStreamedMaps.clear();
+    mFailedMaps.clear();
+
     if (!mMapDocument) {
         mMapItems.swap(mapItems);
         qDeleteAll(mapItems);
+        qDeleteAll(std::exchange(mThumbnailItems, {}));
         updateSceneRect();
         return;
     }
@@ -298,12 +322,22 @@ void MapScene::refreshScene()
     if (const World *world = worldManager.worldForMap(currentMapFile)) {
         const QPoint currentMapPosition = world->mapRect(currentMapFile).topLeft();
         auto const contextMaps = world->contextMaps(currentMapFile);
+        const bool streaming = streamWorldMaps;
 
         for (const WorldMapEntry &mapEntry : contextMaps) {
             MapDocumentPtr mapDocument;
 
             if (mapEntry.fileName == currentMapFile) {
                 mapDocument = mMapDocument->sharedFromThis();
+            } else if (streaming) {
+                // Other maps are loaded once they come into view
+                WorldMapEntry streamedMap;
+                streamedMap.fileName = mapEntry.fileName;
+                streamedMap.rect = mapEntry.rect.translated(-currentMapPosition);
+                mStreamedMaps.append(streamedMap);
+
+                if (MapItem *mapItem = findMapItem(mapEntry.fileName))
+                    mapDocument = mapItem->mapDocument()->sharedFromThis();
             } else {
                 auto doc = DocumentManager::instance()->loadDocument(mapEntry.fileName);
                 mapDocument = doc.objectCast<MapDocument>();
@@ -331,6 +365,20 @@ void MapScene::refreshScene()
     for (MapItem *mapItem : std::as_const(mMapItems))
         mapItem->updateLayerPositions();
 
+    // Keep the thumbnails of maps that are still part of the world
+    QHash<QString, QGraphicsPixmapItem*> thumbnailItems;
+    for (const WorldMapEntry &mapEntry : std::as_const(mStreamedMaps)) {
+        if (QGraphicsPixmapItem *thumbnailItem = mThumbnailItems.take(mapEntry.fileName)) {
+            thumbnailItem->setPos(mapEntry.rect.topLeft());
+            thumbnailItem->setVisible(mWorldsEnabled && !findMapItem(mapEntry.fileName));
+            thumbnailItems.insert(mapEntry.fileName, thumbnailItem);
+        }
+    }
+    mThumbnailItems.swap(thumbnailItems);
+    qDeleteAll(thumbnailItems);
+
+    scheduleWorldMapsUpdate(0);
+
     updateBackgroundColor();
     updateSceneRect();
 
@@ -371,6 +419,10 @@ void MapScene::updateSceneRect()
     for (MapItem *mapItem : std::as_const(mMapItems))
         sceneRect |= mapItem->boundingRect().translated(mapItem->pos());
 
+    // Also cover the maps that aren't loaded, to allow scrolling to them
+    for (const WorldMapEntry &mapEntry : std::as_const(mStreamedMaps))
+        sceneRect |= QRectF(mapEntry.rect);
+
     setSceneRect(sceneRect);
 }
 
@@ -383,6 +435,164 @@ void MapScene::setWorldsEnabled(bool enabled)
 
     for (MapItem *mapItem : std::as_const(mMapItems))
         mapItem->setVisible(mWorldsEnabled || mapItem->mapDocument() == mMapDocument);
+
+    for (auto it = mThumbnailItems.cbegin(); it != mThumbnailItems.cend(); ++it)
+        it.value()->setVisible(mWorldsEnabled && !findMapItem(it.key()));
+
+    scheduleWorldMapsUpdate(0);
+}
+
+void MapScene::scheduleWorldMapsUpdate(int delay)
+{
+    if (!mStreamedMaps.isEmpty())
+        mWorldMapsUpdateTimer.start(delay);
+}
+
+/**
+ * Loads or unloads one of the other maps of the world, based on the view.
+ *
+ * Maps near the view are loaded, nearest first, with one map loaded per
+ * iteration of the event loop so the editor stays responsive. Maps that are
+ * far from the view are unloaded again. When zoomed out, maps are only shown
+ * as thumbnails, for which they are loaded only briefly.
+ */
+void MapScene::updateWorldMaps()
+{
+    if (mStreamedMaps.isEmpty() || !mWorldsEnabled || mViewRect.isEmpty())
+        return;
+
+    // Don't remove maps while they may be interacted with
+    if (QGuiApplication::mouseButtons() != Qt::NoButton) {
+        scheduleWorldMapsUpdate();
+        return;
+    }
+
+    const qreal width = mViewRect.width();
+    const qreal height = mViewRect.height();
+    const QRectF loadRect = mViewRect.adjusted(-width / 2, -height / 2, width / 2, height / 2);
+    const QRectF keepRect = mViewRect.adjusted(-width, -height, width, height);
+    const bool detailed = mPainterScale >= MinimumWorldMapDetailScale;
+
+    bool mapItemsRemoved = false;
+
+    for (auto it = mMapItems.begin(); it != mMapItems.end(); ) {
+        MapItem *mapItem = it.value();
+        const QRectF mapRect = mapItem->boundingRect().translated(mapItem->pos());
+
+        if (it.key() == mMapDocument || (detailed && keepRect.intersects(mapRect))) {
+            ++it;
+            continue;
+        }
+
+        const QString fileName = it.key()->canonicalFilePath();
+        for (const WorldMapEntry &mapEntry : std::as_const(mStreamedMaps)) {
+            if (mapEntry.fileName == fileName) {
+                const Map &map = *it.key()->map();
+                if (it.key()->isModified())
+                    setThumbnail(mapEntry, ThumbnailCache::renderThumbnail(map));
+                else
+                    setThumbnail(mapEntry, ThumbnailCache::instance().storeThumbnail(fileName, map));
+                break;
+            }
+        }
+
+        delete mapItem;
+        it = mMapItems.erase(it);
+        mapItemsRemoved = true;
+    }
+
+    if (mapItemsRemoved)
+        updateSceneRect();
+
+    const QPointF viewCenter = mViewRect.center();
+    const WorldMapEntry *nearestMap = nullptr;
+    qreal nearestDistance = 0;
+
+    for (const WorldMapEntry &mapEntry : std::as_const(mStreamedMaps)) {
+        if (!loadRect.intersects(mapEntry.rect) || mFailedMaps.contains(mapEntry.fileName))
+            continue;
+
+        const bool shown = detailed ? findMapItem(mapEntry.fileName) != nullptr
+                                    : mThumbnailItems.contains(mapEntry.fileName);
+        if (shown)
+            continue;
+
+        const qreal distance = QLineF(viewCenter, QRectF(mapEntry.rect).center()).length();
+        if (!nearestMap || distance < nearestDistance) {
+            nearestMap = &mapEntry;
+            nearestDistance = distance;
+        }
+    }
+
+    if (!nearestMap)
+        return;
+
+    // Avoid loading the map when a thumbnail was stored previously
+    if (!detailed) {
+        const QImage thumbnail = ThumbnailCache::instance().thumbnail(nearestMap->fileName);
+        if (!thumbnail.isNull()) {
+            setThumbnail(*nearestMap, thumbnail);
+            scheduleWorldMapsUpdate(0);
+            return;
+        }
+    }
+
+    auto doc = DocumentManager::instance()->loadDocument(nearestMap->fileName);
+    auto mapDocument = doc.objectCast<MapDocument>();
+
+    if (!mapDocument) {
+        mFailedMaps.insert(nearestMap->fileName);
+    } else if (detailed) {
+        auto mapItem = takeOrCreateMapItem(mapDocument, MapItem::ReadOnly);
+        mapItem->mapDocument()->renderer()->setPainterScale(mPainterScale);
+        mapItem->setPos(nearestMap->rect.topLeft());
+        mapItem->updateLayerPositions();
+        mMapItems.insert(mapDocument.data(), mapItem);
+
+        if (QGraphicsPixmapItem *thumbnailItem = mThumbnailItems.value(nearestMap->fileName))
+            thumbnailItem->setVisible(false);
+
+        updateSceneRect();
+    } else {
+        setThumbnail(*nearestMap, ThumbnailCache::instance().storeThumbnail(nearestMap->fileName,
+                                                                            *mapDocument->map()));
+    }
+
+    // Continue with the next map once pending events have been processed
+    scheduleWorldMapsUpdate(0);
+}
+
+MapItem *MapScene::findMapItem(const QString &fileName) const
+{
+    for (auto it = mMapItems.cbegin(); it != mMapItems.cend(); ++it)
+        if (it.key()->canonicalFilePath() == fileName)
+            return it.value();
+
+    return nullptr;
+}
+
+/**
+ * Sets the small \a image of a map, which is displayed in place of the map
+ * while it isn't loaded.
+ */
+void MapScene::setThumbnail(const WorldMapEntry &mapEntry, const QImage &image)
+{
+    if (mapEntry.rect.isEmpty() || image.isNull())
+        return;
+
+    QGraphicsPixmapItem *&thumbnailItem = mThumbnailItems[mapEntry.fileName];
+    if (!thumbnailItem) {
+        thumbnailItem = new QGraphicsPixmapItem;
+        thumbnailItem->setTransformationMode(Qt::SmoothTransformation);
+        thumbnailItem->setZValue(-1);
+        addItem(thumbnailItem);
+    }
+
+    thumbnailItem->setPixmap(QPixmap::fromImage(image));
+    thumbnailItem->setTransform(QTransform::fromScale(qreal(mapEntry.rect.width()) / image.width(),
+                                                      qreal(mapEntry.rect.height()) / image.height()));
+    thumbnailItem->setPos(mapEntry.rect.topLeft());
+    thumbnailItem->setVisible(mWorldsEnabled);
 }
 
 MapItem *MapScene::takeOrCreateMapItem(const MapDocumentPtr &mapDocument, MapItem::DisplayMode displayMode)
@@ -433,12 +643,54 @@ void MapScene::mapChanged()
 
 void MapScene::repaintTileset(Tileset *tileset)
 {
+    bool used = false;
+
     for (MapItem *mapItem : std::as_const(mMapItems)) {
         if (contains(mapItem->mapDocument()->map()->tilesets(), tileset)) {
-            update();
-            return;
+            mapItem->invalidateTileLayers(tileset);
+            used = true;
+        }
+    }
+
+    if (used)
+        update();
+}
+
+void MapScene::repaintTileAnimations(Tileset *tileset)
+{
+    bool used = false;
+
+    for (MapItem *mapItem : std::as_const(mMapItems)) {
+        if (contains(mapItem->mapDocument()->map()->tilesets(), tileset)) {
+            mapItem->invalidateTileAnimations(tileset);
+            used = true;
         }
     }
+
+    if (used)
+        update();
+}
+
+/**
+ * Repaints only the visible cells showing the given animated tiles, rather
+ * than invalidating all layers using the \a tileset.
+ */
+void MapScene::repaintAnimatedTiles(Tileset *tileset, const QVector<int> &tileIds)
+{
+    QSet<int> changedTileIds;
+
+    for (MapItem *mapItem : std::as_const(mMapItems)) {
+        if (!contains(mapItem->mapDocument()->map()->tilesets(), tileset))
+            continue;
+
+        if (changedTileIds.isEmpty()) {
+            changedTileIds.reserve(tileIds.size());
+            for (int tileId : tileIds)
+                changedTileIds.insert(tileId);
+        }
+
+        mapItem->repaintAnimatedTiles(tileset, changedTileIds);
+    }
 }
 
 void MapScene::tilesetReplaced(int index, Tileset *tileset, Tileset *oldTileset)
@@ -26,14 +26,20 @@
 #include "mapdocument.h"
 #include "mapitem.h"
 #include "session.h"
+#include "world.h"
 
 #include <QColor>
 #include <QGraphicsScene>
 #include <QHash>
+#include <QSet>
+#include <QTimer>
+
+class QGraphicsPixmapItem;
 
 namespace Tiled {
 
 class Layer;
+class Map;
 class MapObject;
 class ObjectGroup;
 class Tile;
@@ -85,6 +91,7 @@ public:
     QPointF parallaxOffset(const Layer &layer) const;
 
     static SessionOption<bool> enableWorlds;
+    static SessionOption<bool> streamWorldMaps;
 
 signals:
     void mapDocumentChanged(MapDocument *mapDocument);
@@ -114,6 +121,8 @@ private:
     void changeEvent(const ChangeEvent &change);
     void mapChanged();
     void repaintTileset(Tileset *tileset);
+    void repaintTileAnimations(Tileset *tileset);
+    void repaintAnimatedTiles(Tileset *tileset, const QVector<int> &tileIds);
 
     void tilesetReplaced(int index, Tileset *tileset, Tileset *oldTileset);
 
@@ -123,6 +132,11 @@ private:
 
     void setWorldsEnabled(bool enabled);
 
+    void scheduleWorldMapsUpdate(int delay = 100);
+    void updateWorldMaps();
+    MapItem *findMapItem(const QString &fileName) const;
+    void setThumbnail(const WorldMapEntry &mapEntry, const QImage &image);
+
     MapItem *takeOrCreateMapItem(const MapDocumentPtr &mapDocument,
                                  MapItem::DisplayMode displayMode);
 
@@ -141,10 +155,19 @@ private:
     bool mSuppressMouseMoveEvents = false;
     bool mMouseMoveEventSuppressed = false;
     Session::CallbackIterator mEnableWorldsCallback;
+    Session::CallbackIterator mStreamWorldMapsCallback;
     Qt::KeyboardModifiers mToolModifiers = Qt::NoModifier;
     Qt::KeyboardModifiers mLastModifiers = Qt::NoModifier;
     QPointF mLastMousePos;
     QRectF mViewRect;
+    qreal mPainterScale = 1.0;
+
+    // Used when streaming world maps, positioned relative to the current map
+    QVector<WorldMapEntry> mStreamedMaps;
+    QHash<QString, QGraphicsPixmapItem*> mThumbnailItems;
+    QSet<QString> mFailedMaps;
+    QTimer mWorldMapsUpdateTimer;
+
     QColor mDefaultBackgroundColor;
     QColor mOverrideBackgroundColor;
 };
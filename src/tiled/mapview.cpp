@@ -26,6 +26,7 @@
 #include "maprenderer.h"
 #include "mapscene.h"
 #include "objectgroup.h"
+#include "paintprofiler.h"
 #include "pannableviewhelper.h"
 #include "preferences.h"
 #include "tileanimationdriver.h"
@@ -34,8 +35,10 @@
 
 #include <QApplication>
 #include <QCursor>
+#include <QFontDatabase>
 #include <QGesture>
 #include <QGestureEvent>
+#include <QPainter>
 #include <QPinchGesture>
 #include <QScrollBar>
 #include <QWheelEvent>
@@ -118,6 +121,12 @@ MapView::MapView(QWidget *parent)
         setInteractive(mode == PannableViewHelper::NoPanning);
         updatePanningDriverState();
     });
+
+    auto profiler = PaintProfiler::instance();
+    connect(profiler, &PaintProfiler::enabledChanged,
+            this, &MapView::setPerformanceOverlayEnabled);
+    if (profiler->isEnabled())
+        setPerformanceOverlayEnabled(true);
 }
 
 MapView::~MapView()
@@ -355,6 +364,10 @@ void MapView::setMapDocument(MapDocument *mapDocument)
     if (mapDocument) {
         connect(mapDocument, &MapDocument::focusMapObjectRequested,
                 this, &MapView::focusMapObject);
+
+        auto countChange = [] { PaintProfiler::instance()->addChange(); };
+        connect(mapDocument, &Document::changed, this, countChange);
+        connect(mapDocument, &MapDocument::regionChanged, this, countChange);
     }
 }
 
@@ -477,7 +490,85 @@ void MapView::paintEvent(QPaintEvent *event)
     if (auto scene = mapScene())
         scene->setPainterScale(scale());
 
+    auto profiler = PaintProfiler::instance();
+    if (!profiler->isEnabled()) {
+        QGraphicsView::paintEvent(event);
+        return;
+    }
+
+    profiler->beginFrame();
     QGraphicsView::paintEvent(event);
+    profiler->endFrame();
+
+    drawPerformanceOverlay();
+}
+
+/**
+ * Enables or disables the performance overlay. While it is enabled, the
+ * whole viewport is repainted on each update, which makes the timings
+ * comparable and avoids scrolling the overlay along with the map.
+ */
+void MapView::setPerformanceOverlayEnabled(bool enabled)
+{
+    setViewportUpdateMode(enabled ? FullViewportUpdate : MinimalViewportUpdate);
+    viewport()->update();
+}
+
+/**
+ * Draws the statistics of the last frame in the top-left corner.
+ */
+void MapView::drawPerformanceOverlay()
+{
+    // Only the most expensive layers are listed
+    constexpr int MaxLayers = 10;
+
+    const auto profiler = PaintProfiler::instance();
+    const auto &frame = profiler->lastFrame();
+    const auto &statistics = frame.statistics;
+
+    QStringList lines;
+    lines.append(tr("Frame: %1 ms (%2 fps)")
+                 .arg(frame.paintTime / 1e6, 0, 'f', 2)
+                 .arg(profiler->framesPerSecond()));
+    lines.append(tr("Cells: %1, flushes: %2 (%3 tinted)")
+                 .arg(statistics.cellsDrawn)
+                 .arg(statistics.flushes)
+                 .arg(statistics.tintedFlushes));
+    lines.append(tr("Tint cache: %1 hits, %2 misses")
+                 .arg(statistics.tintCacheHits)
+                 .arg(statistics.tintCacheMisses));
+    lines.append(tr("Changes: %1/s").arg(profiler->changesPerSecond()));
+
+    for (const auto &entry : frame.layers.mid(0, MaxLayers)) {
+        lines.append(tr("%1: %2 ms, %3 cells, %4 flushes")
+                     .arg(entry.name)
+                     .arg(entry.paintTime / 1e6, 0, 'f', 2)
+                     .arg(entry.statistics.cellsDrawn)
+                     .arg(entry.statistics.flushes));
+    }
+
+    const QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    const QFontMetrics metrics(font);
+    const int margin = Utils::dpiScaled(4);
+
+    int width = 0;
+    for (const QString &line : std::as_const(lines))
+        width = std::max(width, metrics.horizontalAdvance(line));
+
+    const QRect rect(0, 0,
+                     width + margin * 2,
+                     metrics.lineSpacing() * lines.size() + margin * 2);
+
+    QPainter painter(viewport());
+    painter.fillRect(rect, QColor(0, 0, 0, 160));
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+
+    int y = margin + metrics.ascent();
+    for (const QString &line : std::as_const(lines)) {
+        painter.drawText(margin, y, line);
+        y += metrics.lineSpacing();
+    }
 }
 
 void MapView::hideEvent(QHideEvent *event)
@@ -113,6 +113,9 @@ private:
     void focusMapObject(MapObject *mapObject);
     void updateCursor();
 
+    void setPerformanceOverlayEnabled(bool enabled);
+    void drawPerformanceOverlay();
+
     enum PanDirectionFlag {
         Left    = 0x1,
         Right   = 0x2,
@@ -0,0 +1,173 @@
+/*
+ * memoryreport.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memoryreport.h"
+
+#include "documentmanager.h"
+#include "grouplayer.h"
+#include "imagecache.h"
+#include "imagelayer.h"
+#include "map.h"
+#include "mapdocument.h"
+#include "mapeditor.h"
+#include "maprenderer.h"
+#include "mapscene.h"
+#include "mapview.h"
+#include "objectgroup.h"
+#include "tilelayer.h"
+#include "tileset.h"
+#include "tilesetdocument.h"
+#include "undocommands.h"
+
+#include <QUndoStack>
+
+namespace Tiled {
+
+static MemoryReportEntry entry(const QString &name, qint64 bytes)
+{
+    MemoryReportEntry entry;
+    entry.name = name;
+    entry.bytes = bytes;
+    return entry;
+}
+
+/**
+ * Appends \a child to the children of \a parent and adds its size.
+ */
+static void addChild(MemoryReportEntry &parent, MemoryReportEntry child)
+{
+    if (child.bytes > 0)
+        parent.bytes += child.bytes;
+    parent.children.append(std::move(child));
+}
+
+static MemoryReportEntry layerEntry(const Layer &layer)
+{
+    switch (layer.layerType()) {
+    case Layer::TileLayerType: {
+        auto &tileLayer = static_cast<const TileLayer&>(layer);
+        return entry(layer.name(), tileLayer.memoryUsage() +
+                     propertiesMemoryUsage(layer.properties()));
+    }
+    case Layer::ObjectGroupType: {
+        auto &objectGroup = static_cast<const ObjectGroup&>(layer);
+        auto result = entry(layer.name(), objectGroup.memoryUsage());
+        result.count = objectGroup.objectCount();
+        return result;
+    }
+    case Layer::ImageLayerType:
+        return entry(layer.name(), static_cast<const ImageLayer&>(layer).memoryUsage());
+    case Layer::GroupLayerType: {
+        auto result = entry(layer.name(), sizeof(GroupLayer) +
+                            propertiesMemoryUsage(layer.properties()));
+        for (const Layer *childLayer : static_cast<const GroupLayer&>(layer))
+            addChild(result, layerEntry(*childLayer));
+        return result;
+    }
+    }
+
+    return entry(layer.name(), -1);
+}
+
+static MemoryReportEntry undoStackEntry(const Document &document)
+{
+    const QUndoStack *undoStack = document.undoStack();
+
+    auto result = entry(MemoryReport::tr("Undo stack"), undoMemoryUsage(undoStack));
+    result.count = undoStack->count();
+    return result;
+}
+
+/**
+ * Returns the memory report for the given \a document. The size of the
+ * tileset images includes images that may be shared with the image cache or
+ * with other documents.
+ */
+MemoryReportEntry MemoryReport::forDocument(Document *document)
+{
+    auto result = entry(document->displayName(), 0);
+
+    if (auto mapDocument = qobject_cast<MapDocument*>(document)) {
+        const Map *map = mapDocument->map();
+
+        auto layers = entry(tr("Layers"), 0);
+        for (const Layer *layer : map->layers())
+            addChild(layers, layerEntry(*layer));
+        addChild(result, std::move(layers));
+
+        auto tilesets = entry(tr("Tilesets"), 0);
+        for (const SharedTileset &tileset : map->tilesets())
+            addChild(tilesets, entry(tileset->name(), tileset->memoryUsage()));
+        addChild(result, std::move(tilesets));
+
+        // The memory used by scene items is not known, only their number
+        auto editor = static_cast<MapEditor*>(DocumentManager::instance()->editor(Document::MapDocumentType));
+        if (MapView *view = editor ? editor->viewForDocument(mapDocument) : nullptr) {
+            auto sceneItems = entry(tr("Scene items"), -1);
+            sceneItems.count = view->mapScene()->items().size();
+            addChild(result, std::move(sceneItems));
+        }
+    } else if (auto tilesetDocument = qobject_cast<TilesetDocument*>(document)) {
+        const Tileset *tileset = tilesetDocument->tileset().data();
+        auto tilesetEntry = entry(tileset->name(), tileset->memoryUsage());
+        tilesetEntry.count = tileset->tileCount();
+        addChild(result, std::move(tilesetEntry));
+    }
+
+    addChild(result, undoStackEntry(*document));
+
+    return result;
+}
+
+/**
+ * Returns the memory report for the caches shared by all documents.
+ */
+MemoryReportEntry MemoryReport::forSharedCaches()
+{
+    auto result = entry(tr("Shared caches"), 0);
+    addChild(result, entry(tr("Image cache"), ImageCache::memoryUsage()));
+    addChild(result, entry(tr("Tint cache"), MapRenderer::tintCacheMemoryUsage()));
+    return result;
+}
+
+/**
+ * Converts this entry to a map with "name", "bytes", "count" and "children"
+ * members, used by the scripting API.
+ */
+QVariantMap MemoryReportEntry::toVariant() const
+{
+    QVariantList childList;
+    for (const MemoryReportEntry &child : children)
+        childList.append(child.toVariant());
+
+    QVariantMap map {
+        { QStringLiteral("name"), name },
+        { QStringLiteral("bytes"), bytes },
+    };
+
+    if (count >= 0)
+        map.insert(QStringLiteral("count"), count);
+    if (!childList.isEmpty())
+        map.insert(QStringLiteral("children"), childList);
+
+    return map;
+}
+
+} // namespace Tiled
@@ -0,0 +1,59 @@
+/*
+ * memoryreport.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+namespace Tiled {
+
+class Document;
+
+/**
+ * An entry in a report of the memory used by the open documents. The size of
+ * an entry with children is the sum of the sizes of its children.
+ */
+struct MemoryReportEntry
+{
+    QString name;
+    qint64 bytes = 0;           // -1 when the size is not known
+    int count = -1;             // number of items, when applicable
+    QVector<MemoryReportEntry> children;
+
+    QVariantMap toVariant() const;
+};
+
+/**
+ * Creates reports of the approximate amount of memory used by documents and
+ * shared caches, for finding out what takes up memory.
+ */
+class MemoryReport
+{
+    Q_DECLARE_TR_FUNCTIONS(MemoryReport)
+
+public:
+    static MemoryReportEntry forDocument(Document *document);
+    static MemoryReportEntry forSharedCaches();
+};
+
+} // namespace Tiled
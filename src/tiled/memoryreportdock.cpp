@@ -0,0 +1,135 @@
+/*
+ * memoryreportdock.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memoryreportdock.h"
+
+#include "documentmanager.h"
+#include "memoryreport.h"
+#include "utils.h"
+
+#include <QEvent>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLocale>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace Tiled {
+
+MemoryReportDock::MemoryReportDock(QWidget *parent)
+    : QDockWidget(parent)
+    , mTreeWidget(new QTreeWidget)
+    , mRefreshButton(new QPushButton)
+{
+    setObjectName(QLatin1String("MemoryReportDock"));
+
+    mTreeWidget->setColumnCount(3);
+    mTreeWidget->setUniformRowHeights(true);
+    mTreeWidget->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    mTreeWidget->header()->setStretchLastSection(false);
+
+    connect(mRefreshButton, &QPushButton::clicked, this, &MemoryReportDock::refresh);
+
+    // The report is only created when needed, since it walks all data
+    connect(this, &QDockWidget::visibilityChanged, this, [this] (bool visible) {
+        if (visible)
+            refresh();
+    });
+
+    auto toolBarLayout = new QHBoxLayout;
+    toolBarLayout->addStretch();
+    toolBarLayout->addWidget(mRefreshButton);
+    toolBarLayout->setSpacing(Utils::dpiScaled(7));
+
+    auto widget = new QWidget(this);
+    auto layout = new QVBoxLayout(widget);
+
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+    layout->addLayout(toolBarLayout);
+    layout->addWidget(mTreeWidget);
+
+    setWidget(widget);
+
+    retranslateUi();
+}
+
+void MemoryReportDock::changeEvent(QEvent *e)
+{
+    QDockWidget::changeEvent(e);
+
+    switch (e->type()) {
+    case QEvent::LanguageChange:
+        retranslateUi();
+        break;
+    default:
+        break;
+    }
+}
+
+void MemoryReportDock::refresh()
+{
+    mTreeWidget->clear();
+
+    auto documentManager = DocumentManager::maybeInstance();
+    if (documentManager) {
+        for (const auto &document : documentManager->documents()) {
+            addEntry(nullptr, MemoryReport::forDocument(document.data()));
+
+            if (document.data() == documentManager->currentDocument())
+                mTreeWidget->topLevelItem(mTreeWidget->topLevelItemCount() - 1)->setExpanded(true);
+        }
+    }
+
+    addEntry(nullptr, MemoryReport::forSharedCaches());
+
+    mTreeWidget->resizeColumnToContents(1);
+    mTreeWidget->resizeColumnToContents(2);
+}
+
+void MemoryReportDock::addEntry(QTreeWidgetItem *parent, const MemoryReportEntry &entry)
+{
+    auto item = parent ? new QTreeWidgetItem(parent)
+                       : new QTreeWidgetItem(mTreeWidget);
+
+    item->setText(0, entry.name);
+    item->setText(1, entry.bytes >= 0 ? QLocale().formattedDataSize(entry.bytes)
+                                      : tr("Unknown"));
+    if (entry.count >= 0)
+        item->setText(2, QString::number(entry.count));
+
+    item->setTextAlignment(1, Qt::AlignRight | Qt::AlignVCenter);
+    item->setTextAlignment(2, Qt::AlignRight | Qt::AlignVCenter);
+
+    for (const MemoryReportEntry &child : entry.children)
+        addEntry(item, child);
+}
+
+void MemoryReportDock::retranslateUi()
+{
+    setWindowTitle(tr("Memory Report"));
+    mTreeWidget->setHeaderLabels({ tr("Name"), tr("Size"), tr("Count") });
+    mRefreshButton->setText(tr("Refresh"));
+}
+
+} // namespace Tiled
+
+#include "moc_memoryreportdock.cpp"
@@ -0,0 +1,56 @@
+/*
+ * memoryreportdock.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QDockWidget>
+
+class QPushButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+namespace Tiled {
+
+struct MemoryReportEntry;
+
+/**
+ * A dock widget that shows the approximate amount of memory used by the
+ * open documents and the shared caches.
+ */
+class MemoryReportDock : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    MemoryReportDock(QWidget *parent = nullptr);
+
+protected:
+    void changeEvent(QEvent *e) override;
+
+private:
+    void refresh();
+    void addEntry(QTreeWidgetItem *parent, const MemoryReportEntry &entry);
+    void retranslateUi();
+
+    QTreeWidget *mTreeWidget;
+    QPushButton *mRefreshButton;
+};
+
+} // namespace Tiled
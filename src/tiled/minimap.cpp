@@ -33,13 +33,13 @@
 #include <QCursor>
 #include <QResizeEvent>
 #include <QScrollBar>
-#include <QUndoStack>
 
 using namespace Tiled;
 
 MiniMap::MiniMap(QWidget *parent)
     : QFrame(parent)
     , mMapDocument(nullptr)
+    , mImageValid(false)
     , mDragging(false)
     , mMouseMoveCursorState(false)
     , mRedrawMapImage(false)
@@ -74,7 +74,29 @@ void MiniMap::setMapDocument(MapDocument *map)
     mMapDocument = map;
 
     if (mMapDocument) {
-        connect(mMapDocument->undoStack(), &QUndoStack::indexChanged,
+        // Changes to tile layer contents only need the changed area to be
+        // rendered again, while other changes redraw the whole image
+        connect(mMapDocument, &MapDocument::regionChanged,
+                this, &MiniMap::scheduleRegionUpdate);
+        connect(mMapDocument, &Document::changed,
+                this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::mapChanged,
+                this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::tileLayerChanged,
+                this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::layerAdded,
+                this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::layerRemoved,
+                this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::tilesetReplaced,
+                this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::tilesetTilePositioningChanged,
+                this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::tileImageSourceChanged,
+                this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::objectsInserted,
+                this, &MiniMap::scheduleMapImageUpdate);
+        connect(mMapDocument, &MapDocument::objectsIndexChanged,
                 this, &MiniMap::scheduleMapImageUpdate);
 
         if (MapView *mapView = dm->viewForDocument(mMapDocument))
@@ -91,6 +113,25 @@ QSize MiniMap::sizeHint() const
 
 void MiniMap::scheduleMapImageUpdate()
 {
+    mImageValid = false;
+    mMapImageUpdateTimer.start(100);
+}
+
+/**
+ * Schedules a redraw of the part of the minimap image showing the given
+ * \a region (in tile coordinates) of \a tileLayer.
+ */
+void MiniMap::scheduleRegionUpdate(const QRegion &region, TileLayer *tileLayer)
+{
+    const MapRenderer *renderer = mMapDocument->renderer();
+    const QMargins margins = mMapDocument->map()->drawMargins();
+    const QPoint offset = tileLayer->totalOffset().toPoint();
+
+    for (const QRect &r : region) {
+        const QRect boundingRect = renderer->boundingRect(r).marginsAdded(margins);
+        mDirtyRect |= boundingRect.translated(offset).adjusted(-1, -1, 1, 1);
+    }
+
     mMapImageUpdateTimer.start(100);
 }
 
@@ -157,8 +198,12 @@ void MiniMap::updateImageRect()
 
 void MiniMap::renderMapToImage()
 {
+    const QRect dirtyRect = mDirtyRect;
+    mDirtyRect = QRect();
+
     if (!mMapDocument) {
         mMapImage = QImage();
+        mImageValid = false;
         return;
     }
 
@@ -167,6 +212,7 @@ void MiniMap::renderMapToImage()
     const QSize mapSize = miniMapRenderer.mapSize();
     if (mapSize.isEmpty()) {
         mMapImage = QImage();
+        mImageValid = false;
         return;
     }
 
@@ -184,13 +230,27 @@ void MiniMap::renderMapToImage()
     // Allocate a new image when the size changed
     if (mMapImage.size() != imageSize) {
         mMapImage = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+        mImageValid = false;
         updateImageRect();
     }
 
     if (imageSize.isEmpty())
         return;
 
+    // The previous image can only be updated when the map size is the same
+    if (mMapSize != mapSize) {
+        mMapSize = mapSize;
+        mImageValid = false;
+    }
+
+    if (mImageValid) {
+        if (!dirtyRect.isEmpty())
+            miniMapRenderer.renderToImage(mMapImage, mRenderFlags, dirtyRect);
+        return;
+    }
+
     miniMapRenderer.renderToImage(mMapImage, mRenderFlags);
+    mImageValid = true;
 }
 
 void MiniMap::centerViewOnLocalPixel(const QPointF &centerPos, int delta)
@@ -30,6 +30,7 @@
 namespace Tiled {
 
 class MapDocument;
+class TileLayer;
 
 class MiniMap : public QFrame
 {
@@ -41,7 +42,7 @@ public:
     void setMapDocument(MapDocument *);
 
     MiniMapRenderer::RenderFlags renderFlags() const { return mRenderFlags; }
-    void setRenderFlags(MiniMapRenderer::RenderFlags flags) { mRenderFlags = flags; }
+    void setRenderFlags(MiniMapRenderer::RenderFlags flags) { mRenderFlags = flags; mImageValid = false; }
 
     QSize sizeHint() const override;
 
@@ -59,9 +60,13 @@ protected:
 
 private:
     void redrawTimeout();
+    void scheduleRegionUpdate(const QRegion &region, TileLayer *tileLayer);
 
     MapDocument *mMapDocument;
     QImage mMapImage;
+    QSize mMapSize;
+    QRect mDirtyRect;
+    bool mImageValid;
     QRect mImageRect;
     QTimer mMapImageUpdateTimer;
     bool mDragging;
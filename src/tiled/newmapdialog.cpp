@@ -78,6 +78,9 @@ NewMapDialog::NewMapDialog(QWidget *parent) :
     mUi->layerFormat->addItem(QCoreApplication::translate("PreferencesDialog", "Base64 (zlib compressed)"), QVariant::fromValue(Map::Base64Zlib));
     if (compressionSupported(Zstandard))
         mUi->layerFormat->addItem(QCoreApplication::translate("PreferencesDialog", "Base64 (Zstandard compressed)"), QVariant::fromValue(Map::Base64Zstandard));
+    mUi->layerFormat->addItem(QCoreApplication::translate("PreferencesDialog", "Base64 (run-length encoded)"), QVariant::fromValue(Map::Base64RunLength));
+    if (compressionSupported(Zstandard))
+        mUi->layerFormat->addItem(QCoreApplication::translate("PreferencesDialog", "Base64 (run-length encoded, Zstandard compressed)"), QVariant::fromValue(Map::Base64RunLengthZstandard));
 
     mUi->renderOrder->addItem(QCoreApplication::translate("PreferencesDialog", "Right Down"), QVariant::fromValue(Map::RightDown));
     mUi->renderOrder->addItem(QCoreApplication::translate("PreferencesDialog", "Right Up"), QVariant::fromValue(Map::RightUp));
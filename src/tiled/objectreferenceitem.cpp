@@ -31,6 +31,7 @@
 
 #include <QPainter>
 #include <QPen>
+#include <QStyleOptionGraphicsItem>
 #include <QVector2D>
 
 #include <array>
@@ -38,10 +39,83 @@
 
 namespace Tiled {
 
+static constexpr qreal arrowHeadSize = 7.0;
+
+static constexpr std::array<QPointF, 4> arrowHead = {
+    QPointF(0.0, 0.0),
+    QPointF(-2 * arrowHeadSize, arrowHeadSize),
+    QPointF(-1.5 * arrowHeadSize, 0.0),
+    QPointF(-2 * arrowHeadSize, -arrowHeadSize)
+};
+
+static QPointF objectCenter(const QGraphicsItem *item,
+                            MapObject *object,
+                            const MapRenderer &renderer)
+{
+    QPointF screenPos = renderer.pixelToScreenCoords(object->position());
+
+    if (object->shape() != MapObject::Point) {
+        QRectF bounds = object->screenBounds(renderer);
+
+        // Adjust the bounding box for object rotation
+        bounds = rotateAt(screenPos, object->rotation()).mapRect(bounds);
+        screenPos = bounds.center();
+    }
+
+    if (auto mapScene = qobject_cast<MapScene*>(item->scene()))
+        screenPos += mapScene->absolutePositionForLayer(*object->objectGroup());
+
+    return screenPos;
+}
+
+static qreal arrowAngle(const QPointF &sourcePos, const QPointF &targetPos)
+{
+    qreal dx = targetPos.x() - sourcePos.x();
+    qreal dy = targetPos.y() - sourcePos.y();
+    return std::atan2(dy, dx) * 180 / M_PI;
+}
+
+/**
+ * Draws the dashed line of a reference, leaving room for the arrow head.
+ */
+static void drawReferenceLine(QPainter *painter,
+                              const QPointF &sourcePos,
+                              const QPointF &targetPos,
+                              const QColor &color,
+                              qreal painterScale)
+{
+    auto lineWidth = Preferences::instance()->objectLineWidth();
+    auto shadowDist = (lineWidth == 0 ? 1 : lineWidth) / painterScale;
+    auto shadowOffset = QPointF(shadowDist * 0.5, shadowDist * 0.5);
+    auto devicePixelRatio = painter->device()->devicePixelRatioF();
+    auto dashLength = std::ceil(Utils::dpiScaled(2) * devicePixelRatio);
+    auto lineLength = static_cast<qreal>(QVector2D(targetPos - sourcePos).length());
+    auto dashOffset = lineLength * -0.5 * painterScale / lineWidth;
+
+    auto pen = QPen(color, lineWidth, Qt::SolidLine, Qt::RoundCap);
+    pen.setCosmetic(true);
+    pen.setDashPattern({dashLength, dashLength});
+    pen.setDashOffset(dashOffset);
+
+    auto shadowPen = pen;
+    shadowPen.setColor(Qt::black);
+
+    auto direction = QVector2D(targetPos - sourcePos).normalized().toPointF();
+    auto offset = direction * arrowHeadSize / painterScale;
+    auto start = sourcePos + offset;
+    auto end = targetPos - offset;
+
+    painter->setPen(shadowPen);
+    painter->drawLine(start + shadowOffset, end + shadowOffset);
+
+    painter->setPen(pen);
+    painter->drawLine(start, end);
+}
+
+
 class ArrowHead : public QGraphicsItem
 {
 public:
-    static constexpr qreal arrowHeadSize = 7.0;
 
     ArrowHead(QGraphicsItem *parent)
         : QGraphicsItem(parent)
@@ -68,13 +142,6 @@ QRectF ArrowHead::boundingRect() const
 
 void ArrowHead::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
 {
-    static constexpr std::array<QPointF, 4> arrowHead = {
-        QPointF(0.0, 0.0),
-        QPointF(-2 * arrowHeadSize, arrowHeadSize),
-        QPointF(-1.5 * arrowHeadSize, 0.0),
-        QPointF(-2 * arrowHeadSize, -arrowHeadSize)
-    };
-
     const qreal dpiScale = Utils::defaultDpiScale();
     painter->scale(dpiScale, dpiScale);
 
@@ -119,7 +186,7 @@ void ObjectReferenceItem::setTargetPos(const QPointF &pos)
 
 void ObjectReferenceItem::syncWithSourceObject(const MapRenderer &renderer)
 {
-    const QPointF sourcePos = objectCenter(mSourceObject, renderer);
+    const QPointF sourcePos = objectCenter(this, mSourceObject, renderer);
 
     if (mSourcePos != sourcePos) {
         prepareGeometryChange();
@@ -132,7 +199,7 @@ void ObjectReferenceItem::syncWithSourceObject(const MapRenderer &renderer)
 void ObjectReferenceItem::syncWithTargetObject(const MapRenderer &renderer)
 {
     if (mTargetObject)
-        setTargetPos(objectCenter(mTargetObject, renderer));
+        setTargetPos(objectCenter(this, mTargetObject, renderer));
     updateColor();  // color is based on target object
 }
 
@@ -149,9 +216,7 @@ void ObjectReferenceItem::updateColor()
 
 void ObjectReferenceItem::updateArrowRotation()
 {
-    qreal dx = mTargetPos.x() - mSourcePos.x();
-    qreal dy = mTargetPos.y() - mSourcePos.y();
-    mArrowHead->setRotation(std::atan2(dy, dx) * 180 / M_PI);
+    mArrowHead->setRotation(arrowAngle(mSourcePos, mTargetPos));
 }
 
 QRectF ObjectReferenceItem::boundingRect() const
@@ -165,52 +230,207 @@ void ObjectReferenceItem::paint(QPainter *painter, const QStyleOptionGraphicsIte
     if (auto mapScene = qobject_cast<MapScene*>(scene()))
         painterScale = mapScene->mapDocument()->renderer()->painterScale();
 
-    auto lineWidth = Preferences::instance()->objectLineWidth();
-    auto shadowDist = (lineWidth == 0 ? 1 : lineWidth) / painterScale;
-    auto shadowOffset = QPointF(shadowDist * 0.5, shadowDist * 0.5);
-    auto devicePixelRatio = painter->device()->devicePixelRatioF();
-    auto dashLength = std::ceil(Utils::dpiScaled(2) * devicePixelRatio);
-    auto lineLength = static_cast<qreal>(QVector2D(mTargetPos - mSourcePos).length());
-    auto dashOffset = lineLength * -0.5 * painterScale / lineWidth;
+    painter->setRenderHint(QPainter::Antialiasing);
+    drawReferenceLine(painter, mSourcePos, mTargetPos, mColor, painterScale);
+}
 
-    auto pen = QPen(mColor, lineWidth, Qt::SolidLine, Qt::RoundCap);
-    pen.setCosmetic(true);
-    pen.setDashPattern({dashLength, dashLength});
-    pen.setDashOffset(dashOffset);
 
-    auto shadowPen = pen;
-    shadowPen.setColor(Qt::black);
+ObjectReferencesItem::ObjectReferencesItem(QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    setZValue(-0.5); // below labels
+}
 
-    auto direction = QVector2D(mTargetPos - mSourcePos).normalized().toPointF();
-    auto offset = direction * ArrowHead::arrowHeadSize / painterScale;
-    auto start = mSourcePos + offset;
-    auto end = mTargetPos - offset;
+ObjectReferencesItem::~ObjectReferencesItem()
+{
+    qDeleteAll(mReferences);
+}
 
-    painter->setRenderHint(QPainter::Antialiasing);
+ObjectReference *ObjectReferencesItem::addReference(MapObject *source,
+                                                    MapObject *target,
+                                                    const MapRenderer &renderer)
+{
+    auto reference = new ObjectReference(source, target);
+    reference->mIndex = mReferences.size();
+    reference->mSourcePos = objectCenter(this, source, renderer);
+    reference->mTargetPos = objectCenter(this, target, renderer);
+    reference->mColor = target->effectiveColor();
+    mReferences.append(reference);
+
+    const QRectF rect = referenceRect(reference);
+    if (!mBounds.contains(rect)) {
+        prepareGeometryChange();
+        mBounds |= rect;
+    }
+    update(rect);
 
-    painter->setPen(shadowPen);
-    painter->drawLine(start + shadowOffset, end + shadowOffset);
+    return reference;
+}
 
-    painter->setPen(pen);
-    painter->drawLine(start, end);
+void ObjectReferencesItem::removeReference(ObjectReference *reference)
+{
+    Q_ASSERT(mReferences.at(reference->mIndex) == reference);
+
+    update(referenceRect(reference));
+
+    // Move the last reference into the freed slot
+    ObjectReference *last = mReferences.takeLast();
+    if (last != reference) {
+        mReferences[reference->mIndex] = last;
+        last->mIndex = reference->mIndex;
+    }
+
+    delete reference;
 }
 
-QPointF ObjectReferenceItem::objectCenter(MapObject *object, const MapRenderer &renderer) const
+void ObjectReferencesItem::clear()
 {
-    QPointF screenPos = renderer.pixelToScreenCoords(object->position());
+    prepareGeometryChange();
+    qDeleteAll(mReferences);
+    mReferences.clear();
+    mBounds = QRectF();
+}
 
-    if (object->shape() != MapObject::Point) {
-        QRectF bounds = object->screenBounds(renderer);
+void ObjectReferencesItem::syncWithSourceObject(ObjectReference *reference,
+                                                const MapRenderer &renderer)
+{
+    changeReference(reference,
+                    objectCenter(this, reference->mSourceObject, renderer),
+                    reference->mTargetPos);
+}
 
-        // Adjust the bounding box for object rotation
-        bounds = rotateAt(screenPos, object->rotation()).mapRect(bounds);
-        screenPos = bounds.center();
+void ObjectReferencesItem::syncWithTargetObject(ObjectReference *reference,
+                                                const MapRenderer &renderer)
+{
+    changeReference(reference,
+                    reference->mSourcePos,
+                    objectCenter(this, reference->mTargetObject, renderer));
+    updateColor(reference);    // color is based on target object
+}
+
+void ObjectReferencesItem::updateColor(ObjectReference *reference)
+{
+    const QColor color = reference->mTargetObject->effectiveColor();
+
+    if (reference->mColor != color) {
+        reference->mColor = color;
+        update(referenceRect(reference));
     }
+}
 
-    if (auto mapScene = qobject_cast<MapScene*>(scene()))
-        screenPos += mapScene->absolutePositionForLayer(*object->objectGroup());
+/**
+ * Shrinks the bounding rect to fit the current references, since it only
+ * grows while references are added or moved.
+ */
+void ObjectReferencesItem::recalculateBounds()
+{
+    QRectF bounds;
+    for (const ObjectReference *reference : std::as_const(mReferences))
+        bounds |= referenceRect(reference);
 
-    return screenPos;
+    if (mBounds != bounds) {
+        prepareGeometryChange();
+        mBounds = bounds;
+    }
+}
+
+QRectF ObjectReferencesItem::boundingRect() const
+{
+    if (mBounds.isNull())
+        return QRectF();
+
+    // Leave room for the arrow heads down to a scale of 1/16. Below that,
+    // the references usually fit in the view anyway.
+    const qreal margin = Utils::dpiScaled(2 * arrowHeadSize) * 16;
+    return mBounds.adjusted(-margin, -margin, margin, margin);
+}
+
+void ObjectReferencesItem::paint(QPainter *painter,
+                                 const QStyleOptionGraphicsItem *option,
+                                 QWidget *)
+{
+    const QTransform transform = painter->worldTransform();
+    mPainterScale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(transform);
+
+    const qreal margin = Utils::dpiScaled(2 * arrowHeadSize) / mPainterScale;
+    const QRectF exposedRect = option->exposedRect.adjusted(-margin, -margin, margin, margin);
+
+    QVector<const ObjectReference*> visibleReferences;
+
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    for (const ObjectReference *reference : std::as_const(mReferences)) {
+        if (!exposedRect.intersects(referenceRect(reference)))
+            continue;
+
+        drawReferenceLine(painter,
+                          reference->mSourcePos,
+                          reference->mTargetPos,
+                          reference->mColor,
+                          mPainterScale);
+
+        visibleReferences.append(reference);
+    }
+
+    if (visibleReferences.isEmpty())
+        return;
+
+    // Draw the arrow heads on top, ignoring the view transformation like
+    // the ArrowHead used by ObjectReferenceItem
+    QPen arrowOutline(Qt::black);
+    arrowOutline.setCosmetic(true);
+
+    const qreal dpiScale = Utils::defaultDpiScale();
+
+    painter->save();
+    painter->setPen(arrowOutline);
+
+    for (const ObjectReference *reference : std::as_const(visibleReferences)) {
+        const QPointF targetPos = transform.map(reference->mTargetPos);
+
+        QTransform arrowTransform;
+        arrowTransform.translate(targetPos.x(), targetPos.y());
+        arrowTransform.rotate(arrowAngle(reference->mSourcePos, reference->mTargetPos));
+        arrowTransform.scale(dpiScale, dpiScale);
+
+        painter->setTransform(arrowTransform);
+        painter->setBrush(reference->mColor);
+        painter->drawPolygon(arrowHead.data(), arrowHead.size());
+    }
+
+    painter->restore();
+}
+
+void ObjectReferencesItem::changeReference(ObjectReference *reference,
+                                           const QPointF &sourcePos,
+                                           const QPointF &targetPos)
+{
+    if (reference->mSourcePos == sourcePos && reference->mTargetPos == targetPos)
+        return;
+
+    update(referenceRect(reference));
+
+    reference->mSourcePos = sourcePos;
+    reference->mTargetPos = targetPos;
+
+    const QRectF rect = referenceRect(reference);
+    if (!mBounds.contains(rect)) {
+        prepareGeometryChange();
+        mBounds |= rect;
+    }
+    update(rect);
+}
+
+/**
+ * Returns the area covered by the line of the given \a reference, including
+ * the room needed for its arrow head at the last used painter scale.
+ */
+QRectF ObjectReferencesItem::referenceRect(const ObjectReference *reference) const
+{
+    const qreal margin = 5 + Utils::dpiScaled(2 * arrowHeadSize) / mPainterScale;
+    return QRectF(reference->mSourcePos, reference->mTargetPos).normalized()
+            .adjusted(-margin, -margin, margin, margin);
 }
 
 } // namespace Tiled
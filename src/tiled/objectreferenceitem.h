@@ -21,6 +21,7 @@
 #pragma once
 
 #include <QGraphicsItem>
+#include <QVector>
 
 namespace Tiled {
 
@@ -58,9 +59,6 @@ public:
 private:
     void updateArrowRotation();
 
-    QPointF objectCenter(MapObject *object,
-                         const MapRenderer &renderer) const;
-
     QPointF mSourcePos;
     QPointF mTargetPos;
     MapObject *mSourceObject;
@@ -69,4 +67,73 @@ private:
     QColor mColor;
 };
 
+/**
+ * A reference from a source object to a target object, displayed by an
+ * ObjectReferencesItem.
+ */
+class ObjectReference
+{
+public:
+    MapObject *sourceObject() const { return mSourceObject; }
+    MapObject *targetObject() const { return mTargetObject; }
+
+private:
+    friend class ObjectReferencesItem;
+
+    ObjectReference(MapObject *source, MapObject *target)
+        : mSourceObject(source)
+        , mTargetObject(target)
+    {}
+
+    MapObject *mSourceObject;
+    MapObject *mTargetObject;
+    QPointF mSourcePos;
+    QPointF mTargetPos;
+    QColor mColor;
+    int mIndex = -1;
+};
+
+/**
+ * Displays any number of object references using a single item, since maps
+ * with many references would otherwise need a huge number of items.
+ *
+ * Only the references intersecting the exposed area are drawn and changes to
+ * a reference only repaint the area it covers.
+ */
+class ObjectReferencesItem : public QGraphicsItem
+{
+public:
+    explicit ObjectReferencesItem(QGraphicsItem *parent = nullptr);
+    ~ObjectReferencesItem() override;
+
+    ObjectReference *addReference(MapObject *source,
+                                  MapObject *target,
+                                  const MapRenderer &renderer);
+    void removeReference(ObjectReference *reference);
+    void clear();
+
+    void syncWithSourceObject(ObjectReference *reference,
+                              const MapRenderer &renderer);
+    void syncWithTargetObject(ObjectReference *reference,
+                              const MapRenderer &renderer);
+    void updateColor(ObjectReference *reference);
+
+    void recalculateBounds();
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter,
+               const QStyleOptionGraphicsItem *option,
+               QWidget *) override;
+
+private:
+    void changeReference(ObjectReference *reference,
+                         const QPointF &sourcePos,
+                         const QPointF &targetPos);
+    QRectF referenceRect(const ObjectReference *reference) const;
+
+    QVector<ObjectReference*> mReferences;
+    QRectF mBounds;
+    qreal mPainterScale = 1.0;
+};
+
 } // namespace Tiled
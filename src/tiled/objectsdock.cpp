@@ -67,7 +67,21 @@ ObjectsDock::ObjectsDock(QWidget *parent)
 
     mFilterEdit->setFilteredView(mObjectsView);
 
-    connect(mFilterEdit, &QLineEdit::textChanged, mObjectsView, &ObjectsView::setFilter);
+    // Filter after a short delay, to avoid filtering many objects on each
+    // key press
+    mFilterTimer.setInterval(100);
+    mFilterTimer.setSingleShot(true);
+    connect(&mFilterTimer, &QTimer::timeout, this, [this] {
+        mObjectsView->setFilter(mFilterEdit->text());
+    });
+    connect(mFilterEdit, &QLineEdit::textChanged, this, [this] (const QString &text) {
+        if (text.isEmpty()) {
+            mFilterTimer.stop();
+            mObjectsView->setFilter(text);
+        } else {
+            mFilterTimer.start();
+        }
+    });
 
     mActionNewLayer = new QAction(this);
     mActionNewLayer->setIcon(QIcon(QLatin1String(":/images/16/document-new.png")));
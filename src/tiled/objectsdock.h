@@ -22,6 +22,7 @@
 
 #include <QDockWidget>
 #include <QMap>
+#include <QTimer>
 
 class QMenu;
 
@@ -61,6 +62,7 @@ private:
     QAction *mActionMoveDown;
 
     FilterEdit *mFilterEdit;
+    QTimer mFilterTimer;
     ObjectsView *mObjectsView;
     MapDocument *mMapDocument;
     QMenu *mMoveToMenu;
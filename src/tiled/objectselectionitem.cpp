@@ -36,6 +36,8 @@
 #include "variantpropertymanager.h"
 
 #include <QApplication>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
 #include <QTimerEvent>
 #include <QVector2D>
 
@@ -49,6 +51,10 @@ static constexpr qreal labelDistance = 4;
 static constexpr qreal selectionZValue = 1.0;   // selection outlines above labels
 static constexpr qreal hoverZValue = 0.5;       // hover below selection
 
+// Larger selections don't show labels, since creating them is expensive and
+// that many labels would mostly overlap anyway
+static constexpr int maxSelectedObjectLabels = 1000;
+
 static Preferences::ObjectLabelVisiblity objectLabelVisibility()
 {
     return Preferences::instance()->objectLabelVisibility();
@@ -166,6 +172,194 @@ void MapObjectOutline::timerEvent(QTimerEvent *event)
 }
 
 
+/**
+ * Draws the selection outlines of many objects as a single item, which is
+ * much cheaper for the scene than an item per object.
+ *
+ * Point objects are not included, since their outline does not scale with
+ * the view. They use a MapObjectOutline instead.
+ */
+class SelectionOutlinesItem : public QGraphicsObject
+{
+public:
+    explicit SelectionOutlinesItem(QGraphicsItem *parent = nullptr)
+        : QGraphicsObject(parent)
+    {
+        setZValue(selectionZValue);
+        setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    }
+
+    bool contains(MapObject *object) const { return mOutlines.contains(object); }
+
+    void setOutline(MapObject *object, const MapRenderer &renderer);
+    bool removeOutline(MapObject *object);
+    void clear();
+
+    void syncAll(const MapRenderer &renderer);
+    void updateBoundingRect();
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter,
+               const QStyleOptionGraphicsItem *option,
+               QWidget *) override;
+
+protected:
+    void timerEvent(QTimerEvent *event) override;
+
+private:
+    struct Outline
+    {
+        QPointF corners[4];
+        QRectF bounds;
+    };
+
+    void updateTimer();
+
+    QHash<MapObject*, Outline> mOutlines;
+    QRectF mBoundingRect;
+
+    // Marching ants effect
+    int mUpdateTimer = -1;
+    int mOffset = 0;
+};
+
+/**
+ * Sets the outline of the given \a object based on its current geometry.
+ * Call updateBoundingRect() when done changing outlines.
+ */
+void SelectionOutlinesItem::setOutline(MapObject *object, const MapRenderer &renderer)
+{
+    QPointF pixelPos = renderer.pixelToScreenCoords(object->position());
+    QRectF bounds = object->screenBounds(renderer);
+    bounds.translate(-pixelPos);
+
+    if (auto mapScene = static_cast<MapScene*>(scene()))
+        pixelPos += mapScene->absolutePositionForLayer(*object->objectGroup());
+
+    QTransform transform;
+    transform.translate(pixelPos.x(), pixelPos.y());
+    transform.rotate(object->rotation());
+
+    Outline &outline = mOutlines[object];
+    outline.corners[0] = transform.map(bounds.topLeft());
+    outline.corners[1] = transform.map(bounds.topRight());
+    outline.corners[2] = transform.map(bounds.bottomRight());
+    outline.corners[3] = transform.map(bounds.bottomLeft());
+    outline.bounds = transform.mapRect(bounds);
+}
+
+/**
+ * Removes the outline of the given \a object. Returns whether it had one.
+ * Call updateBoundingRect() when done changing outlines.
+ */
+bool SelectionOutlinesItem::removeOutline(MapObject *object)
+{
+    return mOutlines.remove(object) > 0;
+}
+
+void SelectionOutlinesItem::clear()
+{
+    mOutlines.clear();
+    updateBoundingRect();
+}
+
+void SelectionOutlinesItem::syncAll(const MapRenderer &renderer)
+{
+    for (auto it = mOutlines.begin(), end = mOutlines.end(); it != end; ++it)
+        setOutline(it.key(), renderer);
+    updateBoundingRect();
+}
+
+void SelectionOutlinesItem::updateBoundingRect()
+{
+    QRectF boundingRect;
+    for (const Outline &outline : std::as_const(mOutlines))
+        boundingRect |= outline.bounds;
+
+    // Leave some room for the width of the cosmetic pen
+    if (!boundingRect.isNull())
+        boundingRect.adjust(-1, -1, 1, 1);
+
+    if (mBoundingRect != boundingRect) {
+        prepareGeometryChange();
+        mBoundingRect = boundingRect;
+    }
+
+    update();
+    updateTimer();
+}
+
+QRectF SelectionOutlinesItem::boundingRect() const
+{
+    return mBoundingRect;
+}
+
+void SelectionOutlinesItem::paint(QPainter *painter,
+                                  const QStyleOptionGraphicsItem *option,
+                                  QWidget *)
+{
+    QVector<QLineF> lines;
+
+    for (const Outline &outline : std::as_const(mOutlines)) {
+        if (!outline.bounds.intersects(option->exposedRect))
+            continue;
+
+        const QPointF *corners = outline.corners;
+        lines.append(QLineF(corners[0], corners[1]));
+        lines.append(QLineF(corners[1], corners[2]));
+        lines.append(QLineF(corners[2], corners[3]));
+        lines.append(QLineF(corners[3], corners[0]));
+    }
+
+    if (lines.isEmpty())
+        return;
+
+    const qreal devicePixelRatio = painter->device()->devicePixelRatioF();
+    const qreal dashLength = std::ceil(Utils::dpiScaled(2) * devicePixelRatio);
+
+    // Draw a solid white line
+    QPen pen(Qt::white, 1.5 * devicePixelRatio, Qt::SolidLine);
+    pen.setCosmetic(true);
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(pen);
+    painter->drawLines(lines);
+
+    // Draw a black dashed line above the white line
+    pen.setColor(Qt::black);
+    pen.setCapStyle(Qt::FlatCap);
+    pen.setDashPattern({dashLength, dashLength});
+    pen.setDashOffset(mOffset);
+    painter->setPen(pen);
+    painter->drawLines(lines);
+}
+
+void SelectionOutlinesItem::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == mUpdateTimer) {
+        // Update offset used in drawing black dashed line
+        mOffset++;
+        update();
+    } else {
+        QGraphicsObject::timerEvent(event);
+    }
+}
+
+/**
+ * Only runs the marching ants timer while there are outlines to animate.
+ */
+void SelectionOutlinesItem::updateTimer()
+{
+    if (mOutlines.isEmpty()) {
+        if (mUpdateTimer != -1) {
+            killTimer(mUpdateTimer);
+            mUpdateTimer = -1;
+        }
+    } else if (mUpdateTimer == -1) {
+        mUpdateTimer = startTimer(100);
+    }
+}
+
+
 MapObjectLabel::MapObjectLabel(const MapObject *object, QGraphicsItem *parent)
     : QGraphicsItem(parent)
     , mObject(object)
@@ -264,6 +458,9 @@ ObjectSelectionItem::ObjectSelectionItem(MapDocument *mapDocument,
 {
     setFlag(QGraphicsItem::ItemHasNoContents);
 
+    mReferencesItem = std::make_unique<ObjectReferencesItem>(this);
+    mSelectionOutlines = std::make_unique<SelectionOutlinesItem>(this);
+
     connect(mapDocument, &Document::changed,
             this, &ObjectSelectionItem::changeEvent);
     connect(mapDocument, &Document::propertyAdded,
@@ -332,12 +529,15 @@ void ObjectSelectionItem::updateItemPositions()
     for (MapObjectOutline *outline : std::as_const(mObjectOutlines))
         outline->syncWithMapObject(renderer);
 
-    for (const auto &items : std::as_const(mReferencesBySourceObject)) {
-        for (ObjectReferenceItem *item : items) {
-            item->syncWithSourceObject(renderer);
-            item->syncWithTargetObject(renderer);
+    mSelectionOutlines->syncAll(renderer);
+
+    for (const auto &references : std::as_const(mReferencesBySourceObject)) {
+        for (ObjectReference *reference : references) {
+            mReferencesItem->syncWithSourceObject(reference, renderer);
+            mReferencesItem->syncWithTargetObject(reference, renderer);
         }
     }
+    mReferencesItem->recalculateBounds();
 
     if (mHoveredMapObjectItem)
         mHoveredMapObjectItem->syncWithMapObject();
@@ -372,8 +572,8 @@ void ObjectSelectionItem::changeEvent(const ChangeEvent &event)
         qDeleteAll(mObjectLabels);
         qDeleteAll(mObjectOutlines);
         qDeleteAll(mObjectHoverItems);
-        for (const auto &referenceItems : std::as_const(mReferencesBySourceObject))
-            qDeleteAll(referenceItems);
+        mSelectionOutlines->clear();
+        mReferencesItem->clear();
 
         mObjectLabels.clear();
         mObjectOutlines.clear();
@@ -446,10 +646,64 @@ void ObjectSelectionItem::propertiesChanged(Object *object)
     addRemoveObjectReferences(static_cast<MapObject*>(object));
 }
 
-void ObjectSelectionItem::selectedObjectsChanged()
+void ObjectSelectionItem::selectedObjectsChanged(const QSet<MapObject*> &added,
+                                                 const QSet<MapObject*> &removed)
 {
-    addRemoveObjectLabels();
-    addRemoveObjectOutlines();
+    const MapRenderer &renderer = *mMapDocument->renderer();
+
+    // Only the outlines and labels of objects with a changed selection state
+    // are updated, so that selecting an object does not loop over all
+    // selected objects
+    for (MapObject *object : removed) {
+        delete mObjectOutlines.take(object);
+        mSelectionOutlines->removeOutline(object);
+    }
+
+    for (MapObject *object : added)
+        setSelectionOutline(object, renderer);
+
+    mSelectionOutlines->updateBoundingRect();
+
+    const auto visibility = objectLabelVisibility();
+    if (visibility == Preferences::NoObjectLabels)
+        return;
+
+    // Update all labels when the selection crosses the label limit
+    const auto selectionSize = mMapDocument->selectedObjects().size();
+    const auto previousSelectionSize = selectionSize - added.size() + removed.size();
+    if ((selectionSize > maxSelectedObjectLabels) != (previousSelectionSize > maxSelectedObjectLabels)) {
+        addRemoveObjectLabels();
+        return;
+    }
+    if (selectionSize > maxSelectedObjectLabels)
+        return;
+
+    for (MapObject *object : added) {
+        if (mObjectLabels.contains(object))
+            continue;
+
+        MapObjectLabel *labelItem = new MapObjectLabel(object, this);
+        labelItem->syncWithMapObject(renderer);
+        mObjectLabels.insert(object, labelItem);
+    }
+
+    MapObject *hoveredObject = nullptr;
+    if (Preferences::instance()->labelForHoveredObject())
+        hoveredObject = mMapDocument->hoveredMapObject();
+
+    for (MapObject *object : removed) {
+        if (object == hoveredObject)
+            continue;
+
+        // Objects on visible layers keep their label when showing all labels
+        if (visibility == Preferences::AllObjectLabels) {
+            const ObjectGroup *objectGroup = object->objectGroup();
+            if (objectGroup && !objectGroup->isHidden())
+                continue;
+        }
+
+        delete mObjectLabels.take(object);
+    }
 }
 
 void ObjectSelectionItem::aboutToBeSelectedObjectsChanged()
@@ -476,7 +730,8 @@ void ObjectSelectionItem::hoveredMapObjectChanged(MapObject *object,
         // Maybe remove the label from the previous object
         if (MapObjectLabel *label = mObjectLabels.value(previous)) {
             if (!(visibility == Preferences::SelectedObjectLabels &&
-                  mMapDocument->selectedObjects().contains(previous))) {
+                  mMapDocument->isObjectSelected(previous) &&
+                  hasSelectedObjectLabels())) {
                 delete label;
                 mObjectLabels.remove(previous);
             }
@@ -596,10 +851,13 @@ void ObjectSelectionItem::layerChanged(const LayerChangeEvent &event)
 void ObjectSelectionItem::syncOverlayItems(const QList<MapObject*> &objects)
 {
     const MapRenderer &renderer = *mMapDocument->renderer();
+    bool selectionOutlinesChanged = false;
 
     for (MapObject *object : objects) {
-        if (MapObjectOutline *outlineItem = mObjectOutlines.value(object))
-            outlineItem->syncWithMapObject(renderer);
+        if (mMapDocument->isObjectSelected(object)) {
+            setSelectionOutline(object, renderer);
+            selectionOutlinesChanged = true;
+        }
 
         if (MapObjectOutline *outlineItem = mObjectHoverItems.value(object))
             outlineItem->syncWithMapObject(renderer);
@@ -607,17 +865,45 @@ void ObjectSelectionItem::syncOverlayItems(const QList<MapObject*> &objects)
         if (MapObjectLabel *labelItem = mObjectLabels.value(object))
             labelItem->syncWithMapObject(renderer);
 
-        const auto sourceItems = mReferencesBySourceObject.value(object);
-        for (auto item : sourceItems)
-            item->syncWithSourceObject(renderer);
+        const auto sourceReferences = mReferencesBySourceObject.value(object);
+        for (auto reference : sourceReferences)
+            mReferencesItem->syncWithSourceObject(reference, renderer);
 
-        const auto targetItems = mReferencesByTargetObject.value(object);
-        for (auto item : targetItems)
-            item->syncWithTargetObject(renderer);
+        const auto targetReferences = mReferencesByTargetObject.value(object);
+        for (auto reference : targetReferences)
+            mReferencesItem->syncWithTargetObject(reference, renderer);
 
         if (mHoveredMapObjectItem && mHoveredMapObjectItem->mapObject() == object)
             mHoveredMapObjectItem->syncWithMapObject();
     }
+
+    if (selectionOutlinesChanged)
+        mSelectionOutlines->updateBoundingRect();
+}
+
+/**
+ * Sets up the selection outline of the given \a object, which is drawn by
+ * the SelectionOutlinesItem unless it is a point object. A call to
+ * SelectionOutlinesItem::updateBoundingRect() should follow.
+ */
+void ObjectSelectionItem::setSelectionOutline(MapObject *object, const MapRenderer &renderer)
+{
+    if (object->shape() == MapObject::Point) {
+        mSelectionOutlines->removeOutline(object);
+
+        MapObjectOutline *&outlineItem = mObjectOutlines[object];
+        if (!outlineItem)
+            outlineItem = new MapObjectOutline(object, MapObjectOutline::SelectionIndicator, this);
+        outlineItem->syncWithMapObject(renderer);
+    } else {
+        delete mObjectOutlines.take(object);
+        mSelectionOutlines->setOutline(object, renderer);
+    }
+}
+
+bool ObjectSelectionItem::hasSelectedObjectLabels() const
+{
+    return mMapDocument->selectedObjects().size() <= maxSelectedObjectLabels;
 }
 
 void ObjectSelectionItem::updateItemColors() const
@@ -625,9 +911,9 @@ void ObjectSelectionItem::updateItemColors() const
     for (MapObjectLabel *label : mObjectLabels)
         label->updateColor();
 
-    for (const auto &referenceItems : std::as_const(mReferencesBySourceObject))
-        for (ObjectReferenceItem *item : referenceItems)
-            item->updateColor();
+    for (const auto &references : std::as_const(mReferencesBySourceObject))
+        for (ObjectReference *reference : references)
+            mReferencesItem->updateColor(reference);
 }
 
 void ObjectSelectionItem::updateItemColorsForObject(MapObject *mapObject) const
@@ -637,9 +923,9 @@ void ObjectSelectionItem::updateItemColorsForObject(MapObject *mapObject) const
 
     const auto it = mReferencesByTargetObject.find(mapObject);
     if (it != mReferencesByTargetObject.end()) {
-        const QList<ObjectReferenceItem*> &items = *it;
-        for (auto item : items)
-            item->updateColor();
+        const QList<ObjectReference*> &references = *it;
+        for (auto reference : references)
+            mReferencesItem->updateColor(reference);
     }
 }
 
@@ -675,14 +961,14 @@ void ObjectSelectionItem::objectsAboutToBeRemoved(const QList<MapObject *> &obje
         // Remove any references originating from this object
         auto it = mReferencesBySourceObject.find(object);
         if (it != mReferencesBySourceObject.end()) {
-            const QList<ObjectReferenceItem*> &items = *it;
-            for (auto item : items) {
-                auto &itemsByTarget = mReferencesByTargetObject[item->targetObject()];
-                itemsByTarget.removeOne(item);
-                if (itemsByTarget.isEmpty())
-                    mReferencesByTargetObject.remove(item->targetObject());
-
-                delete item;
+            const QList<ObjectReference*> &references = *it;
+            for (auto reference : references) {
+                auto &referencesByTarget = mReferencesByTargetObject[reference->targetObject()];
+                referencesByTarget.removeOne(reference);
+                if (referencesByTarget.isEmpty())
+                    mReferencesByTargetObject.remove(reference->targetObject());
+
+                mReferencesItem->removeReference(reference);
             }
             mReferencesBySourceObject.erase(it);
         }
@@ -690,14 +976,14 @@ void ObjectSelectionItem::objectsAboutToBeRemoved(const QList<MapObject *> &obje
         // Remove any references pointing to this object
         it = mReferencesByTargetObject.find(object);
         if (it != mReferencesByTargetObject.end()) {
-            const QList<ObjectReferenceItem*> &items = *it;
-            for (auto item : items) {
-                auto &itemsBySource = mReferencesBySourceObject[item->sourceObject()];
-                itemsBySource.removeOne(item);
-                if (itemsBySource.isEmpty())
-                    mReferencesBySourceObject.remove(item->sourceObject());
-
-                delete item;
+            const QList<ObjectReference*> &references = *it;
+            for (auto reference : references) {
+                auto &referencesBySource = mReferencesBySourceObject[reference->sourceObject()];
+                referencesBySource.removeOne(reference);
+                if (referencesBySource.isEmpty())
+                    mReferencesBySourceObject.remove(reference->sourceObject());
+
+                mReferencesItem->removeReference(reference);
             }
             mReferencesByTargetObject.erase(it);
         }
@@ -717,6 +1003,11 @@ void ObjectSelectionItem::tilesetTilePositioningChanged(Tileset *tileset)
         if (outline->mapObject()->cell().tileset() == tileset)
             outline->syncWithMapObject(renderer);
 
+    for (MapObject *object : mMapDocument->selectedObjects())
+        if (mSelectionOutlines->contains(object) && object->cell().tileset() == tileset)
+            mSelectionOutlines->setOutline(object, renderer);
+    mSelectionOutlines->updateBoundingRect();
+
     if (mHoveredMapObjectItem && mHoveredMapObjectItem->mapObject()->cell().tileset() == tileset)
         mHoveredMapObjectItem->syncWithMapObject();
 }
@@ -737,8 +1028,8 @@ void ObjectSelectionItem::tileTypeChanged(Tile *tile)
 
     for (auto it = mReferencesByTargetObject.constBegin(), it_end = mReferencesByTargetObject.constEnd(); it != it_end; ++it) {
         if (isObjectAffected(it.key())) {
-            for (ObjectReferenceItem *item : it.value())
-                item->updateColor();
+            for (ObjectReference *reference : it.value())
+                mReferencesItem->updateColor(reference);
         }
     }
 }
@@ -755,10 +1046,8 @@ void ObjectSelectionItem::showObjectReferencesChanged()
 
 void ObjectSelectionItem::objectLineWidthChanged()
 {
-    // Object reference items should redraw when line width is changed
-    for (const auto &items : std::as_const(mReferencesBySourceObject))
-        for (ObjectReferenceItem *item : items)
-            item->update();
+    // Object references should redraw when line width is changed
+    mReferencesItem->update();
 }
 
 void ObjectSelectionItem::sceneFontChanged()
@@ -806,8 +1095,9 @@ void ObjectSelectionItem::addRemoveObjectLabels()
         [[fallthrough]];
 
     case Preferences::SelectedObjectLabels:
-        for (MapObject *object : mMapDocument->selectedObjects())
-            ensureLabel(object);
+        if (hasSelectedObjectLabels())
+            for (MapObject *object : mMapDocument->selectedObjects())
+                ensureLabel(object);
         break;
 
     case Preferences::NoObjectLabels:
@@ -818,24 +1108,6 @@ void ObjectSelectionItem::addRemoveObjectLabels()
     mObjectLabels.swap(labelItems);
 }
 
-void ObjectSelectionItem::addRemoveObjectOutlines()
-{
-    QHash<MapObject*, MapObjectOutline*> outlineItems;
-    const MapRenderer &renderer = *mMapDocument->renderer();
-
-    for (MapObject *mapObject : mMapDocument->selectedObjects()) {
-        MapObjectOutline *outlineItem = mObjectOutlines.take(mapObject);
-        if (!outlineItem) {
-            outlineItem = new MapObjectOutline(mapObject, MapObjectOutline::SelectionIndicator, this);
-            outlineItem->syncWithMapObject(renderer);
-        }
-        outlineItems.insert(mapObject, outlineItem);
-    }
-
-    qDeleteAll(mObjectOutlines); // delete remaining items
-    mObjectOutlines.swap(outlineItems);
-}
-
 void ObjectSelectionItem::addRemoveObjectHoverItems()
 {
     QHash<MapObject*, MapObjectOutline*> hoverItems;
@@ -872,39 +1144,37 @@ static void forEachObjectReference(const Properties &properties, Callback callba
 
 void ObjectSelectionItem::addRemoveObjectReferences()
 {
-    QHash<MapObject*, QList<ObjectReferenceItem*>> referencesBySourceObject;
-    QHash<MapObject*, QList<ObjectReferenceItem*>> referencesByTargetObject;
+    QHash<MapObject*, QList<ObjectReference*>> referencesBySourceObject;
+    QHash<MapObject*, QList<ObjectReference*>> referencesByTargetObject;
     const MapRenderer &renderer = *mMapDocument->renderer();
 
-    auto ensureReferenceItem = [&] (MapObject *sourceObject, ObjectRef ref) {
+    auto ensureReference = [&] (MapObject *sourceObject, ObjectRef ref) {
         MapObject *targetObject = DisplayObjectRef(ref, mMapDocument).object();
         if (!targetObject)
             return;
 
-        QList<ObjectReferenceItem*> &items = referencesBySourceObject[sourceObject];
+        QList<ObjectReference*> &references = referencesBySourceObject[sourceObject];
 
         if (mReferencesBySourceObject.contains(sourceObject)) {
-            QList<ObjectReferenceItem*> &existingItems = mReferencesBySourceObject[sourceObject];
-            auto it = std::find_if(existingItems.begin(),
-                                   existingItems.end(),
-                                   [=] (ObjectReferenceItem *item) {
-                return item->targetObject() == targetObject;
+            QList<ObjectReference*> &existingReferences = mReferencesBySourceObject[sourceObject];
+            auto it = std::find_if(existingReferences.begin(),
+                                   existingReferences.end(),
+                                   [=] (ObjectReference *reference) {
+                return reference->targetObject() == targetObject;
             });
 
-            if (it != existingItems.end()) {
-                items.append(*it);
+            if (it != existingReferences.end()) {
+                references.append(*it);
                 referencesByTargetObject[targetObject].append(*it);
 
-                existingItems.erase(it);
+                existingReferences.erase(it);
                 return;
             }
         }
 
-        auto item = new ObjectReferenceItem(sourceObject, targetObject, this);
-        item->syncWithSourceObject(renderer);
-        item->syncWithTargetObject(renderer);
-        items.append(item);
-        referencesByTargetObject[targetObject].append(item);
+        auto reference = mReferencesItem->addReference(sourceObject, targetObject, renderer);
+        references.append(reference);
+        referencesByTargetObject[targetObject].append(reference);
     };
 
     if (Preferences::instance()->showObjectReferences()) {
@@ -915,15 +1185,18 @@ void ObjectSelectionItem::addRemoveObjectReferences()
 
             for (MapObject *object : objectGroup->objects()) {
                 forEachObjectReference(object->properties(), [&] (ObjectRef ref) {
-                    ensureReferenceItem(object, ref);
+                    ensureReference(object, ref);
                 });
             }
         }
     }
 
-    // delete remaining items
-    for (const auto &items : std::as_const(mReferencesBySourceObject))
-        qDeleteAll(items);
+    // remove remaining references
+    for (const auto &references : std::as_const(mReferencesBySourceObject))
+        for (ObjectReference *reference : references)
+            mReferencesItem->removeReference(reference);
+
+    mReferencesItem->recalculateBounds();
 
     mReferencesBySourceObject.swap(referencesBySourceObject);
     mReferencesByTargetObject.swap(referencesByTargetObject);
@@ -931,50 +1204,48 @@ void ObjectSelectionItem::addRemoveObjectReferences()
 
 void ObjectSelectionItem::addRemoveObjectReferences(MapObject *object)
 {
-    QList<ObjectReferenceItem*> &items = mReferencesBySourceObject[object];
-    QList<ObjectReferenceItem*> existingItems;
-    items.swap(existingItems);
+    QList<ObjectReference*> &references = mReferencesBySourceObject[object];
+    QList<ObjectReference*> existingReferences;
+    references.swap(existingReferences);
 
     const MapRenderer &renderer = *mMapDocument->renderer();
 
-    auto ensureReferenceItem = [&] (MapObject *sourceObject, ObjectRef ref) {
+    auto ensureReference = [&] (MapObject *sourceObject, ObjectRef ref) {
         MapObject *targetObject = DisplayObjectRef(ref, mMapDocument).object();
         if (!targetObject)
             return;
 
-        auto it = std::find_if(existingItems.begin(),
-                               existingItems.end(),
-                               [=] (ObjectReferenceItem *item) {
-            return item->targetObject() == targetObject;
+        auto it = std::find_if(existingReferences.begin(),
+                               existingReferences.end(),
+                               [=] (ObjectReference *reference) {
+            return reference->targetObject() == targetObject;
         });
 
-        if (it != existingItems.end()) {
-            items.append(*it);
-            existingItems.erase(it);
+        if (it != existingReferences.end()) {
+            references.append(*it);
+            existingReferences.erase(it);
             return;
         }
 
-        auto item = new ObjectReferenceItem(sourceObject, targetObject, this);
-        item->syncWithSourceObject(renderer);
-        item->syncWithTargetObject(renderer);
-        items.append(item);
-        mReferencesByTargetObject[targetObject].append(item);
+        auto reference = mReferencesItem->addReference(sourceObject, targetObject, renderer);
+        references.append(reference);
+        mReferencesByTargetObject[targetObject].append(reference);
     };
 
     if (Preferences::instance()->showObjectReferences()) {
         forEachObjectReference(object->properties(), [&] (ObjectRef ref) {
-            ensureReferenceItem(object, ref);
+            ensureReference(object, ref);
         });
     }
 
-    // Delete remaining existing items, also removing them from mReferencesByTargetObject
-    for (ObjectReferenceItem *item : std::as_const(existingItems)) {
-        auto &itemsByTarget = mReferencesByTargetObject[item->targetObject()];
-        itemsByTarget.removeOne(item);
-        if (itemsByTarget.isEmpty())
-            mReferencesByTargetObject.remove(item->targetObject());
+    // Remove remaining existing references, also from mReferencesByTargetObject
+    for (ObjectReference *reference : std::as_const(existingReferences)) {
+        auto &referencesByTarget = mReferencesByTargetObject[reference->targetObject()];
+        referencesByTarget.removeOne(reference);
+        if (referencesByTarget.isEmpty())
+            mReferencesByTargetObject.remove(reference->targetObject());
 
-        delete item;
+        mReferencesItem->removeReference(reference);
     }
 }
 
@@ -24,6 +24,7 @@
 
 #include <QGraphicsObject>
 #include <QHash>
+#include <QSet>
 
 #include <memory>
 
@@ -39,7 +40,9 @@ class Tileset;
 class MapDocument;
 class MapObjectItem;
 class MapObjectOutline;
-class ObjectReferenceItem;
+class ObjectReference;
+class ObjectReferencesItem;
+class SelectionOutlinesItem;
 
 class MapObjectLabel : public QGraphicsItem
 {
@@ -92,7 +95,8 @@ private:
     void changeEvent(const ChangeEvent &event);
     void propertyRemoved(Object *object, const QString &name);
     void propertiesChanged(Object *object);
-    void selectedObjectsChanged();
+    void selectedObjectsChanged(const QSet<MapObject*> &added,
+                                const QSet<MapObject*> &removed);
     void aboutToBeSelectedObjectsChanged();
     void hoveredMapObjectChanged(MapObject *object, MapObject *previous);
     void mapChanged();
@@ -100,6 +104,8 @@ private:
     void layerAboutToBeRemoved(GroupLayer *parentLayer, int index);
     void layerChanged(const LayerChangeEvent &event);
     void syncOverlayItems(const QList<MapObject *> &objects);
+    void setSelectionOutline(MapObject *object, const MapRenderer &renderer);
+    bool hasSelectedObjectLabels() const;
     void updateItemColors() const;
     void updateItemColorsForObject(MapObject *mapObject) const;
     void objectsAdded(const QList<MapObject*> &objects);
@@ -114,7 +120,6 @@ private:
     void sceneFontChanged();
 
     void addRemoveObjectLabels();
-    void addRemoveObjectOutlines();
     void addRemoveObjectHoverItems();
     void addRemoveObjectReferences();
     void addRemoveObjectReferences(MapObject *object);
@@ -123,8 +128,10 @@ private:
     QHash<MapObject*, MapObjectLabel*> mObjectLabels;
     QHash<MapObject*, MapObjectOutline*> mObjectOutlines;
     QHash<MapObject*, MapObjectOutline*> mObjectHoverItems;
-    QHash<MapObject*, QList<ObjectReferenceItem*>> mReferencesBySourceObject;
-    QHash<MapObject*, QList<ObjectReferenceItem*>> mReferencesByTargetObject;
+    QHash<MapObject*, QList<ObjectReference*>> mReferencesBySourceObject;
+    QHash<MapObject*, QList<ObjectReference*>> mReferencesByTargetObject;
+    std::unique_ptr<ObjectReferencesItem> mReferencesItem;
+    std::unique_ptr<SelectionOutlinesItem> mSelectionOutlines;
     std::unique_ptr<MapObjectItem> mHoveredMapObjectItem;
 };
 
@@ -1213,7 +1213,7 @@ void ObjectSelectionTool::startMoving(const QPointF &pos,
 {
     // Move only the clicked item, if it was not part of the selection
     if (mClickedObject && !(modifiers & Qt::AltModifier)) {
-        if (!mapDocument()->selectedObjects().contains(mClickedObject))
+        if (!mapDocument()->isObjectSelected(mClickedObject))
             mapDocument()->setSelectedObjects({ mClickedObject });
     }
 
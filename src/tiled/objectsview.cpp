@@ -298,12 +298,36 @@ void ObjectsView::drawRow(QPainter *painter,
     QTreeView::drawRow(painter, option, proxyIndex);
 }
 
-void ObjectsView::selectedObjectsChanged()
+void ObjectsView::selectedObjectsChanged(const QSet<MapObject*> &added,
+                                         const QSet<MapObject*> &removed)
 {
     if (mSynching)
         return;
 
-    synchronizeSelectedItems();
+    if (added.isEmpty() && removed.isEmpty()) {
+        synchronizeSelectedItems();
+    } else {
+        // Only select and deselect the rows of the changed objects
+        auto rowsSelection = [this] (const QSet<MapObject*> &objects) {
+            QItemSelection itemSelection;
+            for (MapObject *o : objects) {
+                QModelIndex index = mProxyModel->mapFromSource(mapObjectModel()->index(o));
+                if (index.isValid())
+                    itemSelection.select(index, index);
+            }
+            return itemSelection;
+        };
+
+        QScopedValueRollback<bool> synching(mSynching, true);
+        if (!removed.isEmpty())
+            selectionModel()->select(rowsSelection(removed),
+                                     QItemSelectionModel::Deselect |
+                                     QItemSelectionModel::Rows);
+        if (!added.isEmpty())
+            selectionModel()->select(rowsSelection(added),
+                                     QItemSelectionModel::Select |
+                                     QItemSelectionModel::Rows);
+    }
 
     const QList<MapObject *> &selectedObjects = mMapDocument->selectedObjects();
     if (selectedObjects.count() == 1) {
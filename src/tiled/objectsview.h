@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <QSet>
 #include <QTreeView>
 
 namespace Tiled {
@@ -69,7 +70,8 @@ private:
 
     void onActivated(const QModelIndex &proxyIndex);
     void onSectionResized(int logicalIndex);
-    void selectedObjectsChanged();
+    void selectedObjectsChanged(const QSet<MapObject*> &added,
+                                const QSet<MapObject*> &removed);
     void hoveredObjectChanged(MapObject *object, MapObject *previous);
     void setColumnVisibility(bool visible);
 
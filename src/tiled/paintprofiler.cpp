@@ -0,0 +1,143 @@
+/*
+ * paintprofiler.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "paintprofiler.h"
+
+#include "layer.h"
+
+#include <algorithm>
+
+namespace Tiled {
+
+PaintProfiler *PaintProfiler::instance()
+{
+    static PaintProfiler instance;
+    return &instance;
+}
+
+void PaintProfiler::setEnabled(bool enabled)
+{
+    if (mEnabled == enabled)
+        return;
+
+    mEnabled = enabled;
+    mCurrentFrame = Frame();
+    mLastFrame = Frame();
+    mFrameTimestamps.clear();
+    mChangeTimestamps.clear();
+
+    if (enabled)
+        mClock.start();
+
+    emit enabledChanged(enabled);
+}
+
+void PaintProfiler::beginFrame()
+{
+    mCurrentFrame = Frame();
+    mFrameStart = RenderStatistics::current();
+    mFrameTimer.start();
+}
+
+void PaintProfiler::endFrame()
+{
+    mCurrentFrame.paintTime = mFrameTimer.nsecsElapsed();
+    mCurrentFrame.statistics = RenderStatistics::current() - mFrameStart;
+
+    // Show the most expensive layers first
+    std::stable_sort(mCurrentFrame.layers.begin(), mCurrentFrame.layers.end(),
+                     [] (const LayerEntry &a, const LayerEntry &b) {
+        return a.paintTime > b.paintTime;
+    });
+
+    mLastFrame = std::move(mCurrentFrame);
+    mCurrentFrame = Frame();
+    mFrameTimestamps.append(mClock.elapsed());
+}
+
+/**
+ * Adds the \a paintTime and \a statistics of painting the given \a layer to
+ * the current frame. A layer may be painted multiple times in one frame, in
+ * which case the values are accumulated.
+ */
+void PaintProfiler::addLayerPaint(const Layer *layer, qint64 paintTime,
+                                  const RenderStatistics &statistics)
+{
+    auto &layers = mCurrentFrame.layers;
+    auto it = std::find_if(layers.begin(), layers.end(),
+                           [layer] (const LayerEntry &entry) { return entry.layer == layer; });
+
+    if (it == layers.end()) {
+        layers.append(LayerEntry { layer, layer->name() });
+        it = layers.end() - 1;
+    }
+
+    it->paintTime += paintTime;
+    it->statistics += statistics;
+}
+
+void PaintProfiler::addChange()
+{
+    if (mEnabled)
+        mChangeTimestamps.append(mClock.elapsed());
+}
+
+int PaintProfiler::framesPerSecond() const
+{
+    return countRecent(mFrameTimestamps, mClock.elapsed());
+}
+
+int PaintProfiler::changesPerSecond() const
+{
+    return countRecent(mChangeTimestamps, mClock.elapsed());
+}
+
+/**
+ * Removes the \a timestamps older than one second and returns the number of
+ * remaining ones.
+ */
+int PaintProfiler::countRecent(QVector<qint64> &timestamps, qint64 now)
+{
+    const auto recent = std::lower_bound(timestamps.begin(), timestamps.end(), now - 1000);
+    timestamps.erase(timestamps.begin(), recent);
+    return timestamps.size();
+}
+
+
+LayerPaintScope::LayerPaintScope(const Layer *layer)
+    : mLayer(PaintProfiler::instance()->isEnabled() ? layer : nullptr)
+{
+    if (mLayer) {
+        mStatistics = RenderStatistics::current();
+        mTimer.start();
+    }
+}
+
+LayerPaintScope::~LayerPaintScope()
+{
+    if (mLayer) {
+        PaintProfiler::instance()->addLayerPaint(mLayer, mTimer.nsecsElapsed(),
+                                                 RenderStatistics::current() - mStatistics);
+    }
+}
+
+} // namespace Tiled
+
+#include "moc_paintprofiler.cpp"
@@ -0,0 +1,110 @@
+/*
+ * paintprofiler.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "maprenderer.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+
+namespace Tiled {
+
+class Layer;
+
+/**
+ * Collects timings and rendering statistics of the map views, for display
+ * in a performance overlay.
+ *
+ * Profiling is disabled by default, in which case it adds practically no
+ * overhead.
+ */
+class PaintProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct LayerEntry
+    {
+        const Layer *layer;
+        QString name;
+        qint64 paintTime = 0;       // nanoseconds
+        RenderStatistics statistics;
+    };
+
+    struct Frame
+    {
+        qint64 paintTime = 0;       // nanoseconds
+        RenderStatistics statistics;
+        QVector<LayerEntry> layers;
+    };
+
+    static PaintProfiler *instance();
+
+    bool isEnabled() const { return mEnabled; }
+    void setEnabled(bool enabled);
+
+    void beginFrame();
+    void endFrame();
+
+    void addLayerPaint(const Layer *layer, qint64 paintTime,
+                       const RenderStatistics &statistics);
+    void addChange();
+
+    const Frame &lastFrame() const { return mLastFrame; }
+    int framesPerSecond() const;
+    int changesPerSecond() const;
+
+signals:
+    void enabledChanged(bool enabled);
+
+private:
+    PaintProfiler() = default;
+
+    static int countRecent(QVector<qint64> &timestamps, qint64 now);
+
+    bool mEnabled = false;
+    QElapsedTimer mClock;
+    QElapsedTimer mFrameTimer;
+    RenderStatistics mFrameStart;
+    Frame mCurrentFrame;
+    Frame mLastFrame;
+    mutable QVector<qint64> mFrameTimestamps;
+    mutable QVector<qint64> mChangeTimestamps;
+};
+
+/**
+ * Measures the time and rendering statistics of painting a layer, when
+ * profiling is enabled.
+ */
+class LayerPaintScope
+{
+public:
+    explicit LayerPaintScope(const Layer *layer);
+    ~LayerPaintScope();
+
+private:
+    const Layer *mLayer;
+    QElapsedTimer mTimer;
+    RenderStatistics mStatistics;
+};
+
+} // namespace Tiled
@@ -20,10 +20,12 @@
 
 #include "painttilelayer.h"
 
+#include "compression.h"
 #include "map.h"
 #include "mapdocument.h"
 #include "tilelayer.h"
 #include "tilepainter.h"
+#include "tileregion.h"
 
 #include <QCoreApplication>
 
@@ -66,7 +68,7 @@ void PaintTileLayer::paint(TileLayer *target,
     data.mErased = std::make_unique<TileLayer>();
     data.mErased->setCells(target->x(),
                            target->y(), target, paintRegion);
-    data.mPaintedRegion = paintRegion;
+    data.setPaintedRegion(paintRegion);
 
     mLayerData[target].mergeWith(std::move(data));
 }
@@ -79,9 +81,11 @@ void PaintTileLayer::erase(TileLayer *target, const QRegion &eraseRegion)
 
 void PaintTileLayer::undo()
 {
+    decompress();
+
     for (const auto& [tileLayer, data] : mLayerData) {
         TilePainter painter(mMapDocument, tileLayer);
-        painter.setCells(0, 0, data.mErased.get(), data.mPaintedRegion);
+        painter.setCells(0, 0, data.mErased.get(), data.paintedRegion());
     }
 
     QUndoCommand::undo(); // undo child commands
@@ -91,9 +95,11 @@ void PaintTileLayer::redo()
 {
     QUndoCommand::redo(); // redo child commands
 
+    decompress();
+
     for (const auto& [tileLayer, data] : mLayerData) {
         TilePainter painter(mMapDocument, tileLayer);
-        painter.setCells(0, 0, data.mSource.get(), data.mPaintedRegion);
+        painter.setCells(0, 0, data.mSource.get(), data.paintedRegion());
     }
 }
 
@@ -102,7 +108,7 @@ void PaintTileLayer::LayerData::mergeWith(const LayerData &o)
     if (!mSource) {
         mSource.reset(o.mSource->clone());
         mErased.reset(o.mErased->clone());
-        mPaintedRegion = o.mPaintedRegion;
+        setPaintedRegion(o.paintedRegion());
         return;
     }
 
@@ -119,22 +125,227 @@ void PaintTileLayer::LayerData::mergeWith(LayerData &&o)
 
 void PaintTileLayer::LayerData::copy(const LayerData &o)
 {
+    // The mask is built on the first merge, after which the painted region
+    // is only updated through the mask
+    if (mPaintedMask.mBlocks.isEmpty() && !mPaintedRegionDirty)
+        mPaintedMask.add(mPaintedRegion);
+
+    const QRegion &paintedRegion = o.paintedRegion();
+    const QRegion newlyPainted = mPaintedMask.add(paintedRegion);
+
     // Copy the newly painted tiles as well as the newly erased tiles over
-    mSource->setCells(0, 0, o.mSource.get(), o.mPaintedRegion);
-    mErased->setCells(0, 0, o.mErased.get(), o.mPaintedRegion - mPaintedRegion);
-    mPaintedRegion |= o.mPaintedRegion;
+    mSource->setCells(0, 0, o.mSource.get(), paintedRegion);
+    mErased->setCells(0, 0, o.mErased.get(), newlyPainted);
+
+    if (!newlyPainted.isEmpty())
+        mPaintedRegionDirty = true;
+}
+
+const QRegion &PaintTileLayer::LayerData::paintedRegion() const
+{
+    if (mPaintedRegionDirty) {
+        mPaintedRegion = mPaintedMask.toRegion();
+        mPaintedRegionDirty = false;
+    }
+    return mPaintedRegion;
+}
+
+void PaintTileLayer::LayerData::setPaintedRegion(const QRegion &region)
+{
+    mPaintedRegion = region;
+    mPaintedRegionDirty = false;
+    mPaintedMask.mBlocks.clear();
+}
+
+/**
+ * Adds the given \a region to the mask. Returns the part of the region that
+ * was not yet part of the mask.
+ */
+QRegion PaintTileLayer::LayerData::PaintedMask::add(const QRegion &region)
+{
+    TileRegion added;
+
+    for (const QRect &rect : region) {
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            const int end = rect.right() + 1;
+            int x = rect.left();
+
+            while (x < end) {
+                const int blockX = x & ~15;
+                const int first = x - blockX;
+                const int count = std::min(end, blockX + 16) - x;
+
+                quint16 &row = mBlocks[QPoint(x >> 4, y >> 4)][y & 15];
+                const quint16 bits = static_cast<quint16>(((1u << count) - 1) << first);
+                const quint16 fresh = bits & ~row;
+                row |= bits;
+
+                // Add each run of newly set bits as a span
+                for (int bit = first; fresh >> bit; ) {
+                    if (!(fresh & (1u << bit))) {
+                        ++bit;
+                        continue;
+                    }
+
+                    const int start = bit;
+                    while (bit < 16 && (fresh & (1u << bit)))
+                        ++bit;
+
+                    added.addSpan(blockX + start, y, bit - start);
+                }
+
+                x += count;
+            }
+        }
+    }
+
+    return added.toRegion();
+}
+
+QRegion PaintTileLayer::LayerData::PaintedMask::toRegion() const
+{
+    TileRegion region;
+
+    for (auto it = mBlocks.cbegin(), it_end = mBlocks.cend(); it != it_end; ++it) {
+        const int blockX = it.key().x() * 16;
+        const int blockY = it.key().y() * 16;
+        const auto &rows = it.value();
+
+        for (int y = 0; y < 16; ++y) {
+            const quint16 row = rows[y];
+            for (int bit = 0; row >> bit; ) {
+                if (!(row & (1u << bit))) {
+                    ++bit;
+                    continue;
+                }
+
+                const int start = bit;
+                while (bit < 16 && (row & (1u << bit)))
+                    ++bit;
+
+                region.addSpan(blockX + start, blockY + y, bit - start);
+            }
+        }
+    }
+
+    return region.toRegion();
 }
 
 bool PaintTileLayer::mergeWith(const QUndoCommand *other)
 {
     const PaintTileLayer *o = static_cast<const PaintTileLayer*>(other);
-    if (!(mMapDocument == o->mMapDocument && o->mMergeable))
+    if (!(mMapDocument == o->mMapDocument && o->mMergeable && !o->mCompressed))
         return false;
     if (!cloneChildren(other, this))
         return false;
 
+    decompress();
+
     for (const auto& [tileLayer, data] : o->mLayerData)
         mLayerData[tileLayer].mergeWith(data);
 
     return true;
 }
+
+qint64 PaintTileLayer::memoryUsage() const
+{
+    qint64 usage = 0;
+    for (const auto& [tileLayer, data] : mLayerData)
+        usage += data.memoryUsage();
+    return usage;
+}
+
+void PaintTileLayer::compress()
+{
+    if (mCompressed)
+        return;
+
+    for (auto& [tileLayer, data] : mLayerData)
+        data.compress();
+
+    mCompressed = true;
+}
+
+void PaintTileLayer::decompress()
+{
+    if (!mCompressed)
+        return;
+
+    for (auto& [tileLayer, data] : mLayerData)
+        data.decompress();
+
+    mCompressed = false;
+}
+
+qint64 PaintTileLayer::LayerData::memoryUsage() const
+{
+    if (isCompressed())
+        return mCompressedCells.size();
+
+    return mSource->memoryUsage() + mErased->memoryUsage();
+}
+
+static CompressionMethod undoCompressionMethod()
+{
+    return compressionSupported(Zstandard) ? Zstandard : Zlib;
+}
+
+/**
+ * Replaces the source and erased layers by the compressed cells of both
+ * layers within the painted region.
+ */
+void PaintTileLayer::LayerData::compress()
+{
+    if (isCompressed())
+        return;
+
+    QByteArray cells;
+    const auto appendCells = [&] (int, int, const Cell *spanCells, int count) {
+        cells.append(reinterpret_cast<const char*>(spanCells), count * int(sizeof(Cell)));
+    };
+
+    mSource->forEachSpan(paintedRegion(), appendCells);
+    mErased->forEachSpan(paintedRegion(), appendCells);
+
+    QByteArray compressed = Tiled::compress(cells, undoCompressionMethod());
+    if (compressed.isNull())
+        return;
+
+    mCompressedCells = std::move(compressed);
+    mSource.reset();
+    mErased.reset();
+    mPaintedMask.mBlocks.clear();
+}
+
+void PaintTileLayer::LayerData::decompress()
+{
+    if (!isCompressed())
+        return;
+
+    qint64 cellCount = 0;
+    for (const QRect &rect : paintedRegion())
+        cellCount += qint64(rect.width()) * rect.height();
+
+    const QByteArray cells = Tiled::decompress(mCompressedCells,
+                                               int(cellCount * 2 * sizeof(Cell)),
+                                               undoCompressionMethod());
+    Q_ASSERT(cells.size() == cellCount * 2 * qint64(sizeof(Cell)));
+
+    const Cell *cell = reinterpret_cast<const Cell*>(cells.constData());
+
+    const auto readCells = [&] (TileLayer &layer) {
+        for (const QRect &rect : paintedRegion()) {
+            for (int y = rect.top(); y <= rect.bottom(); ++y) {
+                layer.setRow(rect.left(), y, rect.width(), cell);
+                cell += rect.width();
+            }
+        }
+    };
+
+    mSource = std::make_unique<TileLayer>();
+    mErased = std::make_unique<TileLayer>();
+    readCells(*mSource);
+    readCells(*mErased);
+
+    mCompressedCells = QByteArray();
+}
@@ -22,9 +22,13 @@
 
 #include "undocommands.h"
 
+#include <QByteArray>
+#include <QHash>
+#include <QPoint>
 #include <QRegion>
 #include <QUndoCommand>
 
+#include <array>
 #include <memory>
 #include <unordered_map>
 
@@ -40,7 +44,7 @@ class MapDocument;
  * Can merge with additional commands, even when they paint on different
  * tile layers.
  */
-class PaintTileLayer : public QUndoCommand
+class PaintTileLayer : public QUndoCommand, public CompressibleUndoCommand
 {
 public:
     /**
@@ -90,23 +94,55 @@ public:
     int id() const override { return Cmd_PaintTileLayer; }
     bool mergeWith(const QUndoCommand *other) override;
 
+    qint64 memoryUsage() const override;
+    void compress() override;
+
 private:
     struct LayerData
     {
         void mergeWith(const LayerData &o);
         void mergeWith(LayerData &&o);
 
+        qint64 memoryUsage() const;
+        void compress();
+        void decompress();
+        bool isCompressed() const { return !mCompressedCells.isNull(); }
+
+        const QRegion &paintedRegion() const;
+        void setPaintedRegion(const QRegion &region);
+
         std::unique_ptr<TileLayer> mSource;
         std::unique_ptr<TileLayer> mErased;
-        QRegion mPaintedRegion;
+        QByteArray mCompressedCells;
 
     private:
+        /**
+         * The painted cells, stored as one bit per cell in blocks of 16x16
+         * cells. Adding to it only depends on the size of the added region,
+         * unlike uniting QRegions, which gets slower as a stroke grows.
+         */
+        struct PaintedMask
+        {
+            QRegion add(const QRegion &region);
+            QRegion toRegion() const;
+
+            QHash<QPoint, std::array<quint16, 16>> mBlocks;
+        };
+
         void copy(const LayerData &o);
+
+        // Built from the mask only when needed, rather than on each merge
+        mutable QRegion mPaintedRegion;
+        mutable bool mPaintedRegionDirty = false;
+        PaintedMask mPaintedMask;
     };
 
+    void decompress();
+
     MapDocument *mMapDocument;
     std::unordered_map<TileLayer*, LayerData> mLayerData;
     bool mMergeable;
+    bool mCompressed = false;
 };
 
 inline void PaintTileLayer::setMergeable(bool mergeable)
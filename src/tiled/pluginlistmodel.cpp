@@ -65,7 +65,7 @@ QVariant PluginListModel::data(const QModelIndex &index, int role) const
         if (plugin.hasError())
             return mPluginErrorIcon.pixmap(16);
         else
-            return mPluginIcon.pixmap(16, plugin.instance ? QIcon::Normal : QIcon::Disabled);
+            return mPluginIcon.pixmap(16, plugin.isActive() ? QIcon::Normal : QIcon::Disabled);
     }
     case Qt::DisplayRole:
         return QFileInfo(plugin.fileName()).fileName();
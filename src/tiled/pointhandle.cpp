@@ -26,6 +26,11 @@
 #include <QApplication>
 #include <QPainter>
 #include <QPalette>
+#include <QStyleOptionGraphicsItem>
+#include <QtMath>
+
+#include <cmath>
+#include <limits>
 
 namespace Tiled {
 
@@ -87,4 +92,186 @@ void PointHandle::paint(QPainter *painter,
         painter->drawEllipse(QRectF(-4, -4, 8, 8));
 }
 
+
+PointHandlesItem::PointHandlesItem()
+    : QGraphicsItem()
+{
+    setAcceptedMouseButtons(Qt::MouseButtons());
+    setFlags(QGraphicsItem::ItemIgnoresParentOpacity |
+             QGraphicsItem::ItemUsesExtendedStyleOption);
+    setZValue(9999);    // below the PointHandle instances
+}
+
+/**
+ * Sets the scene positions of the handles and rebuilds the grid used to look
+ * up the points in a given area.
+ */
+void PointHandlesItem::setPositions(QVector<QPointF> positions)
+{
+    prepareGeometryChange();
+
+    mPositions = std::move(positions);
+    mBounds = QRectF();
+    mCellStart.clear();
+    mCellPoints.clear();
+    mColumns = 0;
+    mRows = 0;
+
+    if (!mPositions.isEmpty()) {
+        qreal left = mPositions.first().x();
+        qreal top = mPositions.first().y();
+        qreal right = left;
+        qreal bottom = top;
+
+        for (const QPointF &pos : std::as_const(mPositions)) {
+            left = std::min(left, pos.x());
+            top = std::min(top, pos.y());
+            right = std::max(right, pos.x());
+            bottom = std::max(bottom, pos.y());
+        }
+
+        mBounds = QRectF(left, top, right - left, bottom - top);
+
+        // Aim for about 8 points per cell
+        const int cellsPerSide = std::max(1, qCeil(std::sqrt(mPositions.size() / 8.0)));
+        mCellSize = std::max(mBounds.width(), mBounds.height()) / cellsPerSide;
+        if (mCellSize <= 0)
+            mCellSize = 1;
+
+        mColumns = static_cast<int>(mBounds.width() / mCellSize) + 1;
+        mRows = static_cast<int>(mBounds.height() / mCellSize) + 1;
+
+        // Sort the point indexes by cell
+        mCellStart.fill(0, mColumns * mRows + 1);
+        for (const QPointF &pos : std::as_const(mPositions))
+            ++mCellStart[row(pos.y()) * mColumns + column(pos.x()) + 1];
+        for (int i = 1; i < mCellStart.size(); ++i)
+            mCellStart[i] += mCellStart[i - 1];
+
+        QVector<int> next = mCellStart;
+        mCellPoints.resize(mPositions.size());
+        for (int i = 0; i < mPositions.size(); ++i) {
+            const QPointF &pos = mPositions.at(i);
+            mCellPoints[next[row(pos.y()) * mColumns + column(pos.x())]++] = i;
+        }
+    }
+
+    update();
+}
+
+/**
+ * Returns the indexes of the points within the given scene \a rect.
+ */
+QVector<int> PointHandlesItem::pointsInRect(const QRectF &rect) const
+{
+    QVector<int> indexes;
+
+    if (mPositions.isEmpty() ||
+            rect.right() < mBounds.left() || rect.left() > mBounds.right() ||
+            rect.bottom() < mBounds.top() || rect.top() > mBounds.bottom())
+        return indexes;
+
+    const int startColumn = column(rect.left());
+    const int endColumn = column(rect.right());
+    const int startRow = row(rect.top());
+    const int endRow = row(rect.bottom());
+
+    for (int y = startRow; y <= endRow; ++y) {
+        for (int x = startColumn; x <= endColumn; ++x) {
+            const int cell = y * mColumns + x;
+            for (int i = mCellStart.at(cell); i < mCellStart.at(cell + 1); ++i) {
+                const int index = mCellPoints.at(i);
+                if (rect.contains(mPositions.at(index)))
+                    indexes.append(index);
+            }
+        }
+    }
+
+    return indexes;
+}
+
+/**
+ * Returns the index of the point nearest to \a pos, within the given
+ * \a radius, or -1 when there is no such point.
+ */
+int PointHandlesItem::pointAt(const QPointF &pos, qreal radius) const
+{
+    const QRectF rect(pos.x() - radius, pos.y() - radius, radius * 2, radius * 2);
+
+    int nearest = -1;
+    qreal nearestDistance = std::numeric_limits<qreal>::max();
+
+    for (int index : pointsInRect(rect)) {
+        const qreal distance = QLineF(pos, mPositions.at(index)).length();
+        if (distance < nearestDistance) {
+            nearestDistance = distance;
+            nearest = index;
+        }
+    }
+
+    return nearest;
+}
+
+QRectF PointHandlesItem::boundingRect() const
+{
+    if (mPositions.isEmpty())
+        return QRectF();
+
+    // Handles are not drawn below the minimum scale, so this margin is large
+    // enough to fit them at any scale at which they are drawn
+    const qreal margin = Utils::dpiScaled(qreal(5)) / MinimumScale;
+    return mBounds.adjusted(-margin, -margin, margin, margin);
+}
+
+/**
+ * Returns an empty shape, since the handles are looked up using pointAt
+ * instead.
+ */
+QPainterPath PointHandlesItem::shape() const
+{
+    return QPainterPath();
+}
+
+void PointHandlesItem::paint(QPainter *painter,
+                             const QStyleOptionGraphicsItem *option,
+                             QWidget *)
+{
+    const QTransform transform = painter->worldTransform();
+    if (QStyleOptionGraphicsItem::levelOfDetailFromTransform(transform) < MinimumScale)
+        return;
+
+    const QVector<int> indexes = pointsInRect(option->exposedRect);
+    if (indexes.isEmpty() || indexes.size() > MaxVisibleHandles)
+        return;
+
+    const qreal scale = Utils::defaultDpiScale();
+    const QRectF ellipse(-4 * scale, -4 * scale, 8 * scale, 8 * scale);
+
+    QPen pen(Qt::black);
+    pen.setWidthF(scale);
+
+    // Draw the handles in device coordinates, like a PointHandle ignores
+    // the view transformation
+    painter->save();
+    painter->resetTransform();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(pen);
+    painter->setBrush(QColor(Qt::lightGray));
+
+    for (int index : indexes)
+        painter->drawEllipse(ellipse.translated(transform.map(mPositions.at(index))));
+
+    painter->restore();
+}
+
+int PointHandlesItem::column(qreal x) const
+{
+    return qBound(0, static_cast<int>((x - mBounds.left()) / mCellSize), mColumns - 1);
+}
+
+int PointHandlesItem::row(qreal y) const
+{
+    return qBound(0, static_cast<int>((y - mBounds.top()) / mCellSize), mRows - 1);
+}
+
 } // namespace Tiled
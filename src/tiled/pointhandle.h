@@ -21,6 +21,7 @@
 #pragma once
 
 #include <QGraphicsItem>
+#include <QVector>
 
 namespace Tiled {
 
@@ -61,4 +62,49 @@ private:
     bool mHighlighted;
 };
 
+/**
+ * Draws the handles for all points of a polygon with many points in a single
+ * item, since creating a PointHandle for each of them would make the scene
+ * unresponsive.
+ *
+ * Handles are only drawn when zoomed in far enough and when not too many of
+ * them are exposed. The points are kept in a grid to quickly find the ones
+ * within a certain area.
+ */
+class PointHandlesItem : public QGraphicsItem
+{
+public:
+    PointHandlesItem();
+
+    enum { Type = UserType + 4 };
+    int type() const override { return Type; }
+
+    static constexpr qreal MinimumScale = 0.25;
+    static constexpr int MaxVisibleHandles = 2048;
+
+    void setPositions(QVector<QPointF> positions);
+    const QVector<QPointF> &positions() const { return mPositions; }
+
+    QVector<int> pointsInRect(const QRectF &rect) const;
+    int pointAt(const QPointF &pos, qreal radius) const;
+
+    QRectF boundingRect() const override;
+    QPainterPath shape() const override;
+    void paint(QPainter *painter,
+               const QStyleOptionGraphicsItem *option,
+               QWidget *widget = nullptr) override;
+
+private:
+    int column(qreal x) const;
+    int row(qreal y) const;
+
+    QVector<QPointF> mPositions;
+    QRectF mBounds;
+    qreal mCellSize = 1.0;
+    int mColumns = 0;
+    int mRows = 0;
+    QVector<int> mCellStart;    // index into mCellPoints for each cell
+    QVector<int> mCellPoints;   // point indexes, grouped by cell
+};
+
 } // namespace Tiled
@@ -21,11 +21,13 @@
 
 #include "preferences.h"
 
+#include "imagecache.h"
 #include "languagemanager.h"
 #include "pluginmanager.h"
 #include "savefile.h"
 #include "session.h"
 #include "tilesetmanager.h"
+#include "tracer.h"
 
 #include <QApplication>
 #include <QDir>
@@ -60,6 +62,7 @@ void Preferences::deleteInstance()
 Preferences::Preferences()
     : QSettings()
 {
+    TraceScope trace("Preferences");
     initialize();
 }
 
@@ -97,6 +100,8 @@ void Preferences::initialize()
 
     TilesetManager *tilesetManager = TilesetManager::instance();
     tilesetManager->setReloadTilesetsOnChange(reloadTilesetsOnChange());
+    tilesetManager->setLazyImageLoading(loadTileImagesOnDemand());
+    ImageCache::setMemoryLimit(qint64(imageCacheLimit()) * 1024 * 1024);
     tilesetManager->setAnimateTiles(showTileAnimations());
 
     // Read the lists of enabled and disabled plugins
@@ -528,6 +533,32 @@ void Preferences::setReloadTilesetsOnChanged(bool reloadOnChanged)
     TilesetManager::instance()->setReloadTilesetsOnChange(reloadOnChanged);
 }
 
+bool Preferences::loadTileImagesOnDemand() const
+{
+    return get("Storage/LoadTileImagesOnDemand", false);
+}
+
+void Preferences::setLoadTileImagesOnDemand(bool enabled)
+{
+    setValue(QLatin1String("Storage/LoadTileImagesOnDemand"), enabled);
+    TilesetManager::instance()->setLazyImageLoading(enabled);
+}
+
+/**
+ * Returns the memory limit of the image cache in megabytes, where 0 means
+ * there is no limit.
+ */
+int Preferences::imageCacheLimit() const
+{
+    return get("Storage/ImageCacheLimit", 0);
+}
+
+void Preferences::setImageCacheLimit(int megabytes)
+{
+    setValue(QLatin1String("Storage/ImageCacheLimit"), megabytes);
+    ImageCache::setMemoryLimit(qint64(megabytes) * 1024 * 1024);
+}
+
 bool Preferences::useOpenGL() const
 {
     return get("Interface/OpenGL", false);
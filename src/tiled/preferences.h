@@ -136,6 +136,12 @@ public:
     bool reloadTilesetsOnChange() const;
     void setReloadTilesetsOnChanged(bool reloadOnChanged);
 
+    bool loadTileImagesOnDemand() const;
+    void setLoadTileImagesOnDemand(bool enabled);
+
+    int imageCacheLimit() const;
+    void setImageCacheLimit(int megabytes);
+
     bool useOpenGL() const;
     void setUseOpenGL(bool useOpenGL);
 
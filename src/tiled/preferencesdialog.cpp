@@ -93,6 +93,10 @@ PreferencesDialog::PreferencesDialog(QWidget *parent)
             preferences, &Preferences::setSafeSavingEnabled);
     connect(mUi->exportOnSave, &QCheckBox::toggled,
             preferences, &Preferences::setExportOnSave);
+    connect(mUi->loadTileImagesOnDemand, &QCheckBox::toggled,
+            preferences, &Preferences::setLoadTileImagesOnDemand);
+    connect(mUi->imageCacheLimit, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            preferences, &Preferences::setImageCacheLimit);
 
     connect(mUi->embedTilesets, &QCheckBox::toggled, preferences, [preferences] (bool value) {
         preferences->setExportOption(Preferences::EmbedTilesets, value);
@@ -218,6 +222,8 @@ void PreferencesDialog::fromPreferences()
     mUi->restoreSession->setChecked(prefs->restoreSessionOnStartup());
     mUi->safeSaving->setChecked(prefs->safeSavingEnabled());
     mUi->exportOnSave->setChecked(prefs->exportOnSave());
+    mUi->loadTileImagesOnDemand->setChecked(prefs->loadTileImagesOnDemand());
+    mUi->imageCacheLimit->setValue(prefs->imageCacheLimit());
 
     mUi->embedTilesets->setChecked(prefs->exportOption(Preferences::EmbedTilesets));
     mUi->detachTemplateInstances->setChecked(prefs->exportOption(Preferences::DetachTemplateInstances));
@@ -21,6 +21,7 @@
 #include "project.h"
 #include "properties.h"
 #include "savefile.h"
+#include "tracer.h"
 
 #include <QDir>
 #include <QJsonArray>
@@ -107,6 +108,8 @@ bool Project::save(const QString &fileName)
 
 std::unique_ptr<Project> Project::load(const QString &fileName)
 {
+    TraceScope trace("Load project", fileName);
+
     QFile file(fileName);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
         return nullptr;
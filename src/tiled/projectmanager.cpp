@@ -24,6 +24,7 @@
 #include "objecttypes.h"
 #include "preferences.h"
 #include "projectmodel.h"
+#include "referenceindex.h"
 
 namespace Tiled {
 
@@ -32,6 +33,7 @@ ProjectManager *ProjectManager::ourInstance;
 ProjectManager::ProjectManager(QObject *parent)
     : QObject(parent)
     , mProjectModel(new ProjectModel(this))
+    , mReferenceIndex(new ReferenceIndex(mProjectModel, this))
 {
     Q_ASSERT(!ourInstance);
     ourInstance = this;
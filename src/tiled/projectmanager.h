@@ -28,6 +28,7 @@ namespace Tiled {
 
 class EditableAsset;
 class ProjectModel;
+class ReferenceIndex;
 
 /**
  * Singleton for managing the current project.
@@ -48,12 +49,14 @@ public:
     EditableAsset *editableProject();
 
     ProjectModel *projectModel();
+    ReferenceIndex *referenceIndex();
 
 signals:
     void projectChanged();
 
 private:
     ProjectModel *mProjectModel;
+    ReferenceIndex *mReferenceIndex;
 
     static ProjectManager *ourInstance;
 };
@@ -69,4 +72,9 @@ inline ProjectModel *ProjectManager::projectModel()
     return mProjectModel;
 }
 
+inline ReferenceIndex *ProjectManager::referenceIndex()
+{
+    return mReferenceIndex;
+}
+
 } // namespace Tiled
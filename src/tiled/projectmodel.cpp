@@ -23,13 +23,17 @@
 #include "containerhelpers.h"
 #include "fileformat.h"
 #include "pluginmanager.h"
+#include "thumbnailcache.h"
+#include "tracer.h"
 #include "utils.h"
 
 #include <QDir>
 #include <QFileInfo>
 #include <QMimeData>
+#include <QScopeGuard>
 #include <QSet>
 #include <QUrl>
+#include <QtConcurrent>
 
 namespace Tiled {
 
@@ -45,7 +49,8 @@ signals:
     void scanFinished(FolderEntry *entry);
 
 private:
-    void scan(FolderEntry &folder, QSet<QString> &visitedFolders) const;
+    void scan(FolderEntry &folder) const;
+    bool isInterrupted() const;
 
     QStringList mNameFilters;
 };
@@ -78,7 +83,21 @@ static void collectDirectories(const FolderEntry &entry, QStringList &filePaths)
     }
 }
 
-static void findFiles(const FolderEntry &entry, int offset, const QStringList &words, QVector<ProjectModel::Match> &result)
+/**
+ * Returns a mask of the characters in \a string, ignoring case. Used to
+ * quickly rule out files that can't match a word, since all characters of a
+ * word need to appear in a matching file path.
+ */
+template<typename String>
+static quint64 charMask(const String &string)
+{
+    quint64 mask = 0;
+    for (const QChar c : string)
+        mask |= quint64(1) << (c.toCaseFolded().unicode() & 63);
+    return mask;
+}
+
+static void collectFiles(const FolderEntry &entry, int offset, QVector<ProjectModel::IndexedFile> &files)
 {
     for (const auto &childEntry : entry.entries) {
         if (childEntry->entries.empty()) {
@@ -87,21 +106,33 @@ static void findFiles(const FolderEntry &entry, int offset, const QStringList &w
 #else
             const auto relativePath = childEntry->filePath.midRef(offset);
 #endif
-            const int totalScore = Utils::matchingScore(words, relativePath);
-
-            if (totalScore > 0) {
-                result.append(ProjectModel::Match {
-                                   totalScore,
-                                   offset,
-                                   childEntry->filePath
-                               });
-            }
+            files.append(ProjectModel::IndexedFile {
+                             childEntry->filePath,
+                             offset,
+                             charMask(relativePath)
+                         });
         } else {
-            findFiles(*childEntry, offset, words, result);
+            collectFiles(*childEntry, offset, files);
         }
     }
 }
 
+/**
+ * Returns whether the matches for \a words are a subset of the matches for
+ * \a previousWords, which is the case while typing more characters.
+ */
+static bool refinesQuery(const QStringList &previousWords, const QStringList &words)
+{
+    if (previousWords.isEmpty() || words.size() < previousWords.size())
+        return false;
+
+    for (int i = 0; i < previousWords.size(); ++i)
+        if (!words.at(i).startsWith(previousWords.at(i)))
+            return false;
+
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 ProjectModel::ProjectModel(QObject *parent)
@@ -155,6 +186,7 @@ void ProjectModel::setProject(std::unique_ptr<Project> project)
 
     mFolders.clear();
     mFoldersPendingScan.clear();
+    invalidateFileIndex();
 
     const auto &folders = this->project().folders();
     for (const QString &folder : folders) {
@@ -216,6 +248,7 @@ void ProjectModel::removeFolder(int row)
 
     mFolders.erase(mFolders.begin() + row);
     mWatcher.removePaths(watchedFilePaths);
+    invalidateFileIndex();
 
     endRemoveRows();
 
@@ -235,11 +268,66 @@ void ProjectModel::refreshFolders()
                      index(int(mFolders.size() - 1), 0), { Qt::DisplayRole });
 }
 
+/**
+ * Returns the files matching all of the given \a words.
+ *
+ * Only the files that matched the previous query are considered when the
+ * words refine that query. Files that contain not all characters of the
+ * words are skipped before scoring, and the scoring is done in parallel.
+ */
 QVector<ProjectModel::Match> ProjectModel::findFiles(const QStringList &words) const
 {
+    const QVector<IndexedFile> &files = fileIndex();
+
+    struct Candidate
+    {
+        int file;
+        int score;
+    };
+
+    QVector<Candidate> candidates;
+    if (refinesQuery(mPreviousWords, words)) {
+        candidates.reserve(mPreviousMatches.size());
+        for (int file : std::as_const(mPreviousMatches))
+            candidates.append(Candidate { file, 0 });
+    } else {
+        candidates.reserve(files.size());
+        for (int file = 0; file < files.size(); ++file)
+            candidates.append(Candidate { file, 0 });
+    }
+
+    QVector<quint64> wordMasks;
+    wordMasks.reserve(words.size());
+    for (const QString &word : words)
+        wordMasks.append(charMask(word));
+
+    QtConcurrent::blockingMap(candidates, [&] (Candidate &candidate) {
+        const IndexedFile &file = files.at(candidate.file);
+
+        for (const quint64 wordMask : std::as_const(wordMasks))
+            if (wordMask & ~file.charMask)
+                return;
+
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+        const auto relativePath = QStringView(file.path).mid(file.offset);
+#else
+        const auto relativePath = file.path.midRef(file.offset);
+#endif
+        candidate.score = Utils::matchingScore(words, relativePath);
+    });
+
     QVector<Match> result;
-    for (const auto &entry : mFolders)
-        Tiled::findFiles(*entry, entry->filePath.lastIndexOf(QLatin1Char('/')) + 1, words, result);
+    mPreviousMatches.clear();
+
+    for (const Candidate &candidate : std::as_const(candidates)) {
+        if (candidate.score > 0) {
+            const IndexedFile &file = files.at(candidate.file);
+            result.append(Match { candidate.score, file.offset, file.path });
+            mPreviousMatches.append(candidate.file);
+        }
+    }
+
+    mPreviousWords = words;
     return result;
 }
 
@@ -315,8 +403,17 @@ QVariant ProjectModel::data(const QModelIndex &index, int role) const
             entry->fileIcon = mFileIconProvider.icon(QFileInfo(entry->filePath));
         return entry->fileIcon;
     }
-    case Qt::ToolTipRole:
-        return entry->filePath;
+    case Qt::ToolTipRole: {
+        auto &thumbnailCache = ThumbnailCache::instance();
+        const QString thumbnailPath = thumbnailCache.cachedThumbnailPath(entry->filePath);
+        if (thumbnailPath.isEmpty()) {
+            thumbnailCache.requestThumbnail(entry->filePath);
+            return entry->filePath;
+        }
+        return QStringLiteral("<p>%1</p><img src=\"%2\">")
+                .arg(entry->filePath.toHtmlEscaped(),
+                     QUrl::fromLocalFile(thumbnailPath).toString());
+    }
     }
 
     return QVariant();
@@ -357,6 +454,27 @@ QMimeData *ProjectModel::mimeData(const QModelIndexList &indexes) const
     return data;
 }
 
+const QVector<ProjectModel::IndexedFile> &ProjectModel::fileIndex() const
+{
+    if (mFileIndexDirty) {
+        mFileIndex.clear();
+        for (const auto &entry : mFolders)
+            collectFiles(*entry, entry->filePath.lastIndexOf(QLatin1Char('/')) + 1, mFileIndex);
+
+        mFileIndexDirty = false;
+        mPreviousWords.clear();
+        mPreviousMatches.clear();
+    }
+
+    return mFileIndex;
+}
+
+void ProjectModel::invalidateFileIndex()
+{
+    mFileIndexDirty = true;
+    mFileIndex.clear();
+}
+
 FolderEntry *ProjectModel::entryForIndex(const QModelIndex &index) const
 {
     return static_cast<FolderEntry*>(index.internalPointer());
@@ -382,13 +500,22 @@ void ProjectModel::pluginObjectAddedOrRemoved(QObject *object)
             mUpdateNameFiltersTimer.start();
 }
 
+/**
+ * Rescans only the changed directories, rather than the whole folders they
+ * are part of. Falls back to rescanning the whole folder when a changed path
+ * is not known.
+ */
 void ProjectModel::pathsChanged(const QStringList &paths)
 {
-    for (const std::unique_ptr<FolderEntry> &entry : mFolders) {
-        if (std::any_of(paths.begin(), paths.end(),
-                        [&entry] (const QString &path) { return path.startsWith(entry->filePath); })) {
-            scheduleFolderScan(entry->filePath);
+    for (const QString &path : paths) {
+        if (findEntry(mFolders, path)) {
+            scheduleFolderScan(path);
+            continue;
         }
+
+        for (const std::unique_ptr<FolderEntry> &entry : mFolders)
+            if (path.startsWith(entry->filePath))
+                scheduleFolderScan(entry->filePath);
     }
 }
 
@@ -420,13 +547,45 @@ void ProjectModel::updateNameFilters()
     }
 }
 
+static bool isSameOrParentFolder(const QString &folder, const QString &path)
+{
+    return path.startsWith(folder) &&
+            (path.length() == folder.length() || path.at(folder.length()) == QLatin1Char('/'));
+}
+
+/**
+ * Schedules a scan of the given \a folder, which can be one of the project's
+ * folders or any directory within them.
+ */
 void ProjectModel::scheduleFolderScan(const QString &folder)
 {
     if (mScanningFolder.isEmpty()) {
         mScanningFolder = folder;
         emit scanFolder(mScanningFolder);
-    } else if (!mFoldersPendingScan.contains(folder)) {
-        mFoldersPendingScan.append(folder);
+        return;
+    }
+
+    // No need to scan when the folder is already covered by a pending scan
+    for (const QString &pending : std::as_const(mFoldersPendingScan))
+        if (isSameOrParentFolder(pending, folder))
+            return;
+
+    // Pending scans of subdirectories are covered by this scan
+    mFoldersPendingScan.erase(std::remove_if(mFoldersPendingScan.begin(),
+                                             mFoldersPendingScan.end(),
+                                             [&] (const QString &pending) { return isSameOrParentFolder(folder, pending); }),
+                              mFoldersPendingScan.end());
+
+    mFoldersPendingScan.append(folder);
+}
+
+void ProjectModel::scanNextFolder()
+{
+    if (!mFoldersPendingScan.isEmpty()) {
+        mScanningFolder = mFoldersPendingScan.takeFirst();
+        emit scanFolder(mScanningFolder);
+    } else {
+        mScanningFolder.clear();
     }
 }
 
@@ -435,18 +594,28 @@ void ProjectModel::folderScanned(FolderEntry *resultPointer)
     const std::unique_ptr<FolderEntry> result { resultPointer };
     Q_ASSERT(!result->parent);
 
-    const auto it = std::find_if(mFolders.begin(), mFolders.end(),
-                                 [&] (const std::unique_ptr<FolderEntry> &value) { return value->filePath == result->filePath; });
+    const auto scanNext = qScopeGuard([this] { scanNextFolder(); });
 
-    // The folder may have been removed in the meantime
-    if (it == mFolders.end())
+    // The scanned folder may be one of the project's folders, or a directory
+    // within them that changed. It may also have been removed in the meantime.
+    FolderEntry *entry = findEntry(mFolders, result->filePath);
+    if (!entry)
         return;
 
+    const bool isProjectFolder = !entry->parent;
+
+    // Directories without any files are left out of the tree
+    if (!isProjectFolder && result->entries.empty()) {
+        emit aboutToRefresh();
+        removeEmptyEntry(entry);
+        emit refreshed();
+        return;
+    }
+
     // There appears to be no way to reset a subset of the model, so signal the
     // removal of all previous rows and re-add the new rows instead.
 
-    const std::unique_ptr<FolderEntry> &entry = *it;
-    const QModelIndex index = indexForEntry(entry.get());
+    const QModelIndex index = indexForEntry(entry);
 
     QStringList previousDirectories;
     QStringList newDirectories;
@@ -458,6 +627,7 @@ void ProjectModel::folderScanned(FolderEntry *resultPointer)
     mWatcher.removePaths(previousDirectories);
 
     emit aboutToRefresh();
+    invalidateFileIndex();
 
     if (!entry->entries.empty()) {
         beginRemoveRows(index, 0, int(entry->entries.size() - 1));
@@ -471,21 +641,45 @@ void ProjectModel::folderScanned(FolderEntry *resultPointer)
 
         // Fix up parent pointers
         for (auto &childEntry: entry->entries)
-            childEntry->parent = entry.get();
+            childEntry->parent = entry;
 
         endInsertRows();
     }
 
     emit refreshed();
 
-    if (!mFoldersPendingScan.isEmpty()) {
-        mScanningFolder = mFoldersPendingScan.takeFirst();
-        emit scanFolder(mScanningFolder);
-    } else {
-        mScanningFolder.clear();
-    }
+    // Update the "Refreshing" label
+    if (isProjectFolder)
+        emit dataChanged(index, index, { Qt::DisplayRole });
+}
+
+/**
+ * Removes the given directory \a entry, which no longer contains any files.
+ * Its parent directories are removed as well when they become empty.
+ */
+void ProjectModel::removeEmptyEntry(FolderEntry *entry)
+{
+    invalidateFileIndex();
 
-    emit dataChanged(index, index, { Qt::DisplayRole });
+    // The project's folders are always shown, even when empty
+    while (entry->parent) {
+        FolderEntry *parent = entry->parent;
+
+        QStringList watchedFilePaths;
+        watchedFilePaths.append(entry->filePath);
+        collectDirectories(*entry, watchedFilePaths);
+        mWatcher.removePaths(watchedFilePaths);
+
+        const int row = indexForEntry(entry).row();
+        beginRemoveRows(indexForEntry(parent), row, row);
+        parent->entries.erase(parent->entries.begin() + row);
+        endRemoveRows();
+
+        if (!parent->entries.empty())
+            break;
+
+        entry = parent;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -497,45 +691,98 @@ void FolderScanner::setNameFilters(const QStringList &nameFilters)
 
 void FolderScanner::scanFolder(const QString &folder)
 {
-    QSet<QString> visitedFolders;
+    TraceScope trace("Scan project folder", folder);
+
     auto entry = std::make_unique<FolderEntry>(folder);
-    scan(*entry, visitedFolders);
+    scan(*entry);
 
     emit scanFinished(entry.release());
 }
 
-void FolderScanner::scan(FolderEntry &folder, QSet<QString> &visitedFolders) const
+/**
+ * Scans the given \a folder one level of directories at a time. The
+ * directories of each level are listed in parallel, which helps especially
+ * on network file systems. The entries are added in the order they were
+ * listed, so the result doesn't depend on the order in which the listings
+ * complete.
+ */
+void FolderScanner::scan(FolderEntry &folder) const
 {
-#ifndef Q_OS_WASM
-    if (QThread::currentThread()->isInterruptionRequested())
-        return;
-#endif
+    struct Listing
+    {
+        FolderEntry *folder;
+        QFileInfoList fileInfos;
+        QStringList canonicalPaths;     // for directories, empty for files
+    };
 
     constexpr QDir::SortFlags sortFlags { QDir::Name | QDir::LocaleAware | QDir::DirsFirst };
     constexpr QDir::Filters filters { QDir::AllDirs | QDir::Files | QDir::NoDotAndDotDot };
-    const auto list = QDir(folder.filePath).entryInfoList(mNameFilters, filters, sortFlags);
 
-    for (const auto &fileInfo : list) {
-        auto entry = std::make_unique<FolderEntry>(fileInfo.filePath(), &folder);
-
-        if (fileInfo.isDir()) {
-            const QString canonicalPath = fileInfo.canonicalFilePath();
-
-            // prevent potential endless symlink loop
-            if (!visitedFolders.contains(canonicalPath)) {
-                visitedFolders.insert(canonicalPath);
-                scan(*entry, visitedFolders);
+    QSet<QString> visitedFolders;
+    std::vector<FolderEntry*> directories { &folder };
+    std::vector<Listing> listings { Listing { &folder, {}, {} } };
+
+    while (!listings.empty() && !isInterrupted()) {
+        QtConcurrent::blockingMap(listings, [&] (Listing &listing) {
+            if (isInterrupted())
+                return;
+
+            listing.fileInfos = QDir(listing.folder->filePath).entryInfoList(mNameFilters, filters, sortFlags);
+            for (const QFileInfo &fileInfo : std::as_const(listing.fileInfos))
+                listing.canonicalPaths.append(fileInfo.isDir() ? fileInfo.canonicalFilePath() : QString());
+        });
+
+        std::vector<Listing> nextListings;
+
+        for (const Listing &listing : listings) {
+            for (int i = 0; i < listing.fileInfos.size(); ++i) {
+                const QString &canonicalPath = listing.canonicalPaths.at(i);
+                const bool isDir = !canonicalPath.isEmpty();
+
+                // prevent potential endless symlink loop
+                if (isDir) {
+                    if (visitedFolders.contains(canonicalPath))
+                        continue;
+                    visitedFolders.insert(canonicalPath);
+                }
+
+                auto entry = std::make_unique<FolderEntry>(listing.fileInfos.at(i).filePath(), listing.folder);
+                if (isDir) {
+                    directories.push_back(entry.get());
+                    nextListings.push_back(Listing { entry.get(), {}, {} });
+                }
+                listing.folder->entries.push_back(std::move(entry));
             }
-
-            // Leave out empty directories
-            if (entry->entries.empty())
-                continue;
         }
 
-        folder.entries.push_back(std::move(entry));
+        listings.swap(nextListings);
+    }
+
+    // Leave out empty directories, starting with the deepest ones so that
+    // directories containing only empty directories are left out as well
+    QSet<const FolderEntry*> emptyDirectories;
+    for (auto it = directories.rbegin(); it != directories.rend(); ++it) {
+        auto &entries = (*it)->entries;
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [&] (const std::unique_ptr<FolderEntry> &entry) { return emptyDirectories.contains(entry.get()); }),
+                      entries.end());
+
+        if (entries.empty())
+            emptyDirectories.insert(*it);
     }
 }
 
+bool FolderScanner::isInterrupted() const
+{
+#ifndef Q_OS_WASM
+    // Checking the scanning thread, since this is also called from the
+    // thread pool
+    return thread()->isInterruptionRequested();
+#else
+    return false;
+#endif
+}
+
 } // namespace Tiled
 
 #include "projectmodel.moc"
@@ -76,6 +76,13 @@ public:
 #endif
     };
 
+    struct IndexedFile {
+        QString path;
+        int offset;         // start of the path relative to its project folder
+        quint64 charMask;   // see charMask() in projectmodel.cpp
+    };
+
+    const QVector<IndexedFile> &fileIndex() const;
     QVector<Match> findFiles(const QStringList &words) const;
 
     QString filePath(const QModelIndex &index) const;
@@ -112,8 +119,12 @@ private:
 
     void pathsChanged(const QStringList &paths);
 
+    void invalidateFileIndex();
+
     void scheduleFolderScan(const QString &folder);
+    void scanNextFolder();
     void folderScanned(FolderEntry *entry);
+    void removeEmptyEntry(FolderEntry *entry);
 
     std::unique_ptr<ProjectDocument> mProjectDocument;
     Project mEmptyProject;
@@ -123,6 +134,14 @@ private:
 
     std::vector<std::unique_ptr<FolderEntry>> mFolders;
 
+    // Flat list of all files, used to speed up findFiles
+    mutable QVector<IndexedFile> mFileIndex;
+    mutable bool mFileIndexDirty = true;
+
+    // The previous query, which is refined while typing
+    mutable QStringList mPreviousWords;
+    mutable QVector<int> mPreviousMatches;
+
     QThread mScanningThread;
     QString mScanningFolder;
     QStringList mFoldersPendingScan;
@@ -0,0 +1,812 @@
+/*
+ * projectvalidator.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "projectvalidator.h"
+
+#include "base64.h"
+#include "compression.h"
+#include "issuesmodel.h"
+#include "project.h"
+#include "propertytype.h"
+#include "savefile.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QXmlStreamReader>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <algorithm>
+
+namespace Tiled {
+
+namespace {
+
+// Bits on the far end of the 32-bit global tile ID are used for tile flags
+const unsigned TileFlagsMask = 0xF0000000;
+
+// Used as context for the reported issues, so they can be replaced
+const char issueContext = 0;
+
+enum class ValidatedFormat {
+    None,
+    Xml,
+    Json
+};
+
+/**
+ * Hashes of the files used by the validated maps. Shared between the
+ * threads, since many maps tend to use the same tilesets and images.
+ */
+class FileHashes
+{
+public:
+    QByteArray hash(const QString &fileName);
+
+private:
+    QMutex mMutex;
+    QHash<QString, QByteArray> mHashes;
+};
+
+struct TilesetRange
+{
+    unsigned firstGid;
+    int tileCount;      // -1 when unknown
+};
+
+/**
+ * Checks a single map, reading it as plain XML or JSON so that it can be
+ * done from any thread.
+ */
+class MapChecker
+{
+public:
+    MapChecker(ProjectValidator::MapResult &result,
+               const QSet<QString> &propertyTypeNames)
+        : mResult(result)
+        , mPropertyTypeNames(propertyTypeNames)
+        , mDir(QFileInfo(result.fileName).dir())
+    {}
+
+    bool isMap() const { return mIsMap; }
+
+    void readXml(QIODevice *device);
+    void readJson(const QJsonObject &map);
+
+private:
+    void addProblem(Issue::Severity severity, const QString &text);
+
+    QString checkFile(const QString &reference, const QDir &dir, const QString &message);
+    void checkPropertyType(const QString &typeName);
+    void checkTile(unsigned gid);
+    void checkTileData(const QByteArray &text, const QString &encoding, const QString &compression);
+    void reportLayerProblems(const QString &layerName);
+
+    int readExternalTileset(const QString &reference);
+    int readXmlTileset(QXmlStreamReader &xml, const QDir &dir);
+    int readJsonTileset(const QJsonObject &tileset, const QDir &dir);
+    void readJsonLayers(const QJsonArray &layers);
+    void readJsonProperties(const QJsonValue &properties);
+
+    ProjectValidator::MapResult &mResult;
+    const QSet<QString> &mPropertyTypeNames;
+    const QDir mDir;
+    bool mIsMap = false;
+
+    QVector<TilesetRange> mTilesets;
+    QByteArray mDictionary;
+    QHash<QString, bool> mCheckedFiles;
+    QSet<QString> mUnknownTypes;
+
+    int mInvalidTiles = 0;
+    bool mDecodingFailed = false;
+};
+
+} // anonymous namespace
+
+static ValidatedFormat validatedFormat(const QString &fileName)
+{
+    const QString suffix = QFileInfo(fileName).suffix().toLower();
+
+    if (suffix == QLatin1String("tmx") || suffix == QLatin1String("tsx"))
+        return ValidatedFormat::Xml;
+
+    if (suffix == QLatin1String("tmj") ||
+            suffix == QLatin1String("tsj") ||
+            suffix == QLatin1String("json"))
+        return ValidatedFormat::Json;
+
+    return ValidatedFormat::None;
+}
+
+QByteArray FileHashes::hash(const QString &fileName)
+{
+    {
+        QMutexLocker locker(&mMutex);
+        auto it = mHashes.constFind(fileName);
+        if (it != mHashes.constEnd())
+            return it.value();
+    }
+
+    QByteArray result;
+
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly)) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        if (hash.addData(&file))
+            result = hash.result().toHex();
+    }
+
+    QMutexLocker locker(&mMutex);
+    mHashes.insert(fileName, result);
+    return result;
+}
+
+void MapChecker::readXml(QIODevice *device)
+{
+    QXmlStreamReader xml(device);
+
+    if (!xml.readNextStartElement() || xml.name() != QLatin1String("map"))
+        return;
+
+    mIsMap = true;
+
+    QString layerName;
+    QString encoding;
+    QString compression;
+    QByteArray tileData;
+    bool inData = false;
+
+    while (!xml.atEnd()) {
+        switch (xml.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            const auto name = xml.name();
+            const QXmlStreamAttributes atts = xml.attributes();
+
+            if (name == QLatin1String("tileset")) {
+                const unsigned firstGid = atts.value(QLatin1String("firstgid")).toUInt();
+                const QString source = atts.value(QLatin1String("source")).toString();
+                if (source.isEmpty()) {
+                    mTilesets.append(TilesetRange { firstGid, readXmlTileset(xml, mDir) });
+                } else {
+                    mTilesets.append(TilesetRange { firstGid, readExternalTileset(source) });
+                    xml.skipCurrentElement();
+                }
+            } else if (name == QLatin1String("compressiondictionary")) {
+                mDictionary = Base64::decode(xml.readElementText().toLatin1());
+            } else if (name == QLatin1String("image")) {
+                checkFile(atts.value(QLatin1String("source")).toString(), mDir,
+                          ProjectValidator::tr("Image '%1' not found"));
+            } else if (name == QLatin1String("layer")) {
+                layerName = atts.value(QLatin1String("name")).toString();
+            } else if (name == QLatin1String("data")) {
+                inData = true;
+                encoding = atts.value(QLatin1String("encoding")).toString();
+                compression = atts.value(QLatin1String("compression")).toString();
+            } else if (name == QLatin1String("tile")) {
+                if (inData)
+                    checkTile(atts.value(QLatin1String("gid")).toUInt());
+            } else if (name == QLatin1String("object")) {
+                checkFile(atts.value(QLatin1String("template")).toString(), mDir,
+                          ProjectValidator::tr("Template '%1' not found"));
+
+                const auto gid = atts.value(QLatin1String("gid"));
+                if (!gid.isEmpty()) {
+                    const int invalidTiles = std::exchange(mInvalidTiles, 0);
+                    checkTile(gid.toUInt());
+                    if (std::exchange(mInvalidTiles, invalidTiles) > 0) {
+                        addProblem(Issue::Error, ProjectValidator::tr("Object %1 uses a tile that is not part of any tileset")
+                                   .arg(atts.value(QLatin1String("id")).toString()));
+                    }
+                }
+            } else if (name == QLatin1String("property")) {
+                checkPropertyType(atts.value(QLatin1String("propertytype")).toString());
+            }
+            break;
+        }
+        case QXmlStreamReader::Characters:
+            if (inData && !encoding.isEmpty())
+                tileData.append(xml.text().toLatin1());
+            break;
+        case QXmlStreamReader::EndElement: {
+            const auto name = xml.name();
+
+            if (name == QLatin1String("chunk") || name == QLatin1String("data")) {
+                if (!encoding.isEmpty())
+                    checkTileData(tileData, encoding, compression);
+                tileData.clear();
+                inData = name != QLatin1String("data");
+            } else if (name == QLatin1String("layer")) {
+                reportLayerProblems(layerName);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    if (xml.hasError())
+        addProblem(Issue::Error, ProjectValidator::tr("Failed to read map: %1").arg(xml.errorString()));
+}
+
+void MapChecker::readJson(const QJsonObject &map)
+{
+    if (map.value(QLatin1String("type")).toString() != QLatin1String("map"))
+        return;
+
+    mIsMap = true;
+    mDictionary = Base64::decode(map.value(QLatin1String("compressiondictionary")).toString().toLatin1());
+
+    const QJsonArray tilesets = map.value(QLatin1String("tilesets")).toArray();
+    for (const QJsonValue &value : tilesets) {
+        const QJsonObject tileset = value.toObject();
+        const unsigned firstGid = tileset.value(QLatin1String("firstgid")).toInt();
+        const QString source = tileset.value(QLatin1String("source")).toString();
+
+        if (source.isEmpty())
+            mTilesets.append(TilesetRange { firstGid, readJsonTileset(tileset, mDir) });
+        else
+            mTilesets.append(TilesetRange { firstGid, readExternalTileset(source) });
+    }
+
+    readJsonProperties(map.value(QLatin1String("properties")));
+    readJsonLayers(map.value(QLatin1String("layers")).toArray());
+}
+
+void MapChecker::addProblem(Issue::Severity severity, const QString &text)
+{
+    mResult.problems.append(ProjectValidator::Problem { severity, text });
+}
+
+/**
+ * Checks whether the file referenced by \a reference exists, reporting
+ * \a message otherwise. The file is added to the inputs of the map, so its
+ * appearance or disappearance invalidates the cached results.
+ *
+ * Returns the absolute file name, or an empty string when the file is
+ * missing or not on the local file system.
+ */
+QString MapChecker::checkFile(const QString &reference, const QDir &dir, const QString &message)
+{
+    // Resources and extension paths are not checked
+    if (reference.isEmpty() ||
+            reference.startsWith(QLatin1Char(':')) ||
+            reference.startsWith(QLatin1String("qrc:")) ||
+            reference.startsWith(QLatin1String("ext:")))
+        return QString();
+
+    const QString fileName = QDir::cleanPath(dir.filePath(reference));
+
+    auto it = mCheckedFiles.find(fileName);
+    if (it == mCheckedFiles.end()) {
+        const bool exists = QFileInfo::exists(fileName);
+        it = mCheckedFiles.insert(fileName, exists);
+        mResult.inputs.append(fileName);
+
+        if (!exists)
+            addProblem(Issue::Error, message.arg(reference));
+    }
+
+    return it.value() ? fileName : QString();
+}
+
+void MapChecker::checkPropertyType(const QString &typeName)
+{
+    if (typeName.isEmpty() || mPropertyTypeNames.contains(typeName))
+        return;
+
+    if (!mUnknownTypes.contains(typeName)) {
+        mUnknownTypes.insert(typeName);
+        addProblem(Issue::Warning, ProjectValidator::tr("Unknown property type '%1'").arg(typeName));
+    }
+}
+
+/**
+ * Counts the given global tile ID as invalid when it doesn't refer to a
+ * tile in any of the tilesets of the map. Tiles from tilesets that could
+ * not be read are assumed to be valid, since those were reported already.
+ */
+void MapChecker::checkTile(unsigned gid)
+{
+    gid &= ~TileFlagsMask;
+    if (gid == 0)
+        return;
+
+    // The tileset with the highest first GID that isn't above the given GID
+    const TilesetRange *match = nullptr;
+    for (const TilesetRange &range : std::as_const(mTilesets)) {
+        if (range.firstGid <= gid && (!match || range.firstGid > match->firstGid))
+            match = &range;
+    }
+
+    if (!match || (match->tileCount >= 0 && gid - match->firstGid >= unsigned(match->tileCount)))
+        ++mInvalidTiles;
+}
+
+void MapChecker::checkTileData(const QByteArray &text,
+                               const QString &encoding,
+                               const QString &compression)
+{
+    if (encoding == QLatin1String("csv")) {
+        const QList<QByteArray> values = text.split(',');
+        for (const QByteArray &value : values) {
+            const QByteArray trimmed = value.trimmed();
+            if (trimmed.isEmpty())
+                continue;
+
+            bool ok;
+            const unsigned gid = trimmed.toUInt(&ok);
+            if (!ok) {
+                mDecodingFailed = true;
+                return;
+            }
+            checkTile(gid);
+        }
+        return;
+    }
+
+    if (encoding != QLatin1String("base64")) {
+        mDecodingFailed = true;
+        return;
+    }
+
+    QByteArray data = Base64::decode(text);
+    if (data.isEmpty())
+        return;
+
+    bool runLengthEncoded = false;
+
+    if (compression == QLatin1String("rle")) {
+        runLengthEncoded = true;
+    } else if (compression == QLatin1String("rle+zstd") && compressionSupported(Zstandard)) {
+        data = decompress(data, 0, Zstandard);
+        runLengthEncoded = true;
+    } else if (compression == QLatin1String("zlib")) {
+        data = decompress(data, 0, Zlib);
+    } else if (compression == QLatin1String("gzip")) {
+        data = decompress(data, 0, Gzip);
+    } else if (compression == QLatin1String("zstd") && compressionSupported(Zstandard)) {
+        data = decompress(data, 0, Zstandard, mDictionary);
+    } else if (!compression.isEmpty()) {
+        mDecodingFailed = true;
+        return;
+    }
+
+    if (data.isEmpty() || data.size() % 4 != 0) {
+        mDecodingFailed = true;
+        return;
+    }
+
+    // Run-length encoded data consists of (run length, gid) pairs
+    const int start = runLengthEncoded ? 4 : 0;
+    const int step = runLengthEncoded ? 8 : 4;
+
+    if (runLengthEncoded && data.size() % 8 != 0) {
+        mDecodingFailed = true;
+        return;
+    }
+
+    const auto bytes = reinterpret_cast<const uchar *>(data.constData());
+    for (int i = start; i < data.size(); i += step)
+        checkTile(qFromLittleEndian<quint32>(bytes + i));
+}
+
+void MapChecker::reportLayerProblems(const QString &layerName)
+{
+    if (std::exchange(mDecodingFailed, false))
+        addProblem(Issue::Warning, ProjectValidator::tr("Failed to decode the tile data of layer '%1'").arg(layerName));
+
+    if (const int invalidTiles = std::exchange(mInvalidTiles, 0)) {
+        addProblem(Issue::Error, ProjectValidator::tr("Layer '%1' uses %n tile(s) that are not part of any tileset", nullptr, invalidTiles)
+                   .arg(layerName));
+    }
+}
+
+/**
+ * Reads the external tileset referenced by \a reference, checking its
+ * images and property types.
+ *
+ * Returns the number of tiles in the tileset, or -1 when it is unknown.
+ */
+int MapChecker::readExternalTileset(const QString &reference)
+{
+    const QString fileName = checkFile(reference, mDir, ProjectValidator::tr("Tileset '%1' not found"));
+    if (fileName.isEmpty())
+        return -1;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+
+    const QDir dir = QFileInfo(fileName).dir();
+
+    switch (validatedFormat(fileName)) {
+    case ValidatedFormat::Xml: {
+        QXmlStreamReader xml(&file);
+        if (!xml.readNextStartElement() || xml.name() != QLatin1String("tileset"))
+            return -1;
+        return readXmlTileset(xml, dir);
+    }
+    case ValidatedFormat::Json:
+        return readJsonTileset(QJsonDocument::fromJson(file.readAll()).object(), dir);
+    case ValidatedFormat::None:
+        break;
+    }
+
+    return -1;
+}
+
+/**
+ * Reads the tileset element \a xml is positioned at, up to its end.
+ *
+ * The "tilecount" attribute is not written by old versions of Tiled, in
+ * which case the number of tiles is unknown. Since tile IDs in image
+ * collections may have gaps, the highest tile ID is taken into account as
+ * well.
+ */
+int MapChecker::readXmlTileset(QXmlStreamReader &xml, const QDir &dir)
+{
+    const QXmlStreamAttributes tilesetAtts = xml.attributes();
+    const auto tileCountAttribute = tilesetAtts.value(QLatin1String("tilecount"));
+    int tileCount = tileCountAttribute.isEmpty() ? -1 : tileCountAttribute.toInt();
+    int depth = 1;
+
+    while (depth > 0 && !xml.atEnd()) {
+        switch (xml.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            ++depth;
+
+            const auto name = xml.name();
+            const QXmlStreamAttributes atts = xml.attributes();
+
+            if (name == QLatin1String("tile")) {
+                if (tileCount >= 0)
+                    tileCount = qMax(tileCount, atts.value(QLatin1String("id")).toInt() + 1);
+            } else if (name == QLatin1String("image")) {
+                checkFile(atts.value(QLatin1String("source")).toString(), dir,
+                          ProjectValidator::tr("Image '%1' not found"));
+            } else if (name == QLatin1String("property")) {
+                checkPropertyType(atts.value(QLatin1String("propertytype")).toString());
+            }
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            --depth;
+            break;
+        default:
+            break;
+        }
+    }
+
+    return tileCount;
+}
+
+int MapChecker::readJsonTileset(const QJsonObject &tileset, const QDir &dir)
+{
+    const QJsonValue tileCountValue = tileset.value(QLatin1String("tilecount"));
+    int tileCount = tileCountValue.isDouble() ? tileCountValue.toInt() : -1;
+
+    checkFile(tileset.value(QLatin1String("image")).toString(), dir,
+              ProjectValidator::tr("Image '%1' not found"));
+    readJsonProperties(tileset.value(QLatin1String("properties")));
+
+    const QJsonArray tiles = tileset.value(QLatin1String("tiles")).toArray();
+    for (const QJsonValue &value : tiles) {
+        const QJsonObject tile = value.toObject();
+
+        if (tileCount >= 0)
+            tileCount = qMax(tileCount, tile.value(QLatin1String("id")).toInt() + 1);
+
+        checkFile(tile.value(QLatin1String("image")).toString(), dir,
+                  ProjectValidator::tr("Image '%1' not found"));
+        readJsonProperties(tile.value(QLatin1String("properties")));
+    }
+
+    return tileCount;
+}
+
+void MapChecker::readJsonLayers(const QJsonArray &layers)
+{
+    for (const QJsonValue &value : layers) {
+        const QJsonObject layer = value.toObject();
+        const QString type = layer.value(QLatin1String("type")).toString();
+
+        readJsonProperties(layer.value(QLatin1String("properties")));
+
+        if (type == QLatin1String("tilelayer")) {
+            const QString encoding = layer.value(QLatin1String("encoding")).toString();
+            const QString compression = layer.value(QLatin1String("compression")).toString();
+
+            auto checkData = [&] (const QJsonValue &data) {
+                if (data.isString()) {
+                    checkTileData(data.toString().toLatin1(), encoding, compression);
+                } else {
+                    const QJsonArray gids = data.toArray();
+                    for (const QJsonValue &gid : gids)
+                        checkTile(static_cast<quint32>(gid.toDouble()));
+                }
+            };
+
+            const QJsonArray chunks = layer.value(QLatin1String("chunks")).toArray();
+            if (chunks.isEmpty()) {
+                checkData(layer.value(QLatin1String("data")));
+            } else {
+                for (const QJsonValue &chunk : chunks)
+                    checkData(chunk.toObject().value(QLatin1String("data")));
+            }
+
+            reportLayerProblems(layer.value(QLatin1String("name")).toString());
+        } else if (type == QLatin1String("objectgroup")) {
+            const QJsonArray objects = layer.value(QLatin1String("objects")).toArray();
+            for (const QJsonValue &objectValue : objects) {
+                const QJsonObject object = objectValue.toObject();
+
+                checkFile(object.value(QLatin1String("template")).toString(), mDir,
+                          ProjectValidator::tr("Template '%1' not found"));
+                readJsonProperties(object.value(QLatin1String("properties")));
+
+                const QJsonValue gid = object.value(QLatin1String("gid"));
+                if (gid.isDouble()) {
+                    const int invalidTiles = std::exchange(mInvalidTiles, 0);
+                    checkTile(static_cast<quint32>(gid.toDouble()));
+                    if (std::exchange(mInvalidTiles, invalidTiles) > 0) {
+                        addProblem(Issue::Error, ProjectValidator::tr("Object %1 uses a tile that is not part of any tileset")
+                                   .arg(object.value(QLatin1String("id")).toInt()));
+                    }
+                }
+            }
+        } else if (type == QLatin1String("imagelayer")) {
+            checkFile(layer.value(QLatin1String("image")).toString(), mDir,
+                      ProjectValidator::tr("Image '%1' not found"));
+        } else if (type == QLatin1String("group")) {
+            readJsonLayers(layer.value(QLatin1String("layers")).toArray());
+        }
+    }
+}
+
+void MapChecker::readJsonProperties(const QJsonValue &properties)
+{
+    const QJsonArray array = properties.toArray();
+    for (const QJsonValue &property : array)
+        checkPropertyType(property.toObject().value(QLatin1String("propertytype")).toString());
+}
+
+static QString severityName(Issue::Severity severity)
+{
+    return severity == Issue::Error ? QStringLiteral("error") : QStringLiteral("warning");
+}
+
+static Issue::Severity severityFromName(const QString &name)
+{
+    return name == QLatin1String("error") ? Issue::Error : Issue::Warning;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ProjectValidator::ProjectValidator(const Project &project)
+    : mProjectFileName(project.fileName())
+    , mFolders(project.folders())
+{
+    for (const PropertyType *type : *project.propertyTypes())
+        mPropertyTypeNames.insert(type->name);
+}
+
+/**
+ * Returns the file name of the validation cache used for the given project.
+ */
+QString ProjectValidator::cacheFileNameForProject(const QString &projectFileName)
+{
+    const QFileInfo fileInfo(projectFileName);
+    return fileInfo.dir().filePath(fileInfo.completeBaseName() +
+                                   QLatin1String(".tiled-validation-cache"));
+}
+
+/**
+ * Checks all maps in the project, returning the results for each map that
+ * has been checked. Maps for which none of the inputs changed since the
+ * previous run are not read again.
+ *
+ * Blocks until all maps have been checked.
+ */
+QVector<ProjectValidator::MapResult> ProjectValidator::validate() const
+{
+    struct Job
+    {
+        MapResult result;
+        bool isMap = true;
+    };
+
+    const QString cacheFileName = cacheFileNameForProject(mProjectFileName);
+    const QDir cacheDir = QFileInfo(cacheFileName).dir();
+    const QJsonObject settings {
+        { QStringLiteral("version"), QCoreApplication::applicationVersion() },
+    };
+
+    QJsonObject cachedMaps;
+    {
+        QFile file(cacheFileName);
+        if (file.open(QIODevice::ReadOnly)) {
+            const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+            if (root.value(QLatin1String("settings")).toObject() == settings)
+                cachedMaps = root.value(QLatin1String("maps")).toObject();
+        }
+    }
+
+    QVector<Job> jobs;
+    for (const QString &fileName : mapFiles())
+        jobs.append(Job { MapResult { fileName, {}, {}, false }, true });
+
+    FileHashes hashes;
+
+    QtConcurrent::blockingMap(jobs, [&] (Job &job) {
+        MapResult &result = job.result;
+
+        // Try to reuse the results from the previous run
+        const QJsonObject entry = cachedMaps.value(cacheDir.relativeFilePath(result.fileName)).toObject();
+        const QJsonObject inputs = entry.value(QLatin1String("inputs")).toObject();
+        bool upToDate = !inputs.isEmpty();
+        for (auto it = inputs.begin(), end = inputs.end(); upToDate && it != end; ++it) {
+            const QString input = QDir::cleanPath(cacheDir.filePath(it.key()));
+            upToDate = hashes.hash(input) == it.value().toString().toLatin1();
+            result.inputs.append(input);
+        }
+
+        if (upToDate) {
+            result.cached = true;
+            job.isMap = entry.value(QLatin1String("map")).toBool();
+
+            const QJsonArray problems = entry.value(QLatin1String("problems")).toArray();
+            for (const QJsonValue &value : problems) {
+                const QJsonObject problem = value.toObject();
+                result.problems.append(Problem {
+                                           severityFromName(problem.value(QLatin1String("severity")).toString()),
+                                           problem.value(QLatin1String("text")).toString()
+                                       });
+            }
+            return;
+        }
+
+        result.inputs = QStringList { result.fileName, mProjectFileName };
+
+        QFile file(result.fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            result.problems.append(Problem { Issue::Error, tr("Failed to open file") });
+            return;
+        }
+
+        MapChecker checker(result, mPropertyTypeNames);
+
+        switch (validatedFormat(result.fileName)) {
+        case ValidatedFormat::Xml:
+            checker.readXml(&file);
+            break;
+        case ValidatedFormat::Json:
+            checker.readJson(QJsonDocument::fromJson(file.readAll()).object());
+            break;
+        case ValidatedFormat::None:
+            break;
+        }
+
+        job.isMap = checker.isMap();
+        result.inputs.removeDuplicates();
+
+        // Compute the hashes while still on the thread pool
+        for (const QString &input : std::as_const(result.inputs))
+            hashes.hash(input);
+    });
+
+    QJsonObject maps;
+    QVector<MapResult> results;
+
+    for (const Job &job : std::as_const(jobs)) {
+        const MapResult &result = job.result;
+
+        QJsonObject inputs;
+        for (const QString &input : result.inputs)
+            inputs.insert(cacheDir.relativeFilePath(input), QString::fromLatin1(hashes.hash(input)));
+
+        QJsonArray problems;
+        for (const Problem &problem : result.problems) {
+            problems.append(QJsonObject {
+                                { QStringLiteral("severity"), severityName(problem.severity) },
+                                { QStringLiteral("text"), problem.text },
+                            });
+        }
+
+        // Files that are not maps are remembered as well, to avoid reading
+        // them again next time
+        maps.insert(cacheDir.relativeFilePath(result.fileName), QJsonObject {
+                        { QStringLiteral("map"), job.isMap },
+                        { QStringLiteral("inputs"), inputs },
+                        { QStringLiteral("problems"), problems },
+                    });
+
+        if (job.isMap)
+            results.append(result);
+    }
+
+    const QJsonObject root {
+        { QStringLiteral("settings"), settings },
+        { QStringLiteral("maps"), maps },
+    };
+
+    SaveFile file(cacheFileName);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.device()->write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+
+    return results;
+}
+
+/**
+ * Reports the problems found by validate() in the Issues view, replacing
+ * the issues reported by a previous run. Activating an issue opens the map.
+ */
+void ProjectValidator::report(const QVector<MapResult> &results)
+{
+    IssuesModel::instance().removeIssuesWithContext(&issueContext);
+
+    for (const MapResult &result : results) {
+        const QString mapName = QFileInfo(result.fileName).fileName();
+
+        for (const Problem &problem : result.problems) {
+            REPORT(Issue(problem.severity,
+                         QStringLiteral("%1: %2").arg(mapName, problem.text),
+                         OpenFile(result.fileName),
+                         &issueContext));
+        }
+    }
+}
+
+/**
+ * Returns the files in the project folders that may be maps, sorted by
+ * name. Only the TMX and JSON map formats are supported.
+ */
+QStringList ProjectValidator::mapFiles() const
+{
+    const QStringList nameFilters {
+        QStringLiteral("*.tmx"),
+        QStringLiteral("*.tmj"),
+        QStringLiteral("*.json"),
+    };
+
+    QStringList fileNames;
+
+    for (const QString &folder : mFolders) {
+        QDirIterator iterator(folder, nameFilters, QDir::Files, QDirIterator::Subdirectories);
+        while (iterator.hasNext())
+            fileNames.append(QDir::cleanPath(iterator.next()));
+    }
+
+    fileNames.removeDuplicates();
+    std::sort(fileNames.begin(), fileNames.end());
+    return fileNames;
+}
+
+} // namespace Tiled
@@ -0,0 +1,83 @@
+/*
+ * projectvalidator.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "logginginterface.h"
+#include "tilededitor_global.h"
+
+#include <QCoreApplication>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace Tiled {
+
+class Project;
+
+/**
+ * Checks all maps in the folders of a project for problems: references to
+ * missing tilesets, images and templates, unknown property types and tiles
+ * that are not part of any tileset.
+ *
+ * The maps are read in parallel on the global thread pool, without loading
+ * them. The results are cached next to the project file, so that only the
+ * maps whose inputs changed are read again on the next run.
+ *
+ * Since the project is copied into the validator, validate() can be called
+ * from any thread.
+ */
+class TILED_EDITOR_EXPORT ProjectValidator
+{
+    Q_DECLARE_TR_FUNCTIONS(ProjectValidator)
+
+public:
+    struct Problem
+    {
+        Issue::Severity severity;
+        QString text;
+    };
+
+    struct MapResult
+    {
+        QString fileName;
+        QVector<Problem> problems;
+        QStringList inputs;
+        bool cached = false;
+    };
+
+    explicit ProjectValidator(const Project &project);
+
+    static QString cacheFileNameForProject(const QString &projectFileName);
+
+    QVector<MapResult> validate() const;
+
+    static void report(const QVector<MapResult> &results);
+
+private:
+    QStringList mapFiles() const;
+
+    QString mProjectFileName;
+    QStringList mFolders;
+    QSet<QString> mPropertyTypeNames;
+};
+
+} // namespace Tiled
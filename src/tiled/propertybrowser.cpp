@@ -630,22 +630,22 @@ void PropertyBrowser::propertyChanged(Object *object, const QString &name)
 void PropertyBrowser::propertiesChanged(Object *object)
 {
     if (objectPropertiesRelevant(mDocument, object))
-        updateCustomProperties();
+        scheduleUpdateCustomProperties();
 }
 
 void PropertyBrowser::selectedObjectsChanged()
 {
-    updateCustomProperties();
+    scheduleUpdateCustomProperties();
 }
 
 void PropertyBrowser::selectedLayersChanged()
 {
-    updateCustomProperties();
+    scheduleUpdateCustomProperties();
 }
 
 void PropertyBrowser::selectedTilesChanged()
 {
-    updateCustomProperties();
+    scheduleUpdateCustomProperties();
 }
 
 void PropertyBrowser::propertyTypesChanged()
@@ -787,6 +787,7 @@ void PropertyBrowser::addMapProperties()
                         groupProperty);
 
     addProperty(CompressionLevelProperty, QMetaType::Int, tr("Compression Level"), groupProperty);
+    addProperty(CompressionDictionaryProperty, QMetaType::Bool, tr("Compression Dictionary"), groupProperty);
 
     renderOrderProperty->setAttribute(QLatin1String("enumNames"), mRenderOrderNames);
 
@@ -1222,6 +1223,9 @@ void PropertyBrowser::applyMapValue(PropertyId id, const QVariant &val)
     case CompressionLevelProperty:
         command = new ChangeMapProperty(mMapDocument, Map::CompressionLevelProperty, val.toInt());
         break;
+    case CompressionDictionaryProperty:
+        command = new ChangeMapProperty(mMapDocument, Map::CompressionDictionaryProperty, val.toBool());
+        break;
     case ChunkWidthProperty: {
         QSize chunkSize = mMapDocument->map()->chunkSize();
         chunkSize.setWidth(val.toInt());
@@ -1242,10 +1246,15 @@ void PropertyBrowser::applyMapValue(PropertyId id, const QVariant &val)
         mDocument->undoStack()->push(command);
 }
 
-QUndoCommand *PropertyBrowser::applyMapObjectValueTo(PropertyId id, const QVariant &val, MapObject *mapObject)
+QUndoCommand *PropertyBrowser::applyMapObjectValueTo(PropertyId id, const QVariant &val, const QList<MapObject *> &mapObjects)
 {
     QUndoCommand *command = nullptr;
 
+    QList<MapObject*> changedObjects;
+    QVector<QVariant> values;
+    changedObjects.reserve(mapObjects.size());
+    values.reserve(mapObjects.size());
+
     switch (id) {
     default: {
         MapObject::Property property;
@@ -1262,55 +1271,76 @@ QUndoCommand *PropertyBrowser::applyMapObjectValueTo(PropertyId id, const QVaria
             return nullptr; // unrecognized property
         }
 
-        command = new ChangeMapObject(mDocument, mapObject, property, val);
+        values.fill(val, mapObjects.size());
+        command = new ChangeMapObject(mDocument, mapObjects, property, values);
         break;
     }
     case XProperty: {
-        command = new ChangeMapObject(mDocument, mapObject,
+        for (MapObject *mapObject : mapObjects)
+            values.append(QPointF(val.toReal(), mapObject->y()));
+        command = new ChangeMapObject(mDocument, mapObjects,
                                       MapObject::PositionProperty,
-                                      QPointF(val.toReal(), mapObject->y()));
+                                      values);
         break;
     }
     case YProperty: {
-        command = new ChangeMapObject(mDocument, mapObject,
+        for (MapObject *mapObject : mapObjects)
+            values.append(QPointF(mapObject->x(), val.toReal()));
+        command = new ChangeMapObject(mDocument, mapObjects,
                                       MapObject::PositionProperty,
-                                      QPointF(mapObject->x(), val.toReal()));
+                                      values);
         break;
     }
     case WidthProperty: {
-        command = new ChangeMapObject(mDocument, mapObject,
+        for (MapObject *mapObject : mapObjects)
+            values.append(QSizeF(val.toReal(), mapObject->height()));
+        command = new ChangeMapObject(mDocument, mapObjects,
                                       MapObject::SizeProperty,
-                                      QSizeF(val.toReal(), mapObject->height()));
+                                      values);
         break;
     }
     case HeightProperty: {
-        command = new ChangeMapObject(mDocument, mapObject,
+        for (MapObject *mapObject : mapObjects)
+            values.append(QSizeF(mapObject->width(), val.toReal()));
+        command = new ChangeMapObject(mDocument, mapObjects,
                                       MapObject::SizeProperty,
-                                      QSizeF(mapObject->width(), val.toReal()));
+                                      values);
         break;
     }
     case RotationProperty:
-        if (mapObject->canRotate()) {
-            command = new ChangeMapObject(mDocument, mapObject,
+        for (MapObject *mapObject : mapObjects) {
+            if (mapObject->canRotate()) {
+                changedObjects.append(mapObject);
+                values.append(val.toDouble());
+            }
+        }
+        if (!changedObjects.isEmpty()) {
+            command = new ChangeMapObject(mDocument, changedObjects,
                                           MapObject::RotationProperty,
-                                          val.toDouble());
+                                          values);
         }
         break;
     case FlippingProperty: {
         const int flippingFlags = val.toInt();
 
-        MapObjectCell mapObjectCell;
-        mapObjectCell.object = mapObject;
-        mapObjectCell.cell = mapObject->cell();
-        mapObjectCell.cell.setFlippedHorizontally(flippingFlags & 1);
-        mapObjectCell.cell.setFlippedVertically(flippingFlags & 2);
+        QVector<MapObjectCell> changes;
+        changes.reserve(mapObjects.size());
 
-        command = new ChangeMapObjectCells(mDocument, { mapObjectCell });
+        for (MapObject *mapObject : mapObjects) {
+            MapObjectCell mapObjectCell;
+            mapObjectCell.object = mapObject;
+            mapObjectCell.cell = mapObject->cell();
+            mapObjectCell.cell.setFlippedHorizontally(flippingFlags & 1);
+            mapObjectCell.cell.setFlippedVertically(flippingFlags & 2);
+            changes.append(mapObjectCell);
+        }
+
+        command = new ChangeMapObjectCells(mDocument, changes);
 
         command->setText(QCoreApplication::translate("Undo Commands",
                                                      "Flip %n Object(s)",
                                                      nullptr,
-                                                     mMapDocument->selectedObjects().size()));
+                                                     mapObjects.size()));
         break;
     }
     }
@@ -1322,26 +1352,15 @@ void PropertyBrowser::applyMapObjectValue(PropertyId id, const QVariant &val)
 {
     MapObject *mapObject = static_cast<MapObject*>(mObject);
 
-    QUndoCommand *command = applyMapObjectValueTo(id, val, mapObject);
-    if (!command)
-        return;
+    // Apply the change to all selected objects in a single command, with the
+    // current object first
+    QList<MapObject*> mapObjects { mapObject };
+    for (MapObject *obj : mMapDocument->selectedObjects())
+        if (obj != mapObject)
+            mapObjects.append(obj);
 
-    if (mMapDocument->selectedObjects().size() == 1) {
+    if (QUndoCommand *command = applyMapObjectValueTo(id, val, mapObjects))
         mDocument->undoStack()->push(command);
-        return;
-    }
-
-    mDocument->undoStack()->beginMacro(command->text());
-    mDocument->undoStack()->push(command);
-
-    for (MapObject *obj : mMapDocument->selectedObjects()) {
-        if (obj != mapObject) {
-            if (QUndoCommand *cmd = applyMapObjectValueTo(id, val, obj))
-                mDocument->undoStack()->push(cmd);
-        }
-    }
-
-    mDocument->undoStack()->endMacro();
 }
 
 template <class T>
@@ -1744,6 +1763,17 @@ QtVariantProperty *PropertyBrowser::addCustomProperty(const QString &name, const
             break;
     }
 
+    return insertCustomProperty(precedingProperty, name, value);
+}
+
+/**
+ * Creates a custom property with the given \a name and \a value and adds it
+ * after \a precedingProperty, or at the top when it is nullptr.
+ */
+QtVariantProperty *PropertyBrowser::insertCustomProperty(QtProperty *precedingProperty,
+                                                         const QString &name,
+                                                         const QVariant &value)
+{
     QScopedValueRollback<bool> updating(mUpdating, true);
     QtVariantProperty *property = createCustomProperty(name, value);
     mCustomPropertiesGroup->insertSubProperty(property, precedingProperty);
@@ -1760,7 +1790,8 @@ void PropertyBrowser::setCustomPropertyValue(QtVariantProperty *property,
 {
     const QVariant displayValue = toDisplayValue(value);
 
-    if (displayValue.userType() != property->valueType()) {
+    if (displayValue.userType() != property->valueType() ||
+            !mCustomPropertiesHelper.hasPropertyType(property, value)) {
         // Re-creating the property is necessary to change its type
         recreateProperty(property, value);
     } else {
@@ -1864,6 +1895,7 @@ void PropertyBrowser::updateProperties()
         mIdToProperty[ParallaxOriginProperty]->setValue(map->parallaxOrigin());
         mIdToProperty[LayerFormatProperty]->setValue(mLayerFormatValues.indexOf(map->layerDataFormat()));
         mIdToProperty[CompressionLevelProperty]->setValue(map->compressionLevel());
+        mIdToProperty[CompressionDictionaryProperty]->setValue(map->useCompressionDictionary());
         mIdToProperty[RenderOrderProperty]->setValue(map->renderOrder());
         mIdToProperty[BackgroundColorProperty]->setValue(map->backgroundColor());
         mIdToProperty[ChunkWidthProperty]->setValue(map->chunkSize().width());
@@ -2068,30 +2100,61 @@ Properties PropertyBrowser::combinedProperties() const
     return combinedProperties;
 }
 
+/**
+ * Brings the custom properties in line with the properties of the selected
+ * objects. Only the rows that were added, removed or changed are touched, so
+ * that the expanded state of unchanged rows is also preserved.
+ */
 void PropertyBrowser::updateCustomProperties()
 {
+    mCustomPropertiesUpdateScheduled = false;
+
     if (!mObject)
         return;
 
     UpdatingProperties updatingProperties(this, mUpdating);
 
-    mCustomPropertiesHelper.clear();
+    const Properties properties = combinedProperties();
 
-    QMapIterator<QString,QVariant> it(combinedProperties());
-    while (it.hasNext()) {
-        it.next();
+    // Remove the rows of properties that are no longer present
+    const auto existingProperties = mCustomPropertiesHelper.properties();
+    for (auto it = existingProperties.begin(), end = existingProperties.end(); it != end; ++it)
+        if (!properties.contains(it.key()))
+            mCustomPropertiesHelper.deleteProperty(it.value());
 
-        QtVariantProperty *property = createCustomProperty(it.key(), it.value());
-        mCustomPropertiesGroup->addSubProperty(property);
+    // Since both are sorted by name, each new row goes after the previous one
+    QtProperty *precedingProperty = nullptr;
 
-        // Collapse custom color properties, to save space
-        if (property->valueType() == QMetaType::QColor)
-            setExpanded(items(property).constFirst(), false);
+    for (auto it = properties.begin(), end = properties.end(); it != end; ++it) {
+        QtVariantProperty *property = mCustomPropertiesHelper.property(it.key());
+        if (property)
+            setCustomPropertyValue(property, it.value());
+        else
+            insertCustomProperty(precedingProperty, it.key(), it.value());
 
-        updateCustomPropertyColor(it.key());
+        // Look up again, since setCustomPropertyValue may recreate it
+        property = mCustomPropertiesHelper.property(it.key());
+        updateCustomPropertyColor(property);
+        precedingProperty = property;
     }
 }
 
+/**
+ * Updates the custom properties once control returns to the event loop, so
+ * that several changes in a row cause only a single update.
+ */
+void PropertyBrowser::scheduleUpdateCustomProperties()
+{
+    if (mCustomPropertiesUpdateScheduled)
+        return;
+
+    mCustomPropertiesUpdateScheduled = true;
+    QMetaObject::invokeMethod(this, [this] {
+        if (mCustomPropertiesUpdateScheduled)
+            updateCustomProperties();
+    }, Qt::QueuedConnection);
+}
+
 void PropertyBrowser::updateCustomPropertyColor(const QString &name)
 {
     if (QtVariantProperty *property = mCustomPropertiesHelper.property(name))
@@ -2199,6 +2262,14 @@ void PropertyBrowser::retranslateUi()
         mLayerFormatValues.append(Map::Base64Zstandard);
     }
 
+    mLayerFormatNames.append(QCoreApplication::translate("PreferencesDialog", "Base64 (run-length encoded)"));
+    mLayerFormatValues.append(Map::Base64RunLength);
+
+    if (compressionSupported(Zstandard)) {
+        mLayerFormatNames.append(QCoreApplication::translate("PreferencesDialog", "Base64 (run-length encoded, Zstandard compressed)"));
+        mLayerFormatValues.append(Map::Base64RunLengthZstandard);
+    }
+
     mLayerFormatNames.append(QCoreApplication::translate("PreferencesDialog", "CSV"));
     mLayerFormatValues.append(Map::CSV);
 
@@ -150,6 +150,7 @@ private:
         InfiniteProperty,
         TemplateProperty,
         CompressionLevelProperty,
+        CompressionDictionaryProperty,
         ChunkWidthProperty,
         ChunkHeightProperty,
         TintColorProperty,
@@ -175,7 +176,7 @@ private:
 
     void applyMapValue(PropertyId id, const QVariant &val);
     void applyMapObjectValue(PropertyId id, const QVariant &val);
-    QUndoCommand *applyMapObjectValueTo(PropertyId id, const QVariant &val, MapObject *mapObject);
+    QUndoCommand *applyMapObjectValueTo(PropertyId id, const QVariant &val, const QList<MapObject *> &mapObjects);
     void applyLayerValue(PropertyId id, const QVariant &val);
     QUndoCommand *applyTileLayerValueTo(PropertyId id, const QVariant &val, QList<TileLayer *> tileLayers);
     QUndoCommand *applyObjectGroupValueTo(PropertyId id, const QVariant &val, QList<ObjectGroup *> objectGroups);
@@ -199,6 +200,8 @@ private:
                                    QtProperty *parent);
 
     QtVariantProperty *addCustomProperty(const QString &name, const QVariant &value);
+    QtVariantProperty *insertCustomProperty(QtProperty *precedingProperty,
+                                            const QString &name, const QVariant &value);
     void setCustomPropertyValue(QtVariantProperty *property, const QVariant &value);
     void recreateProperty(QtVariantProperty *property, const QVariant &value);
 
@@ -207,6 +210,7 @@ private:
     void updateProperties();
     Properties combinedProperties() const;
     void updateCustomProperties();
+    void scheduleUpdateCustomProperties();
 
     void updateCustomPropertyColor(const QString &name);
     void updateCustomPropertyColors();
@@ -218,6 +222,7 @@ private:
     void retranslateUi();
 
     bool mUpdating = false;
+    bool mCustomPropertiesUpdateScheduled = false;
     int mMapObjectFlags = 0;
     Object *mObject = nullptr;
     Document *mDocument = nullptr;
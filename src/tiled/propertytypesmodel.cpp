@@ -119,7 +119,7 @@ bool PropertyTypesModel::setPropertyTypeName(int row, const QString &name)
     // QVector::move works differently from beginMoveRows
     const int moveToRow = newRow > row ? newRow - 1 : newRow;
 
-    propertyType.name = typeWithName->name;
+    propertyTypes.setTypeName(row, typeWithName->name);
     const auto index = this->index(row);
     emit nameChanged(index, propertyTypes.typeAt(row));
     emit dataChanged(index, index, { Qt::DisplayRole, Qt::EditRole });
@@ -21,17 +21,35 @@
 #pragma once
 
 #include <QMap>
+#include <QVector>
 
 #include <random>
 
 namespace Tiled {
 
-inline std::default_random_engine &globalRandomEngine()
+/**
+ * Returns the random engine shared by the random pickers and other random
+ * choices, like the AutoMapping probability options. It is seeded randomly,
+ * unless a seed is set using seedGlobalRandomEngine().
+ *
+ * A Mersenne Twister is used, since its output is the same on all platforms.
+ */
+inline std::mt19937 &globalRandomEngine()
 {
-    static std::default_random_engine engine(std::random_device{}());
+    static std::mt19937 engine(std::random_device{}());
     return engine;
 }
 
+/**
+ * Seeds the global random engine with \a seed, which makes the random
+ * choices that follow reproducible (for example, when AutoMapping from the
+ * command-line).
+ */
+inline void seedGlobalRandomEngine(quint32 seed)
+{
+    globalRandomEngine().seed(seed);
+}
+
 /**
  * A class that helps pick random things that each have a probability
  * assigned.
@@ -105,4 +123,110 @@ private:
     QMap<Real, T> mThresholds;
 };
 
+/**
+ * Like RandomPicker, but picks in constant time using a precomputed alias
+ * table (Vose's alias method). Meant for sets of values that are picked from
+ * many times without changing.
+ *
+ * The table is built on the first pick after values were added.
+ */
+template<typename T, typename Real = qreal>
+class AliasPicker
+{
+public:
+    void add(const T &value, Real probability = 1.0)
+    {
+        if (probability > 0) {
+            mValues.append(value);
+            mWeights.append(probability);
+            mTableDirty = true;
+        }
+    }
+
+    bool isEmpty() const
+    {
+        return mValues.isEmpty();
+    }
+
+    qsizetype size() const
+    {
+        return mValues.size();
+    }
+
+    const T &pick() const
+    {
+        Q_ASSERT(!isEmpty());
+
+        if (mValues.size() == 1)
+            return mValues.first();
+
+        if (mTableDirty)
+            buildTable();
+
+        auto &engine = globalRandomEngine();
+        std::uniform_int_distribution<int> column(0, mValues.size() - 1);
+        std::uniform_real_distribution<Real> coin(0, 1);
+
+        const int index = column(engine);
+        return coin(engine) < mProbabilities.at(index) ? mValues.at(index)
+                                                       : mValues.at(mAliases.at(index));
+    }
+
+    void clear()
+    {
+        mValues.clear();
+        mWeights.clear();
+        mProbabilities.clear();
+        mAliases.clear();
+        mTableDirty = false;
+    }
+
+private:
+    void buildTable() const
+    {
+        const int count = mValues.size();
+
+        Real sum = 0;
+        for (const Real weight : mWeights)
+            sum += weight;
+
+        // Scale the weights so that their average is 1
+        QVector<Real> scaled(count);
+        QVector<int> small;
+        QVector<int> large;
+
+        for (int i = 0; i < count; ++i) {
+            scaled[i] = mWeights.at(i) * count / sum;
+            (scaled.at(i) < 1 ? small : large).append(i);
+        }
+
+        mProbabilities.fill(1, count);
+        mAliases.resize(count);
+        for (int i = 0; i < count; ++i)
+            mAliases[i] = i;
+
+        // Each column is filled up by a value with a weight above average
+        while (!small.isEmpty() && !large.isEmpty()) {
+            const int less = small.takeLast();
+            const int more = large.takeLast();
+
+            mProbabilities[less] = scaled.at(less);
+            mAliases[less] = more;
+
+            scaled[more] = scaled.at(more) + scaled.at(less) - 1;
+            (scaled.at(more) < 1 ? small : large).append(more);
+        }
+
+        // Remaining columns are full, up to rounding errors
+
+        mTableDirty = false;
+    }
+
+    QVector<T> mValues;
+    QVector<Real> mWeights;
+    mutable QVector<Real> mProbabilities;
+    mutable QVector<int> mAliases;
+    mutable bool mTableDirty = false;
+};
+
 } // namespace Tiled
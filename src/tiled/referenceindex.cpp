@@ -0,0 +1,375 @@
+/*
+ * referenceindex.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "referenceindex.h"
+
+#include "projectmodel.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QXmlStreamReader>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+namespace Tiled {
+
+namespace {
+
+enum class IndexedFormat {
+    None,
+    Xml,
+    Json
+};
+
+class ReferenceCollector
+{
+public:
+    ReferenceCollector(ReferenceIndex::FileReferences &references)
+        : mReferences(references)
+        , mDir(QFileInfo(references.fileName).dir())
+    {}
+
+    template<typename String>
+    void addFile(const String &reference)
+    {
+        if (reference.isEmpty())
+            return;
+        mReferences.files.append(QDir::cleanPath(mDir.filePath(reference.toString())));
+    }
+
+    template<typename String>
+    void addType(const String &typeName)
+    {
+        if (!typeName.isEmpty())
+            mReferences.types.append(typeName.toString());
+    }
+
+    void readXml(QIODevice *device);
+    void readJson(const QJsonValue &value);
+
+private:
+    ReferenceIndex::FileReferences &mReferences;
+    const QDir mDir;
+};
+
+} // anonymous namespace
+
+static IndexedFormat indexedFormat(const QString &fileName)
+{
+    const QString suffix = QFileInfo(fileName).suffix().toLower();
+
+    if (suffix == QLatin1String("tmx") ||
+            suffix == QLatin1String("tsx") ||
+            suffix == QLatin1String("tx"))
+        return IndexedFormat::Xml;
+
+    if (suffix == QLatin1String("tmj") ||
+            suffix == QLatin1String("tsj") ||
+            suffix == QLatin1String("tj") ||
+            suffix == QLatin1String("json") ||
+            suffix == QLatin1String("world"))
+        return IndexedFormat::Json;
+
+    return IndexedFormat::None;
+}
+
+void ReferenceCollector::readXml(QIODevice *device)
+{
+    QXmlStreamReader xml(device);
+
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement)
+            continue;
+
+        const auto name = xml.name();
+        const QXmlStreamAttributes atts = xml.attributes();
+
+        if (name == QLatin1String("tileset") || name == QLatin1String("image")) {
+            addFile(atts.value(QLatin1String("source")));
+        } else if (name == QLatin1String("object")) {
+            addFile(atts.value(QLatin1String("template")));
+            addType(atts.value(QLatin1String("type")));     // before Tiled 1.9
+        } else if (name == QLatin1String("tile")) {
+            addType(atts.value(QLatin1String("type")));     // before Tiled 1.9
+        } else if (name == QLatin1String("property")) {
+            addType(atts.value(QLatin1String("propertytype")));
+        }
+
+        addType(atts.value(QLatin1String("class")));
+    }
+}
+
+void ReferenceCollector::readJson(const QJsonValue &value)
+{
+    if (value.isArray()) {
+        const QJsonArray array = value.toArray();
+
+        // Skip arrays of plain values, like tile layer data
+        if (array.isEmpty() || !(array.first().isObject() || array.first().isArray()))
+            return;
+
+        for (const QJsonValue &element : array)
+            readJson(element);
+        return;
+    }
+
+    if (!value.isObject())
+        return;
+
+    const QJsonObject object = value.toObject();
+
+    for (auto it = object.begin(), end = object.end(); it != end; ++it) {
+        const QString key = it.key();
+        const QJsonValue value = it.value();
+
+        if (value.isString()) {
+            if (key == QLatin1String("source") ||
+                    key == QLatin1String("image") ||
+                    key == QLatin1String("template") ||
+                    key == QLatin1String("fileName")) {     // maps in a world
+                addFile(value.toString());
+            } else if (key == QLatin1String("class") ||
+                       key == QLatin1String("propertytype")) {
+                addType(value.toString());
+            }
+        } else {
+            readJson(value);
+        }
+    }
+}
+
+/**
+ * Reads the references of the given file, unless it wasn't modified since
+ * they were last read. Called from the thread pool.
+ */
+static void readReferences(ReferenceIndex::FileReferences &references)
+{
+    const QDateTime lastModified = QFileInfo(references.fileName).lastModified();
+    if (references.lastModified.isValid() && references.lastModified == lastModified)
+        return;
+
+    references.lastModified = lastModified;
+    references.changed = true;
+    references.files.clear();
+    references.types.clear();
+
+    QFile file(references.fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    ReferenceCollector collector(references);
+
+    switch (indexedFormat(references.fileName)) {
+    case IndexedFormat::Xml:
+        collector.readXml(&file);
+        break;
+    case IndexedFormat::Json:
+        collector.readJson(QJsonDocument::fromJson(file.readAll()).object());
+        break;
+    case IndexedFormat::None:
+        break;
+    }
+
+    references.files.removeDuplicates();
+    references.types.removeDuplicates();
+}
+
+static QVector<ReferenceIndex::FileReferences> readAllReferences(QVector<ReferenceIndex::FileReferences> files)
+{
+    QtConcurrent::blockingMap(files, readReferences);
+    return files;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ReferenceIndex::ReferenceIndex(ProjectModel *projectModel, QObject *parent)
+    : QObject(parent)
+    , mProjectModel(projectModel)
+{
+    // Avoid updating repeatedly while many files are changing
+    mUpdateTimer.setInterval(1000);
+    mUpdateTimer.setSingleShot(true);
+    connect(&mUpdateTimer, &QTimer::timeout, this, &ReferenceIndex::startUpdate);
+
+    connect(&mUpdate, &QFutureWatcher<QVector<FileReferences>>::finished,
+            this, &ReferenceIndex::updateFinished);
+
+    connect(projectModel, &ProjectModel::modelReset, this, [this] {
+        mFiles.clear();
+        mLookupDirty = true;
+        mIndexed = false;
+        mUpdateAgain = mUpdate.isRunning();
+    });
+    connect(projectModel, &ProjectModel::refreshed, this, &ReferenceIndex::scheduleUpdate);
+    connect(projectModel, &ProjectModel::folderRemoved, this, &ReferenceIndex::scheduleUpdate);
+}
+
+ReferenceIndex::~ReferenceIndex()
+{
+    mUpdate.waitForFinished();
+}
+
+/**
+ * Sets whether the index is updated in the background whenever the files in
+ * the project's folders have changed. Otherwise, the index is only built
+ * once it is first queried.
+ */
+void ReferenceIndex::setAutoUpdate(bool autoUpdate)
+{
+    mAutoUpdate = autoUpdate;
+    if (autoUpdate)
+        scheduleUpdate();
+}
+
+/**
+ * Returns the files in the project that reference the given \a fileName,
+ * based on the last update of the index.
+ */
+QStringList ReferenceIndex::referencingFiles(const QString &fileName)
+{
+    ensureIndexed();
+    buildLookup();
+    return mReferencingFiles.value(QDir::cleanPath(QFileInfo(fileName).absoluteFilePath()));
+}
+
+/**
+ * Returns the files in the project that use the custom type \a typeName,
+ * either as class or as the type of a property, based on the last update of
+ * the index.
+ */
+QStringList ReferenceIndex::filesUsingType(const QString &typeName)
+{
+    ensureIndexed();
+    buildLookup();
+    return mFilesUsingType.value(typeName);
+}
+
+void ReferenceIndex::scheduleUpdate()
+{
+    if (mAutoUpdate)
+        mUpdateTimer.start();
+}
+
+void ReferenceIndex::startUpdate()
+{
+    mUpdateTimer.stop();
+
+    if (mUpdate.isRunning()) {
+        mUpdateAgain = true;
+        return;
+    }
+
+    QVector<FileReferences> files;
+
+    for (const ProjectModel::IndexedFile &file : mProjectModel->fileIndex()) {
+        if (indexedFormat(file.path) == IndexedFormat::None)
+            continue;
+
+        // Pass along the previous state, so unchanged files can be skipped
+        auto it = mFiles.constFind(file.path);
+        if (it != mFiles.constEnd()) {
+            files.append(it.value());
+            files.last().changed = false;
+        } else {
+            files.append(FileReferences { file.path, QDateTime(), false, {}, {} });
+        }
+    }
+
+    mResultPending = true;
+    mUpdate.setFuture(QtConcurrent::run(readAllReferences, std::move(files)));
+}
+
+void ReferenceIndex::updateFinished()
+{
+    // May have already been handled by ensureIndexed
+    if (!std::exchange(mResultPending, false))
+        return;
+
+    const QVector<FileReferences> files = mUpdate.result();
+
+    // Files that are no longer part of the project are dropped as well
+    QHash<QString, FileReferences> updatedFiles;
+    updatedFiles.reserve(files.size());
+
+    bool changed = files.size() != mFiles.size();
+    for (const FileReferences &file : files) {
+        changed |= file.changed;
+        updatedFiles.insert(file.fileName, file);
+    }
+
+    mFiles.swap(updatedFiles);
+    mIndexed = true;
+
+    if (changed) {
+        mLookupDirty = true;
+        emit updated();
+    }
+
+    if (std::exchange(mUpdateAgain, false))
+        startUpdate();
+}
+
+/**
+ * Makes sure the index has been built at least once, waiting for an update
+ * in progress or building it right away.
+ */
+void ReferenceIndex::ensureIndexed()
+{
+    if (mIndexed)
+        return;
+
+    if (!mUpdate.isRunning())
+        startUpdate();
+
+    mUpdate.waitForFinished();
+    updateFinished();
+}
+
+void ReferenceIndex::buildLookup()
+{
+    if (!mLookupDirty)
+        return;
+
+    mReferencingFiles.clear();
+    mFilesUsingType.clear();
+
+    for (const FileReferences &file : std::as_const(mFiles)) {
+        for (const QString &reference : file.files)
+            mReferencingFiles[reference].append(file.fileName);
+        for (const QString &typeName : file.types)
+            mFilesUsingType[typeName].append(file.fileName);
+    }
+
+    for (QStringList &fileNames : mReferencingFiles)
+        fileNames.sort();
+    for (QStringList &fileNames : mFilesUsingType)
+        fileNames.sort();
+
+    mLookupDirty = false;
+}
+
+} // namespace Tiled
+
+#include "moc_referenceindex.cpp"
@@ -0,0 +1,92 @@
+/*
+ * referenceindex.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "tilededitor_global.h"
+
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+namespace Tiled {
+
+class ProjectModel;
+
+/**
+ * An index of the references between the files of the current project.
+ * Records which files reference which tilesets, templates, images and maps,
+ * and which custom types they use.
+ *
+ * The files are read in parallel on the global thread pool, without loading
+ * them. When updating, only the files that changed since the last update are
+ * read again.
+ */
+class TILED_EDITOR_EXPORT ReferenceIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReferenceIndex(ProjectModel *projectModel, QObject *parent = nullptr);
+    ~ReferenceIndex() override;
+
+    void setAutoUpdate(bool autoUpdate);
+
+    QStringList referencingFiles(const QString &fileName);
+    QStringList filesUsingType(const QString &typeName);
+
+    struct FileReferences
+    {
+        QString fileName;
+        QDateTime lastModified;
+        bool changed = false;
+        QStringList files;
+        QStringList types;
+    };
+
+signals:
+    void updated();
+
+private:
+    void scheduleUpdate();
+    void startUpdate();
+    void updateFinished();
+    void ensureIndexed();
+    void buildLookup();
+
+    ProjectModel *mProjectModel;
+    QTimer mUpdateTimer;
+    bool mAutoUpdate = false;
+    bool mUpdateAgain = false;
+    bool mIndexed = false;
+    bool mResultPending = false;
+
+    QFutureWatcher<QVector<FileReferences>> mUpdate;
+    QHash<QString, FileReferences> mFiles;
+
+    bool mLookupDirty = true;
+    QHash<QString, QStringList> mReferencingFiles;
+    QHash<QString, QStringList> mFilesUsingType;
+};
+
+} // namespace Tiled
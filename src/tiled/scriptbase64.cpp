@@ -20,6 +20,8 @@
 
 #include "scriptbase64.h"
 
+#include "base64.h"
+
 #include <QObject>
 #include <QJSEngine>
 
@@ -41,17 +43,17 @@ public:
 
 QString ScriptBase64::encode(const QByteArray &data) const
 {
-    return QString::fromLatin1(data.toBase64());
+    return QString::fromLatin1(Base64::encode(data));
 }
 
 QByteArray ScriptBase64::encodeAsBytes(const QByteArray &data) const
 {
-    return data.toBase64();
+    return Base64::encode(data);
 }
 
 QByteArray ScriptBase64::decode(const QByteArray &data) const
 {
-    return QByteArray::fromBase64(data);
+    return Base64::decode(data);
 }
 
 void registerBase64(QJSEngine *jsEngine)
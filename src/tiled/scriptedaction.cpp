@@ -32,6 +32,7 @@ ScriptedAction::ScriptedAction(Id id,
     : QAction(parent)
     , mId(id)
     , mCallback(callback)
+    , mExtension(ScriptManager::instance().loadingExtension())
 {
     static QIcon scriptIcon = [] {
         QIcon icon(QStringLiteral("://images/32/plugin.png"));
@@ -46,7 +47,12 @@ ScriptedAction::ScriptedAction(Id id,
         QJSValueList arguments;
         arguments.append(ScriptManager::instance().engine()->newQObject(this));
 
-        QJSValue result = mCallback.call(arguments);
+        QJSValue result;
+        {
+            ScriptProfiler::Scope scope(ScriptManager::instance().profiler(), mExtension,
+                                        QLatin1String("action ") + QString::fromUtf8(mId.name()));
+            result = mCallback.call(arguments);
+        }
         ScriptManager::instance().checkError(result);
     });
 }
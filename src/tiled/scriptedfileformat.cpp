@@ -33,8 +33,11 @@
 
 namespace Tiled {
 
-ScriptedFileFormat::ScriptedFileFormat(const QJSValue &object)
+ScriptedFileFormat::ScriptedFileFormat(const QString &shortName,
+                                       const QJSValue &object)
     : mObject(object)
+    , mShortName(shortName)
+    , mExtension(ScriptManager::instance().loadingExtension())
 {
 }
 
@@ -72,6 +75,8 @@ QJSValue ScriptedFileFormat::read(const QString &fileName)
     QJSValueList arguments;
     arguments.append(fileName);
 
+    ScriptProfiler::Scope scope(ScriptManager::instance().profiler(), mExtension,
+                                mShortName + QLatin1String(".read"));
     return mObject.property(QStringLiteral("read")).call(arguments);
 }
 
@@ -87,7 +92,12 @@ bool ScriptedFileFormat::write(EditableAsset *asset,
     arguments.append(fileName);
     arguments.append(static_cast<FileFormat::Options::Int>(options));
 
-    QJSValue resultValue = mObject.property(QStringLiteral("write")).call(arguments);
+    QJSValue resultValue;
+    {
+        ScriptProfiler::Scope scope(ScriptManager::instance().profiler(), mExtension,
+                                    mShortName + QLatin1String(".write"));
+        resultValue = mObject.property(QStringLiteral("write")).call(arguments);
+    }
     if (ScriptManager::instance().checkError(resultValue)) {
         error = resultValue.toString();
         return false;
@@ -114,7 +124,12 @@ QStringList ScriptedFileFormat::outputFiles(EditableAsset *asset, const QString
     arguments.append(ScriptManager::instance().engine()->newQObject(asset));
     arguments.append(fileName);
 
-    QJSValue resultValue = outputFiles.call(arguments);
+    QJSValue resultValue;
+    {
+        ScriptProfiler::Scope scope(ScriptManager::instance().profiler(), mExtension,
+                                    mShortName + QLatin1String(".outputFiles"));
+        resultValue = outputFiles.call(arguments);
+    }
 
     if (resultValue.isString())
         return QStringList(resultValue.toString());
@@ -162,7 +177,7 @@ ScriptedMapFormat::ScriptedMapFormat(const QString &shortName,
                                      QObject *parent)
     : MapFormat(parent)
     , mShortName(shortName)
-    , mFormat(object)
+    , mFormat(shortName, object)
 {
     PluginManager::addObject(this);
 }
@@ -213,7 +228,7 @@ ScriptedTilesetFormat::ScriptedTilesetFormat(const QString &shortName,
                                              QObject *parent)
     : TilesetFormat(parent)
     , mShortName(shortName)
-    , mFormat(object)
+    , mFormat(shortName, object)
 {
     PluginManager::addObject(this);
 }
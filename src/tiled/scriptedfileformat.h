@@ -32,7 +32,7 @@ class EditableAsset;
 class ScriptedFileFormat
 {
 public:
-    explicit ScriptedFileFormat(const QJSValue &object);
+    ScriptedFileFormat(const QString &shortName, const QJSValue &object);
 
     FileFormat::Capabilities capabilities() const;
     QString nameFilter() const;
@@ -48,6 +48,8 @@ public:
 
 private:
     QJSValue mObject;
+    QString mShortName;
+    QString mExtension;
 };
 
 class ScriptedMapFormat final : public MapFormat
@@ -42,6 +42,7 @@ namespace Tiled {
 ScriptedTool::ScriptedTool(Id id, QJSValue object, QObject *parent)
     : AbstractTileTool(id, QStringLiteral("<unnamed tool>"), QIcon(), QKeySequence(), nullptr, parent)
     , mScriptObject(std::move(object))
+    , mExtension(ScriptManager::instance().loadingExtension())
 {
     // Read out the properties from the script object before setting its prototype
     const QJSValue nameProperty = mScriptObject.property(QStringLiteral("name"));
@@ -322,7 +323,12 @@ bool ScriptedTool::call(const QString &methodName, const QJSValueList &args)
     QJSValue method = mScriptObject.property(methodName);
     if (method.isCallable()) {
         auto &scriptManager = ScriptManager::instance();
-        QJSValue result = method.callWithInstance(mScriptObject, args);
+        QJSValue result;
+        {
+            ScriptProfiler::Scope scope(scriptManager.profiler(), mExtension,
+                                        name() + QLatin1Char('.') + methodName);
+            result = method.callWithInstance(mScriptObject, args);
+        }
         scriptManager.checkError(result);
 
         return true;
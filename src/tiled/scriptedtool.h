@@ -83,6 +83,7 @@ private:
     bool call(const QString &methodName, const QJSValueList &args = QJSValueList());
 
     QJSValue mScriptObject;
+    QString mExtension;
     QString mIconFileName;
     QList<Id> mToolBarActions;
 };
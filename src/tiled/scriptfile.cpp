@@ -49,6 +49,7 @@
 #include <errno.h>
 #endif
 
+#include <algorithm>
 #include <memory>
 
 namespace Tiled {
@@ -182,8 +183,16 @@ public:
 
 private:
     bool checkForClosed() const;
+    bool flushWriteBuffer() const;
+
+    // Writes smaller than this are collected before passing them on
+    static constexpr int WriteBufferSize = 1024 * 1024;
 
     std::unique_ptr<QFileDevice> m_file;
+    const uchar *m_map = nullptr;
+    qint64 m_mapSize = 0;
+    qint64 m_mapPos = 0;
+    mutable QByteArray m_writeBuffer;
 };
 
 
@@ -488,10 +497,28 @@ ScriptBinaryFile::ScriptBinaryFile(const QString &filePath, OpenMode mode)
                                                                          "Unable to open file '%1': %2").arg(filePath,
                                                                                                              m_file->errorString()));
         m_file.reset();
+        return;
+    }
+
+    // Read-only files are mapped into memory when possible, so that reads
+    // don't need to go through the file device
+    if (m == QIODevice::ReadOnly) {
+        const qint64 size = m_file->size();
+        if (size > 0) {
+            if (uchar *map = m_file->map(0, size)) {
+                m_map = map;
+                m_mapSize = size;
+            }
+        }
     }
 }
 
-ScriptBinaryFile::~ScriptBinaryFile() = default;
+ScriptBinaryFile::~ScriptBinaryFile()
+{
+    // Make sure buffered data isn't lost when the file wasn't closed
+    if (m_file && !m_writeBuffer.isEmpty())
+        m_file->write(m_writeBuffer);
+}
 
 QString ScriptBinaryFile::filePath() const
 {
@@ -504,6 +531,10 @@ bool ScriptBinaryFile::atEof() const
 {
     if (checkForClosed())
         return true;
+    if (m_map)
+        return m_mapPos >= m_mapSize;
+    if (!flushWriteBuffer())
+        return true;
     return m_file->atEnd();
 }
 
@@ -511,6 +542,10 @@ qint64 ScriptBinaryFile::size() const
 {
     if (checkForClosed())
         return -1;
+    if (m_map)
+        return m_mapSize;
+    if (!flushWriteBuffer())
+        return -1;
     return m_file->size();
 }
 
@@ -518,12 +553,14 @@ qint64 ScriptBinaryFile::pos() const
 {
     if (checkForClosed())
         return -1;
-    return m_file->pos();
+    if (m_map)
+        return m_mapPos;
+    return m_file->pos() + m_writeBuffer.size();
 }
 
 void ScriptBinaryFile::resize(qint64 size)
 {
-    if (checkForClosed())
+    if (checkForClosed() || !flushWriteBuffer())
         return;
     if (Q_UNLIKELY(!m_file->resize(size))) {
         ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
@@ -536,6 +573,20 @@ void ScriptBinaryFile::seek(qint64 pos)
 {
     if (checkForClosed())
         return;
+
+    if (m_map) {
+        if (Q_UNLIKELY(pos < 0)) {
+            ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
+                                                                             "Could not seek '%1': %2").arg(m_file->fileName(),
+                                                                                                            QCoreApplication::translate("Script Errors", "Invalid position")));
+            return;
+        }
+        m_mapPos = pos;
+        return;
+    }
+
+    if (!flushWriteBuffer())
+        return;
     if (Q_UNLIKELY(!m_file->seek(pos))) {
         ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
                                                                          "Could not seek '%1': %2").arg(m_file->fileName(),
@@ -547,6 +598,20 @@ QByteArray ScriptBinaryFile::read(qint64 size)
 {
     if (checkForClosed())
         return {};
+
+    if (m_map) {
+        const qint64 available = std::max<qint64>(0, m_mapSize - m_mapPos);
+        const qint64 length = std::min(std::max<qint64>(0, size), available);
+        if (length == 0)
+            return {};
+
+        const QByteArray data(reinterpret_cast<const char*>(m_map + m_mapPos), qsizetype(length));
+        m_mapPos += length;
+        return data;
+    }
+
+    if (!flushWriteBuffer())
+        return {};
     const QByteArray data = m_file->read(size);
     if (Q_UNLIKELY(data.size() == 0 && m_file->error() != QFile::NoError)) {
         ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
@@ -562,6 +627,11 @@ QByteArray ScriptBinaryFile::readAll()
     if (checkForClosed())
         return {};
 
+    if (m_map)
+        return read(m_mapSize - m_mapPos);
+
+    if (!flushWriteBuffer())
+        return {};
     const QByteArray data = m_file->readAll();
     if (Q_UNLIKELY(data.size() == 0 && m_file->error() != QFile::NoError)) {
         ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
@@ -577,6 +647,17 @@ void ScriptBinaryFile::write(const QByteArray &data)
     if (checkForClosed())
         return;
 
+    // Small writes are collected, to avoid passing each one to the device
+    if (!m_map && data.size() < WriteBufferSize) {
+        m_writeBuffer.append(data);
+        if (m_writeBuffer.size() >= WriteBufferSize)
+            flushWriteBuffer();
+        return;
+    }
+
+    if (!flushWriteBuffer())
+        return;
+
     const qint64 size = m_file->write(data);
     if (Q_UNLIKELY(size == -1)) {
         ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
@@ -587,7 +668,7 @@ void ScriptBinaryFile::write(const QByteArray &data)
 
 void ScriptBinaryFile::commit()
 {
-    if (checkForClosed())
+    if (checkForClosed() || !flushWriteBuffer())
         return;
 
     bool ok = true;
@@ -611,6 +692,11 @@ void ScriptBinaryFile::close()
     if (checkForClosed())
         return;
 
+    flushWriteBuffer();
+
+    m_map = nullptr;
+    m_mapSize = 0;
+    m_mapPos = 0;
     m_file.reset();
 }
 
@@ -624,6 +710,28 @@ bool ScriptBinaryFile::checkForClosed() const
     return true;
 }
 
+/**
+ * Writes any buffered data to the file. Returns false and throws a script
+ * error when this failed.
+ */
+bool ScriptBinaryFile::flushWriteBuffer() const
+{
+    if (m_writeBuffer.isEmpty())
+        return true;
+
+    const qint64 size = m_file->write(m_writeBuffer);
+    m_writeBuffer.clear();
+
+    if (Q_UNLIKELY(size == -1)) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors",
+                                                                         "Could not write to '%1': %2").arg(m_file->fileName(),
+                                                                                                            m_file->errorString()));
+        return false;
+    }
+
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 ScriptTextFile::ScriptTextFile()
@@ -55,6 +55,7 @@
 #include "tilelayerwangedit.h"
 #include "tilesetdock.h"
 #include "tileseteditor.h"
+#include "tracer.h"
 
 #include <QCoreApplication>
 #include <QDesktopServices>
@@ -153,6 +154,8 @@ ScriptManager::ScriptManager(QObject *parent)
 void ScriptManager::ensureInitialized()
 {
     if (!mEngine) {
+        TraceScope trace("Initialize scripting");
+
         if (mExtensionsPaths.isEmpty())
             refreshExtensionsPaths();
 
@@ -173,7 +176,13 @@ QJSValue ScriptManager::evaluate(const QString &program,
     if (!fileName.isEmpty())
         globalObject.setProperty(QStringLiteral("__filename"), fileName);
 
-    QJSValue result = mEngine->evaluate(program, fileName, lineNumber);
+    QJSValue result;
+    {
+        ScriptProfiler::Scope scope(mProfiler, mLoadingExtension,
+                                    fileName.isEmpty() ? QStringLiteral("evaluate")
+                                                       : QLatin1String("evaluate ") + fileName);
+        result = mEngine->evaluate(program, fileName, lineNumber);
+    }
     checkError(result, program);
 
     globalObject.deleteProperty(QStringLiteral("__filename"));
@@ -190,7 +199,12 @@ void ScriptManager::evaluateFileOrLoadModule(const QString &fileName)
         QJSValue globalObject = mEngine->globalObject();
         globalObject.setProperty(QStringLiteral("__filename"), fileName);
 
-        QJSValue result = mEngine->importModule(fileName);
+        QJSValue result;
+        {
+            ScriptProfiler::Scope scope(mProfiler, mLoadingExtension,
+                                        QLatin1String("import ") + fileName);
+            result = mEngine->importModule(fileName);
+        }
 
         // According to the documentation, importModule could return an
         // error object, though in practice this doesn't appear to happen.
@@ -288,11 +302,17 @@ void ScriptManager::loadExtension(const QString &path)
     const QStringList jsFiles = dir.entryList(nameFilters,
                                               QDir::Files | QDir::Readable);
 
+    // Scripts directly in an extensions path are each their own extension
+    const bool topLevel = mExtensionsPaths.contains(path);
+
     for (const QString &jsFile : jsFiles) {
         const QString absolutePath = dir.filePath(jsFile);
+        mLoadingExtension = topLevel ? absolutePath : path;
         evaluateFileOrLoadModule(absolutePath);
         mWatcher.addPath(absolutePath);
     }
+
+    mLoadingExtension.clear();
 }
 
 bool ScriptManager::checkError(QJSValue value, const QString &program)
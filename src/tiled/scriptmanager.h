@@ -21,6 +21,7 @@
 #pragma once
 
 #include "filesystemwatcher.h"
+#include "scriptprofiler.h"
 #include "tilededitor_global.h"
 
 #include <QJSValue>
@@ -69,6 +70,9 @@ public:
 
     ScriptModule *module() const;
     QJSEngine *engine() const;
+    ScriptProfiler &profiler();
+
+    const QString &loadingExtension() const;
 
     QJSValue evaluate(const QString &program,
                       const QString &fileName = QString(), int lineNumber = 1);
@@ -114,6 +118,8 @@ private:
     FileSystemWatcher mWatcher;
     QString mExtensionsPath;
     QStringList mExtensionsPaths;
+    QString mLoadingExtension;
+    ScriptProfiler mProfiler;
     int mTempCount = 0;
     bool mProjectExtensionsSuppressed = false;
 
@@ -140,6 +146,20 @@ inline QJSEngine *ScriptManager::engine() const
     return mEngine;
 }
 
+inline ScriptProfiler &ScriptManager::profiler()
+{
+    return mProfiler;
+}
+
+/**
+ * Returns the path of the extension that is currently being loaded, or an
+ * empty string when no extension is being loaded.
+ */
+inline const QString &ScriptManager::loadingExtension() const
+{
+    return mLoadingExtension;
+}
+
 inline bool ScriptManager::projectExtensionsSuppressed() const
 {
     return mProjectExtensionsSuppressed;
@@ -24,11 +24,14 @@
 #include "commandmanager.h"
 #include "compression.h"
 #include "documentmanager.h"
+#include "editablemap.h"
 #include "editabletileset.h"
 #include "issuesmodel.h"
 #include "logginginterface.h"
 #include "mainwindow.h"
+#include "mapdiff.h"
 #include "mapeditor.h"
+#include "memoryreport.h"
 #include "projectmanager.h"
 #include "scriptdialog.h"
 #include "scriptedaction.h"
@@ -687,38 +690,54 @@ void ScriptModule::setCallback(Issue &issue, QJSValue activated)
     }
 }
 
+// Signal handlers connected by scripts are called directly by the engine,
+// so their time is recorded per signal rather than per extension.
 void ScriptModule::documentCreated(Document *document)
 {
+    ScriptProfiler::Scope scope(ScriptManager::instance().profiler(), QString(),
+                                QStringLiteral("assetCreated"));
     emit assetCreated(document->editable());
 }
 
 void ScriptModule::documentOpened(Document *document)
 {
+    ScriptProfiler::Scope scope(ScriptManager::instance().profiler(), QString(),
+                                QStringLiteral("assetOpened"));
     emit assetOpened(document->editable());
 }
 
 void ScriptModule::documentReloaded(Document *document)
 {
+    ScriptProfiler::Scope scope(ScriptManager::instance().profiler(), QString(),
+                                QStringLiteral("assetReloaded"));
     emit assetReloaded(document->editable());
 }
 
 void ScriptModule::documentAboutToBeSaved(Document *document)
 {
+    ScriptProfiler::Scope scope(ScriptManager::instance().profiler(), QString(),
+                                QStringLiteral("assetAboutToBeSaved"));
     emit assetAboutToBeSaved(document->editable());
 }
 
 void ScriptModule::documentSaved(Document *document)
 {
+    ScriptProfiler::Scope scope(ScriptManager::instance().profiler(), QString(),
+                                QStringLiteral("assetSaved"));
     emit assetSaved(document->editable());
 }
 
 void ScriptModule::documentAboutToClose(Document *document)
 {
+    ScriptProfiler::Scope scope(ScriptManager::instance().profiler(), QString(),
+                                QStringLiteral("assetAboutToBeClosed"));
     emit assetAboutToBeClosed(document->editable());
 }
 
 void ScriptModule::currentDocumentChanged(Document *document)
 {
+    ScriptProfiler::Scope scope(ScriptManager::instance().profiler(), QString(),
+                                QStringLiteral("activeAssetChanged"));
     emit activeAssetChanged(document ? document->editable() : nullptr);
 }
 
@@ -753,6 +772,81 @@ void ScriptModule::unloadAllWorlds() const
     WorldManager::instance().unloadAllWorlds();
 }
 
+void ScriptModule::startProfiling() const
+{
+    ScriptManager::instance().profiler().start();
+}
+
+/**
+ * Stops profiling and reports the results in the Console view.
+ */
+void ScriptModule::stopProfiling() const
+{
+    auto &profiler = ScriptManager::instance().profiler();
+    profiler.stop();
+
+    const QStringList lines = profiler.summary();
+    for (const QString &line : lines)
+        Tiled::INFO(line);
+}
+
+/**
+ * Saves the calls recorded by the last profiling session to \a fileName, in
+ * the Chrome trace event format.
+ */
+bool ScriptModule::saveProfile(const QString &fileName) const
+{
+    QString error;
+    if (!ScriptManager::instance().profiler().writeChromeTrace(fileName, &error)) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Error saving profile: %1").arg(error));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Returns a report of the approximate amount of memory used by the given
+ * open \a asset, or by all open assets and the shared caches when no asset
+ * is given.
+ */
+QVariantMap ScriptModule::memoryReport(EditableAsset *asset) const
+{
+    if (asset) {
+        if (!asset->document()) {
+            ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Not an open asset"));
+            return {};
+        }
+        return MemoryReport::forDocument(asset->document()).toVariant();
+    }
+
+    MemoryReportEntry report;
+    report.name = QCoreApplication::translate("Tiled::MemoryReport", "Memory report");
+
+    if (auto documentManager = DocumentManager::maybeInstance())
+        for (const auto &document : documentManager->documents())
+            report.children.append(MemoryReport::forDocument(document.data()));
+    report.children.append(MemoryReport::forSharedCaches());
+
+    for (const MemoryReportEntry &child : std::as_const(report.children))
+        report.bytes += std::max<qint64>(child.bytes, 0);
+
+    return report.toVariant();
+}
+
+QVariantMap ScriptModule::compareMaps(EditableMap *oldMap, EditableMap *newMap) const
+{
+    if (!oldMap) {
+        ScriptManager::instance().throwNullArgError(0);
+        return {};
+    }
+    if (!newMap) {
+        ScriptManager::instance().throwNullArgError(1);
+        return {};
+    }
+
+    return MapDiff::compare(*oldMap->map(), *newMap->map()).toVariant();
+}
+
 } // namespace Tiled
 
 #include "moc_scriptmodule.cpp"
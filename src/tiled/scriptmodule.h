@@ -36,6 +36,7 @@ namespace Tiled {
 
 class Document;
 class EditableAsset;
+class EditableMap;
 class MapEditor;
 class ScriptImage;
 class ScriptMapFormatWrapper;
@@ -149,6 +150,13 @@ public:
     Q_INVOKABLE void unloadWorld(const QString &fileName) const;
     Q_INVOKABLE void unloadAllWorlds() const;
 
+    Q_INVOKABLE void startProfiling() const;
+    Q_INVOKABLE void stopProfiling() const;
+    Q_INVOKABLE bool saveProfile(const QString &fileName) const;
+
+    Q_INVOKABLE QVariantMap memoryReport(Tiled::EditableAsset *asset = nullptr) const;
+    Q_INVOKABLE QVariantMap compareMaps(Tiled::EditableMap *oldMap, Tiled::EditableMap *newMap) const;
+
 signals:
     void assetCreated(Tiled::EditableAsset *asset);
     void assetOpened(Tiled::EditableAsset *asset);
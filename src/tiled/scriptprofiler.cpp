@@ -0,0 +1,242 @@
+/*
+ * scriptprofiler.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scriptprofiler.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <algorithm>
+
+namespace Tiled {
+
+// Limits the memory used when profiling is left enabled for a long time
+static constexpr int MaxRecordedCalls = 1000000;
+
+int ScriptProfiler::mWrapperCount = 0;
+int ScriptProfiler::mLiveWrapperCount = 0;
+
+ScriptProfiler::Scope::Scope(ScriptProfiler &profiler,
+                             const QString &extension,
+                             const QString &name)
+    : mProfiler(profiler.isEnabled() ? &profiler : nullptr)
+{
+    if (!mProfiler)
+        return;
+
+    mExtension = extension;
+    mName = name;
+    mStart = mProfiler->mTimer.nsecsElapsed();
+    mSession = mProfiler->mSession;
+    mDepth = mProfiler->mDepth++;
+    mWrappersCreated = mWrapperCount;
+}
+
+ScriptProfiler::Scope::~Scope()
+{
+    if (!mProfiler)
+        return;
+
+    // Profiling may have been stopped or restarted during the call
+    if (mProfiler->mSession != mSession)
+        return;
+
+    mProfiler->mDepth = mDepth;
+
+    if (mProfiler->isEnabled())
+        mProfiler->record(mExtension, mName, mStart, mDepth, mWrapperCount - mWrappersCreated);
+}
+
+/**
+ * Enables the profiler, discarding any previously recorded calls.
+ */
+void ScriptProfiler::start()
+{
+    mCalls.clear();
+    ++mSession;
+    mDroppedCalls = 0;
+    mDepth = 0;
+    mTimer.start();
+    mEnabled = true;
+}
+
+/**
+ * Disables the profiler. The recorded calls are kept until the profiler is
+ * started again.
+ */
+void ScriptProfiler::stop()
+{
+    mEnabled = false;
+}
+
+void ScriptProfiler::record(const QString &extension, const QString &name,
+                            qint64 start, int depth, int wrappersCreated)
+{
+    if (mCalls.size() >= MaxRecordedCalls) {
+        ++mDroppedCalls;
+        return;
+    }
+
+    mCalls.append(Call { extension, name,
+                         start, mTimer.nsecsElapsed() - start,
+                         depth, wrappersCreated });
+}
+
+static QString milliseconds(qint64 nanoseconds)
+{
+    return QString::number(nanoseconds / 1000000.0, 'f', 2);
+}
+
+/**
+ * Returns a human-readable summary of the recorded calls, as a list of lines.
+ *
+ * Lists the time spent per extension, followed by the time spent per
+ * callback, slowest first. The time of a callback includes the time of any
+ * calls made from it.
+ */
+QStringList ScriptProfiler::summary() const
+{
+    struct Totals
+    {
+        QString extension;
+        QString name;
+        qint64 duration = 0;
+        int count = 0;
+        int wrappersCreated = 0;
+    };
+
+    QHash<QString, Totals> extensions;
+    QHash<QPair<QString, QString>, Totals> callbacks;
+    qint64 totalDuration = 0;
+
+    for (const Call &call : mCalls) {
+        auto &callback = callbacks[qMakePair(call.extension, call.name)];
+        callback.extension = call.extension;
+        callback.name = call.name;
+        callback.duration += call.duration;
+        callback.count += 1;
+        callback.wrappersCreated += call.wrappersCreated;
+
+        // Only count outermost calls, to avoid counting nested calls twice
+        if (call.depth == 0) {
+            auto &extension = extensions[call.extension];
+            extension.extension = call.extension;
+            extension.duration += call.duration;
+            extension.count += 1;
+            extension.wrappersCreated += call.wrappersCreated;
+            totalDuration += call.duration;
+        }
+    }
+
+    auto slowestFirst = [] (const Totals &a, const Totals &b) {
+        return a.duration > b.duration;
+    };
+
+    QVector<Totals> sortedExtensions(extensions.begin(), extensions.end());
+    QVector<Totals> sortedCallbacks(callbacks.begin(), callbacks.end());
+    std::sort(sortedExtensions.begin(), sortedExtensions.end(), slowestFirst);
+    std::sort(sortedCallbacks.begin(), sortedCallbacks.end(), slowestFirst);
+
+    auto extensionName = [] (const QString &extension) {
+        if (extension.isEmpty())
+            return QCoreApplication::translate("Tiled::ScriptProfiler", "(no extension)");
+        return QFileInfo(extension).fileName();
+    };
+
+    QStringList lines;
+    lines.append(QCoreApplication::translate("Tiled::ScriptProfiler", "Script profile: %1 ms in %n call(s)", nullptr, mCalls.size())
+                 .arg(milliseconds(totalDuration)));
+
+    if (mDroppedCalls > 0)
+        lines.append(QCoreApplication::translate("Tiled::ScriptProfiler", "%n call(s) were not recorded", nullptr, mDroppedCalls));
+
+    lines.append(QCoreApplication::translate("Tiled::ScriptProfiler", "%n wrapper(s) currently alive", nullptr, mLiveWrapperCount));
+
+    for (const Totals &totals : std::as_const(sortedExtensions)) {
+        lines.append(QCoreApplication::translate("Tiled::ScriptProfiler", "%1 ms in %2: %n call(s), %3 wrapper(s) created", nullptr, totals.count)
+                     .arg(milliseconds(totals.duration),
+                          extensionName(totals.extension),
+                          QString::number(totals.wrappersCreated)));
+    }
+
+    for (const Totals &totals : std::as_const(sortedCallbacks)) {
+        lines.append(QCoreApplication::translate("Tiled::ScriptProfiler", "%1 ms in %2 (%3): %n call(s), %4 wrapper(s) created", nullptr, totals.count)
+                     .arg(milliseconds(totals.duration),
+                          totals.name,
+                          extensionName(totals.extension),
+                          QString::number(totals.wrappersCreated)));
+    }
+
+    return lines;
+}
+
+/**
+ * Writes the recorded calls to \a fileName in the Chrome trace event format,
+ * which can be viewed in chrome://tracing or https://ui.perfetto.dev.
+ */
+bool ScriptProfiler::writeChromeTrace(const QString &fileName, QString *error) const
+{
+    QJsonArray traceEvents;
+
+    for (const Call &call : mCalls) {
+        traceEvents.append(QJsonObject {
+            { QStringLiteral("name"), call.name },
+            { QStringLiteral("cat"), QFileInfo(call.extension).fileName() },
+            { QStringLiteral("ph"), QStringLiteral("X") },
+            { QStringLiteral("ts"), call.start / 1000.0 },
+            { QStringLiteral("dur"), call.duration / 1000.0 },
+            { QStringLiteral("pid"), 1 },
+            { QStringLiteral("tid"), 1 },
+            { QStringLiteral("args"), QJsonObject {
+                  { QStringLiteral("extension"), call.extension },
+                  { QStringLiteral("wrappersCreated"), call.wrappersCreated },
+              } },
+        });
+    }
+
+    const QJsonObject trace {
+        { QStringLiteral("traceEvents"), traceEvents },
+        { QStringLiteral("displayTimeUnit"), QStringLiteral("ms") },
+    };
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+
+    if (!file.commit()) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace Tiled
@@ -0,0 +1,106 @@
+/*
+ * scriptprofiler.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+
+namespace Tiled {
+
+/**
+ * Records the time spent in script code, to help finding out which extension
+ * or callback is slowing things down.
+ *
+ * Profiling is off by default and is controlled through the scripting API.
+ * While enabled, each instrumented call is recorded along with the extension
+ * it belongs to and the number of editable wrapper objects created during
+ * the call. Since wrappers are reused for as long as the wrapped object
+ * exists, a high number of created wrappers usually means objects are being
+ * created and removed, or detached copies are being made.
+ */
+class ScriptProfiler
+{
+public:
+    /**
+     * Records the duration of its own lifetime as a call to \a name, when
+     * the profiler is enabled.
+     */
+    class Scope
+    {
+    public:
+        Scope(ScriptProfiler &profiler,
+              const QString &extension,
+              const QString &name);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        ScriptProfiler *mProfiler;
+        QString mExtension;
+        QString mName;
+        qint64 mStart = 0;
+        int mSession = 0;
+        int mDepth = 0;
+        int mWrappersCreated = 0;
+    };
+
+    struct Call
+    {
+        QString extension;
+        QString name;
+        qint64 start;       // nanoseconds since profiling started
+        qint64 duration;    // in nanoseconds
+        int depth;          // number of enclosing calls
+        int wrappersCreated;
+    };
+
+    void start();
+    void stop();
+    bool isEnabled() const { return mEnabled; }
+
+    const QVector<Call> &calls() const { return mCalls; }
+
+    QStringList summary() const;
+    bool writeChromeTrace(const QString &fileName, QString *error = nullptr) const;
+
+    static void wrapperCreated() { ++mWrapperCount; ++mLiveWrapperCount; }
+    static void wrapperDestroyed() { --mLiveWrapperCount; }
+    static int liveWrapperCount() { return mLiveWrapperCount; }
+
+private:
+    void record(const QString &extension, const QString &name,
+                qint64 start, int depth, int wrappersCreated);
+
+    bool mEnabled = false;
+    int mSession = 0;
+    int mDepth = 0;
+    int mDroppedCalls = 0;
+    QElapsedTimer mTimer;
+    QVector<Call> mCalls;
+
+    static int mWrapperCount;
+    static int mLiveWrapperCount;
+};
+
+} // namespace Tiled
@@ -55,7 +55,7 @@ void SelectSameTileTool::tilePositionChanged(QPoint tilePos)
             resultRegion = infinite ? tileLayer->bounds() : tileLayer->rect();
             resultRegion -= tileLayer->region();
         } else {
-            resultRegion = tileLayer->region([&] (const Cell &cell) { return cell == matchCell; });
+            resultRegion = tileLayer->regionOfCell(matchCell);
         }
     }
     setSelectedRegion(resultRegion);
@@ -220,12 +220,13 @@ void ShapeFillTool::updateFillOverlay()
     QRect area = QRect::span(p1, p2);
 #endif
 
+    // Keep the random tiles that were already picked while resizing the shape
     switch (mCurrentShape) {
     case Rect:
-        updatePreview(area);
+        updatePreview(area, true);
         break;
     case Circle:
-        updatePreview(ellipseRegion(area));
+        updatePreview(ellipseRegion(area), true);
         break;
     }
 }
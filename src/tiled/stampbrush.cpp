@@ -28,6 +28,7 @@
 #include "mapscene.h"
 #include "stampactions.h"
 #include "tile.h"
+#include "tileregion.h"
 #include "tilestamp.h"
 #include "wangset.h"
 #include "wangfiller.h"
@@ -97,8 +98,8 @@ void StampBrush::tilePositionChanged(QPoint pos)
             drawPreviewLayer(QVector<QPoint>() << points.at(i));
 
             // Only update the brush item for the last drawn piece
-            if (i == points.size() - 1)
-                brushItem()->setMap(mPreviewMap);
+            if (i == points.size() - 1 && mPreviewMap)
+                brushItem()->setMap(mPreviewMap, mPreviewRegion);
 
             doPaint(Mergeable, &paintedRegions);
         }
@@ -385,6 +386,45 @@ static void shiftColumns(TileLayer *tileLayer, Map::StaggerIndex staggerIndex)
 }
 
 void StampBrush::drawPreviewLayer(const QVector<QPoint> &points)
+{
+    if (points.size() == 1 && movePreview(points.first()))
+        return;
+
+    buildPreview(points);
+
+    mPreviewRegion = mPreviewMap ? mPreviewMap->modifiedTileRegion() : QRegion();
+
+    // A preview of a single stamp without random elements can be moved
+    // around instead of being rebuilt for each position
+    mPreviewMovable = mPreviewMap && points.size() == 1
+            && !mIsRandom && !mIsWangFill
+            && mStamp.variations().size() == 1
+            && !mapDocument()->map()->isStaggered();
+    mPreviewPosition = points.isEmpty() ? QPoint() : points.first();
+}
+
+/**
+ * Moves the existing preview to \a pos, when possible. Returns whether the
+ * preview was moved.
+ */
+bool StampBrush::movePreview(QPoint pos)
+{
+    if (!mPreviewMovable || !mPreviewMap || mIsRandom || mIsWangFill)
+        return false;
+
+    const QPoint offset = pos - mPreviewPosition;
+    if (offset.isNull())
+        return true;
+
+    for (Layer *layer : mPreviewMap->tileLayers())
+        layer->setPosition(layer->position() + offset);
+
+    mPreviewRegion.translate(offset);
+    mPreviewPosition = pos;
+    return true;
+}
+
+void StampBrush::buildPreview(const QVector<QPoint> &points)
 {
     mPreviewMap.clear();
 
@@ -432,10 +472,11 @@ void StampBrush::drawPreviewLayer(const QVector<QPoint> &points)
         if (!tileLayer)
             return;
 
-        QRegion paintedRegion;
+        TileRegion pointsRegion;
         for (const QPoint &p : points)
-            paintedRegion += QRect(p, p);
+            pointsRegion.addSpan(p.x(), p.y(), 1);
 
+        const QRegion paintedRegion = pointsRegion.toRegion();
         const QRect bounds = paintedRegion.boundingRect();
 
         Map::Parameters mapParameters = mapDocument()->map()->parameters();
@@ -461,7 +502,7 @@ void StampBrush::drawPreviewLayer(const QVector<QPoint> &points)
         QVector<PaintOperation> operations;
         QHash<const Map *, QRegion> regionCache;
         QHash<const Map *, Map *> shiftedCopies;
-        const auto randomVariations = mStamp.randomVariations();
+        const auto &randomVariations = mStamp.randomVariations();
         const Map::StaggerAxis mapStaggerAxis = mapDocument()->map()->staggerAxis();
         const Map::StaggerIndex mapStaggerIndex = mapDocument()->map()->staggerIndex();
 
@@ -626,7 +667,7 @@ void StampBrush::updatePreview(QPoint tilePos)
         }
 
         if (mPreviewMap)
-            tileRegion = mPreviewMap->modifiedTileRegion();
+            tileRegion = mPreviewRegion;
 
         if (tileRegion.isEmpty())
             tileRegion = QRect(tilePos, tilePos);
@@ -669,6 +710,7 @@ void StampBrush::setWangFill(bool value)
 void StampBrush::invalidateRandomCache()
 {
     mRandomCacheValid = false;
+    mPreviewMovable = false;
 }
 
 #include "moc_stampbrush.cpp"
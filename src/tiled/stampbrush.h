@@ -113,12 +113,22 @@ private:
 
     TileStamp mStamp;
     SharedMap mPreviewMap;
+    QRegion mPreviewRegion;
     QVector<SharedTileset> mMissingTilesets;
 
+    /**
+     * Whether the preview map can be moved to paint the stamp at another
+     * position, and the position it is currently at.
+     */
+    bool mPreviewMovable = false;
+    QPoint mPreviewPosition;
+
     CaptureStampHelper mCaptureStampHelper;
     QPoint mPrevTilePosition;
 
     void drawPreviewLayer(const QVector<QPoint> &points);
+    bool movePreview(QPoint pos);
+    void buildPreview(const QVector<QPoint> &points);
 
     /**
      * There are several options how the stamp utility can be used.
@@ -154,7 +164,7 @@ private:
     QPoint mStampReference;
 
     bool mIsRandom = false;
-    RandomPicker<Cell> mRandomCellPicker;
+    AliasPicker<Cell> mRandomCellPicker;
 
     bool mIsWangFill = false;
     WangSet *mWangSet = nullptr;
@@ -96,7 +96,7 @@ void SwapTiles::swap()
         if (tileSizeChanged)
             changedProperties |= MapObject::SizeProperty;
 
-        emit mMapDocument->changed(MapObjectsChangeEvent(changedObjects, changedProperties));
+        mMapDocument->emitChanged(MapObjectsChangeEvent(changedObjects, changedProperties));
     }
 }
 
@@ -344,7 +344,7 @@ void TemplatesDock::undo()
 {
     if (mDummyMapDocument) {
         mDummyMapDocument->undoStack()->undo();
-        emit mDummyMapDocument->selectedObjectsChanged();
+        emit mDummyMapDocument->selectedObjectsChanged({}, {});
     }
 }
 
@@ -352,7 +352,7 @@ void TemplatesDock::redo()
 {
     if (mDummyMapDocument) {
         mDummyMapDocument->undoStack()->redo();
-        emit mDummyMapDocument->selectedObjectsChanged();
+        emit mDummyMapDocument->selectedObjectsChanged({}, {});
     }
 }
 
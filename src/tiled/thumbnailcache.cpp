@@ -0,0 +1,200 @@
+/*
+ * thumbnailcache.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thumbnailcache.h"
+
+#include "map.h"
+#include "mapformat.h"
+#include "minimaprenderer.h"
+#include "tileset.h"
+#include "tilesetformat.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+namespace Tiled {
+
+ThumbnailCache::ThumbnailCache(QObject *parent)
+    : QObject(parent)
+    , mCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                      + QLatin1String("/thumbnails"))
+{
+    mGenerateTimer.setSingleShot(true);
+    connect(&mGenerateTimer, &QTimer::timeout,
+            this, &ThumbnailCache::generateNextThumbnail);
+}
+
+ThumbnailCache &ThumbnailCache::instance()
+{
+    static ThumbnailCache thumbnailCache;
+    return thumbnailCache;
+}
+
+/**
+ * Returns the path of the thumbnail of the given file, or an empty string
+ * when no up-to-date thumbnail has been stored.
+ */
+QString ThumbnailCache::cachedThumbnailPath(const QString &fileName) const
+{
+    const QString path = thumbnailPath(fileName);
+    if (!path.isEmpty() && QFileInfo::exists(path))
+        return path;
+    return QString();
+}
+
+/**
+ * Returns the stored thumbnail of the given file, or a null image when no
+ * up-to-date thumbnail has been stored.
+ */
+QImage ThumbnailCache::thumbnail(const QString &fileName) const
+{
+    const QString path = cachedThumbnailPath(fileName);
+    if (path.isEmpty())
+        return QImage();
+    return QImage(path);
+}
+
+/**
+ * Requests a thumbnail to be generated for the given map or tileset file,
+ * unless one has already been stored. The thumbnailReady() signal is emitted
+ * once it is available.
+ *
+ * Thumbnails are generated one at a time in between other events.
+ */
+void ThumbnailCache::requestThumbnail(const QString &fileName)
+{
+    if (mPendingFiles.contains(fileName) || mFailedFiles.contains(fileName))
+        return;
+    if (!cachedThumbnailPath(fileName).isEmpty())
+        return;
+
+    if (!QFileInfo(fileName).isFile() ||
+            (!findSupportingMapFormat(fileName) && !findSupportingTilesetFormat(fileName))) {
+        mFailedFiles.insert(fileName);
+        return;
+    }
+
+    mPendingFiles.append(fileName);
+    if (!mGenerateTimer.isActive())
+        mGenerateTimer.start(0);
+}
+
+/**
+ * Renders and stores a thumbnail of the given \a map, which was loaded from
+ * \a fileName. The thumbnail is written in the background.
+ *
+ * Returns the rendered thumbnail.
+ */
+QImage ThumbnailCache::storeThumbnail(const QString &fileName, const Map &map)
+{
+    const QImage image = renderThumbnail(map);
+    storeThumbnail(fileName, image);
+    return image;
+}
+
+/**
+ * Renders a thumbnail of the given \a map, fitting within the thumbnail
+ * size.
+ */
+QImage ThumbnailCache::renderThumbnail(const Map &map)
+{
+    const MiniMapRenderer renderer(&map);
+    const QSize mapSize = renderer.mapSize();
+    if (mapSize.isEmpty())
+        return QImage();
+
+    const QSize size = mapSize.boundedTo(QSize(ThumbnailSize, ThumbnailSize));
+
+    return renderer.render(mapSize.scaled(size, Qt::KeepAspectRatio),
+                           MiniMapRenderer::DrawTileLayers |
+                           MiniMapRenderer::DrawImageLayers |
+                           MiniMapRenderer::DrawMapObjects |
+                           MiniMapRenderer::IgnoreInvisibleLayer |
+                           MiniMapRenderer::IgnoreOffsetsAndImages |
+                           MiniMapRenderer::SmoothPixmapTransform);
+}
+
+QString ThumbnailCache::thumbnailPath(const QString &fileName) const
+{
+    const QFileInfo fileInfo(fileName);
+    if (!fileInfo.exists())
+        return QString();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(fileInfo.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+    hash.addData(QByteArray::number(fileInfo.size()));
+
+    return mCacheDirectory + QLatin1Char('/')
+            + QString::fromLatin1(hash.result().toHex())
+            + QLatin1String(".png");
+}
+
+void ThumbnailCache::storeThumbnail(const QString &fileName, const QImage &image)
+{
+    const QString path = thumbnailPath(fileName);
+    if (path.isEmpty() || image.isNull())
+        return;
+
+    // Encoding and writing the image is done on the thread pool
+    QtConcurrent::run([directory = mCacheDirectory, path, image] {
+        QDir().mkpath(directory);
+
+        QSaveFile file(path);
+        if (file.open(QIODevice::WriteOnly) && image.save(&file, "png"))
+            file.commit();
+    });
+}
+
+void ThumbnailCache::generateNextThumbnail()
+{
+    if (mPendingFiles.isEmpty())
+        return;
+
+    const QString fileName = mPendingFiles.takeFirst();
+    QImage image;
+
+    if (std::unique_ptr<Map> map = readMap(fileName, nullptr)) {
+        image = storeThumbnail(fileName, *map);
+    } else if (SharedTileset tileset = readTileset(fileName)) {
+        if (!tileset->image().isNull()) {
+            const QSize size = tileset->image().size().boundedTo(QSize(ThumbnailSize, ThumbnailSize));
+            image = tileset->image().toImage().scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            storeThumbnail(fileName, image);
+        }
+    }
+
+    if (image.isNull())
+        mFailedFiles.insert(fileName);
+    else
+        emit thumbnailReady(fileName);
+
+    if (!mPendingFiles.isEmpty())
+        mGenerateTimer.start(0);
+}
+
+} // namespace Tiled
+
+#include "moc_thumbnailcache.cpp"
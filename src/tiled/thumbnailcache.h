@@ -0,0 +1,73 @@
+/*
+ * thumbnailcache.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+namespace Tiled {
+
+class Map;
+
+/**
+ * Keeps thumbnails of maps and tilesets on disk, so that they don't need to
+ * be loaded again just to show a preview.
+ *
+ * Thumbnails are keyed by the path, modification time and size of the file.
+ * Changes to tilesets or images used by a map don't invalidate its thumbnail.
+ */
+class ThumbnailCache : public QObject
+{
+    Q_OBJECT
+
+    ThumbnailCache(QObject *parent = nullptr);
+
+public:
+    enum { ThumbnailSize = 256 };
+
+    static ThumbnailCache &instance();
+
+    QString cachedThumbnailPath(const QString &fileName) const;
+    QImage thumbnail(const QString &fileName) const;
+
+    void requestThumbnail(const QString &fileName);
+    QImage storeThumbnail(const QString &fileName, const Map &map);
+
+    static QImage renderThumbnail(const Map &map);
+
+signals:
+    void thumbnailReady(const QString &fileName);
+
+private:
+    QString thumbnailPath(const QString &fileName) const;
+    void storeThumbnail(const QString &fileName, const QImage &image);
+    void generateNextThumbnail();
+
+    QString mCacheDirectory;
+    QStringList mPendingFiles;
+    QSet<QString> mFailedFiles;
+    QTimer mGenerateTimer;
+};
+
+} // namespace Tiled
@@ -103,7 +103,7 @@ QVariant FrameListModel::data(const QModelIndex &index, int role) const
     case Qt::DecorationRole: {
         int tileId = mFrames.at(index.row()).tileId;
         if (Tile *tile = mTileset->findTile(tileId))
-            return tile->image().copy(tile->imageRect());
+            return tile->croppedImage();
     }
     }
 
@@ -661,7 +661,7 @@ bool TileAnimationEditor::updatePreviewPixmap()
     const Frame frame = frames.at(mPreviewFrameIndex);
 
     if (Tile *tile = tileset->findTile(frame.tileId)) {
-        const QPixmap image = tile->image().copy(tile->imageRect());
+        const QPixmap image = tile->croppedImage();
         const qreal scale = mUi->tilesetView->zoomable()->scale();
 
         const int w = qRound(image.width() * scale);
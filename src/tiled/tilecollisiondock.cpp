@@ -253,7 +253,7 @@ void TileCollisionDock::autoDetectMask()
     if (!mDummyMapDocument)
         return;
 
-    const QPixmap pixmap = mTile->image().copy(mTile->imageRect());
+    const QPixmap pixmap = mTile->croppedImage();
     const QRect content = pixmap.hasAlphaChannel() ? QRegion(pixmap.mask()).boundingRect()
                                                    : pixmap.rect();
 
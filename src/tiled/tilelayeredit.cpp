@@ -22,6 +22,12 @@
 
 #include "editabletile.h"
 #include "editabletilelayer.h"
+#include "gidmapper.h"
+#include "scriptmanager.h"
+
+#include <QCoreApplication>
+
+#include <cstring>
 
 namespace Tiled {
 
@@ -54,6 +60,101 @@ void TileLayerEdit::setTile(int x, int y, EditableTile *tile, int flags)
     mChanges.setCell(x, y, cell);
 }
 
+/**
+ * Reads 32-bit unsigned integers from \a value, which can be an ArrayBuffer,
+ * a typed array or a regular array of numbers.
+ */
+static QVector<unsigned> toUnsignedVector(const QJSValue &value)
+{
+    QVector<unsigned> result;
+
+    if (value.isArray()) {
+        const int length = value.property(QStringLiteral("length")).toInt();
+        result.resize(length);
+        for (int i = 0; i < length; ++i)
+            result[i] = value.property(i).toUInt();
+        return result;
+    }
+
+    QJSValue buffer = value;
+    int byteOffset = 0;
+    int byteLength = -1;
+
+    // Typed arrays are a view on an ArrayBuffer
+    if (value.hasProperty(QStringLiteral("buffer"))) {
+        buffer = value.property(QStringLiteral("buffer"));
+        byteOffset = value.property(QStringLiteral("byteOffset")).toInt();
+        byteLength = value.property(QStringLiteral("byteLength")).toInt();
+    }
+
+    const QVariant variant = buffer.toVariant();
+    if (variant.userType() != QMetaType::QByteArray)
+        return result;
+
+    const QByteArray data = variant.toByteArray().mid(byteOffset, byteLength);
+    result.resize(data.size() / int(sizeof(unsigned)));
+    std::memcpy(result.data(), data.constData(), result.size() * sizeof(unsigned));
+    return result;
+}
+
+/**
+ * Sets the cells in \a rect to the given global tile IDs, which are given
+ * row by row and refer to the tilesets of the map the target layer is part
+ * of.
+ */
+void TileLayerEdit::setGids(QRect rect, const QJSValue &gids)
+{
+    const Map *map = mTargetLayer->tileLayer()->map();
+    if (!map) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Layer not part of a map"));
+        return;
+    }
+
+    if (rect.isEmpty())
+        return;
+
+    const QVector<unsigned> values = toUnsignedVector(gids);
+    if (qint64(values.size()) != qint64(rect.width()) * rect.height()) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Number of tile IDs doesn't match the size of the area"));
+        return;
+    }
+
+    // Reject unknown tile IDs up front, since GidMapper::gidsToCells would
+    // otherwise extend the last tileset to make room for them
+    const unsigned flagMask = 0xF0000000;
+    unsigned endGid = 1;
+    for (const SharedTileset &tileset : map->tilesets())
+        endGid += tileset->nextTileId();
+
+    for (unsigned gid : values) {
+        if ((gid & ~flagMask) >= endGid) {
+            ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Invalid tile ID: %1").arg(gid & ~flagMask));
+            return;
+        }
+    }
+
+    const GidMapper gidMapper(map->tilesets());
+
+    QVector<Cell> cells(values.size());
+    gidMapper.gidsToCells(values.constData(), values.size(), cells.data());
+
+    for (int i = 0; i < cells.size(); ++i) {
+        if (!cells.at(i).isEmpty() && !cells.at(i).tile()) {
+            ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Invalid tile ID: %1").arg(values.at(i) & ~flagMask));
+            return;
+        }
+    }
+
+    const Cell *cell = cells.constData();
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        for (int x = rect.left(); x <= rect.right(); ++x, ++cell) {
+            Cell changed = *cell;
+            changed.setChecked(true);  // Used to find painted region later (allows erasing)
+            mChanges.setCell(x, y, changed);
+        }
+    }
+}
+
 void TileLayerEdit::apply()
 {
     // Applying an edit automatically makes it mergeable, so that further
@@ -23,6 +23,7 @@
 #include "editabletile.h"
 #include "tilelayer.h"
 
+#include <QJSValue>
 #include <QObject>
 
 namespace Tiled {
@@ -54,6 +55,7 @@ public:
 
 public slots:
     void setTile(int x, int y, EditableTile *tile, int flags = 0);
+    void setGids(QRect rect, const QJSValue &gids);
     void apply();
 
 private:
@@ -0,0 +1,622 @@
+/*
+ * tilelayerglrenderer.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tilelayerglrenderer.h"
+
+#ifndef QT_NO_OPENGL
+
+#include "map.h"
+#include "maprenderer.h"
+#include "tile.h"
+#include "tilelayer.h"
+
+// Needed to avoid include issue when compiling with mingw_900
+#if defined(Q_OS_WIN) && QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#undef min
+#undef max
+
+#include <QDebug>
+#include <QMatrix4x4>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLWidget>
+#include <QPainter>
+#include <QPaintEngine>
+#include <QtMath>
+
+#include <cmath>
+
+using namespace Tiled;
+
+namespace {
+
+/**
+ * The width and height of a block, in cells.
+ */
+constexpr int BlockSize = 64;
+
+enum AttributeLocation {
+    VertexLocation,
+    PositionLocation,
+    SourceLocation,
+    TransformLocation,
+};
+
+/**
+ * The per-instance data, derived from QPainter::PixmapFragment.
+ */
+struct Instance
+{
+    float x, y;
+    float sourceLeft, sourceTop, width, height;
+    float scaleX, scaleY, rotation;
+};
+
+const char vertexShaderSource[] = R"(
+in vec2 vertex;
+in vec2 position;
+in vec4 source;
+in vec3 transform;
+
+uniform mat4 matrix;
+uniform vec2 textureSize;
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 p = vertex * source.zw * transform.xy;
+    float c = cos(transform.z);
+    float s = sin(transform.z);
+    p = vec2(p.x * c - p.y * s, p.x * s + p.y * c);
+
+    gl_Position = matrix * vec4(position + p, 0.0, 1.0);
+    texCoord = (source.xy + (vertex + 0.5) * source.zw) / textureSize;
+}
+)";
+
+const char fragmentShaderSource[] = R"(
+in vec2 texCoord;
+
+uniform sampler2D tex;
+uniform vec4 tint;
+uniform float opacity;
+
+out vec4 fragColor;
+
+void main()
+{
+    vec4 color = texture(tex, texCoord);
+    fragColor = vec4(color.rgb * tint.rgb, color.a) * (tint.a * opacity);
+}
+)";
+
+qint64 blockKey(QPoint index)
+{
+    return (qint64(index.x()) << 32) | quint32(index.y());
+}
+
+QPoint blockIndex(qint64 key)
+{
+    return QPoint(int(key >> 32), int(quint32(key)));
+}
+
+int floorDiv(int value, int divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+QSize cellSize(const Cell &cell, QSize tileSize)
+{
+    if (cell.tileset()->tileRenderSize() == Tileset::TileSize)
+        if (const Tile *tile = cell.tile())
+            return tile->size();
+    return tileSize;
+}
+
+} // anonymous namespace
+
+TileLayerGLRenderer::TileLayerGLRenderer(const TileLayer *layer)
+    : mLayer(layer)
+{
+}
+
+TileLayerGLRenderer::~TileLayerGLRenderer()
+{
+    if (mWidget && mContext) {
+        mWidget->makeCurrent();
+        releaseResources();
+        mWidget->doneCurrent();
+    } else {
+        forgetResources();
+    }
+}
+
+/**
+ * Returns whether the given \a painter paints on an OpenGL context that
+ * supports instanced drawing.
+ */
+bool TileLayerGLRenderer::isSupported(QPainter *painter)
+{
+    const QPaintEngine *engine = painter->paintEngine();
+    if (!engine || engine->type() != QPaintEngine::OpenGL2)
+        return false;
+    if (!dynamic_cast<QOpenGLWidget*>(painter->device()))
+        return false;
+
+    const QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context)
+        return false;
+
+    const QSurfaceFormat format = context->format();
+    const auto version = qMakePair(format.majorVersion(), format.minorVersion());
+    if (context->isOpenGLES())
+        return version >= qMakePair(3, 0);
+    return version >= qMakePair(3, 3);
+}
+
+/**
+ * Returns whether the layer can currently be rendered by this renderer.
+ */
+bool TileLayerGLRenderer::canRender(const MapRenderer *renderer) const
+{
+    const Map *map = renderer->map();
+    if (map->orientation() != Map::Orthogonal)
+        return false;
+    if (renderer->testFlag(ShowTileCollisionShapes))
+        return false;
+
+    // Tiles extending beyond their cell would need to be drawn in order
+    const QMargins margins = mLayer->drawMargins();
+    return margins.left() <= 0 &&
+            margins.top() <= map->tileHeight() &&
+            margins.right() <= map->tileWidth() &&
+            margins.bottom() <= 0;
+}
+
+/**
+ * Renders the cells within the \a exposed rectangle, rebuilding any blocks
+ * that have changed along the way.
+ */
+void TileLayerGLRenderer::render(QPainter *painter,
+                                 const MapRenderer *renderer,
+                                 const QRectF &exposed)
+{
+    const QSize tileSize = renderer->map()->tileSize();
+    if (tileSize.isEmpty())
+        return;
+
+    if (tileSize != mTileSize) {
+        mTileSize = tileSize;
+        invalidate();
+    }
+
+    // Determine the visible blocks
+    const QRect layerBounds = mLayer->localBounds();
+    const QPoint position = mLayer->position();
+    QRect exposedCells(QPoint(int(std::floor(exposed.left() / tileSize.width())),
+                              int(std::floor(exposed.top() / tileSize.height()))),
+                       QPoint(int(std::ceil(exposed.right() / tileSize.width())),
+                              int(std::ceil(exposed.bottom() / tileSize.height()))));
+    exposedCells.translate(-position);
+    exposedCells &= layerBounds;
+    if (exposedCells.isEmpty())
+        return;
+
+    const int firstBlockX = floorDiv(exposedCells.left(), BlockSize);
+    const int firstBlockY = floorDiv(exposedCells.top(), BlockSize);
+    const int lastBlockX = floorDiv(exposedCells.right(), BlockSize);
+    const int lastBlockY = floorDiv(exposedCells.bottom(), BlockSize);
+
+    painter->beginNativePainting();
+
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!initialize(context)) {
+        painter->endNativePainting();
+        return;
+    }
+
+    mWidget = dynamic_cast<QOpenGLWidget*>(painter->device());
+
+    if (mReset) {
+        releaseResources();
+        mReset = false;
+    }
+
+    for (int y = firstBlockY; y <= lastBlockY; ++y) {
+        for (int x = firstBlockX; x <= lastBlockX; ++x) {
+            const QPoint index(x, y);
+            Block &block = mBlocks[blockKey(index)];
+            if (block.dirty)
+                buildBlock(block, index, renderer);
+        }
+    }
+
+    // Collected separately, since inserting may move the blocks
+    QVector<const Block*> visibleBlocks;
+    for (int y = firstBlockY; y <= lastBlockY; ++y)
+        for (int x = firstBlockX; x <= lastBlockX; ++x)
+            visibleBlocks.append(&mBlocks.constFind(blockKey(QPoint(x, y))).value());
+
+    QOpenGLExtraFunctions *f = context->extraFunctions();
+
+    const QPaintDevice *device = painter->device();
+    const qreal dpr = device->devicePixelRatioF();
+    const int framebufferWidth = qRound(device->width() * dpr);
+    const int framebufferHeight = qRound(device->height() * dpr);
+
+    QMatrix4x4 projection;
+    projection.ortho(0, device->width(), device->height(), 0, -1, 1);
+    const QMatrix4x4 matrix = projection * QMatrix4x4(painter->combinedTransform());
+
+    QColor tintColor = mLayer->effectiveTintColor();
+    if (!tintColor.isValid())
+        tintColor = Qt::white;
+
+    f->glViewport(0, 0, framebufferWidth, framebufferHeight);
+    f->glDisable(GL_DEPTH_TEST);
+    f->glDisable(GL_STENCIL_TEST);
+    f->glEnable(GL_BLEND);
+    f->glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Respect the clip set up by the graphics view
+    if (painter->hasClipping()) {
+        const QRect clip = painter->combinedTransform()
+                .mapRect(painter->clipBoundingRect()).toAlignedRect();
+        f->glEnable(GL_SCISSOR_TEST);
+        f->glScissor(qFloor(clip.x() * dpr),
+                     qFloor(framebufferHeight - (clip.y() + clip.height()) * dpr),
+                     qCeil(clip.width() * dpr),
+                     qCeil(clip.height() * dpr));
+    } else {
+        f->glDisable(GL_SCISSOR_TEST);
+    }
+
+    mProgram->bind();
+    mProgram->setUniformValue("matrix", matrix);
+    mProgram->setUniformValue("tex", 0);
+    mProgram->setUniformValue("tint", tintColor);
+    mProgram->setUniformValue("opacity", GLfloat(painter->opacity()));
+
+    QOpenGLVertexArrayObject::Binder vertexArrayBinder(mVertexArray.get());
+
+    f->glBindBuffer(GL_ARRAY_BUFFER, mQuadBuffer);
+    f->glEnableVertexAttribArray(VertexLocation);
+    f->glVertexAttribPointer(VertexLocation, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    f->glEnableVertexAttribArray(PositionLocation);
+    f->glEnableVertexAttribArray(SourceLocation);
+    f->glEnableVertexAttribArray(TransformLocation);
+    f->glVertexAttribDivisor(PositionLocation, 1);
+    f->glVertexAttribDivisor(SourceLocation, 1);
+    f->glVertexAttribDivisor(TransformLocation, 1);
+
+    const GLint filter = painter->testRenderHint(QPainter::SmoothPixmapTransform) ? GL_LINEAR : GL_NEAREST;
+    f->glActiveTexture(GL_TEXTURE0);
+
+    for (const Block *block : std::as_const(visibleBlocks)) {
+        for (const Batch &batch : block->batches) {
+            const Texture *tex = texture(batch.pixmap);
+            if (!tex)
+                continue;
+
+            f->glBindTexture(GL_TEXTURE_2D, tex->id);
+            f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+            f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+            mProgram->setUniformValue("textureSize", QSizeF(tex->size));
+
+            f->glBindBuffer(GL_ARRAY_BUFFER, batch.buffer);
+            f->glVertexAttribPointer(PositionLocation, 2, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                                     reinterpret_cast<const void*>(offsetof(Instance, x)));
+            f->glVertexAttribPointer(SourceLocation, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                                     reinterpret_cast<const void*>(offsetof(Instance, sourceLeft)));
+            f->glVertexAttribPointer(TransformLocation, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                                     reinterpret_cast<const void*>(offsetof(Instance, scaleX)));
+
+            f->glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, batch.count);
+        }
+    }
+
+    f->glVertexAttribDivisor(PositionLocation, 0);
+    f->glVertexAttribDivisor(SourceLocation, 0);
+    f->glVertexAttribDivisor(TransformLocation, 0);
+    f->glDisableVertexAttribArray(VertexLocation);
+    f->glDisableVertexAttribArray(PositionLocation);
+    f->glDisableVertexAttribArray(SourceLocation);
+    f->glDisableVertexAttribArray(TransformLocation);
+    f->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+    f->glDisable(GL_SCISSOR_TEST);
+
+    vertexArrayBinder.release();
+    mProgram->release();
+
+    painter->endNativePainting();
+
+    renderFallbackCells(painter, renderer, visibleBlocks);
+}
+
+/**
+ * Marks all blocks as changed. Their resources are released the next time
+ * the layer is rendered, since this requires the context to be current.
+ */
+void TileLayerGLRenderer::invalidate()
+{
+    mReset = true;
+}
+
+/**
+ * Marks the blocks intersecting the given \a rect (in pixels) as changed.
+ */
+void TileLayerGLRenderer::invalidate(const QRectF &rect)
+{
+    if (mTileSize.isEmpty() || rect.isEmpty())
+        return;
+
+    QRect cells(QPoint(int(std::floor(rect.left() / mTileSize.width())),
+                       int(std::floor(rect.top() / mTileSize.height()))),
+                QPoint(int(std::ceil(rect.right() / mTileSize.width())),
+                       int(std::ceil(rect.bottom() / mTileSize.height()))));
+    cells.translate(-mLayer->position());
+
+    const int firstBlockX = floorDiv(cells.left(), BlockSize);
+    const int firstBlockY = floorDiv(cells.top(), BlockSize);
+    const int lastBlockX = floorDiv(cells.right(), BlockSize);
+    const int lastBlockY = floorDiv(cells.bottom(), BlockSize);
+
+    for (auto it = mBlocks.begin(); it != mBlocks.end(); ++it) {
+        const QPoint index = blockIndex(it.key());
+        if (index.x() >= firstBlockX && index.x() <= lastBlockX &&
+                index.y() >= firstBlockY && index.y() <= lastBlockY)
+            it.value().dirty = true;
+    }
+}
+
+bool TileLayerGLRenderer::initialize(QOpenGLContext *context)
+{
+    if (mContext == context && mProgram)
+        return true;
+
+    // A different context can't use our resources. The old context is
+    // usually gone, taking the resources along with it.
+    forgetResources();
+    mContext = context;
+
+    const QByteArray header = context->isOpenGLES() ? QByteArrayLiteral("#version 300 es\nprecision highp float;\n")
+                                                    : QByteArrayLiteral("#version 330\n");
+
+    auto program = std::make_unique<QOpenGLShaderProgram>();
+    program->addShaderFromSourceCode(QOpenGLShader::Vertex, header + vertexShaderSource);
+    program->addShaderFromSourceCode(QOpenGLShader::Fragment, header + fragmentShaderSource);
+    program->bindAttributeLocation("vertex", VertexLocation);
+    program->bindAttributeLocation("position", PositionLocation);
+    program->bindAttributeLocation("source", SourceLocation);
+    program->bindAttributeLocation("transform", TransformLocation);
+    if (!program->link()) {
+        qWarning() << "TileLayerGLRenderer: Failed to link shader program:" << program->log();
+        return false;
+    }
+    mProgram = std::move(program);
+
+    // Needed for core profile contexts, otherwise optional
+    mVertexArray = std::make_unique<QOpenGLVertexArrayObject>();
+    mVertexArray->create();
+
+    static const GLfloat quad[] = {
+        -0.5f, -0.5f,
+         0.5f, -0.5f,
+        -0.5f,  0.5f,
+         0.5f,  0.5f,
+    };
+
+    QOpenGLExtraFunctions *f = context->extraFunctions();
+    f->glGenBuffers(1, &mQuadBuffer);
+    f->glBindBuffer(GL_ARRAY_BUFFER, mQuadBuffer);
+    f->glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    f->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    f->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &mMaxTextureSize);
+
+    return true;
+}
+
+/**
+ * Deletes the blocks and textures. Requires the context to be current.
+ */
+void TileLayerGLRenderer::releaseResources()
+{
+    if (!mContext) {
+        forgetResources();
+        return;
+    }
+
+    QOpenGLExtraFunctions *f = mContext->extraFunctions();
+
+    for (Block &block : mBlocks)
+        releaseBlock(block);
+    for (const Texture &texture : std::as_const(mTextures))
+        f->glDeleteTextures(1, &texture.id);
+
+    mBlocks.clear();
+    mTextures.clear();
+}
+
+/**
+ * Drops all resources without deleting them, for when their context is no
+ * longer available.
+ */
+void TileLayerGLRenderer::forgetResources()
+{
+    mBlocks.clear();
+    mTextures.clear();
+    mProgram.reset();
+    mVertexArray.reset();
+    mQuadBuffer = 0;
+}
+
+void TileLayerGLRenderer::releaseBlock(Block &block)
+{
+    QOpenGLExtraFunctions *f = mContext->extraFunctions();
+    for (const Batch &batch : std::as_const(block.batches))
+        f->glDeleteBuffers(1, &batch.buffer);
+
+    block.batches.clear();
+    block.fallbackCells.clear();
+}
+
+/**
+ * Collects the instance data for the cells in the block at \a index,
+ * grouped by the image they use, and uploads it.
+ */
+void TileLayerGLRenderer::buildBlock(Block &block, QPoint index, const MapRenderer *renderer)
+{
+    releaseBlock(block);
+    block.dirty = false;
+
+    const QRect rect = QRect(index * BlockSize, QSize(BlockSize, BlockSize)) & mLayer->localBounds();
+    const QPoint position = mLayer->position();
+
+    QHash<qint64, int> batchIndexes;
+    QVector<QVector<Instance>> instances;
+
+    mLayer->forEachSpan(rect, [&] (int startX, int y, const Cell *cells, int count) {
+        for (int i = 0; i < count; ++i) {
+            const Cell &cell = cells[i];
+            if (cell.isEmpty())
+                continue;
+
+            const QPoint cellPos(startX + i, y);
+            const Tile *tile = cell.tile();
+
+            // Cells without image, or with an image that is too large for
+            // a texture, are drawn with a QPainter instead
+            if (!tile || tile->image().isNull() ||
+                    tile->image().width() > mMaxTextureSize ||
+                    tile->image().height() > mMaxTextureSize) {
+                block.fallbackCells.append(cellPos);
+                continue;
+            }
+
+            if (tile->imageRect().isEmpty())
+                continue;
+
+            const QPoint tilePos = cellPos + position;
+            const QPointF screenPos(tilePos.x() * mTileSize.width(),
+                                    (tilePos.y() + 1) * mTileSize.height());
+
+            const QPainter::PixmapFragment fragment =
+                    CellRenderer::fragmentForCell(renderer, cell, tile, screenPos,
+                                                  cellSize(cell, mTileSize),
+                                                  CellRenderer::BottomLeft);
+
+            const QPixmap &image = tile->image();
+            auto batchIndex = batchIndexes.constFind(image.cacheKey());
+            if (batchIndex == batchIndexes.constEnd()) {
+                batchIndex = batchIndexes.insert(image.cacheKey(), block.batches.size());
+                block.batches.append(Batch { image, 0, 0 });
+                instances.append(QVector<Instance>());
+            }
+
+            instances[*batchIndex].append(Instance {
+                float(fragment.x), float(fragment.y),
+                float(fragment.sourceLeft), float(fragment.sourceTop),
+                float(fragment.width), float(fragment.height),
+                float(fragment.scaleX), float(fragment.scaleY),
+                float(qDegreesToRadians(fragment.rotation))
+            });
+        }
+    });
+
+    QOpenGLExtraFunctions *f = mContext->extraFunctions();
+
+    for (int i = 0; i < block.batches.size(); ++i) {
+        Batch &batch = block.batches[i];
+        const QVector<Instance> &batchInstances = instances.at(i);
+
+        batch.count = batchInstances.size();
+        f->glGenBuffers(1, &batch.buffer);
+        f->glBindBuffer(GL_ARRAY_BUFFER, batch.buffer);
+        f->glBufferData(GL_ARRAY_BUFFER,
+                        batchInstances.size() * sizeof(Instance),
+                        batchInstances.constData(),
+                        GL_STATIC_DRAW);
+    }
+
+    f->glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/**
+ * Returns the texture for the given \a pixmap, uploading it when needed.
+ */
+const TileLayerGLRenderer::Texture *TileLayerGLRenderer::texture(const QPixmap &pixmap)
+{
+    auto it = mTextures.constFind(pixmap.cacheKey());
+    if (it != mTextures.constEnd())
+        return &it.value();
+
+    const QImage image = pixmap.toImage().convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+    if (image.isNull())
+        return nullptr;
+
+    QOpenGLExtraFunctions *f = mContext->extraFunctions();
+
+    Texture texture;
+    texture.size = image.size();
+    f->glGenTextures(1, &texture.id);
+    f->glBindTexture(GL_TEXTURE_2D, texture.id);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    f->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width(), image.height(), 0,
+                    GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
+
+    return &mTextures.insert(pixmap.cacheKey(), texture).value();
+}
+
+/**
+ * Renders the cells that could not be drawn using OpenGL, like the markers
+ * for missing images, through the regular CellRenderer.
+ */
+void TileLayerGLRenderer::renderFallbackCells(QPainter *painter,
+                                              const MapRenderer *renderer,
+                                              const QVector<const Block*> &blocks) const
+{
+    CellRenderer cellRenderer(painter, renderer, mLayer->effectiveTintColor());
+    const QPoint position = mLayer->position();
+
+    for (const Block *block : blocks) {
+        for (const QPoint cellPos : block->fallbackCells) {
+            const Cell &cell = mLayer->cellAt(cellPos);
+            const QPoint tilePos = cellPos + position;
+            const QPointF screenPos(tilePos.x() * mTileSize.width(),
+                                    (tilePos.y() + 1) * mTileSize.height());
+
+            cellRenderer.render(cell, screenPos, cellSize(cell, mTileSize),
+                                CellRenderer::BottomLeft);
+        }
+    }
+}
+
+#endif // QT_NO_OPENGL
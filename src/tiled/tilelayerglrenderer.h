@@ -0,0 +1,118 @@
+/*
+ * tilelayerglrenderer.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifndef QT_NO_OPENGL
+
+#include <QHash>
+#include <QPixmap>
+#include <QPointer>
+#include <QRectF>
+#include <QSize>
+#include <QVector>
+
+#include <memory>
+
+class QOpenGLContext;
+class QOpenGLShaderProgram;
+class QOpenGLVertexArrayObject;
+class QOpenGLWidget;
+class QPainter;
+
+namespace Tiled {
+
+class MapRenderer;
+class TileLayer;
+
+/**
+ * Renders a tile layer using OpenGL, for views that use an OpenGL viewport.
+ *
+ * The cells are divided into blocks, for each of which the instance data is
+ * uploaded to a vertex buffer once. The blocks are then drawn with one
+ * instanced draw call for each texture they use, so the cost of redrawing
+ * no longer depends on the number of visible cells.
+ *
+ * Only orthogonal maps whose tiles don't extend beyond their cell are
+ * supported, since the blocks are not drawn in the render order of the map.
+ */
+class TileLayerGLRenderer
+{
+public:
+    explicit TileLayerGLRenderer(const TileLayer *layer);
+    ~TileLayerGLRenderer();
+
+    static bool isSupported(QPainter *painter);
+    bool canRender(const MapRenderer *renderer) const;
+
+    void render(QPainter *painter, const MapRenderer *renderer,
+                const QRectF &exposed);
+
+    void invalidate();
+    void invalidate(const QRectF &rect);
+
+private:
+    struct Batch
+    {
+        QPixmap pixmap;     // keeps the image of the texture alive
+        unsigned buffer = 0;
+        int count = 0;
+    };
+
+    struct Block
+    {
+        QVector<Batch> batches;
+        QVector<QPoint> fallbackCells;
+        bool dirty = true;
+    };
+
+    struct Texture
+    {
+        unsigned id = 0;
+        QSize size;
+    };
+
+    bool initialize(QOpenGLContext *context);
+    void releaseResources();
+    void forgetResources();
+    void releaseBlock(Block &block);
+    void buildBlock(Block &block, QPoint index, const MapRenderer *renderer);
+    const Texture *texture(const QPixmap &pixmap);
+    void renderFallbackCells(QPainter *painter, const MapRenderer *renderer,
+                             const QVector<const Block*> &blocks) const;
+
+    const TileLayer *mLayer;
+
+    QPointer<QOpenGLWidget> mWidget;
+    QPointer<QOpenGLContext> mContext;
+    std::unique_ptr<QOpenGLShaderProgram> mProgram;
+    std::unique_ptr<QOpenGLVertexArrayObject> mVertexArray;
+    unsigned mQuadBuffer = 0;
+    int mMaxTextureSize = 0;
+
+    QHash<qint64, Block> mBlocks;
+    QHash<qint64, Texture> mTextures;
+    QSize mTileSize;
+    bool mReset = false;
+};
+
+} // namespace Tiled
+
+#endif // QT_NO_OPENGL
@@ -23,11 +23,132 @@
 #include "map.h"
 #include "mapdocument.h"
 #include "maprenderer.h"
+#include "paintprofiler.h"
+#include "tile.h"
+#include "tilelayerglrenderer.h"
+#include "tilelayerlod.h"
 
+#include <QCache>
+#include <QGraphicsScene>
+#include <QGraphicsView>
 #include <QStyleOptionGraphicsItem>
 
+#include <algorithm>
+#include <cmath>
+
 using namespace Tiled;
 
+namespace {
+
+/**
+ * The size of the cached tiles in device-independent pixels.
+ */
+constexpr int CacheTileSize = 256;
+
+struct CacheKey
+{
+    const TileLayerItem *item;
+    QPoint index;
+
+    bool operator==(const CacheKey &o) const
+    {
+        return item == o.item && index == o.index;
+    }
+};
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+uint qHash(const CacheKey &key, uint seed) Q_DECL_NOTHROW
+#else
+size_t qHash(const CacheKey &key, size_t seed) Q_DECL_NOTHROW
+#endif
+{
+    auto h = ::qHash(quintptr(key.item), seed);
+    h = ::qHash(key.index.x(), h);
+    h = ::qHash(key.index.y(), h);
+    return h;
+}
+
+/**
+ * Shared by all tile layers, for up to 256 MB of cached tiles (in KB).
+ */
+QCache<CacheKey, QPixmap> &tileCache()
+{
+    static QCache<CacheKey, QPixmap> cache { 256 * 1024 };
+    return cache;
+}
+
+qsizetype cost(const QPixmap &pixmap)
+{
+    return qMax<qsizetype>(1, qsizetype(pixmap.width()) * pixmap.height() * pixmap.depth() / (8 * 1024));
+}
+
+/**
+ * Adds the parts of \a region falling within each chunk to the bounding
+ * boxes in \a chunkBounds.
+ */
+void addChunkBounds(QHash<QPoint, QRect> &chunkBounds, const QRegion &region)
+{
+    for (const QRect &rect : region) {
+        const int startX = rect.left() >> CHUNK_BITS;
+        const int startY = rect.top() >> CHUNK_BITS;
+        const int endX = rect.right() >> CHUNK_BITS;
+        const int endY = rect.bottom() >> CHUNK_BITS;
+
+        for (int y = startY; y <= endY; ++y) {
+            for (int x = startX; x <= endX; ++x) {
+                const QRect chunkRect(x << CHUNK_BITS, y << CHUNK_BITS, CHUNK_SIZE, CHUNK_SIZE);
+                QRect &bounds = chunkBounds[QPoint(x, y)];
+                bounds |= rect & chunkRect;
+            }
+        }
+    }
+}
+
+/**
+ * Merges the bounding boxes of horizontally adjacent chunks, returning
+ * one rectangle for each run of chunks.
+ */
+QVector<QRect> chunkRunBounds(const QHash<QPoint, QRect> &chunkBounds)
+{
+    QVector<QPoint> chunks;
+    chunks.reserve(chunkBounds.size());
+    for (auto it = chunkBounds.cbegin(), it_end = chunkBounds.cend(); it != it_end; ++it)
+        chunks.append(it.key());
+
+    std::sort(chunks.begin(), chunks.end(), [] (QPoint a, QPoint b) {
+        return a.y() < b.y() || (a.y() == b.y() && a.x() < b.x());
+    });
+
+    QVector<QRect> runs;
+    QPoint previous;
+
+    for (const QPoint &chunk : std::as_const(chunks)) {
+        const QRect &bounds = chunkBounds.value(chunk);
+
+        if (!runs.isEmpty() && chunk.y() == previous.y() && chunk.x() == previous.x() + 1)
+            runs.last() |= bounds;
+        else
+            runs.append(bounds);
+
+        previous = chunk;
+    }
+
+    return runs;
+}
+
+} // anonymous namespace
+
+bool TileLayerItem::CacheParameters::operator==(const CacheParameters &o) const
+{
+    return renderer == o.renderer &&
+            flags == o.flags &&
+            scale == o.scale &&
+            devicePixelRatio == o.devicePixelRatio &&
+            objectLineWidth == o.objectLineWidth &&
+            renderHints == o.renderHints &&
+            tintColor == o.tintColor;
+}
+
 TileLayerItem::TileLayerItem(TileLayer *layer, MapDocument *mapDocument, QGraphicsItem *parent)
     : LayerItem(layer, parent)
     , mMapDocument(mapDocument)
@@ -37,6 +158,11 @@ TileLayerItem::TileLayerItem(TileLayer *layer, MapDocument *mapDocument, QGraphi
     syncWithTileLayer();
 }
 
+TileLayerItem::~TileLayerItem()
+{
+    clearCache();
+}
+
 void TileLayerItem::syncWithTileLayer()
 {
     prepareGeometryChange();
@@ -55,6 +181,170 @@ void TileLayerItem::syncWithTileLayer()
     }
 
     mBoundingRect = boundingRect.marginsAdded(margins);
+
+    // Tileset changes and map changes also end up here
+    invalidate();
+}
+
+/**
+ * Discards the cached rendering of the whole layer and schedules a repaint.
+ */
+void TileLayerItem::invalidate()
+{
+    clearCache();
+#ifndef QT_NO_OPENGL
+    if (mGLRenderer)
+        mGLRenderer->invalidate();
+#endif
+    if (mLod)
+        mLod->invalidate();
+    mPendingChunkBounds.clear();
+    mAnimatedTilesDirty = true;
+    update();
+}
+
+/**
+ * Discards the cached rendering of the given \a region (in map coordinates)
+ * and schedules a repaint of the affected area.
+ *
+ * Complex changes can produce regions made up of thousands of rectangles.
+ * These are reduced to the bounding boxes of the changes within each run of
+ * chunks, and the cached rendering is only discarded right before painting,
+ * so that all changes made in between are handled at once.
+ */
+void TileLayerItem::invalidate(const QRegion &region)
+{
+    if (region.isEmpty())
+        return;
+
+    QHash<QPoint, QRect> chunkBounds;
+    addChunkBounds(chunkBounds, region);
+
+    const MapRenderer *renderer = mMapDocument->renderer();
+    const QMargins margins = mMapDocument->map()->drawMargins();
+
+    for (const QRect &rect : chunkRunBounds(chunkBounds))
+        update(renderer->boundingRect(rect).marginsAdded(margins));
+
+    if (mPendingChunkBounds.isEmpty()) {
+        mPendingChunkBounds.swap(chunkBounds);
+    } else {
+        for (auto it = chunkBounds.cbegin(), it_end = chunkBounds.cend(); it != it_end; ++it)
+            mPendingChunkBounds[it.key()] |= it.value();
+    }
+
+    // The changed cells may use animated tiles
+    mAnimatedTilesDirty = true;
+}
+
+/**
+ * Discards the cached rendering after the frames of animated tiles have
+ * changed, and schedules a repaint.
+ *
+ * The level of detail images are kept, since animations aren't noticeable
+ * when that far zoomed out.
+ */
+void TileLayerItem::invalidateAnimations()
+{
+    clearCache();
+#ifndef QT_NO_OPENGL
+    if (mGLRenderer)
+        mGLRenderer->invalidate();
+#endif
+    update();
+}
+
+/**
+ * Schedules a repaint of the cells showing any of the tiles with the given
+ * \a tileIds from the given \a tileset, after their animation has advanced
+ * to another frame. Only the cells visible in any of the views are checked,
+ * so off-screen parts of the layer cost nothing.
+ *
+ * Layers showing animated tiles are neither cached nor drawn using OpenGL,
+ * so there is nothing to invalidate.
+ */
+void TileLayerItem::repaintAnimatedTiles(Tileset *tileset, const QSet<int> &tileIds)
+{
+    const MapRenderer *renderer = mMapDocument->renderer();
+    if (!isVisible() || !scene() || !renderer->testFlag(ShowTileAnimations))
+        return;
+
+    const TileLayer *layer = tileLayer();
+    const QMargins margins = mMapDocument->map()->drawMargins();
+
+    const auto views = scene()->views();
+    for (QGraphicsView *view : views) {
+        const QRectF visibleRect = view->mapToScene(view->viewport()->rect()).boundingRect();
+        const QRectF exposed = mapRectFromScene(visibleRect) & mBoundingRect;
+        if (exposed.isEmpty())
+            continue;
+
+        renderer->drawTileLayer([&] (QPoint tilePos, const QPointF &) {
+            const Cell &cell = layer->cellAt(tilePos - layer->position());
+            if (cell.tileset() == tileset && tileIds.contains(cell.tileId()))
+                update(renderer->boundingRect(QRect(tilePos, QSize(1, 1))).marginsAdded(margins));
+        }, exposed.marginsAdded(margins));
+    }
+}
+
+/**
+ * Discards the cached rendering of the given \a rects (in item coordinates).
+ */
+void TileLayerItem::invalidateRects(const QVector<QRectF> &rects)
+{
+    if (mCacheParameters.scale > 0) {
+        const qreal tileSpan = CacheTileSize / mCacheParameters.scale;
+        auto &cache = tileCache();
+        const auto keys = cache.keys();
+        for (const CacheKey &key : keys) {
+            if (key.item != this)
+                continue;
+
+            const QRectF tileRect(key.index.x() * tileSpan, key.index.y() * tileSpan,
+                                  tileSpan, tileSpan);
+            const bool changed = std::any_of(rects.begin(), rects.end(), [&] (const QRectF &rect) {
+                return tileRect.intersects(rect);
+            });
+            if (changed)
+                cache.remove(key);
+        }
+    }
+
+#ifndef QT_NO_OPENGL
+    if (mGLRenderer)
+        for (const QRectF &rect : rects)
+            mGLRenderer->invalidate(rect);
+#endif
+}
+
+/**
+ * Discards the cached rendering of the areas changed since the layer was
+ * last painted.
+ */
+void TileLayerItem::flushPendingInvalidation()
+{
+    if (mPendingChunkBounds.isEmpty())
+        return;
+
+    const QVector<QRect> runs = chunkRunBounds(mPendingChunkBounds);
+    mPendingChunkBounds.clear();
+
+    const MapRenderer *renderer = mMapDocument->renderer();
+    const QMargins margins = mMapDocument->map()->drawMargins();
+
+    QVector<QRectF> rects;
+    QRegion region;
+    rects.reserve(runs.size());
+
+    for (const QRect &run : runs) {
+        rects.append(QRectF(renderer->boundingRect(run).marginsAdded(margins)));
+        region += run;
+    }
+
+    invalidateRects(rects);
+
+    if (mLod)
+        mLod->invalidate(region);
 }
 
 QRectF TileLayerItem::boundingRect() const
@@ -66,7 +356,149 @@ void TileLayerItem::paint(QPainter *painter,
                           const QStyleOptionGraphicsItem *option,
                           QWidget *)
 {
+    const LayerPaintScope paintScope(tileLayer());
+
+    flushPendingInvalidation();
+
     MapRenderer *renderer = mMapDocument->renderer();
-    // TODO: Display a border around the layer when selected
-    renderer->drawTileLayer(painter, tileLayer(), option->exposedRect);
+    const bool animated = renderer->testFlag(ShowTileAnimations) && hasAnimatedTiles();
+
+#ifndef QT_NO_OPENGL
+    // Use hardware rendering when drawing on an OpenGL viewport
+    if (!animated && TileLayerGLRenderer::isSupported(painter)) {
+        if (!mGLRenderer)
+            mGLRenderer = std::make_unique<TileLayerGLRenderer>(tileLayer());
+
+        if (mGLRenderer->canRender(renderer)) {
+            mGLRenderer->render(painter, renderer, option->exposedRect);
+            return;
+        }
+    }
+#endif
+
+    const QTransform transform = painter->transform();
+
+    // Far zoomed out, draw the layer from downsampled images of its cells
+    const qreal scale = std::sqrt(std::abs(transform.determinant()));
+    if (scale < TileLayerLod::MaximumScale) {
+        if (!mLod)
+            mLod = std::make_unique<TileLayerLod>(tileLayer());
+
+        const qreal dpr = painter->device()->devicePixelRatioF();
+        mLod->draw(painter, renderer, option->exposedRect, scale * dpr);
+        return;
+    }
+
+    // The cache is only used when the view is scaled uniformly, and not for
+    // layers with animated tiles, since those would need to be re-rendered
+    // all the time.
+    const bool useCache = transform.type() <= QTransform::TxScale &&
+            transform.m11() > 0 && transform.m11() == transform.m22() &&
+            !animated;
+
+    if (!useCache) {
+        // TODO: Display a border around the layer when selected
+        renderer->drawTileLayer(painter, tileLayer(), option->exposedRect);
+        return;
+    }
+
+    CacheParameters parameters;
+    parameters.renderer = renderer;
+    parameters.flags = renderer->flags();
+    parameters.scale = transform.m11();
+    parameters.devicePixelRatio = painter->device()->devicePixelRatioF();
+    parameters.objectLineWidth = renderer->objectLineWidth();
+    parameters.renderHints = painter->renderHints();
+    parameters.tintColor = tileLayer()->effectiveTintColor();
+
+    if (parameters != mCacheParameters) {
+        clearCache();
+        mCacheParameters = parameters;
+    }
+
+    const qreal tileSpan = CacheTileSize / parameters.scale;
+    const QRectF exposed = option->exposedRect & mBoundingRect;
+    if (exposed.isEmpty())
+        return;
+
+    const int startX = static_cast<int>(std::floor(exposed.left() / tileSpan));
+    const int startY = static_cast<int>(std::floor(exposed.top() / tileSpan));
+    const int endX = static_cast<int>(std::ceil(exposed.right() / tileSpan));
+    const int endY = static_cast<int>(std::ceil(exposed.bottom() / tileSpan));
+
+    // Cached tiles are drawn at whole pixels, to avoid resampling them
+    const QPoint origin(qRound(transform.dx()), qRound(transform.dy()));
+    auto &cache = tileCache();
+
+    painter->save();
+    painter->setTransform(QTransform());
+
+    for (int y = startY; y < endY; ++y) {
+        for (int x = startX; x < endX; ++x) {
+            const QPoint index(x, y);
+            const QPoint position = origin + index * CacheTileSize;
+
+            if (const QPixmap *cached = cache.object(CacheKey { this, index })) {
+                painter->drawPixmap(position, *cached);
+                continue;
+            }
+
+            const QPixmap pixmap = renderCacheTile(index, parameters);
+            painter->drawPixmap(position, pixmap);
+            cache.insert(CacheKey { this, index }, new QPixmap(pixmap), cost(pixmap));
+        }
+    }
+
+    painter->restore();
+}
+
+/**
+ * Returns whether this layer uses any tileset containing animated tiles.
+ */
+bool TileLayerItem::hasAnimatedTiles() const
+{
+    if (mAnimatedTilesDirty) {
+        mHasAnimatedTiles = false;
+        mAnimatedTilesDirty = false;
+
+        const auto tilesets = tileLayer()->usedTilesets();
+        for (const SharedTileset &tileset : tilesets) {
+            const auto &tiles = tileset->tiles();
+            if (std::any_of(tiles.begin(), tiles.end(), [] (const Tile *tile) { return tile->isAnimated(); })) {
+                mHasAnimatedTiles = true;
+                break;
+            }
+        }
+    }
+
+    return mHasAnimatedTiles;
+}
+
+QPixmap TileLayerItem::renderCacheTile(QPoint index, const CacheParameters &parameters) const
+{
+    const qreal dpr = parameters.devicePixelRatio;
+    const qreal tileSpan = CacheTileSize / parameters.scale;
+    const QRectF rect(index.x() * tileSpan, index.y() * tileSpan, tileSpan, tileSpan);
+
+    QPixmap pixmap(QSize(CacheTileSize, CacheTileSize) * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHints(parameters.renderHints);
+    painter.scale(parameters.scale, parameters.scale);
+    painter.translate(-rect.topLeft());
+
+    parameters.renderer->drawTileLayer(&painter, tileLayer(), rect);
+
+    return pixmap;
+}
+
+void TileLayerItem::clearCache()
+{
+    auto &cache = tileCache();
+    const auto keys = cache.keys();
+    for (const CacheKey &key : keys)
+        if (key.item == this)
+            cache.remove(key);
 }
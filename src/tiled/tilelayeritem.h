@@ -22,14 +22,32 @@
 
 #include "layeritem.h"
 
+#include "maprenderer.h"
 #include "tilelayer.h"
 
+#include <QColor>
+#include <QHash>
+#include <QPainter>
+#include <QSet>
+
+#include <memory>
+
 namespace Tiled {
 
 class MapDocument;
+class TileLayerGLRenderer;
+class TileLayerLod;
 
 /**
  * A graphics item displaying a tile layer in a QGraphicsView.
+ *
+ * The rendered layer is cached in tiles of a fixed size at the current zoom
+ * level, so that panning around doesn't require drawing each cell again.
+ * Any changes affecting the rendering of the layer need to invalidate this
+ * cache.
+ *
+ * When zoomed out far, the layer is drawn from downsampled images of blocks
+ * of cells instead (see TileLayerLod).
  */
 class TileLayerItem : public LayerItem
 {
@@ -41,6 +59,7 @@ public:
      * @param mapDocument the map document owning the map of this layer
      */
     TileLayerItem(TileLayer *layer, MapDocument *mapDocument, QGraphicsItem *parent = nullptr);
+    ~TileLayerItem() override;
 
     TileLayer *tileLayer() const;
 
@@ -54,6 +73,11 @@ public:
      */
     void syncWithTileLayer();
 
+    void invalidate();
+    void invalidate(const QRegion &region);
+    void invalidateAnimations();
+    void repaintAnimatedTiles(Tileset *tileset, const QSet<int> &tileIds);
+
     // QGraphicsItem
     QRectF boundingRect() const override;
     void paint(QPainter *painter,
@@ -61,8 +85,40 @@ public:
                QWidget *widget = nullptr) override;
 
 private:
+    struct CacheParameters
+    {
+        const MapRenderer *renderer = nullptr;
+        RenderFlags flags;
+        qreal scale = 0;
+        qreal devicePixelRatio = 0;
+        qreal objectLineWidth = 0;
+        QPainter::RenderHints renderHints;
+        QColor tintColor;
+
+        bool operator==(const CacheParameters &o) const;
+        bool operator!=(const CacheParameters &o) const { return !(*this == o); }
+    };
+
+    void invalidateRects(const QVector<QRectF> &rects);
+    void flushPendingInvalidation();
+
+    bool hasAnimatedTiles() const;
+    QPixmap renderCacheTile(QPoint index, const CacheParameters &parameters) const;
+    void clearCache();
+
     MapDocument *mMapDocument;
     QRectF mBoundingRect;
+    CacheParameters mCacheParameters;
+    mutable bool mAnimatedTilesDirty = true;
+    mutable bool mHasAnimatedTiles = false;
+    std::unique_ptr<TileLayerLod> mLod;
+
+    // Bounding boxes of the changed cells within each chunk, of which the
+    // cached rendering is discarded when the layer is next painted
+    QHash<QPoint, QRect> mPendingChunkBounds;
+#ifndef QT_NO_OPENGL
+    std::unique_ptr<TileLayerGLRenderer> mGLRenderer;
+#endif
 };
 
 inline TileLayer *TileLayerItem::tileLayer() const
@@ -23,8 +23,11 @@
 
 #include "mapdocument.h"
 #include "map.h"
+#include "tileregion.h"
 
-#include <QQueue>
+#include <QVector>
+
+#include <algorithm>
 
 using namespace Tiled;
 
@@ -186,59 +189,157 @@ void TilePainter::erase(const QRegion &region)
     emit mMapDocument->regionChanged(paintable, mTileLayer);
 }
 
-static QRegion fillRegion(const TileLayer *layer,
-                          const QRegion &region,
-                          QPoint fillOrigin,
-                          Map::Orientation orientation,
-                          Map::StaggerAxis staggerAxis,
-                          Map::StaggerIndex staggerIndex)
+// The largest area to consider for a fill, in tiles. Larger bounds are
+// reduced to an area of this size around the fill origin.
+static constexpr int MaxFillSize = 4096;
+
+namespace {
+
+/**
+ * Determines which cells of a tile layer match a given cell, computing this
+ * for a whole row at a time and keeping track of the cells that have been
+ * processed by the fill.
+ */
+class FillMatcher
+{
+public:
+    FillMatcher(const TileLayer *layer, const QRect &bounds, const Cell &matchCell)
+        : mLayer(layer)
+        , mBounds(bounds)
+        , mMatchCell(matchCell)
+        , mMatchesEmpty(matchCell == Cell::empty)
+        , mStates(bounds.width() * bounds.height())
+        , mRowLoaded(bounds.height())
+    {}
+
+    bool matches(int x, int y)
+    {
+        return state(x, y) & Matches;
+    }
+
+    bool isProcessed(int x, int y)
+    {
+        return state(x, y) & Processed;
+    }
+
+    void setProcessed(int x, int y)
+    {
+        state(x, y) |= Processed;
+    }
+
+private:
+    enum State : quint8 {
+        Matches     = 0x1,
+        Processed   = 0x2,
+    };
+
+    quint8 &state(int x, int y)
+    {
+        const int row = y - mBounds.top();
+        if (!mRowLoaded[row])
+            loadRow(y);
+        return mStates[row * mBounds.width() + x - mBounds.left()];
+    }
+
+    void loadRow(int y);
+
+    const TileLayer *mLayer;
+    const QRect mBounds;
+    const Cell mMatchCell;
+    const bool mMatchesEmpty;
+    QVector<quint8> mStates;
+    QVector<bool> mRowLoaded;
+};
+
+void FillMatcher::loadRow(int y)
+{
+    const int row = y - mBounds.top();
+    quint8 *states = mStates.data() + row * mBounds.width() - mBounds.left();
+    Cell cells[CHUNK_SIZE];
+
+    for (int x = mBounds.left(); x <= mBounds.right(); ) {
+        const int chunkEnd = std::min(mBounds.right() + 1, (x & ~CHUNK_MASK) + CHUNK_SIZE);
+        const int count = chunkEnd - x;
+        const Chunk *chunk = mLayer->findChunk(x, y);
+
+        if (!chunk) {
+            std::fill(states + x, states + chunkEnd, mMatchesEmpty ? Matches : 0);
+        } else if (chunk->isUniform()) {
+            // No need to look at each cell when they're all the same
+            const bool matches = chunk->cellAt(0, 0) == mMatchCell;
+            std::fill(states + x, states + chunkEnd, matches ? Matches : 0);
+        } else {
+            chunk->copyRow(x & CHUNK_MASK, y & CHUNK_MASK, count, cells);
+            for (int i = 0; i < count; ++i)
+                states[x + i] = cells[i] == mMatchCell ? Matches : 0;
+        }
+
+        x = chunkEnd;
+    }
+
+    mRowLoaded[row] = true;
+}
+
+} // anonymous namespace
+
+/**
+ * Computes the region of cells connected to \a fillOrigin that match the
+ * cell at the fill origin, within the bounding rectangle of \a region.
+ *
+ * Works on whole spans of cells at a time, looking up each row of cells only
+ * once.
+ */
+static TileRegion fillRegion(const TileLayer *layer,
+                             const QRegion &region,
+                             QPoint fillOrigin,
+                             Map::Orientation orientation,
+                             Map::StaggerAxis staggerAxis,
+                             Map::StaggerIndex staggerIndex)
 {
     // Return empty region when the bounds do not contain the fill origin
     if (!region.contains(fillOrigin))
-        return QRegion();
+        return TileRegion();
 
-    // Cache cell that we will match other cells against
-    const Cell matchCell = layer->cellAt(fillOrigin);
+    QRect bounds = region.boundingRect();
+    if (bounds.width() > MaxFillSize || bounds.height() > MaxFillSize) {
+        QRect limit(0, 0, MaxFillSize, MaxFillSize);
+        limit.moveCenter(fillOrigin);
+        bounds &= limit;
+    }
 
-    const QRect bounds = region.boundingRect();
-    const int width = bounds.width();
-    const int height = bounds.height();
-    const int indexOffset = -(bounds.left() + bounds.top() * width);
+    FillMatcher matcher(layer, bounds, layer->cellAt(fillOrigin));
 
     const bool isStaggered = orientation == Map::Hexagonal || orientation == Map::Staggered;
 
-    // Create a queue to hold cells that need filling
-    QQueue<QPoint> fillPositions;
-    fillPositions.enqueue(fillOrigin);
+    // Holds positions from which to continue filling
+    QVector<QPoint> fillPositions;
+    fillPositions.append(fillOrigin);
+    matcher.setProcessed(fillOrigin.x(), fillOrigin.y());
 
-    // Create an array that will store which cells have been processed
-    // This is faster than checking if a given cell is in the region/list
-    QVector<bool> processedCellsVec(width * height);
-    bool *processedCells = processedCellsVec.data();
-    QRegion fillRegion;
+    TileRegion fillRegion;
 
-    // Loop through queued positions and fill them, while at the same time
-    // checking adjacent positions to see if they should be added
+    // Loop through the positions and fill their span, while at the same time
+    // checking adjacent spans to see if they should be added
     while (!fillPositions.isEmpty()) {
-        const QPoint currentPoint = fillPositions.dequeue();
-        const int startOfLine = currentPoint.y() * width;
+        const QPoint currentPoint = fillPositions.takeLast();
+        const int y = currentPoint.y();
 
         // Seek as far left as we can
         int left = currentPoint.x();
-        while (left > bounds.left() && layer->cellAt(left - 1, currentPoint.y()) == matchCell) {
+        while (left > bounds.left() && matcher.matches(left - 1, y)) {
             --left;
-            processedCells[indexOffset + startOfLine + left] = true;
+            matcher.setProcessed(left, y);
         }
 
         // Seek as far right as we can
         int right = currentPoint.x();
-        while (right < bounds.right() && layer->cellAt(right + 1, currentPoint.y()) == matchCell) {
+        while (right < bounds.right() && matcher.matches(right + 1, y)) {
             ++right;
-            processedCells[indexOffset + startOfLine + right] = true;
+            matcher.setProcessed(right, y);
         }
 
         // Add cells between left and right to the region
-        fillRegion += QRegion(left, currentPoint.y(), right - left + 1, 1);
+        fillRegion.addSpan(left, y, right - left + 1);
 
         bool leftColumnIsStaggered = false;
         bool rightColumnIsStaggered = false;
@@ -246,7 +347,7 @@ static QRegion fillRegion(const TileLayer *layer,
         // For hexagonal maps with a staggered Y-axis, we may need to extend the search range
         if (isStaggered) {
             if (staggerAxis == Map::StaggerY) {
-                bool rowIsStaggered = ((layer->y() + currentPoint.y()) & 1) ^ staggerIndex;
+                bool rowIsStaggered = ((layer->y() + y) & 1) ^ staggerIndex;
                 if (rowIsStaggered)
                     right = qMin(right + 1, bounds.right());
                 else
@@ -258,28 +359,25 @@ static QRegion fillRegion(const TileLayer *layer,
         }
 
         // Loop between left and right and check if cells above or below need
-        // to be added to the queue.
-        auto findFillPositions = [=,&fillPositions](int left, int right, int y) {
+        // to be added, adding only one position for each span of cells.
+        auto findFillPositions = [&](int left, int right, int y) {
             bool adjacentCellAdded = false;
 
             for (int x = left; x <= right; ++x) {
-                const int index = y * width + x;
-
-                if (!processedCells[indexOffset + index] && layer->cellAt(x, y) == matchCell) {
-                    // Do not add the cell to the queue if an adjacent cell was added.
+                if (!matcher.isProcessed(x, y) && matcher.matches(x, y)) {
                     if (!adjacentCellAdded) {
-                        fillPositions.enqueue(QPoint(x, y));
+                        fillPositions.append(QPoint(x, y));
                         adjacentCellAdded = true;
                     }
                 } else {
                     adjacentCellAdded = false;
                 }
 
-                processedCells[indexOffset + index] = true;
+                matcher.setProcessed(x, y);
             }
         };
 
-        if (currentPoint.y() > bounds.top()) {
+        if (y > bounds.top()) {
             int _left = left;
             int _right = right;
 
@@ -290,10 +388,10 @@ static QRegion fillRegion(const TileLayer *layer,
                     _right = qMin(right + 1, bounds.right());
             }
 
-            findFillPositions(_left, _right, currentPoint.y() - 1);
+            findFillPositions(_left, _right, y - 1);
         }
 
-        if (currentPoint.y() < bounds.bottom()) {
+        if (y < bounds.bottom()) {
             int _left = left;
             int _right = right;
 
@@ -304,7 +402,7 @@ static QRegion fillRegion(const TileLayer *layer,
                     _right = qMin(right + 1, bounds.right());
             }
 
-            findFillPositions(_left, _right, currentPoint.y() + 1);
+            findFillPositions(_left, _right, y + 1);
         }
     }
 
@@ -323,29 +421,29 @@ QRegion TilePainter::computePaintableFillRegion(QPoint fillOrigin) const
     else
         bounds = mTileLayer->rect();
 
-    QRegion region = fillRegion(mTileLayer,
-                                bounds.translated(-mTileLayer->position()),
-                                fillOrigin - mTileLayer->position(),
-                                map->orientation(), map->staggerAxis(), map->staggerIndex());
+    TileRegion region = fillRegion(mTileLayer,
+                                   bounds.translated(-mTileLayer->position()),
+                                   fillOrigin - mTileLayer->position(),
+                                   map->orientation(), map->staggerAxis(), map->staggerIndex());
 
-    region.translate(mTileLayer->position());
+    region = region.translated(mTileLayer->position());
 
     if (!selection.isEmpty())
-        region &= selection;
+        region &= TileRegion(selection);
 
-    return region;
+    return region.toRegion();
 }
 
 QRegion TilePainter::computeFillRegion(QPoint fillOrigin) const
 {
     const Map *map = mMapDocument->map();
     QRegion bounds = map->infinite() ? mTileLayer->bounds() : mTileLayer->rect();
-    QRegion region = fillRegion(mTileLayer,
-                                bounds.translated(-mTileLayer->position()),
-                                fillOrigin - mTileLayer->position(),
-                                map->orientation(), map->staggerAxis(), map->staggerIndex());
+    TileRegion region = fillRegion(mTileLayer,
+                                   bounds.translated(-mTileLayer->position()),
+                                   fillOrigin - mTileLayer->position(),
+                                   map->orientation(), map->staggerAxis(), map->staggerIndex());
 
-    return region.translated(mTileLayer->position());
+    return region.translated(mTileLayer->position()).toRegion();
 }
 
 bool TilePainter::isDrawable(int x, int y) const
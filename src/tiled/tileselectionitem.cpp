@@ -45,6 +45,8 @@ TileSelectionItem::TileSelectionItem(MapDocument *mapDocument,
             this, &TileSelectionItem::selectionChanged);
     connect(mapDocument, &MapDocument::currentLayerChanged,
             this, &TileSelectionItem::updatePosition);
+    connect(mapDocument, &MapDocument::mapChanged,
+            this, &TileSelectionItem::mapChanged);
 
     updateBoundingRect();
 }
@@ -65,13 +67,21 @@ void TileSelectionItem::paint(QPainter *painter,
                               const QStyleOptionGraphicsItem *option,
                               QWidget *)
 {
-    const QRegion &selection = mMapDocument->selectedArea();
+    Q_UNUSED(option)
+
+    MapRenderer *renderer = mMapDocument->renderer();
+
+    // Computing the outline of complex selections is expensive, so it is
+    // only done again when the selection changed
+    if (mSelectionPathDirty) {
+        mSelectionPath = renderer->tileSelectionPath(mMapDocument->selectedArea());
+        mSelectionPathDirty = false;
+    }
+
     QColor highlight = QApplication::palette().highlight().color();
     highlight.setAlpha(128);
 
-    MapRenderer *renderer = mMapDocument->renderer();
-    renderer->drawTileSelection(painter, selection, highlight,
-                                option->exposedRect);
+    renderer->drawTileSelection(painter, mSelectionPath, highlight);
 }
 
 void TileSelectionItem::documentChanged(const ChangeEvent &change)
@@ -94,11 +104,24 @@ void TileSelectionItem::documentChanged(const ChangeEvent &change)
     }
 }
 
+/**
+ * The outline of the selection depends on the size and orientation of the
+ * tiles.
+ */
+void TileSelectionItem::mapChanged()
+{
+    prepareGeometryChange();
+    updateBoundingRect();
+    mSelectionPathDirty = true;
+    update();
+}
+
 void TileSelectionItem::selectionChanged(const QRegion &newSelection,
                                          const QRegion &oldSelection)
 {
     prepareGeometryChange();
     updateBoundingRect();
+    mSelectionPathDirty = true;
 
     // Make sure changes within the bounding rect are updated
     const QRect changedArea = newSelection.xored(oldSelection).boundingRect();
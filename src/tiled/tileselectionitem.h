@@ -21,6 +21,7 @@
 #pragma once
 
 #include <QGraphicsObject>
+#include <QPainterPath>
 
 namespace Tiled {
 
@@ -55,11 +56,16 @@ private:
                           const QRegion &oldSelection);
 
     void currentLayerChanged(Layer *layer);
+    void mapChanged();
 
     void updateBoundingRect();
 
     MapDocument *mMapDocument;
     QRectF mBoundingRect;
+
+    // The outline of the selection, computed when it is first painted
+    mutable QPainterPath mSelectionPath;
+    mutable bool mSelectionPathDirty = true;
 };
 
 } // namespace Tiled
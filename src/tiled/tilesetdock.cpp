@@ -74,6 +74,10 @@
 
 using namespace Tiled;
 
+// Models of tilesets that are no longer shown are kept around for a while,
+// since they are likely to be shown again when switching between maps
+static constexpr int MaxCachedTilesetModels = 16;
+
 namespace {
 
 class NoTilesetWidget : public QWidget
@@ -372,10 +376,7 @@ void TilesetDock::selectTiles(const QList<Tile *> &tiles)
         const Tileset *tileset = tile->tileset();
         const int tilesetIndex = indexOfTileset(tileset);
         if (tilesetIndex != -1) {
-            TilesetView *view = tilesetViewAt(tilesetIndex);
-            if (!view->model()) // Lazily set up the model
-                setupTilesetModel(view, mTilesetDocuments.at(tilesetIndex));
-
+            TilesetView *view = ensureTilesetView(tilesetIndex);
             const TilesetModel *model = view->tilesetModel();
             const QModelIndex modelIndex = model->tileIndex(tile);
             QItemSelectionModel *selectionModel = view->selectionModel();
@@ -493,12 +494,9 @@ void TilesetDock::updateActions()
     const int index = mTabBar->currentIndex();
 
     if (index > -1) {
-        view = tilesetViewAt(index);
+        view = ensureTilesetView(index);
         tileset = mTilesetDocuments.at(index)->tileset().data();
 
-        if (!view->model()) // Lazily set up the model
-            setupTilesetModel(view, mTilesetDocuments.at(index));
-
         mViewStack->setCurrentIndex(index);
         external = tileset->isExternal();
     }
@@ -570,11 +568,43 @@ void TilesetDock::createTilesetView(int index, TilesetDocument *tilesetDocument)
 
     mTilesetDocuments.insert(index, tilesetDocument);
 
-    TilesetView *view = new TilesetView;
-
     // Hides the "New Tileset..." special view if it is shown.
     mSuperViewStack->setCurrentIndex(1);
 
+    // Insert a placeholder before the tab to make sure it is there when the
+    // tab index changes (happens when first tab is inserted). The actual view
+    // is only created once it is needed, see ensureTilesetView.
+    mViewStack->insertWidget(index, new QWidget);
+    mTabBar->insertTab(index, tileset->name());
+    mTabBar->setTabToolTip(index, tileset->fileName());
+
+    // Workaround a bug that appears to have snug into Qt 6 which causes the
+    // tab bar to be entirely invisible if only a single tab exists.
+#if QT_VERSION >= QT_VERSION_CHECK(6, 2, 4)
+    if (!mTabBar->isVisible())
+        mTabBar->updateGeometry();
+#endif
+
+    connect(tilesetDocument, &TilesetDocument::fileNameChanged,
+            this, &TilesetDock::tilesetFileNameChanged);
+    connect(tilesetDocument, &TilesetDocument::tilesetChanged,
+            this, &TilesetDock::tilesetChanged);
+}
+
+/**
+ * Returns the view for the tileset at the given \a index, creating it when
+ * it doesn't exist yet.
+ */
+TilesetView *TilesetDock::ensureTilesetView(int index)
+{
+    if (TilesetView *view = tilesetViewAt(index))
+        return view;
+
+    TilesetDocument *tilesetDocument = mTilesetDocuments.at(index);
+    auto tileset = tilesetDocument->tileset();
+
+    TilesetView *view = new TilesetView;
+
     // Restore state from last time
     const QString fileName = tilesetDocument->externalOrEmbeddedFileName();
     const QVariantMap fileState = Session::current().fileState(fileName);
@@ -595,28 +625,29 @@ void TilesetDock::createTilesetView(int index, TilesetDocument *tilesetDocument)
         }
     }
 
-    // Insert view before the tab to make sure it is there when the tab index
-    // changes (happens when first tab is inserted).
-    mViewStack->insertWidget(index, view);
-    mTabBar->insertTab(index, tileset->name());
-    mTabBar->setTabToolTip(index, tileset->fileName());
-
-    // Workaround a bug that appears to have snug into Qt 6 which causes the
-    // tab bar to be entirely invisible if only a single tab exists.
-#if QT_VERSION >= QT_VERSION_CHECK(6, 2, 4)
-    if (!mTabBar->isVisible())
-        mTabBar->updateGeometry();
-#endif
-
-    connect(tilesetDocument, &TilesetDocument::fileNameChanged,
-            this, &TilesetDock::tilesetFileNameChanged);
-    connect(tilesetDocument, &TilesetDocument::tilesetChanged,
-            this, &TilesetDock::tilesetChanged);
+    setupTilesetModel(view, tilesetDocument);
 
     connect(view, &TilesetView::clicked,
             this, &TilesetDock::updateCurrentTiles);
     connect(view, &TilesetView::swapTilesRequested,
             this, &TilesetDock::swapTiles);
+
+    // Replace the placeholder
+    QWidget *placeholder = mViewStack->widget(index);
+    const bool isCurrent = mViewStack->currentWidget() == placeholder;
+    {
+        const QSignalBlocker blocker(mViewStack);
+        mViewStack->insertWidget(index, view);
+        if (isCurrent)
+            mViewStack->setCurrentIndex(index);
+        mViewStack->removeWidget(placeholder);
+        delete placeholder;
+    }
+
+    if (isCurrent)
+        onCurrentTilesetChanged();
+
+    return view;
 }
 
 void TilesetDock::deleteTilesetView(int index)
@@ -625,18 +656,21 @@ void TilesetDock::deleteTilesetView(int index)
     tilesetDocument->disconnect(this);
 
     Tileset *tileset = tilesetDocument->tileset().data();
-    TilesetView *view = tilesetViewAt(index);
 
-    // Remember the scale
-    const QString fileName = tilesetDocument->externalOrEmbeddedFileName();
-    Session::current().setFileStateValue(fileName, QLatin1String("scaleInDock"), view->scale());
+    if (TilesetView *view = tilesetViewAt(index)) {
+        // Remember the scale
+        const QString fileName = tilesetDocument->externalOrEmbeddedFileName();
+        Session::current().setFileStateValue(fileName, QLatin1String("scaleInDock"), view->scale());
+
+        cacheTilesetModel(view->tilesetModel());
+    }
 
     // Some cleanup for potentially old preferences from Tiled 1.3
     const QString path = QLatin1String("TilesetDock/TilesetScale/") + tileset->name();
     Preferences::instance()->remove(path);
 
     mTilesetDocuments.removeAt(index);
-    delete view;                    // view needs to go before the tab
+    delete mViewStack->widget(index);   // view needs to go before the tab
     mTabBar->removeTab(index);
 
     // Make the "New Tileset..." special tab reappear if there is no tileset open
@@ -665,11 +699,9 @@ void TilesetDock::tilesetChanged(Tileset *tileset)
     if (index < 0)
         return;
 
-    TilesetView *view = tilesetViewAt(index);
-
-    if (TilesetModel *model = view->tilesetModel()) {
+    if (TilesetView *view = tilesetViewAt(index)) {
         view->updateBackgroundColor();
-        model->tilesetChanged();
+        view->tilesetModel()->tilesetChanged();
     }
 }
 
@@ -1050,19 +1082,32 @@ int TilesetDock::indexOfTileset(const Tileset *tileset) const
     return std::distance(mTilesetDocuments.constBegin(), it);
 }
 
+/**
+ * Returns the current tileset view, or nullptr when it wasn't created yet.
+ */
 TilesetView *TilesetDock::currentTilesetView() const
 {
-    return static_cast<TilesetView *>(mViewStack->currentWidget());
+    return qobject_cast<TilesetView *>(mViewStack->currentWidget());
 }
 
+/**
+ * Returns the tileset view at the given \a index, or nullptr when it wasn't
+ * created yet.
+ */
 TilesetView *TilesetDock::tilesetViewAt(int index) const
 {
-    return static_cast<TilesetView *>(mViewStack->widget(index));
+    return qobject_cast<TilesetView *>(mViewStack->widget(index));
 }
 
 void TilesetDock::setupTilesetModel(TilesetView *view, TilesetDocument *tilesetDocument)
 {
-    view->setModel(new TilesetModel(tilesetDocument, view));
+    TilesetModel *model = takeCachedTilesetModel(tilesetDocument);
+    if (model)
+        model->setParent(view);
+    else
+        model = new TilesetModel(tilesetDocument, view);
+
+    view->setModel(model);
 
     QItemSelectionModel *s = view->selectionModel();
     connect(s, &QItemSelectionModel::selectionChanged,
@@ -1073,6 +1118,43 @@ void TilesetDock::setupTilesetModel(TilesetView *view, TilesetDocument *tilesetD
             this, &TilesetDock::indexPressed);
 }
 
+/**
+ * Keeps the \a model of a tileset view that is about to be deleted, so that
+ * it can be reused when the tileset is shown again.
+ */
+void TilesetDock::cacheTilesetModel(TilesetModel *model)
+{
+    model->setParent(this);
+    mCachedModels.append(model);
+
+    // The model can't outlive its tileset document
+    connect(model->tilesetDocument(), &QObject::destroyed, model, [this, model] {
+        if (mCachedModels.removeOne(model))
+            model->deleteLater();
+    });
+
+    while (mCachedModels.size() > MaxCachedTilesetModels)
+        delete mCachedModels.takeFirst();
+}
+
+TilesetModel *TilesetDock::takeCachedTilesetModel(TilesetDocument *tilesetDocument)
+{
+    for (int i = 0; i < mCachedModels.size(); ++i) {
+        TilesetModel *model = mCachedModels.at(i);
+        if (model->tilesetDocument() != tilesetDocument)
+            continue;
+
+        mCachedModels.removeAt(i);
+        QObject::disconnect(tilesetDocument, &QObject::destroyed, model, nullptr);
+
+        // Catch up on any changes made while the model wasn't shown
+        model->tilesetChanged();
+        return model;
+    }
+
+    return nullptr;
+}
+
 void TilesetDock::editTileset()
 {
     auto tileset = currentTileset();
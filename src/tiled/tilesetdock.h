@@ -53,6 +53,7 @@ class MapDocument;
 class TileStamp;
 class TilesetDocument;
 class TilesetDocumentsFilterModel;
+class TilesetModel;
 class TilesetView;
 class Zoomable;
 
@@ -171,14 +172,19 @@ private:
     TilesetView *tilesetViewAt(int index) const;
 
     void createTilesetView(int index, TilesetDocument *tilesetDocument);
+    TilesetView *ensureTilesetView(int index);
     void deleteTilesetView(int index);
     void moveTilesetView(int from, int to);
     void setupTilesetModel(TilesetView *view, TilesetDocument *tilesetDocument);
 
+    void cacheTilesetModel(TilesetModel *model);
+    TilesetModel *takeCachedTilesetModel(TilesetDocument *tilesetDocument);
+
     MapDocument *mMapDocument = nullptr;
 
     QList<TilesetDocument *> mTilesetDocuments;
     TilesetDocumentsFilterModel *mTilesetDocumentsFilterModel;
+    QList<TilesetModel *> mCachedModels;    // least recently used first
 
     QTabBar *mTabBar;
     QStackedWidget *mSuperViewStack;
@@ -28,6 +28,7 @@
 #include "tile.h"
 #include "tilesetformat.h"
 #include "tilesetwangsetmodel.h"
+#include "tracer.h"
 #include "wangcolormodel.h"
 #include "wangset.h"
 
@@ -171,6 +172,8 @@ TilesetDocumentPtr TilesetDocument::load(const QString &fileName,
                                          TilesetFormat *format,
                                          QString *error)
 {
+    TraceScope trace("Load tileset", fileName);
+
     SharedTileset tileset = format->read(fileName);
 
     if (tileset.isNull()) {
@@ -43,10 +43,13 @@
 #include "tileanimationeditor.h"
 #include "tilecollisiondock.h"
 #include "tilelayer.h"
+#include "tilesetatlas.h"
 #include "tilesetdocument.h"
+#include "tilesetformat.h"
 #include "tilesetmanager.h"
 #include "tilesetmodel.h"
 #include "tilesetview.h"
+#include "tmxmapformat.h"
 #include "toolmanager.h"
 #include "undodock.h"
 #include "utils.h"
@@ -131,6 +134,7 @@ TilesetEditor::TilesetEditor(QObject *parent)
     , mWidgetStack(new QStackedWidget(mMainWindow))
     , mAddTiles(new QAction(this))
     , mRemoveTiles(new QAction(this))
+    , mPackIntoAtlases(new QAction(this))
     , mRelocateTiles(new QAction(this))
     , mShowAnimationEditor(new QAction(this))
     , mDynamicWrappingToggle(new QAction(this))
@@ -154,6 +158,7 @@ TilesetEditor::TilesetEditor(QObject *parent)
     ActionManager::registerAction(editWang, "EditWang");
     ActionManager::registerAction(mAddTiles, "AddTiles");
     ActionManager::registerAction(mRemoveTiles, "RemoveTiles");
+    ActionManager::registerAction(mPackIntoAtlases, "PackIntoAtlases");
     ActionManager::registerAction(mRelocateTiles, "RelocateTiles");
     ActionManager::registerAction(mShowAnimationEditor, "ShowAnimationEditor");
     ActionManager::registerAction(mDynamicWrappingToggle, "DynamicWrappingToggle");
@@ -198,6 +203,7 @@ TilesetEditor::TilesetEditor(QObject *parent)
 
     connect(mAddTiles, &QAction::triggered, this, &TilesetEditor::openAddTilesDialog);
     connect(mRemoveTiles, &QAction::triggered, this, &TilesetEditor::removeTiles);
+    connect(mPackIntoAtlases, &QAction::triggered, this, &TilesetEditor::packIntoAtlases);
 
     connect(mRelocateTiles, &QAction::toggled, this, &TilesetEditor::setRelocateTiles);
     connect(editCollision, &QAction::toggled, this, &TilesetEditor::setEditCollision);
@@ -675,6 +681,7 @@ void TilesetEditor::retranslateUi()
 
     mAddTiles->setText(tr("Add Tiles"));
     mRemoveTiles->setText(tr("Remove Tiles"));
+    mPackIntoAtlases->setText(tr("Pack Into Atlases..."));
     mRelocateTiles->setText(tr("Rearrange Tiles"));
     mShowAnimationEditor->setText(tr("Tile Animation Editor"));
     mDynamicWrappingToggle->setText(tr("Dynamically Wrap Tiles"));
@@ -1034,6 +1041,58 @@ void TilesetEditor::onAnimationEditorClosed()
     mShowAnimationEditor->setChecked(false);
 }
 
+/**
+ * Saves a copy of the current image collection tileset, with its tile images
+ * packed into atlases. The tileset itself is not changed, so that it can
+ * remain the source from which the packed tileset is derived.
+ */
+void TilesetEditor::packIntoAtlases()
+{
+    Tileset *tileset = currentTileset();
+    if (!tileset || !tileset->isCollection())
+        return;
+
+    FormatHelper<TilesetFormat> helper(FileFormat::Write);
+
+    Session &session = Session::current();
+
+    QString suggestedFileName = session.lastPath(Session::ExternalTileset);
+    suggestedFileName += QLatin1Char('/');
+    suggestedFileName += tileset->name();
+    suggestedFileName += QLatin1String("-atlas.tsx");
+
+    QString selectedFilter = TsxTilesetFormat().nameFilter();
+    const QString fileName =
+            QFileDialog::getSaveFileName(mMainWindow->window(), tr("Pack Into Atlases"),
+                                         suggestedFileName,
+                                         helper.filter(), &selectedFilter);
+
+    if (fileName.isEmpty())
+        return;
+
+    session.setLastPath(Session::ExternalTileset, QFileInfo(fileName).path());
+
+    TilesetFormat *format = helper.formatByNameFilter(selectedFilter);
+    if (!format)
+        return;     // can't happen
+
+    SharedTileset packedTileset = tileset->clone();
+
+    TilesetAtlasPacker packer;
+    QString error;
+
+    if (!packer.pack(*packedTileset, fileName))
+        error = packer.errorString();
+    else if (!format->write(*packedTileset, fileName))
+        error = format->errorString();
+
+    if (!error.isEmpty()) {
+        QMessageBox::critical(mMainWindow->window(),
+                              tr("Pack Into Atlases"),
+                              tr("Error saving tileset: %1").arg(error));
+    }
+}
+
 void TilesetEditor::updateAddRemoveActions()
 {
     bool isCollection = false;
@@ -1046,6 +1105,7 @@ void TilesetEditor::updateAddRemoveActions()
 
     mAddTiles->setEnabled(isCollection);
     mRemoveTiles->setEnabled(isCollection && hasSelection);
+    mPackIntoAtlases->setEnabled(isCollection);
 }
 
 } // namespace Tiled
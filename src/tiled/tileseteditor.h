@@ -92,6 +92,7 @@ public:
 
     QAction *addTilesAction() const;
     QAction *removeTilesAction() const;
+    QAction *packIntoAtlasesAction() const;
     QAction *relocateTilesAction() const;
     QAction *editCollisionAction() const;
     QAction *editWangSetsAction() const;
@@ -126,6 +127,7 @@ private:
     void openAddTilesDialog();
     void addTiles(const QList<QUrl> &urls);
     void removeTiles();
+    void packIntoAtlases();
 
     void setRelocateTiles(bool relocateTiles);
     void setEditCollision(bool editCollision);
@@ -158,6 +160,7 @@ private:
 
     QAction *mAddTiles;
     QAction *mRemoveTiles;
+    QAction *mPackIntoAtlases;
     QAction *mRelocateTiles;
     QAction *mShowAnimationEditor;
     QAction *mDynamicWrappingToggle;
@@ -188,6 +191,11 @@ inline QAction *TilesetEditor::removeTilesAction() const
     return mRemoveTiles;
 }
 
+inline QAction *TilesetEditor::packIntoAtlasesAction() const
+{
+    return mPackIntoAtlases;
+}
+
 inline QAction *TilesetEditor::relocateTilesAction() const
 {
     return mRelocateTiles;
@@ -30,13 +30,24 @@
 
 #include <QMimeData>
 
+#include <algorithm>
+
 using namespace Tiled;
 
+static QList<int> tileIdsOf(const Tileset *tileset)
+{
+    QList<int> tileIds;
+    tileIds.reserve(tileset->tileCount());
+    for (const Tile *tile : tileset->tiles())
+        tileIds.append(tile->id());
+    return tileIds;
+}
+
 TilesetModel::TilesetModel(TilesetDocument *tilesetDocument, QObject *parent)
     : QAbstractListModel(parent)
     , mTilesetDocument(tilesetDocument)
 {
-    refreshTileIds();
+    setTileIds(tileIdsOf(tileset()));
 
     connect(tilesetDocument, &TilesetDocument::tileImageSourceChanged,
             this, &TilesetModel::tileChanged);
@@ -79,7 +90,7 @@ QVariant TilesetModel::data(const QModelIndex &index, int role) const
 {
     if (role == Qt::DecorationRole) {
         if (Tile *tile = tileAt(index))
-            return tile->image().copy(tile->imageRect());
+            return tile->croppedImage();
     }
 
     return QVariant();
@@ -174,7 +185,7 @@ bool TilesetModel::dropMimeData(const QMimeData *data, Qt::DropAction action,
 
     if (!sourceTiles.isEmpty()) {
         Tile *destinationTile = tileAt(parent);
-        int destinationIndex = destinationTile ? mTileIds.indexOf(destinationTile->id())
+        int destinationIndex = destinationTile ? mTileIndexes.value(destinationTile->id(), -1)
                                                : mTileIds.size() - 1;
 
         mTilesetDocument->undoStack()->push(new RelocateTiles(mTilesetDocument,
@@ -210,7 +221,7 @@ QModelIndex TilesetModel::tileIndex(const Tile *tile) const
     if (columnCount <= 0)
         return QModelIndex();
 
-    const int tileIndex = mTileIds.indexOf(tile->id());
+    const int tileIndex = mTileIndexes.value(tile->id(), -1);
     // todo: this assertion was hit when testing tileset image size changes
     Q_ASSERT(tileIndex != -1);
 
@@ -225,11 +236,52 @@ Tileset *TilesetModel::tileset() const
     return mTilesetDocument->tileset().data();
 }
 
+static int rowCountFor(int tileCount, int columns)
+{
+    return columns > 0 ? (tileCount + columns - 1) / columns : 1;
+}
+
+static bool startsWith(const QList<int> &list, const QList<int> &prefix)
+{
+    return list.size() >= prefix.size()
+            && std::equal(prefix.cbegin(), prefix.cend(), list.cbegin());
+}
+
 void TilesetModel::tilesetChanged()
 {
-    beginResetModel();
-    refreshTileIds();
-    endResetModel();
+    const QList<int> tileIds = tileIdsOf(tileset());
+    const int columns = columnCount();
+    const bool appended = startsWith(tileIds, mTileIds);
+    const bool truncated = !appended && startsWith(mTileIds, tileIds);
+
+    // Changes to the layout of the tiles require a reset
+    if (columns != mColumnCount || columns <= 0 || !(appended || truncated) ||
+            tileset()->tileSize() != mTileSize) {
+        beginResetModel();
+        setTileIds(tileIds);
+        endResetModel();
+        return;
+    }
+
+    const int previousRows = rowCountFor(mTileIds.size(), columns);
+    const int rows = rowCountFor(tileIds.size(), columns);
+
+    if (rows > previousRows) {
+        beginInsertRows(QModelIndex(), previousRows, rows - 1);
+        setTileIds(tileIds);
+        endInsertRows();
+    } else if (rows < previousRows) {
+        beginRemoveRows(QModelIndex(), rows, previousRows - 1);
+        setTileIds(tileIds);
+        endRemoveRows();
+    } else {
+        setTileIds(tileIds);
+    }
+
+    // The images of the remaining tiles may have changed as well
+    const int changedRows = std::min(rows, previousRows);
+    if (changedRows > 0)
+        emit dataChanged(index(0, 0), index(changedRows - 1, columns - 1));
 }
 
 void TilesetModel::setColumnCountOverride(int columnCount)
@@ -239,6 +291,7 @@ void TilesetModel::setColumnCountOverride(int columnCount)
 
     beginResetModel();
     mColumnCountOverride = columnCount;
+    mColumnCount = TilesetModel::columnCount();
     endResetModel();
 }
 
@@ -278,11 +331,16 @@ void TilesetModel::tileChanged(Tile *tile)
     emit dataChanged(i, i);
 }
 
-void TilesetModel::refreshTileIds()
+void TilesetModel::setTileIds(const QList<int> &tileIds)
 {
-    mTileIds.clear();
-    for (Tile *tile : tileset()->tiles())
-        mTileIds.append(tile->id());
+    mTileIds = tileIds;
+    mColumnCount = columnCount();
+    mTileSize = tileset()->tileSize();
+
+    mTileIndexes.clear();
+    mTileIndexes.reserve(mTileIds.size());
+    for (int i = 0; i < mTileIds.size(); ++i)
+        mTileIndexes.insert(mTileIds.at(i), i);
 }
 
 #include "moc_tilesetmodel.cpp"
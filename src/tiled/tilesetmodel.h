@@ -24,6 +24,7 @@
 #include "tile.h"
 
 #include <QAbstractListModel>
+#include <QHash>
 
 namespace Tiled {
 
@@ -96,9 +97,17 @@ public:
      */
     Tileset *tileset() const;
 
+    /**
+     * Returns the tileset document associated with this model.
+     */
+    TilesetDocument *tilesetDocument() const { return mTilesetDocument; }
+
     /**
      * Refreshes the list of tile IDs. Should be called after tiles are added
      * or removed from the tileset.
+     *
+     * When tiles were only added or removed at the end, rows are inserted or
+     * removed rather than resetting the model.
      */
     void tilesetChanged();
 
@@ -126,10 +135,13 @@ private:
      */
     void tileChanged(Tile *tile);
 
-    void refreshTileIds();
+    void setTileIds(const QList<int> &tileIds);
 
     TilesetDocument *mTilesetDocument;
     QList<int> mTileIds;
+    QHash<int, int> mTileIndexes;   // tile ID -> index in mTileIds
+    int mColumnCount = 0;           // column count when tile IDs were set
+    QSize mTileSize;                // tile size when tile IDs were set
     int mColumnCountOverride = 0;
 };
 
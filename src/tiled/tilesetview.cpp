@@ -148,14 +148,39 @@ void TileDelegate::paint(QPainter *painter,
     }
 
     // Draw the tile image
-    if (Zoomable *zoomable = mTilesetView->zoomable())
-        if (zoomable->smoothTransform())
-            painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    Zoomable *zoomable = mTilesetView->zoomable();
+    const bool smooth = zoomable && zoomable->smoothTransform();
+    if (smooth)
+        painter->setRenderHint(QPainter::SmoothPixmapTransform);
+
+    // Tiles from the tileset image are drawn from a scaled copy of that
+    // image, to avoid scaling from the full image for each tile. Very large
+    // tileset images are drawn from a pyramid of tiles instead.
+    QPixmap scaledImage;
+    const ImagePyramid *pyramid = nullptr;
+    const qreal devicePixelRatio = painter->device()->devicePixelRatioF();
+    if (!tileImage.isNull() &&
+            tileImage.cacheKey() == model->tileset()->image().cacheKey()) {
+        pyramid = mTilesetView->tilesetImagePyramid();
+        if (!pyramid && !wrapping && zoom != 1.0)
+            scaledImage = mTilesetView->scaledTilesetImage(zoom, devicePixelRatio, smooth);
+    }
 
-    if (!tileImage.isNull())
+    if (pyramid) {
+        pyramid->draw(painter, targetRect, tile->imageRect());
+    } else if (!scaledImage.isNull()) {
+        const qreal scale = zoom * devicePixelRatio;
+        const QRect &imageRect = tile->imageRect();
+        const QRect sourceRect(qRound(imageRect.x() * scale),
+                               qRound(imageRect.y() * scale),
+                               qRound(targetRect.width() * devicePixelRatio),
+                               qRound(targetRect.height() * devicePixelRatio));
+        painter->drawPixmap(targetRect, scaledImage, sourceRect);
+    } else if (!tileImage.isNull()) {
         painter->drawPixmap(targetRect, tileImage, tile->imageRect());
-    else
+    } else {
         mTilesetView->imageMissingIcon().paint(painter, targetRect, Qt::AlignBottom | Qt::AlignLeft);
+    }
 
 
     // Overlay with film strip when animated
@@ -259,10 +284,10 @@ void TileDelegate::drawWangOverlay(QPainter *painter,
     setupTilesetGridTransform(*tile->tileset(), transform, targetRect);
     painter->setTransform(transform, true);
 
-    paintWangOverlay(painter,
-                     wangSet->wangIdOfTile(tile) & wangSet->typeMask(),
-                     *wangSet,
-                     targetRect);
+    paintCachedWangOverlay(painter,
+                           wangSet->wangIdOfTile(tile) & wangSet->typeMask(),
+                           *wangSet,
+                           targetRect);
 
     if (mTilesetView->hoveredIndex() == index) {
         qreal opacity = painter->opacity();
@@ -561,6 +586,61 @@ QIcon TilesetView::imageMissingIcon() const
     return QIcon::fromTheme(QLatin1String("image-missing"), mImageMissingIcon);
 }
 
+/**
+ * Returns a copy of the tileset image scaled by \a scale for a device with
+ * the given \a devicePixelRatio. The copy is kept until the image or the
+ * scale changes.
+ *
+ * Returns a null pixmap when the scaled image would be too large.
+ */
+QPixmap TilesetView::scaledTilesetImage(qreal scale, qreal devicePixelRatio, bool smooth) const
+{
+    // Limit the memory used by the scaled image to 64 MB
+    constexpr qint64 MaxScaledImagePixels = 16 * 1024 * 1024;
+
+    const TilesetModel *model = tilesetModel();
+    if (!model)
+        return QPixmap();
+
+    const QPixmap &image = model->tileset()->image();
+    const QSize size = (QSizeF(image.size()) * scale * devicePixelRatio).toSize();
+
+    if (size.isEmpty() || qint64(size.width()) * size.height() > MaxScaledImagePixels)
+        return QPixmap();
+
+    if (mScaledImageKey != image.cacheKey() || mScaledImageSize != size ||
+            mScaledImageSmooth != smooth) {
+        mScaledImage = image.scaled(size, Qt::IgnoreAspectRatio,
+                                    smooth ? Qt::SmoothTransformation
+                                           : Qt::FastTransformation);
+        mScaledImageKey = image.cacheKey();
+        mScaledImageSize = size;
+        mScaledImageSmooth = smooth;
+    }
+
+    return mScaledImage;
+}
+
+/**
+ * Returns the pyramid used for drawing the tileset image, or nullptr when
+ * the tileset image is not large enough to need one.
+ */
+const ImagePyramid *TilesetView::tilesetImagePyramid() const
+{
+    const TilesetModel *model = tilesetModel();
+    const QPixmap image = model ? model->tileset()->image() : QPixmap();
+
+    if (!ImagePyramid::isLarge(image.size())) {
+        mImagePyramid.reset();
+        return nullptr;
+    }
+
+    if (!mImagePyramid || mImagePyramid->cacheKey() != image.cacheKey())
+        mImagePyramid = std::make_unique<ImagePyramid>(image);
+
+    return mImagePyramid.get();
+}
+
 void TilesetView::mousePressEvent(QMouseEvent *event)
 {
     if (mEditWangSet) {
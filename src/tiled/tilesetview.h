@@ -20,11 +20,14 @@
 
 #pragma once
 
+#include "imagepyramid.h"
 #include "tilesetmodel.h"
 #include "wangset.h"
 
 #include <QTableView>
 
+#include <memory>
+
 namespace Tiled {
 
 class ChangeEvent;
@@ -98,6 +101,9 @@ public:
 
     QIcon imageMissingIcon() const;
 
+    QPixmap scaledTilesetImage(qreal scale, qreal devicePixelRatio, bool smooth) const;
+    const ImagePyramid *tilesetImagePyramid() const;
+
     void updateBackgroundColor();
 
 signals:
@@ -160,6 +166,13 @@ private:
     bool mWangIdChanged = false;
 
     const QIcon mImageMissingIcon;
+
+    // Cached scaled copy of the tileset image
+    mutable QPixmap mScaledImage;
+    mutable qint64 mScaledImageKey = 0;
+    mutable QSize mScaledImageSize;
+    mutable bool mScaledImageSmooth = false;
+    mutable std::unique_ptr<ImagePyramid> mImagePyramid;
 };
 
 inline TilesetDocument *TilesetView::tilesetDocument() const
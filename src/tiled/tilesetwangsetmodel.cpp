@@ -75,7 +75,7 @@ QVariant TilesetWangSetModel::data(const QModelIndex &index, int role) const
             return wangSet->name();
         case Qt::DecorationRole:
             if (Tile *tile = wangSet->imageTile())
-                return tile->image().copy(tile->imageRect());
+                return tile->croppedImage();
             else
                 return wangSetIcon(wangSet->type());
             break;
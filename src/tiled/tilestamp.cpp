@@ -27,8 +27,35 @@
 #include <QDebug>
 #include <QJsonArray>
 
+#include <memory>
+
 namespace Tiled {
 
+/**
+ * The variations of a stamp in each of its orientations, shared between the
+ * stamp and all stamps derived from it by flipping and rotating. This way
+ * each orientation is only computed once, until the stamp is changed.
+ *
+ * An orientation is identified by the flags a cell ends up with when it is
+ * flipped and rotated in the same way as the stamp.
+ */
+class TileStampTransforms
+{
+public:
+    ~TileStampTransforms();
+
+    static constexpr int OrientationCount = 8;
+
+    QVector<TileStampVariation> variations[OrientationCount];
+};
+
+TileStampTransforms::~TileStampTransforms()
+{
+    for (const auto &orientationVariations : variations)
+        for (const TileStampVariation &variation : orientationVariations)
+            delete variation.map;
+}
+
 class TileStampData : public QSharedData
 {
 public:
@@ -36,12 +63,44 @@ public:
     TileStampData(const TileStampData &other);
     ~TileStampData();
 
+    void invalidateCaches();
+
     int quickStampIndex;
     QString name;
     QString fileName;
     QVector<TileStampVariation> variations;
+
+    // Caches, which are not copied
+    mutable std::unique_ptr<AliasPicker<Map *>> randomVariations;
+    std::shared_ptr<TileStampTransforms> transforms;
+    int orientation = 0;
 };
 
+static QVector<TileStampVariation> cloneVariations(const QVector<TileStampVariation> &variations)
+{
+    QVector<TileStampVariation> clones;
+    clones.reserve(variations.size());
+    for (const TileStampVariation &variation : variations)
+        clones.append(TileStampVariation(variation.map->clone().release(), variation.probability));
+    return clones;
+}
+
+static int flippedOrientation(int orientation, FlipDirection direction)
+{
+    return orientation ^ (direction == FlipHorizontally ? Cell::FlippedHorizontally
+                                                        : Cell::FlippedVertically);
+}
+
+static int rotatedOrientation(int orientation, RotateDirection direction)
+{
+    Cell cell;
+    cell.setFlippedHorizontally(orientation & Cell::FlippedHorizontally);
+    cell.setFlippedVertically(orientation & Cell::FlippedVertically);
+    cell.setFlippedAntiDiagonally(orientation & Cell::FlippedAntiDiagonally);
+    cell.rotate(direction);
+    return cell.flags();
+}
+
 TileStampData::TileStampData()
     : quickStampIndex(-1)
 {}
@@ -64,6 +123,17 @@ TileStampData::~TileStampData()
         delete variation.map;
 }
 
+/**
+ * Drops the cached random picker and transformed variations, which needs to
+ * happen whenever the variations change.
+ */
+void TileStampData::invalidateCaches()
+{
+    randomVariations.reset();
+    transforms.reset();
+    orientation = 0;
+}
+
 
 TileStamp::TileStamp()
     : d(new TileStampData)
@@ -128,6 +198,7 @@ qreal TileStamp::probability(int index) const
 void TileStamp::setProbability(int index, qreal probability)
 {
     d->variations[index].probability = probability;
+    d->invalidateCaches();
 }
 
 QSize TileStamp::maxSize() const
@@ -150,6 +221,7 @@ void TileStamp::addVariation(std::unique_ptr<Map> map, qreal probability)
 {
     Q_ASSERT(map);
     d->variations.append(TileStampVariation(map.release(), probability));
+    d->invalidateCaches();
 }
 
 /**
@@ -158,6 +230,7 @@ void TileStamp::addVariation(std::unique_ptr<Map> map, qreal probability)
  */
 Map *TileStamp::takeVariation(int index)
 {
+    d->invalidateCaches();
     return d->variations.takeAt(index).map;
 }
 
@@ -179,15 +252,71 @@ void TileStamp::setQuickStampIndex(int quickStampIndex)
     d->quickStampIndex = quickStampIndex;
 }
 
-RandomPicker<Map *> TileStamp::randomVariations() const
+/**
+ * Returns a picker for choosing a random variation based on the variation
+ * probabilities. The picker is cached until the variations change.
+ */
+const AliasPicker<Map *> &TileStamp::randomVariations() const
 {
     Q_ASSERT(!d->variations.isEmpty());
 
-    RandomPicker<Map *> randomPicker;
+    if (!d->randomVariations) {
+        d->randomVariations = std::make_unique<AliasPicker<Map *>>();
+        for (const TileStampVariation &variation : std::as_const(d->variations))
+            d->randomVariations->add(variation.map, variation.probability);
+    }
+
+    return *d->randomVariations;
+}
+
+/**
+ * Returns whether flipped and rotated versions of this stamp can be cached
+ * by orientation. This is not the case for staggered and hexagonal maps,
+ * since transforming those also changes their stagger index.
+ */
+bool TileStamp::canCacheTransforms() const
+{
     for (const TileStampVariation &variation : std::as_const(d->variations))
-        randomPicker.add(variation.map, variation.probability);
+        if (variation.map->isStaggered())
+            return false;
+    return true;
+}
+
+/**
+ * Returns the cached version of this stamp in the given \a orientation, or
+ * an empty stamp when it hasn't been computed yet.
+ */
+TileStamp TileStamp::cachedTransform(int orientation) const
+{
+    TileStamp stamp;
 
-    return randomPicker;
+    if (d->transforms) {
+        const auto &variations = d->transforms->variations[orientation];
+        if (!variations.isEmpty()) {
+            stamp.d->name = d->name;
+            stamp.d->variations = cloneVariations(variations);
+            stamp.d->transforms = d->transforms;
+            stamp.d->orientation = orientation;
+        }
+    }
+
+    return stamp;
+}
+
+/**
+ * Stores the \a transformed version of this stamp, which has the given
+ * \a orientation, so that it can be reused.
+ */
+void TileStamp::cacheTransform(TileStamp &transformed, int orientation) const
+{
+    if (!d->transforms) {
+        d->transforms = std::make_shared<TileStampTransforms>();
+        d->transforms->variations[d->orientation] = cloneVariations(d->variations);
+    }
+
+    d->transforms->variations[orientation] = cloneVariations(transformed.d->variations);
+    transformed.d->transforms = d->transforms;
+    transformed.d->orientation = orientation;
 }
 
 /**
@@ -196,6 +325,15 @@ RandomPicker<Map *> TileStamp::randomVariations() const
  */
 TileStamp TileStamp::flipped(FlipDirection direction) const
 {
+    const bool cacheTransforms = canCacheTransforms();
+    const int orientation = flippedOrientation(d->orientation, direction);
+
+    if (cacheTransforms) {
+        TileStamp cached = cachedTransform(orientation);
+        if (!cached.isEmpty())
+            return cached;
+    }
+
     TileStamp flipped(*this);
     flipped.d.detach();
 
@@ -231,6 +369,9 @@ TileStamp TileStamp::flipped(FlipDirection direction) const
         }
     }
 
+    if (cacheTransforms)
+        cacheTransform(flipped, orientation);
+
     return flipped;
 }
 
@@ -240,6 +381,15 @@ TileStamp TileStamp::flipped(FlipDirection direction) const
  */
 TileStamp TileStamp::rotated(RotateDirection direction) const
 {
+    const bool cacheTransforms = canCacheTransforms();
+    const int orientation = rotatedOrientation(d->orientation, direction);
+
+    if (cacheTransforms) {
+        TileStamp cached = cachedTransform(orientation);
+        if (!cached.isEmpty())
+            return cached;
+    }
+
     TileStamp rotated(*this);
     rotated.d.detach();
 
@@ -268,6 +418,9 @@ TileStamp TileStamp::rotated(RotateDirection direction) const
         variation.map->setHeight(rotatedSize.height());
     }
 
+    if (cacheTransforms)
+        cacheTransform(rotated, orientation);
+
     return rotated;
 }
 
@@ -85,7 +85,7 @@ public:
     int quickStampIndex() const;
     void setQuickStampIndex(int quickStampIndex);
 
-    RandomPicker<Map *> randomVariations() const;
+    const AliasPicker<Map *> &randomVariations() const;
 
     TileStamp flipped(FlipDirection direction) const;
     TileStamp rotated(RotateDirection direction) const;
@@ -98,6 +98,10 @@ public:
                               const QDir &mapDir);
 
 private:
+    bool canCacheTransforms() const;
+    TileStamp cachedTransform(int orientation) const;
+    void cacheTransform(TileStamp &transformed, int orientation) const;
+
     QExplicitlySharedDataPointer<TileStampData> d;
 };
 
@@ -88,13 +88,13 @@ TransformMapObjects::TransformMapObjects(Document *document,
 void TransformMapObjects::undo()
 {
     ChangeValue<MapObject, TransformState>::undo();
-    emit document()->changed(MapObjectsChangeEvent(objects(), mChangedProperties));
+    document()->emitChanged(MapObjectsChangeEvent(objects(), mChangedProperties));
 }
 
 void TransformMapObjects::redo()
 {
     ChangeValue<MapObject, TransformState>::redo();
-    emit document()->changed(MapObjectsChangeEvent(objects(), mChangedProperties));
+    document()->emitChanged(MapObjectsChangeEvent(objects(), mChangedProperties));
 }
 
 bool TransformMapObjects::mergeWith(const QUndoCommand *other)
@@ -20,7 +20,7 @@
 
 #include "undocommands.h"
 
-#include <QUndoCommand>
+#include <QUndoStack>
 
 namespace Tiled {
 
@@ -40,4 +40,71 @@ bool cloneChildren(const QUndoCommand *command, QUndoCommand *parent)
     return true;
 }
 
+/**
+ * Returns the approximate amount of memory used by the given \a command and
+ * its children, in bytes. Only commands that implement
+ * CompressibleUndoCommand are taken into account.
+ */
+qint64 undoMemoryUsage(const QUndoCommand *command)
+{
+    qint64 usage = 0;
+
+    if (auto compressible = dynamic_cast<const CompressibleUndoCommand*>(command))
+        usage += compressible->memoryUsage();
+
+    for (int i = 0, count = command->childCount(); i < count; ++i)
+        usage += undoMemoryUsage(command->child(i));
+
+    return usage;
+}
+
+/**
+ * Returns the approximate amount of memory used by all commands on the
+ * given \a undoStack, in bytes.
+ */
+qint64 undoMemoryUsage(const QUndoStack *undoStack)
+{
+    qint64 usage = 0;
+    for (int i = 0, count = undoStack->count(); i < count; ++i)
+        usage += undoMemoryUsage(undoStack->command(i));
+    return usage;
+}
+
+static void compressUndoCommand(const QUndoCommand *command)
+{
+    // QUndoStack only provides const access to its commands, but compressing
+    // a command does not change its behavior.
+    if (auto compressible = dynamic_cast<const CompressibleUndoCommand*>(command))
+        const_cast<CompressibleUndoCommand*>(compressible)->compress();
+
+    for (int i = 0, count = command->childCount(); i < count; ++i)
+        compressUndoCommand(command->child(i));
+}
+
+/**
+ * Compresses the commands on the given \a undoStack, starting with the
+ * oldest one, until their memory usage fits within \a budget bytes.
+ *
+ * The commands right before and after the current index are left alone,
+ * since these are the ones most likely to be used or merged with next.
+ */
+void compressUndoStack(QUndoStack *undoStack, qint64 budget)
+{
+    qint64 usage = undoMemoryUsage(undoStack);
+    if (usage <= budget)
+        return;
+
+    const int index = undoStack->index();
+
+    for (int i = 0, count = undoStack->count(); i < count && usage > budget; ++i) {
+        if (i == index - 1 || i == index)
+            continue;
+
+        const QUndoCommand *command = undoStack->command(i);
+        const qint64 before = undoMemoryUsage(command);
+        compressUndoCommand(command);
+        usage -= before - undoMemoryUsage(command);
+    }
+}
+
 } // namespace Tiled
@@ -20,7 +20,10 @@
 
 #pragma once
 
+#include <QtGlobal>
+
 class QUndoCommand;
+class QUndoStack;
 
 namespace Tiled {
 
@@ -68,6 +71,36 @@ public:
     virtual QUndoCommand *clone(QUndoCommand *parent = nullptr) const = 0;
 };
 
+/**
+ * Interface to be implemented by undo commands that may hold on to large
+ * amounts of data, like copies of tile layers.
+ *
+ * The memory used by these commands is taken into account for the undo
+ * memory budget. When the budget is exceeded, the oldest commands are
+ * compressed. A compressed command needs to restore its data on undo(),
+ * redo() and when merging.
+ */
+class CompressibleUndoCommand
+{
+public:
+    virtual ~CompressibleUndoCommand() = default;
+
+    /**
+     * Returns the approximate amount of memory used by the data of this
+     * command, in bytes, not including its children.
+     */
+    virtual qint64 memoryUsage() const = 0;
+
+    /**
+     * Compresses the data of this command, for as long as it isn't used.
+     */
+    virtual void compress() = 0;
+};
+
 bool cloneChildren(const QUndoCommand *command, QUndoCommand *parent);
 
+qint64 undoMemoryUsage(const QUndoCommand *command);
+qint64 undoMemoryUsage(const QUndoStack *undoStack);
+void compressUndoStack(QUndoStack *undoStack, qint64 budget);
+
 } // namespace Tiled
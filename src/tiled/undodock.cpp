@@ -21,7 +21,14 @@
 
 #include "undodock.h"
 
+#include "document.h"
+#include "preferences.h"
+#include "undocommands.h"
+
 #include <QEvent>
+#include <QLabel>
+#include <QLocale>
+#include <QUndoStack>
 #include <QUndoView>
 #include <QVBoxLayout>
 
@@ -37,10 +44,14 @@ UndoDock::UndoDock(QWidget *parent)
     mUndoView->setCleanIcon(cleanIcon);
     mUndoView->setUniformItemSizes(true);
 
+    mMemoryUsageLabel = new QLabel(this);
+    mMemoryUsageLabel->setContentsMargins(4, 2, 4, 2);
+
     QWidget *widget = new QWidget(this);
     QVBoxLayout *layout = new QVBoxLayout(widget);
     layout->setContentsMargins(0, 0, 0, 0);
     layout->addWidget(mUndoView);
+    layout->addWidget(mMemoryUsageLabel);
 
     setWidget(widget);
     retranslateUi();
@@ -48,7 +59,15 @@ UndoDock::UndoDock(QWidget *parent)
 
 void UndoDock::setStack(QUndoStack *stack)
 {
+    if (QUndoStack *previousStack = mUndoView->stack())
+        previousStack->disconnect(this);
+
     mUndoView->setStack(stack);
+
+    if (stack)
+        connect(stack, &QUndoStack::indexChanged, this, &UndoDock::updateMemoryUsage);
+
+    updateMemoryUsage();
 }
 
 void UndoDock::changeEvent(QEvent *e)
@@ -67,6 +86,23 @@ void UndoDock::retranslateUi()
 {
     setWindowTitle(tr("History"));
     mUndoView->setEmptyLabel(tr("<empty>"));
+    updateMemoryUsage();
+}
+
+void UndoDock::updateMemoryUsage()
+{
+    const QUndoStack *stack = mUndoView->stack();
+    const qint64 usage = stack ? undoMemoryUsage(stack) : 0;
+    const int budget = Document::undoMemoryBudget;
+
+    const QLocale locale;
+    if (budget > 0) {
+        mMemoryUsageLabel->setText(tr("Memory: %1 of %2").arg(
+                                       locale.formattedDataSize(usage),
+                                       locale.formattedDataSize(qint64(budget) * 1024 * 1024)));
+    } else {
+        mMemoryUsageLabel->setText(tr("Memory: %1").arg(locale.formattedDataSize(usage)));
+    }
 }
 
 #include "moc_undodock.cpp"
@@ -23,6 +23,7 @@
 
 #include <QDockWidget>
 
+class QLabel;
 class QUndoStack;
 class QUndoView;
 
@@ -46,7 +47,10 @@ protected:
 
 private:
     void retranslateUi();
+    void updateMemoryUsage();
+
     QUndoView *mUndoView;
+    QLabel *mMemoryUsageLabel;
 };
 
 } // namespace Tiled
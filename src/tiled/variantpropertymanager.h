@@ -26,6 +26,7 @@
 #include <QtVariantPropertyManager>
 
 #include <QFileIconProvider>
+#include <QHash>
 
 namespace Tiled {
 
@@ -96,19 +97,19 @@ private:
 
     static QString objectRefLabel(const MapObject &object);
 
-    QMap<const QtProperty *, QVariant> mValues;
+    QHash<const QtProperty *, QVariant> mValues;
 
     struct FilePathAttributes {
         QString filter;
         bool directory = false;
     };
-    QMap<const QtProperty *, FilePathAttributes> mFilePathAttributes;
+    QHash<const QtProperty *, FilePathAttributes> mFilePathAttributes;
 
     struct StringAttributes {
         QStringList suggestions;
         bool multiline = false;
     };
-    QMap<const QtProperty *, StringAttributes> mStringAttributes;
+    QHash<const QtProperty *, StringAttributes> mStringAttributes;
 
     int alignToIndexH(Qt::Alignment align) const;
     int alignToIndexV(Qt::Alignment align) const;
@@ -116,8 +117,8 @@ private:
     Qt::Alignment indexVToAlign(int idx) const;
     QString indexHToString(int idx) const;
     QString indexVToString(int idx) const;
-    QMap<const QtProperty *, Qt::Alignment> m_alignValues;
-    using PropertyToPropertyMap = QMap<QtProperty *, QtProperty *>;
+    QHash<const QtProperty *, Qt::Alignment> m_alignValues;
+    using PropertyToPropertyMap = QHash<QtProperty *, QtProperty *>;
     PropertyToPropertyMap m_propertyToAlignH;
     PropertyToPropertyMap m_propertyToAlignV;
     PropertyToPropertyMap m_alignHToProperty;
@@ -27,10 +27,21 @@
 #include "map.h"
 #include "randompicker.h"
 #include "tilelayer.h"
+#include "tileregion.h"
 #include "wangset.h"
 
 using namespace Tiled;
 
+/**
+ * Flags tracked for each location during WangFiller::apply, which avoids
+ * doing many expensive QRegion operations.
+ */
+enum CellFlag : quint8 {
+    InRegion    = 0x1,
+    Queued      = 0x2,
+    Invalid     = 0x4,
+};
+
 static constexpr QPoint aroundTilePoints[WangId::NumIndexes] = {
     QPoint( 0, -1),
     QPoint( 1, -1),
@@ -53,9 +64,19 @@ WangFiller::WangFiller(const WangSet &wangSet,
 {
 }
 
+/**
+ * Returns the region to be filled, along with the desired WangIds.
+ */
+WangFiller::FillRegion &WangFiller::region()
+{
+    mergeAddedPositions();
+    return mFillRegion;
+}
+
 void WangFiller::setRegion(const QRegion &region)
 {
     mFillRegion.region = region;
+    mAddedPositions = TileRegion();
 }
 
 WangFiller::CellInfo &WangFiller::changePosition(QPoint pos)
@@ -63,10 +84,12 @@ WangFiller::CellInfo &WangFiller::changePosition(QPoint pos)
     CellInfo &info = mFillRegion.grid.add(pos);
 
     // Initialize the desired WangId when necessary, and make sure the location
-    // is part of the to be processed region.
+    // is part of the to be processed region. The positions are collected in a
+    // TileRegion, since adding them to a QRegion one by one gets slow for
+    // long strokes.
     if (info == CellInfo()) {
         info.desired = mWangSet.wangIdOfCell(mBack.cellAt(pos));
-        mFillRegion.region += QRect(pos, pos);
+        mAddedPositions.addSpan(pos.x(), pos.y(), 1);
     }
 
     return info;
@@ -187,6 +210,7 @@ static void updateAdjacent(WangFiller::CellInfo &adjacentInfo, WangId wangId, in
  */
 void WangFiller::apply(TileLayer &target)
 {
+    mergeAddedPositions();
     mInvalidRegion = QRegion();
 
     auto &grid = mFillRegion.grid;
@@ -208,11 +232,17 @@ void WangFiller::apply(TileLayer &target)
         region &= mBack.rect();
     }
 
+    Grid<quint8> flags;
+    for (const QRect &rect : region)
+        for (int y = rect.top(); y <= rect.bottom(); ++y)
+            for (int x = rect.left(); x <= rect.right(); ++x)
+                flags.add(x, y) |= InRegion;
+
     if (!mCorrectionsEnabled) {
         // Set the Wang IDs at the border of the region to prefer the tiles in
         // the filled region to connect with those outside of it.
         auto setDesiredWangId = [&] (int x, int y, WangId mask) {
-            const WangId surroundings = wangIdFromSurroundings(QPoint(x, y));
+            const WangId surroundings = wangIdFromSurroundings(QPoint(x, y), flags);
             CellInfo &info = grid.add(x, y);
 
             // Don't override explicitly set indexes and don't override with
@@ -242,8 +272,10 @@ void WangFiller::apply(TileLayer &target)
     if (!mMapRenderer->map()->infinite())
         bounds &= mBack.rect();
 
-    // Keep a list of points that need correction
+    // Keep a list of points that need correction, and the ones for which no
+    // matching tile was found
     QVector<QPoint> corrections;
+    TileRegion invalidRegion;
 
     auto resolve = [&] (int x, int y) {
         const QPoint targetPos(x - target.x(),
@@ -254,7 +286,11 @@ void WangFiller::apply(TileLayer &target)
 
         Cell cell;
         if (!findBestMatch(target, grid, QPoint(x, y), cell)) {
-            mInvalidRegion += QRect(x, y, 1, 1);
+            quint8 &cellFlags = flags.add(x, y);
+            if (!(cellFlags & Invalid)) {
+                cellFlags |= Invalid;
+                invalidRegion.addSpan(x, y, 1);
+            }
             return;
         }
 
@@ -276,10 +312,13 @@ void WangFiller::apply(TileLayer &target)
             updateAdjacent(adjacentInfo, cellWangId, i);
 
             // Check if we may need to reconsider a tile outside of our starting region
-            if (!WangId::isCorner(i) && mCorrectionsEnabled && bounds.contains(p) && !region.contains(p)) {
+            // Each point only needs to be queued once, since it will be
+            // resolved before any further changes are made around it.
+            if (!WangId::isCorner(i) && mCorrectionsEnabled && bounds.contains(p) && !(flags.get(p) & (InRegion | Queued))) {
                 const WangId currentWangId = mWangSet.wangIdOfCell(mBack.cellAt(p));
 
                 if ((currentWangId & adjacentInfo.mask) != (adjacentInfo.desired & adjacentInfo.mask)) {
+                    flags.add(p) |= Queued;
                     corrections.append(p);
 
                     // Synchronize desired WangId with current tile, keeping the masked indexes
@@ -308,9 +347,23 @@ void WangFiller::apply(TileLayer &target)
         processing.clear();
     }
 
+    mInvalidRegion = invalidRegion.toRegion();
     mFillRegion = FillRegion();
 }
 
+void WangFiller::mergeAddedPositions()
+{
+    if (mAddedPositions.isEmpty())
+        return;
+
+    if (mFillRegion.region.isEmpty())
+        mFillRegion.region = mAddedPositions.toRegion();
+    else
+        mFillRegion.region |= mAddedPositions.toRegion();
+
+    mAddedPositions = TileRegion();
+}
+
 /**
  * Returns a WangId matching that of the provided \a surroundingWangIds.
  *
@@ -350,7 +403,7 @@ static WangId wangIdFromSurrounding(const WangId surroundingWangIds[])
     return id;
 }
 
-WangId WangFiller::wangIdFromSurroundings(QPoint point) const
+WangId WangFiller::wangIdFromSurroundings(QPoint point, const Grid<quint8> &flags) const
 {
     WangId wangIds[WangId::NumIndexes];
     QPoint adjacentPoints[8];
@@ -363,7 +416,7 @@ WangId WangFiller::wangIdFromSurroundings(QPoint point) const
         if (cell.isEmpty())
             continue;
 
-        if (mFillRegion.region.contains(adjacentPoints[i]))
+        if (flags.get(adjacentPoints[i]) & InRegion)
             continue;
 
         wangIds[i] = mWangSet.wangIdOfCell(cell);
@@ -430,9 +483,13 @@ bool WangFiller::findBestMatch(const TileLayer &target,
         }
     };
 
+    // Only visit the candidates matching the masked WangId
     const auto &wangIdsAndCells = mWangSet.wangIdsAndCells();
-    for (const auto &wangIdAndCell : wangIdsAndCells)
+    const auto candidates = mWangSet.matchingWangIdsAndCells(info.desired, info.mask);
+    for (int index : candidates) {
+        const auto &wangIdAndCell = wangIdsAndCells.at(index);
         processCandidate(wangIdAndCell.wangId, wangIdAndCell.cell);
+    }
 
     if (mErasingEnabled)
         processCandidate(WangId(), Cell());
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "grid.h"
+#include "tileregion.h"
 #include "wangset.h"
 
 #include <QList>
@@ -68,7 +69,7 @@ public:
                         const TileLayer &back,
                         const MapRenderer *mapRenderer);
 
-    FillRegion &region() { return mFillRegion; }
+    FillRegion &region();
 
     bool correctionsEnabled() const { return mCorrectionsEnabled; }
     void setCorrectionsEnabled(bool enabled) { mCorrectionsEnabled = enabled; }
@@ -95,9 +96,9 @@ public:
 private:
     /**
      * Returns a wangId based the cells surrounding the given point, which
-     * are outside of the current region.
+     * are outside of the current region (as marked in the \a flags).
      */
-    WangId wangIdFromSurroundings(QPoint point) const;
+    WangId wangIdFromSurroundings(QPoint point, const Grid<quint8> &flags) const;
     WangId wangIdFromSurroundingCells(const Cell surroundingCells[]) const;
 
     bool findBestMatch(const TileLayer &target,
@@ -105,6 +106,8 @@ private:
                        QPoint position,
                        Cell &result) const;
 
+    void mergeAddedPositions();
+
     const WangSet &mWangSet;
     const TileLayer &mBack;
     const MapRenderer * const mMapRenderer;
@@ -112,6 +115,7 @@ private:
     bool mCorrectionsEnabled = false;
     bool mErasingEnabled = true;
     FillRegion mFillRegion;
+    TileRegion mAddedPositions;     // not yet merged into mFillRegion.region
     QRegion mInvalidRegion;
 
     QPainter *mDebugPainter = nullptr;
@@ -26,6 +26,7 @@
 #include <QPainter>
 #include <QPainterPath>
 #include <QPalette>
+#include <QPixmapCache>
 
 namespace Tiled {
 
@@ -579,6 +580,70 @@ void paintWangOverlay(QPainter *painter,
     painter->restore();
 }
 
+/**
+ * Paints the same overlay as paintWangOverlay, using a pixmap cached in the
+ * QPixmapCache. This is a lot faster when many tiles share the same WangIds,
+ * like when scrolling through a large tileset.
+ *
+ * The cache key includes everything the overlay depends on, including the
+ * colors, so the pixmaps never need to be invalidated explicitly.
+ *
+ * Falls back to painting the overlay directly when the painter is rotated
+ * or scaled, since a pixmap would look different in that case.
+ */
+void paintCachedWangOverlay(QPainter *painter,
+                            WangId wangId,
+                            const WangSet &wangSet,
+                            const QRect &rect,
+                            WangOverlayOptions options)
+{
+    if (!wangId || rect.isEmpty())
+        return;
+
+    if (painter->transform().type() > QTransform::TxTranslate) {
+        paintWangOverlay(painter, wangId, wangSet, rect, options);
+        return;
+    }
+
+    const qreal devicePixelRatio = painter->device()->devicePixelRatioF();
+
+    QString key = QStringLiteral("wangoverlay:%1:%2:%3x%4@%5:%6")
+            .arg(int(wangSet.type()))
+            .arg(int(options))
+            .arg(rect.width())
+            .arg(rect.height())
+            .arg(devicePixelRatio)
+            .arg(quint64(wangId), 0, 16);
+
+    for (int i = 0; i < WangId::NumIndexes; ++i) {
+        const int color = wangId.indexColor(i);
+        QRgb rgba = 0;
+        if (color == int(WangId::INDEX_MASK))
+            rgba = QGuiApplication::palette().color(QPalette::Highlight).rgba();
+        else if (color > 0 && color <= wangSet.colorCount())
+            rgba = wangSet.colorAt(color)->color().rgba();
+
+        key += QLatin1Char(':');
+        key += QString::number(rgba, 16);
+    }
+
+    QPixmap pixmap;
+    if (!QPixmapCache::find(key, &pixmap)) {
+        pixmap = QPixmap(rect.size() * devicePixelRatio);
+        pixmap.setDevicePixelRatio(devicePixelRatio);
+        pixmap.fill(Qt::transparent);
+
+        QPainter pixmapPainter(&pixmap);
+        paintWangOverlay(&pixmapPainter, wangId, wangSet,
+                         QRect(QPoint(), rect.size()), options);
+        pixmapPainter.end();
+
+        QPixmapCache::insert(key, pixmap);
+    }
+
+    painter->drawPixmap(rect.topLeft(), pixmap);
+}
+
 static QIcon paintWangSetIcon(WangSet::Type type)
 {
     static const auto iconSize = Utils::dpiScaled(QSize(32, 32));
@@ -43,6 +43,12 @@ void paintWangOverlay(QPainter *painter,
                       const QRect &rect,
                       WangOverlayOptions options = WO_TransparentFill | WO_Shadow | WO_Outline);
 
+void paintCachedWangOverlay(QPainter *painter,
+                            WangId wangId,
+                            const WangSet &wangSet,
+                            const QRect &rect,
+                            WangOverlayOptions options = WO_TransparentFill | WO_Shadow | WO_Outline);
+
 QIcon wangSetIcon(WangSet::Type type);
 
 } // namespace Tiled
@@ -119,7 +119,7 @@ QVariant WangSetModel::data(const QModelIndex &index, int role) const
             return wangSet->name();
         case Qt::DecorationRole:
             if (Tile *tile = wangSet->imageTile())
-                return tile->image().copy(tile->imageRect());
+                return tile->croppedImage();
             else
                 return wangSetIcon(wangSet->type());
             break;
@@ -73,7 +73,7 @@ void WangTemplateDelegate::paint(QPainter *painter,
     painter->setClipRect(option.rect);
 
     if (WangSet *wangSet = mWangTemplateView->wangSet())
-        paintWangOverlay(painter, wangId, *wangSet, option.rect, WO_Outline);
+        paintCachedWangOverlay(painter, wangId, *wangSet, option.rect, WO_Outline);
 
     // Highlight currently selected tile.
     if (mWangTemplateView->currentIndex() == index) {
@@ -20,30 +20,58 @@
  * this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "automappingmanager.h"
 #include "commandlineparser.h"
+#include "exportcache.h"
 #include "exporthelper.h"
+#include "imagecache.h"
 #include "logginginterface.h"
 #include "mainwindow.h"
+#include "mapdiff.h"
+#include "mapdocument.h"
 #include "mapformat.h"
+#include "mapreader.h"
+#include "mapwriter.h"
 #include "pluginmanager.h"
 #include "preferences.h"
+#include "projectmanager.h"
+#include "projectvalidator.h"
+#include "randompicker.h"
+#include "savefile.h"
 #include "scriptmanager.h"
 #include "sentryhelper.h"
 #include "stylehelper.h"
 #include "tiledapplication.h"
 #include "tileset.h"
+#include "tilesetatlas.h"
 #include "tmxmapformat.h"
+#include "tracer.h"
+#include "utils.h"
 
+#include <QDateTime>
 #include <QDebug>
+#include <QDirIterator>
 #include <QFileInfo>
 #include <QImageReader>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QProcess>
+#include <QResource>
+#include <QScopeGuard>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <QUndoStack>
 #include <QtPlugin>
 
 #include "qtcompat_p.h"
 
+#include <algorithm>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #ifdef Q_OS_WIN
 
@@ -85,7 +113,14 @@ public:
     bool disableOpenGL = false;
     bool exportMap = false;
     bool exportTileset = false;
+    bool packTileset = false;
+    bool autoMap = false;
+    bool incremental = false;
+    bool validateProject = false;
+    bool diffMaps = false;
+    bool serve = false;
     bool newInstance = false;
+    int jobs = 1;
     Preferences::ExportOptions exportOptions;
 
 private:
@@ -93,12 +128,23 @@ private:
     void justQuit();
     void setDisableOpenGL();
     void setProject();
+    void addResourceArchive();
     void setExportMap();
     void setExportTileset();
+    void setPackTileset();
+    void setAutoMap();
+    void setRandomSeed();
+    void setValidateProject();
+    void setDiffMaps();
+    void setServe();
     void setExportEmbedTilesets();
     void setExportDetachTemplateInstances();
     void setExportResolveObjectTypesAndProperties();
     void setExportMinimized();
+    void setSkipUnchanged();
+    void setIncremental();
+    void setJobs();
+    void setImageCache();
     void showExportFormats();
     void setCompatibilityVersion();
     void evaluateScript();
@@ -183,6 +229,763 @@ inline T *findExportFormat(const QString *filter,
     return outputFormat;
 }
 
+using LoadedTilesets = QSet<SharedTileset>;
+
+/**
+ * Keeps the external tilesets of \a map loaded until the end of the export,
+ * so that they are not loaded again when they are used by other maps.
+ */
+static void keepTilesetsLoaded(const Map &map, LoadedTilesets &loadedTilesets)
+{
+    for (const SharedTileset &tileset : map.tilesets())
+        if (tileset->isExternal())
+            loadedTilesets.insert(tileset);
+}
+
+/**
+ * Used during TMX to TMX export without options that need the whole map.
+ * Each top-level layer is written as soon as it was read, which avoids
+ * keeping the entire map in memory.
+ *
+ * Returns false when the map could not be streamed, in which case the
+ * target file is left untouched.
+ */
+static bool streamTmxMap(const QString &sourceFile,
+                         const QString &targetFile,
+                         bool minimize,
+                         LoadedTilesets &loadedTilesets)
+{
+    QFile source(sourceFile);
+    if (!source.open(QFile::ReadOnly | QFile::Text))
+        return false;
+
+    SaveFile target(targetFile);
+    if (!target.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    MapWriter writer;
+    writer.setMinimizeOutput(minimize);
+    bool started = false;
+
+    auto beginMap = [&] (Map &map) {
+        // We don't want to save the export options in the exported file
+        map.exportFileName.clear();
+        map.exportFormat.clear();
+
+        writer.beginMap(&map, target.device(), QFileInfo(targetFile).absolutePath());
+        started = true;
+    };
+
+    MapReader reader;
+    const auto map = reader.readMap(&source, QFileInfo(sourceFile).absolutePath(),
+                                    [&] (Map &streamingMap, Layer &layer) {
+        if (!started)
+            beginMap(streamingMap);
+        writer.writeLayer(&layer);
+    });
+
+    if (!map)
+        return false;
+
+    keepTilesetsLoaded(*map, loadedTilesets);
+
+    if (!started)
+        beginMap(*map);
+    writer.endMap();
+
+    if (target.error() != QFileDevice::NoError)
+        return false;
+
+    return target.commit();
+}
+
+/**
+ * Writes \a sourceMap to \a targetFile in the given \a outputFormat, after
+ * applying the export options.
+ */
+static bool writeExportMap(const Map *sourceMap,
+                           MapFormat *outputFormat,
+                           const QString &targetFile,
+                           Preferences::ExportOptions exportOptions)
+{
+    std::unique_ptr<Map> exportMap;
+    ExportHelper exportHelper(exportOptions);
+    const Map *map = exportHelper.prepareExportMap(sourceMap, exportMap);
+
+    if (!outputFormat->write(map, targetFile, exportHelper.formatOptions())) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to export map to target file.");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Exports the map \a sourceFile to \a targetFile, using the format matching
+ * \a filter or otherwise the format matching the target file.
+ */
+static bool exportMapFile(const QString *filter,
+                          const QString &sourceFile,
+                          const QString &targetFile,
+                          Preferences::ExportOptions exportOptions,
+                          LoadedTilesets &loadedTilesets)
+{
+    QString errorMsg;
+    MapFormat *outputFormat = findExportFormat<MapFormat>(filter, targetFile, errorMsg);
+    if (!outputFormat) {
+        Q_ASSERT(!errorMsg.isEmpty());
+        qWarning().noquote() << errorMsg;
+        return false;
+    }
+
+    // Stream TMX to TMX conversions when no export options need the
+    // whole map, falling back to loading it entirely when this fails
+    if (dynamic_cast<TmxMapFormat*>(outputFormat) &&
+            !(exportOptions & ~Preferences::ExportMinimized) &&
+            QFileInfo(sourceFile) != QFileInfo(targetFile)) {
+        MapFormat *sourceFormat = findSupportingMapFormat(sourceFile);
+        if (!sourceFormat || dynamic_cast<TmxMapFormat*>(sourceFormat)) {
+            const bool minimize = exportOptions.testFlag(Preferences::ExportMinimized);
+            if (streamTmxMap(sourceFile, targetFile, minimize, loadedTilesets))
+                return true;
+        }
+    }
+
+    // Load the source file
+    const std::unique_ptr<Map> sourceMap(readMap(sourceFile, &errorMsg));
+    if (!sourceMap) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load source map.");
+        if (!errorMsg.isEmpty())
+            qWarning().noquote() << errorMsg;
+        return false;
+    }
+
+    keepTilesetsLoaded(*sourceMap, loadedTilesets);
+
+    return writeExportMap(sourceMap.get(), outputFormat, targetFile, exportOptions);
+}
+
+/**
+ * Returns the command line arguments to pass on to the export workers. These
+ * are the arguments of this process, except for the program name, the
+ * given \a files and the options that start the export.
+ */
+static QStringList workerArguments(const QStringList &files)
+{
+    QStringList arguments = QCoreApplication::arguments();
+    arguments.removeFirst();
+
+    QStringList options;
+    int fileIndex = 0;
+    bool noMoreOptions = false;
+
+    for (int i = 0; i < arguments.size(); ++i) {
+        const QString &argument = arguments.at(i);
+
+        if (!noMoreOptions) {
+            if (argument == QLatin1String("--")) {
+                noMoreOptions = true;
+                continue;
+            }
+            if (argument == QLatin1String("--export-map"))
+                continue;
+            if (argument == QLatin1String("--jobs")) {
+                ++i;    // skip the number of jobs
+                continue;
+            }
+        }
+
+        if (fileIndex < files.size() && argument == files.at(fileIndex) &&
+                (noMoreOptions || !argument.startsWith(QLatin1Char('-')))) {
+            ++fileIndex;
+            continue;
+        }
+
+        options.append(argument);
+    }
+
+    return options;
+}
+
+/**
+ * Exports the maps in \a files, which lists source and target files in
+ * pairs, optionally preceded by the format, by distributing them over up to
+ * \a jobs worker processes. Each worker is this executable, exporting its
+ * share of the maps.
+ *
+ * Since each worker has its own script engine and Python interpreter, this
+ * uses multiple cores even for export formats that can only export one map
+ * at a time within a process, like those provided by Python scripts.
+ *
+ * Returns whether all workers exported their maps without errors.
+ */
+static bool exportMapFilesInWorkers(const QStringList &files, int jobs)
+{
+    const QStringList options = workerArguments(files);
+
+    // With an odd number of files, the first one is the format
+    const int first = files.size() % 2;
+    const int pairCount = files.size() / 2;
+    jobs = std::min(jobs, pairCount);
+
+    std::vector<std::unique_ptr<QProcess>> workers;
+
+    for (int job = 0; job < jobs; ++job) {
+        QStringList arguments = options;
+        arguments.append(QStringLiteral("--export-map"));
+        arguments.append(QStringLiteral("--"));
+        if (first)
+            arguments.append(files.first());
+
+        // Spread the maps evenly, since their order often correlates with
+        // their size
+        for (int pair = job; pair < pairCount; pair += jobs) {
+            arguments.append(files.at(first + pair * 2));
+            arguments.append(files.at(first + pair * 2 + 1));
+        }
+
+        auto worker = std::make_unique<QProcess>();
+        worker->setProcessChannelMode(QProcess::ForwardedChannels);
+        worker->start(QCoreApplication::applicationFilePath(), arguments);
+        workers.push_back(std::move(worker));
+    }
+
+    bool success = true;
+
+    for (const auto &worker : workers) {
+        if (!worker->waitForFinished(-1) && worker->error() == QProcess::FailedToStart) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to start export worker: %1")
+                                    .arg(worker->errorString());
+            success = false;
+            continue;
+        }
+
+        success &= worker->exitStatus() == QProcess::NormalExit && worker->exitCode() == 0;
+    }
+
+    return success;
+}
+
+/**
+ * Exports each map in the folders of the loaded project that has an export
+ * target, using the export format stored in the map (as set by
+ * File > Export As).
+ *
+ * When \a incremental is set, maps are skipped when none of the files they
+ * depend on changed since the previous incremental export.
+ *
+ * Returns whether all maps were exported without errors.
+ */
+static bool exportProjectMaps(Preferences::ExportOptions exportOptions,
+                              bool incremental,
+                              LoadedTilesets &loadedTilesets)
+{
+    QStringList nameFilters;
+    const auto mapFormats = PluginManager::objects<MapFormat>();
+    for (MapFormat *format : mapFormats) {
+        if (format->hasCapabilities(MapFormat::Read))
+            nameFilters.append(Utils::cleanFilterList(format->nameFilter()));
+    }
+    nameFilters.removeDuplicates();
+
+    const Project &project = ProjectManager::instance()->project();
+    if (project.fileName().isEmpty())
+        return false;   // failed to load
+
+    std::unique_ptr<ExportCache> cache;
+    if (incremental) {
+        const QJsonObject settings {
+            { QStringLiteral("version"), QCoreApplication::applicationVersion() },
+            { QStringLiteral("exportOptions"), static_cast<int>(exportOptions) },
+            { QStringLiteral("compatibilityVersion"), static_cast<int>(FileFormat::compatibilityVersion()) },
+        };
+        cache = std::make_unique<ExportCache>(ExportCache::fileNameForProject(project.fileName()), settings);
+        cache->load();
+    }
+
+    // Property types are stored in the project, so it affects all maps
+    const QStringList projectDependencies { project.fileName() };
+
+    bool success = true;
+
+    for (const QString &folder : project.folders()) {
+        QDirIterator iterator(folder, nameFilters, QDir::Files, QDirIterator::Subdirectories);
+
+        while (iterator.hasNext()) {
+            const QString fileName = iterator.next();
+
+            // Skip files that are not maps, like tilesets using the same extension
+            if (!findSupportingMapFormat(fileName))
+                continue;
+
+            if (cache && cache->isUpToDate(fileName))
+                continue;
+
+            QString errorMsg;
+            const std::unique_ptr<Map> map(readMap(fileName, &errorMsg));
+            if (!map) {
+                qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load map '%1'.").arg(fileName);
+                if (!errorMsg.isEmpty())
+                    qWarning().noquote() << errorMsg;
+                if (cache)
+                    cache->remove(fileName);
+                success = false;
+                continue;
+            }
+
+            keepTilesetsLoaded(*map, loadedTilesets);
+
+            if (map->exportFileName.isEmpty()) {
+                if (cache)
+                    cache->update(*map, projectDependencies);
+                continue;
+            }
+
+            MapFormat *outputFormat = findFileFormat<MapFormat>(map->exportFormat);
+            if (!outputFormat) {
+                qWarning().noquote() << QCoreApplication::translate("Command line", "Export format '%1' of map '%2' not found.")
+                                        .arg(map->exportFormat, fileName);
+                if (cache)
+                    cache->remove(fileName);
+                success = false;
+                continue;
+            }
+
+            const bool exported = writeExportMap(map.get(), outputFormat, map->exportFileName, exportOptions);
+            if (cache) {
+                if (exported)
+                    cache->update(*map, projectDependencies);
+                else
+                    cache->remove(fileName);
+            }
+            success &= exported;
+        }
+    }
+
+    if (cache && !cache->save())
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to save export cache.");
+
+    return success;
+}
+
+/**
+ * Checks all maps in the folders of the given project, printing the
+ * problems found. Only maps whose inputs changed since the previous
+ * validation are read again.
+ *
+ * Returns whether no errors were found.
+ */
+static bool validateProjectMaps(const QString &projectFile)
+{
+    const std::unique_ptr<Project> project = Project::load(projectFile);
+    if (!project) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load project '%1'.")
+                                .arg(projectFile);
+        return false;
+    }
+
+    const QVector<ProjectValidator::MapResult> results = ProjectValidator(*project).validate();
+
+    bool success = true;
+
+    for (const ProjectValidator::MapResult &result : results) {
+        for (const ProjectValidator::Problem &problem : result.problems) {
+            qWarning().noquote() << QStringLiteral("%1: %2").arg(result.fileName, problem.text);
+            success &= problem.severity != Issue::Error;
+        }
+    }
+
+    return success;
+}
+
+/**
+ * Compares the map \a oldFile to the map \a newFile. Returns nothing when
+ * either map could not be loaded.
+ */
+static std::optional<MapDiff> compareMapFiles(const QString &oldFile, const QString &newFile)
+{
+    std::unique_ptr<Map> maps[2];
+    const QString files[2] = { oldFile, newFile };
+
+    // Loading both maps before comparing them shares their external tilesets
+    for (int i = 0; i < 2; ++i) {
+        QString errorMsg;
+        maps[i] = readMap(files[i], &errorMsg);
+        if (!maps[i]) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load map '%1'.").arg(files[i]);
+            if (!errorMsg.isEmpty())
+                qWarning().noquote() << errorMsg;
+            return std::nullopt;
+        }
+    }
+
+    return MapDiff::compare(*maps[0], *maps[1]);
+}
+
+/**
+ * Compares the map \a oldFile to the map \a newFile and prints the
+ * differences as JSON.
+ *
+ * Returns 0 when the maps are the same, 1 when they differ and 2 when either
+ * map could not be loaded, like the diff utility.
+ */
+static int diffMapFiles(const QString &oldFile, const QString &newFile)
+{
+    const std::optional<MapDiff> diff = compareMapFiles(oldFile, newFile);
+    if (!diff)
+        return 2;
+
+    stdOut() << QJsonDocument::fromVariant(diff->toVariant()).toJson() << Qt::flush;
+
+    return diff->isEmpty() ? 0 : 1;
+}
+
+/**
+ * Exports the tileset \a sourceFile to \a targetFile, using the format
+ * matching \a filter or otherwise the format matching the target file.
+ */
+static bool exportTilesetFile(const QString *filter,
+                              const QString &sourceFile,
+                              const QString &targetFile,
+                              Preferences::ExportOptions exportOptions)
+{
+    QString errorMsg;
+    TilesetFormat *outputFormat = findExportFormat<TilesetFormat>(filter, targetFile, errorMsg);
+    if (!outputFormat) {
+        Q_ASSERT(!errorMsg.isEmpty());
+        qWarning().noquote() << errorMsg;
+        return false;
+    }
+
+    // Load the source file
+    SharedTileset sourceTileset(readTileset(sourceFile, &errorMsg));
+    if (!sourceTileset) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load source tileset.");
+        if (!errorMsg.isEmpty())
+            qWarning().noquote() << errorMsg;
+        return false;
+    }
+
+    // Apply export options
+    ExportHelper exportHelper(exportOptions);
+    SharedTileset exportTileset = exportHelper.prepareExportTileset(sourceTileset);
+
+    // Write out the file
+    bool success = outputFormat->write(*exportTileset, targetFile, exportHelper.formatOptions());
+
+    if (!success) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to export tileset to target file.");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Packs the images of the image collection tileset \a sourceFile into
+ * atlases and saves the result as \a targetFile, leaving the source
+ * tileset untouched. The format is chosen based on the target file.
+ */
+static bool packTilesetFile(const QString &sourceFile,
+                            const QString &targetFile,
+                            Preferences::ExportOptions exportOptions)
+{
+    QString errorMsg;
+    TilesetFormat *outputFormat = findExportFormat<TilesetFormat>(nullptr, targetFile, errorMsg);
+    if (!outputFormat) {
+        Q_ASSERT(!errorMsg.isEmpty());
+        qWarning().noquote() << errorMsg;
+        return false;
+    }
+
+    SharedTileset sourceTileset(readTileset(sourceFile, &errorMsg));
+    if (!sourceTileset) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load source tileset.");
+        if (!errorMsg.isEmpty())
+            qWarning().noquote() << errorMsg;
+        return false;
+    }
+
+    // Pack a copy, since the loaded tileset may be shared
+    SharedTileset packedTileset = sourceTileset->clone();
+
+    TilesetAtlasPacker packer;
+    if (!packer.pack(*packedTileset, targetFile)) {
+        qWarning().noquote() << packer.errorString();
+        return false;
+    }
+
+    ExportHelper exportHelper(exportOptions);
+    SharedTileset exportTileset = exportHelper.prepareExportTileset(packedTileset);
+
+    if (!outputFormat->write(*exportTileset, targetFile, exportHelper.formatOptions())) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to export tileset to target file.");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Applies the AutoMapping rules from \a rulesFile to each of the
+ * \a mapFiles, saving the maps that changed. The rules are loaded only once
+ * and reused for all maps, and as long as \a manager exists.
+ *
+ * Returns whether all maps were processed without errors.
+ */
+static bool autoMapFiles(AutomappingManager &manager,
+                         const QString &rulesFile,
+                         const QStringList &mapFiles,
+                         LoadedTilesets &loadedTilesets)
+{
+    if (!QFileInfo::exists(rulesFile)) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Rules file '%1' not found.").arg(rulesFile);
+        return false;
+    }
+
+    bool success = true;
+
+    for (const QString &mapFile : mapFiles) {
+        QString errorString;
+        MapDocumentPtr mapDocument;
+
+        if (MapFormat *format = findSupportingMapFormat(mapFile))
+            mapDocument = MapDocument::load(mapFile, format, &errorString);
+        else
+            errorString = QCoreApplication::translate("Command line", "Unrecognized file format.");
+
+        if (!mapDocument) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load map '%1'.").arg(mapFile);
+            if (!errorString.isEmpty())
+                qWarning().noquote() << errorString;
+            success = false;
+            continue;
+        }
+
+        keepTilesetsLoaded(*mapDocument->map(), loadedTilesets);
+
+        // The manager keeps the loaded rules as long as the rules file stays
+        // the same, but it should not refer to the map after it is closed
+        manager.setMapDocument(mapDocument.data(), rulesFile);
+        const auto detach = qScopeGuard([&] { manager.setMapDocument(nullptr, rulesFile); });
+
+        manager.autoMap();
+
+        if (!manager.warningString().isEmpty())
+            qWarning().noquote() << manager.warningString().trimmed();
+
+        if (!manager.errorString().isEmpty()) {
+            qWarning().noquote() << manager.errorString().trimmed();
+            success = false;
+        }
+
+        if (mapDocument->undoStack()->isClean())
+            continue;
+
+        if (!mapDocument->save(mapFile, &errorString)) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to save map '%1'.").arg(mapFile);
+            if (!errorString.isEmpty())
+                qWarning().noquote() << errorString;
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+static QMutex sJobMessagesMutex;
+static QStringList *sJobMessages;
+
+/**
+ * Collects the warnings reported while running a job of --serve, which may
+ * come from other threads.
+ */
+static void collectJobMessage(QtMsgType type, const QMessageLogContext &, const QString &message)
+{
+    if (type == QtDebugMsg)
+        return;
+
+    QMutexLocker locker(&sJobMessagesMutex);
+    if (sJobMessages)
+        sJobMessages->append(message);
+}
+
+/**
+ * The state kept between the jobs of --serve.
+ */
+class JobServer
+{
+public:
+    explicit JobServer(Preferences::ExportOptions exportOptions)
+        : mExportOptions(exportOptions)
+    {}
+
+    int exec();
+
+private:
+    bool runJob(const QString &method, const QJsonObject &params, QJsonObject &result);
+    void releaseChangedTilesets();
+    void rememberLoadedTilesets();
+
+    const Preferences::ExportOptions mExportOptions;
+
+    // Keeps the compiled AutoMapping rules cached between jobs
+    AutomappingManager mAutomappingManager;
+
+    LoadedTilesets mLoadedTilesets;
+    QHash<SharedTileset, QDateTime> mTilesetModified;
+};
+
+/**
+ * Reads jobs from the standard input, one JSON object per line, and writes a
+ * response line for each of them to the standard output. For example:
+ *
+ *   {"id": 1, "method": "exportMap", "params": {"source": "a.tmx", "target": "a.json"}}
+ *   {"id": 1, "result": {"success": true, "messages": []}}
+ *
+ * The jobs are run one after the other, until "quit" is received or the
+ * input is closed.
+ */
+int JobServer::exec()
+{
+    QTextStream input(stdin);
+    QString line;
+
+    while (input.readLineInto(&line)) {
+        if (line.trimmed().isEmpty())
+            continue;
+
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(line.toUtf8(), &parseError);
+        const QJsonObject request = document.object();
+        const QString method = request.value(QLatin1String("method")).toString();
+
+        QJsonObject response { { QStringLiteral("id"), request.value(QLatin1String("id")) } };
+
+        if (!document.isObject() || method.isEmpty()) {
+            const QString error = parseError.error != QJsonParseError::NoError
+                    ? parseError.errorString()
+                    : QStringLiteral("Missing method");
+            response.insert(QStringLiteral("error"), QJsonObject { { QStringLiteral("message"), error } });
+        } else if (method == QLatin1String("quit")) {
+            response.insert(QStringLiteral("result"), QJsonObject());
+            stdOut() << QJsonDocument(response).toJson(QJsonDocument::Compact) << Qt::endl;
+            break;
+        } else {
+            releaseChangedTilesets();
+
+            QStringList messages;
+            {
+                QMutexLocker locker(&sJobMessagesMutex);
+                sJobMessages = &messages;
+            }
+            const QtMessageHandler previousHandler = qInstallMessageHandler(collectJobMessage);
+
+            QJsonObject result;
+            const bool known = runJob(method, request.value(QLatin1String("params")).toObject(), result);
+
+            qInstallMessageHandler(previousHandler);
+            {
+                QMutexLocker locker(&sJobMessagesMutex);
+                sJobMessages = nullptr;
+            }
+
+            rememberLoadedTilesets();
+
+            if (known) {
+                result.insert(QStringLiteral("messages"), QJsonArray::fromStringList(messages));
+                response.insert(QStringLiteral("result"), result);
+            } else {
+                const QString error = QStringLiteral("Unknown method '%1'").arg(method);
+                response.insert(QStringLiteral("error"), QJsonObject { { QStringLiteral("message"), error } });
+            }
+        }
+
+        stdOut() << QJsonDocument(response).toJson(QJsonDocument::Compact) << Qt::endl;
+
+        // Lets file watchers and deferred deletes do their work between jobs
+        QCoreApplication::processEvents();
+    }
+
+    return 0;
+}
+
+/**
+ * Runs a single job, setting at least "success" in the \a result. Returns
+ * false when the \a method is not known.
+ */
+bool JobServer::runJob(const QString &method, const QJsonObject &params, QJsonObject &result)
+{
+    auto string = [&] (const char *name) {
+        return params.value(QLatin1String(name)).toString();
+    };
+
+    bool success = false;
+
+    if (method == QLatin1String("exportMap")) {
+        const QString format = string("format");
+        const QString *filter = format.isEmpty() ? nullptr : &format;
+
+        if (params.contains(QLatin1String("source"))) {
+            success = exportMapFile(filter, string("source"), string("target"),
+                                    mExportOptions, mLoadedTilesets);
+        } else {
+            // Without a source, export the maps of the project
+            const bool incremental = params.value(QLatin1String("incremental")).toBool();
+            success = exportProjectMaps(mExportOptions, incremental, mLoadedTilesets);
+        }
+    } else if (method == QLatin1String("exportTileset")) {
+        const QString format = string("format");
+        const QString *filter = format.isEmpty() ? nullptr : &format;
+        success = exportTilesetFile(filter, string("source"), string("target"), mExportOptions);
+    } else if (method == QLatin1String("packTileset")) {
+        success = packTilesetFile(string("source"), string("target"), mExportOptions);
+    } else if (method == QLatin1String("autoMap")) {
+        QStringList maps;
+        const QJsonArray mapsArray = params.value(QLatin1String("maps")).toArray();
+        for (const QJsonValue &value : mapsArray)
+            maps.append(value.toString());
+
+        success = autoMapFiles(mAutomappingManager, string("rules"), maps, mLoadedTilesets);
+    } else if (method == QLatin1String("diffMaps")) {
+        if (const std::optional<MapDiff> diff = compareMapFiles(string("old"), string("new"))) {
+            result.insert(QStringLiteral("same"), diff->isEmpty());
+            result.insert(QStringLiteral("diff"), QJsonObject::fromVariantMap(diff->toVariant()));
+            success = true;
+        }
+    } else if (method == QLatin1String("validate")) {
+        const QString project = params.contains(QLatin1String("project")) ? string("project")
+                                                                          : Preferences::startupProject();
+        success = validateProjectMaps(project);
+    } else {
+        return false;
+    }
+
+    result.insert(QStringLiteral("success"), success);
+    return true;
+}
+
+/**
+ * Releases the tilesets whose file changed since they were loaded, so that
+ * the next job loads them again.
+ */
+void JobServer::releaseChangedTilesets()
+{
+    for (auto it = mTilesetModified.begin(); it != mTilesetModified.end(); ) {
+        if (QFileInfo(it.key()->fileName()).lastModified() != it.value()) {
+            mLoadedTilesets.remove(it.key());
+            it = mTilesetModified.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void JobServer::rememberLoadedTilesets()
+{
+    for (const SharedTileset &tileset : std::as_const(mLoadedTilesets))
+        if (!mTilesetModified.contains(tileset))
+            mTilesetModified.insert(tileset, QFileInfo(tileset->fileName()).lastModified());
+}
+
 
 } // anonymous namespace
 
@@ -209,6 +1012,11 @@ CommandLineHandler::CommandLineHandler()
                 QLatin1String("--project"),
                 tr("Project file to load"));
 
+    option<&CommandLineHandler::addResourceArchive>(
+                QChar(),
+                QLatin1String("--resource-archive"),
+                tr("Make the files in a packed .rcc archive available under :/<archive name>/"));
+
     option<&CommandLineHandler::setExportMap>(
                 QChar(),
                 QLatin1String("--export-map"),
@@ -219,6 +1027,36 @@ CommandLineHandler::CommandLineHandler()
                 QLatin1String("--export-tileset"),
                 tr("Export the specified tileset file to target"));
 
+    option<&CommandLineHandler::setPackTileset>(
+                QChar(),
+                QLatin1String("--pack-tileset"),
+                tr("Pack the images of the specified image collection tileset into atlases, saving it as target"));
+
+    option<&CommandLineHandler::setAutoMap>(
+                QChar(),
+                QLatin1String("--automap"),
+                tr("Apply the specified AutoMapping rules to the given maps"));
+
+    option<&CommandLineHandler::setRandomSeed>(
+                QChar(),
+                QLatin1String("--random-seed"),
+                tr("Seed for random choices, making AutoMapping results reproducible"));
+
+    option<&CommandLineHandler::setValidateProject>(
+                QChar(),
+                QLatin1String("--validate"),
+                tr("Check the maps of the project for broken links, unknown property types and invalid tiles"));
+
+    option<&CommandLineHandler::setDiffMaps>(
+                QChar(),
+                QLatin1String("--diff-maps"),
+                tr("Print the differences between two maps as JSON"));
+
+    option<&CommandLineHandler::setServe>(
+                QChar(),
+                QLatin1String("--serve"),
+                tr("Run jobs read as JSON lines from the standard input, keeping loaded files between jobs"));
+
     option<&CommandLineHandler::showExportFormats>(
                 QChar(),
                 QLatin1String("--export-formats"),
@@ -249,6 +1087,26 @@ CommandLineHandler::CommandLineHandler()
                 QLatin1String("--minimize"),
                 tr("Minimize the exported file by omitting unnecessary whitespace"));
 
+    option<&CommandLineHandler::setSkipUnchanged>(
+                QChar(),
+                QLatin1String("--skip-unchanged"),
+                tr("Don't rewrite exported files when their contents did not change"));
+
+    option<&CommandLineHandler::setIncremental>(
+                QChar(),
+                QLatin1String("--incremental"),
+                tr("When exporting a project, only export maps whose inputs changed since the last incremental export"));
+
+    option<&CommandLineHandler::setJobs>(
+                QChar(),
+                QLatin1String("--jobs"),
+                tr("Export the given maps using this many worker processes (0 for one per core)"));
+
+    option<&CommandLineHandler::setImageCache>(
+                QChar(),
+                QLatin1String("--image-cache"),
+                tr("Directory in which decoded images are cached between runs"));
+
     option<&CommandLineHandler::startNewInstance>(
                 QChar(),
                 QLatin1String("--new-instance"),
@@ -296,6 +1154,26 @@ void CommandLineHandler::setProject()
     }
 }
 
+void CommandLineHandler::addResourceArchive()
+{
+    const QString archiveFile = nextArgument();
+    if (archiveFile.isEmpty()) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Missing argument, add an archive using: --resource-archive <.rcc file>");
+        justQuit();
+        return;
+    }
+
+    // The archive's directory is loaded once and its files are read from
+    // memory, avoiding many file system round trips for its contents
+    const QFileInfo fileInfo(archiveFile);
+    const QString mapRoot = QLatin1Char('/') + fileInfo.completeBaseName();
+
+    if (!QResource::registerResource(fileInfo.absoluteFilePath(), mapRoot)) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load resource archive '%1'.").arg(archiveFile);
+        justQuit();
+    }
+}
+
 void CommandLineHandler::setExportMap()
 {
     exportMap = true;
@@ -306,6 +1184,44 @@ void CommandLineHandler::setExportTileset()
     exportTileset = true;
 }
 
+void CommandLineHandler::setPackTileset()
+{
+    packTileset = true;
+}
+
+void CommandLineHandler::setAutoMap()
+{
+    autoMap = true;
+}
+
+void CommandLineHandler::setValidateProject()
+{
+    validateProject = true;
+}
+
+void CommandLineHandler::setDiffMaps()
+{
+    diffMaps = true;
+}
+
+void CommandLineHandler::setServe()
+{
+    serve = true;
+}
+
+void CommandLineHandler::setRandomSeed()
+{
+    bool ok;
+    const quint32 seed = nextArgument().toUInt(&ok);
+    if (!ok) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Missing or invalid argument, set a number using: --random-seed <number>");
+        justQuit();
+        return;
+    }
+
+    seedGlobalRandomEngine(seed);
+}
+
 void CommandLineHandler::setExportEmbedTilesets()
 {
     exportOptions |= Preferences::EmbedTilesets;
@@ -326,6 +1242,41 @@ void CommandLineHandler::setExportMinimized()
     exportOptions |= Preferences::ExportMinimized;
 }
 
+void CommandLineHandler::setSkipUnchanged()
+{
+    SaveFile::setSkipUnchangedFiles(true);
+}
+
+void CommandLineHandler::setIncremental()
+{
+    incremental = true;
+}
+
+void CommandLineHandler::setJobs()
+{
+    bool ok;
+    const int count = nextArgument().toInt(&ok);
+    if (!ok || count < 0) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Missing or invalid argument, set the number of worker processes using: --jobs <number>");
+        justQuit();
+        return;
+    }
+
+    jobs = count > 0 ? count : QThread::idealThreadCount();
+}
+
+void CommandLineHandler::setImageCache()
+{
+    const QString directory = nextArgument();
+    if (directory.isEmpty()) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Missing argument, set a directory using: --image-cache <directory>");
+        justQuit();
+        return;
+    }
+
+    ImageCache::setDiskCacheDirectory(directory);
+}
+
 void CommandLineHandler::showExportFormats()
 {
     initializePluginsAndExtensions();
@@ -451,9 +1402,15 @@ int main(int argc, char *argv[])
     QCoreApplication::setAttribute(Qt::AA_DontShowIconsInMenus);
 #endif
 
+    // Opt-in tracing of the startup and loading phases
+    Tracer::start(qEnvironmentVariable("TILED_TRACE"));
+    const auto finishTrace = qScopeGuard([] { Tracer::finish(); });
+
     Tiled::increaseImageAllocationLimit();
 
+    const qint64 applicationStart = Tracer::now();
     TiledApplication a(argc, argv);
+    Tracer::addEvent("TiledApplication", applicationStart);
 
 #ifdef TILED_SENTRY
     Sentry sentry;
@@ -480,95 +1437,113 @@ int main(int argc, char *argv[])
     if (commandLine.disableOpenGL)
         Preferences::instance()->setUseOpenGL(false);
 
+    if (commandLine.serve) {
+        initializePluginsAndExtensions();
+
+        JobServer server(commandLine.exportOptions);
+        return server.exec();
+    }
+
     if (commandLine.exportMap) {
-        // Get the path to the source file and target file
-        if (commandLine.exportTileset || commandLine.filesToOpen().length() < 2) {
-            qWarning().noquote() << QCoreApplication::translate("Command line", "Export syntax is --export-map [format] <source> <target>");
+        // Get the path to the source files and target files
+        const QStringList &files = commandLine.filesToOpen();
+        const bool exportProject = files.isEmpty() && !Preferences::startupProject().isEmpty();
+        if (commandLine.exportTileset || (files.length() < 2 && !exportProject)) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Export syntax is --export-map [format] <source> <target> [<source> <target>...], or --project <project> --export-map");
             return 1;
         }
 
-        initializePluginsAndExtensions();
-
+        // With an odd number of files, the first one is the format
         int index = 0;
-        const QString *filter = commandLine.filesToOpen().length() > 2 ? &commandLine.filesToOpen().at(index++) : nullptr;
-        const QString &sourceFile = commandLine.filesToOpen().at(index++);
-        const QString &targetFile = commandLine.filesToOpen().at(index++);
+        const QString *filter = files.length() % 2 ? &files.at(index++) : nullptr;
 
-        QString errorMsg;
-        MapFormat *outputFormat = findExportFormat<MapFormat>(filter, targetFile, errorMsg);
-        if (!outputFormat) {
-            Q_ASSERT(!errorMsg.isEmpty());
-            qWarning().noquote() << errorMsg;
-            return 1;
-        }
+        // The workers load the plugins and extensions themselves
+        if (!exportProject && commandLine.jobs > 1 && files.length() - index > 2)
+            return exportMapFilesInWorkers(files, commandLine.jobs) ? 0 : 1;
 
-        // Load the source file
-        const std::unique_ptr<Map> sourceMap(readMap(sourceFile, &errorMsg));
-        if (!sourceMap) {
-            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load source map.");
-            if (!errorMsg.isEmpty())
-                qWarning().noquote() << errorMsg;
-            return 1;
-        }
+        initializePluginsAndExtensions();
 
-        // Apply export options
-        std::unique_ptr<Map> exportMap;
-        ExportHelper exportHelper(commandLine.exportOptions);
-        const Map *map = exportHelper.prepareExportMap(sourceMap.get(), exportMap);
+        // Shared between the exported maps, to load each tileset only once
+        LoadedTilesets loadedTilesets;
 
-        // Write out the file
-        bool success = outputFormat->write(map, targetFile, exportHelper.formatOptions());
+        if (exportProject)
+            return exportProjectMaps(commandLine.exportOptions, commandLine.incremental, loadedTilesets) ? 0 : 1;
 
-        if (!success) {
-            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to export map to target file.");
-            return 1;
-        }
-        return 0;
+        bool success = true;
+
+        for (; index + 1 < files.length(); index += 2)
+            success &= exportMapFile(filter, files.at(index), files.at(index + 1), commandLine.exportOptions, loadedTilesets);
+
+        return success ? 0 : 1;
     }
 
     if (commandLine.exportTileset) {
-        // Get the path to the source file and target file
-        if (commandLine.filesToOpen().length() < 2) {
-            qWarning().noquote() << QCoreApplication::translate("Command line", "Export syntax is --export-tileset [format] <source> <target>");
+        // Get the path to the source files and target files
+        const QStringList &files = commandLine.filesToOpen();
+        if (files.length() < 2) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Export syntax is --export-tileset [format] <source> <target> [<source> <target>...]");
             return 1;
         }
 
         initializePluginsAndExtensions();
 
+        // With an odd number of files, the first one is the format
         int index = 0;
-        const QString *filter = commandLine.filesToOpen().length() > 2 ? &commandLine.filesToOpen().at(index++) : nullptr;
-        const QString &sourceFile = commandLine.filesToOpen().at(index++);
-        const QString &targetFile = commandLine.filesToOpen().at(index++);
+        const QString *filter = files.length() % 2 ? &files.at(index++) : nullptr;
+        bool success = true;
 
-        QString errorMsg;
-        TilesetFormat *outputFormat = findExportFormat<TilesetFormat>(filter, targetFile, errorMsg);
-        if (!outputFormat) {
-            Q_ASSERT(!errorMsg.isEmpty());
-            qWarning().noquote() << errorMsg;
+        for (; index + 1 < files.length(); index += 2)
+            success &= exportTilesetFile(filter, files.at(index), files.at(index + 1), commandLine.exportOptions);
+
+        return success ? 0 : 1;
+    }
+
+    if (commandLine.packTileset) {
+        const QStringList &files = commandLine.filesToOpen();
+        if (files.length() != 2) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Pack syntax is --pack-tileset <source> <target>");
             return 1;
         }
 
-        // Load the source file
-        SharedTileset sourceTileset(readTileset(sourceFile, &errorMsg));
-        if (!sourceTileset) {
-            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load source tileset.");
-            if (!errorMsg.isEmpty())
-                qWarning().noquote() << errorMsg;
+        initializePluginsAndExtensions();
+
+        return packTilesetFile(files.at(0), files.at(1), commandLine.exportOptions) ? 0 : 1;
+    }
+
+    if (commandLine.autoMap) {
+        // Get the path to the rules file and the maps
+        if (commandLine.filesToOpen().length() < 2) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "AutoMap syntax is --automap <rules file> <map>...");
             return 1;
         }
 
-        // Apply export options
-        ExportHelper exportHelper(commandLine.exportOptions);
-        SharedTileset exportTileset = exportHelper.prepareExportTileset(sourceTileset);
+        initializePluginsAndExtensions();
+
+        const QStringList &files = commandLine.filesToOpen();
+        AutomappingManager manager;
+        LoadedTilesets loadedTilesets;
+        return autoMapFiles(manager, files.first(), files.mid(1), loadedTilesets) ? 0 : 1;
+    }
+
+    if (commandLine.diffMaps) {
+        const QStringList &files = commandLine.filesToOpen();
+        if (files.length() != 2) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Diff syntax is --diff-maps <old map> <new map>");
+            return 2;
+        }
+
+        initializePluginsAndExtensions();
 
-        // Write out the file
-        bool success = outputFormat->write(*exportTileset, targetFile, exportHelper.formatOptions());
+        return diffMapFiles(files.at(0), files.at(1));
+    }
 
-        if (!success) {
-            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to export tileset to target file.");
+    if (commandLine.validateProject) {
+        if (Preferences::startupProject().isEmpty()) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Validate syntax is --project <project> --validate");
             return 1;
         }
-        return 0;
+
+        return validateProjectMaps(Preferences::startupProject()) ? 0 : 1;
     }
 
     QStringList filesToOpen;
@@ -605,8 +1580,10 @@ int main(int argc, char *argv[])
     Session::initialize();
     StyleHelper::initialize();
 
+    const qint64 mainWindowStart = Tracer::now();
     MainWindow w;
     w.show();
+    Tracer::addEvent("MainWindow", mainWindowStart);
 
     a.setActivationWindow(&w);
 #ifdef Q_OS_WIN
@@ -98,7 +98,14 @@ ApplicationWindow {
 
 
     Text {
-        text: mapLoader.status === Tiled.MapLoader.Null ? qsTr("No map file loaded") : mapLoader.error
+        text: {
+            if (mapLoader.status === Tiled.MapLoader.Null)
+                qsTr("No map file loaded")
+            else if (mapLoader.status === Tiled.MapLoader.Loading)
+                qsTr("Loading map...")
+            else
+                mapLoader.error
+        }
         anchors.centerIn: parent
     }
 
@@ -213,6 +213,8 @@ ApplicationWindow {
                         qsTr("No map file loaded")
                     } else if (mapLoader.status === Tiled.MapLoader.Error) {
                         mapLoader.error
+                    } else if (mapLoader.status === Tiled.MapLoader.Loading) {
+                        qsTr("Loading map...")
                     } else {
                         var mapRelativeCoords = singleFingerPanArea.mapToItem(mapItem, singleFingerPanArea.mouseX, singleFingerPanArea.mouseY)
                         var tileCoords = mapItem.screenToTileCoords(mapRelativeCoords.x, mapRelativeCoords.y)
@@ -26,6 +26,7 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "imagecache.h"
 #include "pluginmanager.h"
 #include "tmxrasterizer.h"
 #include "tmxmapformat.h"
@@ -105,6 +106,17 @@ int main(int argc, char *argv[])
                           { QStringLiteral("frame-duration"),
                             QCoreApplication::translate("main", "Duration of each frame in milliseconds, defaults to 100."),
                             QCoreApplication::translate("main", "number") },
+                          { QStringLiteral("region"),
+                            QCoreApplication::translate("main", "Only renders the given region of a world, in pixels. Maps outside of this region are not loaded."),
+                            QCoreApplication::translate("main", "x,y,width,height") },
+                          { QStringLiteral("split"),
+                            QCoreApplication::translate("main", "Renders a map in SIZE x SIZE pieces, saved to separate images with the column and row added to their names. Allows rendering maps too large for a single image."),
+                            QCoreApplication::translate("main", "size") },
+                          { QStringLiteral("image-cache"),
+                            QCoreApplication::translate("main", "Directory in which decoded images are cached between runs, to avoid decoding shared tileset images again."),
+                            QCoreApplication::translate("main", "directory") },
+                          { QStringLiteral("gpu"),
+                            QCoreApplication::translate("main", "Renders maps on the GPU using an offscreen OpenGL context, when available.") },
                       });
     parser.addPositionalArgument(QStringLiteral("map|world"), QCoreApplication::translate("main", "Map or world file to render."));
     parser.addPositionalArgument(QStringLiteral("image"), QCoreApplication::translate("main", "Image file to output."));
@@ -120,10 +132,14 @@ int main(int argc, char *argv[])
     if (fileToOpen.isEmpty() || fileToSave.isEmpty())
         parser.showHelp(1);
 
+    if (parser.isSet(QLatin1String("image-cache")))
+        ImageCache::setDiskCacheDirectory(parser.value(QLatin1String("image-cache")));
+
     TmxRasterizer w;
     w.setAntiAliasing(parser.isSet(QLatin1String("anti-aliasing")));
     w.setSmoothImages(!parser.isSet(QLatin1String("no-smoothing")));
     w.setIgnoreVisibility(parser.isSet(QLatin1String("ignore-visibility")));
+    w.setUseGpu(parser.isSet(QLatin1String("gpu")));
     w.setLayersToHide(parser.values(QLatin1String("hide-layer")));
     w.setLayersToShow(parser.values(QLatin1String("show-layer")));
     w.setLayerTypeVisible(Layer::TileLayerType, !parser.isSet(QLatin1String("hide-tile-layers")));
@@ -186,5 +202,28 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (parser.isSet(QLatin1String("region"))) {
+        const QStringList values = parser.value(QLatin1String("region")).split(QLatin1Char(','));
+        bool ok = values.size() == 4;
+        int region[4] = {};
+        for (int i = 0; ok && i < 4; ++i)
+            region[i] = values.at(i).trimmed().toInt(&ok);
+
+        w.setRegion(QRect(region[0], region[1], region[2], region[3]));
+        if (!ok || w.region().isEmpty()) {
+            qWarning().noquote() << QCoreApplication::translate("main", "Invalid region specified: \"%1\"").arg(parser.value(QLatin1String("region")));
+            exit(1);
+        }
+    }
+
+    if (parser.isSet(QLatin1String("split"))) {
+        bool ok;
+        w.setSplitSize(parser.value(QLatin1String("split")).toInt(&ok));
+        if (!ok || w.splitSize() <= 0) {
+            qWarning().noquote() << QCoreApplication::translate("main", "Invalid split size specified: \"%1\"").arg(parser.value(QLatin1String("split")));
+            exit(1);
+        }
+    }
+
     return w.render(fileToOpen, fileToSave);
 }
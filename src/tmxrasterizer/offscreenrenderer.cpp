@@ -0,0 +1,171 @@
+/*
+ * offscreenrenderer.cpp
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ *
+ * This file is part of the TMX Rasterizer.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "offscreenrenderer.h"
+
+#include <QPainter>
+
+#ifndef QT_NO_OPENGL
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLPaintDevice>
+#endif
+
+#include <algorithm>
+
+#ifndef QT_NO_OPENGL
+/**
+ * The maximum width and height of the framebuffer, to limit the amount of
+ * GPU memory used for large images.
+ */
+static constexpr int MaximumPieceSize = 4096;
+#endif
+
+OffscreenRenderer::OffscreenRenderer() = default;
+
+OffscreenRenderer::~OffscreenRenderer()
+{
+#ifndef QT_NO_OPENGL
+    // The context needs to be destroyed before its surface
+    mContext.reset();
+#endif
+}
+
+/**
+ * Creates the OpenGL context and offscreen surface. Returns whether this
+ * succeeded, which depends on the platform plugin supporting OpenGL.
+ */
+bool OffscreenRenderer::create()
+{
+#ifndef QT_NO_OPENGL
+    auto context = std::make_unique<QOpenGLContext>();
+    if (!context->create())
+        return false;
+
+    auto surface = std::make_unique<QOffscreenSurface>();
+    surface->setFormat(context->format());
+    surface->create();
+    if (!surface->isValid() || !context->makeCurrent(surface.get()))
+        return false;
+
+    GLint maxTextureSize = 0;
+    GLint maxRenderbufferSize = 0;
+    QOpenGLFunctions *gl = context->functions();
+    gl->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    gl->glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbufferSize);
+    context->doneCurrent();
+
+    const int maxPieceSize = std::min({ MaximumPieceSize,
+                                        int(maxTextureSize),
+                                        int(maxRenderbufferSize) });
+    if (maxPieceSize <= 0)
+        return false;
+
+    mContext = std::move(context);
+    mSurface = std::move(surface);
+    mMaxPieceSize = maxPieceSize;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Renders an image of the given \a size, calling \a paint for each piece
+ * drawn on the framebuffer. With \a samples larger than 0, a multisampled
+ * framebuffer is used for antialiasing.
+ *
+ * Returns a null image when the framebuffer could not be created.
+ */
+QImage OffscreenRenderer::render(const QSize &size, int samples, const PaintFunction &paint)
+{
+#ifndef QT_NO_OPENGL
+    if (!isValid() || size.isEmpty() || !mContext->makeCurrent(mSurface.get()))
+        return QImage();
+
+    const QSize pieceSize(std::min(size.width(), mMaxPieceSize),
+                          std::min(size.height(), mMaxPieceSize));
+
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    format.setSamples(samples);
+
+    // A single framebuffer is reused for all pieces
+    QOpenGLFramebufferObject framebuffer(pieceSize, format);
+    if (!framebuffer.isValid()) {
+        mContext->doneCurrent();
+        return QImage();
+    }
+
+    QOpenGLFunctions *gl = mContext->functions();
+    QImage image;
+
+    if (pieceSize != size)
+        image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+
+    for (int y = 0; y < size.height(); y += pieceSize.height()) {
+        for (int x = 0; x < size.width(); x += pieceSize.width()) {
+            const QRect piece = QRect(QPoint(x, y), pieceSize) & QRect(QPoint(), size);
+
+            framebuffer.bind();
+            gl->glClearColor(0, 0, 0, 0);
+            gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+            {
+                QOpenGLPaintDevice device(pieceSize);
+                QPainter painter(&device);
+                paint(painter, piece);
+            }
+
+            const QImage pieceImage = framebuffer.toImage();
+
+            if (pieceSize == size) {
+                image = pieceImage;
+            } else {
+                // Pieces at the right and bottom edges may be only partially used
+                QPainter painter(&image);
+                painter.setCompositionMode(QPainter::CompositionMode_Source);
+                painter.drawImage(piece.topLeft(), pieceImage, QRect(QPoint(), piece.size()));
+            }
+        }
+    }
+
+    framebuffer.release();
+    mContext->doneCurrent();
+
+    return image;
+#else
+    Q_UNUSED(size);
+    Q_UNUSED(samples);
+    Q_UNUSED(paint);
+    return QImage();
+#endif
+}
@@ -0,0 +1,70 @@
+/*
+ * offscreenrenderer.h
+ * Copyright 2026, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ *
+ * This file is part of the TMX Rasterizer.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <QImage>
+#include <QRect>
+
+#include <functional>
+#include <memory>
+
+class QOffscreenSurface;
+class QOpenGLContext;
+class QPainter;
+
+/**
+ * Paints on an offscreen OpenGL framebuffer, which does not require a
+ * window or display. The result is read back in pieces no larger than the
+ * framebuffer size supported by the driver.
+ */
+class OffscreenRenderer
+{
+public:
+    OffscreenRenderer();
+    ~OffscreenRenderer();
+
+    bool create();
+    bool isValid() const { return mMaxPieceSize > 0; }
+
+    /**
+     * Paints the piece of the image at the given rectangle, in image
+     * coordinates, with the painter's origin at the top-left of the piece.
+     */
+    using PaintFunction = std::function<void (QPainter &painter, const QRect &piece)>;
+
+    QImage render(const QSize &size, int samples, const PaintFunction &paint);
+
+private:
+#ifndef QT_NO_OPENGL
+    std::unique_ptr<QOffscreenSurface> mSurface;
+    std::unique_ptr<QOpenGLContext> mContext;
+#endif
+    int mMaxPieceSize = 0;
+};
@@ -32,7 +32,9 @@
 #include "imagelayer.h"
 #include "map.h"
 #include "mapformat.h"
+#include "mapobject.h"
 #include "objectgroup.h"
+#include "tile.h"
 #include "tilelayer.h"
 #include "tilesetmanager.h"
 #include "world.h"
@@ -40,16 +42,35 @@
 #include <QDebug>
 #include <QFileInfo>
 #include <QImageWriter>
+#include <QSet>
+#include <QThread>
+#include <QtConcurrent>
 
+#include <algorithm>
 #include <memory>
 
 using namespace Tiled;
 
-TmxRasterizer::TmxRasterizer() = default;
+/**
+ * The minimum height in pixels of the bands in which the image is split for
+ * drawing it in parallel.
+ */
+static constexpr int MinimumBandHeight = 128;
 
+TmxRasterizer::TmxRasterizer()
+{
+    // Only the images of tiles that are actually drawn need to be loaded
+    TilesetManager::instance()->setLazyImageLoading(true);
+}
+
+/**
+ * Draws the layers of the map. When an \a exposed rectangle (in pixels) is
+ * given, tile layers only draw the cells that may be visible within it.
+ */
 void TmxRasterizer::drawMapLayers(const MapRenderer &renderer,
                                   QPainter &painter,
-                                  QPoint mapOffset) const
+                                  QPoint mapOffset,
+                                  const QRectF &exposed) const
 {
     // Perform a similar rendering than found in minimaprenderer.cpp
     LayerIterator iterator(renderer.map());
@@ -66,16 +87,12 @@ void TmxRasterizer::drawMapLayers(const MapRenderer &renderer,
         auto *objectGroup = dynamic_cast<const ObjectGroup*>(layer);
 
         if (tileLayer) {
-            renderer.drawTileLayer(&painter, tileLayer);
+            renderer.drawTileLayer(&painter, tileLayer,
+                                   exposed.isNull() ? QRectF() : exposed.translated(-offset));
         } else if (imageLayer) {
             renderer.drawImageLayer(&painter, imageLayer);
         } else if (objectGroup) {
-            QList<MapObject*> objects = objectGroup->objects();
-
-            if (objectGroup->drawOrder() == ObjectGroup::TopDownOrder)
-                std::stable_sort(objects.begin(), objects.end(), [](MapObject *a, MapObject *b){return a->y() < b->y();});
-
-            for (const MapObject *object : std::as_const(objects)) {
+            for (const MapObject *object : objectGroup->objectsInDrawOrder()) {
                 if (shouldDrawObject(object)) {
                     if (object->rotation() != qreal(0)) {
                         QPointF origin = renderer.pixelToScreenCoords(object->position());
@@ -166,33 +183,238 @@ int TmxRasterizer::render(const QString &fileName,
         }
 
         renderer = MapRenderer::create(map.get());
+
+        if (mUseGpu && !mOffscreenRenderer) {
+            auto offscreenRenderer = std::make_unique<OffscreenRenderer>();
+            if (offscreenRenderer->create())
+                mOffscreenRenderer = std::move(offscreenRenderer);
+            else
+                qWarning("Unable to create an OpenGL context, falling back to software rendering");
+        }
     }
 
+    QStringList imageFileNames;
+
     for (int frame = 0; frame < frameCount; ++frame) {
         if (mFrameCount > 0) {
             imageFileName = QString(QLatin1String("%1/%2%3.%4"))
                     .arg(imagePath, imageBaseName, QString::number(frame), imageSuffix);
         }
 
-        int ret;
+        imageFileNames.append(imageFileName);
+    }
+
+    if (map && mSplitSize > 0) {
+        for (int frame = 0; frame < frameCount; ++frame) {
+            const int advance = frame == 0 ? mAdvanceAnimations : mFrameDuration;
+            if (advance > 0)
+                TilesetManager::instance()->advanceTileAnimations(advance);
 
-        if (map) {
-            ret = renderMap(*renderer, imageFileName);
-            mAdvanceAnimations = mFrameDuration;
-        } else {
-            ret = renderWorld(fileName, imageFileName);
-            mAdvanceAnimations = mAdvanceAnimations + mFrameDuration;
+            if (int ret = renderMapTiles(*renderer, imageFileNames.at(frame)))
+                return ret;
         }
+        return 0;
+    }
+
+    if (map)
+        return renderMap(*renderer, imageFileNames);
 
-        if (ret)
+    for (const QString &imageFileName : std::as_const(imageFileNames)) {
+        if (int ret = renderWorld(fileName, imageFileName))
             return ret;
+
+        mAdvanceAnimations = mAdvanceAnimations + mFrameDuration;
     }
 
     return 0;
 }
 
+/**
+ * Renders the map to each of the given \a imageFileNames, advancing the tile
+ * animations by the frame duration between frames.
+ *
+ * Only the first frame is drawn completely, in parallel for larger images
+ * (see drawMap). Each following frame starts from a copy of the previous
+ * one, in which only the area showing animated tiles is cleared and drawn
+ * again. Frames are saved in parallel, while the next
+ * frame is being drawn.
+ */
 int TmxRasterizer::renderMap(const MapRenderer &renderer,
-                             const QString &imageFileName)
+                             const QStringList &imageFileNames)
+{
+    QSize mapSize;
+    const QTransform transform = mapTransform(renderer, mapSize);
+
+    QImage image(mapSize, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+
+    // Only relevant when rendering multiple frames
+    const QRegion animatedRegion = imageFileNames.size() > 1 ? animatedArea(renderer)
+                                                              : QRegion();
+
+    QVector<QFuture<int>> pendingSaves;
+
+    for (int frame = 0; frame < imageFileNames.size(); ++frame) {
+        const int advance = frame == 0 ? mAdvanceAnimations : mFrameDuration;
+        if (advance > 0)
+            TilesetManager::instance()->advanceTileAnimations(advance);
+
+        // Without animated tiles, the previous frame is saved again
+        if (frame == 0) {
+            drawMap(renderer, image, transform);
+        } else if (!animatedRegion.isEmpty()) {
+            // Painting detaches the image from the copy that is still being saved
+            QPainter painter(&image);
+
+            painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
+            painter.setTransform(transform);
+
+            painter.setClipRegion(animatedRegion);
+            painter.setCompositionMode(QPainter::CompositionMode_Clear);
+            painter.fillRect(animatedRegion.boundingRect(), Qt::transparent);
+            painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+            drawMapLayers(renderer, painter);
+        }
+
+        pendingSaves.append(QtConcurrent::run([this, fileName = imageFileNames.at(frame), image] {
+            return saveImage(fileName, image);
+        }));
+    }
+
+    int ret = 0;
+    for (const QFuture<int> &save : std::as_const(pendingSaves))
+        ret = qMax(ret, save.result());
+
+    return ret;
+}
+
+/**
+ * Makes sure the images of the tiles in the layers that will be drawn are
+ * loaded, since images that are loaded on demand can only be loaded on the
+ * main thread.
+ */
+void TmxRasterizer::loadTileImages(const Map *map) const
+{
+    LayerIterator iterator(map);
+    while (const Layer *layer = iterator.next()) {
+        if (!shouldDrawLayer(layer))
+            continue;
+
+        if (auto tileLayer = dynamic_cast<const TileLayer*>(layer)) {
+            for (const Cell &cell : *tileLayer)
+                if (const Tile *tile = cell.tile())
+                    tile->image();
+        } else if (auto objectGroup = dynamic_cast<const ObjectGroup*>(layer)) {
+            for (const MapObject *object : objectGroup->objects())
+                if (shouldDrawObject(object))
+                    if (const Tile *tile = object->cell().tile())
+                        tile->image();
+        }
+    }
+}
+
+/**
+ * Draws the whole map to \a image, using the given \a transform from map
+ * pixels to image pixels.
+ *
+ * Larger images are split in horizontal bands, which are drawn in parallel,
+ * each with its own painter and renderer. Tiles extending into neighboring
+ * bands are drawn by each of them and clipped to the band.
+ */
+void TmxRasterizer::drawMap(const MapRenderer &renderer,
+                            QImage &image,
+                            const QTransform &transform) const
+{
+    if (mOffscreenRenderer) {
+        const QImage drawn = drawMapOffscreen(renderer, image.rect(), transform);
+        if (!drawn.isNull()) {
+            image = drawn;
+            return;
+        }
+    }
+
+    const int bandCount = qBound(1, image.height() / MinimumBandHeight,
+                                 QThread::idealThreadCount());
+
+    if (bandCount == 1) {
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
+        painter.setTransform(transform);
+
+        drawMapLayers(renderer, painter);
+        return;
+    }
+
+    loadTileImages(renderer.map());
+
+    // Update the cached draw order before it is used from several threads
+    for (const Layer *layer : renderer.map()->objectGroups())
+        static_cast<const ObjectGroup*>(layer)->objectsInDrawOrder();
+
+    QVector<QRect> bands;
+    for (int i = 0; i < bandCount; ++i) {
+        const int top = image.height() * i / bandCount;
+        const int bottom = image.height() * (i + 1) / bandCount;
+        bands.append(QRect(0, top, image.width(), bottom - top));
+    }
+
+    // Each band paints on its own image sharing the pixel data
+    uchar *bits = image.bits();
+    const qsizetype bytesPerLine = image.bytesPerLine();
+    const QTransform inverted = transform.inverted();
+
+    QtConcurrent::blockingMap(bands, [&] (const QRect &band) {
+        QImage bandImage(bits + band.top() * bytesPerLine,
+                         image.width(), band.height(), bytesPerLine,
+                         image.format());
+
+        // The renderer is not shared between threads
+        const auto bandRenderer = MapRenderer::create(renderer.map());
+        bandRenderer->setFlags(renderer.flags());
+
+        QPainter painter(&bandImage);
+        painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
+        painter.setTransform(transform * QTransform::fromTranslate(0, -band.top()));
+
+        drawMapLayers(*bandRenderer, painter, QPoint(0, 0),
+                      inverted.mapRect(QRectF(band)));
+    });
+}
+
+/**
+ * Draws the given \a rect of the image on the GPU, using the given
+ * \a transform from map pixels to image pixels. Tile layers only draw the
+ * cells that may be visible within the piece of the image being drawn.
+ *
+ * Returns a null image when the offscreen framebuffer could not be created.
+ */
+QImage TmxRasterizer::drawMapOffscreen(const MapRenderer &renderer,
+                                       const QRect &rect,
+                                       const QTransform &transform) const
+{
+    const QTransform inverted = transform.inverted();
+    const int samples = mUseAntiAliasing ? 4 : 0;
+
+    return mOffscreenRenderer->render(rect.size(), samples, [&] (QPainter &painter, const QRect &piece) {
+        const QRect imageRect = piece.translated(rect.topLeft());
+
+        painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
+        painter.setTransform(transform * QTransform::fromTranslate(-imageRect.x(), -imageRect.y()));
+
+        drawMapLayers(renderer, painter, QPoint(0, 0), inverted.mapRect(QRectF(imageRect)));
+    });
+}
+
+/**
+ * Returns the transform from map pixels to image pixels, based on the scale
+ * options. The size of the image is assigned to \a imageSize.
+ */
+QTransform TmxRasterizer::mapTransform(const MapRenderer &renderer, QSize &imageSize) const
 {
     const auto map = renderer.map();
     QRect mapBoundingRect = renderer.mapBoundingRect();
@@ -211,25 +433,139 @@ int TmxRasterizer::renderMap(const MapRenderer &renderer,
         xScale = yScale = mScale;
     }
 
-    if (mAdvanceAnimations > 0)
-        TilesetManager::instance()->advanceTileAnimations(mAdvanceAnimations);
-
     mapSize.rwidth() *= xScale;
     mapSize.rheight() *= yScale;
+    imageSize = mapSize;
 
-    QImage image(mapSize, QImage::Format_ARGB32);
-    image.fill(Qt::transparent);
-    QPainter painter(&image);
+    QTransform transform = QTransform::fromScale(xScale, yScale);
+    transform.translate(-mapBoundingRect.left(), -mapBoundingRect.top());
+    return transform;
+}
 
-    painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
-    painter.setTransform(QTransform::fromScale(xScale, yScale));
+/**
+ * Renders the map in square pieces of the split size, each saved to its own
+ * file with the column and row appended to the name, like "map_2_3.png".
+ *
+ * The pieces are drawn one at a time and saved on the thread pool. At most
+ * one piece per thread is waiting to be saved, so memory use doesn't depend
+ * on the size of the map.
+ */
+int TmxRasterizer::renderMapTiles(const MapRenderer &renderer,
+                                  const QString &imageFileName)
+{
+    QSize mapSize;
+    const QTransform transform = mapTransform(renderer, mapSize);
+    const QTransform inverted = transform.inverted();
 
-    painter.translate(-mapBoundingRect.left(), -mapBoundingRect.top());
+    const QFileInfo imageFileInfo(imageFileName);
+    const QString imagePath = imageFileInfo.path();
+    const QString imageBaseName = imageFileInfo.completeBaseName();
+    const QString imageSuffix = imageFileInfo.suffix();
 
-    drawMapLayers(renderer, painter);
+    const int columns = (mapSize.width() + mSplitSize - 1) / mSplitSize;
+    const int rows = (mapSize.height() + mSplitSize - 1) / mSplitSize;
+    const int maxPendingSaves = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
 
-    return saveImage(imageFileName, image);
+    QVector<QFuture<int>> pendingSaves;
+    int ret = 0;
+
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            const QRect rect = QRect(column * mSplitSize, row * mSplitSize, mSplitSize, mSplitSize)
+                    & QRect(QPoint(), mapSize);
+
+            QImage image;
+            if (mOffscreenRenderer)
+                image = drawMapOffscreen(renderer, rect, transform);
+
+            if (image.isNull()) {
+                image = QImage(rect.size(), QImage::Format_ARGB32);
+                image.fill(Qt::transparent);
+
+                QPainter painter(&image);
+                painter.setRenderHint(QPainter::Antialiasing, mUseAntiAliasing);
+                painter.setRenderHint(QPainter::SmoothPixmapTransform, mSmoothImages);
+                painter.setTransform(transform * QTransform::fromTranslate(-rect.x(), -rect.y()));
+
+                drawMapLayers(renderer, painter, QPoint(0, 0), inverted.mapRect(QRectF(rect)));
+            }
+
+            if (pendingSaves.size() >= maxPendingSaves)
+                ret = qMax(ret, pendingSaves.takeFirst().result());
+
+            const QString fileName = QString(QLatin1String("%1/%2_%3_%4.%5"))
+                    .arg(imagePath, imageBaseName, QString::number(column), QString::number(row), imageSuffix);
+
+            pendingSaves.append(QtConcurrent::run([this, fileName, image] {
+                return saveImage(fileName, image);
+            }));
+        }
+    }
+
+    for (const QFuture<int> &save : std::as_const(pendingSaves))
+        ret = qMax(ret, save.result());
+
+    return ret;
+}
+
+/**
+ * Returns the area of the map, in pixels, covered by animated tiles. This
+ * includes animated tile objects.
+ */
+QRegion TmxRasterizer::animatedArea(const MapRenderer &renderer) const
+{
+    const auto isAnimated = [] (const Cell &cell) {
+        const Tile *tile = cell.tile();
+        return tile && tile->isAnimated();
+    };
+
+    // Tiles may extend beyond their cell, and offsets may not be whole pixels
+    QMargins margins = renderer.map()->drawMargins();
+    margins += QMargins(1, 1, 1, 1);
+
+    QRegion area;
+
+    LayerIterator iterator(renderer.map());
+    while (const Layer *layer = iterator.next()) {
+        if (!shouldDrawLayer(layer))
+            continue;
+
+        const QPoint offset = layer->totalOffset().toPoint();
+
+        if (auto tileLayer = dynamic_cast<const TileLayer*>(layer)) {
+            const auto tilesets = tileLayer->usedTilesets();
+            const bool hasAnimatedTiles = std::any_of(tilesets.begin(), tilesets.end(), [] (const SharedTileset &tileset) {
+                const auto &tiles = tileset->tiles();
+                return std::any_of(tiles.begin(), tiles.end(), [] (const Tile *tile) { return tile->isAnimated(); });
+            });
+            if (!hasAnimatedTiles)
+                continue;
+
+            const QRegion cells = tileLayer->region(isAnimated);
+            for (const QRect &rect : cells)
+                area += renderer.boundingRect(rect).marginsAdded(margins).translated(offset);
+
+        } else if (auto objectGroup = dynamic_cast<const ObjectGroup*>(layer)) {
+            for (const MapObject *object : objectGroup->objects()) {
+                if (!shouldDrawObject(object) || !isAnimated(object->cell()))
+                    continue;
+
+                QRectF bounds = renderer.boundingRect(object);
+                if (object->rotation() != qreal(0)) {
+                    const QPointF origin = renderer.pixelToScreenCoords(object->position());
+                    QTransform transform;
+                    transform.translate(origin.x(), origin.y());
+                    transform.rotate(object->rotation());
+                    transform.translate(-origin.x(), -origin.y());
+                    bounds = transform.mapRect(bounds);
+                }
+
+                area += bounds.toAlignedRect().marginsAdded(QMargins(1, 1, 1, 1)).translated(offset);
+            }
+        }
+    }
+
+    return area;
 }
 
 
@@ -263,26 +599,39 @@ int TmxRasterizer::renderWorld(const QString &worldFileName,
         return 1;
     }
 
-    auto const maps = world->allMaps();
+    auto maps = world->allMaps();
     if (maps.isEmpty()) {
         qWarning("Error: The world file to rasterize contains no maps : \"%s\"",
                  qUtf8Printable(worldFileName));
         return 1;
     }
+
+    // The size of the maps is usually stored in the world, in which case
+    // they only need to be loaded for rendering
     QRect worldBoundingRect;
-    for (const WorldMapEntry &mapEntry : maps) {
-        std::unique_ptr<Map> map { readMap(mapEntry.fileName, &errorString) };
-        if (!map) {
-            qWarning("Error while reading \"%s\":\n%s",
-                     qUtf8Printable(mapEntry.fileName),
-                     qUtf8Printable(errorString));
-            continue;
+    for (WorldMapEntry &mapEntry : maps) {
+        if (mapEntry.rect.isEmpty()) {
+            std::unique_ptr<Map> map { readMap(mapEntry.fileName, &errorString) };
+            if (!map) {
+                qWarning("Error while reading \"%s\":\n%s",
+                         qUtf8Printable(mapEntry.fileName),
+                         qUtf8Printable(errorString));
+                continue;
+            }
+            const auto renderer = MapRenderer::create(map.get());
+            mapEntry.rect.setSize(renderer->mapBoundingRect().size());
         }
-        const auto renderer = MapRenderer::create(map.get());
-        QRect mapBoundingRect = renderer->mapBoundingRect();
-        mapBoundingRect.translate(mapEntry.rect.topLeft());
 
-        worldBoundingRect = worldBoundingRect.united(mapBoundingRect);
+        worldBoundingRect = worldBoundingRect.united(mapEntry.rect);
+    }
+
+    if (!mRegion.isEmpty())
+        worldBoundingRect &= mRegion;
+
+    if (worldBoundingRect.isEmpty()) {
+        qWarning("Error: No maps to render in \"%s\"",
+                 qUtf8Printable(worldFileName));
+        return 1;
     }
 
     QSize worldSize = worldBoundingRect.size();
@@ -307,7 +656,16 @@ int TmxRasterizer::renderWorld(const QString &worldFileName,
 
     painter.translate(-worldBoundingRect.topLeft());
 
-    for (const WorldMapEntry &mapEntry : maps) {
+    // Only draw the cells of tile layers within the requested region
+    const QRectF exposed = mRegion.isEmpty() ? QRectF() : QRectF(worldBoundingRect);
+
+    // Keep the tilesets loaded, since they are usually shared between maps
+    QSet<SharedTileset> usedTilesets;
+
+    for (const WorldMapEntry &mapEntry : std::as_const(maps)) {
+        if (!mapEntry.rect.intersects(worldBoundingRect))
+            continue;
+
         std::unique_ptr<Map> map { readMap(mapEntry.fileName, &errorString) };
         if (!map) {
             qWarning("Error while reading \"%s\":\n%s",
@@ -319,8 +677,11 @@ int TmxRasterizer::renderWorld(const QString &worldFileName,
             TilesetManager::instance()->advanceTileAnimations(mAdvanceAnimations);
 
         const auto renderer = MapRenderer::create(map.get());
-        drawMapLayers(*renderer, painter, mapEntry.rect.topLeft());
+        drawMapLayers(*renderer, painter, mapEntry.rect.topLeft(), exposed);
         TilesetManager::instance()->resetTileAnimations();
+
+        for (const SharedTileset &tileset : map->tilesets())
+            usedTilesets.insert(tileset);
     }
 
     return saveImage(imageFileName, image);
@@ -31,9 +31,15 @@
 #include "layer.h"
 
 #include "maprenderer.h"
+#include "offscreenrenderer.h"
 
+#include <QRect>
+#include <QRegion>
 #include <QString>
 #include <QStringList>
+#include <QTransform>
+
+#include <memory>
 
 using namespace Tiled;
 
@@ -51,9 +57,12 @@ public:
     int advanceAnimations() const { return mAdvanceAnimations; }
     int frameCount() const { return mFrameCount; }
     int frameDuration() const { return mFrameDuration; }
+    int splitSize() const { return mSplitSize; }
+    QRect region() const { return mRegion; }
     bool useAntiAliasing() const { return mUseAntiAliasing; }
     bool smoothImages() const { return mSmoothImages; }
     bool ignoreVisibility() const { return mIgnoreVisibility; }
+    bool useGpu() const { return mUseGpu; }
 
     void setScale(qreal scale) { mScale = scale; }
     void setTileSize(int tileSize) { mTileSize = tileSize; }
@@ -61,9 +70,12 @@ public:
     void setAdvanceAnimations(int duration) { mAdvanceAnimations = duration; }
     void setFrameCount(int frameCount) { mFrameCount = frameCount; }
     void setFrameDuration(int frameDuration) { mFrameDuration = frameDuration; }
+    void setSplitSize(int splitSize) { mSplitSize = splitSize; }
+    void setRegion(const QRect &region) { mRegion = region; }
     void setAntiAliasing(bool useAntiAliasing) { mUseAntiAliasing = useAntiAliasing; }
     void setSmoothImages(bool smoothImages) { mSmoothImages = smoothImages; }
     void setIgnoreVisibility(bool IgnoreVisibility) { mIgnoreVisibility = IgnoreVisibility; }
+    void setUseGpu(bool useGpu) { mUseGpu = useGpu; }
 
     void setLayersToHide(QStringList layersToHide) { mLayersToHide = layersToHide; }
     void setLayersToShow(QStringList layersToShow) { mLayersToShow = layersToShow; }
@@ -82,17 +94,29 @@ private:
     int mAdvanceAnimations = 0;
     int mFrameCount = 0;
     int mFrameDuration = 100;
+    int mSplitSize = 0;
+    QRect mRegion;
     bool mUseAntiAliasing = false;
     bool mSmoothImages = true;
     bool mIgnoreVisibility = false;
+    bool mUseGpu = false;
+    std::unique_ptr<OffscreenRenderer> mOffscreenRenderer;
     QStringList mLayersToHide;
     QStringList mLayersToShow;
     QStringList mObjectsToHide;
     QStringList mObjectsToShow;
     int mLayerTypesToShow = Layer::AnyLayerType & ~Layer::GroupLayerType;
 
-    void drawMapLayers(const MapRenderer &renderer, QPainter &painter, QPoint mapOffset = QPoint(0, 0)) const;
-    int renderMap(const MapRenderer &renderer, const QString &imageFileName);
+    void drawMapLayers(const MapRenderer &renderer, QPainter &painter, QPoint mapOffset = QPoint(0, 0),
+                       const QRectF &exposed = QRectF()) const;
+    void loadTileImages(const Map *map) const;
+    void drawMap(const MapRenderer &renderer, QImage &image, const QTransform &transform) const;
+    QImage drawMapOffscreen(const MapRenderer &renderer, const QRect &rect,
+                            const QTransform &transform) const;
+    QTransform mapTransform(const MapRenderer &renderer, QSize &imageSize) const;
+    int renderMap(const MapRenderer &renderer, const QStringList &imageFileNames);
+    int renderMapTiles(const MapRenderer &renderer, const QString &imageFileName);
+    QRegion animatedArea(const MapRenderer &renderer) const;
     int renderWorld(const QString &worldFileName, const QString &imageFileName);
     int saveImage(const QString &imageFileName, const QImage &image) const;
     bool shouldDrawLayer(const Layer *layer) const;
@@ -35,15 +35,26 @@
 #include "maprenderer.h"
 #include "objectgroup.h"
 #include "tilelayer.h"
+#include "tilelayerlod.h"
 
 #include <QCoreApplication>
 #include <QDebug>
 #include <QGraphicsItem>
 #include <QGraphicsScene>
 #include <QStyleOptionGraphicsItem>
+#include <QWheelEvent>
+
+#include <cmath>
+#include <memory>
 
 using namespace Tiled;
 
+/**
+ * The zoom limits of the view.
+ */
+static constexpr qreal MinimumScale = 1.0 / 256;
+static constexpr qreal MaximumScale = 16.0;
+
 /**
  * Item that represents a map object.
  */
@@ -98,6 +109,10 @@ public:
     {
         setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
         setPos(mTileLayer->offset());
+
+        // Keeps the visible part of the layer in a pixmap, which is scrolled
+        // along when panning, so that only newly exposed parts are drawn
+        setCacheMode(QGraphicsItem::DeviceCoordinateCache);
     }
 
     QRectF boundingRect() const override
@@ -107,12 +122,24 @@ public:
 
     void paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *) override
     {
-        mRenderer->drawTileLayer(p, mTileLayer, option->rect);
+        // Far zoomed out, draw the layer from downsampled images of its cells
+        const qreal scale = std::sqrt(std::abs(p->transform().determinant()));
+        if (scale < TileLayerLod::MaximumScale) {
+            if (!mLod)
+                mLod = std::make_unique<TileLayerLod>(mTileLayer);
+
+            const qreal dpr = p->device()->devicePixelRatioF();
+            mLod->draw(p, mRenderer, option->exposedRect, scale * dpr);
+            return;
+        }
+
+        mRenderer->drawTileLayer(p, mTileLayer, option->exposedRect);
     }
 
 private:
     TileLayer *mTileLayer;
     MapRenderer *mRenderer;
+    std::unique_ptr<TileLayerLod> mLod;
 };
 
 /**
@@ -207,3 +234,26 @@ bool TmxViewer::viewMap(const QString &fileName)
 
     return true;
 }
+
+/**
+ * Zooms in or out around the mouse cursor. The zoom factor is proportional
+ * to the scroll distance, which makes zooming smooth with touchpads and
+ * high-resolution mouse wheels.
+ */
+void TmxViewer::wheelEvent(QWheelEvent *event)
+{
+    const int delta = event->angleDelta().y();
+    if (delta == 0) {
+        QGraphicsView::wheelEvent(event);
+        return;
+    }
+
+    // One step of a regular mouse wheel zooms by a factor of 2^(1/4)
+    const qreal currentScale = transform().m11();
+    const qreal newScale = qBound(MinimumScale,
+                                  currentScale * std::pow(2.0, delta / 480.0),
+                                  MaximumScale);
+
+    scale(newScale / currentScale, newScale / currentScale);
+    event->accept();
+}
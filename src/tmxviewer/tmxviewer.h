@@ -47,6 +47,9 @@ public:
 
     bool viewMap(const QString &fileName);
 
+protected:
+    void wheelEvent(QWheelEvent *event) override;
+
 private:
     QGraphicsScene *mScene;
     std::unique_ptr<Tiled::Map> mMap;
@@ -21,24 +21,34 @@ private slots:
 void test_AutoMapping::autoMap_data()
 {
     QTest::addColumn<QString>("directory");
-
-    QTest::newRow("ignore-flip") << QStringLiteral("ignore-flip");
-    QTest::newRow("infinite-target-map") << QStringLiteral("infinite-target-map");
-    QTest::newRow("inputnot") << QStringLiteral("inputnot");
-    QTest::newRow("match-type") << QStringLiteral("match-type");
-    QTest::newRow("mod-and-offset") << QStringLiteral("mod-and-offset");
-    QTest::newRow("option-ignore-lock") << QStringLiteral("option-ignore-lock");
-    QTest::newRow("option-no-overlapping-output") << QStringLiteral("option-no-overlapping-output");
-    QTest::newRow("option-overflow-border") << QStringLiteral("option-overflow-border");
-    QTest::newRow("option-wrap-border") << QStringLiteral("option-wrap-border");
-    QTest::newRow("simple-2x2-rule") << QStringLiteral("simple-2x2-rule");
-    QTest::newRow("simple-replace") << QStringLiteral("simple-replace");
-    QTest::newRow("terrain-corner") << QStringLiteral("terrain-corner");
+    QTest::addColumn<bool>("applyInParallel");
+
+    const QStringList directories {
+        QStringLiteral("ignore-flip"),
+        QStringLiteral("infinite-target-map"),
+        QStringLiteral("inputnot"),
+        QStringLiteral("match-type"),
+        QStringLiteral("mod-and-offset"),
+        QStringLiteral("option-ignore-lock"),
+        QStringLiteral("option-no-overlapping-output"),
+        QStringLiteral("option-overflow-border"),
+        QStringLiteral("option-wrap-border"),
+        QStringLiteral("simple-2x2-rule"),
+        QStringLiteral("simple-replace"),
+        QStringLiteral("terrain-corner"),
+    };
+
+    // Applying the rules in parallel should give the same results
+    for (const QString &directory : directories) {
+        QTest::newRow(qUtf8Printable(directory)) << directory << true;
+        QTest::newRow(qUtf8Printable(directory + QStringLiteral("-serial"))) << directory << false;
+    }
 }
 
 void test_AutoMapping::autoMap()
 {
     QFETCH(QString, directory);
+    QFETCH(bool, applyInParallel);
 
     MapReader reader;
     auto inputMap = reader.readMap(directory + QStringLiteral("/map.tmx"));
@@ -52,6 +62,7 @@ void test_AutoMapping::autoMap()
     MapDocument mapDocument(std::move(inputMap));
     AutoMapper autoMapper(std::move(rulesMap));
     AutoMappingContext context(&mapDocument);
+    context.applyInParallel = applyInParallel;
 
     QRegion region;
 
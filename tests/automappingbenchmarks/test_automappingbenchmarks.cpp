@@ -0,0 +1,352 @@
+#include "layer.h"
+#include "map.h"
+#include "mapreader.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include "automapper.h"
+#include "mapdocument.h"
+
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QtTest/QtTest>
+
+#include <limits>
+#include <memory>
+
+using namespace Tiled;
+
+/*
+ * Benchmarks AutoMapping on large work maps with many rules.
+ *
+ * The corpus consists of the test cases from tests/automapping, with both
+ * their work map and their rules repeated many times, as well as generated
+ * rule sets resembling those used for placing terrain borders.
+ *
+ * Lines starting with "RESULT," report the time spent in each phase (in
+ * nanoseconds) and the number of matches, as comma-separated values.
+ *
+ * When the TILED_BENCHMARK_BASELINE environment variable points to a JSON
+ * file with earlier results, the test fails when a phase got slower than the
+ * baseline by more than TILED_BENCHMARK_THRESHOLD percent (default: 25), or
+ * when the number of matches changed. Set TILED_BENCHMARK_UPDATE_BASELINE to
+ * write the results to the baseline file instead.
+ */
+
+// Number of times the work maps and rules of the test cases are repeated
+static const int workMapCopies = 16;
+static const int rulesCopies = 10;
+
+// Phases that took less time than this in the baseline are too noisy to check
+static const qint64 minimumCheckedTime = 1000000;
+
+namespace {
+
+struct Timings
+{
+    qint64 prepareTime = std::numeric_limits<qint64>::max();
+    qint64 compileTime = 0;
+    qint64 matchTime = std::numeric_limits<qint64>::max();
+    qint64 applyTime = std::numeric_limits<qint64>::max();
+    int matchCount = 0;
+};
+
+} // anonymous namespace
+
+/**
+ * Repeats the contents of all tile layers in the given \a map \a columns by
+ * \a rows times, leaving \a spacing empty tiles between the copies.
+ */
+static void repeatTileLayers(Map &map, int columns, int rows, int spacing)
+{
+    const QSize step(map.width() + spacing, map.height() + spacing);
+    const QSize size(step.width() * columns - spacing,
+                     step.height() * rows - spacing);
+
+    LayerIterator iterator(&map, Layer::TileLayerType);
+    while (auto tileLayer = static_cast<TileLayer*>(iterator.next())) {
+        const std::unique_ptr<TileLayer> original(tileLayer->clone());
+        tileLayer->resize(size, QPoint());
+
+        for (int y = 0; y < rows; ++y)
+            for (int x = 0; x < columns; ++x)
+                tileLayer->setCells(x * step.width(), y * step.height(), original.get());
+    }
+
+    map.setWidth(size.width());
+    map.setHeight(size.height());
+}
+
+static bool loadTestCase(const QString &directory,
+                         std::unique_ptr<Map> &workMap,
+                         std::unique_ptr<Map> &rulesMap)
+{
+    const QString path = QStringLiteral("../automapping/") + directory;
+
+    MapReader reader;
+    workMap = reader.readMap(path + QStringLiteral("/map.tmx"));
+    rulesMap = reader.readMap(path + QStringLiteral("/rules.tmx"));
+
+    if (!workMap || !rulesMap)
+        return false;
+
+    repeatTileLayers(*workMap, workMapCopies, workMapCopies, 0);
+    repeatTileLayers(*rulesMap, rulesCopies, rulesCopies, 1);
+    return true;
+}
+
+/**
+ * Generates a rule for each of the 256 combinations of water and ground
+ * tiles around a water tile, outputting a matching border tile. The work
+ * map is filled with random water and ground tiles.
+ */
+static void createBorderRules(int size, bool matchInOrder,
+                              std::unique_ptr<Map> &workMap,
+                              std::unique_ptr<Map> &rulesMap)
+{
+    enum { Ground, Water, FirstBorder };
+
+    QImage image(32 * 16, 32 * 17, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::gray);
+
+    SharedTileset tileset = Tileset::create(QStringLiteral("terrain"), 32, 32);
+    tileset->loadFromImage(image, QUrl());
+
+    Map::Parameters parameters;
+    parameters.width = 16 * 4 - 1;
+    parameters.height = 16 * 4 - 1;
+    parameters.tileWidth = 32;
+    parameters.tileHeight = 32;
+
+    rulesMap = std::make_unique<Map>(parameters);
+    rulesMap->addTileset(tileset);
+    rulesMap->setProperty(QStringLiteral("MatchInOrder"), matchInOrder);
+
+    auto input = std::make_unique<TileLayer>(QStringLiteral("input_ground"),
+                                             0, 0, parameters.width, parameters.height);
+    auto output = std::make_unique<TileLayer>(QStringLiteral("output_borders"),
+                                              0, 0, parameters.width, parameters.height);
+
+    static const QPoint neighbors[] = {
+        { -1, -1 }, { 0, -1 }, { 1, -1 },
+        { -1,  0 },            { 1,  0 },
+        { -1,  1 }, { 0,  1 }, { 1,  1 },
+    };
+
+    for (int combination = 0; combination < 256; ++combination) {
+        const QPoint center(combination % 16 * 4 + 1, combination / 16 * 4 + 1);
+
+        input->setCell(center.x(), center.y(), Cell(tileset.data(), Water));
+        for (int i = 0; i < 8; ++i) {
+            const QPoint pos = center + neighbors[i];
+            const int tileId = (combination >> i) & 1 ? Water : Ground;
+            input->setCell(pos.x(), pos.y(), Cell(tileset.data(), tileId));
+        }
+
+        output->setCell(center.x(), center.y(), Cell(tileset.data(), FirstBorder + combination));
+    }
+
+    rulesMap->addLayer(std::move(input));
+    rulesMap->addLayer(std::move(output));
+
+    parameters.width = size;
+    parameters.height = size;
+
+    workMap = std::make_unique<Map>(parameters);
+    workMap->addTileset(tileset);
+
+    auto ground = std::make_unique<TileLayer>(QStringLiteral("ground"),
+                                              0, 0, size, size);
+
+    QRandomGenerator random(42);
+    for (int y = 0; y < size; ++y)
+        for (int x = 0; x < size; ++x)
+            ground->setCell(x, y, Cell(tileset.data(), random.bounded(2) ? Water : Ground));
+
+    workMap->addLayer(std::move(ground));
+}
+
+class test_AutoMappingBenchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void autoMap_data();
+    void autoMap();
+
+private:
+    void checkAgainstBaseline(const QString &name, const Timings &timings);
+
+    QString mBaselineFileName;
+    bool mUpdateBaseline = false;
+    qreal mThreshold = 25;
+    QJsonObject mBaseline;
+};
+
+void test_AutoMappingBenchmarks::initTestCase()
+{
+    mBaselineFileName = qEnvironmentVariable("TILED_BENCHMARK_BASELINE");
+    mUpdateBaseline = qEnvironmentVariableIsSet("TILED_BENCHMARK_UPDATE_BASELINE");
+
+    bool ok;
+    const int threshold = qEnvironmentVariableIntValue("TILED_BENCHMARK_THRESHOLD", &ok);
+    if (ok && threshold > 0)
+        mThreshold = threshold;
+
+    if (mBaselineFileName.isEmpty() || mUpdateBaseline)
+        return;
+
+    QFile file(mBaselineFileName);
+    QVERIFY2(file.open(QIODevice::ReadOnly), qUtf8Printable(file.errorString()));
+
+    QJsonParseError error;
+    mBaseline = QJsonDocument::fromJson(file.readAll(), &error).object();
+    QVERIFY2(error.error == QJsonParseError::NoError, qUtf8Printable(error.errorString()));
+}
+
+void test_AutoMappingBenchmarks::cleanupTestCase()
+{
+    if (mBaselineFileName.isEmpty() || !mUpdateBaseline)
+        return;
+
+    QSaveFile file(mBaselineFileName);
+    QVERIFY2(file.open(QIODevice::WriteOnly), qUtf8Printable(file.errorString()));
+    file.write(QJsonDocument(mBaseline).toJson());
+    QVERIFY2(file.commit(), qUtf8Printable(file.errorString()));
+}
+
+void test_AutoMappingBenchmarks::autoMap_data()
+{
+    QTest::addColumn<QString>("corpus");
+
+    const QStringList corpus {
+        QStringLiteral("ignore-flip"),
+        QStringLiteral("inputnot"),
+        QStringLiteral("option-no-overlapping-output"),
+        QStringLiteral("option-overflow-border"),
+        QStringLiteral("option-wrap-border"),
+        QStringLiteral("simple-2x2-rule"),
+        QStringLiteral("simple-replace"),
+        QStringLiteral("terrain-corner"),
+        QStringLiteral("borders"),
+        QStringLiteral("borders-in-order"),
+    };
+
+    for (const QString &name : corpus)
+        QTest::newRow(qUtf8Printable(name)) << name;
+}
+
+void test_AutoMappingBenchmarks::autoMap()
+{
+    QFETCH(QString, corpus);
+
+    std::unique_ptr<Map> workMap;
+    std::unique_ptr<Map> rulesMap;
+
+    if (corpus == QLatin1String("borders"))
+        createBorderRules(256, false, workMap, rulesMap);
+    else if (corpus == QLatin1String("borders-in-order"))
+        createBorderRules(256, true, workMap, rulesMap);
+    else
+        QVERIFY(loadTestCase(corpus, workMap, rulesMap));
+
+    const QRegion region(QRect(QPoint(), workMap->size()));
+
+    MapDocument mapDocument(std::move(workMap));
+    AutoMapper autoMapper(std::move(rulesMap));
+    QVERIFY2(autoMapper.errorString().isEmpty(), qUtf8Printable(autoMapper.errorString()));
+
+    // Keeps the fastest time of each phase, except for compiling the rules,
+    // which only happens in the first iteration
+    Timings timings;
+
+    QBENCHMARK {
+        AutoMappingContext context(&mapDocument);
+
+        QElapsedTimer timer;
+        timer.start();
+        autoMapper.prepareAutoMap(context);
+        const qint64 prepareTime = timer.nsecsElapsed();
+
+        autoMapper.autoMap(region, nullptr, context);
+
+        const auto &statistics = context.statistics;
+        timings.prepareTime = qMin(timings.prepareTime, prepareTime);
+        timings.compileTime = qMax(timings.compileTime, statistics.compileTime);
+        timings.matchTime = qMin(timings.matchTime, statistics.matchTime);
+        timings.applyTime = qMin(timings.applyTime, statistics.applyTime);
+        timings.matchCount = statistics.matchCount;
+    }
+
+    const auto report = [] (const char *measure, qint64 value) {
+        qInfo().noquote() << QStringLiteral("RESULT,%1,%2,%3,%4")
+                             .arg(QLatin1String(QTest::currentTestFunction()),
+                                  QLatin1String(QTest::currentDataTag()),
+                                  QLatin1String(measure))
+                             .arg(value);
+    };
+
+    report("prepare", timings.prepareTime);
+    report("compile", timings.compileTime);
+    report("match", timings.matchTime);
+    report("apply", timings.applyTime);
+    report("matches", timings.matchCount);
+
+    QVERIFY(timings.matchCount > 0);
+
+    checkAgainstBaseline(corpus, timings);
+}
+
+void test_AutoMappingBenchmarks::checkAgainstBaseline(const QString &name,
+                                                      const Timings &timings)
+{
+    if (mBaselineFileName.isEmpty())
+        return;
+
+    if (mUpdateBaseline) {
+        mBaseline.insert(name, QJsonObject {
+                             { QStringLiteral("prepare"), double(timings.prepareTime) },
+                             { QStringLiteral("compile"), double(timings.compileTime) },
+                             { QStringLiteral("match"), double(timings.matchTime) },
+                             { QStringLiteral("apply"), double(timings.applyTime) },
+                             { QStringLiteral("matches"), timings.matchCount },
+                         });
+        return;
+    }
+
+    const QJsonObject baseline = mBaseline.value(name).toObject();
+    if (baseline.isEmpty())
+        QSKIP("No baseline for this corpus");
+
+    QCOMPARE(timings.matchCount, baseline.value(QLatin1String("matches")).toInt());
+
+    const std::pair<const char *, qint64> phases[] = {
+        { "prepare", timings.prepareTime },
+        { "compile", timings.compileTime },
+        { "match", timings.matchTime },
+        { "apply", timings.applyTime },
+    };
+
+    for (const auto &[phase, time] : phases) {
+        const qint64 baselineTime = baseline.value(QLatin1String(phase)).toDouble();
+        if (baselineTime < minimumCheckedTime)
+            continue;
+
+        const qreal change = (time - baselineTime) * 100.0 / baselineTime;
+        QVERIFY2(change <= mThreshold,
+                 qUtf8Printable(QStringLiteral("%1 got %2% slower (%3 ms, baseline %4 ms)")
+                                .arg(QLatin1String(phase))
+                                .arg(change, 0, 'f', 1)
+                                .arg(time / 1e6, 0, 'f', 2)
+                                .arg(baselineTime / 1e6, 0, 'f', 2)));
+    }
+}
+
+QTEST_MAIN(test_AutoMappingBenchmarks)
+#include "test_automappingbenchmarks.moc"
@@ -0,0 +1,66 @@
+#include "base64.h"
+
+#include <QtTest/QtTest>
+
+#include <QRandomGenerator>
+
+using namespace Tiled;
+
+class test_Base64 : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void encode();
+    void decode_data();
+    void decode();
+    void roundTrip();
+};
+
+void test_Base64::encode()
+{
+    QCOMPARE(Base64::encode(QByteArray()), QByteArray());
+    QCOMPARE(Base64::encode("f"), QByteArray("Zg=="));
+    QCOMPARE(Base64::encode("fo"), QByteArray("Zm8="));
+    QCOMPARE(Base64::encode("foo"), QByteArray("Zm9v"));
+    QCOMPARE(Base64::encode("foob"), QByteArray("Zm9vYg=="));
+    QCOMPARE(Base64::encode("\xff\xfe\xfd"), QByteArray("//79"));
+}
+
+void test_Base64::decode_data()
+{
+    QTest::addColumn<QByteArray>("encoded");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("padded") << QByteArray("Zm9vYg==");
+    QTest::newRow("unpadded") << QByteArray("Zm9vYmE");
+    QTest::newRow("whitespace") << QByteArray("\n   Zm9v\n   YmFy\n");
+    QTest::newRow("split-group") << QByteArray("Zm 9vY mFy");
+    QTest::newRow("invalid-characters") << QByteArray("Zm9v*YmFy!");
+    QTest::newRow("single-character") << QByteArray("Z");
+}
+
+void test_Base64::decode()
+{
+    QFETCH(QByteArray, encoded);
+
+    QCOMPARE(Base64::decode(encoded), QByteArray::fromBase64(encoded));
+}
+
+void test_Base64::roundTrip()
+{
+    QRandomGenerator random(1);
+
+    for (int size = 0; size < 100; ++size) {
+        QByteArray data(size, Qt::Uninitialized);
+        for (char &byte : data)
+            byte = static_cast<char>(random.bounded(256));
+
+        const QByteArray encoded = Base64::encode(data);
+        QCOMPARE(encoded, data.toBase64());
+        QCOMPARE(Base64::decode(encoded), data);
+    }
+}
+
+QTEST_APPLESS_MAIN(test_Base64)
+#include "test_base64.moc"
@@ -0,0 +1,406 @@
+#include "compression.h"
+#include "map.h"
+#include "mapformat.h"
+#include "mapobject.h"
+#include "mapreader.h"
+#include "maptovariantconverter.h"
+#include "mapwriter.h"
+#include "objectgroup.h"
+#include "pluginmanager.h"
+#include "tilelayer.h"
+#include "tileset.h"
+#include "varianttomapconverter.h"
+
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include <memory>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+using namespace Tiled;
+
+/*
+ * Benchmarks reading and writing generated maps in the supported formats.
+ *
+ * The size of the maps can be set using the TILED_BENCHMARK_SIZE environment
+ * variable (default: 128). The timings can be written in a machine-readable
+ * format using the options of QTest, for example "-o results.csv,csv". In
+ * addition, lines starting with "RESULT," report the size of the written
+ * data and the memory held by the read map, as comma-separated values.
+ */
+
+namespace {
+
+enum class FileType {
+    Tmx,
+    Json,
+    Plugin,
+};
+
+enum class Content {
+    Basic,
+    ManyLayers,
+    ManyObjects,
+    HeavyProperties,
+};
+
+} // anonymous namespace
+
+Q_DECLARE_METATYPE(FileType)
+Q_DECLARE_METATYPE(Content)
+
+static int benchmarkSize()
+{
+    bool ok;
+    const int size = qEnvironmentVariableIntValue("TILED_BENCHMARK_SIZE", &ok);
+    return ok && size > 0 ? size : 128;
+}
+
+/**
+ * Returns the resident memory of this process in bytes, or -1 when it is not
+ * known on this platform.
+ */
+static qint64 residentMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly))
+        return -1;
+
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2)
+        return -1;
+
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+static void reportResult(const char *measure, qint64 value)
+{
+    qInfo().noquote() << QStringLiteral("RESULT,%1,%2,%3,%4")
+                         .arg(QLatin1String(QTest::currentTestFunction()),
+                              QLatin1String(QTest::currentDataTag()),
+                              QLatin1String(measure))
+                         .arg(value);
+}
+
+static void setProperties(Object &object, int count, int seed)
+{
+    for (int i = 0; i < count; ++i) {
+        const QString name = QStringLiteral("property%1").arg(i);
+        switch (i % 4) {
+        case 0: object.setProperty(name, QStringLiteral("value %1").arg(seed + i)); break;
+        case 1: object.setProperty(name, seed + i); break;
+        case 2: object.setProperty(name, (seed + i) / 3.0); break;
+        case 3: object.setProperty(name, (seed + i) % 2 == 0); break;
+        }
+    }
+}
+
+static std::unique_ptr<Map> createMap(Map::Orientation orientation,
+                                      bool infinite,
+                                      Map::LayerDataFormat layerDataFormat,
+                                      Content content)
+{
+    const int size = benchmarkSize();
+
+    Map::Parameters parameters;
+    parameters.orientation = orientation;
+    parameters.width = size;
+    parameters.height = size;
+    parameters.tileWidth = 32;
+    parameters.tileHeight = orientation == Map::Isometric ? 16 : 32;
+    parameters.infinite = infinite;
+    if (orientation == Map::Hexagonal)
+        parameters.hexSideLength = 16;
+
+    auto map = std::make_unique<Map>(parameters);
+    map->setLayerDataFormat(layerDataFormat);
+
+    SharedTileset tileset = Tileset::create(QStringLiteral("tiles"), 32, 32);
+    tileset->setNextTileId(256);
+    map->addTileset(tileset);
+
+    const int tileLayerCount = content == Content::ManyLayers ? 64 : 4;
+    const int offset = infinite ? -size / 2 : 0;
+
+    for (int l = 0; l < tileLayerCount; ++l) {
+        auto layer = std::make_unique<TileLayer>(QStringLiteral("Tile Layer %1").arg(l),
+                                                 0, 0, size, size);
+
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                if ((x * 7 + y * 3 + l) % 5 == 0)
+                    continue;
+
+                Cell cell(tileset.data(), (x * y + l) % 256);
+                cell.setFlippedHorizontally(x % 3 == 0);
+                layer->setCell(x + offset, y + offset, cell);
+            }
+        }
+
+        if (content == Content::HeavyProperties)
+            setProperties(*layer, 50, l);
+
+        map->addLayer(std::move(layer));
+    }
+
+    const int objectCount = content == Content::ManyObjects ? size * size
+                                                            : size * size / 16;
+    const int propertyCount = content == Content::HeavyProperties ? 20 : 0;
+
+    auto objectGroup = std::make_unique<ObjectGroup>(QStringLiteral("Objects"), 0, 0);
+
+    for (int i = 0; i < objectCount; ++i) {
+        auto object = std::make_unique<MapObject>(QStringLiteral("Object %1").arg(i),
+                                                  QStringLiteral("Type"),
+                                                  QPointF(i % size * 32, i / size * 32),
+                                                  QSizeF(32, 32));
+        object->setId(i + 1);
+
+        if (i % 4 == 1)
+            object->setShape(MapObject::Ellipse);
+        if (i % 4 == 2) {
+            object->setShape(MapObject::Polygon);
+            object->setPolygon(QPolygonF() << QPointF(0, 0) << QPointF(32, 0) << QPointF(16, 32));
+        }
+
+        setProperties(*object, propertyCount, i);
+        objectGroup->addObject(std::move(object));
+    }
+
+    map->addLayer(std::move(objectGroup));
+    map->setNextObjectId(objectCount + 1);
+
+    return map;
+}
+
+static QByteArray serializeMap(const Map &map, FileType fileType)
+{
+    switch (fileType) {
+    case FileType::Tmx: {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        MapWriter().writeMap(&map, &buffer);
+        return buffer.data();
+    }
+    case FileType::Json: {
+        const QVariant variant = MapToVariantConverter().toVariant(map, QDir::current());
+        return QJsonDocument::fromVariant(variant).toJson(QJsonDocument::Compact);
+    }
+    case FileType::Plugin:
+        break;
+    }
+
+    return QByteArray();
+}
+
+static std::unique_ptr<Map> deserializeMap(const QByteArray &data, FileType fileType)
+{
+    switch (fileType) {
+    case FileType::Tmx: {
+        QBuffer buffer;
+        buffer.setData(data);
+        buffer.open(QIODevice::ReadOnly);
+        return MapReader().readMap(&buffer);
+    }
+    case FileType::Json: {
+        const QVariant variant = QJsonDocument::fromJson(data).toVariant();
+        return VariantToMapConverter().toMap(variant, QDir::current());
+    }
+    case FileType::Plugin:
+        break;
+    }
+
+    return nullptr;
+}
+
+class test_Benchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void writeMap_data();
+    void writeMap();
+    void readMap_data();
+    void readMap();
+
+private:
+    void addRows(bool read);
+
+    QTemporaryDir mTemporaryDir;
+};
+
+void test_Benchmarks::initTestCase()
+{
+    QVERIFY(mTemporaryDir.isValid());
+
+    // Makes the formats provided by plugins available, when they are found
+    PluginManager::instance()->loadPlugins();
+}
+
+void test_Benchmarks::addRows(bool read)
+{
+    QTest::addColumn<FileType>("fileType");
+    QTest::addColumn<MapFormat*>("mapFormat");
+    QTest::addColumn<Map::Orientation>("orientation");
+    QTest::addColumn<bool>("infinite");
+    QTest::addColumn<Map::LayerDataFormat>("layerDataFormat");
+    QTest::addColumn<Content>("content");
+
+    const struct {
+        const char *name;
+        Map::LayerDataFormat format;
+    } layerDataFormats[] = {
+        { "xml", Map::XML },
+        { "csv", Map::CSV },
+        { "base64", Map::Base64 },
+        { "zlib", Map::Base64Zlib },
+        { "gzip", Map::Base64Gzip },
+        { "zstd", Map::Base64Zstandard },
+    };
+
+    for (const auto &layerDataFormat : layerDataFormats) {
+        const QByteArray name = QByteArray("tmx-") + layerDataFormat.name;
+        QTest::newRow(name.constData()) << FileType::Tmx << static_cast<MapFormat*>(nullptr)
+                            << Map::Orthogonal << false << layerDataFormat.format << Content::Basic;
+        QTest::newRow((name + "-infinite").constData()) << FileType::Tmx << static_cast<MapFormat*>(nullptr)
+                                          << Map::Orthogonal << true << layerDataFormat.format << Content::Basic;
+    }
+
+    QTest::newRow("tmx-zlib-isometric") << FileType::Tmx << static_cast<MapFormat*>(nullptr)
+                                        << Map::Isometric << false << Map::Base64Zlib << Content::Basic;
+    QTest::newRow("tmx-zlib-hexagonal") << FileType::Tmx << static_cast<MapFormat*>(nullptr)
+                                        << Map::Hexagonal << false << Map::Base64Zlib << Content::Basic;
+    QTest::newRow("tmx-zlib-many-layers") << FileType::Tmx << static_cast<MapFormat*>(nullptr)
+                                          << Map::Orthogonal << false << Map::Base64Zlib << Content::ManyLayers;
+    QTest::newRow("tmx-zlib-many-objects") << FileType::Tmx << static_cast<MapFormat*>(nullptr)
+                                           << Map::Orthogonal << false << Map::Base64Zlib << Content::ManyObjects;
+    QTest::newRow("tmx-zlib-heavy-properties") << FileType::Tmx << static_cast<MapFormat*>(nullptr)
+                                               << Map::Orthogonal << false << Map::Base64Zlib << Content::HeavyProperties;
+
+    QTest::newRow("json-csv") << FileType::Json << static_cast<MapFormat*>(nullptr)
+                              << Map::Orthogonal << false << Map::CSV << Content::Basic;
+    QTest::newRow("json-zlib") << FileType::Json << static_cast<MapFormat*>(nullptr)
+                               << Map::Orthogonal << false << Map::Base64Zlib << Content::Basic;
+    QTest::newRow("json-csv-infinite") << FileType::Json << static_cast<MapFormat*>(nullptr)
+                                       << Map::Orthogonal << true << Map::CSV << Content::Basic;
+    QTest::newRow("json-csv-many-objects") << FileType::Json << static_cast<MapFormat*>(nullptr)
+                                           << Map::Orthogonal << false << Map::CSV << Content::ManyObjects;
+    QTest::newRow("json-csv-heavy-properties") << FileType::Json << static_cast<MapFormat*>(nullptr)
+                                               << Map::Orthogonal << false << Map::CSV << Content::HeavyProperties;
+
+    const auto formats = PluginManager::objects<MapFormat>();
+    for (MapFormat *format : formats) {
+        if (!format->hasCapabilities(read ? MapFormat::ReadWrite : MapFormat::Write))
+            continue;
+
+        const QByteArray name = "plugin-" + format->shortName().toUtf8();
+        QTest::newRow(name.constData()) << FileType::Plugin << format
+                            << Map::Orthogonal << false << Map::CSV << Content::Basic;
+    }
+}
+
+void test_Benchmarks::writeMap_data()
+{
+    addRows(false);
+}
+
+void test_Benchmarks::writeMap()
+{
+    QFETCH(FileType, fileType);
+    QFETCH(MapFormat*, mapFormat);
+    QFETCH(Map::Orientation, orientation);
+    QFETCH(bool, infinite);
+    QFETCH(Map::LayerDataFormat, layerDataFormat);
+    QFETCH(Content, content);
+
+    if (layerDataFormat == Map::Base64Zstandard && !compressionSupported(Zstandard))
+        QSKIP("Zstandard compression is not supported");
+
+    const auto map = createMap(orientation, infinite, layerDataFormat, content);
+
+    if (fileType == FileType::Plugin) {
+        const QString fileName = mTemporaryDir.filePath(QStringLiteral("map"));
+
+        QBENCHMARK {
+            QVERIFY2(mapFormat->write(map.get(), fileName), qUtf8Printable(mapFormat->errorString()));
+        }
+
+        reportResult("bytes", QFileInfo(fileName).size());
+        return;
+    }
+
+    QByteArray data;
+
+    QBENCHMARK {
+        data = serializeMap(*map, fileType);
+    }
+
+    QVERIFY(!data.isEmpty());
+    reportResult("bytes", data.size());
+}
+
+void test_Benchmarks::readMap_data()
+{
+    addRows(true);
+}
+
+void test_Benchmarks::readMap()
+{
+    QFETCH(FileType, fileType);
+    QFETCH(MapFormat*, mapFormat);
+    QFETCH(Map::Orientation, orientation);
+    QFETCH(bool, infinite);
+    QFETCH(Map::LayerDataFormat, layerDataFormat);
+    QFETCH(Content, content);
+
+    if (layerDataFormat == Map::Base64Zstandard && !compressionSupported(Zstandard))
+        QSKIP("Zstandard compression is not supported");
+
+    QByteArray data;
+    QString fileName;
+
+    {
+        const auto map = createMap(orientation, infinite, layerDataFormat, content);
+
+        if (fileType == FileType::Plugin) {
+            fileName = mTemporaryDir.filePath(QStringLiteral("map"));
+            QVERIFY2(mapFormat->write(map.get(), fileName), qUtf8Printable(mapFormat->errorString()));
+        } else {
+            data = serializeMap(*map, fileType);
+        }
+    }
+
+    auto read = [&] {
+        if (fileType == FileType::Plugin)
+            return mapFormat->read(fileName);
+        return deserializeMap(data, fileType);
+    };
+
+    QBENCHMARK {
+        const auto map = read();
+        QVERIFY(map);
+    }
+
+    // Measure the memory held by the read map outside of the benchmark
+    const qint64 memoryBefore = residentMemory();
+    const auto map = read();
+    const qint64 memoryAfter = residentMemory();
+
+    QVERIFY(map);
+
+    if (memoryBefore != -1 && memoryAfter != -1)
+        reportResult("memory", memoryAfter - memoryBefore);
+}
+
+QTEST_MAIN(test_Benchmarks)
+#include "test_benchmarks.moc"
@@ -0,0 +1,107 @@
+#include "grouplayer.h"
+#include "map.h"
+#include "tilelayer.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_GroupLayer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void effectiveProperties();
+    void reparenting();
+    void clone();
+    void layerIterator();
+};
+
+void test_GroupLayer::effectiveProperties()
+{
+    GroupLayer outer(QStringLiteral("outer"), 0, 0);
+    auto innerLayer = std::make_unique<GroupLayer>(QStringLiteral("inner"), 0, 0);
+    auto tileLayer = std::make_unique<TileLayer>(QStringLiteral("tiles"), 0, 0, 4, 4);
+    GroupLayer *inner = innerLayer.get();
+    TileLayer *tiles = tileLayer.get();
+
+    inner->addLayer(std::move(tileLayer));
+    outer.addLayer(std::move(innerLayer));
+
+    tiles->setOpacity(0.5);
+    inner->setOpacity(0.5);
+    outer.setOpacity(0.5);
+    QCOMPARE(tiles->effectiveOpacity(), 0.125);
+
+    outer.setParallaxFactor(QPointF(2.0, 0.5));
+    tiles->setParallaxFactor(QPointF(0.5, 0.5));
+    QCOMPARE(tiles->effectiveParallaxFactor(), QPointF(1.0, 0.25));
+
+    QCOMPARE(tiles->effectiveTintColor(), QColor(255, 255, 255, 255));
+    outer.setTintColor(QColor(255, 0, 0, 255));
+    QCOMPARE(tiles->effectiveTintColor(), QColor(255, 0, 0, 255));
+    outer.setTintColor(QColor());
+    QCOMPARE(tiles->effectiveTintColor(), QColor(255, 255, 255, 255));
+
+    QVERIFY(!tiles->isHidden());
+    outer.setVisible(false);
+    QVERIFY(tiles->isHidden());
+    QVERIFY(inner->isHidden());
+    outer.setVisible(true);
+    QVERIFY(!tiles->isHidden());
+}
+
+void test_GroupLayer::reparenting()
+{
+    GroupLayer group(QStringLiteral("group"), 0, 0);
+    group.setOpacity(0.5);
+    group.setVisible(false);
+
+    group.addLayer(std::make_unique<TileLayer>(QStringLiteral("tiles"), 0, 0, 4, 4));
+    Layer *tiles = group.layerAt(0);
+    QCOMPARE(tiles->effectiveOpacity(), 0.5);
+    QVERIFY(tiles->isHidden());
+
+    std::unique_ptr<Layer> taken(group.takeLayerAt(0));
+    QCOMPARE(taken->effectiveOpacity(), 1.0);
+    QVERIFY(!taken->isHidden());
+}
+
+void test_GroupLayer::clone()
+{
+    GroupLayer group(QStringLiteral("group"), 0, 0);
+    group.setOpacity(0.5);
+    group.addLayer(std::make_unique<TileLayer>(QStringLiteral("tiles"), 0, 0, 4, 4));
+    group.layerAt(0)->setOpacity(0.5);
+
+    std::unique_ptr<GroupLayer> copy(group.clone());
+    QCOMPARE(copy->effectiveOpacity(), 0.5);
+    QCOMPARE(copy->layerAt(0)->effectiveOpacity(), 0.25);
+}
+
+void test_GroupLayer::layerIterator()
+{
+    Map map;
+    auto group = std::make_unique<GroupLayer>(QStringLiteral("group"), 0, 0);
+    group->addLayer(std::make_unique<TileLayer>(QStringLiteral("a"), 0, 0, 4, 4));
+    group->addLayer(std::make_unique<GroupLayer>(QStringLiteral("empty"), 0, 0));
+    map.addLayer(std::move(group));
+    map.addLayer(std::make_unique<TileLayer>(QStringLiteral("b"), 0, 0, 4, 4));
+
+    QStringList forward;
+    for (Layer *layer : map.allLayers())
+        forward.append(layer->name());
+    QCOMPARE(forward, QStringList({ QStringLiteral("a"), QStringLiteral("empty"),
+                                    QStringLiteral("group"), QStringLiteral("b") }));
+
+    QStringList backward;
+    LayerIterator iterator(&map);
+    iterator.toBack();
+    while (Layer *layer = iterator.previous())
+        backward.append(layer->name());
+    QCOMPARE(backward, QStringList({ QStringLiteral("b"), QStringLiteral("group"),
+                                     QStringLiteral("empty"), QStringLiteral("a") }));
+}
+
+QTEST_MAIN(test_GroupLayer)
+#include "test_grouplayer.moc"
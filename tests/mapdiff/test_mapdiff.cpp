@@ -0,0 +1,174 @@
+#include "map.h"
+#include "mapdiff.h"
+#include "mapobject.h"
+#include "objectgroup.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_MapDiff : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void identical();
+    void changedCells();
+    void layers();
+    void objects();
+    void unsharedTilesets();
+
+private:
+    std::unique_ptr<Map> createMap(const SharedTileset &tileset) const;
+};
+
+std::unique_ptr<Map> test_MapDiff::createMap(const SharedTileset &tileset) const
+{
+    auto map = std::make_unique<Map>(Map::Orthogonal, 64, 64, 32, 32);
+    map->addTileset(tileset);
+
+    auto tileLayer = std::make_unique<TileLayer>(QStringLiteral("Ground"), 0, 0, 64, 64);
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 64; ++x)
+            if ((x + y) % 3 != 0)
+                tileLayer->setCell(x, y, Cell(tileset.data(), (x + y) % 16));
+    map->addLayer(std::move(tileLayer));
+
+    auto objectGroup = std::make_unique<ObjectGroup>(QStringLiteral("Objects"), 0, 0);
+    for (int i = 0; i < 4; ++i)
+        objectGroup->addObject(std::make_unique<MapObject>(QString(), QString(),
+                                                           QPointF(i * 32, 0),
+                                                           QSizeF(32, 32)));
+    map->addLayer(std::move(objectGroup));
+
+    return map;
+}
+
+void test_MapDiff::identical()
+{
+    const SharedTileset tileset = Tileset::create(QStringLiteral("a"), 32, 32);
+    const auto map = createMap(tileset);
+    const auto copy = map->clone();
+
+    const MapDiff diff = MapDiff::compare(*map, *copy);
+    QVERIFY(diff.isEmpty());
+    QVERIFY(diff.hasOnlyCellChanges());
+}
+
+void test_MapDiff::changedCells()
+{
+    const SharedTileset tileset = Tileset::create(QStringLiteral("a"), 32, 32);
+    const auto map = createMap(tileset);
+    const auto copy = map->clone();
+
+    auto tileLayer = copy->layerAt(0)->asTileLayer();
+    tileLayer->setCell(1, 0, Cell::empty);
+    tileLayer->setCell(2, 0, Cell::empty);
+    tileLayer->setCell(40, 50, Cell(tileset.data(), 15));
+
+    const MapDiff diff = MapDiff::compare(*map, *copy);
+    QCOMPARE(diff.layers.size(), 1);
+    QVERIFY(diff.hasOnlyCellChanges());
+
+    const LayerDiff &layerDiff = diff.layers.first();
+    QCOMPARE(layerDiff.change, LayerDiff::Modified);
+    QCOMPARE(layerDiff.id, map->layerAt(0)->id());
+    QVERIFY(!layerDiff.attributesChanged);
+    QCOMPARE(layerDiff.changedCells, QRegion(1, 0, 2, 1) + QRegion(40, 50, 1, 1));
+
+    const QVariantMap variant = diff.toVariant();
+    const QVariantList layers = variant.value(QStringLiteral("layers")).toList();
+    QCOMPARE(layers.size(), 1);
+    QCOMPARE(layers.first().toMap().value(QStringLiteral("changedCellCount")).toInt(), 3);
+}
+
+void test_MapDiff::layers()
+{
+    const SharedTileset tileset = Tileset::create(QStringLiteral("a"), 32, 32);
+    const auto map = createMap(tileset);
+    const auto copy = map->clone();
+
+    const int removedId = copy->layerAt(1)->id();
+    delete copy->takeLayerAt(1);
+    copy->layerAt(0)->setName(QStringLiteral("Renamed"));
+    copy->addLayer(std::make_unique<TileLayer>(QStringLiteral("New"), 0, 0, 64, 64));
+
+    const MapDiff diff = MapDiff::compare(*map, *copy);
+    QVERIFY(diff.mapChanged);       // the next layer ID changed
+    QVERIFY(!diff.hasOnlyCellChanges());
+    QCOMPARE(diff.layers.size(), 3);
+
+    QCOMPARE(diff.layers.at(0).change, LayerDiff::Modified);
+    QVERIFY(diff.layers.at(0).attributesChanged);
+    QVERIFY(diff.layers.at(0).changedCells.isEmpty());
+
+    QCOMPARE(diff.layers.at(1).change, LayerDiff::Added);
+    QCOMPARE(diff.layers.at(1).name, QStringLiteral("New"));
+
+    QCOMPARE(diff.layers.at(2).change, LayerDiff::Removed);
+    QCOMPARE(diff.layers.at(2).id, removedId);
+    QCOMPARE(diff.layers.at(2).type, Layer::ObjectGroupType);
+}
+
+void test_MapDiff::objects()
+{
+    const SharedTileset tileset = Tileset::create(QStringLiteral("a"), 32, 32);
+    const auto map = createMap(tileset);
+    const auto copy = map->clone();
+
+    auto objectGroup = copy->layerAt(1)->asObjectGroup();
+    const int removedId = objectGroup->objectAt(0)->id();
+    const int changedId = objectGroup->objectAt(2)->id();
+
+    MapObject *removedObject = objectGroup->objectAt(0);
+    objectGroup->removeObjectAt(0);
+    delete removedObject;
+    objectGroup->objectAt(1)->setName(QStringLiteral("Changed"));
+    objectGroup->addObject(std::make_unique<MapObject>());
+    copy->initializeObjectIds(*objectGroup);
+    const int addedId = objectGroup->objects().last()->id();
+
+    MapDiff diff = MapDiff::compare(*map, *copy);
+    QCOMPARE(diff.layers.size(), 1);
+    QVERIFY(!diff.layers.first().attributesChanged);
+    QCOMPARE(diff.layers.first().addedObjects, QVector<int> { addedId });
+    QCOMPARE(diff.layers.first().removedObjects, QVector<int> { removedId });
+    QCOMPARE(diff.layers.first().changedObjects, QVector<int> { changedId });
+
+    // Reordering objects changes their drawing order
+    const auto reordered = map->clone();
+    reordered->layerAt(1)->asObjectGroup()->moveObjects(0, 4, 1);
+
+    diff = MapDiff::compare(*map, *reordered);
+    QCOMPARE(diff.layers.size(), 1);
+    QVERIFY(diff.layers.first().attributesChanged);
+    QVERIFY(diff.layers.first().changedObjects.isEmpty());
+}
+
+void test_MapDiff::unsharedTilesets()
+{
+    // Tilesets are matched by name when they are embedded
+    const auto map = createMap(Tileset::create(QStringLiteral("a"), 32, 32));
+    const auto other = createMap(Tileset::create(QStringLiteral("a"), 32, 32));
+
+    QVERIFY(MapDiff::compare(*map, *other).isEmpty());
+
+    other->layerAt(0)->asTileLayer()->setCell(5, 5, Cell::empty);
+
+    MapDiff diff = MapDiff::compare(*map, *other);
+    QCOMPARE(diff.layers.size(), 1);
+    QCOMPARE(diff.layers.first().changedCells, QRegion(5, 5, 1, 1));
+
+    const auto renamed = createMap(Tileset::create(QStringLiteral("b"), 32, 32));
+
+    diff = MapDiff::compare(*map, *renamed);
+    QCOMPARE(diff.addedTilesets, QStringList { QStringLiteral("b") });
+    QCOMPARE(diff.removedTilesets, QStringList { QStringLiteral("a") });
+    QCOMPARE(diff.layers.size(), 1);
+    QVERIFY(!diff.layers.first().changedCells.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(test_MapDiff)
+#include "test_mapdiff.moc"
@@ -0,0 +1,81 @@
+#include "mapobject.h"
+
+#include <QtTest/QtTest>
+
+#include <QRandomGenerator>
+
+using namespace Tiled;
+
+class test_MapObject : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void simplifiedPolygon();
+    void simplifiedPolygonSmall();
+};
+
+static qreal distanceToSegment(const QPointF &point, const QPointF &start, const QPointF &end)
+{
+    const QPointF direction = end - start;
+    const qreal lengthSquared = QPointF::dotProduct(direction, direction);
+    qreal t = 0;
+    if (lengthSquared > 0)
+        t = qBound(0.0, QPointF::dotProduct(point - start, direction) / lengthSquared, 1.0);
+    return QLineF(point, start + direction * t).length();
+}
+
+static qreal distanceToPolyline(const QPointF &point, const QPolygonF &polyline)
+{
+    qreal distance = QLineF(point, polyline.first()).length();
+    for (int i = 1; i < polyline.size(); ++i)
+        distance = std::min(distance, distanceToSegment(point, polyline.at(i - 1), polyline.at(i)));
+    return distance;
+}
+
+void test_MapObject::simplifiedPolygon()
+{
+    // A noisy coastline
+    QRandomGenerator random(5);
+    QPolygonF polygon;
+    for (int i = 0; i < 2000; ++i)
+        polygon.append(QPointF(i, 100 * std::sin(i / 100.0) + random.bounded(4.0)));
+
+    MapObject object;
+    object.setShape(MapObject::Polyline);
+    object.setPolygon(polygon);
+
+    // Below a pixel the polygon is not simplified
+    QCOMPARE(object.simplifiedPolygon(0.5), polygon);
+
+    for (const qreal tolerance : { 1.0, 3.0, 8.0, 50.0 }) {
+        const QPolygonF &simplified = object.simplifiedPolygon(tolerance);
+
+        QVERIFY(simplified.size() < polygon.size());
+        QCOMPARE(simplified.first(), polygon.first());
+        QCOMPARE(simplified.last(), polygon.last());
+
+        for (const QPointF &point : polygon)
+            QVERIFY(distanceToPolyline(point, simplified) <= tolerance);
+    }
+
+    // Changing the polygon clears the cached levels
+    const QPolygonF line { QPointF(0, 0), QPointF(10, 0) };
+    object.setPolygon(QPolygonF(line + polygon));
+    QCOMPARE(object.simplifiedPolygon(8.0).first(), QPointF(0, 0));
+}
+
+void test_MapObject::simplifiedPolygonSmall()
+{
+    const QPolygonF polygon { QPointF(0, 0), QPointF(5, 0.1), QPointF(10, 0) };
+
+    MapObject object;
+    object.setShape(MapObject::Polygon);
+    object.setPolygon(polygon);
+
+    // Polygons with few points are never simplified
+    QCOMPARE(object.simplifiedPolygon(100.0), polygon);
+}
+
+QTEST_APPLESS_MAIN(test_MapObject)
+#include "test_mapobject.moc"
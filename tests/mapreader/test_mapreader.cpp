@@ -1,8 +1,14 @@
+#include "compression.h"
+#include "grouplayer.h"
 #include "map.h"
 #include "mapobject.h"
 #include "objectgroup.h"
+#include "tile.h"
 #include "tilelayer.h"
+#include "tileset.h"
+#include "tilesetmanager.h"
 #include "mapreader.h"
+#include "mapwriter.h"
 
 #include <QtTest/QtTest>
 
@@ -14,6 +20,16 @@ class test_MapReader : public QObject
 
 private slots:
     void loadMap();
+
+    void writeAndReadLayerData_data();
+    void writeAndReadLayerData();
+    void readCsvLayerData_data();
+    void readCsvLayerData();
+    void readBase64LayerData_data();
+    void readBase64LayerData();
+    void streamMap();
+    void compressionDictionary();
+    void lazyTileImages();
 };
 
 void test_MapReader::loadMap()
@@ -53,5 +69,352 @@ void test_MapReader::loadMap()
     QCOMPARE(mapObject->height(), qreal(64));
 }
 
+void test_MapReader::writeAndReadLayerData_data()
+{
+    QTest::addColumn<Map::LayerDataFormat>("format");
+    QTest::addColumn<bool>("infinite");
+    QTest::addColumn<QSize>("chunkSize");
+
+    const QSize nativeChunkSize(CHUNK_SIZE, CHUNK_SIZE);
+
+    QTest::newRow("xml") << Map::XML << false << nativeChunkSize;
+    QTest::newRow("csv") << Map::CSV << false << nativeChunkSize;
+    QTest::newRow("base64") << Map::Base64 << false << nativeChunkSize;
+    QTest::newRow("gzip") << Map::Base64Gzip << false << nativeChunkSize;
+    QTest::newRow("zlib") << Map::Base64Zlib << false << nativeChunkSize;
+    QTest::newRow("rle") << Map::Base64RunLength << false << nativeChunkSize;
+    QTest::newRow("csv-infinite") << Map::CSV << true << nativeChunkSize;
+    QTest::newRow("zlib-infinite") << Map::Base64Zlib << true << nativeChunkSize;
+    QTest::newRow("zlib-infinite-32x8") << Map::Base64Zlib << true << QSize(32, 8);
+    QTest::newRow("rle-infinite") << Map::Base64RunLength << true << nativeChunkSize;
+}
+
+void test_MapReader::writeAndReadLayerData()
+{
+    QFETCH(Map::LayerDataFormat, format);
+    QFETCH(bool, infinite);
+    QFETCH(QSize, chunkSize);
+
+    Map::Parameters parameters;
+    parameters.width = 40;
+    parameters.height = 30;
+    parameters.tileWidth = 32;
+    parameters.tileHeight = 32;
+    parameters.infinite = infinite;
+
+    Map map(parameters);
+    map.setLayerDataFormat(format);
+    map.setChunkSize(chunkSize);
+
+    SharedTileset tileset = Tileset::create(QStringLiteral("a"), 32, 32);
+    tileset->setNextTileId(100);
+    SharedTileset otherTileset = Tileset::create(QStringLiteral("b"), 32, 32);
+    otherTileset->setNextTileId(100);
+    map.addTileset(tileset);
+    map.addTileset(otherTileset);
+
+    for (int l = 0; l < 3; ++l) {
+        auto layer = new TileLayer(QStringLiteral("Layer %1").arg(l), 0, 0,
+                                   map.width(), map.height());
+
+        for (int y = 0; y < map.height(); ++y) {
+            for (int x = 0; x < map.width(); ++x) {
+                if ((x * 7 + y * 3 + l) % 5 == 0)
+                    continue;
+
+                Cell cell((x + y) % 2 ? tileset.data() : otherTileset.data(),
+                          (x * y + l) % 100);
+                cell.setFlippedHorizontally(x % 3 == 0);
+                cell.setFlippedVertically(y % 4 == 0);
+                layer->setCell(infinite ? x - 20 : x, y, cell);
+            }
+        }
+
+        map.addLayer(layer);
+    }
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+
+    MapWriter writer;
+    writer.writeMap(&map, &buffer);
+    buffer.seek(0);
+
+    MapReader reader;
+    auto readMap = reader.readMap(&buffer);
+    QVERIFY2(readMap, qUtf8Printable(reader.errorString()));
+    QCOMPARE(readMap->layerCount(), map.layerCount());
+
+    for (int l = 0; l < map.layerCount(); ++l) {
+        auto layer = static_cast<TileLayer*>(map.layerAt(l));
+        auto readLayer = dynamic_cast<TileLayer*>(readMap->layerAt(l));
+        QVERIFY(readLayer);
+        QCOMPARE(readLayer->region(), layer->region());
+
+        const QRect bounds = layer->localBounds();
+        for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
+            for (int x = bounds.left(); x <= bounds.right(); ++x) {
+                const Cell cell = layer->cellAt(x, y);
+                const Cell readCell = readLayer->cellAt(x, y);
+
+                QCOMPARE(readCell.isEmpty(), cell.isEmpty());
+                if (cell.isEmpty())
+                    continue;
+
+                QCOMPARE(readCell.tileset()->name(), cell.tileset()->name());
+                QCOMPARE(readCell.tileId(), cell.tileId());
+                QCOMPARE(readCell.flags(), cell.flags());
+            }
+        }
+    }
+}
+
+void test_MapReader::readCsvLayerData_data()
+{
+    QTest::addColumn<QString>("data");
+    QTest::addColumn<bool>("valid");
+
+    QTest::newRow("plain") << QStringLiteral("1,2,0,4,5,6") << true;
+    QTest::newRow("whitespace") << QStringLiteral("\n1, 2,0,\n 4,5 ,6\n") << true;
+    QTest::newRow("trailing-comma") << QStringLiteral("1,2,0,4,5,6,") << true;
+    QTest::newRow("too-short") << QStringLiteral("1,2,0,4,5") << false;
+    QTest::newRow("too-long") << QStringLiteral("1,2,0,4,5,6,7") << false;
+    QTest::newRow("not-a-number") << QStringLiteral("1,2,0,x,5,6") << false;
+    QTest::newRow("invalid-tile") << QStringLiteral("1,2,0,4,5,6") << false;
+}
+
+void test_MapReader::readCsvLayerData()
+{
+    QFETCH(QString, data);
+    QFETCH(bool, valid);
+
+    // The "invalid-tile" row refers to a tile before the first tileset
+    const int firstGid = QTest::currentDataTag() == QByteArrayLiteral("invalid-tile") ? 3 : 1;
+
+    const QString tmx = QStringLiteral(
+                "<map version=\"1.10\" orientation=\"orthogonal\" width=\"3\" height=\"2\" tilewidth=\"32\" tileheight=\"32\">"
+                "<tileset firstgid=\"%1\" name=\"a\" tilewidth=\"32\" tileheight=\"32\" tilecount=\"0\" columns=\"0\"/>"
+                "<layer name=\"Layer\" width=\"3\" height=\"2\"><data encoding=\"csv\">%2</data></layer>"
+                "</map>").arg(firstGid).arg(data);
+
+    QByteArray bytes = tmx.toUtf8();
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::ReadOnly);
+
+    MapReader reader;
+    auto map = reader.readMap(&buffer);
+    QCOMPARE(bool(map), valid);
+    if (!valid)
+        return;
+
+    auto layer = static_cast<TileLayer*>(map->layerAt(0));
+    QCOMPARE(layer->cellAt(0, 0).tileId(), 0);
+    QCOMPARE(layer->cellAt(1, 0).tileId(), 1);
+    QVERIFY(layer->cellAt(2, 0).isEmpty());
+    QCOMPARE(layer->cellAt(0, 1).tileId(), 3);
+    QCOMPARE(layer->cellAt(2, 1).tileId(), 5);
+}
+
+void test_MapReader::readBase64LayerData_data()
+{
+    QTest::addColumn<QString>("data");
+    QTest::addColumn<bool>("valid");
+
+    // The global tile IDs 1, 2, 0, 4, 5 and 6 in little-endian byte order
+    QByteArray gids;
+    for (const quint32 gid : { 1, 2, 0, 4, 5, 6 }) {
+        char bytes[4];
+        qToLittleEndian(gid, bytes);
+        gids.append(bytes, 4);
+    }
+    const QString base64 = QString::fromLatin1(gids.toBase64());
+
+    QTest::newRow("plain") << base64 << true;
+    QTest::newRow("whitespace") << (QLatin1String("\n   ") + base64.left(6) + QLatin1String("\n ") + base64.mid(6) + QLatin1String("\n")) << true;
+    QTest::newRow("too-short") << base64.left(base64.size() - 4) << false;
+    QTest::newRow("too-long") << (base64 + QLatin1String("AAAA")) << false;
+}
+
+void test_MapReader::readBase64LayerData()
+{
+    QFETCH(QString, data);
+    QFETCH(bool, valid);
+
+    const QString tmx = QStringLiteral(
+                "<map version=\"1.10\" orientation=\"orthogonal\" width=\"3\" height=\"2\" tilewidth=\"32\" tileheight=\"32\">"
+                "<tileset firstgid=\"1\" name=\"a\" tilewidth=\"32\" tileheight=\"32\" tilecount=\"0\" columns=\"0\"/>"
+                "<layer name=\"Layer\" width=\"3\" height=\"2\"><data encoding=\"base64\">%1</data></layer>"
+                "</map>").arg(data);
+
+    QByteArray bytes = tmx.toUtf8();
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::ReadOnly);
+
+    MapReader reader;
+    auto map = reader.readMap(&buffer);
+    QCOMPARE(bool(map), valid);
+    if (!valid)
+        return;
+
+    auto layer = static_cast<TileLayer*>(map->layerAt(0));
+    QCOMPARE(layer->cellAt(0, 0).tileId(), 0);
+    QCOMPARE(layer->cellAt(1, 0).tileId(), 1);
+    QVERIFY(layer->cellAt(2, 0).isEmpty());
+    QCOMPARE(layer->cellAt(0, 1).tileId(), 3);
+    QCOMPARE(layer->cellAt(2, 1).tileId(), 5);
+}
+
+void test_MapReader::streamMap()
+{
+    Map::Parameters parameters;
+    parameters.tileWidth = 32;
+    parameters.tileHeight = 32;
+    parameters.infinite = true;
+
+    Map map(parameters);
+    map.setProperty(QStringLiteral("name"), QStringLiteral("streamed"));
+
+    SharedTileset tileset = Tileset::create(QStringLiteral("a"), 32, 32);
+    tileset->setNextTileId(10);
+    map.addTileset(tileset);
+
+    auto tileLayer = new TileLayer(QStringLiteral("Tiles"), 0, 0, 0, 0);
+    tileLayer->setCell(-5, 3, Cell(tileset.data(), 1));
+    tileLayer->setCell(40, 70, Cell(tileset.data(), 2));
+    map.addLayer(tileLayer);
+
+    auto groupLayer = new GroupLayer(QStringLiteral("Group"), 0, 0);
+    auto childLayer = new TileLayer(QStringLiteral("Child"), 0, 0, 0, 0);
+    childLayer->setCell(100, -100, Cell(tileset.data(), 3));
+    groupLayer->addLayer(childLayer);
+    map.addLayer(groupLayer);
+
+    QBuffer source;
+    source.open(QIODevice::ReadWrite);
+    MapWriter().writeMap(&map, &source);
+    source.seek(0);
+
+    QBuffer target;
+    target.open(QIODevice::ReadWrite);
+
+    MapWriter writer;
+    QStringList streamedLayers;
+
+    MapReader reader;
+    auto streamedMap = reader.readMap(&source, QString(), [&] (Map &streamingMap, Layer &layer) {
+        if (streamedLayers.isEmpty())
+            writer.beginMap(&streamingMap, &target);
+        QCOMPARE(streamingMap.layerCount(), 1);
+        streamedLayers.append(layer.name());
+        writer.writeLayer(&layer);
+    });
+    QVERIFY2(streamedMap, qUtf8Printable(reader.errorString()));
+    QCOMPARE(streamedMap->layerCount(), 0);
+    QCOMPARE(streamedLayers, QStringList({ QStringLiteral("Tiles"), QStringLiteral("Group") }));
+    writer.endMap();
+    target.seek(0);
+
+    auto readMap = MapReader().readMap(&target);
+    QVERIFY(readMap);
+    QCOMPARE(readMap->property(QStringLiteral("name")).toString(), QStringLiteral("streamed"));
+    QCOMPARE(readMap->tilesetCount(), 1);
+    QCOMPARE(readMap->layerCount(), 2);
+
+    auto readTileLayer = readMap->layerAt(0)->asTileLayer();
+    QVERIFY(readTileLayer);
+    QCOMPARE(readTileLayer->region(), tileLayer->region());
+    QCOMPARE(readTileLayer->cellAt(40, 70).tileId(), 2);
+
+    auto readGroupLayer = readMap->layerAt(1)->asGroupLayer();
+    QVERIFY(readGroupLayer);
+    QCOMPARE(readGroupLayer->layerCount(), 1);
+    QCOMPARE(readGroupLayer->layerAt(0)->asTileLayer()->cellAt(100, -100).tileId(), 3);
+}
+
+void test_MapReader::compressionDictionary()
+{
+    if (!compressionSupported(Zstandard))
+        QSKIP("Zstandard compression not supported");
+
+    Map::Parameters parameters;
+    parameters.tileWidth = 32;
+    parameters.tileHeight = 32;
+    parameters.infinite = true;
+
+    Map map(parameters);
+    map.setLayerDataFormat(Map::Base64Zstandard);
+    map.setUseCompressionDictionary(true);
+
+    SharedTileset tileset = Tileset::create(QStringLiteral("a"), 32, 32);
+    tileset->setNextTileId(64);
+    map.addTileset(tileset);
+
+    auto tileLayer = new TileLayer(QStringLiteral("Tiles"), 0, 0, 0, 0);
+    for (int y = 0; y < 240; ++y)
+        for (int x = 0; x < 240; ++x)
+            tileLayer->setCell(x, y, Cell(tileset.data(), (x / 3 + y * 7) % 64));
+    map.addLayer(tileLayer);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    MapWriter().writeMap(&map, &buffer);
+    QVERIFY(buffer.data().contains("<compressiondictionary encoding=\"base64\">"));
+    buffer.seek(0);
+
+    MapReader reader;
+    auto readMap = reader.readMap(&buffer);
+    QVERIFY2(readMap, qUtf8Printable(reader.errorString()));
+    QVERIFY(readMap->useCompressionDictionary());
+    QVERIFY(!readMap->compressionDictionary().isEmpty());
+
+    auto readTileLayer = readMap->layerAt(0)->asTileLayer();
+    QVERIFY(readTileLayer);
+    QCOMPARE(readTileLayer->region(), tileLayer->region());
+    for (int y = 0; y < 240; ++y)
+        for (int x = 0; x < 240; ++x)
+            QCOMPARE(readTileLayer->cellAt(x, y).tileId(), tileLayer->cellAt(x, y).tileId());
+}
+
+void test_MapReader::lazyTileImages()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QImage image(24, 40, QImage::Format_ARGB32);
+    image.fill(Qt::red);
+    QVERIFY(image.save(dir.filePath(QStringLiteral("tile.png"))));
+
+    const QByteArray tmx =
+            "<map version=\"1.10\" orientation=\"orthogonal\" width=\"1\" height=\"1\" tilewidth=\"32\" tileheight=\"32\">"
+            "<tileset firstgid=\"1\" name=\"a\" tilewidth=\"32\" tileheight=\"32\" tilecount=\"1\" columns=\"0\">"
+            "<tile id=\"0\"><image width=\"24\" height=\"40\" source=\"tile.png\"/></tile>"
+            "</tileset>"
+            "</map>";
+
+    TilesetManager::instance()->setLazyImageLoading(true);
+
+    QBuffer buffer;
+    buffer.setData(tmx);
+    buffer.open(QIODevice::ReadOnly);
+
+    MapReader reader;
+    auto map = reader.readMap(&buffer, dir.path());
+
+    TilesetManager::instance()->setLazyImageLoading(false);
+
+    QVERIFY2(map, qUtf8Printable(reader.errorString()));
+
+    const SharedTileset &tileset = map->tilesetAt(0);
+    const Tile *tile = tileset->findTile(0);
+    QVERIFY(tile);
+
+    // The size is known before the image is loaded
+    QCOMPARE(tile->imageStatus(), LoadingPending);
+    QCOMPARE(tile->size(), QSize(24, 40));
+
+    QCOMPARE(tile->image().size(), QSize(24, 40));
+    QCOMPARE(tile->imageStatus(), LoadingReady);
+}
+
 QTEST_MAIN(test_MapReader)
 #include "test_mapreader.moc"
@@ -0,0 +1,337 @@
+#include "grouplayer.h"
+#include "map.h"
+#include "mapobject.h"
+#include "objectgroup.h"
+
+#include <QtTest/QtTest>
+
+#include <QRandomGenerator>
+
+using namespace Tiled;
+
+class test_ObjectGroup : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void findObjectById();
+    void mapFindObjectById();
+    void objectsIntersecting();
+    void objectsIntersectingAfterChanges();
+    void objectsInDrawOrder();
+
+    void benchmarkObjectsIntersecting();
+};
+
+/**
+ * The reference implementation, checking each object.
+ */
+static QList<MapObject*> scanObjectsIntersecting(const ObjectGroup &objectGroup, const QRectF &rect)
+{
+    QList<MapObject*> objects;
+
+    for (MapObject *object : objectGroup) {
+        QRectF bounds;
+
+        switch (object->shape()) {
+        case MapObject::Polygon:
+        case MapObject::Polyline: {
+            QTransform transform;
+            transform.translate(object->x(), object->y());
+            transform.rotate(object->rotation());
+            bounds = transform.map(object->polygon()).boundingRect();
+            break;
+        }
+        case MapObject::Point:
+            bounds = QRectF(object->position(), QSizeF(0, 0));
+            break;
+        default:
+            bounds = object->bounds();
+            if (object->rotation() != 0.0) {
+                QTransform transform;
+                transform.translate(object->x(), object->y());
+                transform.rotate(object->rotation());
+                transform.translate(-object->x(), -object->y());
+                bounds = transform.mapRect(bounds);
+            }
+            break;
+        }
+        }
+
+        if (bounds.left() <= rect.right() && rect.left() <= bounds.right() &&
+                bounds.top() <= rect.bottom() && rect.top() <= bounds.bottom())
+            objects.append(object);
+    }
+
+    std::sort(objects.begin(), objects.end(), [] (const MapObject *a, const MapObject *b) {
+        return a->id() < b->id();
+    });
+
+    return objects;
+}
+
+static std::unique_ptr<MapObject> randomObject(QRandomGenerator &random, int id)
+{
+    const QPointF position(random.bounded(2000.0), random.bounded(2000.0));
+    const QSizeF size(random.bounded(100.0), random.bounded(100.0));
+
+    auto object = std::make_unique<MapObject>(QString(), QString(), position, size);
+    object->setId(id);
+
+    switch (random.bounded(4)) {
+    case 0:
+        object->setShape(MapObject::Point);
+        object->setSize(QSizeF(0, 0));
+        break;
+    case 1:
+        object->setShape(MapObject::Polygon);
+        object->setPolygon(QPolygonF({ QPointF(0, 0),
+                                       QPointF(random.bounded(200.0) - 100, random.bounded(50.0)),
+                                       QPointF(random.bounded(50.0), random.bounded(200.0) - 100) }));
+        break;
+    case 2:
+        object->setRotation(random.bounded(360.0));
+        break;
+    default:
+        // Some big objects, to cover objects that don't fit in a few cells
+        if (random.bounded(10) == 0)
+            object->setSize(QSizeF(random.bounded(2000.0), random.bounded(2000.0)));
+        break;
+    }
+
+    return object;
+}
+
+static QRectF randomRect(QRandomGenerator &random)
+{
+    return QRectF(random.bounded(2200.0) - 100, random.bounded(2200.0) - 100,
+                  random.bounded(400.0), random.bounded(400.0));
+}
+
+void test_ObjectGroup::findObjectById()
+{
+    ObjectGroup objectGroup;
+
+    QRandomGenerator random(1);
+    for (int id = 1; id <= 10; ++id)
+        objectGroup.addObject(randomObject(random, id));
+
+    MapObject *fifth = objectGroup.objectAt(4);
+    QCOMPARE(objectGroup.findObjectById(5), fifth);
+    QCOMPARE(objectGroup.findObjectById(11), nullptr);
+
+    fifth->setId(20);
+    QCOMPARE(objectGroup.findObjectById(5), nullptr);
+    QCOMPARE(objectGroup.findObjectById(20), fifth);
+
+    objectGroup.removeObject(fifth);
+    QCOMPARE(objectGroup.findObjectById(20), nullptr);
+
+    objectGroup.insertObject(0, fifth);
+    QCOMPARE(objectGroup.findObjectById(20), fifth);
+
+    // With duplicate IDs, the first object is returned
+    auto duplicate = randomObject(random, 20);
+    MapObject *duplicatePtr = duplicate.get();
+    objectGroup.addObject(std::move(duplicate));
+    QCOMPARE(objectGroup.findObjectById(20), fifth);
+
+    objectGroup.removeObject(fifth);
+    QCOMPARE(objectGroup.findObjectById(20), duplicatePtr);
+
+    delete fifth;
+}
+
+void test_ObjectGroup::mapFindObjectById()
+{
+    Map map;
+
+    auto objectGroup = new ObjectGroup;
+    auto first = new MapObject;
+    auto second = new MapObject;
+    objectGroup->addObject(first);
+    map.addLayer(objectGroup);
+    objectGroup->addObject(second);
+
+    QCOMPARE(first->id(), 1);
+    QCOMPARE(second->id(), 2);
+    QCOMPARE(map.findObjectById(1), first);
+    QCOMPARE(map.findObjectById(2), second);
+
+    // Objects in nested layers are found, also when adding them after the
+    // lookup table was created
+    auto groupLayer = new GroupLayer(QString(), 0, 0);
+    auto nestedGroup = new ObjectGroup;
+    auto nested = new MapObject;
+    nestedGroup->addObject(nested);
+    groupLayer->addLayer(std::unique_ptr<Layer>(nestedGroup));
+    map.addLayer(groupLayer);
+
+    QCOMPARE(nested->id(), 3);
+    QCOMPARE(map.findObjectById(3), nested);
+
+    // Removed layers and objects are no longer found
+    std::unique_ptr<Layer> takenLayer(map.takeLayerAt(1));
+    QCOMPARE(map.findObjectById(3), nullptr);
+
+    objectGroup->removeObject(first);
+    QCOMPARE(map.findObjectById(1), nullptr);
+    QCOMPARE(map.findObjectById(2), second);
+
+    // Changed IDs are picked up
+    second->setId(10);
+    QCOMPARE(map.findObjectById(2), nullptr);
+    QCOMPARE(map.findObjectById(10), second);
+
+    delete first;
+}
+
+void test_ObjectGroup::objectsIntersecting()
+{
+    ObjectGroup objectGroup;
+
+    QRandomGenerator random(2);
+    for (int id = 1; id <= 1000; ++id)
+        objectGroup.addObject(randomObject(random, id));
+
+    for (int i = 0; i < 200; ++i) {
+        const QRectF rect = randomRect(random);
+        QCOMPARE(objectGroup.objectsIntersecting(rect),
+                 scanObjectsIntersecting(objectGroup, rect));
+    }
+
+    // A rect covering everything
+    const QRectF everything(-1000, -1000, 5000, 5000);
+    QCOMPARE(objectGroup.objectsIntersecting(everything).size(), objectGroup.objectCount());
+}
+
+void test_ObjectGroup::objectsIntersectingAfterChanges()
+{
+    ObjectGroup objectGroup;
+
+    QRandomGenerator random(3);
+    int nextId = 1;
+    for (; nextId <= 1000; ++nextId)
+        objectGroup.addObject(randomObject(random, nextId));
+
+    // Create the index
+    objectGroup.objectsIntersecting(QRectF(0, 0, 1, 1));
+
+    for (int round = 0; round < 20; ++round) {
+        // Move, resize and rotate a few objects
+        for (int i = 0; i < 20; ++i) {
+            MapObject *object = objectGroup.objectAt(random.bounded(objectGroup.objectCount()));
+            switch (random.bounded(3)) {
+            case 0:
+                object->setPosition(QPointF(random.bounded(2000.0), random.bounded(2000.0)));
+                break;
+            case 1:
+                object->setSize(QSizeF(random.bounded(300.0), random.bounded(300.0)));
+                break;
+            case 2:
+                object->setRotation(random.bounded(360.0));
+                break;
+            }
+        }
+
+        // Remove and add some objects
+        for (int i = 0; i < 10; ++i) {
+            MapObject *object = objectGroup.objectAt(0);
+            objectGroup.removeObjectAt(0);
+            delete object;
+        }
+        for (int i = 0; i < 10; ++i, ++nextId)
+            objectGroup.insertObject(random.bounded(objectGroup.objectCount()),
+                                     randomObject(random, nextId).release());
+
+        for (int i = 0; i < 20; ++i) {
+            const QRectF rect = randomRect(random);
+            QCOMPARE(objectGroup.objectsIntersecting(rect),
+                     scanObjectsIntersecting(objectGroup, rect));
+        }
+    }
+
+    // Moving all objects makes the index get recreated
+    objectGroup.offsetObjects(QPointF(500, 500), QRectF(), true, false, false);
+
+    for (int i = 0; i < 20; ++i) {
+        const QRectF rect = randomRect(random);
+        QCOMPARE(objectGroup.objectsIntersecting(rect),
+                 scanObjectsIntersecting(objectGroup, rect));
+    }
+}
+
+/**
+ * The reference implementation, sorting all objects.
+ */
+static QList<MapObject*> sortObjectsInDrawOrder(const ObjectGroup &objectGroup)
+{
+    QList<MapObject*> objects = objectGroup.objects();
+    std::stable_sort(objects.begin(), objects.end(), [] (const MapObject *a, const MapObject *b) {
+        return a->y() < b->y();
+    });
+    return objects;
+}
+
+void test_ObjectGroup::objectsInDrawOrder()
+{
+    ObjectGroup objectGroup;
+
+    // Use few distinct y-coordinates, to check the order of equal ones
+    QRandomGenerator random(4);
+    const auto randomPosition = [&] {
+        return QPointF(random.bounded(2000.0), random.bounded(50));
+    };
+
+    for (int id = 1; id <= 200; ++id) {
+        auto object = std::make_unique<MapObject>(QString(), QString(), randomPosition(), QSizeF(10, 10));
+        object->setId(id);
+        objectGroup.addObject(std::move(object));
+    }
+
+    QCOMPARE(objectGroup.objectsInDrawOrder(), sortObjectsInDrawOrder(objectGroup));
+
+    // Moving single objects
+    for (int i = 0; i < 50; ++i) {
+        objectGroup.objectAt(random.bounded(objectGroup.objectCount()))->setPosition(randomPosition());
+        QCOMPARE(objectGroup.objectsInDrawOrder(), sortObjectsInDrawOrder(objectGroup));
+    }
+
+    // Moving many objects at once
+    for (int i = 0; i < 50; ++i)
+        objectGroup.objectAt(random.bounded(objectGroup.objectCount()))->setPosition(randomPosition());
+    QCOMPARE(objectGroup.objectsInDrawOrder(), sortObjectsInDrawOrder(objectGroup));
+
+    // Changing the stacking order
+    objectGroup.moveObjects(0, 100, 10);
+    QCOMPARE(objectGroup.objectsInDrawOrder(), sortObjectsInDrawOrder(objectGroup));
+
+    objectGroup.setDrawOrder(ObjectGroup::IndexOrder);
+    QCOMPARE(objectGroup.objectsInDrawOrder(), objectGroup.objects());
+}
+
+void test_ObjectGroup::benchmarkObjectsIntersecting()
+{
+    ObjectGroup objectGroup;
+
+    // Spread 200,000 small objects over a large area
+    QRandomGenerator random(4);
+    for (int id = 1; id <= 200000; ++id) {
+        const QPointF position(random.bounded(100000.0), random.bounded(100000.0));
+        auto object = std::make_unique<MapObject>(QString(), QString(), position, QSizeF(32, 32));
+        object->setId(id);
+        objectGroup.addObject(std::move(object));
+    }
+
+    objectGroup.objectsIntersecting(QRectF(0, 0, 1, 1));
+
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i) {
+            const QRectF rect(random.bounded(100000.0), random.bounded(100000.0), 1000, 1000);
+            objectGroup.objectsIntersecting(rect);
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(test_ObjectGroup)
+#include "test_objectgroup.moc"
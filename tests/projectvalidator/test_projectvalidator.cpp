@@ -0,0 +1,143 @@
+#include "project.h"
+#include "projectvalidator.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_ProjectValidator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void reportsProblems();
+    void ignoresFilesThatAreNotMaps();
+    void reusesCachedResults();
+
+private:
+    void writeFile(const QString &fileName, const QByteArray &contents);
+    QVector<ProjectValidator::MapResult> validate();
+
+    std::unique_ptr<QTemporaryDir> mDir;
+    std::unique_ptr<Project> mProject;
+};
+
+static const char brokenMap[] =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<map version=\"1.10\" orientation=\"orthogonal\" width=\"2\" height=\"2\" tilewidth=\"16\" tileheight=\"16\">\n"
+        " <properties>\n"
+        "  <property name=\"settings\" type=\"class\" propertytype=\"Unknown\"/>\n"
+        " </properties>\n"
+        " <tileset firstgid=\"1\" source=\"missing.tsx\"/>\n"
+        " <tileset firstgid=\"5\" name=\"tiles\" tilewidth=\"16\" tileheight=\"16\" tilecount=\"4\" columns=\"2\">\n"
+        "  <image source=\"missing.png\" width=\"32\" height=\"32\"/>\n"
+        " </tileset>\n"
+        " <layer id=\"1\" name=\"Ground\" width=\"2\" height=\"2\">\n"
+        "  <data encoding=\"csv\">\n"
+        "3,8,\n"
+        "9,0\n"
+        "</data>\n"
+        " </layer>\n"
+        " <objectgroup id=\"2\" name=\"Objects\">\n"
+        "  <object id=\"1\" template=\"missing.tx\" x=\"0\" y=\"0\"/>\n"
+        "  <object id=\"2\" gid=\"12\" x=\"0\" y=\"16\" width=\"16\" height=\"16\"/>\n"
+        " </objectgroup>\n"
+        "</map>\n";
+
+static const char validJsonMap[] =
+        "{ \"type\": \"map\", \"width\": 2, \"height\": 1, \"tilewidth\": 16, \"tileheight\": 16,\n"
+        "  \"tilesets\": [ { \"firstgid\": 1, \"name\": \"tiles\", \"tilecount\": 2, \"tiles\": [] } ],\n"
+        "  \"layers\": [ { \"type\": \"tilelayer\", \"name\": \"Ground\", \"width\": 2, \"height\": 1,\n"
+        "                \"data\": [ 1, 2147483650 ] } ] }\n";
+
+void test_ProjectValidator::init()
+{
+    mDir = std::make_unique<QTemporaryDir>();
+    QVERIFY(mDir->isValid());
+
+    mProject = std::make_unique<Project>();
+    mProject->addFolder(mDir->path());
+    QVERIFY(mProject->save(mDir->filePath(QStringLiteral("test.tiled-project"))));
+}
+
+void test_ProjectValidator::cleanup()
+{
+    mProject.reset();
+    mDir.reset();
+}
+
+void test_ProjectValidator::reportsProblems()
+{
+    writeFile(QStringLiteral("broken.tmx"), brokenMap);
+
+    const auto results = validate();
+    QCOMPARE(results.size(), 1);
+
+    QStringList texts;
+    for (const ProjectValidator::Problem &problem : results.first().problems)
+        texts.append(problem.text);
+
+    QCOMPARE(texts.size(), 6);
+    QVERIFY(texts.contains(QStringLiteral("Unknown property type 'Unknown'")));
+    QVERIFY(texts.contains(QStringLiteral("Tileset 'missing.tsx' not found")));
+    QVERIFY(texts.contains(QStringLiteral("Image 'missing.png' not found")));
+    QVERIFY(texts.contains(QStringLiteral("Layer 'Ground' uses 1 tile(s) that are not part of any tileset")));
+    QVERIFY(texts.contains(QStringLiteral("Template 'missing.tx' not found")));
+    QVERIFY(texts.contains(QStringLiteral("Object 2 uses a tile that is not part of any tileset")));
+}
+
+void test_ProjectValidator::ignoresFilesThatAreNotMaps()
+{
+    writeFile(QStringLiteral("valid.tmj"), validJsonMap);
+    writeFile(QStringLiteral("data.json"), "{ \"foo\": [ 1, 2, 3 ] }");
+
+    const auto results = validate();
+    QCOMPARE(results.size(), 1);
+    QVERIFY(results.first().fileName.endsWith(QLatin1String("valid.tmj")));
+    QVERIFY(results.first().problems.isEmpty());
+}
+
+void test_ProjectValidator::reusesCachedResults()
+{
+    writeFile(QStringLiteral("broken.tmx"), brokenMap);
+    writeFile(QStringLiteral("valid.tmj"), validJsonMap);
+
+    auto results = validate();
+    QCOMPARE(results.size(), 2);
+    QVERIFY(!results.at(0).cached);
+    QVERIFY(!results.at(1).cached);
+    const int problemCount = results.at(0).problems.size();
+
+    results = validate();
+    QCOMPARE(results.size(), 2);
+    QVERIFY(results.at(0).cached);
+    QVERIFY(results.at(1).cached);
+    QCOMPARE(results.at(0).problems.size(), problemCount);
+
+    // Providing one of the missing files invalidates the cached results
+    writeFile(QStringLiteral("missing.tx"), "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<template/>\n");
+
+    results = validate();
+    QCOMPARE(results.size(), 2);
+    QVERIFY(!results.at(0).cached);
+    QVERIFY(results.at(1).cached);
+    QCOMPARE(results.at(0).problems.size(), problemCount - 1);
+}
+
+void test_ProjectValidator::writeFile(const QString &fileName, const QByteArray &contents)
+{
+    QFile file(mDir->filePath(fileName));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(contents);
+}
+
+QVector<ProjectValidator::MapResult> test_ProjectValidator::validate()
+{
+    return ProjectValidator(*mProject).validate();
+}
+
+QTEST_MAIN(test_ProjectValidator)
+#include "test_projectvalidator.moc"
@@ -0,0 +1,109 @@
+#include "randompicker.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_RandomPicker : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void aliasPickerSingleValue();
+    void aliasPickerSkipsZeroProbability();
+    void aliasPickerDistribution_data();
+    void aliasPickerDistribution();
+    void seededPicksAreReproducible();
+};
+
+void test_RandomPicker::aliasPickerSingleValue()
+{
+    AliasPicker<int> picker;
+    QVERIFY(picker.isEmpty());
+
+    picker.add(42, 0.5);
+    QCOMPARE(picker.size(), 1);
+
+    for (int i = 0; i < 10; ++i)
+        QCOMPARE(picker.pick(), 42);
+}
+
+void test_RandomPicker::aliasPickerSkipsZeroProbability()
+{
+    AliasPicker<int> picker;
+    picker.add(1, 0.0);
+    picker.add(2, 1.0);
+    picker.add(3, -1.0);
+    picker.add(4, 1.0);
+
+    QCOMPARE(picker.size(), 2);
+
+    for (int i = 0; i < 1000; ++i) {
+        const int value = picker.pick();
+        QVERIFY(value == 2 || value == 4);
+    }
+}
+
+void test_RandomPicker::aliasPickerDistribution_data()
+{
+    QTest::addColumn<QVector<qreal>>("probabilities");
+
+    QTest::newRow("uniform") << QVector<qreal> { 1, 1, 1, 1 };
+    QTest::newRow("skewed") << QVector<qreal> { 0.1, 5, 1, 0.4, 2.5 };
+    QTest::newRow("dominant") << QVector<qreal> { 100, 1 };
+}
+
+void test_RandomPicker::aliasPickerDistribution()
+{
+    QFETCH(QVector<qreal>, probabilities);
+
+    seedGlobalRandomEngine(1234);
+
+    AliasPicker<int> picker;
+    qreal sum = 0;
+    for (int i = 0; i < probabilities.size(); ++i) {
+        picker.add(i, probabilities.at(i));
+        sum += probabilities.at(i);
+    }
+
+    constexpr int pickCount = 100000;
+    QVector<int> counts(probabilities.size());
+    for (int i = 0; i < pickCount; ++i)
+        ++counts[picker.pick()];
+
+    for (int i = 0; i < probabilities.size(); ++i) {
+        const qreal expected = probabilities.at(i) / sum;
+        const qreal actual = qreal(counts.at(i)) / pickCount;
+        QVERIFY2(qAbs(actual - expected) < 0.01,
+                 qPrintable(QStringLiteral("value %1: expected %2, got %3")
+                            .arg(i).arg(expected).arg(actual)));
+    }
+}
+
+void test_RandomPicker::seededPicksAreReproducible()
+{
+    AliasPicker<int> aliasPicker;
+    RandomPicker<int> randomPicker;
+    for (int i = 0; i < 10; ++i) {
+        aliasPicker.add(i, i + 1);
+        randomPicker.add(i, i + 1);
+    }
+
+    const auto picks = [&] {
+        QVector<int> result;
+        for (int i = 0; i < 100; ++i) {
+            result.append(aliasPicker.pick());
+            result.append(randomPicker.pick());
+        }
+        return result;
+    };
+
+    seedGlobalRandomEngine(42);
+    const QVector<int> first = picks();
+
+    seedGlobalRandomEngine(42);
+    QCOMPARE(picks(), first);
+}
+
+QTEST_MAIN(test_RandomPicker)
+#include "test_randompicker.moc"
@@ -0,0 +1,340 @@
+#include "map.h"
+#include "maprenderer.h"
+#include "minimaprenderer.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QtTest/QtTest>
+
+#include <memory>
+
+using namespace Tiled;
+
+/*
+ * Benchmarks rendering generated maps with each of the map renderers and
+ * with the mini-map renderer.
+ *
+ * The size of the maps can be set using the TILED_BENCHMARK_SIZE environment
+ * variable (default: 128). Besides the timings reported by QTest, lines
+ * starting with "RESULT," report the frames per second and the number of
+ * times the CellRenderer had to flush its batch of fragments per frame, as
+ * comma-separated values.
+ */
+
+namespace {
+
+enum class LayerKind {
+    Plain,
+    Flipped,
+    Tinted,
+    ImageCollection,
+    Parallax,
+};
+
+} // anonymous namespace
+
+Q_DECLARE_METATYPE(LayerKind)
+
+static const QSize viewSize(1024, 768);
+
+static int benchmarkSize()
+{
+    bool ok;
+    const int size = qEnvironmentVariableIntValue("TILED_BENCHMARK_SIZE", &ok);
+    return ok && size > 0 ? size : 128;
+}
+
+static void reportResult(const char *measure, double value)
+{
+    qInfo().noquote() << QStringLiteral("RESULT,%1,%2,%3,%4")
+                         .arg(QLatin1String(QTest::currentTestFunction()),
+                              QLatin1String(QTest::currentDataTag()),
+                              QLatin1String(measure),
+                              QString::number(value));
+}
+
+static const char *orientationName(Map::Orientation orientation)
+{
+    switch (orientation) {
+    case Map::Orthogonal:   return "orthogonal";
+    case Map::Isometric:    return "isometric";
+    case Map::Staggered:    return "staggered";
+    case Map::Hexagonal:    return "hexagonal";
+    default:                return "unknown";
+    }
+}
+
+static const char *layerKindName(LayerKind kind)
+{
+    switch (kind) {
+    case LayerKind::Plain:              return "plain";
+    case LayerKind::Flipped:            return "flipped";
+    case LayerKind::Tinted:             return "tinted";
+    case LayerKind::ImageCollection:    return "collection";
+    case LayerKind::Parallax:           return "parallax";
+    }
+    return "unknown";
+}
+
+/**
+ * Creates an image with \a columns by \a rows differently colored tiles of
+ * the given \a tileSize, with a transparent border to make the tiles
+ * require alpha blending.
+ */
+static QImage createTilesetImage(QSize tileSize, int columns, int rows)
+{
+    QImage image(tileSize.width() * columns, tileSize.height() * rows,
+                 QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            const QRect rect(QPoint(x * tileSize.width(), y * tileSize.height()), tileSize);
+            const QColor color = QColor::fromHsv((x + y * columns) * 360 / (columns * rows), 160, 220);
+            painter.fillRect(rect.adjusted(1, 1, -1, -1), color);
+        }
+    }
+
+    return image;
+}
+
+static std::unique_ptr<Map> createMap(Map::Orientation orientation)
+{
+    const int size = benchmarkSize();
+
+    Map::Parameters parameters;
+    parameters.orientation = orientation;
+    parameters.width = size;
+    parameters.height = size;
+    parameters.tileWidth = orientation == Map::Isometric || orientation == Map::Staggered ? 64 : 32;
+    parameters.tileHeight = 32;
+    if (orientation == Map::Hexagonal)
+        parameters.hexSideLength = 16;
+
+    auto map = std::make_unique<Map>(parameters);
+    const QSize tileSize = map->tileSize();
+
+    SharedTileset tileset = Tileset::create(QStringLiteral("tiles"),
+                                            tileSize.width(), tileSize.height());
+    tileset->loadFromImage(createTilesetImage(tileSize, 16, 16), QUrl());
+    map->addTileset(tileset);
+
+    // Image collection tiles are twice as high as the grid, so they overlap
+    SharedTileset collection = Tileset::create(QStringLiteral("collection"), 0, 0);
+    const QImage collectionImage = createTilesetImage(QSize(tileSize.width(), tileSize.height() * 2), 4, 4);
+    for (int i = 0; i < 16; ++i) {
+        const QRect rect(QPoint(i % 4 * tileSize.width(), i / 4 * tileSize.height() * 2),
+                         QSize(tileSize.width(), tileSize.height() * 2));
+        collection->addTile(QPixmap::fromImage(collectionImage.copy(rect)));
+    }
+    map->addTileset(collection);
+
+    for (LayerKind kind : { LayerKind::Plain,
+                            LayerKind::Flipped,
+                            LayerKind::Tinted,
+                            LayerKind::ImageCollection,
+                            LayerKind::Parallax }) {
+        auto layer = std::make_unique<TileLayer>(QLatin1String(layerKindName(kind)),
+                                                 0, 0, size, size);
+
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                Cell cell;
+
+                if (kind == LayerKind::ImageCollection) {
+                    if ((x + y) % 3 != 0)
+                        continue;
+                    cell = Cell(collection->findTile((x * 7 + y) % 16));
+                } else {
+                    cell = Cell(tileset.data(), (x * 7 + y * 3) % 256);
+                }
+
+                if (kind == LayerKind::Flipped) {
+                    cell.setFlippedHorizontally(x % 2 == 0);
+                    cell.setFlippedVertically(y % 2 == 0);
+                    cell.setFlippedAntiDiagonally((x + y) % 3 == 0);
+                }
+
+                layer->setCell(x, y, cell);
+            }
+        }
+
+        if (kind == LayerKind::Tinted)
+            layer->setTintColor(QColor(255, 128, 128, 200));
+        if (kind == LayerKind::Parallax)
+            layer->setParallaxFactor(QPointF(0.5, 0.5));
+
+        map->addLayer(std::move(layer));
+    }
+
+    return map;
+}
+
+class test_RenderBenchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void drawTileLayer_data();
+    void drawTileLayer();
+
+    void miniMapRenderer_data();
+    void miniMapRenderer();
+
+private:
+    const Map *map(Map::Orientation orientation) const;
+
+    std::vector<std::unique_ptr<Map>> mMaps;
+};
+
+static const Map::Orientation orientations[] = {
+    Map::Orthogonal,
+    Map::Isometric,
+    Map::Staggered,
+    Map::Hexagonal,
+};
+
+void test_RenderBenchmarks::initTestCase()
+{
+    for (Map::Orientation orientation : orientations)
+        mMaps.push_back(createMap(orientation));
+}
+
+void test_RenderBenchmarks::cleanupTestCase()
+{
+    mMaps.clear();
+}
+
+const Map *test_RenderBenchmarks::map(Map::Orientation orientation) const
+{
+    for (const auto &map : mMaps)
+        if (map->orientation() == orientation)
+            return map.get();
+    return nullptr;
+}
+
+void test_RenderBenchmarks::drawTileLayer_data()
+{
+    QTest::addColumn<Map::Orientation>("orientation");
+    QTest::addColumn<LayerKind>("layerKind");
+    QTest::addColumn<qreal>("scale");
+
+    for (Map::Orientation orientation : orientations) {
+        for (LayerKind kind : { LayerKind::Plain,
+                                LayerKind::Flipped,
+                                LayerKind::Tinted,
+                                LayerKind::ImageCollection,
+                                LayerKind::Parallax }) {
+            for (qreal scale : { 0.25, 1.0, 2.0 }) {
+                const QByteArray tag = QByteArray(orientationName(orientation))
+                        + '-' + layerKindName(kind)
+                        + '-' + QByteArray::number(scale);
+                QTest::newRow(tag.constData()) << orientation << kind << scale;
+            }
+        }
+    }
+}
+
+void test_RenderBenchmarks::drawTileLayer()
+{
+    QFETCH(Map::Orientation, orientation);
+    QFETCH(LayerKind, layerKind);
+    QFETCH(qreal, scale);
+
+    const Map *map = this->map(orientation);
+    const auto renderer = MapRenderer::create(map);
+    renderer->setPainterScale(scale);
+
+    const TileLayer *layer = map->layerAt(static_cast<int>(layerKind))->asTileLayer();
+    QVERIFY(layer);
+
+    // Show the center of the map, like a view would after opening it
+    const QSizeF exposedSize(viewSize.width() / scale, viewSize.height() / scale);
+    QRectF exposed(QPointF(), exposedSize);
+    exposed.moveCenter(renderer->mapBoundingRect().center());
+
+    // Apply the parallax offset like the MapScene does
+    const QPointF parallaxFactor = layer->effectiveParallaxFactor();
+    const QPointF parallaxOffset((1.0 - parallaxFactor.x()) * exposed.center().x(),
+                                 (1.0 - parallaxFactor.y()) * exposed.center().y());
+
+    QImage image(viewSize, QImage::Format_ARGB32_Premultiplied);
+
+    const quint64 flushCountBefore = RenderStatistics::current().flushes;
+    int frames = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK {
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        painter.scale(scale, scale);
+        painter.translate(-exposed.topLeft() + parallaxOffset);
+        renderer->drawTileLayer(&painter, layer, exposed.translated(-parallaxOffset));
+        painter.end();
+
+        ++frames;
+    }
+
+    const qint64 elapsed = timer.nsecsElapsed();
+    const quint64 flushes = RenderStatistics::current().flushes - flushCountBefore;
+
+    if (elapsed > 0)
+        reportResult("fps", frames * 1e9 / elapsed);
+    reportResult("flushes", double(flushes) / frames);
+}
+
+void test_RenderBenchmarks::miniMapRenderer_data()
+{
+    QTest::addColumn<Map::Orientation>("orientation");
+    QTest::addColumn<int>("size");
+
+    for (Map::Orientation orientation : orientations) {
+        for (int size : { 128, 256, 512 }) {
+            const QByteArray tag = QByteArray(orientationName(orientation))
+                    + '-' + QByteArray::number(size);
+            QTest::newRow(tag.constData()) << orientation << size;
+        }
+    }
+}
+
+void test_RenderBenchmarks::miniMapRenderer()
+{
+    QFETCH(Map::Orientation, orientation);
+    QFETCH(int, size);
+
+    const MiniMapRenderer miniMapRenderer(map(orientation));
+    const MiniMapRenderer::RenderFlags flags = MiniMapRenderer::DrawTileLayers
+            | MiniMapRenderer::DrawBackground
+            | MiniMapRenderer::SmoothPixmapTransform;
+
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+
+    const quint64 flushCountBefore = RenderStatistics::current().flushes;
+    int frames = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK {
+        miniMapRenderer.renderToImage(image, flags);
+        ++frames;
+    }
+
+    const qint64 elapsed = timer.nsecsElapsed();
+    const quint64 flushes = RenderStatistics::current().flushes - flushCountBefore;
+
+    if (elapsed > 0)
+        reportResult("fps", frames * 1e9 / elapsed);
+    reportResult("flushes", double(flushes) / frames);
+}
+
+QTEST_MAIN(test_RenderBenchmarks)
+#include "test_renderbenchmarks.moc"
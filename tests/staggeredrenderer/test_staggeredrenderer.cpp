@@ -1,3 +1,4 @@
+#include "isometricrenderer.h"
 #include "map.h"
 #include "mapobject.h"
 #include "objectgroup.h"
@@ -29,6 +30,8 @@ private slots:
 
     void relativeCoordinates();
 
+    void batchedCoordinates();
+
 private:
     Map *mMap;
 };
@@ -150,5 +153,51 @@ void test_StaggeredRenderer::relativeCoordinates()
     QCOMPARE(renderer.bottomRight(1, 1), QPoint(2, 2));
 }
 
+void test_StaggeredRenderer::batchedCoordinates()
+{
+    QPolygonF points;
+    for (int y = -40; y <= 40; y += 7)
+        for (int x = -70; x <= 70; x += 9)
+            points.append(QPointF(x + 0.5, y + 0.25));
+
+    const StaggeredRenderer staggered(mMap);
+    const HexagonalRenderer hexagonal(mMap);
+    const IsometricRenderer isometric(mMap);
+    const OrthogonalRenderer orthogonal(mMap);
+    const MapRenderer *renderers[] = { &staggered, &hexagonal, &isometric, &orthogonal };
+
+    // The batched conversions match converting each point individually
+    for (const MapRenderer *renderer : renderers) {
+        QPolygonF result(points.size());
+
+        renderer->screenToTileCoords(points.constData(), result.data(), points.size());
+        for (int i = 0; i < points.size(); ++i)
+            QCOMPARE(result.at(i), renderer->screenToTileCoords(points.at(i)));
+
+        renderer->pixelToTileCoords(points.constData(), result.data(), points.size());
+        for (int i = 0; i < points.size(); ++i)
+            QCOMPARE(result.at(i), renderer->pixelToTileCoords(points.at(i)));
+
+        renderer->tileToScreenCoords(points.constData(), result.data(), points.size());
+        for (int i = 0; i < points.size(); ++i)
+            QCOMPARE(result.at(i), renderer->tileToScreenCoords(points.at(i)));
+
+        result = renderer->pixelToScreenCoords(points);
+        for (int i = 0; i < points.size(); ++i)
+            QCOMPARE(result.at(i), renderer->pixelToScreenCoords(points.at(i)));
+
+        result = renderer->screenToPixelCoords(points);
+        for (int i = 0; i < points.size(); ++i)
+            QCOMPARE(result.at(i), renderer->screenToPixelCoords(points.at(i)));
+
+        // Converting in place
+        result = points;
+        QPointF *data = result.data();
+        renderer->screenToTileCoords(data, data, result.size());
+        for (int i = 0; i < points.size(); ++i)
+            QCOMPARE(result.at(i), renderer->screenToTileCoords(points.at(i)));
+    }
+}
+
 QTEST_MAIN(test_StaggeredRenderer)
 #include "test_staggeredrenderer.moc"
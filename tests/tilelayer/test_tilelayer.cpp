@@ -0,0 +1,701 @@
+#include "tilelayer.h"
+#include "tileregion.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_TileLayer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void packedCells();
+    void unpackedFallback();
+    void manyTilesets();
+    void replaceTileset();
+    void usedTilesets();
+    void uniformChunks();
+    void sharedChunks();
+    void eraseChunks();
+    void diffRegion();
+    void forEachSpan();
+    void setRow();
+    void regions();
+    void chunkMap();
+    void merge();
+    void resize();
+    void offsetTiles_data();
+    void offsetTiles();
+    void flip_data();
+    void flip();
+    void rotate_data();
+    void rotate();
+
+    void benchmarkChunkLookup_data();
+    void benchmarkChunkLookup();
+
+private:
+    void fillPattern(TileLayer &layer) const;
+
+    SharedTileset mTileset;
+    SharedTileset mOtherTileset;
+};
+
+void test_TileLayer::initTestCase()
+{
+    mTileset = Tileset::create(QStringLiteral("a"), 32, 32);
+    mOtherTileset = Tileset::create(QStringLiteral("b"), 32, 32);
+}
+
+void test_TileLayer::packedCells()
+{
+    TileLayer layer(QString(), 0, 0, 32, 32);
+
+    Cell cell(mTileset.data(), 5);
+    cell.setFlippedHorizontally(true);
+    cell.setRotatedHexagonal120(true);
+
+    layer.setCell(3, 4, cell);
+    layer.setCell(20, 4, Cell(mOtherTileset.data(), 0));
+
+    QCOMPARE(layer.cellAt(3, 4), cell);
+    QVERIFY(layer.cellAt(3, 4).flippedHorizontally());
+    QVERIFY(layer.cellAt(3, 4).rotatedHexagonal120());
+    QCOMPARE(layer.cellAt(20, 4), Cell(mOtherTileset.data(), 0));
+    QVERIFY(layer.cellAt(4, 4).isEmpty());
+    QCOMPARE(layer.cellAt(4, 4).tileId(), -1);
+    QVERIFY(layer.findChunk(3, 4)->isPacked());
+
+    Cell checked;
+    checked.setChecked(true);
+    layer.setCell(5, 5, checked);
+    QVERIFY(layer.cellAt(5, 5).checked());
+
+    layer.setCell(3, 4, Cell::empty);
+    QCOMPARE(layer.cellAt(3, 4), Cell::empty);
+    QCOMPARE(layer.region(), QRegion(20, 4, 1, 1));
+}
+
+void test_TileLayer::unpackedFallback()
+{
+    TileLayer layer(QString(), 0, 0, 16, 16);
+
+    layer.setCell(0, 0, Cell(mTileset.data(), 1));
+    QVERIFY(layer.findChunk(0, 0)->isPacked());
+
+    const Cell bigCell(mTileset.data(), 1 << 24);
+    layer.setCell(1, 0, bigCell);
+    QVERIFY(!layer.findChunk(0, 0)->isPacked());
+
+    QCOMPARE(layer.cellAt(0, 0), Cell(mTileset.data(), 1));
+    QCOMPARE(layer.cellAt(1, 0), bigCell);
+}
+
+void test_TileLayer::manyTilesets()
+{
+    TileLayer layer(QString(), 0, 0, 16, 16);
+    QVector<SharedTileset> tilesets;
+
+    // Keep painting with new tilesets on the same cell, so that unused
+    // tilesets need to be dropped to keep the chunk packed.
+    for (int i = 0; i < 300; ++i) {
+        tilesets.append(Tileset::create(QString::number(i), 16, 16));
+        layer.setCell(0, 0, Cell(mTileset.data(), 0));
+        layer.setCell(1, 1, Cell(tilesets.last().data(), i));
+    }
+
+    QVERIFY(layer.findChunk(0, 0)->isPacked());
+    QCOMPARE(layer.cellAt(0, 0), Cell(mTileset.data(), 0));
+    QCOMPARE(layer.cellAt(1, 1), Cell(tilesets.last().data(), 299));
+}
+
+void test_TileLayer::replaceTileset()
+{
+    TileLayer layer(QString(), 0, 0, 16, 16);
+
+    layer.setCell(0, 0, Cell(mTileset.data(), 1));
+    layer.setCell(1, 0, Cell(mOtherTileset.data(), 2));
+    layer.replaceReferencesToTileset(mTileset.data(), mOtherTileset.data());
+
+    QCOMPARE(layer.cellAt(0, 0), Cell(mOtherTileset.data(), 1));
+    QCOMPARE(layer.cellAt(1, 0), Cell(mOtherTileset.data(), 2));
+
+    layer.removeReferencesToTileset(mOtherTileset.data());
+    QVERIFY(layer.isEmpty());
+}
+
+void test_TileLayer::usedTilesets()
+{
+    TileLayer layer(QString(), 0, 0, 32, 16);
+
+    layer.setCell(0, 0, Cell(mTileset.data(), 1));
+    layer.setCell(1, 0, Cell(mOtherTileset.data(), 2));
+    layer.setCell(2, 0, Cell(mOtherTileset.data(), 3));
+    layer.setCell(16, 0, Cell(mOtherTileset.data(), 4));
+    QCOMPARE(layer.usedTilesets().size(), 2);
+
+    // Still used by other cells, in the same and in another chunk
+    layer.setCell(1, 0, Cell(mTileset.data(), 1));
+    QVERIFY(layer.referencesTileset(mOtherTileset.data()));
+    layer.setCell(2, 0, Cell::empty);
+    QVERIFY(layer.referencesTileset(mOtherTileset.data()));
+
+    layer.setCell(16, 0, Cell::empty);
+    QVERIFY(!layer.referencesTileset(mOtherTileset.data()));
+    QCOMPARE(layer.usedTilesets().size(), 1);
+
+    // Unpacked chunks track their tilesets as well
+    const Cell bigCell(mOtherTileset.data(), 1 << 24);
+    layer.setCell(3, 0, bigCell);
+    QVERIFY(!layer.findChunk(0, 0)->isPacked());
+    QVERIFY(layer.referencesTileset(mOtherTileset.data()));
+
+    layer.setCell(3, 0, Cell(mOtherTileset.data(), 5));
+    layer.squeeze();
+    QVERIFY(layer.findChunk(0, 0)->isPacked());
+
+    const Cell cells[] = { Cell(mTileset.data(), 6), Cell(mTileset.data(), 7) };
+    layer.setRow(2, 0, 2, cells);
+    QVERIFY(!layer.referencesTileset(mOtherTileset.data()));
+    QVERIFY(layer.referencesTileset(mTileset.data()));
+}
+
+void test_TileLayer::uniformChunks()
+{
+    TileLayer layer(QString(), 0, 0, 32, 32);
+    const Cell cell(mTileset.data(), 3);
+
+    layer.setTiles(QRegion(0, 0, 16, 16), mTileset->findOrCreateTile(3));
+    layer.setCell(16, 0, cell);
+    QVERIFY(layer.findChunk(0, 0)->isPacked());
+
+    layer.squeeze();
+    QVERIFY(layer.findChunk(0, 0)->isUniform());
+    QVERIFY(layer.findChunk(16, 0)->isPacked());
+
+    QCOMPARE(layer.cellAt(7, 9), cell);
+    QCOMPARE(layer.region(), QRegion(0, 0, 16, 16) + QRegion(16, 0, 1, 1));
+    QVERIFY(!layer.isEmpty());
+
+    // Writing the same cell again keeps the chunk uniform
+    layer.setCell(2, 2, cell);
+    QVERIFY(layer.findChunk(0, 0)->isUniform());
+
+    layer.setCell(2, 2, Cell::empty);
+    QVERIFY(layer.findChunk(0, 0)->isPacked());
+    QVERIFY(layer.cellAt(2, 2).isEmpty());
+    QCOMPARE(layer.cellAt(3, 2), cell);
+
+    layer.erase(QRegion(0, 0, 32, 32));
+    QVERIFY(!layer.findChunk(0, 0));
+    QVERIFY(layer.isEmpty());
+}
+
+void test_TileLayer::sharedChunks()
+{
+    TileLayer layer(QString(), 0, 0, 64, 64);
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 64; ++x)
+            layer.setCell(x, y, Cell(mTileset.data(), x + y * 64));
+
+    Cell checked;
+    checked.setChecked(true);
+    layer.setCell(40, 40, checked);
+
+    // Aligned copy, sharing most chunks
+    const auto copied = layer.copy(QRegion(16, 16, 40, 40));
+    QCOMPARE(copied->size(), QSize(40, 40));
+    for (int y = 0; y < 40; ++y)
+        for (int x = 0; x < 40; ++x)
+            QCOMPARE(copied->cellAt(x, y), layer.cellAt(x + 16, y + 16));
+    QVERIFY(copied->cellAt(24, 24).checked());
+    QVERIFY(copied->cellAt(40, 0).isEmpty());
+
+    // Modifying the copy does not affect the original
+    copied->setCell(0, 0, Cell::empty);
+    QCOMPARE(layer.cellAt(16, 16), Cell(mTileset.data(), 16 + 16 * 64));
+
+    // Unaligned copy
+    const auto unaligned = layer.copy(QRegion(3, 5, 20, 20));
+    for (int y = 0; y < 20; ++y)
+        for (int x = 0; x < 20; ++x)
+            QCOMPARE(unaligned->cellAt(x, y), layer.cellAt(x + 3, y + 5));
+
+    // Setting cells from an empty layer clears the area
+    TileLayer empty;
+    layer.setCells(0, 0, &empty, QRegion(0, 0, 32, 32));
+    QCOMPARE(layer.region(), QRegion(0, 0, 64, 64) - QRegion(0, 0, 32, 32) - QRegion(40, 40, 1, 1));
+    QVERIFY(!copied->cellAt(1, 1).isEmpty());
+}
+
+void test_TileLayer::eraseChunks()
+{
+    TileLayer layer(QString(), 0, 0, 64, 64);
+    layer.setTiles(QRegion(0, 0, 64, 64), mTileset->findOrCreateTile(1));
+
+    // Fully covered chunks are dropped, partially covered ones are cleared
+    layer.erase(QRegion(0, 0, 40, 16));
+    QVERIFY(!layer.findChunk(0, 0));
+    QVERIFY(!layer.findChunk(16, 0));
+    QVERIFY(layer.findChunk(32, 0));
+    QVERIFY(layer.cellAt(39, 0).isEmpty());
+    QCOMPARE(layer.cellAt(40, 0), Cell(mTileset.data(), 1));
+    QCOMPARE(layer.region(), QRegion(0, 0, 64, 64) - QRegion(0, 0, 40, 16));
+
+    // Chunks that become empty are collected, shrinking the bounds
+    layer.erase(QRegion(40, 0, 24, 16));
+    layer.erase(QRegion(0, 16, 64, 10));
+    layer.erase(QRegion(0, 26, 64, 38));
+    QVERIFY(!layer.findChunk(32, 0));
+    QVERIFY(layer.isEmpty());
+    QCOMPARE(layer.localBounds(), QRect());
+
+    // Checked cells keep their chunk alive
+    layer.setTiles(QRegion(0, 0, 32, 32), mTileset->findOrCreateTile(1));
+    Cell checked;
+    checked.setChecked(true);
+    layer.setCell(20, 20, checked);
+    layer.erase(QRegion(0, 0, 20, 32));
+    QVERIFY(!layer.findChunk(0, 0));
+    QVERIFY(layer.findChunk(16, 16));
+    layer.erase(QRegion(16, 0, 16, 16));
+    QCOMPARE(layer.localBounds(), QRect(16, 16, 16, 16));
+
+    // Setting cells from an empty layer drops the cleared chunks as well
+    TileLayer empty;
+    layer.setCells(0, 0, &empty, QRegion(0, 0, 64, 64));
+    QVERIFY(!layer.findChunk(16, 16));
+    QCOMPARE(layer.localBounds(), QRect());
+}
+
+void test_TileLayer::diffRegion()
+{
+    // Reference implementation comparing each cell
+    auto cellDiffRegion = [] (const TileLayer &a, const TileLayer &b) {
+        const QPoint offset = b.position() - a.position();
+        const QRect r = a.bounds().united(b.bounds()).translated(-a.position());
+
+        TileRegion region;
+        for (int y = r.top(); y <= r.bottom(); ++y)
+            for (int x = r.left(); x <= r.right(); ++x)
+                if (a.cellAt(x, y) != b.cellAt(QPoint(x, y) - offset))
+                    region.addSpan(x, y, 1);
+        return region.toRegion();
+    };
+
+    TileLayer layer(QString(), 0, 0, 64, 64);
+    fillPattern(layer);
+
+    const auto copied = layer.copy(QRegion(0, 0, 64, 64));
+    QVERIFY(layer.computeDiffRegion(*copied).isEmpty());
+
+    copied->setCell(3, 3, Cell::empty);
+    copied->setCell(4, 3, Cell(mOtherTileset.data(), 1));
+    copied->setCell(32, 0, Cell(mTileset.data(), 2));     // unallocated chunk
+    layer.setCell(60, 60, Cell::empty);
+
+    QCOMPARE(layer.computeDiffRegion(*copied), cellDiffRegion(layer, *copied));
+    QCOMPARE(copied->computeDiffRegion(layer), cellDiffRegion(*copied, layer));
+    QCOMPARE(layer.computeDiffRegion(*copied).rectCount(), 3);
+
+    // Offset aligned to the chunk grid
+    TileLayer aligned(QString(), 16, 16, 64, 64);
+    aligned.setCells(0, 0, &layer, QRegion(0, 0, 48, 48));
+    QCOMPARE(layer.computeDiffRegion(aligned), cellDiffRegion(layer, aligned));
+
+    // Offset not aligned to the chunk grid
+    TileLayer unaligned(QString(), 3, 0, 64, 64);
+    unaligned.setCells(0, 0, &layer, QRegion(0, 0, 64, 64));
+    QCOMPARE(layer.computeDiffRegion(unaligned), cellDiffRegion(layer, unaligned));
+}
+
+void test_TileLayer::forEachSpan()
+{
+    TileLayer layer(QString(), 0, 0, 40, 40);
+    for (int y = 0; y < 40; y += 3)
+        for (int x = 0; x < 40; x += 2)
+            layer.setCell(x, y, Cell(mTileset.data(), x * y));
+
+    // Includes area outside of the allocated chunks
+    const QRect rect(-5, 7, 60, 20);
+    QPoint expected = rect.topLeft();
+
+    layer.forEachSpan(rect, [&] (int x, int y, const Cell *cells, int count) {
+        QCOMPARE(QPoint(x, y), expected);
+        QVERIFY(count > 0 && count <= CHUNK_SIZE);
+        QCOMPARE(x >> CHUNK_BITS, (x + count - 1) >> CHUNK_BITS);
+
+        for (int i = 0; i < count; ++i)
+            QCOMPARE(cells[i], layer.cellAt(x + i, y));
+
+        expected.rx() += count;
+        if (expected.x() > rect.right())
+            expected = QPoint(rect.left(), y + 1);
+    });
+
+    QCOMPARE(expected, QPoint(rect.left(), rect.bottom() + 1));
+}
+
+void test_TileLayer::setRow()
+{
+    TileLayer layer(QString(), 0, 0, 40, 40);
+    layer.setCell(20, 3, Cell(mOtherTileset.data(), 1));
+    QCOMPARE(layer.usedTilesets().size(), 1);
+
+    // Spans three chunks, of which the first is left unallocated
+    QVector<Cell> cells(30);
+    for (int i = 10; i < cells.size(); ++i)
+        cells[i] = Cell(mTileset.data(), i);
+
+    layer.setRow(6, 3, cells.size(), cells.constData());
+
+    QVERIFY(!layer.findChunk(6, 3));
+    QCOMPARE(layer.bounds(), QRect(16, 0, 32, 16));
+    for (int i = 0; i < cells.size(); ++i)
+        QCOMPARE(layer.cellAt(6 + i, 3), cells.at(i));
+
+    // The cell from the other tileset was overwritten
+    QCOMPARE(layer.usedTilesets().size(), 1);
+    QVERIFY(layer.usedTilesets().contains(mTileset));
+
+    // Setting empty cells does not allocate chunks
+    layer.setRow(0, 20, 16, QVector<Cell>(16).constData());
+    QVERIFY(!layer.findChunk(0, 20));
+}
+
+void test_TileLayer::regions()
+{
+    TileLayer layer(QString(), 2, 3, 48, 48);
+
+    // A run crossing two chunk borders on a packed row
+    for (int x = 10; x < 40; ++x)
+        layer.setCell(x, 5, Cell(mTileset.data(), x));
+
+    // A uniform chunk next to an unpacked one
+    layer.setTiles(QRegion(0, 16, 16, 16), mTileset->findOrCreateTile(1));
+    layer.squeeze();
+    QVERIFY(layer.findChunk(0, 16)->isUniform());
+    layer.setCell(16, 20, Cell(mTileset.data(), 1 << 24));
+    QVERIFY(!layer.findChunk(16, 20)->isPacked());
+
+    Cell checked;
+    checked.setChecked(true);
+    layer.setCell(30, 40, checked);
+
+    const QRegion expected = QRegion(12, 8, 30, 1) +
+            QRegion(2, 19, 16, 16) +
+            QRegion(18, 23, 1, 1);
+
+    QCOMPARE(layer.region(), expected);
+    QCOMPARE(layer.region([] (const Cell &cell) { return !cell.isEmpty(); }), expected);
+    QCOMPARE(layer.modifiedRegion(), expected + QRegion(32, 43, 1, 1));
+    QCOMPARE(TileLayer().region(), QRegion());
+}
+
+void test_TileLayer::chunkMap()
+{
+    ChunkMap chunks;
+    chunks.setDenseArea(QRect(0, 0, 64, 64));
+    QCOMPARE(chunks.denseArea(), QRect(0, 0, 4, 4));
+
+    // Add chunks both inside and outside of the dense area
+    for (int y = -20; y < 20; ++y)
+        for (int x = -20; x < 20; ++x)
+            chunks[QPoint(x, y)].setCell(0, 0, Cell(mTileset.data(), x * 100 + y));
+
+    QCOMPARE(chunks.size(), 40 * 40);
+
+    for (int y = -20; y < 20; ++y)
+        for (int x = -20; x < 20; ++x)
+            QCOMPARE(std::as_const(chunks).find(QPoint(x, y))->cellAt(0, 0),
+                     Cell(mTileset.data(), x * 100 + y));
+
+    QVERIFY(!std::as_const(chunks).find(QPoint(20, 0)));
+    QVERIFY(!std::as_const(chunks).find(QPoint(-21, 5)));
+
+    // Changing the dense area keeps all chunks
+    chunks.setDenseArea(QRect(-160, -160, 320, 320));
+    QCOMPARE(std::as_const(chunks).find(QPoint(-7, 13))->cellAt(0, 0),
+             Cell(mTileset.data(), -700 + 13));
+    QCOMPARE(std::as_const(chunks).find(QPoint(15, -20))->cellAt(0, 0),
+             Cell(mTileset.data(), 1500 - 20));
+
+    chunks.clear();
+    QVERIFY(chunks.isEmpty());
+    QVERIFY(!std::as_const(chunks).find(QPoint(0, 0)));
+}
+
+void test_TileLayer::fillPattern(TileLayer &layer) const
+{
+    // Leaves some cells empty and some chunks unallocated
+    for (int y = 0; y < layer.height(); ++y)
+        for (int x = 0; x < layer.width(); ++x)
+            if ((x + y) % 7 != 0 && !(x >= 32 && x < 48 && y < 16))
+                layer.setCell(x, y, Cell(mTileset.data(), x + y * layer.width()));
+}
+
+void test_TileLayer::merge()
+{
+    TileLayer source(QString(), 0, 0, 40, 40);
+    fillPattern(source);
+    for (int y = 16; y < 32; ++y)
+        for (int x = 0; x < 16; ++x)
+            source.setCell(x, y, Cell(mOtherTileset.data(), 1));
+
+    const QVector<QPoint> positions { QPoint(0, 0), QPoint(16, -16), QPoint(5, 3), QPoint(-7, 20) };
+
+    for (const QPoint pos : positions) {
+        TileLayer layer(QString(), 0, 0, 50, 50);
+        for (int y = 0; y < 50; ++y)
+            for (int x = 0; x < 50; ++x)
+                layer.setCell(x, y, Cell(mOtherTileset.data(), 2));
+
+        layer.merge(pos, &source);
+
+        for (int y = 0; y < 50; ++y) {
+            for (int x = 0; x < 50; ++x) {
+                const QPoint sourcePos = QPoint(x, y) - pos;
+                const Cell sourceCell = source.contains(sourcePos) ? source.cellAt(sourcePos)
+                                                                   : Cell::empty;
+                const Cell expected = sourceCell.isEmpty() ? Cell(mOtherTileset.data(), 2)
+                                                           : sourceCell;
+                QCOMPARE(layer.cellAt(x, y), expected);
+            }
+        }
+
+        QCOMPARE(layer.usedTilesets().size(), 2);
+    }
+}
+
+void test_TileLayer::resize()
+{
+    TileLayer original(QString(), 0, 0, 40, 40);
+    fillPattern(original);
+
+    const QVector<QPoint> offsets { QPoint(0, 0), QPoint(16, 32), QPoint(-3, 5) };
+
+    for (const QPoint offset : offsets) {
+        std::unique_ptr<TileLayer> layer(original.clone());
+        layer->resize(QSize(30, 50), offset);
+
+        QCOMPARE(layer->size(), QSize(30, 50));
+        for (int y = -CHUNK_SIZE; y < 50 + CHUNK_SIZE; ++y) {
+            for (int x = -CHUNK_SIZE; x < 30 + CHUNK_SIZE; ++x) {
+                const QPoint oldPos = QPoint(x, y) - offset;
+                const bool preserved = layer->contains(x, y) && original.contains(oldPos);
+                QCOMPARE(layer->cellAt(x, y), preserved ? original.cellAt(oldPos) : Cell::empty);
+            }
+        }
+    }
+}
+
+void test_TileLayer::offsetTiles_data()
+{
+    QTest::addColumn<QPoint>("offset");
+    QTest::addColumn<QRect>("bounds");
+    QTest::addColumn<bool>("wrapX");
+    QTest::addColumn<bool>("wrapY");
+
+    const QRect layerBounds(0, 0, 64, 48);
+    const QRect partialBounds(5, 3, 40, 30);
+
+    QTest::newRow("aligned") << QPoint(16, -32) << layerBounds << false << false;
+    QTest::newRow("aligned wrapped") << QPoint(16, -32) << layerBounds << true << true;
+    QTest::newRow("unaligned") << QPoint(3, 7) << layerBounds << false << false;
+    QTest::newRow("unaligned wrapped") << QPoint(-3, 7) << layerBounds << true << true;
+    QTest::newRow("wrap x only") << QPoint(21, -5) << layerBounds << true << false;
+    QTest::newRow("wrap y only") << QPoint(21, -5) << layerBounds << false << true;
+    QTest::newRow("partial") << QPoint(-9, 4) << partialBounds << false << false;
+    QTest::newRow("partial wrapped") << QPoint(-9, 4) << partialBounds << true << true;
+    QTest::newRow("beyond bounds") << QPoint(100, 0) << partialBounds << false << false;
+    QTest::newRow("beyond bounds wrapped") << QPoint(100, -61) << partialBounds << true << true;
+}
+
+void test_TileLayer::offsetTiles()
+{
+    QFETCH(QPoint, offset);
+    QFETCH(QRect, bounds);
+    QFETCH(bool, wrapX);
+    QFETCH(bool, wrapY);
+
+    TileLayer original(QString(), 0, 0, 64, 48);
+    fillPattern(original);
+
+    std::unique_ptr<TileLayer> layer(original.clone());
+    layer->offsetTiles(offset, bounds, wrapX, wrapY);
+
+    const auto wrap = [] (int value, int first, int size) {
+        return first + ((value - first) % size + size) % size;
+    };
+
+    for (int y = 0; y < 48; ++y) {
+        for (int x = 0; x < 64; ++x) {
+            Cell expected = original.cellAt(x, y);
+
+            if (bounds.contains(x, y)) {
+                int oldX = x - offset.x();
+                int oldY = y - offset.y();
+                if (wrapX)
+                    oldX = wrap(oldX, bounds.left(), bounds.width());
+                if (wrapY)
+                    oldY = wrap(oldY, bounds.top(), bounds.height());
+
+                expected = bounds.contains(oldX, oldY) ? original.cellAt(oldX, oldY)
+                                                       : Cell::empty;
+            }
+
+            QCOMPARE(layer->cellAt(x, y), expected);
+        }
+    }
+}
+
+void test_TileLayer::flip_data()
+{
+    QTest::addColumn<QSize>("size");
+
+    QTest::newRow("aligned") << QSize(32, 48);
+    QTest::newRow("unaligned") << QSize(37, 21);
+}
+
+void test_TileLayer::flip()
+{
+    QFETCH(QSize, size);
+
+    TileLayer original(QString(), 0, 0, size.width(), size.height());
+    fillPattern(original);
+    original.setCell(20, 1, Cell(mOtherTileset.data(), 1 << 30));  // unpacked chunk
+    for (int y = 0; y < 16; ++y)
+        for (int x = 0; x < 16; ++x)
+            original.setCell(x, y, Cell(mOtherTileset.data(), 3)); // uniform chunk
+    original.squeeze();
+
+    for (const FlipDirection direction : { FlipHorizontally, FlipVertically }) {
+        std::unique_ptr<TileLayer> layer(original.clone());
+        layer->flip(direction);
+
+        QCOMPARE(layer->size(), size);
+
+        for (int y = 0; y < size.height(); ++y) {
+            for (int x = 0; x < size.width(); ++x) {
+                Cell expected;
+
+                if (direction == FlipHorizontally) {
+                    expected = original.cellAt(size.width() - x - 1, y);
+                    expected.setFlippedHorizontally(!expected.flippedHorizontally());
+                } else {
+                    expected = original.cellAt(x, size.height() - y - 1);
+                    expected.setFlippedVertically(!expected.flippedVertically());
+                }
+
+                if (expected.isEmpty())
+                    expected = Cell::empty;
+
+                QCOMPARE(layer->cellAt(x, y), expected);
+            }
+        }
+
+        QCOMPARE(layer->region().boundingRect() | QRect(QPoint(), size), QRect(QPoint(), size));
+    }
+}
+
+void test_TileLayer::rotate_data()
+{
+    flip_data();
+}
+
+void test_TileLayer::rotate()
+{
+    QFETCH(QSize, size);
+
+    TileLayer original(QString(), 0, 0, size.width(), size.height());
+    fillPattern(original);
+    original.setCell(20, 1, Cell(mOtherTileset.data(), 1 << 30));  // unpacked chunk
+
+    Cell flipped(mOtherTileset.data(), 4);
+    flipped.setFlippedAntiDiagonally(true);
+    flipped.setFlippedVertically(true);
+    original.setCell(5, 6, flipped);
+
+    for (const RotateDirection direction : { RotateLeft, RotateRight }) {
+        std::unique_ptr<TileLayer> layer(original.clone());
+        layer->rotate(direction);
+
+        QCOMPARE(layer->size(), size.transposed());
+
+        for (int y = 0; y < size.height(); ++y) {
+            for (int x = 0; x < size.width(); ++x) {
+                Cell expected = original.cellAt(x, y);
+                expected.rotate(direction);
+
+                if (expected.isEmpty())
+                    expected = Cell::empty;
+
+                const QPoint rotated = direction == RotateRight
+                        ? QPoint(size.height() - y - 1, x)
+                        : QPoint(y, size.width() - x - 1);
+
+                QCOMPARE(layer->cellAt(rotated), expected);
+            }
+        }
+
+        // Rotating back restores the original
+        layer->rotate(direction == RotateRight ? RotateLeft : RotateRight);
+        for (int y = 0; y < size.height(); ++y)
+            for (int x = 0; x < size.width(); ++x)
+                QCOMPARE(layer->cellAt(x, y), original.cellAt(x, y));
+    }
+}
+
+void test_TileLayer::benchmarkChunkLookup_data()
+{
+    QTest::addColumn<int>("mode");
+
+    QTest::newRow("QHash") << 0;
+    QTest::newRow("ChunkMap dense") << 1;
+    QTest::newRow("ChunkMap sparse") << 2;
+}
+
+void test_TileLayer::benchmarkChunkLookup()
+{
+    QFETCH(int, mode);
+
+    constexpr int size = 128;  // in chunks
+
+    QHash<QPoint, Chunk> hash;
+    ChunkMap chunks;
+    if (mode == 1)
+        chunks.setDenseArea(QRect(0, 0, size * CHUNK_SIZE, size * CHUNK_SIZE));
+
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            if (mode == 0)
+                hash.insert(QPoint(x, y), Chunk());
+            else
+                chunks[QPoint(x, y)];
+        }
+    }
+
+    int found = 0;
+
+    // Also look up some chunks that don't exist
+    QBENCHMARK {
+        for (int y = -1; y <= size; ++y) {
+            for (int x = -1; x <= size; ++x) {
+                const QPoint key(x, y);
+                if (mode == 0)
+                    found += hash.constFind(key) != hash.constEnd();
+                else
+                    found += std::as_const(chunks).find(key) != nullptr;
+            }
+        }
+    }
+
+    QVERIFY(found > 0);
+}
+
+QTEST_MAIN(test_TileLayer)
+#include "test_tilelayer.moc"
@@ -0,0 +1,135 @@
+#include "tileregion.h"
+
+#include <QtTest/QtTest>
+
+#include <QRandomGenerator>
+
+using namespace Tiled;
+
+class test_TileRegion : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void addSpan();
+    void fromRegion();
+    void contains();
+    void operations_data();
+    void operations();
+};
+
+/**
+ * Creates a TileRegion and a matching QRegion from random rectangles, added
+ * in random order.
+ */
+static void randomRegions(QRandomGenerator &random, TileRegion &tileRegion, QRegion &region)
+{
+    const int count = random.bounded(1, 20);
+    for (int i = 0; i < count; ++i) {
+        const QRect rect(random.bounded(-20, 20), random.bounded(-20, 20),
+                         random.bounded(1, 15), random.bounded(1, 15));
+        tileRegion.addRect(rect);
+        region += rect;
+    }
+}
+
+void test_TileRegion::addSpan()
+{
+    TileRegion region;
+    QVERIFY(region.isEmpty());
+
+    region.addSpan(0, 0, 2);
+    region.addSpan(2, 0, 2);     // touching, merged
+    region.addSpan(1, 0, 1);     // contained, out of order
+    region.addSpan(6, 0, 1);
+    region.addSpan(0, -1, 1);    // earlier row
+    region.addSpan(0, 1, 0);     // empty, ignored
+
+    const QVector<QRect> expected {
+        QRect(0, -1, 1, 1),
+        QRect(0, 0, 4, 1),
+        QRect(6, 0, 1, 1),
+    };
+
+    QCOMPARE(region.spans(), expected);
+    QCOMPARE(region.area(), qint64(6));
+    QCOMPARE(region.boundingRect(), QRect(0, -1, 7, 2));
+}
+
+void test_TileRegion::fromRegion()
+{
+    QRandomGenerator random(1);
+
+    for (int i = 0; i < 100; ++i) {
+        TileRegion tileRegion;
+        QRegion region;
+        randomRegions(random, tileRegion, region);
+
+        QCOMPARE(TileRegion(region), tileRegion);
+        QCOMPARE(tileRegion.toRegion(), region);
+        QCOMPARE(tileRegion.boundingRect(), region.boundingRect());
+    }
+}
+
+void test_TileRegion::contains()
+{
+    QRandomGenerator random(2);
+
+    for (int i = 0; i < 20; ++i) {
+        TileRegion tileRegion;
+        QRegion region;
+        randomRegions(random, tileRegion, region);
+
+        for (int y = -25; y < 40; ++y)
+            for (int x = -25; x < 40; ++x)
+                QCOMPARE(tileRegion.contains(QPoint(x, y)), region.contains(QPoint(x, y)));
+    }
+}
+
+void test_TileRegion::operations_data()
+{
+    QTest::addColumn<int>("operation");
+
+    QTest::newRow("united") << 0;
+    QTest::newRow("intersected") << 1;
+    QTest::newRow("subtracted") << 2;
+}
+
+void test_TileRegion::operations()
+{
+    QFETCH(int, operation);
+
+    QRandomGenerator random(3);
+
+    for (int i = 0; i < 100; ++i) {
+        TileRegion a, b;
+        QRegion regionA, regionB;
+        randomRegions(random, a, regionA);
+        randomRegions(random, b, regionB);
+
+        TileRegion result;
+        QRegion expected;
+
+        switch (operation) {
+        case 0:
+            result = a.united(b);
+            expected = regionA.united(regionB);
+            break;
+        case 1:
+            result = a.intersected(b);
+            expected = regionA.intersected(regionB);
+            break;
+        case 2:
+            result = a.subtracted(b);
+            expected = regionA.subtracted(regionB);
+            break;
+        }
+
+        QCOMPARE(result.toRegion(), expected);
+        QCOMPARE(result, TileRegion(expected));
+        QCOMPARE(result.translated(QPoint(3, -2)).toRegion(), expected.translated(3, -2));
+    }
+}
+
+QTEST_APPLESS_MAIN(test_TileRegion)
+#include "test_tileregion.moc"
@@ -0,0 +1,341 @@
+#include "tileset.h"
+#include "wangset.h"
+
+#include <QtTest/QtTest>
+
+#include <QRandomGenerator>
+
+using namespace Tiled;
+
+class test_WangSet : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matchingWangIdsAndCells_data();
+    void matchingWangIdsAndCells();
+    void lookupAfterChange();
+    void colorDistances_data();
+    void colorDistances();
+    void colorDistancesAfterChange();
+    void transformations();
+};
+
+/**
+ * The reference implementation, checking each entry.
+ */
+static QVector<int> scanWangIdsAndCells(const WangSet &wangSet, WangId wangId, WangId mask)
+{
+    QVector<int> indexes;
+    const auto &entries = wangSet.wangIdsAndCells();
+    for (int index = 0; index < entries.size(); ++index)
+        if ((entries.at(index).wangId & mask) == (wangId & mask))
+            indexes.append(index);
+    return indexes;
+}
+
+static WangId randomWangId(QRandomGenerator &random, int colorCount)
+{
+    WangId wangId;
+    for (int i = 0; i < WangId::NumIndexes; ++i)
+        wangId.setIndexColor(i, random.bounded(colorCount + 1));
+    return wangId;
+}
+
+/**
+ * The reference implementation of the color distances, which connects
+ * colors until no shorter paths are found.
+ */
+static QVector<QVector<int>> referenceColorDistances(const QVector<WangId> &wangIds,
+                                                     WangId typeMask,
+                                                     int colorCount)
+{
+    QVector<QVector<int>> distances(colorCount + 1);
+
+    for (int i = 1; i <= colorCount; ++i) {
+        QVector<int> distance(colorCount + 1, -1);
+
+        for (WangId wangId : wangIds) {
+            wangId &= typeMask;
+
+            if (wangId.hasCornerWithColor(i))
+                for (int index = 0; index < 4; ++index)
+                    distance[wangId.cornerColor(index)] = 1;
+
+            if (wangId.hasEdgeWithColor(i))
+                for (int index = 0; index < 4; ++index)
+                    distance[wangId.edgeColor(index)] = 1;
+        }
+
+        distance[i] = 0;
+        distances[i] = distance;
+    }
+
+    bool newConnections;
+    do {
+        newConnections = false;
+
+        for (int i = 1; i <= colorCount; ++i) {
+            for (int j = 1; j <= colorCount; ++j) {
+                if (i == j)
+                    continue;
+
+                for (int t = 0; t <= colorCount; ++t) {
+                    const int d0 = distances[i][t];
+                    const int d1 = distances[j][t];
+                    if (d0 == -1 || d1 == -1)
+                        continue;
+
+                    const int d = distances[i][j];
+                    if (d == -1 || d0 + d1 < d) {
+                        distances[i][j] = d0 + d1;
+                        distances[j][i] = d0 + d1;
+                        newConnections = true;
+                    }
+                }
+            }
+        }
+    } while (newConnections);
+
+    return distances;
+}
+
+static WangId cornerWangId(int a, int b)
+{
+    WangId wangId;
+    wangId.setCornerColor(0, a);
+    wangId.setCornerColor(1, a);
+    wangId.setCornerColor(2, b);
+    wangId.setCornerColor(3, b);
+    return wangId;
+}
+
+static WangId randomMask(QRandomGenerator &random, bool partial)
+{
+    WangId mask;
+    for (int i = 0; i < WangId::NumIndexes; ++i) {
+        if (random.bounded(2))
+            mask.setIndexColor(i, WangId::INDEX_MASK);
+        else if (partial && random.bounded(4) == 0)
+            mask.setIndexColor(i, 0x0F);
+    }
+    return mask;
+}
+
+void test_WangSet::matchingWangIdsAndCells_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<bool>("transformations");
+
+    QTest::newRow("corner") << int(WangSet::Corner) << false;
+    QTest::newRow("edge") << int(WangSet::Edge) << false;
+    QTest::newRow("mixed") << int(WangSet::Mixed) << false;
+    QTest::newRow("mixed-transformed") << int(WangSet::Mixed) << true;
+}
+
+void test_WangSet::matchingWangIdsAndCells()
+{
+    QFETCH(int, type);
+    QFETCH(bool, transformations);
+
+    constexpr int colorCount = 3;
+
+    SharedTileset tileset = Tileset::create(QStringLiteral("wang"), 32, 32);
+    if (transformations)
+        tileset->setTransformationFlags(Tileset::AllowFlipHorizontally | Tileset::AllowRotate);
+
+    WangSet wangSet(tileset.data(), QStringLiteral("set"), static_cast<WangSet::Type>(type));
+    wangSet.setColorCount(colorCount);
+
+    QRandomGenerator random(42);
+
+    // Use enough tiles for the bitsets to need multiple words
+    for (int tileId = 0; tileId < 300; ++tileId)
+        wangSet.setWangId(tileId, randomWangId(random, colorCount));
+
+    for (int i = 0; i < 500; ++i) {
+        const WangId wangId = randomWangId(random, colorCount);
+        const WangId mask = i % 10 == 0 ? WangId(WangId::FULL_MASK)
+                                        : randomMask(random, i % 5 == 0);
+
+        QCOMPARE(wangSet.matchingWangIdsAndCells(wangId, mask),
+                 scanWangIdsAndCells(wangSet, wangId, mask));
+        QCOMPARE(wangSet.wangIdIsUsed(wangId, mask),
+                 !scanWangIdsAndCells(wangSet, wangId, mask & wangSet.typeMask()).isEmpty());
+    }
+}
+
+void test_WangSet::lookupAfterChange()
+{
+    SharedTileset tileset = Tileset::create(QStringLiteral("wang"), 32, 32);
+
+    WangSet wangSet(tileset.data(), QStringLiteral("set"), WangSet::Mixed);
+    wangSet.setColorCount(2);
+
+    const WangId grass = WangId::fromUint(0x11111111);
+    const WangId water = WangId::fromUint(0x22222222);
+
+    wangSet.setWangId(0, grass);
+    QCOMPARE(wangSet.matchingWangIdsAndCells(grass, WangId::FULL_MASK).size(), 1);
+    QVERIFY(wangSet.matchingWangIdsAndCells(water, WangId::FULL_MASK).isEmpty());
+
+    // The lookup tables are rebuilt when the set changes
+    wangSet.setWangId(0, water);
+    QVERIFY(wangSet.matchingWangIdsAndCells(grass, WangId::FULL_MASK).isEmpty());
+    QCOMPARE(wangSet.matchingWangIdsAndCells(water, WangId::MaskTop).size(), 1);
+
+    // Colors added later are not in the lookup tables
+    wangSet.setColorCount(3);
+    QVERIFY(!wangSet.wangIdIsUsed(WangId::fromUint(0x33333333), WangId::MaskTop));
+}
+
+void test_WangSet::colorDistances_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<int>("tileCount");
+
+    QTest::newRow("corner-sparse") << int(WangSet::Corner) << 6;
+    QTest::newRow("corner") << int(WangSet::Corner) << 40;
+    QTest::newRow("edge-sparse") << int(WangSet::Edge) << 6;
+    QTest::newRow("mixed-sparse") << int(WangSet::Mixed) << 4;
+    QTest::newRow("mixed") << int(WangSet::Mixed) << 40;
+}
+
+void test_WangSet::colorDistances()
+{
+    QFETCH(int, type);
+    QFETCH(int, tileCount);
+
+    constexpr int colorCount = 12;
+
+    SharedTileset tileset = Tileset::create(QStringLiteral("wang"), 32, 32);
+
+    WangSet wangSet(tileset.data(), QStringLiteral("set"), static_cast<WangSet::Type>(type));
+    wangSet.setColorCount(colorCount);
+
+    QRandomGenerator random(7);
+    QVector<WangId> wangIds;
+
+    // Tiles using only a few colors each, so that colors are connected by
+    // longer paths
+    for (int tileId = 0; tileId < tileCount; ++tileId) {
+        const int a = random.bounded(colorCount + 1);
+        const int b = random.bounded(colorCount + 1);
+
+        WangId wangId;
+        for (int i = 0; i < WangId::NumIndexes; ++i)
+            wangId.setIndexColor(i, random.bounded(2) ? a : b);
+
+        wangSet.setWangId(tileId, wangId);
+        wangIds.append(wangId);
+    }
+
+    const auto expected = referenceColorDistances(wangIds, wangSet.typeMask(), colorCount);
+
+    int maximumDistance = 1;
+    for (int i = 1; i <= colorCount; ++i) {
+        for (int j = 0; j <= colorCount; ++j) {
+            QCOMPARE(wangSet.transitionPenalty(i, j), expected[i][j]);
+            QCOMPARE(wangSet.colorAt(i)->distanceToColor(j), expected[i][j]);
+            if (j > 0)
+                maximumDistance = std::max(maximumDistance, expected[i][j]);
+        }
+    }
+    QCOMPARE(wangSet.maximumColorDistance(), maximumDistance);
+}
+
+void test_WangSet::colorDistancesAfterChange()
+{
+    SharedTileset tileset = Tileset::create(QStringLiteral("wang"), 32, 32);
+
+    WangSet wangSet(tileset.data(), QStringLiteral("set"), WangSet::Corner);
+    wangSet.setColorCount(4);
+
+    wangSet.setWangId(0, cornerWangId(1, 2));
+    wangSet.setWangId(1, cornerWangId(2, 3));
+    wangSet.setWangId(2, cornerWangId(3, 4));
+
+    QCOMPARE(wangSet.transitionPenalty(1, 2), 1);
+    QCOMPARE(wangSet.transitionPenalty(1, 4), 3);
+    QCOMPARE(wangSet.transitionPenalty(1, 0), -1);
+    QCOMPARE(wangSet.maximumColorDistance(), 3);
+    QVERIFY(wangSet.hasTransition(1, 2));
+    QVERIFY(wangSet.hasTransition(2, 1));
+    QVERIFY(!wangSet.hasTransition(1, 3));
+
+    // The distances are updated when they are needed after a change
+    wangSet.setWangId(3, cornerWangId(1, 4));
+    QVERIFY(wangSet.hasTransition(1, 4));
+    QCOMPARE(wangSet.colorAt(1)->distanceToColor(4), 1);
+    QCOMPARE(wangSet.transitionPenalty(1, 3), 2);
+    QCOMPARE(wangSet.maximumColorDistance(), 2);
+
+    // Paths may pass through "no color"
+    wangSet.setWangId(1, cornerWangId(2, 0));
+    wangSet.setWangId(2, cornerWangId(3, 0));
+    QVERIFY(wangSet.hasTransition(0, 3));
+    QCOMPARE(wangSet.transitionPenalty(2, 3), 2);
+    QCOMPARE(wangSet.transitionPenalty(3, 0), 1);
+}
+
+void test_WangSet::transformations()
+{
+    QRandomGenerator random(3);
+
+    for (int n = 0; n < 1000; ++n) {
+        WangId wangId;
+        for (int i = 0; i < WangId::NumIndexes; ++i) {
+            // Include plenty of unset indexes and some high colors
+            const int r = random.bounded(4);
+            wangId.setIndexColor(i, r == 0 ? 0 : r == 1 ? 254 : random.bounded(1, 8));
+        }
+
+        WangId mask;
+        bool hasWildCards = false;
+        for (int i = 0; i < WangId::NumIndexes; ++i) {
+            if (wangId.indexColor(i))
+                mask.setIndexColor(i, WangId::INDEX_MASK);
+            else
+                hasWildCards = true;
+        }
+        QCOMPARE(wangId.mask(), mask);
+        QCOMPARE(wangId.hasWildCards(), hasWildCards);
+
+        for (int color : { 0, 1, 254, 255, 256 }) {
+            WangId colorMask;
+            bool corner = false;
+            bool edge = false;
+            for (int i = 0; i < WangId::NumIndexes; ++i) {
+                if (wangId.indexColor(i) == color) {
+                    colorMask.setIndexColor(i, WangId::INDEX_MASK);
+                    (WangId::isCorner(i) ? corner : edge) = true;
+                }
+            }
+            QCOMPARE(wangId.mask(color), colorMask);
+            QCOMPARE(wangId.hasCornerWithColor(color), corner);
+            QCOMPARE(wangId.hasEdgeWithColor(color), edge);
+        }
+
+        for (int rotations = -5; rotations <= 5; ++rotations) {
+            WangId rotated;
+            for (int i = 0; i < WangId::NumIndexes; ++i) {
+                const int target = (i + 2 * (rotations % 4) + 8) % WangId::NumIndexes;
+                rotated.setIndexColor(target, wangId.indexColor(i));
+            }
+            QCOMPARE(wangId.rotated(rotations), rotated);
+        }
+
+        WangId flippedHorizontally;
+        WangId flippedVertically;
+        for (int i = 0; i < WangId::NumIndexes; ++i) {
+            flippedHorizontally.setIndexColor((8 - i) % 8, wangId.indexColor(i));
+            flippedVertically.setIndexColor((12 - i) % 8, wangId.indexColor(i));
+        }
+        QCOMPARE(wangId.flippedHorizontally(), flippedHorizontally);
+        QCOMPARE(wangId.flippedVertically(), flippedVertically);
+        QCOMPARE(wangId.flippedHorizontally().flippedHorizontally(), wangId);
+    }
+}
+
+QTEST_MAIN(test_WangSet)
+#include "test_wangset.moc"
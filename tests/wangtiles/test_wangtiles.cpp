@@ -0,0 +1,120 @@
+#include "map.h"
+#include "mapreader.h"
+#include "orthogonalrenderer.h"
+#include "tilelayer.h"
+#include "tileset.h"
+#include "wangset.h"
+
+#include "wangfiller.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_WangTiles : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void benchmarkFill_data();
+    void benchmarkFill();
+};
+
+/**
+ * Paints a pattern of blocks of different colors, like a user would when
+ * painting with the Terrain Brush.
+ */
+static void paintPattern(WangFiller &filler, const WangSet &wangSet, int size)
+{
+    auto color = [&] (int x, int y) {
+        return (x / 8 + 2 * (y / 8)) % wangSet.colorCount() + 1;
+    };
+
+    if (wangSet.type() == WangSet::Edge) {
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                if (y > 0)
+                    filler.setEdge(QPoint(x, y), WangId::Top, color(x, y));
+                if (x > 0)
+                    filler.setEdge(QPoint(x, y), WangId::Left, color(x, y));
+            }
+        }
+    } else {
+        for (int y = 1; y < size; ++y)
+            for (int x = 1; x < size; ++x)
+                filler.setCorner(QPoint(x, y), color(x, y));
+    }
+}
+
+void test_WangTiles::benchmarkFill_data()
+{
+    QTest::addColumn<QString>("tilesetFile");
+    QTest::addColumn<int>("wangSetIndex");
+    QTest::addColumn<int>("size");
+    QTest::addColumn<bool>("corrections");
+
+    const struct {
+        const char *name;
+        const char *fileName;
+        int wangSetIndex;
+    } wangSets[] = {
+        { "corner-grass-and-water", "grassAndWater.tsx", 0 },
+        { "corner-lots", "PathAndObjects.tsx", 0 },
+        { "edge-walkways", "walkways.tsx", 0 },
+        { "mixed-blob", "wangblob.tsx", 0 },
+    };
+
+    for (const auto &wangSet : wangSets) {
+        for (int size : { 16, 64, 128 }) {
+            for (bool corrections : { false, true }) {
+                QTest::addRow("%s-%d%s", wangSet.name, size, corrections ? "-corrections" : "")
+                        << QString::fromLatin1(wangSet.fileName)
+                        << wangSet.wangSetIndex
+                        << size
+                        << corrections;
+            }
+        }
+    }
+}
+
+void test_WangTiles::benchmarkFill()
+{
+    QFETCH(QString, tilesetFile);
+    QFETCH(int, wangSetIndex);
+    QFETCH(int, size);
+    QFETCH(bool, corrections);
+
+    MapReader reader;
+    const SharedTileset tileset = reader.readTileset(tilesetFile);
+    QVERIFY2(tileset, qPrintable(reader.errorString()));
+
+    const WangSet *wangSet = tileset->wangSet(wangSetIndex);
+    QVERIFY(wangSet);
+
+    Map::Parameters parameters;
+    parameters.width = size;
+    parameters.height = size;
+    parameters.tileWidth = tileset->tileWidth();
+    parameters.tileHeight = tileset->tileHeight();
+
+    Map map(parameters);
+    map.addTileset(tileset);
+
+    const OrthogonalRenderer renderer(&map);
+    const TileLayer back(QString(), 0, 0, size, size);
+    TileLayer target(QString(), 0, 0, size, size);
+
+    QBENCHMARK {
+        target.clear();
+
+        WangFiller filler(*wangSet, back, &renderer);
+        filler.setCorrectionsEnabled(corrections);
+        paintPattern(filler, *wangSet, size);
+        filler.apply(target);
+    }
+
+    QVERIFY(!target.isEmpty());
+}
+
+QTEST_MAIN(test_WangTiles)
+#include "test_wangtiles.moc"